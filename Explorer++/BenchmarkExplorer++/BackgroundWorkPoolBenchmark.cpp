@@ -0,0 +1,240 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "BackgroundWorkPoolBenchmark.h"
+#include "../Explorer++/ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include <TlHelp32.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <latch>
+#include <memory>
+#include <thread>
+
+namespace
+{
+
+const int TAB_COUNTS[] = { 1, 10, 100 };
+
+// Each tab previously had its own thread for each of these job types.
+enum class JobType
+{
+	Column,
+	Thumbnail,
+	InfoTip
+};
+
+constexpr int NUM_JOB_TYPES = 3;
+
+// The number of tasks queued by each tab, split between the job types in roughly the proportion
+// they're queued when browsing a folder in the details view with thumbnails enabled.
+constexpr int NUM_COLUMN_TASKS_PER_TAB = 400;
+constexpr int NUM_THUMBNAIL_TASKS_PER_TAB = 150;
+constexpr int NUM_INFO_TIP_TASKS_PER_TAB = 50;
+constexpr int NUM_TASKS_PER_TAB =
+	NUM_COLUMN_TASKS_PER_TAB + NUM_THUMBNAIL_TASKS_PER_TAB + NUM_INFO_TIP_TASKS_PER_TAB;
+
+// The amount of work done by each task. This is roughly the cost of retrieving the text for a
+// cached column.
+constexpr size_t WORK_BUFFER_SIZE = 16 * 1024;
+
+struct Result
+{
+	double durationMs;
+	int numThreads;
+};
+
+// Stands in for the work a task would do (e.g. retrieving the text for a column).
+uint64_t SimulateWork(int taskIndex)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < WORK_BUFFER_SIZE; i++)
+	{
+		hash ^= static_cast<uint8_t>(taskIndex + i);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+int CountProcessThreads()
+{
+	// CreateToolhelp32Snapshot() returns INVALID_HANDLE_VALUE on failure, which unique_hfile treats
+	// as an invalid handle.
+	wil::unique_hfile snapshot(CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0));
+
+	if (!snapshot)
+	{
+		return -1;
+	}
+
+	DWORD processId = GetCurrentProcessId();
+	int numThreads = 0;
+
+	THREADENTRY32 threadEntry;
+	threadEntry.dwSize = sizeof(threadEntry);
+
+	for (BOOL res = Thread32First(snapshot.get(), &threadEntry); res;
+		res = Thread32Next(snapshot.get(), &threadEntry))
+	{
+		if (threadEntry.th32OwnerProcessID == processId)
+		{
+			numThreads++;
+		}
+	}
+
+	return numThreads;
+}
+
+// Queues the work for each tab, in the same order the tab would, by calling the supplied function
+// for each task.
+template <typename QueueFunction>
+void QueueTabWork(int numTabs, QueueFunction queueTask)
+{
+	for (int tab = 0; tab < numTabs; tab++)
+	{
+		for (int i = 0; i < NUM_TASKS_PER_TAB; i++)
+		{
+			JobType jobType;
+
+			if (i < NUM_COLUMN_TASKS_PER_TAB)
+			{
+				jobType = JobType::Column;
+			}
+			else if (i < NUM_COLUMN_TASKS_PER_TAB + NUM_THUMBNAIL_TASKS_PER_TAB)
+			{
+				jobType = JobType::Thumbnail;
+			}
+			else
+			{
+				jobType = JobType::InfoTip;
+			}
+
+			queueTask(tab, jobType, tab * NUM_TASKS_PER_TAB + i);
+		}
+	}
+}
+
+// This is the approach that was previously used: each tab had a single-threaded pool for each job
+// type.
+Result RunOnPerTabPools(int numTabs)
+{
+	std::vector<std::shared_ptr<ComStaThreadPoolExecutor>> executors;
+
+	for (int i = 0; i < numTabs * NUM_JOB_TYPES; i++)
+	{
+		executors.push_back(std::make_shared<ComStaThreadPoolExecutor>(1));
+	}
+
+	std::latch tasksFinished(static_cast<ptrdiff_t>(numTabs) * NUM_TASKS_PER_TAB);
+	std::atomic<uint64_t> checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	QueueTabWork(numTabs,
+		[&](int tab, JobType jobType, int taskIndex)
+		{
+			executors[tab * NUM_JOB_TYPES + static_cast<int>(jobType)]->post(
+				[&tasksFinished, &checksum, taskIndex]
+				{
+					checksum += SimulateWork(taskIndex);
+					tasksFinished.count_down();
+				});
+		});
+
+	tasksFinished.wait();
+
+	auto end = std::chrono::steady_clock::now();
+
+	int numThreads = CountProcessThreads();
+
+	for (auto &executor : executors)
+	{
+		executor->shutdown();
+	}
+
+	return { std::chrono::duration<double, std::milli>(end - start).count(), numThreads };
+}
+
+// Each tab has a TaskGroup for each job type, all of which share a single pool, sized to the core
+// count.
+Result RunOnSharedPool(int numTabs)
+{
+	auto executor = std::make_shared<ComStaThreadPoolExecutor>(
+		std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+
+	Result result;
+
+	{
+		BackgroundWorkPool workPool(executor);
+
+		// These are declared before the task groups, so that they outlive any running tasks (the
+		// TaskGroup destructor waits for those tasks to finish).
+		std::latch tasksFinished(static_cast<ptrdiff_t>(numTabs) * NUM_TASKS_PER_TAB);
+		std::atomic<uint64_t> checksum = 0;
+
+		std::vector<std::unique_ptr<TaskGroup>> taskGroups;
+
+		for (int i = 0; i < numTabs * NUM_JOB_TYPES; i++)
+		{
+			taskGroups.push_back(std::make_unique<TaskGroup>(&workPool));
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		QueueTabWork(numTabs,
+			[&](int tab, JobType jobType, int taskIndex)
+			{
+				// Info tips are run at a higher priority, as they are when browsing.
+				auto priority =
+					(jobType == JobType::InfoTip) ? TaskPriority::High : TaskPriority::Normal;
+
+				taskGroups[tab * NUM_JOB_TYPES + static_cast<int>(jobType)]->Push(
+					[&tasksFinished, &checksum, taskIndex]
+					{
+						checksum += SimulateWork(taskIndex);
+						tasksFinished.count_down();
+					},
+					priority);
+			});
+
+		tasksFinished.wait();
+
+		auto end = std::chrono::steady_clock::now();
+
+		result = { std::chrono::duration<double, std::milli>(end - start).count(),
+			CountProcessThreads() };
+	}
+
+	executor->shutdown();
+
+	return result;
+}
+
+void PrintResult(int numTabs, const wchar_t *name, const Result &result)
+{
+	double tasksPerSecond = (numTabs * NUM_TASKS_PER_TAB) / (result.durationMs / 1000.0);
+
+	wprintf(L"%-8d %-16ls %16.2f %16.0f %16d\n", numTabs, name, result.durationMs, tasksPerSecond,
+		result.numThreads);
+}
+
+}
+
+void RunBackgroundWorkPoolBenchmark()
+{
+	wprintf(L"Background work (%d tasks per tab, %u cores)\n\n", NUM_TASKS_PER_TAB,
+		std::thread::hardware_concurrency());
+	wprintf(L"%-8ls %-16ls %16ls %16ls %16ls\n", L"Tabs", L"Pool", L"Time (ms)", L"Tasks/s",
+		L"Threads");
+
+	for (int numTabs : TAB_COUNTS)
+	{
+		PrintResult(numTabs, L"Per-tab pools", RunOnPerTabPools(numTabs));
+		PrintResult(numTabs, L"Shared pool", RunOnSharedPool(numTabs));
+	}
+}
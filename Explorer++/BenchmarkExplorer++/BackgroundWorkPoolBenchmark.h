@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Runs the same background work for 1, 10 and 100 simulated tabs, with each tab queueing column,
+// thumbnail and info tip tasks. The work is run on a shared BackgroundWorkPool (as tabs now do) and
+// on a set of single-threaded pools for each tab (as tabs previously did). Writes the throughput
+// and the number of threads the process has for each configuration to stdout.
+void RunBackgroundWorkPoolBenchmark();
@@ -0,0 +1,38 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "BenchmarkFiles.h"
+#include "../Helper/FileStreams.h"
+#include "../Helper/ReadAheadPipeline.h"
+#include <algorithm>
+
+bool CreateBenchmarkFile(const std::wstring &path, uint64_t size, int seed)
+{
+	auto writer = FileWriter::Create(path);
+
+	if (!writer)
+	{
+		return false;
+	}
+
+	std::vector<std::byte> block(ReadAheadPipeline::DEFAULT_BUFFER_SIZE);
+
+	for (size_t i = 0; i < block.size(); i++)
+	{
+		block[i] = static_cast<std::byte>((i * 31 + seed) % 251);
+	}
+
+	for (uint64_t written = 0; written < size; written += block.size())
+	{
+		auto blockSize = static_cast<size_t>(std::min<uint64_t>(block.size(), size - written));
+
+		if (!writer->Write(std::span(block).first(blockSize)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
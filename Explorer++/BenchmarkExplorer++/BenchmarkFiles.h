@@ -0,0 +1,12 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Creates a file of the specified size, filled with a repeating pattern derived from the seed. The
+// file must not already exist.
+bool CreateBenchmarkFile(const std::wstring &path, uint64_t size, int seed);
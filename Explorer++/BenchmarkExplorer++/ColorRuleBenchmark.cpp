@@ -0,0 +1,207 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ColorRuleBenchmark.h"
+#include "../Explorer++/ColorRuleModel.h"
+#include "../Explorer++/ColorRuleProgram.h"
+#include <cstdio>
+#include <optional>
+#include <random>
+
+namespace
+{
+
+constexpr int NUM_ITEMS = 100'000;
+constexpr int NUM_RULES = 50;
+constexpr int NUM_PAINTS = 10;
+
+// Every tenth rule filters on an attribute, rather than on the file name.
+const DWORD RULE_ATTRIBUTES[] = { FILE_ATTRIBUTE_HIDDEN, FILE_ATTRIBUTE_COMPRESSED,
+	FILE_ATTRIBUTE_ENCRYPTED, FILE_ATTRIBUTE_SYSTEM, FILE_ATTRIBUTE_READONLY };
+
+// The number of distinct file extensions. Only some of the extensions have a rule, so the remaining
+// items are checked against every rule without a match being found.
+constexpr int NUM_EXTENSIONS = 80;
+
+struct Item
+{
+	std::wstring name;
+	DWORD attributes;
+
+	// Equivalent to the cached rule index and generation stored in ItemInfo_t.
+	std::optional<size_t> colorRuleIndex;
+	int colorRuleGeneration = -1;
+};
+
+void AddRules(ColorRuleModel &model)
+{
+	for (int i = 0; i < NUM_RULES; i++)
+	{
+		auto color = RGB(i, 255 - i, 128);
+
+		if (i % 10 == 9)
+		{
+			model.AddItem(std::make_unique<ColorRule>(L"Attribute rule", L"", false,
+				RULE_ATTRIBUTES[i / 10], color));
+		}
+		else
+		{
+			model.AddItem(std::make_unique<ColorRule>(L"Extension rule",
+				L"*.type" + std::to_wstring(i), true, 0, color));
+		}
+	}
+}
+
+std::vector<Item> GenerateItems()
+{
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<int> extensionDistribution(0, NUM_EXTENSIONS - 1);
+	std::uniform_int_distribution<int> attributeDistribution(0, 99);
+
+	std::vector<Item> items;
+	items.reserve(NUM_ITEMS);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		Item item;
+		item.name = L"file " + std::to_wstring(i) + L".TYPE"
+			+ std::to_wstring(extensionDistribution(generator));
+		item.attributes = FILE_ATTRIBUTE_NORMAL;
+
+		if (attributeDistribution(generator) < 2)
+		{
+			item.attributes = FILE_ATTRIBUTE_HIDDEN;
+		}
+
+		items.push_back(std::move(item));
+	}
+
+	return items;
+}
+
+// Equivalent to the way in which the color for an item was previously determined, each time the
+// item was drawn.
+std::optional<COLORREF> GetColorFromModel(const ColorRuleModel &model, const Item &item)
+{
+	for (const auto &colorRule : model.GetItems())
+	{
+		if (!colorRule->GetFilterPattern().empty()
+			&& !colorRule->GetCompiledFilterPattern().Matches(item.name))
+		{
+			continue;
+		}
+
+		if (colorRule->GetFilterAttributes() != 0
+			&& !WI_IsAnyFlagSet(item.attributes, colorRule->GetFilterAttributes()))
+		{
+			continue;
+		}
+
+		return colorRule->GetColor();
+	}
+
+	return std::nullopt;
+}
+
+// Equivalent to ShellBrowserImpl::GetItemColorRuleIndex().
+std::optional<size_t> GetCachedColorRuleIndex(Item &item, const ColorRuleProgram &program,
+	int generation)
+{
+	if (item.colorRuleGeneration == generation)
+	{
+		return item.colorRuleIndex;
+	}
+
+	item.colorRuleIndex = program.Evaluate(item.name, item.attributes);
+	item.colorRuleGeneration = generation;
+
+	return item.colorRuleIndex;
+}
+
+// Calls the specified function for each item, as would happen when every item is drawn. Returns
+// the time taken, along with a checksum of the colors, so that the results from each method can be
+// compared.
+template <typename GetColor>
+std::pair<double, uint64_t> MeasurePaint(std::vector<Item> &items, GetColor getColor)
+{
+	uint64_t checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (auto &item : items)
+	{
+		std::optional<COLORREF> color = getColor(item);
+		checksum = checksum * 31 + (color ? *color + 1 : 0);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	return { std::chrono::duration<double, std::milli>(end - start).count(), checksum };
+}
+
+template <typename GetColor>
+std::pair<double, uint64_t> MeasureRepaints(std::vector<Item> &items, GetColor getColor)
+{
+	double totalTime = 0;
+	uint64_t checksum = 0;
+
+	for (int i = 0; i < NUM_PAINTS; i++)
+	{
+		auto [time, paintChecksum] = MeasurePaint(items, getColor);
+		totalTime += time;
+		checksum = paintChecksum;
+	}
+
+	return { totalTime / NUM_PAINTS, checksum };
+}
+
+}
+
+void RunColorRuleBenchmark()
+{
+	wprintf(L"Color rules (%d rules, %d items, average of %d paints)\n\n", NUM_RULES, NUM_ITEMS,
+		NUM_PAINTS);
+	wprintf(L"%-36ls %16ls\n", L"Method", L"ms per paint");
+
+	ColorRuleModel model;
+	AddRules(model);
+
+	auto items = GenerateItems();
+
+	auto [modelTime, modelChecksum] = MeasureRepaints(items,
+		[&model](const Item &item) { return GetColorFromModel(model, item); });
+	wprintf(L"%-36ls %16.2f\n", L"Walking the model", modelTime);
+
+	ColorRuleProgram program(&model);
+
+	auto [programTime, programChecksum] = MeasureRepaints(items,
+		[&program](const Item &item) -> std::optional<COLORREF>
+		{
+			auto ruleIndex = program.Evaluate(item.name, item.attributes);
+			return ruleIndex ? std::optional(program.GetColor(*ruleIndex)) : std::nullopt;
+		});
+	wprintf(L"%-36ls %16.2f\n", L"ColorRuleProgram", programTime);
+
+	// The program and cached indexes are rebuilt whenever the rules change, so the first paint
+	// after a change has to evaluate the rules for every item.
+	int generation = 0;
+	auto getCachedColor = [&](Item &item) -> std::optional<COLORREF>
+	{
+		auto ruleIndex = GetCachedColorRuleIndex(item, program, generation);
+		return ruleIndex ? std::optional(program.GetColor(*ruleIndex)) : std::nullopt;
+	};
+
+	auto [firstPaintTime, firstPaintChecksum] = MeasurePaint(items, getCachedColor);
+	wprintf(L"%-36ls %16.2f\n", L"Cached (first paint)", firstPaintTime);
+
+	auto [repaintTime, repaintChecksum] = MeasureRepaints(items, getCachedColor);
+	wprintf(L"%-36ls %16.2f\n", L"Cached (repaint)", repaintTime);
+
+	if (programChecksum != modelChecksum || firstPaintChecksum != modelChecksum
+		|| repaintChecksum != modelChecksum)
+	{
+		wprintf(L"failed\n");
+	}
+}
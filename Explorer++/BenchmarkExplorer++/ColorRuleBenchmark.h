@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Measures the cost of determining the color of each item when a folder of 100,000 items is
+// painted with 50 color rules. The rules are evaluated on each paint (both by walking the model, as
+// was previously done, and through a ColorRuleProgram), then once per item, with the result cached
+// for subsequent paints. Writes the results to stdout.
+void RunColorRuleBenchmark();
@@ -0,0 +1,183 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ColumnValueCacheBenchmark.h"
+#include "../Explorer++/ShellBrowser/ColumnValueCache.h"
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+namespace
+{
+
+constexpr int NUM_FILES = 20'000;
+constexpr int NUM_LOOKUPS = 1'000'000;
+
+// The size budget is only applied when saving, and is large enough here that nothing is evicted.
+constexpr uint64_t MAX_CACHE_SIZE = 1ULL << 30;
+
+const ColumnType CACHED_COLUMNS[] = { ColumnType::ProductName, ColumnType::Company,
+	ColumnType::Description, ColumnType::FileVersion };
+
+struct CachedFile
+{
+	std::wstring path;
+	WIN32_FIND_DATA findData;
+};
+
+std::vector<CachedFile> GenerateFiles()
+{
+	std::vector<CachedFile> files(NUM_FILES);
+
+	for (int i = 0; i < NUM_FILES; i++)
+	{
+		auto &file = files[i];
+		file.path = L"C:\\Program Files\\Benchmark\\bin\\module" + std::to_wstring(i) + L".dll";
+		file.findData = {};
+		file.findData.nFileSizeLow = 100'000 + i;
+		file.findData.ftLastWriteTime = { static_cast<DWORD>(i), 0x01D9A000 };
+	}
+
+	return files;
+}
+
+// Text of a similar length to a version number.
+std::wstring BuildColumnText(int fileIndex, ColumnType columnType)
+{
+	return L"10.0." + std::to_wstring(fileIndex) + L"."
+		+ std::to_wstring(columnType._to_integral());
+}
+
+// A lookup identifies a file and one of its columns. The lookups are in a random order, as the
+// items in a folder would be when sorted by something other than their name.
+struct Lookup
+{
+	int fileIndex;
+	ColumnType columnType;
+};
+
+std::vector<Lookup> GenerateLookups()
+{
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<int> fileDistribution(0, NUM_FILES - 1);
+	std::uniform_int_distribution<size_t> columnDistribution(0, std::size(CACHED_COLUMNS) - 1);
+
+	std::vector<Lookup> lookups;
+	lookups.reserve(NUM_LOOKUPS);
+
+	for (int i = 0; i < NUM_LOOKUPS; i++)
+	{
+		lookups.push_back(
+			{ fileDistribution(generator), CACHED_COLUMNS[columnDistribution(generator)] });
+	}
+
+	return lookups;
+}
+
+void PrintTime(const wchar_t *name, std::chrono::steady_clock::duration duration)
+{
+	double milliseconds = std::chrono::duration<double, std::milli>(duration).count();
+	wprintf(L"%-36ls %12.1f %16.1f\n", name, milliseconds,
+		std::chrono::duration<double, std::nano>(duration).count() / NUM_LOOKUPS);
+}
+
+// Looks up the value for each key and checks whether the expected number of values were found.
+void MeasureLookups(const wchar_t *name, ColumnValueCache &cache,
+	const std::vector<ColumnValueCache::Key> &keys, int expectedNumHits)
+{
+	int numHits = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (const auto &key : keys)
+	{
+		if (cache.MaybeGetValue(key))
+		{
+			numHits++;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if (numHits != expectedNumHits)
+	{
+		wprintf(L"%-36ls failed\n", name);
+		return;
+	}
+
+	PrintTime(name, end - start);
+}
+
+}
+
+void RunColumnValueCacheBenchmark()
+{
+	auto filePath =
+		std::filesystem::temp_directory_path() / L"ExplorerPlusPlusColumnValueCacheBenchmark.dat";
+	std::filesystem::remove(filePath);
+
+	wprintf(L"Column value cache (%d files, %zu columns each, %d lookups, in %ls)\n\n", NUM_FILES,
+		std::size(CACHED_COLUMNS), NUM_LOOKUPS, filePath.c_str());
+
+	auto files = GenerateFiles();
+	auto lookups = GenerateLookups();
+
+	std::vector<ColumnValueCache::Key> keys;
+	keys.reserve(lookups.size());
+
+	wprintf(L"%-36ls %12ls %16ls\n", L"Operation", L"Time (ms)", L"Per lookup (ns)");
+
+	// This is the part of each lookup that's performed before the cache is consulted.
+	auto start = std::chrono::steady_clock::now();
+
+	for (const auto &lookup : lookups)
+	{
+		const auto &file = files[lookup.fileIndex];
+		keys.push_back(ColumnValueCache::BuildKey(file.path, file.findData, lookup.columnType));
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	PrintTime(L"Building keys", end - start);
+
+	// The same files, each with a different modification time.
+	std::vector<ColumnValueCache::Key> staleKeys = keys;
+
+	for (auto &key : staleKeys)
+	{
+		key.lastWriteTime++;
+	}
+
+	{
+		ColumnValueCache cache(filePath, MAX_CACHE_SIZE);
+
+		for (int i = 0; i < NUM_FILES; i++)
+		{
+			for (auto columnType : CACHED_COLUMNS)
+			{
+				cache.SetValue(
+					ColumnValueCache::BuildKey(files[i].path, files[i].findData, columnType),
+					BuildColumnText(i, columnType));
+			}
+		}
+
+		MeasureLookups(L"Unsaved entries, hits", cache, keys, NUM_LOOKUPS);
+
+		if (!cache.Save())
+		{
+			wprintf(L"Couldn't save the cache to %ls\n", filePath.c_str());
+			std::filesystem::remove(filePath);
+			return;
+		}
+	}
+
+	{
+		// The entries are now all read from the mapped file.
+		ColumnValueCache cache(filePath, MAX_CACHE_SIZE);
+		MeasureLookups(L"Mapped entries, hits", cache, keys, NUM_LOOKUPS);
+		MeasureLookups(L"Mapped entries, misses", cache, staleKeys, 0);
+	}
+
+	std::filesystem::remove(filePath);
+}
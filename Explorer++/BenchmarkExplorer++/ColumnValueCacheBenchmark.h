@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Times lookups in a ColumnValueCache holding the version information columns for 20,000 files,
+// both before the entries have been saved and once they've been read back from the mapped cache
+// file (created in the temporary directory and removed afterwards). Also times building the keys
+// and looking up values that aren't cached. Writes the timings to stdout.
+void RunColumnValueCacheBenchmark();
@@ -0,0 +1,245 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "DirectoryChangeQueueBenchmark.h"
+#include "../Explorer++/ShellBrowser/DirectoryChangeQueue.h"
+#include <strsafe.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <thread>
+
+namespace
+{
+
+constexpr int PRODUCER_COUNTS[] = { 1, 2, 4, 8 };
+constexpr int NUM_CHANGES_PER_PRODUCER = 100'000;
+constexpr int NUM_NAMES = 1'000;
+
+// The queue is large enough to hold every change, so that nothing is dropped and the comparison
+// only reflects the cost of contention.
+constexpr size_t MAX_QUEUED_CHANGES = PRODUCER_COUNTS[std::size(PRODUCER_COUNTS) - 1]
+	* static_cast<size_t>(NUM_CHANGES_PER_PRODUCER);
+constexpr size_t MAX_QUEUED_NAME_CHARACTERS = MAX_QUEUED_CHANGES * 16;
+
+struct Result
+{
+	double durationMs;
+	double maxPushTimeUs;
+	size_t numProcessed;
+};
+
+// Stands in for the work done on the UI thread for each change (e.g. finding the affected item).
+size_t ProcessChange(DWORD action, const wchar_t *name, int folderId)
+{
+	return std::hash<std::wstring_view>()(name) ^ action ^ static_cast<size_t>(folderId);
+}
+
+// This is the approach that was previously used: each change was copied into a MAX_PATH buffer
+// and added to a list, with the UI thread holding the same lock while it applied the changes.
+class LockedChangeList
+{
+public:
+	LockedChangeList()
+	{
+		InitializeCriticalSection(&m_criticalSection);
+	}
+
+	~LockedChangeList()
+	{
+		DeleteCriticalSection(&m_criticalSection);
+	}
+
+	bool Push(DWORD action, const wchar_t *name, int folderId)
+	{
+		AlteredFile alteredFile;
+		StringCchCopy(alteredFile.fileName, std::size(alteredFile.fileName), name);
+		alteredFile.action = action;
+		alteredFile.folderId = folderId;
+
+		EnterCriticalSection(&m_criticalSection);
+		m_alteredFiles.push_back(alteredFile);
+		LeaveCriticalSection(&m_criticalSection);
+
+		return true;
+	}
+
+	size_t ProcessAll()
+	{
+		size_t numProcessed = 0;
+		size_t checksum = 0;
+
+		EnterCriticalSection(&m_criticalSection);
+
+		for (const auto &alteredFile : m_alteredFiles)
+		{
+			checksum += ProcessChange(alteredFile.action, alteredFile.fileName,
+				alteredFile.folderId);
+			numProcessed++;
+		}
+
+		m_alteredFiles.clear();
+
+		LeaveCriticalSection(&m_criticalSection);
+
+		m_checksum += checksum;
+
+		return numProcessed;
+	}
+
+private:
+	struct AlteredFile
+	{
+		wchar_t fileName[MAX_PATH];
+		DWORD action;
+		int folderId;
+	};
+
+	CRITICAL_SECTION m_criticalSection;
+	std::list<AlteredFile> m_alteredFiles;
+	size_t m_checksum = 0;
+};
+
+class QueueAdapter
+{
+public:
+	QueueAdapter() : m_queue(MAX_QUEUED_CHANGES, MAX_QUEUED_NAME_CHARACTERS)
+	{
+	}
+
+	bool Push(DWORD action, const wchar_t *name, int folderId)
+	{
+		return m_queue.Push(action, name, folderId);
+	}
+
+	size_t ProcessAll()
+	{
+		auto result = m_queue.Drain();
+		size_t checksum = 0;
+
+		for (const auto &change : result.changes)
+		{
+			checksum += ProcessChange(change.action, change.name.c_str(), change.folderId);
+		}
+
+		m_checksum += checksum;
+
+		return result.changes.size();
+	}
+
+private:
+	DirectoryChangeQueue m_queue;
+	size_t m_checksum = 0;
+};
+
+std::vector<std::wstring> GenerateNames()
+{
+	std::vector<std::wstring> names;
+
+	for (int i = 0; i < NUM_NAMES; i++)
+	{
+		names.push_back(L"document_" + std::to_wstring(i) + L".txt");
+	}
+
+	return names;
+}
+
+// Each producer pushes its changes as fast as it can, while the consumer repeatedly drains and
+// processes whatever has been queued, until every change has been processed.
+template <typename ChangeStore>
+Result RunProducers(int numProducers, const std::vector<std::wstring> &names)
+{
+	ChangeStore changeStore;
+	std::atomic<int64_t> maxPushTimeNs = 0;
+	std::atomic<size_t> numDropped = 0;
+	size_t numProcessed = 0;
+	size_t numChanges = static_cast<size_t>(numProducers) * NUM_CHANGES_PER_PRODUCER;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::jthread> producers;
+
+	for (int i = 0; i < numProducers; i++)
+	{
+		producers.emplace_back(
+			[&changeStore, &maxPushTimeNs, &numDropped, &names, i]
+			{
+				int64_t producerMaxPushTimeNs = 0;
+
+				for (int j = 0; j < NUM_CHANGES_PER_PRODUCER; j++)
+				{
+					auto pushStart = std::chrono::steady_clock::now();
+					bool pushed =
+						changeStore.Push(FILE_ACTION_MODIFIED, names[j % names.size()].c_str(), i);
+					auto pushEnd = std::chrono::steady_clock::now();
+
+					if (!pushed)
+					{
+						numDropped++;
+					}
+
+					producerMaxPushTimeNs = std::max<int64_t>(producerMaxPushTimeNs,
+						std::chrono::duration_cast<std::chrono::nanoseconds>(pushEnd - pushStart)
+							.count());
+				}
+
+				int64_t current = maxPushTimeNs.load();
+
+				while (current < producerMaxPushTimeNs
+					&& !maxPushTimeNs.compare_exchange_weak(current, producerMaxPushTimeNs))
+				{
+				}
+			});
+	}
+
+	// Any dropped changes will never be processed, so they're excluded here.
+	while (numProcessed + numDropped.load() < numChanges)
+	{
+		size_t numProcessedNow = changeStore.ProcessAll();
+
+		if (numProcessedNow == 0)
+		{
+			std::this_thread::yield();
+		}
+
+		numProcessed += numProcessedNow;
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	producers.clear();
+
+	return { std::chrono::duration<double, std::milli>(end - start).count(),
+		maxPushTimeNs.load() / 1000.0, numProcessed };
+}
+
+void PrintResult(int numProducers, const wchar_t *name, const Result &result)
+{
+	double changesPerSecond = result.numProcessed / (result.durationMs / 1000.0);
+
+	wprintf(L"%-10d %-24ls %16.2f %16.0f %16.2f\n", numProducers, name, result.durationMs,
+		changesPerSecond, result.maxPushTimeUs);
+}
+
+}
+
+void RunDirectoryChangeQueueBenchmark()
+{
+	auto names = GenerateNames();
+
+	wprintf(L"Directory change queue (%d changes per producer)\n\n", NUM_CHANGES_PER_PRODUCER);
+	wprintf(L"%-10ls %-24ls %16ls %16ls %16ls\n", L"Producers", L"Queue", L"Time (ms)",
+		L"Changes/s", L"Max push (us)");
+
+	for (int numProducers : PRODUCER_COUNTS)
+	{
+		PrintResult(numProducers, L"Locked list",
+			RunProducers<LockedChangeList>(numProducers, names));
+		PrintResult(numProducers, L"DirectoryChangeQueue",
+			RunProducers<QueueAdapter>(numProducers, names));
+	}
+}
@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Has several producer threads push directory changes concurrently, while a consumer thread drains
+// and processes them, using DirectoryChangeQueue and using the list guarded by a critical section
+// that was previously used. Writes the push throughput and the longest time taken by a single push
+// to stdout, for each number of producers.
+void RunDirectoryChangeQueueBenchmark();
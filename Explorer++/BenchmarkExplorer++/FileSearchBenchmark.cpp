@@ -0,0 +1,277 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "FileSearchBenchmark.h"
+#include "../Explorer++/ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/FileSearcher.h"
+#include "../Helper/WildcardPattern.h"
+#include <wil/common.h>
+#include <wil/resource.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <regex>
+#include <thread>
+
+namespace
+{
+
+// 50 top-level folders, each containing 20 subfolders of 200 files, for a total of 200,000 files
+// in 1,050 folders.
+constexpr int NUM_TOP_LEVEL_FOLDERS = 50;
+constexpr int NUM_SUBFOLDERS = 20;
+constexpr int NUM_FILES_PER_FOLDER = 200;
+constexpr int TOTAL_NUM_FILES = NUM_TOP_LEVEL_FOLDERS * NUM_SUBFOLDERS * NUM_FILES_PER_FOLDER;
+
+const wchar_t *const FILE_EXTENSIONS[] = { L".txt", L".log", L".png", L".cpp" };
+
+// Every fourth file has a .txt extension, so both patterns below match the same quarter of the
+// files.
+constexpr int EXPECTED_NUM_MATCHES = TOTAL_NUM_FILES / 4;
+const wchar_t WILDCARD_PATTERN[] = L"*.txt";
+const wchar_t REGULAR_EXPRESSION_PATTERN[] = L"report_[0-9]+\\.txt";
+
+const wchar_t *GetFileExtension(int index)
+{
+	return FILE_EXTENSIONS[index % std::size(FILE_EXTENSIONS)];
+}
+
+bool CreateTree(const std::filesystem::path &root)
+{
+	std::error_code error;
+
+	for (int i = 0; i < NUM_TOP_LEVEL_FOLDERS; i++)
+	{
+		for (int j = 0; j < NUM_SUBFOLDERS; j++)
+		{
+			auto folder = root / std::to_wstring(i) / std::to_wstring(j);
+			std::filesystem::create_directories(folder, error);
+
+			if (error)
+			{
+				return false;
+			}
+
+			for (int k = 0; k < NUM_FILES_PER_FOLDER; k++)
+			{
+				auto path = folder / (L"report_" + std::to_wstring(k) + GetFileExtension(k));
+				std::ofstream file(path, std::ios::binary);
+
+				if (!file)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+// This is the approach that was previously used: a serial, recursive search, with each name
+// matched by the supplied function.
+void SearchSerially(const std::wstring &folder,
+	const std::function<bool(const std::wstring &name)> &matchFunction, int &numMatches)
+{
+	WIN32_FIND_DATA findData;
+	wil::unique_hfind findHandle(FindFirstFile((folder + L"\\*").c_str(), &findData));
+
+	if (!findHandle)
+	{
+		return;
+	}
+
+	do
+	{
+		std::wstring name = findData.cFileName;
+
+		if (name == L"." || name == L"..")
+		{
+			continue;
+		}
+
+		if (matchFunction(name))
+		{
+			numMatches++;
+		}
+
+		if (WI_IsFlagSet(findData.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY))
+		{
+			SearchSerially(folder + L"\\" + name, matchFunction, numMatches);
+		}
+	} while (FindNextFile(findHandle.get(), &findData));
+}
+
+void MeasureSearch(const wchar_t *name, std::function<int()> searchFunction)
+{
+	auto start = std::chrono::steady_clock::now();
+	int numMatches = searchFunction();
+	auto end = std::chrono::steady_clock::now();
+
+	if (numMatches != EXPECTED_NUM_MATCHES)
+	{
+		wprintf(L"%-36ls failed\n", name);
+		return;
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	wprintf(L"%-36ls %12.1f\n", name, milliseconds);
+}
+
+int SearchUsingFileSearcher(const std::wstring &directory, const std::wstring &pattern,
+	FileSearcher::PatternSyntax syntax, BackgroundWorkPool *workPool, unsigned int numWorkers)
+{
+	FileSearcher::Criteria criteria;
+	criteria.pattern = pattern;
+	criteria.syntax = syntax;
+
+	FileSearcher searcher(criteria, workPool, numWorkers);
+	auto summary = searcher.Search(directory, [](FileSearcher::Batch) {});
+
+	if (!summary)
+	{
+		return 0;
+	}
+
+	return summary->numFilesFound;
+}
+
+// Times the name matching alone, so that the difference between the two regular expression engines
+// isn't hidden by the cost of enumerating the files.
+void RunRegularExpressionBenchmark()
+{
+	constexpr int NUM_NAMES = 1000000;
+
+	std::vector<std::wstring> names;
+	names.reserve(NUM_NAMES);
+
+	for (int i = 0; i < NUM_NAMES; i++)
+	{
+		names.push_back(L"report_" + std::to_wstring(i) + GetFileExtension(i));
+	}
+
+	std::wregex standardRegex(REGULAR_EXPRESSION_PATTERN, std::regex_constants::icase);
+	boost::wregex boostRegex(REGULAR_EXPRESSION_PATTERN, boost::regex::perl | boost::regex::icase);
+
+	auto measure = [&names](const wchar_t *name, auto matchFunction)
+	{
+		auto start = std::chrono::steady_clock::now();
+		int numMatches = 0;
+
+		for (const auto &currentName : names)
+		{
+			if (matchFunction(currentName))
+			{
+				numMatches++;
+			}
+		}
+
+		auto end = std::chrono::steady_clock::now();
+
+		if (numMatches != NUM_NAMES / 4)
+		{
+			wprintf(L"%-36ls failed\n", name);
+			return;
+		}
+
+		double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		wprintf(L"%-36ls %12.1f\n", name, milliseconds);
+	};
+
+	wprintf(L"\nMatching %d names\n\n", NUM_NAMES);
+	wprintf(L"%-36ls %12ls\n", L"Engine", L"Time (ms)");
+
+	measure(L"std::wregex", [&standardRegex](const std::wstring &name)
+		{ return std::regex_match(name, standardRegex); });
+	measure(L"boost::wregex", [&boostRegex](const std::wstring &name)
+		{ return boost::regex_match(name, boostRegex); });
+}
+
+}
+
+void RunFileSearchBenchmark()
+{
+	auto directory =
+		std::filesystem::temp_directory_path() / L"ExplorerPlusPlusFileSearchBenchmark";
+	std::filesystem::remove_all(directory);
+
+	wprintf(L"File search (%d files, in %ls)\n\n", TOTAL_NUM_FILES, directory.c_str());
+
+	if (!CreateTree(directory))
+	{
+		wprintf(L"Couldn't create the tree in %ls\n", directory.c_str());
+		std::filesystem::remove_all(directory);
+		return;
+	}
+
+	std::wstring directoryString = directory.wstring();
+
+	WildcardPattern wildcardPattern(WILDCARD_PATTERN, false);
+	std::wregex regex(REGULAR_EXPRESSION_PATTERN, std::regex_constants::icase);
+
+	auto searchSeriallyUsingWildcard = [&directoryString, &wildcardPattern]
+	{
+		int numMatches = 0;
+		SearchSerially(directoryString,
+			[&wildcardPattern](const std::wstring &name) { return wildcardPattern.Matches(name); },
+			numMatches);
+		return numMatches;
+	};
+
+	auto searchSeriallyUsingRegex = [&directoryString, &regex]
+	{
+		int numMatches = 0;
+		SearchSerially(directoryString,
+			[&regex](const std::wstring &name) { return std::regex_match(name, regex); },
+			numMatches);
+		return numMatches;
+	};
+
+	auto executor = std::make_shared<ComStaThreadPoolExecutor>(
+		std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+	BackgroundWorkPool workPool(executor);
+
+	auto searchUsingWildcard = [&directoryString, &workPool](unsigned int numWorkers)
+	{
+		return [&directoryString, &workPool, numWorkers]
+		{
+			return SearchUsingFileSearcher(directoryString, WILDCARD_PATTERN,
+				FileSearcher::PatternSyntax::Wildcard, &workPool, numWorkers);
+		};
+	};
+
+	auto searchUsingRegex = [&directoryString, &workPool](unsigned int numWorkers)
+	{
+		return [&directoryString, &workPool, numWorkers]
+		{
+			return SearchUsingFileSearcher(directoryString, REGULAR_EXPRESSION_PATTERN,
+				FileSearcher::PatternSyntax::RegularExpression, &workPool, numWorkers);
+		};
+	};
+
+	// As with the folder size benchmark, the tree has just been created, so its metadata is likely
+	// to be cached and the results reflect the cost of the search itself.
+	wprintf(L"%-36ls %12ls\n", L"Method", L"Time (ms)");
+
+	for (int i = 0; i < 2; i++)
+	{
+		MeasureSearch(L"Serial, wildcard", searchSeriallyUsingWildcard);
+		MeasureSearch(L"Serial, std::wregex", searchSeriallyUsingRegex);
+		MeasureSearch(L"FileSearcher, wildcard, 1 worker", searchUsingWildcard(1));
+		MeasureSearch(L"FileSearcher, wildcard, 4 workers", searchUsingWildcard(4));
+		MeasureSearch(L"FileSearcher, regex, 1 worker", searchUsingRegex(1));
+		MeasureSearch(L"FileSearcher, regex, 4 workers", searchUsingRegex(4));
+	}
+
+	executor->shutdown();
+
+	std::filesystem::remove_all(directory);
+
+	RunRegularExpressionBenchmark();
+}
@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Searches a synthetic tree of 200,000 files (created in the temporary directory and removed
+// afterwards) using FileSearcher, with wildcard and regular expression patterns and with different
+// numbers of workers, and compares that with the serial search that was previously used. Also
+// times std::wregex against boost::wregex when matching names alone. Writes the timings to stdout.
+void RunFileSearchBenchmark();
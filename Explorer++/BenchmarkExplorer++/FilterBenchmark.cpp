@@ -0,0 +1,238 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "FilterBenchmark.h"
+#include "../Explorer++/ShellBrowser/ListViewItemModel.h"
+#include "../Explorer++/ShellBrowser/SelectionTracker.h"
+#include "../Helper/WildcardPattern.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+
+constexpr int NUM_ITEMS = 100'000;
+
+// The per-keystroke budget for filtering as you type, which corresponds to a single frame at 60Hz.
+constexpr double KEYSTROKE_BUDGET_MILLISECONDS = 16;
+
+const wchar_t *const NAME_WORDS[] = { L"notes", L"report", L"summary", L"invoice", L"photo",
+	L"backup", L"draft", L"meeting", L"budget", L"plan", L"annual", L"note" };
+const wchar_t *const FILE_EXTENSIONS[] = { L".txt", L".docx", L".jpg", L".pdf" };
+
+// The filter as it's typed and then deleted. Characters are typed in front of the trailing '*',
+// so each keystroke narrows the filter, until the characters are deleted again.
+const wchar_t *const FILTERS[] = { L"*", L"*n*", L"*no*", L"*not*", L"*note*", L"*notes*",
+	L"*note*", L"*not*", L"*no*", L"*n*", L"*" };
+
+std::vector<std::wstring> GenerateNames()
+{
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<size_t> wordDistribution(0, std::size(NAME_WORDS) - 1);
+	std::uniform_int_distribution<size_t> extensionDistribution(0, std::size(FILE_EXTENSIONS) - 1);
+
+	std::vector<std::wstring> names;
+	names.reserve(NUM_ITEMS);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		names.push_back(std::wstring(NAME_WORDS[wordDistribution(generator)]) + L" "
+			+ NAME_WORDS[wordDistribution(generator)] + L" " + std::to_wstring(i)
+			+ FILE_EXTENSIONS[extensionDistribution(generator)]);
+	}
+
+	return names;
+}
+
+// The items in a folder, sorted by name, with the visible items held in a ListViewItemModel. The
+// filtering mirrors what ShellBrowserImpl does for a virtual listview.
+class FilteredFolder
+{
+public:
+	explicit FilteredFolder(const std::vector<std::wstring> &names) :
+		m_names(names),
+		m_model(&m_selectionTracker)
+	{
+		std::vector<int> internalIndexes(m_names.size());
+		std::iota(internalIndexes.begin(), internalIndexes.end(), 0);
+		RestoreItems(std::move(internalIndexes));
+	}
+
+	// Equivalent to ShellBrowserImpl::SetFilterText().
+	void SetFilterIncrementally(const std::wstring &filter)
+	{
+		bool filterNarrowed = WildcardPattern::IsSubsetOf(filter, m_filter);
+		SetFilter(filter);
+
+		std::vector<int> itemsToRestore;
+
+		if (!filterNarrowed)
+		{
+			for (int internalIndex : m_filteredItems)
+			{
+				if (m_filterPattern.Matches(m_names[internalIndex]))
+				{
+					itemsToRestore.push_back(internalIndex);
+				}
+			}
+		}
+
+		RemoveFilteredItems();
+
+		for (int internalIndex : itemsToRestore)
+		{
+			m_filteredItems.erase(internalIndex);
+		}
+
+		RestoreItems(std::move(itemsToRestore));
+	}
+
+	// Restores every filtered item and then filters the full set of items again, which is what
+	// was previously done whenever the filter changed.
+	void SetFilterFully(const std::wstring &filter)
+	{
+		SetFilter(filter);
+
+		std::vector<int> itemsToRestore(m_filteredItems.begin(), m_filteredItems.end());
+		m_filteredItems.clear();
+		RestoreItems(std::move(itemsToRestore));
+
+		RemoveFilteredItems();
+	}
+
+	int GetNumVisibleItems() const
+	{
+		return m_model.GetCount();
+	}
+
+private:
+	void SetFilter(const std::wstring &filter)
+	{
+		m_filter = filter;
+		m_filterPattern = WildcardPattern(m_filter, false);
+	}
+
+	int CompareItems(int internalIndex1, int internalIndex2) const
+	{
+		return m_names[internalIndex1].compare(m_names[internalIndex2]);
+	}
+
+	void RemoveFilteredItems()
+	{
+		std::unordered_set<int> itemsToRemove;
+
+		for (int i = 0; i < m_model.GetCount(); i++)
+		{
+			int internalIndex = m_model.GetInternalIndexAt(i);
+
+			if (!m_filterPattern.Matches(m_names[internalIndex]))
+			{
+				m_selectionTracker.RemoveItem(internalIndex);
+				m_filteredItems.insert(internalIndex);
+				itemsToRemove.insert(internalIndex);
+			}
+		}
+
+		m_model.RemoveItems(itemsToRemove);
+	}
+
+	// Equivalent to ShellBrowserImpl::QueueItemsForSortedInsertion(), followed by the insertion of
+	// the queued items.
+	void RestoreItems(std::vector<int> internalIndexes)
+	{
+		std::sort(internalIndexes.begin(), internalIndexes.end(),
+			[this](int internalIndex1, int internalIndex2)
+			{ return CompareItems(internalIndex1, internalIndex2) < 0; });
+
+		std::vector<std::pair<int, int>> items;
+		items.reserve(internalIndexes.size());
+
+		int currentItem = 0;
+
+		for (int internalIndex : internalIndexes)
+		{
+			int count = m_model.GetCount() - currentItem;
+
+			while (count > 0)
+			{
+				int step = count / 2;
+				int middle = currentItem + step;
+
+				if (CompareItems(internalIndex, m_model.GetInternalIndexAt(middle)) > 0)
+				{
+					currentItem = middle + 1;
+					count -= step + 1;
+				}
+				else
+				{
+					count = step;
+				}
+			}
+
+			items.emplace_back(internalIndex, currentItem + static_cast<int>(items.size()));
+			m_selectionTracker.AddItem(internalIndex, false, 0);
+		}
+
+		m_model.InsertItems(items);
+	}
+
+	const std::vector<std::wstring> &m_names;
+	SelectionTracker m_selectionTracker;
+	ListViewItemModel m_model;
+	std::unordered_set<int> m_filteredItems;
+	std::wstring m_filter = L"*";
+	WildcardPattern m_filterPattern = WildcardPattern(L"*", false);
+};
+
+template <typename Function>
+double MeasureMilliseconds(Function function)
+{
+	auto start = std::chrono::steady_clock::now();
+	function();
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}
+
+void RunFilterBenchmark()
+{
+	wprintf(L"Filtering as you type (%d items, %.0f ms budget per keystroke)\n\n", NUM_ITEMS,
+		KEYSTROKE_BUDGET_MILLISECONDS);
+	wprintf(L"%-12ls %12ls %18ls %18ls\n", L"Filter", L"Visible", L"Incremental (ms)",
+		L"Full (ms)");
+
+	auto names = GenerateNames();
+	FilteredFolder incrementalFolder(names);
+	FilteredFolder fullFolder(names);
+
+	double maxIncrementalTime = 0;
+
+	for (auto filter : FILTERS)
+	{
+		double incrementalTime =
+			MeasureMilliseconds([&] { incrementalFolder.SetFilterIncrementally(filter); });
+		double fullTime = MeasureMilliseconds([&] { fullFolder.SetFilterFully(filter); });
+
+		if (incrementalFolder.GetNumVisibleItems() != fullFolder.GetNumVisibleItems())
+		{
+			wprintf(L"%-12ls failed\n", filter);
+			return;
+		}
+
+		wprintf(L"%-12ls %12d %18.2f %18.2f\n", filter, incrementalFolder.GetNumVisibleItems(),
+			incrementalTime, fullTime);
+
+		maxIncrementalTime = std::max(maxIncrementalTime, incrementalTime);
+	}
+
+	wprintf(L"\nSlowest incremental keystroke: %.2f ms (%ls budget)\n", maxIncrementalTime,
+		(maxIncrementalTime <= KEYSTROKE_BUDGET_MILLISECONDS) ? L"within" : L"over");
+}
@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Simulates a filter being typed (and then deleted) in a folder of 100,000 items displayed in a
+// virtual listview. Each change to the filter is applied incrementally, so that only the items
+// whose visibility changes are removed or restored, and by restoring every item and then filtering
+// again, as was previously done. Writes the time taken for each keystroke to stdout.
+void RunFilterBenchmark();
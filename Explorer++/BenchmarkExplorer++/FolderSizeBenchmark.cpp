@@ -0,0 +1,175 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "FolderSizeBenchmark.h"
+#include "../Helper/FolderSize.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+namespace
+{
+
+// 100 top-level folders, each containing 10 subfolders of 1,000 files, for a total of 1,000,000
+// files in 1,100 folders.
+constexpr int NUM_TOP_LEVEL_FOLDERS = 100;
+constexpr int NUM_SUBFOLDERS = 10;
+constexpr int NUM_FILES_PER_FOLDER = 1000;
+constexpr int TOTAL_NUM_FILES = NUM_TOP_LEVEL_FOLDERS * NUM_SUBFOLDERS * NUM_FILES_PER_FOLDER;
+
+bool CreateTree(const std::filesystem::path &root)
+{
+	std::error_code error;
+
+	for (int i = 0; i < NUM_TOP_LEVEL_FOLDERS; i++)
+	{
+		for (int j = 0; j < NUM_SUBFOLDERS; j++)
+		{
+			auto folder = root / std::to_wstring(i) / std::to_wstring(j);
+			std::filesystem::create_directories(folder, error);
+
+			if (error)
+			{
+				return false;
+			}
+
+			for (int k = 0; k < NUM_FILES_PER_FOLDER; k++)
+			{
+				auto path = folder / std::to_wstring(k);
+				std::ofstream file(path, std::ios::binary);
+
+				if (!file)
+				{
+					return false;
+				}
+
+				file.close();
+
+				// The files are extended, rather than written, so that creating the tree is
+				// relatively quick and doesn't require a large amount of space.
+				std::filesystem::resize_file(path, static_cast<std::uintmax_t>(k) * 17, error);
+
+				if (error)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+// This is the approach that was previously used: a serial, recursive walk, with a separate
+// request made to retrieve the size of each file.
+FolderInfo GetFolderInfoSerially(const std::filesystem::path &path)
+{
+	FolderInfo folderInfo = {};
+	std::error_code error;
+
+	for (const auto &entry : std::filesystem::directory_iterator(path, error))
+	{
+		std::error_code typeErrorCode;
+		auto isDirectory = entry.is_directory(typeErrorCode);
+
+		if (typeErrorCode)
+		{
+			continue;
+		}
+
+		if (isDirectory)
+		{
+			folderInfo.numFolders++;
+
+			FolderInfo subFolderInfo = GetFolderInfoSerially(entry.path());
+
+			folderInfo.size += subFolderInfo.size;
+			folderInfo.numFolders += subFolderInfo.numFolders;
+			folderInfo.numFiles += subFolderInfo.numFiles;
+		}
+		else
+		{
+			std::error_code sizeErrorCode;
+			const auto size = std::filesystem::file_size(entry.path(), sizeErrorCode);
+
+			if (!sizeErrorCode)
+			{
+				folderInfo.size += size;
+				folderInfo.numFiles++;
+			}
+		}
+	}
+
+	return folderInfo;
+}
+
+void MeasureWalk(const wchar_t *name, std::function<std::optional<FolderInfo>()> walkFunction)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto folderInfo = walkFunction();
+	auto end = std::chrono::steady_clock::now();
+
+	if (!folderInfo || folderInfo->numFiles != TOTAL_NUM_FILES)
+	{
+		wprintf(L"%-32ls failed\n", name);
+		return;
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	wprintf(L"%-32ls %12.1f\n", name, milliseconds);
+}
+
+}
+
+void RunFolderSizeBenchmark()
+{
+	auto directory =
+		std::filesystem::temp_directory_path() / L"ExplorerPlusPlusFolderSizeBenchmark";
+	std::filesystem::remove_all(directory);
+
+	wprintf(L"Folder size (%d files, in %ls)\n\n", TOTAL_NUM_FILES, directory.c_str());
+
+	if (!CreateTree(directory))
+	{
+		wprintf(L"Couldn't create the tree in %ls\n", directory.c_str());
+		std::filesystem::remove_all(directory);
+		return;
+	}
+
+	auto walkSerially = [&directory]
+	{ return std::optional<FolderInfo>(GetFolderInfoSerially(directory)); };
+
+	auto walkUsingSingleThread = [&directory]
+	{ return FolderSizeCalculator(nullptr, 1).Calculate(directory); };
+
+	auto walkUsingMultipleThreads = [&directory]
+	{ return FolderSizeCalculator().Calculate(directory); };
+
+	FolderSizeCache cache;
+	FolderSizeCalculator cachedCalculator(&cache);
+
+	// The cache is populated before the timed runs, so this measures the case where nothing has
+	// changed since the last calculation.
+	cachedCalculator.Calculate(directory);
+
+	auto walkUsingCache = [&directory, &cachedCalculator]
+	{ return cachedCalculator.Calculate(directory); };
+
+	// The tree has just been created, so its metadata is likely to be cached by the file system
+	// for every run. The results therefore reflect the cost of the walk itself, rather than the
+	// cost of reading from the disk.
+	wprintf(L"%-32ls %12ls\n", L"Method", L"Time (ms)");
+
+	for (int i = 0; i < 2; i++)
+	{
+		MeasureWalk(L"Serial walk", walkSerially);
+		MeasureWalk(L"Calculator, 1 thread", walkUsingSingleThread);
+		MeasureWalk(L"Calculator, 4 threads", walkUsingMultipleThreads);
+		MeasureWalk(L"Calculator, 4 threads, cached", walkUsingCache);
+	}
+
+	std::filesystem::remove_all(directory);
+}
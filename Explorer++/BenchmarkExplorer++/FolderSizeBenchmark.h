@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Calculates the size of a synthetic tree of a million files (created in the temporary directory
+// and removed afterwards) using FolderSizeCalculator, with and without a cache and with different
+// numbers of threads, and compares that with the serial walk that was previously used. Writes the
+// timings to stdout.
+void RunFolderSizeBenchmark();
@@ -0,0 +1,272 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "GroupingBenchmark.h"
+#include "../Explorer++/ComStaThreadPoolExecutor.h"
+#include "../Explorer++/ShellBrowser/FolderSettings.h"
+#include "../Explorer++/ShellBrowser/GroupDataRetrieval.h"
+#include "../Explorer++/ShellBrowser/ItemData.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include <strsafe.h>
+#include <wil/com.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <optional>
+#include <thread>
+
+namespace
+{
+
+// The top-level folder contains 2,000 files, plus 20 subfolders of 50 files each. The subfolders
+// are included so that the total size mode has folders to calculate the size of.
+constexpr int NUM_FILES = 2'000;
+constexpr int NUM_SUBFOLDERS = 20;
+constexpr int NUM_FILES_PER_SUBFOLDER = 50;
+
+// Matches ShellBrowserImpl::GROUPING_CHUNK_SIZE.
+constexpr size_t GROUPING_CHUNK_SIZE = 256;
+
+const wchar_t *const FILE_EXTENSIONS[] = { L".txt", L".log", L".dll", L".jpg", L".docx" };
+
+// Each mode here can be selected from the "Group by" menu for a filesystem folder.
+const SortMode GROUP_MODES[] = { SortMode::Name, SortMode::Type, SortMode::Size,
+	SortMode::DateModified, SortMode::Created, SortMode::Accessed, SortMode::Attributes,
+	SortMode::Extension, SortMode::TotalSize, SortMode::FreeSpace, SortMode::Owner,
+	SortMode::ProductName, SortMode::Company, SortMode::Description, SortMode::FileVersion,
+	SortMode::ProductVersion, SortMode::Title, SortMode::Subject, SortMode::Authors,
+	SortMode::Keywords, SortMode::Comments, SortMode::CameraModel, SortMode::DateTaken,
+	SortMode::Width, SortMode::Height, SortMode::FileSystem };
+
+using GroupNames = std::vector<std::optional<std::wstring>>;
+
+bool CreateFiles(const std::filesystem::path &folder, int numFiles)
+{
+	for (int i = 0; i < numFiles; i++)
+	{
+		auto path = folder
+			/ (L"item" + std::to_wstring(i) + FILE_EXTENSIONS[i % std::size(FILE_EXTENSIONS)]);
+		std::ofstream file(path, std::ios::binary);
+
+		if (!file)
+		{
+			return false;
+		}
+
+		// This spreads the files across the empty, tiny and small size groups.
+		file << std::string((i % 3) * 10'000, 'x');
+	}
+
+	return true;
+}
+
+bool CreateFolder(const std::filesystem::path &root)
+{
+	std::error_code error;
+	std::filesystem::create_directories(root, error);
+
+	if (error || !CreateFiles(root, NUM_FILES))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < NUM_SUBFOLDERS; i++)
+	{
+		auto subfolder = root / (L"folder" + std::to_wstring(i));
+		std::filesystem::create_directory(subfolder, error);
+
+		if (error || !CreateFiles(subfolder, NUM_FILES_PER_SUBFOLDER))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Builds the item information in the same way as it's built for a listview item, by parsing the
+// item's path and retrieving its find data.
+std::vector<BasicItemInfo_t> RetrieveItems(const std::filesystem::path &folder)
+{
+	std::vector<BasicItemInfo_t> items;
+
+	WIN32_FIND_DATA findData;
+	wil::unique_hfind findHandle(FindFirstFile((folder / L"*").c_str(), &findData));
+
+	if (!findHandle)
+	{
+		return items;
+	}
+
+	do
+	{
+		if (lstrcmp(findData.cFileName, L".") == 0 || lstrcmp(findData.cFileName, L"..") == 0)
+		{
+			continue;
+		}
+
+		auto path = folder / findData.cFileName;
+		unique_pidl_absolute pidl;
+		HRESULT hr = SHParseDisplayName(path.c_str(), nullptr, wil::out_param(pidl), 0, nullptr);
+
+		if (FAILED(hr))
+		{
+			continue;
+		}
+
+		BasicItemInfo_t &item = items.emplace_back();
+		item.pridl.reset(ILCloneChild(ILFindLastID(pidl.get())));
+		item.pidlComplete = std::move(pidl);
+		item.wfd = findData;
+		item.isFindDataValid = true;
+		StringCchCopy(item.szDisplayName, std::size(item.szDisplayName), findData.cFileName);
+		item.isRoot = false;
+	} while (FindNextFile(findHandle.get(), &findData));
+
+	return items;
+}
+
+std::optional<std::wstring> DetermineGroupName(const BasicItemInfo_t &item, SortMode groupMode,
+	const GlobalFolderSettings &globalFolderSettings)
+{
+	auto groupInfo = DetermineItemGroupInfo(item, groupMode, GetModuleHandle(nullptr),
+		globalFolderSettings, nullptr);
+
+	if (!groupInfo)
+	{
+		return std::nullopt;
+	}
+
+	return groupInfo->name;
+}
+
+GroupNames GroupSerially(const std::vector<BasicItemInfo_t> &items, SortMode groupMode,
+	const GlobalFolderSettings &globalFolderSettings)
+{
+	GroupNames groupNames;
+	groupNames.reserve(items.size());
+
+	for (const auto &item : items)
+	{
+		groupNames.push_back(DetermineGroupName(item, groupMode, globalFolderSettings));
+	}
+
+	return groupNames;
+}
+
+// Each chunk receives its own copy of the item information, as is done when queuing a grouping
+// task.
+GroupNames GroupInChunks(const std::vector<BasicItemInfo_t> &items, SortMode groupMode,
+	const GlobalFolderSettings &globalFolderSettings, TaskGroup &taskGroup)
+{
+	std::vector<std::future<GroupNames>> futures;
+
+	for (size_t start = 0; start < items.size(); start += GROUPING_CHUNK_SIZE)
+	{
+		size_t end = std::min(start + GROUPING_CHUNK_SIZE, items.size());
+		std::vector<BasicItemInfo_t> chunk(items.begin() + start, items.begin() + end);
+
+		futures.push_back(taskGroup.Push(
+			[groupMode, &globalFolderSettings, chunk = std::move(chunk)]
+			{ return GroupSerially(chunk, groupMode, globalFolderSettings); }));
+	}
+
+	GroupNames groupNames;
+	groupNames.reserve(items.size());
+
+	for (auto &future : futures)
+	{
+		auto chunkGroupNames = future.get();
+		groupNames.insert(groupNames.end(), chunkGroupNames.begin(), chunkGroupNames.end());
+	}
+
+	return groupNames;
+}
+
+// Regrouping determines the groups for the fast modes on the UI thread. The modes that are backed
+// by a column reuse the text retrieved for that column, while the remaining slow modes are handled
+// on the background work pool.
+const wchar_t *GetGroupingLocation(SortMode groupMode)
+{
+	if (GetGroupModeColumn(groupMode))
+	{
+		return L"Column threads";
+	}
+	else if (IsSlowGroupMode(groupMode))
+	{
+		return L"Work pool";
+	}
+
+	return L"UI thread";
+}
+
+template <typename Function>
+std::pair<double, GroupNames> MeasureGrouping(Function function)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto groupNames = function();
+	auto end = std::chrono::steady_clock::now();
+
+	return { std::chrono::duration<double, std::milli>(end - start).count(),
+		std::move(groupNames) };
+}
+
+}
+
+void RunGroupingBenchmark()
+{
+	// The shell functions used to parse the items and retrieve their properties require COM.
+	auto comInitialization = wil::CoInitializeEx_failfast(COINIT_APARTMENTTHREADED);
+
+	auto folder = std::filesystem::temp_directory_path() / L"ExplorerPlusPlusGroupingBenchmark";
+	std::filesystem::remove_all(folder);
+
+	if (!CreateFolder(folder))
+	{
+		wprintf(L"Couldn't create the files in %ls\n", folder.c_str());
+		std::filesystem::remove_all(folder);
+		return;
+	}
+
+	auto items = RetrieveItems(folder);
+	int numThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	wprintf(L"Grouping (%zu items, in %ls, %d threads)\n\n", items.size(), folder.c_str(),
+		numThreads);
+	wprintf(L"%-16ls %-16ls %16ls %16ls\n", L"Group mode", L"Handled on", L"Serial (ms)",
+		L"Chunked (ms)");
+
+	auto executor = std::make_shared<ComStaThreadPoolExecutor>(numThreads);
+
+	{
+		BackgroundWorkPool workPool(executor);
+		TaskGroup taskGroup(&workPool);
+		GlobalFolderSettings globalFolderSettings;
+
+		for (auto groupMode : GROUP_MODES)
+		{
+			auto [serialTime, serialGroupNames] = MeasureGrouping(
+				[&] { return GroupSerially(items, groupMode, globalFolderSettings); });
+			auto [chunkedTime, chunkedGroupNames] = MeasureGrouping(
+				[&]
+				{ return GroupInChunks(items, groupMode, globalFolderSettings, taskGroup); });
+
+			if (chunkedGroupNames != serialGroupNames)
+			{
+				wprintf(L"%-16hs failed\n", groupMode._to_string());
+				continue;
+			}
+
+			wprintf(L"%-16hs %-16ls %16.2f %16.2f\n", groupMode._to_string(),
+				GetGroupingLocation(groupMode), serialTime, chunkedTime);
+		}
+	}
+
+	executor->shutdown();
+
+	std::filesystem::remove_all(folder);
+}
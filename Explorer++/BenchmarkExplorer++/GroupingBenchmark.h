@@ -0,0 +1,12 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Measures the time taken to determine the groups for the items in a folder of real files, in each
+// of the group modes. The production grouping code (DetermineItemGroupInfo()) is called for every
+// item, both serially on the calling thread and in chunks on a BackgroundWorkPool. The modes that
+// query the file itself (e.g. the version information and document properties) are included. Also
+// reports where each mode is handled when regrouping. Writes the results to stdout.
+void RunGroupingBenchmark();
@@ -0,0 +1,257 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ItemNameIndexBenchmark.h"
+#include "../Explorer++/ShellBrowser/ItemNameIndex.h"
+#include <array>
+#include <cstdio>
+#include <numeric>
+#include <optional>
+#include <random>
+
+namespace
+{
+
+constexpr int NUM_ITEMS = 100'000;
+constexpr int NUM_CHANGES = 10'000;
+
+enum class ChangeType
+{
+	Added,
+	Removed,
+	Modified,
+	Renamed
+};
+
+constexpr size_t NUM_CHANGE_TYPES = 4;
+
+struct Change
+{
+	ChangeType type;
+
+	// The item the change is expected to apply to. For additions, this is the internal index the
+	// new item should be given.
+	int internalIndex;
+
+	std::wstring parsingName;
+
+	// Only set for renames.
+	std::wstring newParsingName;
+};
+
+// Holds the parsing name of each item, indexed by internal index, in place of the item data that
+// would be compared in the application. Removed items are left with an empty name.
+struct Folder
+{
+	ItemNameIndex index;
+	std::vector<std::wstring> parsingNames;
+};
+
+std::wstring BuildParsingName(const wchar_t *prefix, int number)
+{
+	return L"C:\\Users\\Benchmark\\Documents\\" + std::wstring(prefix) + std::to_wstring(number)
+		+ L".txt";
+}
+
+void AddItem(Folder &folder, int internalIndex, const std::wstring &parsingName)
+{
+	if (static_cast<size_t>(internalIndex) >= folder.parsingNames.size())
+	{
+		folder.parsingNames.resize(internalIndex + 1);
+	}
+
+	folder.parsingNames[internalIndex] = parsingName;
+	folder.index.AddItem(internalIndex, parsingName);
+}
+
+void RemoveItem(Folder &folder, int internalIndex)
+{
+	folder.parsingNames[internalIndex].clear();
+	folder.index.RemoveItem(internalIndex);
+}
+
+Folder BuildFolder()
+{
+	Folder folder;
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		AddItem(folder, i, BuildParsingName(L"file_", i));
+	}
+
+	return folder;
+}
+
+// The changes are generated by simulating the set of items in the folder, so that each removal,
+// modification or rename refers to an item that will exist at that point in the replay.
+std::vector<Change> GenerateChanges()
+{
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<int> typeDistribution(0, NUM_CHANGE_TYPES - 1);
+
+	std::vector<int> liveItems(NUM_ITEMS);
+	std::iota(liveItems.begin(), liveItems.end(), 0);
+
+	std::vector<std::wstring> parsingNames;
+	parsingNames.reserve(NUM_ITEMS + NUM_CHANGES);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		parsingNames.push_back(BuildParsingName(L"file_", i));
+	}
+
+	std::vector<Change> changes;
+	changes.reserve(NUM_CHANGES);
+
+	for (int i = 0; i < NUM_CHANGES; i++)
+	{
+		auto type = static_cast<ChangeType>(typeDistribution(generator));
+
+		if (type == ChangeType::Added)
+		{
+			int internalIndex = static_cast<int>(parsingNames.size());
+			parsingNames.push_back(BuildParsingName(L"new_", i));
+			liveItems.push_back(internalIndex);
+			changes.push_back({ type, internalIndex, parsingNames.back(), L"" });
+			continue;
+		}
+
+		std::uniform_int_distribution<size_t> itemDistribution(0, liveItems.size() - 1);
+		size_t liveItemIndex = itemDistribution(generator);
+		int internalIndex = liveItems[liveItemIndex];
+
+		Change change = { type, internalIndex, parsingNames[internalIndex], L"" };
+
+		if (type == ChangeType::Removed)
+		{
+			liveItems[liveItemIndex] = liveItems.back();
+			liveItems.pop_back();
+		}
+		else if (type == ChangeType::Renamed)
+		{
+			parsingNames[internalIndex] = BuildParsingName(L"renamed_", i);
+			change.newParsingName = parsingNames[internalIndex];
+		}
+
+		changes.push_back(std::move(change));
+	}
+
+	return changes;
+}
+
+// The time spent looking up items, indexed by the type of change.
+using ReplayTimes = std::array<std::chrono::steady_clock::duration, NUM_CHANGE_TYPES>;
+
+// Applies each change to the folder, in the same way that the directory modification handler
+// does, with the affected item being looked up through findItem. Returns false if any lookup
+// didn't find the expected item.
+template <typename FindFunction>
+bool ReplayChanges(Folder &folder, const std::vector<Change> &changes, FindFunction findItem,
+	ReplayTimes &times)
+{
+	for (const auto &change : changes)
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto internalIndex = findItem(folder, change.parsingName);
+		times[static_cast<size_t>(change.type)] += std::chrono::steady_clock::now() - start;
+
+		// New items are also looked up, to check whether they're already present.
+		std::optional<int> expectedInternalIndex;
+
+		if (change.type != ChangeType::Added)
+		{
+			expectedInternalIndex = change.internalIndex;
+		}
+
+		if (internalIndex != expectedInternalIndex)
+		{
+			return false;
+		}
+
+		switch (change.type)
+		{
+		case ChangeType::Added:
+			AddItem(folder, change.internalIndex, change.parsingName);
+			break;
+
+		case ChangeType::Removed:
+			RemoveItem(folder, *internalIndex);
+			break;
+
+		case ChangeType::Modified:
+			break;
+
+		case ChangeType::Renamed:
+			RemoveItem(folder, *internalIndex);
+			AddItem(folder, *internalIndex, change.newParsingName);
+			break;
+		}
+	}
+
+	return true;
+}
+
+double ToMilliseconds(std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+template <typename FindFunction>
+void MeasureReplay(const wchar_t *name, const std::vector<Change> &changes,
+	FindFunction findItem)
+{
+	auto folder = BuildFolder();
+	ReplayTimes times = {};
+
+	if (!ReplayChanges(folder, changes, findItem, times))
+	{
+		wprintf(L"%-24ls failed\n", name);
+		return;
+	}
+
+	wprintf(L"%-24ls", name);
+
+	std::chrono::steady_clock::duration totalTime{};
+
+	for (auto time : times)
+	{
+		wprintf(L" %10.1f", ToMilliseconds(time));
+		totalTime += time;
+	}
+
+	wprintf(L" %14.0f\n",
+		static_cast<double>(changes.size()) / (ToMilliseconds(totalTime) / 1000));
+}
+
+std::optional<int> FindItem(const Folder &folder, const std::optional<std::wstring> &parsingName,
+	const std::wstring &targetParsingName)
+{
+	return folder.index.FindEquivalentItem(parsingName,
+		[&folder, &targetParsingName](int internalIndex)
+		{ return folder.parsingNames[internalIndex] == targetParsingName; });
+}
+
+}
+
+void RunItemNameIndexBenchmark()
+{
+	wprintf(L"Item name index (%d items, %d changes)\n\n", NUM_ITEMS, NUM_CHANGES);
+	wprintf(L"Time spent looking up items, by type of change (ms)\n\n");
+	wprintf(L"%-24ls %10ls %10ls %10ls %10ls %14ls\n", L"Method", L"Added", L"Removed",
+		L"Modified", L"Renamed", L"Lookups/s");
+
+	auto changes = GenerateChanges();
+
+	// New items aren't in the index, so looking them up doesn't require any items to be checked.
+	MeasureReplay(L"ItemNameIndex", changes,
+		[](const Folder &folder, const std::wstring &parsingName)
+		{ return FindItem(folder, parsingName, parsingName); });
+
+	// Without a parsing name, every item is checked, which is equivalent to the linear search that
+	// was previously performed for every change.
+	MeasureReplay(L"Checking every item", changes,
+		[](const Folder &folder, const std::wstring &parsingName)
+		{ return FindItem(folder, std::nullopt, parsingName); });
+}
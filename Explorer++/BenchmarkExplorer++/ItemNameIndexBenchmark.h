@@ -0,0 +1,12 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Replays a synthetic log of directory changes (additions, removals, modifications and renames)
+// against a folder of 100,000 items. Each change requires the affected item to be looked up by
+// name. The lookups are done through ItemNameIndex and then by checking every item, as was
+// previously done. Writes the lookup time for each type of change, along with the overall lookup
+// throughput, to stdout.
+void RunItemNameIndexBenchmark();
@@ -0,0 +1,59 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "BackgroundWorkPoolBenchmark.h"
+#include "ColorRuleBenchmark.h"
+#include "ColumnValueCacheBenchmark.h"
+#include "DirectoryChangeQueueBenchmark.h"
+#include "FileSearchBenchmark.h"
+#include "FilterBenchmark.h"
+#include "FolderSizeBenchmark.h"
+#include "GroupingBenchmark.h"
+#include "ItemNameIndexBenchmark.h"
+#include "MergeFilesBenchmark.h"
+#include "ParallelSortBenchmark.h"
+#include "SecureOverwriteBenchmark.h"
+#include "SortKeyStoreBenchmark.h"
+#include "SortedInsertionBenchmark.h"
+#include "SplitFileBenchmark.h"
+#include "WildcardBenchmark.h"
+
+// The benchmarks should be run using a release build. Debug builds are significantly slower and
+// aren't representative of the real-world performance.
+int wmain()
+{
+	RunParallelSortBenchmark();
+	wprintf(L"\n");
+	RunMergeFilesBenchmark();
+	wprintf(L"\n");
+	RunSplitFileBenchmark();
+	wprintf(L"\n");
+	RunSecureOverwriteBenchmark();
+	wprintf(L"\n");
+	RunFolderSizeBenchmark();
+	wprintf(L"\n");
+	RunFileSearchBenchmark();
+	wprintf(L"\n");
+	RunSortKeyStoreBenchmark();
+	wprintf(L"\n");
+	RunItemNameIndexBenchmark();
+	wprintf(L"\n");
+	RunSortedInsertionBenchmark();
+	wprintf(L"\n");
+	RunColumnValueCacheBenchmark();
+	wprintf(L"\n");
+	RunWildcardBenchmark();
+	wprintf(L"\n");
+	RunFilterBenchmark();
+	wprintf(L"\n");
+	RunColorRuleBenchmark();
+	wprintf(L"\n");
+	RunGroupingBenchmark();
+	wprintf(L"\n");
+	RunBackgroundWorkPoolBenchmark();
+	wprintf(L"\n");
+	RunDirectoryChangeQueueBenchmark();
+	return 0;
+}
@@ -0,0 +1,159 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "MergeFilesBenchmark.h"
+#include "BenchmarkFiles.h"
+#include "../Helper/FileStreams.h"
+#include "../Helper/ReadAheadPipeline.h"
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+
+namespace
+{
+
+constexpr int NUM_PARTS = 4;
+constexpr uint64_t PART_SIZE = 1536ull * 1024 * 1024;
+
+// The whole-file approach reads each part into a buffer the size of the part. A single ReadFile
+// call can't read more than 4GB, so the part is read in pieces of this size.
+constexpr size_t WHOLE_FILE_READ_SIZE = 64 * 1024 * 1024;
+
+constexpr double BYTES_PER_MEGABYTE = 1024.0 * 1024.0;
+
+bool MergeUsingPipeline(const std::vector<std::wstring> &parts, const std::wstring &outputPath)
+{
+	auto writer = FileWriter::Create(outputPath);
+
+	if (!writer)
+	{
+		return false;
+	}
+
+	writer->Reserve(PART_SIZE * parts.size());
+
+	auto openPart = [&parts](size_t index) -> std::unique_ptr<ReadAheadPipeline::Source>
+	{ return FileReader::Open(parts[index]); };
+
+	auto writeBlock = [&writer](size_t index, std::span<const std::byte> block)
+	{
+		UNREFERENCED_PARAMETER(index);
+
+		return writer->Write(block);
+	};
+
+	ReadAheadPipeline pipeline;
+	auto result = pipeline.Run(parts.size(), openPart, writeBlock);
+
+	return result.status == ReadAheadPipeline::Status::Succeeded;
+}
+
+bool MergeUsingWholeFileBuffers(const std::vector<std::wstring> &parts,
+	const std::wstring &outputPath)
+{
+	auto writer = FileWriter::Create(outputPath);
+
+	if (!writer)
+	{
+		return false;
+	}
+
+	for (const auto &part : parts)
+	{
+		auto reader = FileReader::Open(part);
+
+		if (!reader)
+		{
+			return false;
+		}
+
+		auto buffer = std::make_unique<std::byte[]>(static_cast<size_t>(PART_SIZE));
+		uint64_t totalRead = 0;
+
+		while (totalRead < PART_SIZE)
+		{
+			auto readSize = std::min<uint64_t>(WHOLE_FILE_READ_SIZE, PART_SIZE - totalRead);
+			auto numBytesRead = reader->Read(
+				std::span(buffer.get() + totalRead, static_cast<size_t>(readSize)));
+
+			if (!numBytesRead || *numBytesRead == 0)
+			{
+				return false;
+			}
+
+			totalRead += *numBytesRead;
+		}
+
+		if (!writer->Write(std::span(buffer.get(), static_cast<size_t>(PART_SIZE))))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename MergeFunction>
+void MeasureMerge(const wchar_t *name, const std::vector<std::wstring> &parts,
+	const std::wstring &outputPath, MergeFunction mergeFunction)
+{
+	auto start = std::chrono::steady_clock::now();
+	bool succeeded = mergeFunction(parts, outputPath);
+	auto end = std::chrono::steady_clock::now();
+
+	DeleteFile(outputPath.c_str());
+
+	if (!succeeded)
+	{
+		wprintf(L"%-24ls failed\n", name);
+		return;
+	}
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double totalMegabytes = static_cast<double>(PART_SIZE * parts.size()) / BYTES_PER_MEGABYTE;
+
+	wprintf(L"%-24ls %10.2f %12.1f\n", name, seconds, totalMegabytes / seconds);
+}
+
+}
+
+void RunMergeFilesBenchmark()
+{
+	auto directory = std::filesystem::temp_directory_path() / L"ExplorerPlusPlusMergeBenchmark";
+	std::filesystem::create_directories(directory);
+
+	wprintf(L"Merge files (%d parts of %llu MB, in %ls)\n\n", NUM_PARTS,
+		PART_SIZE / (1024 * 1024), directory.c_str());
+
+	std::vector<std::wstring> parts;
+
+	for (int i = 0; i < NUM_PARTS; i++)
+	{
+		auto path = (directory / (L"part" + std::to_wstring(i + 1))).wstring();
+
+		if (!CreateBenchmarkFile(path, PART_SIZE, i))
+		{
+			wprintf(L"Couldn't create %ls\n", path.c_str());
+			std::filesystem::remove_all(directory);
+			return;
+		}
+
+		parts.push_back(path);
+	}
+
+	auto outputPath = (directory / L"merged").wstring();
+
+	// The parts have just been written, so some of them may still be in the file system cache.
+	// Each method is run twice, alternating, so that neither is consistently favored.
+	wprintf(L"%-24ls %10ls %12ls\n", L"Method", L"Time (s)", L"MB/s");
+
+	for (int i = 0; i < 2; i++)
+	{
+		MeasureMerge(L"Whole-file buffers", parts, outputPath, MergeUsingWholeFileBuffers);
+		MeasureMerge(L"Read-ahead pipeline", parts, outputPath, MergeUsingPipeline);
+	}
+
+	std::filesystem::remove_all(directory);
+}
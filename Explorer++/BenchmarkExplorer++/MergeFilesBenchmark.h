@@ -0,0 +1,10 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Merges a set of multi-gigabyte synthetic files (created in the temporary directory and removed
+// afterwards) using ReadAheadPipeline, and compares that with reading each file into memory in its
+// entirety before writing it out. Writes the timings to stdout.
+void RunMergeFilesBenchmark();
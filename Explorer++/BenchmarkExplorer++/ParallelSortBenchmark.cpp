@@ -0,0 +1,109 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ParallelSortBenchmark.h"
+#include "../Explorer++/ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/ParallelSort.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace
+{
+
+// Each sort is repeated this number of times and the fastest time is reported.
+constexpr int NUM_REPETITIONS = 5;
+
+// Sorting a folder involves ordering the item indexes by a key that's stored separately (e.g. the
+// size or modification date of each item), so that's what's measured here.
+struct SortData
+{
+	std::vector<uint64_t> keys;
+	std::vector<int> initialOrder;
+};
+
+SortData GenerateSortData(int numItems)
+{
+	std::mt19937_64 generator(1234);
+
+	// Keys are drawn from a range that's smaller than the number of items, so that there are
+	// duplicate keys, as there would be in a real folder (e.g. files with the same size).
+	std::uniform_int_distribution<uint64_t> distribution(0,
+		static_cast<uint64_t>(numItems / 2));
+
+	SortData data;
+	data.keys.resize(numItems);
+	std::generate(data.keys.begin(), data.keys.end(), [&] { return distribution(generator); });
+
+	data.initialOrder.resize(numItems);
+	std::iota(data.initialOrder.begin(), data.initialOrder.end(), 0);
+	std::shuffle(data.initialOrder.begin(), data.initialOrder.end(), generator);
+
+	return data;
+}
+
+template <typename SortFunction>
+double MeasureSortMilliseconds(const SortData &data, SortFunction sortFunction)
+{
+	auto compare = [&keys = data.keys](int index1, int index2)
+	{ return keys[index1] < keys[index2]; };
+
+	double bestTime = 0;
+
+	for (int i = 0; i < NUM_REPETITIONS; i++)
+	{
+		auto order = data.initialOrder;
+
+		auto start = std::chrono::steady_clock::now();
+		sortFunction(order, compare);
+		auto end = std::chrono::steady_clock::now();
+
+		double time = std::chrono::duration<double, std::milli>(end - start).count();
+
+		if (i == 0 || time < bestTime)
+		{
+			bestTime = time;
+		}
+	}
+
+	return bestTime;
+}
+
+}
+
+void RunParallelSortBenchmark()
+{
+	int numThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	wprintf(L"Parallel sort (%d pool threads, best of %d runs)\n\n", numThreads,
+		NUM_REPETITIONS);
+	wprintf(L"%12ls %18ls %18ls %10ls\n", L"Items", L"stable_sort (ms)", L"Parallel (ms)",
+		L"Speedup");
+
+	auto executor = std::make_shared<ComStaThreadPoolExecutor>(numThreads);
+	BackgroundWorkPool workPool(executor);
+
+	for (int numItems : { 10'000, 100'000, 1'000'000, 10'000'000 })
+	{
+		auto data = GenerateSortData(numItems);
+
+		double sequentialTime = MeasureSortMilliseconds(data,
+			[](std::vector<int> &order, const auto &compare)
+			{ std::stable_sort(order.begin(), order.end(), compare); });
+
+		double parallelTime = MeasureSortMilliseconds(data,
+			[&workPool](std::vector<int> &order, const auto &compare)
+			{ ParallelStableSort(order.begin(), order.end(), compare, &workPool); });
+
+		wprintf(L"%12d %18.2f %18.2f %9.2fx\n", numItems, sequentialTime, parallelTime,
+			sequentialTime / parallelTime);
+	}
+
+	executor->shutdown();
+}
@@ -0,0 +1,9 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Compares ParallelStableSort with std::stable_sort, when sorting between 10 thousand and 10
+// million items, and writes the timings to stdout.
+void RunParallelSortBenchmark();
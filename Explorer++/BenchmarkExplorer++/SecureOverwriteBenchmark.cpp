@@ -0,0 +1,161 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "SecureOverwriteBenchmark.h"
+#include "BenchmarkFiles.h"
+#include "../Helper/ChaCha20.h"
+#include "../Helper/FileStreams.h"
+#include "../Helper/SecureOverwriter.h"
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+constexpr uint64_t FILE_SIZE = 1024ull * 1024 * 1024;
+
+// Writing a single byte at a time is slow enough that only a small file is used.
+constexpr uint64_t BYTE_AT_A_TIME_FILE_SIZE = 4ull * 1024 * 1024;
+
+constexpr uint64_t RANDOM_GENERATION_SIZE = 1024ull * 1024 * 1024;
+
+constexpr double BYTES_PER_MEGABYTE = 1024.0 * 1024.0;
+
+bool OverwriteUsingPass(const std::wstring &path, const OverwritePass &pass)
+{
+	auto file = FileOverwriter::Open(path);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	// The key is fixed, since the quality of the random data doesn't matter here.
+	SecureOverwriter overwriter({});
+	auto status = overwriter.Overwrite(*file, FILE_SIZE, std::span(&pass, 1));
+
+	return status == SecureOverwriter::Status::Succeeded;
+}
+
+// This is the approach that was previously used: the file is overwritten one byte at a time, with
+// a separate WriteFile call (and, for a random pass, a separate CryptGenRandom call) for each byte.
+bool OverwriteByteAtATime(const std::wstring &path, bool random)
+{
+	wil::unique_hfile file(
+		CreateFile(path.c_str(), FILE_WRITE_DATA, 0, nullptr, OPEN_EXISTING, NULL, nullptr));
+
+	if (!file)
+	{
+		return false;
+	}
+
+	wil::unique_hcryptprov provider;
+
+	if (random
+		&& !CryptAcquireContext(&provider, nullptr, nullptr, PROV_RSA_AES, CRYPT_VERIFYCONTEXT))
+	{
+		return false;
+	}
+
+	for (uint64_t i = 0; i < BYTE_AT_A_TIME_FILE_SIZE; i++)
+	{
+		BYTE data = 0x00;
+
+		if (random && !CryptGenRandom(provider.get(), 1, &data))
+		{
+			return false;
+		}
+
+		DWORD numBytesWritten;
+
+		if (!WriteFile(file.get(), &data, 1, &numBytesWritten, nullptr))
+		{
+			return false;
+		}
+	}
+
+	return FlushFileBuffers(file.get());
+}
+
+void MeasureThroughput(const wchar_t *name, uint64_t size, std::function<bool()> function)
+{
+	auto start = std::chrono::steady_clock::now();
+	bool succeeded = function();
+	auto end = std::chrono::steady_clock::now();
+
+	if (!succeeded)
+	{
+		wprintf(L"%-32ls failed\n", name);
+		return;
+	}
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double totalMegabytes = static_cast<double>(size) / BYTES_PER_MEGABYTE;
+
+	wprintf(L"%-32ls %10.2f %12.1f\n", name, seconds, totalMegabytes / seconds);
+}
+
+bool GenerateRandomData()
+{
+	ChaCha20 chaCha20({});
+	std::vector<std::byte> buffer(SecureOverwriter::DEFAULT_BLOCK_SIZE);
+
+	for (uint64_t total = 0; total < RANDOM_GENERATION_SIZE; total += buffer.size())
+	{
+		chaCha20.Generate(buffer);
+	}
+
+	return true;
+}
+
+}
+
+void RunSecureOverwriteBenchmark()
+{
+	auto directory =
+		std::filesystem::temp_directory_path() / L"ExplorerPlusPlusSecureOverwriteBenchmark";
+	std::filesystem::create_directories(directory);
+
+	wprintf(L"Secure overwrite (%llu MB file, in %ls)\n\n", FILE_SIZE / (1024 * 1024),
+		directory.c_str());
+
+	auto path = (directory / L"file").wstring();
+	auto byteAtATimePath = (directory / L"small_file").wstring();
+
+	if (!CreateBenchmarkFile(path, FILE_SIZE, 0)
+		|| !CreateBenchmarkFile(byteAtATimePath, BYTE_AT_A_TIME_FILE_SIZE, 0))
+	{
+		wprintf(L"Couldn't create the files in %ls\n", directory.c_str());
+		std::filesystem::remove_all(directory);
+		return;
+	}
+
+	const OverwritePass zeroPass = { OverwritePass::Type::Pattern, std::byte{ 0x00 } };
+	const OverwritePass onePass = { OverwritePass::Type::Pattern, std::byte{ 0xFF } };
+	const OverwritePass randomPass = { OverwritePass::Type::Random };
+
+	wprintf(L"%-32ls %10ls %12ls\n", L"Method", L"Time (s)", L"MB/s");
+
+	for (int i = 0; i < 2; i++)
+	{
+		MeasureThroughput(L"Pass, 0x00", FILE_SIZE,
+			[&path, &zeroPass] { return OverwriteUsingPass(path, zeroPass); });
+		MeasureThroughput(L"Pass, 0xFF", FILE_SIZE,
+			[&path, &onePass] { return OverwriteUsingPass(path, onePass); });
+		MeasureThroughput(L"Pass, random", FILE_SIZE,
+			[&path, &randomPass] { return OverwriteUsingPass(path, randomPass); });
+		MeasureThroughput(L"Byte at a time, 0x00", BYTE_AT_A_TIME_FILE_SIZE,
+			[&byteAtATimePath] { return OverwriteByteAtATime(byteAtATimePath, false); });
+		MeasureThroughput(L"Byte at a time, random", BYTE_AT_A_TIME_FILE_SIZE,
+			[&byteAtATimePath] { return OverwriteByteAtATime(byteAtATimePath, true); });
+	}
+
+	wprintf(L"\n");
+	MeasureThroughput(L"ChaCha20 (in memory)", RANDOM_GENERATION_SIZE, GenerateRandomData);
+
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Overwrites a synthetic file (created in the temporary directory and removed afterwards) using
+// each type of pass supported by SecureOverwriter, and compares that with the byte-at-a-time
+// approach that was previously used. Also measures how quickly random data can be generated in
+// memory. Writes the throughput of each to stdout.
+void RunSecureOverwriteBenchmark();
@@ -0,0 +1,170 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "SortKeyStoreBenchmark.h"
+#include "../Explorer++/ComStaThreadPoolExecutor.h"
+#include "../Explorer++/ShellBrowser/FolderSettings.h"
+#include "../Explorer++/ShellBrowser/SortKeyStore.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/ParallelSort.h"
+#include <strsafe.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace
+{
+
+constexpr int NUM_ITEMS = 1'000'000;
+
+// Each sort is repeated this number of times and the fastest time is reported.
+constexpr int NUM_REPETITIONS = 3;
+
+// Every tenth item is a folder.
+constexpr int FOLDER_INTERVAL = 10;
+
+// The names are built from a small set of prefixes, followed by a number, so that there are long
+// common prefixes and natural sorting has to compare the numeric part, as it would in a folder of
+// photos or logs.
+const wchar_t *const NAME_PREFIXES[] = { L"IMG_", L"report ", L"Document (", L"backup-",
+	L"setup", L"notes" };
+const wchar_t *const FILE_EXTENSIONS[] = { L".jpg", L".txt", L".docx", L".zip", L".exe",
+	L".log" };
+const DWORD FILE_ATTRIBUTES[] = { FILE_ATTRIBUTE_ARCHIVE, FILE_ATTRIBUTE_NORMAL,
+	FILE_ATTRIBUTE_READONLY, FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_ARCHIVE };
+
+const SortMode SORT_MODES[] = { SortMode::Name, SortMode::Size, SortMode::DateModified,
+	SortMode::Created, SortMode::Accessed, SortMode::Attributes, SortMode::Extension };
+
+FILETIME IntegerToFileTime(uint64_t value)
+{
+	ULARGE_INTEGER largeInteger;
+	largeInteger.QuadPart = value;
+	return { largeInteger.LowPart, largeInteger.HighPart };
+}
+
+// The find data for each item is generated as the item is added, rather than being held for every
+// item up front, since WIN32_FIND_DATA is large.
+void PopulateStore(SortKeyStore &store)
+{
+	std::mt19937_64 generator(1234);
+	std::uniform_int_distribution<int> numberDistribution(0, NUM_ITEMS);
+	std::uniform_int_distribution<size_t> prefixDistribution(0, std::size(NAME_PREFIXES) - 1);
+	std::uniform_int_distribution<size_t> extensionDistribution(0, std::size(FILE_EXTENSIONS) - 1);
+	std::uniform_int_distribution<size_t> attributeDistribution(0, std::size(FILE_ATTRIBUTES) - 1);
+	std::uniform_int_distribution<uint64_t> sizeDistribution(0, 1ULL << 32);
+
+	// Times within roughly a year of each other.
+	constexpr uint64_t BASE_TIME = 133'000'000'000'000'000;
+	std::uniform_int_distribution<uint64_t> timeDistribution(0, 315'360'000'000'000);
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		bool isFolder = (i % FOLDER_INTERVAL) == 0;
+
+		std::wstring name = NAME_PREFIXES[prefixDistribution(generator)]
+			+ std::to_wstring(numberDistribution(generator));
+
+		if (!isFolder)
+		{
+			name += FILE_EXTENSIONS[extensionDistribution(generator)];
+		}
+
+		WIN32_FIND_DATA wfd = {};
+		wfd.dwFileAttributes =
+			isFolder ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTES[attributeDistribution(generator)];
+		StringCchCopy(wfd.cFileName, std::size(wfd.cFileName), name.c_str());
+
+		if (!isFolder)
+		{
+			ULARGE_INTEGER size;
+			size.QuadPart = sizeDistribution(generator);
+			wfd.nFileSizeLow = size.LowPart;
+			wfd.nFileSizeHigh = size.HighPart;
+		}
+
+		wfd.ftCreationTime = IntegerToFileTime(BASE_TIME + timeDistribution(generator));
+		wfd.ftLastWriteTime = IntegerToFileTime(BASE_TIME + timeDistribution(generator));
+		wfd.ftLastAccessTime = IntegerToFileTime(BASE_TIME + timeDistribution(generator));
+
+		store.SetItem(i, name, wfd, true, false, name);
+	}
+}
+
+template <typename SortFunction>
+double MeasureSortMilliseconds(const std::vector<int> &initialOrder, const SortKeyStore &store,
+	SortMode sortMode, SortFunction sortFunction)
+{
+	GlobalFolderSettings globalFolderSettings;
+
+	auto compare = [&](int internalIndex1, int internalIndex2)
+	{ return store.Compare(internalIndex1, internalIndex2, sortMode, globalFolderSettings) < 0; };
+
+	double bestTime = 0;
+
+	for (int i = 0; i < NUM_REPETITIONS; i++)
+	{
+		auto order = initialOrder;
+
+		auto start = std::chrono::steady_clock::now();
+		sortFunction(order, compare);
+		auto end = std::chrono::steady_clock::now();
+
+		double time = std::chrono::duration<double, std::milli>(end - start).count();
+
+		if (i == 0 || time < bestTime)
+		{
+			bestTime = time;
+		}
+	}
+
+	return bestTime;
+}
+
+}
+
+void RunSortKeyStoreBenchmark()
+{
+	int numThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	wprintf(L"Sort keys (%d items, %d pool threads, best of %d runs)\n\n", NUM_ITEMS, numThreads,
+		NUM_REPETITIONS);
+
+	SortKeyStore store;
+
+	auto start = std::chrono::steady_clock::now();
+	PopulateStore(store);
+	auto end = std::chrono::steady_clock::now();
+
+	wprintf(L"%-36ls %12.1f\n\n", L"Adding items (ms)",
+		std::chrono::duration<double, std::milli>(end - start).count());
+
+	std::vector<int> initialOrder(NUM_ITEMS);
+	std::iota(initialOrder.begin(), initialOrder.end(), 0);
+	std::shuffle(initialOrder.begin(), initialOrder.end(), std::mt19937_64(5678));
+
+	wprintf(L"%-16ls %18ls %18ls\n", L"Sort mode", L"stable_sort (ms)", L"Parallel (ms)");
+
+	auto executor = std::make_shared<ComStaThreadPoolExecutor>(numThreads);
+	BackgroundWorkPool workPool(executor);
+
+	for (SortMode sortMode : SORT_MODES)
+	{
+		double sequentialTime = MeasureSortMilliseconds(initialOrder, store, sortMode,
+			[](std::vector<int> &order, const auto &compare)
+			{ std::stable_sort(order.begin(), order.end(), compare); });
+
+		double parallelTime = MeasureSortMilliseconds(initialOrder, store, sortMode,
+			[&workPool](std::vector<int> &order, const auto &compare)
+			{ ParallelStableSort(order.begin(), order.end(), compare, &workPool); });
+
+		wprintf(L"%-16hs %18.2f %18.2f\n", sortMode._to_string(), sequentialTime, parallelTime);
+	}
+
+	executor->shutdown();
+}
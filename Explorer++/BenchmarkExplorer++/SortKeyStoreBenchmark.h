@@ -0,0 +1,10 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Adds a million synthetic items to a SortKeyStore, then sorts them by each of the sort modes that
+// SortKeyStore supports, using both std::stable_sort and ParallelStableSort. Writes the timings to
+// stdout.
+void RunSortKeyStoreBenchmark();
@@ -0,0 +1,212 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "SortedInsertionBenchmark.h"
+#include "../Explorer++/ShellBrowser/ListViewItemModel.h"
+#include "../Explorer++/ShellBrowser/SelectionTracker.h"
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <utility>
+
+namespace
+{
+
+// Each restore is repeated this number of times and the fastest time is reported.
+constexpr int NUM_REPETITIONS = 3;
+
+// Items are sorted by a key that's stored separately, in the same way that items are sorted using
+// the values in SortKeyStore. Half of the items are filtered and are therefore not in the model to
+// begin with.
+struct FolderData
+{
+	std::vector<uint64_t> keys;
+
+	// In sorted order.
+	std::vector<int> visibleItems;
+
+	// In the order the items were filtered (i.e. in internal index order).
+	std::vector<int> filteredItems;
+};
+
+int CompareItems(const std::vector<uint64_t> &keys, int internalIndex1, int internalIndex2)
+{
+	return (keys[internalIndex1] > keys[internalIndex2])
+		- (keys[internalIndex1] < keys[internalIndex2]);
+}
+
+FolderData GenerateFolderData(int numItems)
+{
+	std::mt19937_64 generator(1234);
+	std::uniform_int_distribution<uint64_t> keyDistribution;
+	std::bernoulli_distribution filteredDistribution(0.5);
+
+	FolderData data;
+	data.keys.resize(numItems);
+	std::generate(data.keys.begin(), data.keys.end(), [&] { return keyDistribution(generator); });
+
+	for (int i = 0; i < numItems; i++)
+	{
+		if (filteredDistribution(generator))
+		{
+			data.filteredItems.push_back(i);
+		}
+		else
+		{
+			data.visibleItems.push_back(i);
+		}
+	}
+
+	std::stable_sort(data.visibleItems.begin(), data.visibleItems.end(),
+		[&keys = data.keys](int internalIndex1, int internalIndex2)
+		{ return CompareItems(keys, internalIndex1, internalIndex2) < 0; });
+
+	return data;
+}
+
+// Equivalent to ShellBrowserImpl::DetermineItemSortedPosition().
+int DetermineSortedPosition(const ListViewItemModel &model, const std::vector<uint64_t> &keys,
+	int internalIndex, int first)
+{
+	int count = model.GetCount() - first;
+
+	while (count > 0)
+	{
+		int step = count / 2;
+		int middle = first + step;
+
+		if (CompareItems(keys, internalIndex, model.GetInternalIndexAt(middle)) > 0)
+		{
+			first = middle + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	return first;
+}
+
+void RestoreIndividually(ListViewItemModel &model, const FolderData &data)
+{
+	for (int internalIndex : data.filteredItems)
+	{
+		model.InsertItem(internalIndex,
+			DetermineSortedPosition(model, data.keys, internalIndex, 0));
+	}
+}
+
+// Equivalent to ShellBrowserImpl::QueueItemsForSortedInsertion(), followed by the insertion of
+// the queued items into the model.
+void RestoreAsBatch(ListViewItemModel &model, const FolderData &data)
+{
+	auto internalIndexes = data.filteredItems;
+	std::stable_sort(internalIndexes.begin(), internalIndexes.end(),
+		[&keys = data.keys](int internalIndex1, int internalIndex2)
+		{ return CompareItems(keys, internalIndex1, internalIndex2) < 0; });
+
+	std::vector<std::pair<int, int>> items;
+	items.reserve(internalIndexes.size());
+
+	int currentItem = 0;
+
+	for (int internalIndex : internalIndexes)
+	{
+		currentItem = DetermineSortedPosition(model, data.keys, internalIndex, currentItem);
+
+		// Each of the previously queued items will be inserted before this one.
+		items.emplace_back(internalIndex, currentItem + static_cast<int>(items.size()));
+	}
+
+	model.InsertItems(items);
+}
+
+bool IsModelSorted(const ListViewItemModel &model, const FolderData &data)
+{
+	if (model.GetCount() != static_cast<int>(data.keys.size()))
+	{
+		return false;
+	}
+
+	for (int i = 1; i < model.GetCount(); i++)
+	{
+		if (CompareItems(data.keys, model.GetInternalIndexAt(i - 1), model.GetInternalIndexAt(i))
+			> 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename RestoreFunction>
+std::optional<double> MeasureRestoreMilliseconds(const FolderData &data,
+	RestoreFunction restoreFunction)
+{
+	std::vector<std::pair<int, int>> visibleItems;
+
+	for (int internalIndex : data.visibleItems)
+	{
+		visibleItems.emplace_back(internalIndex, static_cast<int>(visibleItems.size()));
+	}
+
+	double bestTime = 0;
+
+	for (int i = 0; i < NUM_REPETITIONS; i++)
+	{
+		SelectionTracker selectionTracker;
+		ListViewItemModel model(&selectionTracker);
+		model.InsertItems(visibleItems);
+
+		auto start = std::chrono::steady_clock::now();
+		restoreFunction(model, data);
+		auto end = std::chrono::steady_clock::now();
+
+		if (!IsModelSorted(model, data))
+		{
+			return std::nullopt;
+		}
+
+		double time = std::chrono::duration<double, std::milli>(end - start).count();
+
+		if (i == 0 || time < bestTime)
+		{
+			bestTime = time;
+		}
+	}
+
+	return bestTime;
+}
+
+}
+
+void RunSortedInsertionBenchmark()
+{
+	wprintf(L"Sorted insertion (restoring half of the items in a folder, best of %d runs)\n\n",
+		NUM_REPETITIONS);
+	wprintf(L"%12ls %12ls %18ls %18ls %10ls\n", L"Items", L"Restored", L"Individual (ms)",
+		L"Batch (ms)", L"Speedup");
+
+	for (int numItems : { 2'000, 20'000, 200'000 })
+	{
+		auto data = GenerateFolderData(numItems);
+
+		auto individualTime = MeasureRestoreMilliseconds(data, RestoreIndividually);
+		auto batchTime = MeasureRestoreMilliseconds(data, RestoreAsBatch);
+
+		if (!individualTime || !batchTime)
+		{
+			wprintf(L"%12d failed\n", numItems);
+			continue;
+		}
+
+		wprintf(L"%12d %12zu %18.2f %18.2f %9.2fx\n", numItems, data.filteredItems.size(),
+			*individualTime, *batchTime, *individualTime / *batchTime);
+	}
+}
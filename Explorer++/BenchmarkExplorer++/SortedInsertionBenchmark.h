@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Restores the filtered half of a folder, in sorted order, to a ListViewItemModel, for folders of
+// up to 200,000 items. Compares restoring each item individually (via a binary search, then a
+// single insertion) with sorting the items and inserting them as a batch, which is what clearing a
+// filter does. Writes the timings to stdout.
+void RunSortedInsertionBenchmark();
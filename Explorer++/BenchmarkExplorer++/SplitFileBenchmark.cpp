@@ -0,0 +1,186 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "SplitFileBenchmark.h"
+#include "BenchmarkFiles.h"
+#include "../Explorer++/ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/FileSplitter.h"
+#include "../Helper/FileStreams.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace
+{
+
+constexpr uint64_t INPUT_SIZE = 4096ull * 1024 * 1024;
+constexpr uint64_t PART_SIZE = 512ull * 1024 * 1024;
+
+// See the comment in MergeFilesBenchmark.cpp.
+constexpr size_t WHOLE_PART_READ_SIZE = 64 * 1024 * 1024;
+
+constexpr double BYTES_PER_MEGABYTE = 1024.0 * 1024.0;
+
+std::wstring GetPartPath(const std::filesystem::path &directory, size_t partIndex)
+{
+	return (directory / (L"part" + std::to_wstring(partIndex + 1))).wstring();
+}
+
+bool SplitUsingSplitter(const std::wstring &inputPath, const std::filesystem::path &outputDirectory,
+	BackgroundWorkPool *workPool, unsigned int numWriters, bool computeChecksums)
+{
+	auto openInput = [&inputPath](uint64_t offset) -> std::unique_ptr<ReadAheadPipeline::Source>
+	{ return FileReader::Open(inputPath, offset); };
+
+	auto createPart = [&outputDirectory](size_t partIndex,
+						  uint64_t partSize) -> std::unique_ptr<FileSplitter::Sink>
+	{
+		auto writer = FileWriter::Create(GetPartPath(outputDirectory, partIndex));
+
+		if (writer)
+		{
+			writer->Reserve(partSize);
+		}
+
+		return writer;
+	};
+
+	FileSplitter splitter(workPool, numWriters);
+	auto result = splitter.Run(INPUT_SIZE, PART_SIZE, computeChecksums, openInput, createPart);
+
+	return result.status == FileSplitter::Status::Succeeded;
+}
+
+// This is the approach that was previously used when splitting a file: a buffer the size of a
+// part is allocated, then each part is read into the buffer and written out, in turn.
+bool SplitUsingWholePartBuffer(const std::wstring &inputPath,
+	const std::filesystem::path &outputDirectory)
+{
+	auto reader = FileReader::Open(inputPath);
+
+	if (!reader)
+	{
+		return false;
+	}
+
+	auto buffer = std::make_unique<std::byte[]>(static_cast<size_t>(PART_SIZE));
+	uint64_t numParts = FileSplitter::GetNumParts(INPUT_SIZE, PART_SIZE);
+
+	for (size_t i = 0; i < numParts; i++)
+	{
+		auto partSize = std::min(PART_SIZE, INPUT_SIZE - i * PART_SIZE);
+		uint64_t totalRead = 0;
+
+		while (totalRead < partSize)
+		{
+			auto readSize = std::min<uint64_t>(WHOLE_PART_READ_SIZE, partSize - totalRead);
+			auto numBytesRead = reader->Read(
+				std::span(buffer.get() + totalRead, static_cast<size_t>(readSize)));
+
+			if (!numBytesRead || *numBytesRead == 0)
+			{
+				return false;
+			}
+
+			totalRead += *numBytesRead;
+		}
+
+		auto writer = FileWriter::Create(GetPartPath(outputDirectory, i));
+
+		if (!writer || !writer->Write(std::span(buffer.get(), static_cast<size_t>(partSize))))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void MeasureSplit(const wchar_t *name, const std::filesystem::path &outputDirectory,
+	std::function<bool()> splitFunction)
+{
+	std::filesystem::create_directories(outputDirectory);
+
+	auto start = std::chrono::steady_clock::now();
+	bool succeeded = splitFunction();
+	auto end = std::chrono::steady_clock::now();
+
+	std::filesystem::remove_all(outputDirectory);
+
+	if (!succeeded)
+	{
+		wprintf(L"%-32ls failed\n", name);
+		return;
+	}
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double totalMegabytes = static_cast<double>(INPUT_SIZE) / BYTES_PER_MEGABYTE;
+
+	wprintf(L"%-32ls %10.2f %12.1f\n", name, seconds, totalMegabytes / seconds);
+}
+
+}
+
+void RunSplitFileBenchmark()
+{
+	auto directory = std::filesystem::temp_directory_path() / L"ExplorerPlusPlusSplitBenchmark";
+	std::filesystem::create_directories(directory);
+
+	wprintf(L"Split file (%llu MB into parts of %llu MB, in %ls)\n\n",
+		INPUT_SIZE / (1024 * 1024), PART_SIZE / (1024 * 1024), directory.c_str());
+
+	auto inputPath = (directory / L"input").wstring();
+
+	if (!CreateBenchmarkFile(inputPath, INPUT_SIZE, 0))
+	{
+		wprintf(L"Couldn't create %ls\n", inputPath.c_str());
+		std::filesystem::remove_all(directory);
+		return;
+	}
+
+	auto outputDirectory = directory / L"parts";
+
+	auto executor = std::make_shared<ComStaThreadPoolExecutor>(
+		std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+	BackgroundWorkPool workPool(executor);
+
+	auto splitUsingWholePartBuffer = [&inputPath, &outputDirectory]
+	{ return SplitUsingWholePartBuffer(inputPath, outputDirectory); };
+
+	auto splitUsingSingleWriter = [&inputPath, &outputDirectory, &workPool]
+	{ return SplitUsingSplitter(inputPath, outputDirectory, &workPool, 1, false); };
+
+	auto splitUsingMultipleWriters = [&inputPath, &outputDirectory, &workPool]
+	{
+		return SplitUsingSplitter(inputPath, outputDirectory, &workPool,
+			FileSplitter::DEFAULT_NUM_WRITERS, false);
+	};
+
+	auto splitWithChecksums = [&inputPath, &outputDirectory, &workPool]
+	{
+		return SplitUsingSplitter(inputPath, outputDirectory, &workPool,
+			FileSplitter::DEFAULT_NUM_WRITERS, true);
+	};
+
+	// As with the merge benchmark, the methods are alternated, so that file system caching doesn't
+	// consistently favor one of them.
+	wprintf(L"%-32ls %10ls %12ls\n", L"Method", L"Time (s)", L"MB/s");
+
+	for (int i = 0; i < 2; i++)
+	{
+		MeasureSplit(L"Whole-part buffer", outputDirectory, splitUsingWholePartBuffer);
+		MeasureSplit(L"Splitter, 1 writer", outputDirectory, splitUsingSingleWriter);
+		MeasureSplit(L"Splitter, 4 writers", outputDirectory, splitUsingMultipleWriters);
+		MeasureSplit(L"Splitter, 4 writers, CRC-32", outputDirectory, splitWithChecksums);
+	}
+
+	executor->shutdown();
+
+	std::filesystem::remove_all(directory);
+}
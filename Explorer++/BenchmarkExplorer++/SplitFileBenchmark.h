@@ -0,0 +1,11 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Splits a multi-gigabyte synthetic file (created in the temporary directory and removed
+// afterwards) using FileSplitter, with and without checksums and with different numbers of
+// writers, and compares that with reading each part into memory in its entirety before writing it
+// out. Writes the timings to stdout.
+void RunSplitFileBenchmark();
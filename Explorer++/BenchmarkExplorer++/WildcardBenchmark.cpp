@@ -0,0 +1,281 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "WildcardBenchmark.h"
+#include "../Helper/StringHelper.h"
+#include "../Helper/WildcardPattern.h"
+#include <Shlwapi.h>
+#include <strsafe.h>
+#include <cstdio>
+#include <random>
+#include <span>
+
+namespace
+{
+
+constexpr int NUM_NAMES = 500'000;
+
+const wchar_t *const NAME_PREFIXES[] = { L"IMG_", L"Report ", L"document_", L"Backup-",
+	L"setup", L"Meeting notes " };
+
+// Names that contain non-ASCII characters can't be folded by the vectorized comparisons, so they
+// take the slower path.
+const wchar_t *const NON_ASCII_NAME_PREFIXES[] = { L"Résumé ", L"Отчёт ", L"Überweisung_",
+	L"Café menu ", L"Ωmega-", L"Meeting notes – " };
+
+// The vectorized comparisons make the most difference for long names.
+const wchar_t *const LONG_NAME_PREFIXES[] = {
+	L"Quarterly financial report for the northern region, prepared by the accounts team ",
+	L"Photos from the summer holiday in the mountains, sorted by date and location ",
+	L"Minutes and meeting notes from the weekly planning session of the design group ",
+	L"Exported database backup of the customer relationship management system ",
+	L"Installation package for the latest release of the development environment ",
+	L"Draft chapters of the book, with comments and corrections from the editor " };
+const wchar_t *const FILE_EXTENSIONS[] = { L".jpg", L".txt", L".docx", L".h", L".cpp", L".LOG" };
+
+const wchar_t *const PATTERNS[] = { L"*.txt", L"report*", L"*notes*", L"IMG_?????.jpg",
+	L"*.h: *.cpp: *.txt" };
+
+// Patterns that exercise each of the comparisons performed when matching: a suffix comparison, a
+// search for a single segment and a search for several segments in turn.
+const wchar_t *const PER_NAME_PATTERNS[] = { L"*.txt", L"*notes*", L"*meeting*notes*.TXT" };
+
+// The implementation of CheckWildcardMatch that was used before WildcardPattern was introduced.
+BOOL LegacyCheckWildcardMatch(const TCHAR *szWildcard, const TCHAR *szString, BOOL bCaseSensitive);
+
+BOOL LegacyCheckWildcardMatchInternal(const TCHAR *szWildcard, const TCHAR *szString,
+	BOOL bCaseSensitive)
+{
+	BOOL bMatched;
+	BOOL bCurrentMatch = TRUE;
+
+	while (*szWildcard != '\0' && *szString != '\0' && bCurrentMatch)
+	{
+		switch (*szWildcard)
+		{
+		case '*':
+			bMatched = FALSE;
+
+			if (*(szWildcard + 1) != '\0')
+			{
+				bMatched = LegacyCheckWildcardMatch(++szWildcard, szString, bCaseSensitive);
+			}
+
+			while (*szWildcard != '\0' && *szString != '\0' && !bMatched)
+			{
+				bMatched = LegacyCheckWildcardMatch(szWildcard, ++szString, bCaseSensitive);
+			}
+
+			if (bMatched)
+			{
+				while (*szWildcard != '\0')
+				{
+					szWildcard++;
+				}
+
+				szWildcard--;
+
+				while (*szString != '\0')
+				{
+					szString++;
+				}
+			}
+
+			bCurrentMatch = bMatched;
+			break;
+
+		case '?':
+			szString++;
+			break;
+
+		default:
+			if (bCaseSensitive)
+			{
+				bCurrentMatch = (*szWildcard == *szString);
+			}
+			else
+			{
+				TCHAR szCharacter1[1];
+				LCMapString(LOCALE_USER_DEFAULT, LCMAP_LOWERCASE, szWildcard, 1, szCharacter1,
+					static_cast<int>(std::size(szCharacter1)));
+
+				TCHAR szCharacter2[1];
+				LCMapString(LOCALE_USER_DEFAULT, LCMAP_LOWERCASE, szString, 1, szCharacter2,
+					static_cast<int>(std::size(szCharacter2)));
+
+				bCurrentMatch = (szCharacter1[0] == szCharacter2[0]);
+			}
+
+			szString++;
+			break;
+		}
+
+		szWildcard++;
+	}
+
+	while (*szWildcard == '*')
+	{
+		szWildcard++;
+	}
+
+	return *szWildcard == '\0' && *szString == '\0' && bCurrentMatch;
+}
+
+BOOL LegacyCheckWildcardMatch(const TCHAR *szWildcard, const TCHAR *szString, BOOL bCaseSensitive)
+{
+	if (!wcschr(szWildcard, ':'))
+	{
+		return LegacyCheckWildcardMatchInternal(szWildcard, szString, bCaseSensitive);
+	}
+
+	TCHAR szWildcardPattern[512];
+	TCHAR *szRemainingPattern = nullptr;
+
+	StringCchCopy(szWildcardPattern, std::size(szWildcardPattern), szWildcard);
+
+	TCHAR *szSinglePattern = wcstok_s(szWildcardPattern, _T(":"), &szRemainingPattern);
+
+	while (szSinglePattern != nullptr)
+	{
+		PathRemoveBlanks(szSinglePattern);
+
+		if (LegacyCheckWildcardMatchInternal(szSinglePattern, szString, bCaseSensitive))
+		{
+			return TRUE;
+		}
+
+		szSinglePattern = wcstok_s(nullptr, _T(":"), &szRemainingPattern);
+	}
+
+	return FALSE;
+}
+
+std::vector<std::wstring> GenerateNames(std::span<const wchar_t *const> prefixes)
+{
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<size_t> prefixDistribution(0, prefixes.size() - 1);
+	std::uniform_int_distribution<size_t> extensionDistribution(0, std::size(FILE_EXTENSIONS) - 1);
+	std::uniform_int_distribution<int> numberDistribution(0, 99'999);
+
+	std::vector<std::wstring> names;
+	names.reserve(NUM_NAMES);
+
+	for (int i = 0; i < NUM_NAMES; i++)
+	{
+		names.push_back(prefixes[prefixDistribution(generator)]
+			+ std::to_wstring(numberDistribution(generator))
+			+ FILE_EXTENSIONS[extensionDistribution(generator)]);
+	}
+
+	return names;
+}
+
+// Returns the number of names that matched, along with the time taken.
+template <typename MatchFunction>
+std::pair<int, double> MeasureMatches(const std::vector<std::wstring> &names,
+	MatchFunction matchFunction)
+{
+	int numMatches = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (const auto &name : names)
+	{
+		if (matchFunction(name))
+		{
+			numMatches++;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	return { numMatches, std::chrono::duration<double, std::milli>(end - start).count() };
+}
+
+void MeasurePattern(const std::vector<std::wstring> &names, const wchar_t *patternText,
+	bool caseSensitive)
+{
+	auto [legacyMatches, legacyTime] = MeasureMatches(names,
+		[patternText, caseSensitive](const std::wstring &name)
+		{ return LegacyCheckWildcardMatch(patternText, name.c_str(), caseSensitive); });
+
+	auto [perCallMatches, perCallTime] = MeasureMatches(names,
+		[patternText, caseSensitive](const std::wstring &name)
+		{ return CheckWildcardMatch(patternText, name.c_str(), caseSensitive); });
+
+	WildcardPattern pattern(patternText, caseSensitive);
+
+	auto [compiledMatches, compiledTime] = MeasureMatches(names,
+		[&pattern](const std::wstring &name) { return pattern.Matches(name); });
+
+	if (perCallMatches != legacyMatches || compiledMatches != legacyMatches)
+	{
+		wprintf(L"%-24ls failed\n", patternText);
+		return;
+	}
+
+	wprintf(L"%-24ls %10d %14.1f %14.1f %14.1f\n", patternText, legacyMatches, legacyTime,
+		perCallTime, compiledTime);
+}
+
+double MeasurePerNameNanoseconds(const std::vector<std::wstring> &names,
+	const WildcardPattern &pattern)
+{
+	auto matchFunction = [&pattern](const std::wstring &name) { return pattern.Matches(name); };
+	double milliseconds = MeasureMatches(names, matchFunction).second;
+
+	return milliseconds * 1'000'000 / static_cast<double>(names.size());
+}
+
+// Measures the cost of matching a single name against a WildcardPattern, for each set of names.
+void RunPerNameBenchmark()
+{
+	struct NameSet
+	{
+		const wchar_t *description;
+		std::vector<std::wstring> names;
+	};
+
+	const NameSet nameSets[] = { { L"ASCII", GenerateNames(NAME_PREFIXES) },
+		{ L"Non-ASCII", GenerateNames(NON_ASCII_NAME_PREFIXES) },
+		{ L"Long ASCII", GenerateNames(LONG_NAME_PREFIXES) } };
+
+	wprintf(L"\nPer-name cost of compiled patterns (ns)\n\n");
+	wprintf(L"%-12ls %-24ls %18ls %18ls\n", L"Names", L"Pattern", L"Case-insensitive",
+		L"Case-sensitive");
+
+	for (const auto &nameSet : nameSets)
+	{
+		for (auto patternText : PER_NAME_PATTERNS)
+		{
+			wprintf(L"%-12ls %-24ls %18.1f %18.1f\n", nameSet.description, patternText,
+				MeasurePerNameNanoseconds(nameSet.names, WildcardPattern(patternText, false)),
+				MeasurePerNameNanoseconds(nameSet.names, WildcardPattern(patternText, true)));
+		}
+	}
+}
+
+}
+
+void RunWildcardBenchmark()
+{
+	wprintf(L"Wildcard matching (%d names)\n", NUM_NAMES);
+
+	auto names = GenerateNames(NAME_PREFIXES);
+
+	for (bool caseSensitive : { false, true })
+	{
+		wprintf(L"\n%ls\n\n", caseSensitive ? L"Case-sensitive" : L"Case-insensitive");
+		wprintf(L"%-24ls %10ls %14ls %14ls %14ls\n", L"Pattern", L"Matches", L"Legacy (ms)",
+			L"Per call (ms)", L"Compiled (ms)");
+
+		for (auto patternText : PATTERNS)
+		{
+			MeasurePattern(names, patternText, caseSensitive);
+		}
+	}
+
+	RunPerNameBenchmark();
+}
@@ -0,0 +1,12 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+// Matches a set of wildcard patterns against 500,000 synthetic file names. The patterns are matched
+// with the previous implementation of CheckWildcardMatch, with the current CheckWildcardMatch
+// (which parses the pattern on each call) and with a WildcardPattern that's constructed once. Then
+// measures the per-name cost of WildcardPattern for sets of ASCII, non-ASCII and long names, which
+// determine whether the vectorized comparisons can be used. Writes the timings to stdout.
+void RunWildcardBenchmark();
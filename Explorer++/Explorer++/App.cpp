@@ -21,6 +21,8 @@
 #include "RegistryAppStorageFactory.h"
 #include "ResourceHelper.h"
 #include "ResourceManager.h"
+#include "ShellBrowser/ColumnValueCache.h"
+#include "Storage.h"
 #include "TabStorage.h"
 #include "UIThreadExecutor.h"
 #include "Win32ResourceLoader.h"
@@ -43,6 +45,8 @@ App::App(const CommandLine::Settings *commandLineSettings) :
 	m_acceleratorManager(InitializeAcceleratorManager()),
 	m_cachedIcons(std::make_shared<CachedIcons>(MAX_CACHED_ICONS)),
 	m_iconFetcher(std::make_shared<AsyncIconFetcher>(&m_runtime, m_cachedIcons)),
+	m_columnValueCache(std::make_unique<ColumnValueCache>(Storage::GetColumnValueCacheFilePath(),
+		MAX_COLUMN_VALUE_CACHE_SIZE)),
 	m_colorRuleModel(ColorRuleModelFactory::Create()),
 	m_resourceInstance(GetModuleHandle(nullptr)),
 	m_processManager(&m_browserList),
@@ -375,6 +379,11 @@ CachedIcons *App::GetCachedIcons()
 	return m_cachedIcons.get();
 }
 
+ColumnValueCache *App::GetColumnValueCache()
+{
+	return m_columnValueCache.get();
+}
+
 std::shared_ptr<AsyncIconFetcher> App::GetIconFetcher()
 {
 	return m_iconFetcher;
@@ -530,6 +539,7 @@ void App::OnExitStarted()
 	// begins.
 	m_saveSettingsTimer.cancel();
 	SaveSettings();
+	m_columnValueCache->Save();
 
 	m_exitStarted = true;
 }
@@ -544,4 +554,5 @@ void App::SessionEnding()
 	}
 
 	SaveSettings();
+	m_columnValueCache->Save();
 }
@@ -30,6 +30,7 @@
 class AsyncIconFetcher;
 class CachedIcons;
 class ColorRuleModel;
+class ColumnValueCache;
 class IconResourceLoader;
 struct WindowStorageData;
 
@@ -53,6 +54,7 @@ public:
 	AcceleratorManager *GetAcceleratorManager();
 	Config *GetConfig();
 	CachedIcons *GetCachedIcons();
+	ColumnValueCache *GetColumnValueCache();
 	std::shared_ptr<AsyncIconFetcher> GetIconFetcher();
 	BrowserList *GetBrowserList();
 	ModelessDialogList *GetModelessDialogList();
@@ -76,6 +78,10 @@ private:
 	// various components in the application.
 	static constexpr int MAX_CACHED_ICONS = 1000;
 
+	// The maximum size of the on-disk cache of column values. When the cache is saved, the least
+	// recently used values are evicted until the cache fits within this limit.
+	static constexpr uint64_t MAX_COLUMN_VALUE_CACHE_SIZE = 32 * 1024 * 1024;
+
 	static constexpr int MIN_COM_STA_THREADPOOL_SIZE = 5;
 
 	void OnBrowserRemoved();
@@ -102,6 +108,7 @@ private:
 	Config m_config;
 	std::shared_ptr<CachedIcons> m_cachedIcons;
 	std::shared_ptr<AsyncIconFetcher> m_iconFetcher;
+	std::unique_ptr<ColumnValueCache> m_columnValueCache;
 	BrowserList m_browserList;
 	ModelessDialogList m_modelessDialogList;
 	BookmarkTree m_bookmarkTree;
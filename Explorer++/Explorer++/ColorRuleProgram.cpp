@@ -0,0 +1,62 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ColorRuleProgram.h"
+#include "ColorRuleModel.h"
+
+ColorRuleProgram::ColorRuleProgram(const ColorRuleModel *model)
+{
+	m_rules.reserve(model->GetItems().size());
+
+	for (const auto &colorRule : model->GetItems())
+	{
+		CompiledRule rule;
+
+		if (!colorRule->GetFilterPattern().empty())
+		{
+			rule.filterPattern = colorRule->GetCompiledFilterPattern();
+		}
+
+		rule.attributeMask = colorRule->GetFilterAttributes();
+		rule.color = colorRule->GetColor();
+
+		m_rules.push_back(std::move(rule));
+	}
+}
+
+std::optional<size_t> ColorRuleProgram::Evaluate(std::wstring_view fileName,
+	std::optional<DWORD> attributes) const
+{
+	for (size_t i = 0; i < m_rules.size(); i++)
+	{
+		const auto &rule = m_rules[i];
+
+		// The attribute check is done first, since it's much cheaper than matching the file name.
+		if (rule.attributeMask != 0
+			&& (!attributes || WI_AreAllFlagsClear(*attributes, rule.attributeMask)))
+		{
+			continue;
+		}
+
+		if (rule.filterPattern && !rule.filterPattern->Matches(fileName))
+		{
+			continue;
+		}
+
+		return i;
+	}
+
+	return std::nullopt;
+}
+
+COLORREF ColorRuleProgram::GetColor(size_t ruleIndex) const
+{
+	return m_rules.at(ruleIndex).color;
+}
+
+size_t ColorRuleProgram::GetRuleCount() const
+{
+	return m_rules.size();
+}
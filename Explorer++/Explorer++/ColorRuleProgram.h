@@ -0,0 +1,45 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "../Helper/WildcardPattern.h"
+#include <optional>
+#include <string_view>
+#include <vector>
+
+class ColorRuleModel;
+
+// A snapshot of the color rules in a ColorRuleModel, in a form that can be evaluated cheaply
+// against a large number of items. The program doesn't observe the model, so it needs to be
+// rebuilt whenever the color rules change.
+class ColorRuleProgram
+{
+public:
+	ColorRuleProgram() = default;
+	explicit ColorRuleProgram(const ColorRuleModel *model);
+
+	// Returns the index of the first rule that matches the specified item, or std::nullopt if no
+	// rule matches. If the attributes of the item aren't known, rules that filter on attributes
+	// won't match.
+	std::optional<size_t> Evaluate(std::wstring_view fileName,
+		std::optional<DWORD> attributes) const;
+
+	COLORREF GetColor(size_t ruleIndex) const;
+	size_t GetRuleCount() const;
+
+private:
+	struct CompiledRule
+	{
+		// Rules with an empty filter pattern match every file name.
+		std::optional<WildcardPattern> filterPattern;
+
+		// Rules with an attribute mask of 0 match every item, regardless of its attributes.
+		DWORD attributeMask;
+
+		COLORREF color;
+	};
+
+	std::vector<CompiledRule> m_rules;
+};
@@ -43,10 +43,8 @@ void ComStaThreadPoolExecutor::enqueue(std::span<concurrencpp::task> tasks)
 
 	lock.unlock();
 
-	// Note that this will only wake a single thread, which is problematic if multiple tasks are
-	// being queued at once. In practice, that shouldn't be an issue, since the application really
-	// only needs to queue one task at a time. Although this overloaded version of enqueue() is
-	// present, it only exists to satisfy the interface declared by concurrencpp::executor.
+	// Note that this will only wake a single thread. If multiple tasks are queued, that thread will
+	// wake another thread once it has taken a task (see RunTask()).
 	m_taskQueuedEvent.SetEvent();
 }
 
@@ -146,8 +144,18 @@ bool ComStaThreadPoolExecutor::RunTask()
 	auto task = std::move(m_queue.front());
 	m_queue.pop();
 
+	bool tasksRemaining = !m_queue.empty();
+
 	lock.unlock();
 
+	// The event is auto-reset and will only have woken a single thread, so if there are still
+	// tasks waiting, another thread needs to be woken to run them. Otherwise, a burst of tasks
+	// would be run one at a time.
+	if (tasksRemaining)
+	{
+		m_taskQueuedEvent.SetEvent();
+	}
+
 	task();
 
 	return true;
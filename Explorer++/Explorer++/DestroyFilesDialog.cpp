@@ -11,6 +11,19 @@
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/StringHelper.h"
 #include "../Helper/XMLSettings.h"
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+
+constexpr UINT WM_APP_DESTROYPROGRESS = WM_APP + 1;
+constexpr UINT WM_APP_DESTROYFINISHED = WM_APP + 2;
+
+// Progress is reported in tenths of a percent.
+constexpr int PROGRESS_RANGE = 1000;
+
+}
 
 const TCHAR DestroyFilesDialogPersistentSettings::SETTINGS_KEY[] = _T("DestroyFiles");
 
@@ -18,9 +31,10 @@ const TCHAR DestroyFilesDialogPersistentSettings::SETTING_OVERWRITE_METHOD[] =
 	_T("OverwriteMethod");
 
 DestroyFilesDialog::DestroyFilesDialog(HINSTANCE resourceInstance, HWND hParent,
-	ThemeManager *themeManager, const std::list<std::wstring> &FullFilenameList,
-	BOOL bShowFriendlyDates) :
-	ThemedDialog(resourceInstance, IDD_DESTROYFILES, hParent, DialogSizingType::Both, themeManager)
+	ThemeManager *themeManager, BackgroundWorkPool *workPool,
+	const std::list<std::wstring> &FullFilenameList, BOOL bShowFriendlyDates) :
+	ThemedDialog(resourceInstance, IDD_DESTROYFILES, hParent, DialogSizingType::Both, themeManager),
+	m_workPool(workPool)
 {
 	m_FullFilenameList = FullFilenameList;
 	m_bShowFriendlyDates = bShowFriendlyDates;
@@ -122,6 +136,8 @@ INT_PTR DestroyFilesDialog::OnInitDialog()
 		break;
 	}
 
+	SendDlgItemMessage(m_hDlg, IDC_DESTROYFILES_PROGRESS, PBM_SETRANGE32, 0, PROGRESS_RANGE);
+
 	m_pdfdps->RestoreDialogPosition(m_hDlg, true);
 
 	return 0;
@@ -140,6 +156,8 @@ std::vector<ResizableDialogControl> DestroyFilesDialog::GetResizableControls()
 		MovingType::Vertical, SizingType::None);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDC_DESTROYFILES_STATIC_WARNING_MESSAGE),
 		MovingType::Vertical, SizingType::Horizontal);
+	controls.emplace_back(GetDlgItem(m_hDlg, IDC_DESTROYFILES_PROGRESS), MovingType::Vertical,
+		SizingType::Horizontal);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDOK), MovingType::Both, SizingType::None);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDCANCEL), MovingType::Both, SizingType::None);
 	return controls;
@@ -165,7 +183,25 @@ INT_PTR DestroyFilesDialog::OnCommand(WPARAM wParam, LPARAM lParam)
 
 INT_PTR DestroyFilesDialog::OnClose()
 {
-	EndDialog(m_hDlg, 0);
+	OnCancel();
+	return 0;
+}
+
+INT_PTR DestroyFilesDialog::OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	UNREFERENCED_PARAMETER(lParam);
+
+	switch (uMsg)
+	{
+	case WM_APP_DESTROYPROGRESS:
+		SendDlgItemMessage(m_hDlg, IDC_DESTROYFILES_PROGRESS, PBM_SETPOS, wParam, 0);
+		break;
+
+	case WM_APP_DESTROYFINISHED:
+		OnDestroyFinished(wParam);
+		break;
+	}
+
 	return 0;
 }
 
@@ -209,6 +245,16 @@ void DestroyFilesDialog::OnOk()
 
 void DestroyFilesDialog::OnCancel()
 {
+	if (m_destroyingFiles)
+	{
+		// Any file that's currently being overwritten will be left in place. The dialog will be
+		// closed once the background thread has stopped.
+		m_cancelRequested = true;
+		m_destroyThread.request_stop();
+		EnableWindow(GetDlgItem(m_hDlg, IDCANCEL), FALSE);
+		return;
+	}
+
 	EndDialog(m_hDlg, 0);
 }
 
@@ -225,10 +271,52 @@ void DestroyFilesDialog::OnConfirmDestroy()
 		overwriteMethod = FileOperations::OverwriteMethod::ThreePass;
 	}
 
-	/* TODO: Perform in background thread. */
-	for (const auto &strFullFilename : m_FullFilenameList)
+	m_destroyingFiles = true;
+
+	EnableWindow(GetDlgItem(m_hDlg, IDOK), FALSE);
+	EnableWindow(GetDlgItem(m_hDlg, IDC_DESTROYFILES_RADIO_ONEPASS), FALSE);
+	EnableWindow(GetDlgItem(m_hDlg, IDC_DESTROYFILES_RADIO_THREEPASS), FALSE);
+
+	std::vector<std::wstring> paths(m_FullFilenameList.begin(), m_FullFilenameList.end());
+
+	// The thread only refers to the dialog through its window handle. The dialog won't be closed
+	// until the finished message has been received, so the handle will remain valid for as long as
+	// the thread runs.
+	m_destroyThread = std::jthread(
+		[hDlg = m_hDlg, workPool = m_workPool, paths = std::move(paths), overwriteMethod](
+			std::stop_token stopToken)
+		{
+			std::atomic<int> lastProgress = 0;
+
+			auto progressCallback = [hDlg, &lastProgress](uint64_t numBytesWritten,
+										uint64_t totalBytes)
+			{
+				int progress =
+					static_cast<int>(numBytesWritten * PROGRESS_RANGE / std::max(totalBytes, 1ull));
+
+				// Only post a message when the position actually changes, since a message could
+				// otherwise be posted for every block written.
+				if (lastProgress.exchange(progress) != progress)
+				{
+					PostMessage(hDlg, WM_APP_DESTROYPROGRESS, progress, 0);
+				}
+			};
+
+			size_t numFailed = FileOperations::DeleteFilesSecurely(paths, overwriteMethod,
+				workPool, progressCallback, stopToken);
+			PostMessage(hDlg, WM_APP_DESTROYFINISHED, numFailed, 0);
+		});
+}
+
+void DestroyFilesDialog::OnDestroyFinished(size_t numFailed)
+{
+	m_destroyingFiles = false;
+	m_destroyThread.join();
+
+	if (numFailed > 0 && !m_cancelRequested)
 	{
-		DeleteFileSecurely(strFullFilename, overwriteMethod);
+		auto message = ResourceHelper::LoadString(GetResourceInstance(), IDS_DESTROY_FILES_FAILED);
+		MessageBox(m_hDlg, message.c_str(), App::APP_NAME, MB_ICONWARNING | MB_OK);
 	}
 
 	EndDialog(m_hDlg, 1);
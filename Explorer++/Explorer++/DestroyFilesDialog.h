@@ -9,7 +9,9 @@
 #include "../Helper/FileOperations.h"
 #include "../Helper/ResizableDialogHelper.h"
 #include <wil/resource.h>
+#include <thread>
 
+class BackgroundWorkPool;
 class DestroyFilesDialog;
 
 class DestroyFilesDialogPersistentSettings : public DialogSettings
@@ -42,12 +44,14 @@ class DestroyFilesDialog : public ThemedDialog
 {
 public:
 	DestroyFilesDialog(HINSTANCE resourceInstance, HWND hParent, ThemeManager *themeManager,
-		const std::list<std::wstring> &FullFilenameList, BOOL bShowFriendlyDates);
+		BackgroundWorkPool *workPool, const std::list<std::wstring> &FullFilenameList,
+		BOOL bShowFriendlyDates);
 
 protected:
 	INT_PTR OnInitDialog() override;
 	INT_PTR OnCommand(WPARAM wParam, LPARAM lParam) override;
 	INT_PTR OnClose() override;
+	INT_PTR OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) override;
 
 private:
 	std::vector<ResizableDialogControl> GetResizableControls() override;
@@ -56,7 +60,9 @@ private:
 	void OnOk();
 	void OnCancel();
 	void OnConfirmDestroy();
+	void OnDestroyFinished(size_t numFailed);
 
+	BackgroundWorkPool *const m_workPool;
 	std::list<std::wstring> m_FullFilenameList;
 
 	wil::unique_hicon m_icon;
@@ -64,4 +70,12 @@ private:
 	DestroyFilesDialogPersistentSettings *m_pdfdps;
 
 	BOOL m_bShowFriendlyDates;
+
+	bool m_destroyingFiles = false;
+	bool m_cancelRequested = false;
+
+	// The files are overwritten on a background thread, so that the dialog remains responsive and
+	// can show progress. This is declared last, so that the thread is stopped and joined before
+	// any other members are destroyed.
+	std::jthread m_destroyThread;
 };
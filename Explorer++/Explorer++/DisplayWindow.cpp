@@ -121,56 +121,61 @@ void Explorerplusplus::UpdateDisplayWindowForOneFile(const Tab &tab)
 			if (((dwAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
 				&& m_config->globalFolderSettings.showFolderSizes)
 			{
-				FolderSize_t *pfs = nullptr;
-				FolderSizeExtraInfo *pfsei = nullptr;
-				DWFolderSize displayWindowFolderSize;
 				TCHAR szDisplayText[256];
 				TCHAR szTotalSize[64];
 				TCHAR szCalculating[64];
-				DWORD threadId;
-
-				pfs = (FolderSize_t *) malloc(sizeof(FolderSize_t));
 
-				if (pfs != nullptr)
-				{
-					pfsei = (FolderSizeExtraInfo *) malloc(sizeof(FolderSizeExtraInfo));
+				LoadString(m_app->GetResourceInstance(), IDS_GENERAL_TOTALSIZE, szTotalSize,
+					std::size(szTotalSize));
+				LoadString(m_app->GetResourceInstance(), IDS_GENERAL_CALCULATING, szCalculating,
+					std::size(szCalculating));
+				StringCchPrintf(szDisplayText, std::size(szDisplayText), _T("%s: %s"), szTotalSize,
+					szCalculating);
+				DisplayWindow_BufferText(m_displayWindow->GetHWND(), szDisplayText);
 
-					if (pfsei != nullptr)
-					{
-						pfsei->pContainer = (void *) this;
-						pfsei->uId = m_iDWFolderSizeUniqueId;
-						pfs->pData = (LPVOID) pfsei;
-
-						pfs->pfnCallback = FolderSizeCallbackStub;
-
-						StringCchCopy(pfs->szPath, std::size(pfs->szPath), fullItemName.c_str());
-
-						LoadString(m_app->GetResourceInstance(), IDS_GENERAL_TOTALSIZE, szTotalSize,
-							std::size(szTotalSize));
-						LoadString(m_app->GetResourceInstance(), IDS_GENERAL_CALCULATING,
-							szCalculating, std::size(szCalculating));
-						StringCchPrintf(szDisplayText, std::size(szDisplayText), _T("%s: %s"),
-							szTotalSize, szCalculating);
-						DisplayWindow_BufferText(m_displayWindow->GetHWND(), szDisplayText);
-
-						/* Maintain a global list of folder size operations. */
-						displayWindowFolderSize.uId = m_iDWFolderSizeUniqueId;
-						displayWindowFolderSize.iTabId =
-							GetActivePane()->GetTabContainer()->GetSelectedTab().GetId();
-						displayWindowFolderSize.bValid = TRUE;
-						m_DWFolderSizes.push_back(displayWindowFolderSize);
-
-						HANDLE hThread = CreateThread(nullptr, 0, Thread_CalculateFolderSize,
-							(LPVOID) pfs, 0, &threadId);
-						CloseHandle(hThread);
-
-						m_iDWFolderSizeUniqueId++;
-					}
-					else
+				/* Maintain a global list of folder size operations. */
+				DWFolderSize displayWindowFolderSize;
+				displayWindowFolderSize.uId = m_iDWFolderSizeUniqueId;
+				displayWindowFolderSize.iTabId =
+					GetActivePane()->GetTabContainer()->GetSelectedTab().GetId();
+				displayWindowFolderSize.bValid = TRUE;
+				m_DWFolderSizes.push_back(displayWindowFolderSize);
+
+				m_folderSizeTaskGroup.Push(
+					[hContainer = m_hContainer, uId = m_iDWFolderSizeUniqueId, fullItemName](
+						std::stop_token stopToken)
 					{
-						free(pfs);
-					}
-				}
+						auto folderInfo = GetFolderInfo(fullItemName, stopToken);
+
+						if (!folderInfo)
+						{
+							// The calculation was cancelled, because the selection changed.
+							return;
+						}
+
+						auto *pDWFolderSizeCompletion = static_cast<DWFolderSizeCompletion *>(
+							malloc(sizeof(DWFolderSizeCompletion)));
+
+						if (!pDWFolderSizeCompletion)
+						{
+							return;
+						}
+
+						pDWFolderSizeCompletion->liFolderSize.QuadPart = folderInfo->size;
+						pDWFolderSizeCompletion->uId = uId;
+
+						/* Queue the result back to the main thread, so that
+						the folder size can be displayed. It is up to the main
+						thread to determine whether the folder size should actually
+						be shown. */
+						if (!PostMessage(hContainer, WM_APP_FOLDERSIZECOMPLETED,
+								reinterpret_cast<WPARAM>(pDWFolderSizeCompletion), 0))
+						{
+							free(pDWFolderSizeCompletion);
+						}
+					});
+
+				m_iDWFolderSizeUniqueId++;
 			}
 			else
 			{
@@ -27,6 +27,7 @@
 #include "Theme.h"
 #include "ValueWrapper.h"
 #include "WindowStorage.h"
+#include "../Helper/BackgroundWorkPool.h"
 #include "../Helper/ClipboardHelper.h"
 #include "../Helper/DropHandler.h"
 #include "../Helper/FileActionHandler.h"
@@ -185,12 +186,6 @@ private:
 		BOOL bValid;
 	};
 
-	struct FolderSizeExtraInfo
-	{
-		void *pContainer;
-		int uId;
-	};
-
 	enum class FocusChangeDirection
 	{
 		Previous,
@@ -526,10 +521,6 @@ private:
 	void StopDirectoryMonitoringForTab(const Tab &tab);
 	int DetermineListViewObjectIndex(HWND hListView);
 
-	static void FolderSizeCallbackStub(int nFolders, int nFiles, PULARGE_INTEGER lTotalFolderSize,
-		LPVOID pData);
-	void FolderSizeCallback(FolderSizeExtraInfo *pfsei, int nFolders, int nFiles,
-		PULARGE_INTEGER lTotalFolderSize);
 
 	bool ConfirmClose();
 
@@ -656,6 +647,7 @@ private:
 	/* Display window folder sizes. */
 	std::list<DWFolderSize> m_DWFolderSizes;
 	int m_iDWFolderSizeUniqueId;
+	TaskGroup m_folderSizeTaskGroup;
 
 	// WM_DEVICECHANGE notifications
 	DeviceChangeSignal m_deviceChangeSignal;
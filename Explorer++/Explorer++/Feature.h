@@ -16,6 +16,10 @@ BETTER_ENUM(Feature, int,
 
 	// When enabled, the application will allow multiple windows to be created and restored in each
 	// session, rather than just a single window.
-	MultipleWindowsPerSession
+	MultipleWindowsPerSession,
+
+	// When enabled, the listview in each tab will be created as a virtual (owner-data) listview,
+	// with the items it displays held by the tab, rather than by the listview control.
+	VirtualListView
 )
 // clang-format on
@@ -17,6 +17,7 @@
 const TCHAR FilterDialogPersistentSettings::SETTINGS_KEY[] = _T("Filter");
 
 const TCHAR FilterDialogPersistentSettings::SETTING_FILTER_LIST[] = _T("Filter");
+const TCHAR FilterDialogPersistentSettings::SETTING_FILTER_AS_YOU_TYPE[] = _T("FilterAsYouType");
 
 FilterDialog::FilterDialog(HINSTANCE resourceInstance, HWND hParent, ThemeManager *themeManager,
 	CoreInterface *coreInterface, const IconResourceLoader *iconResourceLoader) :
@@ -31,6 +32,11 @@ INT_PTR FilterDialog::OnInitDialog()
 {
 	HWND hComboBox = GetDlgItem(m_hDlg, IDC_FILTER_COMBOBOX);
 
+	auto *shellBrowser = m_coreInterface->GetActiveShellBrowserImpl();
+	m_originalFilter = shellBrowser->GetFilterText();
+	m_originalFilterCaseSensitive = shellBrowser->GetFilterCaseSensitive();
+	m_originalFilterApplied = shellBrowser->IsFilterApplied();
+
 	SetFocus(hComboBox);
 
 	for (const auto &strFilter : m_persistentSettings->m_FilterList)
@@ -39,17 +45,20 @@ INT_PTR FilterDialog::OnInitDialog()
 			reinterpret_cast<LPARAM>(strFilter.c_str()));
 	}
 
-	std::wstring filter = m_coreInterface->GetActiveShellBrowserImpl()->GetFilterText();
-
-	ComboBox_SelectString(hComboBox, -1, filter.c_str());
+	ComboBox_SelectString(hComboBox, -1, m_originalFilter.c_str());
 
 	SendMessage(hComboBox, CB_SETEDITSEL, 0, MAKELPARAM(0, -1));
 
-	if (m_coreInterface->GetActiveShellBrowserImpl()->GetFilterCaseSensitive())
+	if (m_originalFilterCaseSensitive)
 	{
 		CheckDlgButton(m_hDlg, IDC_FILTERS_CASESENSITIVE, BST_CHECKED);
 	}
 
+	if (m_persistentSettings->m_filterAsYouType)
+	{
+		CheckDlgButton(m_hDlg, IDC_FILTERS_FILTER_AS_YOU_TYPE, BST_CHECKED);
+	}
+
 	m_persistentSettings->RestoreDialogPosition(m_hDlg, true);
 
 	return 0;
@@ -67,6 +76,8 @@ std::vector<ResizableDialogControl> FilterDialog::GetResizableControls()
 		SizingType::Horizontal);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDC_FILTERS_CASESENSITIVE), MovingType::None,
 		SizingType::Horizontal);
+	controls.emplace_back(GetDlgItem(m_hDlg, IDC_FILTERS_FILTER_AS_YOU_TYPE), MovingType::None,
+		SizingType::Horizontal);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDOK), MovingType::Horizontal, SizingType::None);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDCANCEL), MovingType::Horizontal, SizingType::None);
 	return controls;
@@ -78,6 +89,40 @@ INT_PTR FilterDialog::OnCommand(WPARAM wParam, LPARAM lParam)
 
 	switch (LOWORD(wParam))
 	{
+	case IDC_FILTER_COMBOBOX:
+		switch (HIWORD(wParam))
+		{
+		case CBN_EDITCHANGE:
+			ApplyFilterAsYouType(GetWindowString(GetDlgItem(m_hDlg, IDC_FILTER_COMBOBOX)));
+			break;
+
+		case CBN_SELCHANGE:
+		{
+			// The text in the edit control hasn't been updated at the point this notification is
+			// sent, so the text needs to be retrieved from the list instead.
+			HWND hComboBox = GetDlgItem(m_hDlg, IDC_FILTER_COMBOBOX);
+			int selectedIndex = ComboBox_GetCurSel(hComboBox);
+
+			if (selectedIndex != CB_ERR)
+			{
+				std::wstring filter(ComboBox_GetLBTextLen(hComboBox, selectedIndex) + 1, '\0');
+				ComboBox_GetLBText(hComboBox, selectedIndex, filter.data());
+				filter.resize(filter.find('\0'));
+				ApplyFilterAsYouType(filter);
+			}
+		}
+		break;
+		}
+		break;
+
+	case IDC_FILTERS_CASESENSITIVE:
+		ApplyFilterAsYouType(GetWindowString(GetDlgItem(m_hDlg, IDC_FILTER_COMBOBOX)));
+		break;
+
+	case IDC_FILTERS_FILTER_AS_YOU_TYPE:
+		OnFilterAsYouTypeToggled();
+		break;
+
 	case IDOK:
 		OnOk();
 		break;
@@ -90,6 +135,65 @@ INT_PTR FilterDialog::OnCommand(WPARAM wParam, LPARAM lParam)
 	return 0;
 }
 
+bool FilterDialog::IsFilterAsYouTypeEnabled() const
+{
+	return IsDlgButtonChecked(m_hDlg, IDC_FILTERS_FILTER_AS_YOU_TYPE) == BST_CHECKED;
+}
+
+void FilterDialog::OnFilterAsYouTypeToggled()
+{
+	if (IsFilterAsYouTypeEnabled())
+	{
+		ApplyFilterAsYouType(GetWindowString(GetDlgItem(m_hDlg, IDC_FILTER_COMBOBOX)));
+	}
+	else
+	{
+		RestoreOriginalFilter();
+	}
+}
+
+// Applies the filter immediately, so that the results can be seen while the filter is being typed.
+// The tab only updates the items whose visibility has changed, so this remains cheap even in large
+// folders.
+void FilterDialog::ApplyFilterAsYouType(const std::wstring &filter)
+{
+	if (!IsFilterAsYouTypeEnabled())
+	{
+		return;
+	}
+
+	auto *shellBrowser = m_coreInterface->GetActiveShellBrowserImpl();
+
+	// Until something has been entered, the original set of items should be shown.
+	if (filter.empty() && !m_originalFilterApplied)
+	{
+		RestoreOriginalFilter();
+		return;
+	}
+
+	shellBrowser->SetFilterCaseSensitive(
+		IsDlgButtonChecked(m_hDlg, IDC_FILTERS_CASESENSITIVE) == BST_CHECKED);
+	shellBrowser->SetFilterText(filter);
+
+	if (!shellBrowser->IsFilterApplied())
+	{
+		shellBrowser->SetFilterApplied(true);
+	}
+}
+
+void FilterDialog::RestoreOriginalFilter()
+{
+	auto *shellBrowser = m_coreInterface->GetActiveShellBrowserImpl();
+
+	if (shellBrowser->IsFilterApplied() != m_originalFilterApplied)
+	{
+		shellBrowser->SetFilterApplied(m_originalFilterApplied);
+	}
+
+	shellBrowser->SetFilterCaseSensitive(m_originalFilterCaseSensitive);
+	shellBrowser->SetFilterText(m_originalFilter);
+}
+
 INT_PTR FilterDialog::OnClose()
 {
 	EndDialog(m_hDlg, 0);
@@ -139,6 +243,11 @@ void FilterDialog::OnOk()
 
 void FilterDialog::OnCancel()
 {
+	if (IsFilterAsYouTypeEnabled())
+	{
+		RestoreOriginalFilter();
+	}
+
 	EndDialog(m_hDlg, 0);
 }
 
@@ -146,10 +255,14 @@ void FilterDialog::SaveState()
 {
 	m_persistentSettings->SaveDialogPosition(m_hDlg);
 
+	m_persistentSettings->m_filterAsYouType = IsFilterAsYouTypeEnabled();
+
 	m_persistentSettings->m_bStateSaved = TRUE;
 }
 
-FilterDialogPersistentSettings::FilterDialogPersistentSettings() : DialogSettings(SETTINGS_KEY)
+FilterDialogPersistentSettings::FilterDialogPersistentSettings() :
+	DialogSettings(SETTINGS_KEY),
+	m_filterAsYouType(false)
 {
 }
 
@@ -162,23 +275,32 @@ FilterDialogPersistentSettings &FilterDialogPersistentSettings::GetInstance()
 void FilterDialogPersistentSettings::SaveExtraRegistrySettings(HKEY hKey)
 {
 	RegistrySettings::SaveStringList(hKey, SETTING_FILTER_LIST, m_FilterList);
+	RegistrySettings::SaveDword(hKey, SETTING_FILTER_AS_YOU_TYPE, m_filterAsYouType);
 }
 
 void FilterDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 {
 	RegistrySettings::ReadStringList(hKey, SETTING_FILTER_LIST, m_FilterList);
+	RegistrySettings::Read32BitValueFromRegistry(hKey, SETTING_FILTER_AS_YOU_TYPE,
+		m_filterAsYouType);
 }
 
 void FilterDialogPersistentSettings::SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom,
 	IXMLDOMElement *pParentNode)
 {
 	XMLSettings::AddStringListToNode(pXMLDom, pParentNode, SETTING_FILTER_LIST, m_FilterList);
+	XMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_FILTER_AS_YOU_TYPE,
+		XMLSettings::EncodeBoolValue(m_filterAsYouType));
 }
 
 void FilterDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
 {
-	if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, bstrName, lstrlen(SETTING_FILTER_LIST),
-			SETTING_FILTER_LIST, lstrlen(SETTING_FILTER_LIST))
+	if (lstrcmpi(bstrName, SETTING_FILTER_AS_YOU_TYPE) == 0)
+	{
+		m_filterAsYouType = XMLSettings::DecodeBoolValue(bstrValue);
+	}
+	else if (CompareString(LOCALE_INVARIANT, NORM_IGNORECASE, bstrName,
+				 lstrlen(SETTING_FILTER_LIST), SETTING_FILTER_LIST, lstrlen(SETTING_FILTER_LIST))
 		== CSTR_EQUAL)
 	{
 		m_FilterList.emplace_back(bstrValue);
@@ -25,6 +25,7 @@ private:
 	static const TCHAR SETTINGS_KEY[];
 
 	static const TCHAR SETTING_FILTER_LIST[];
+	static const TCHAR SETTING_FILTER_AS_YOU_TYPE[];
 
 	FilterDialogPersistentSettings();
 
@@ -38,6 +39,7 @@ private:
 	void LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue) override;
 
 	std::list<std::wstring> m_FilterList;
+	bool m_filterAsYouType;
 };
 
 class FilterDialog : public ThemedDialog
@@ -60,8 +62,19 @@ private:
 	void OnOk();
 	void OnCancel();
 
+	void OnFilterAsYouTypeToggled();
+	void ApplyFilterAsYouType(const std::wstring &filter);
+	void RestoreOriginalFilter();
+	bool IsFilterAsYouTypeEnabled() const;
+
 	CoreInterface *m_coreInterface;
 	const IconResourceLoader *const m_iconResourceLoader;
 
 	FilterDialogPersistentSettings *m_persistentSettings;
+
+	// The filter that was in place when the dialog was opened. This is restored if the dialog is
+	// cancelled after the filter has been updated as the user typed.
+	std::wstring m_originalFilter;
+	bool m_originalFilterCaseSensitive = false;
+	bool m_originalFilterApplied = false;
 };
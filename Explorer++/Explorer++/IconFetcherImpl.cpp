@@ -7,11 +7,11 @@
 #include "../Helper/CachedIcons.h"
 #include "../Helper/WindowSubclass.h"
 
-IconFetcherImpl::IconFetcherImpl(HWND hwnd, CachedIcons *cachedIcons) :
+IconFetcherImpl::IconFetcherImpl(HWND hwnd, CachedIcons *cachedIcons,
+	BackgroundWorkPool *workPool) :
 	m_hwnd(hwnd),
 	m_cachedIcons(cachedIcons),
-	m_iconThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
-		CoUninitialize),
+	m_iconTaskGroup(workPool),
 	m_iconResultIDCounter(0)
 {
 	FAIL_FAST_IF_FAILED(GetDefaultFileIconIndex(m_defaultFileIconIndex));
@@ -23,7 +23,7 @@ IconFetcherImpl::IconFetcherImpl(HWND hwnd, CachedIcons *cachedIcons) :
 
 IconFetcherImpl::~IconFetcherImpl()
 {
-	m_iconThreadPool.clear_queue();
+	m_iconTaskGroup.CancelPendingTasks();
 }
 
 LRESULT IconFetcherImpl::OwnerWindowSubclass(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -43,11 +43,9 @@ void IconFetcherImpl::QueueIconTask(std::wstring_view path, Callback callback)
 {
 	int iconResultID = m_iconResultIDCounter++;
 
-	auto iconResult = m_iconThreadPool.push(
-		[this, iconResultID, copiedPath = std::wstring(path)](int id) -> std::optional<IconResult>
+	auto iconResult = m_iconTaskGroup.Push(
+		[this, iconResultID, copiedPath = std::wstring(path)]() -> std::optional<IconResult>
 		{
-			UNREFERENCED_PARAMETER(id);
-
 			// SHGetFileInfo will fail for non-filesystem paths that are passed in
 			// as strings. For example, attempting to retrieve the icon for the
 			// recycle bin will fail if you pass the parsing path (i.e.
@@ -93,11 +91,9 @@ void IconFetcherImpl::QueueIconTask(PCIDLIST_ABSOLUTE pidl, Callback callback)
 	BasicItemInfo basicItemInfo;
 	basicItemInfo.pidl.reset(ILCloneFull(pidl));
 
-	auto iconResult = m_iconThreadPool.push(
-		[this, iconResultID, basicItemInfo](int id) -> std::optional<IconResult>
+	auto iconResult = m_iconTaskGroup.Push(
+		[this, iconResultID, basicItemInfo]() -> std::optional<IconResult>
 		{
-			UNREFERENCED_PARAMETER(id);
-
 			// It's important that pidl is updated. Otherwise, the icon that's retrieved may be the
 			// original icon.
 			PidlAbsolute updatedPidl;
@@ -190,7 +186,7 @@ void IconFetcherImpl::ProcessIconResult(int iconResultId)
 
 void IconFetcherImpl::ClearQueue()
 {
-	m_iconThreadPool.clear_queue();
+	m_iconTaskGroup.CancelPendingTasks();
 	m_iconResults.clear();
 }
 
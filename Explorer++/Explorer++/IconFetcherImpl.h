@@ -5,8 +5,8 @@
 #pragma once
 
 #include "IconFetcher.h"
+#include "../Helper/BackgroundWorkPool.h"
 #include "../Helper/ShellHelper.h"
-#include "../ThirdParty/CTPL/cpl_stl.h"
 #include <future>
 #include <unordered_map>
 
@@ -16,7 +16,7 @@ class WindowSubclass;
 class IconFetcherImpl : public IconFetcher
 {
 public:
-	IconFetcherImpl(HWND hwnd, CachedIcons *cachedIcons);
+	IconFetcherImpl(HWND hwnd, CachedIcons *cachedIcons, BackgroundWorkPool *workPool);
 	~IconFetcherImpl();
 
 	void QueueIconTask(std::wstring_view path, Callback callback) override;
@@ -69,7 +69,7 @@ private:
 	int m_defaultFileIconIndex;
 	int m_defaultFolderIconIndex;
 
-	ctpl::thread_pool m_iconThreadPool;
+	TaskGroup m_iconTaskGroup;
 	std::unordered_map<int, FutureResult> m_iconResults;
 	int m_iconResultIDCounter;
 	std::function<void(int data)> m_callback;
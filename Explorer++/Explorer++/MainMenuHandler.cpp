@@ -75,7 +75,8 @@ void Explorerplusplus::OnSplitFile()
 		std::wstring fullFilename = m_pActiveShellBrowser->GetItemFullName(iSelected);
 
 		SplitFileDialog splitFileDialog(m_app->GetResourceInstance(), m_hContainer,
-			m_app->GetThemeManager(), m_app->GetIconResourceLoader(), fullFilename);
+			m_app->GetThemeManager(), m_app->GetIconResourceLoader(),
+			m_app->GetRuntime()->GetBackgroundWorkPool(), fullFilename);
 		splitFileDialog.ShowModalDialog();
 	}
 }
@@ -92,7 +93,7 @@ void Explorerplusplus::OnDestroyFiles()
 	}
 
 	DestroyFilesDialog destroyFilesDialog(m_app->GetResourceInstance(), m_hContainer,
-		m_app->GetThemeManager(), fullFilenameList,
+		m_app->GetThemeManager(), m_app->GetRuntime()->GetBackgroundWorkPool(), fullFilenameList,
 		m_config->globalFolderSettings.showFriendlyDates);
 	destroyFilesDialog.ShowModalDialog();
 }
@@ -113,8 +114,9 @@ void Explorerplusplus::OnSearch()
 			std::wstring currentDirectory = selectedTab.GetShellBrowserImpl()->GetDirectory();
 
 			return new SearchDialog(m_app->GetResourceInstance(), m_hContainer,
-				m_app->GetThemeManager(), currentDirectory, this, this,
-				GetActivePane()->GetTabContainer(), m_app->GetIconResourceLoader());
+				m_app->GetThemeManager(), m_app->GetRuntime()->GetBackgroundWorkPool(),
+				currentDirectory, this, this, GetActivePane()->GetTabContainer(),
+				m_app->GetIconResourceLoader());
 		});
 }
 
@@ -425,7 +425,7 @@ LRESULT Explorerplusplus::HandleMenuOrToolbarButtonOrAccelerator(HWND hwnd, int
 		break;
 
 	case IDM_EDIT_INVERTSELECTION:
-		ListViewHelper::InvertSelection(m_hActiveListView);
+		GetActiveShellBrowserImpl()->InvertSelection();
 		SetFocus(m_hActiveListView);
 		break;
 
@@ -9,12 +9,14 @@
 #include "MainResource.h"
 #include "ResourceHelper.h"
 #include "../Helper/FileOperations.h"
+#include "../Helper/FileStreams.h"
 #include "../Helper/Helper.h"
 #include "../Helper/ListViewHelper.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/StringHelper.h"
 #include "../Helper/WindowHelper.h"
 #include <wil/resource.h>
+#include <optional>
 #include <regex>
 
 namespace NMergeFilesDialog
@@ -23,8 +25,10 @@ const int WM_APP_SETTOTALMERGECOUNT = WM_APP + 1;
 const int WM_APP_SETCURRENTMERGECOUNT = WM_APP + 2;
 const int WM_APP_MERGINGFINISHED = WM_APP + 3;
 const int WM_APP_OUTPUTFILEINVALID = WM_APP + 4;
+const int WM_APP_MERGINGFAILED = WM_APP + 5;
 
 DWORD WINAPI MergeFilesThread(LPVOID pParam);
+std::optional<uint64_t> GetTotalFileSize(const std::vector<std::wstring> &files);
 }
 
 const TCHAR MergeFilesDialogPersistentSettings::SETTINGS_KEY[] = _T("MergeFiles");
@@ -269,6 +273,10 @@ INT_PTR MergeFilesDialog::OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lPar
 		OnFinished();
 		break;
 
+	case NMergeFilesDialog::WM_APP_MERGINGFAILED:
+		OnFailed();
+		break;
+
 	case NMergeFilesDialog::WM_APP_OUTPUTFILEINVALID:
 	{
 		auto errorMessage =
@@ -433,6 +441,25 @@ void MergeFilesDialog::OnFinished()
 	SetDlgItemText(m_hDlg, IDOK, m_szOk);
 }
 
+void MergeFilesDialog::OnFailed()
+{
+	auto errorMessage =
+		ResourceHelper::LoadString(GetResourceInstance(), IDS_MERGE_FILES_MERGEFAILED);
+	MessageBox(m_hDlg, errorMessage.c_str(), App::APP_NAME, MB_ICONWARNING | MB_OK);
+
+	assert(m_pMergeFiles != nullptr);
+
+	m_pMergeFiles->Release();
+	m_pMergeFiles = nullptr;
+
+	m_bMergingFiles = false;
+	m_bStopMerging = false;
+
+	SendDlgItemMessage(m_hDlg, IDC_MERGE_PROGRESS, PBM_SETPOS, 0, 0);
+
+	SetDlgItemText(m_hDlg, IDOK, m_szOk);
+}
+
 DWORD WINAPI NMergeFilesDialog::MergeFilesThread(LPVOID pParam)
 {
 	assert(pParam != nullptr);
@@ -443,93 +470,102 @@ DWORD WINAPI NMergeFilesDialog::MergeFilesThread(LPVOID pParam)
 	return 0;
 }
 
-MergeFiles::MergeFiles(HWND hDlg, const std::wstring &strOutputFilename,
-	const std::list<std::wstring> &FullFilenameList)
+// Returns std::nullopt if the size of any of the files can't be retrieved.
+std::optional<uint64_t> NMergeFilesDialog::GetTotalFileSize(const std::vector<std::wstring> &files)
 {
-	m_hDlg = hDlg;
-	m_strOutputFilename = strOutputFilename;
-	m_FullFilenameList = FullFilenameList;
+	uint64_t totalSize = 0;
+
+	for (const auto &file : files)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA attributeData;
+		BOOL res = GetFileAttributesEx(file.c_str(), GetFileExInfoStandard, &attributeData);
+
+		if (!res)
+		{
+			return std::nullopt;
+		}
 
-	m_bstopMerging = false;
+		ULARGE_INTEGER fileSize;
+		fileSize.LowPart = attributeData.nFileSizeLow;
+		fileSize.HighPart = attributeData.nFileSizeHigh;
+		totalSize += fileSize.QuadPart;
+	}
 
-	InitializeCriticalSection(&m_csStop);
+	return totalSize;
 }
 
-MergeFiles::~MergeFiles()
+MergeFiles::MergeFiles(HWND hDlg, const std::wstring &strOutputFilename,
+	const std::list<std::wstring> &FullFilenameList) :
+	m_hDlg(hDlg),
+	m_strOutputFilename(strOutputFilename),
+	m_inputFiles(FullFilenameList.begin(), FullFilenameList.end())
 {
-	DeleteCriticalSection(&m_csStop);
 }
 
 void MergeFiles::StartMerging()
 {
-	LARGE_INTEGER lMergeFileSize;
-	int nFilesMerged = 1;
-	bool bStop = false;
+	auto outputFile = FileWriter::Create(m_strOutputFilename);
 
-	HANDLE hOutputFile = CreateFile(m_strOutputFilename.c_str(), GENERIC_WRITE, 0, nullptr,
-		CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
-
-	if (hOutputFile == INVALID_HANDLE_VALUE)
+	if (!outputFile)
 	{
 		PostMessage(m_hDlg, NMergeFilesDialog::WM_APP_OUTPUTFILEINVALID, 0, 0);
 		return;
 	}
 
 	PostMessage(m_hDlg, NMergeFilesDialog::WM_APP_SETTOTALMERGECOUNT,
-		static_cast<WPARAM>(m_FullFilenameList.size()), 0);
-
-	for (const auto &strFullFilename : m_FullFilenameList)
-	{
-		if (bStop)
-		{
-			break;
-		}
-
-		HANDLE hInputFile = CreateFile(strFullFilename.c_str(), GENERIC_READ, FILE_SHARE_READ,
-			nullptr, OPEN_EXISTING, 0, nullptr);
+		static_cast<WPARAM>(m_inputFiles.size()), 0);
 
-		if (hInputFile != INVALID_HANDLE_VALUE)
-		{
-			GetFileSizeEx(hInputFile, &lMergeFileSize);
+	// This is only an optimization, so the merge can still go ahead if the space can't be
+	// reserved.
+	auto totalSize = NMergeFilesDialog::GetTotalFileSize(m_inputFiles);
 
-			if (lMergeFileSize.QuadPart != 0)
-			{
-				auto buffer = std::make_unique<char[]>(lMergeFileSize.LowPart);
+	if (totalSize)
+	{
+		outputFile->Reserve(*totalSize);
+	}
 
-				DWORD dwNumberOfBytesRead;
-				ReadFile(hInputFile, reinterpret_cast<LPVOID>(buffer.get()),
-					static_cast<DWORD>(lMergeFileSize.LowPart), &dwNumberOfBytesRead, nullptr);
+	auto openInputFile = [this](size_t index) -> std::unique_ptr<ReadAheadPipeline::Source>
+	{ return FileReader::Open(m_inputFiles[index]); };
 
-				DWORD dwNumberOfBytesWritten;
-				WriteFile(hOutputFile, reinterpret_cast<LPCVOID>(buffer.get()), dwNumberOfBytesRead,
-					&dwNumberOfBytesWritten, nullptr);
-			}
+	auto writeBlock = [&outputFile](size_t index, std::span<const std::byte> block)
+	{
+		UNREFERENCED_PARAMETER(index);
 
-			CloseHandle(hInputFile);
+		return outputFile->Write(block);
+	};
 
-			PostMessage(m_hDlg, NMergeFilesDialog::WM_APP_SETCURRENTMERGECOUNT, nFilesMerged, 0);
+	auto onInputFileMerged = [this](size_t index)
+	{
+		PostMessage(m_hDlg, NMergeFilesDialog::WM_APP_SETCURRENTMERGECOUNT, index + 1, 0);
+		return true;
+	};
 
-			nFilesMerged++;
+	ReadAheadPipeline pipeline;
+	auto result = pipeline.Run(m_inputFiles.size(), openInputFile, writeBlock, onInputFileMerged,
+		m_stopSource.get_token());
 
-			EnterCriticalSection(&m_csStop);
-			if (m_bstopMerging)
-			{
-				bStop = true;
-			}
-			LeaveCriticalSection(&m_csStop);
-		}
+	if (result.status != ReadAheadPipeline::Status::Succeeded)
+	{
+		// A partially merged file isn't of any use, so it's removed.
+		outputFile->Discard();
 	}
 
-	CloseHandle(hOutputFile);
+	outputFile.reset();
 
-	SendMessage(m_hDlg, NMergeFilesDialog::WM_APP_MERGINGFINISHED, 0, 0);
+	if (result.status == ReadAheadPipeline::Status::Succeeded
+		|| result.status == ReadAheadPipeline::Status::Cancelled)
+	{
+		SendMessage(m_hDlg, NMergeFilesDialog::WM_APP_MERGINGFINISHED, 0, 0);
+	}
+	else
+	{
+		SendMessage(m_hDlg, NMergeFilesDialog::WM_APP_MERGINGFAILED, 0, 0);
+	}
 }
 
 void MergeFiles::StopMerging()
 {
-	EnterCriticalSection(&m_csStop);
-	m_bstopMerging = true;
-	LeaveCriticalSection(&m_csStop);
+	m_stopSource.request_stop();
 }
 
 MergeFilesDialogPersistentSettings::MergeFilesDialogPersistentSettings() :
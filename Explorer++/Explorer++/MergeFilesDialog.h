@@ -8,6 +8,7 @@
 #include "../Helper/DialogSettings.h"
 #include "../Helper/ReferenceCount.h"
 #include "../Helper/ResizableDialogHelper.h"
+#include <stop_token>
 
 class IconResourceLoader;
 class MergeFilesDialog;
@@ -28,12 +29,14 @@ private:
 	MergeFilesDialogPersistentSettings &operator=(const MergeFilesDialogPersistentSettings &);
 };
 
+// Merges a set of files into a single output file. The input files are streamed through a fixed
+// set of buffers, so memory use doesn't depend on the size of the files, and reading from the input
+// files overlaps with writing to the output file.
 class MergeFiles : public ReferenceCount
 {
 public:
 	MergeFiles(HWND hDlg, const std::wstring &strOutputFilename,
 		const std::list<std::wstring> &FullFilenameList);
-	~MergeFiles();
 
 	void StartMerging();
 	void StopMerging();
@@ -42,10 +45,9 @@ private:
 	HWND m_hDlg;
 
 	std::wstring m_strOutputFilename;
-	std::list<std::wstring> m_FullFilenameList;
+	std::vector<std::wstring> m_inputFiles;
 
-	CRITICAL_SECTION m_csStop;
-	bool m_bstopMerging;
+	std::stop_source m_stopSource;
 };
 
 class MergeFilesDialog : public ThemedDialog
@@ -74,6 +76,7 @@ private:
 	void OnChangeOutputDirectory();
 	void OnMove(bool bUp);
 	void OnFinished();
+	void OnFailed();
 
 	const IconResourceLoader *const m_iconResourceLoader;
 
@@ -4,6 +4,7 @@
 
 #include "stdafx.h"
 #include "Runtime.h"
+#include "../Helper/BackgroundWorkPool.h"
 #include <chrono>
 
 using namespace std::chrono_literals;
@@ -13,6 +14,7 @@ Runtime::Runtime(std::shared_ptr<concurrencpp::executor> uiThreadExecutor,
 	m_uiThreadExecutor(uiThreadExecutor),
 	m_comStaExecutor(comStaExecutor),
 	m_timerQueue(std::make_shared<concurrencpp::timer_queue>(120s)),
+	m_backgroundWorkPool(std::make_unique<BackgroundWorkPool>(comStaExecutor)),
 	m_uiThreadId(UniqueThreadId::GetForCurrentThread())
 {
 }
@@ -39,6 +41,11 @@ std::shared_ptr<concurrencpp::timer_queue> Runtime::GetTimerQueue() const
 	return m_timerQueue;
 }
 
+BackgroundWorkPool *Runtime::GetBackgroundWorkPool() const
+{
+	return m_backgroundWorkPool.get();
+}
+
 bool Runtime::IsUiThread() const
 {
 	return UniqueThreadId::GetForCurrentThread() == m_uiThreadId;
@@ -9,6 +9,8 @@
 #include <concurrencpp/concurrencpp.h>
 #include <memory>
 
+class BackgroundWorkPool;
+
 class Runtime : private boost::noncopyable
 {
 public:
@@ -20,11 +22,17 @@ public:
 	std::shared_ptr<concurrencpp::executor> GetUiThreadExecutor() const;
 	std::shared_ptr<concurrencpp::executor> GetComStaExecutor() const;
 	std::shared_ptr<concurrencpp::timer_queue> GetTimerQueue() const;
+
+	// Runs background work on the COM STA executor. This should be used in place of creating
+	// dedicated threads, so that the number of threads stays fixed.
+	BackgroundWorkPool *GetBackgroundWorkPool() const;
+
 	bool IsUiThread() const;
 
 private:
 	const std::shared_ptr<concurrencpp::executor> m_uiThreadExecutor;
 	const std::shared_ptr<concurrencpp::executor> m_comStaExecutor;
 	const std::shared_ptr<concurrencpp::timer_queue> m_timerQueue;
+	const std::unique_ptr<BackgroundWorkPool> m_backgroundWorkPool;
 	const UniqueThreadId m_uiThreadId;
 };
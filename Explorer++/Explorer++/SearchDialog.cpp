@@ -18,19 +18,18 @@
 #include "../Helper/DpiCompatibility.h"
 #include "../Helper/Helper.h"
 #include "../Helper/RegistrySettings.h"
+#include "../Helper/ScopedRedrawDisabler.h"
 #include "../Helper/ShellContextMenu.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/WindowHelper.h"
 #include "../Helper/XMLSettings.h"
 #include <algorithm>
-#include <regex>
 
 namespace NSearchDialog
 {
-const int WM_APP_SEARCHITEMFOUND = WM_APP + 1;
+const int WM_APP_SEARCHRESULTSFOUND = WM_APP + 1;
 const int WM_APP_SEARCHFINISHED = WM_APP + 2;
-const int WM_APP_SEARCHCHANGEDDIRECTORY = WM_APP + 3;
-const int WM_APP_REGULAREXPRESSIONINVALID = WM_APP + 4;
+const int WM_APP_REGULAREXPRESSIONINVALID = WM_APP + 3;
 
 int CALLBACK SortResultsStub(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort);
 
@@ -58,9 +57,11 @@ const TCHAR SearchDialogPersistentSettings::SETTING_DIRECTORY_LIST[] = _T("Direc
 const TCHAR SearchDialogPersistentSettings::SETTING_PATTERN_LIST[] = _T("Pattern");
 
 SearchDialog::SearchDialog(HINSTANCE resourceInstance, HWND hParent, ThemeManager *themeManager,
-	std::wstring_view searchDirectory, BrowserWindow *browserWindow, CoreInterface *coreInterface,
-	TabContainer *tabContainer, const IconResourceLoader *iconResourceLoader) :
+	BackgroundWorkPool *workPool, std::wstring_view searchDirectory, BrowserWindow *browserWindow,
+	CoreInterface *coreInterface, TabContainer *tabContainer,
+	const IconResourceLoader *iconResourceLoader) :
 	ThemedDialog(resourceInstance, IDD_SEARCH, hParent, DialogSizingType::Both, themeManager),
+	m_workPool(workPool),
 	m_searchDirectory(searchDirectory),
 	m_browserWindow(browserWindow),
 	m_coreInterface(coreInterface),
@@ -70,8 +71,7 @@ SearchDialog::SearchDialog(HINSTANCE resourceInstance, HWND hParent, ThemeManage
 	m_bStopSearching(FALSE),
 	m_pSearch(nullptr),
 	m_iInternalIndex(0),
-	m_iPreviousSelectedColumn(-1),
-	m_bSetSearchTimer(TRUE)
+	m_iPreviousSelectedColumn(-1)
 {
 	m_persistentSettings = &SearchDialogPersistentSettings::GetInstance();
 }
@@ -283,7 +283,6 @@ void SearchDialog::StartSearching()
 	ShowWindow(GetDlgItem(m_hDlg, IDC_LINK_STATUS), SW_HIDE);
 	ShowWindow(GetDlgItem(m_hDlg, IDC_STATIC_STATUS), SW_SHOW);
 
-	m_AwaitingSearchItems.clear();
 	m_SearchItemsMapInternal.clear();
 
 	ListView_DeleteAllItems(GetDlgItem(m_hDlg, IDC_LISTVIEW_SEARCHRESULTS));
@@ -340,8 +339,15 @@ void SearchDialog::StartSearching()
 		dwAttributes |= FILE_ATTRIBUTE_SYSTEM;
 	}
 
-	m_pSearch = new Search(m_hDlg, szBaseDirectory, szSearchPattern, dwAttributes,
-		bUseRegularExpressions, bCaseInsensitive, bSearchSubFolders);
+	FileSearcher::Criteria criteria;
+	criteria.pattern = szSearchPattern;
+	criteria.syntax = bUseRegularExpressions ? FileSearcher::PatternSyntax::RegularExpression
+											 : FileSearcher::PatternSyntax::Wildcard;
+	criteria.caseSensitive = !bCaseInsensitive;
+	criteria.requiredAttributes = dwAttributes;
+	criteria.searchSubfolders = bSearchSubFolders;
+
+	m_pSearch = new Search(m_hDlg, m_workPool, szBaseDirectory, criteria);
 	m_pSearch->AddRef();
 
 	/* Save the search directory and search pattern (only if they are not
@@ -776,32 +782,25 @@ INT_PTR SearchDialog::OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
 	switch (uMsg)
 	{
-	/* We won't actually process the item here. Instead, we'll
-	add it onto the list of current items, which will be processed
-	in batch. This is done to stop this message from blocking the
-	main GUI (also see http://www.flounder.com/iocompletion.htm). */
-	case NSearchDialog::WM_APP_SEARCHITEMFOUND:
-	{
-		m_AwaitingSearchItems.push_back(reinterpret_cast<PIDLIST_ABSOLUTE>(wParam));
-
-		if (m_bSetSearchTimer)
-		{
-			SetTimer(m_hDlg, SEARCH_PROCESSITEMS_TIMER_ID, SEARCH_PROCESSITEMS_TIMER_ELAPSED,
-				nullptr);
-
-			m_bSetSearchTimer = FALSE;
-		}
-	}
-	break;
+	/* Results are delivered in batches, rather than individually, so
+	that a search that matches a large number of items doesn't flood
+	the message queue. */
+	case NSearchDialog::WM_APP_SEARCHRESULTSFOUND:
+		ProcessSearchResults();
+		break;
 
 	case NSearchDialog::WM_APP_SEARCHFINISHED:
 	{
+		/* Any batches that couldn't be announced are
+		picked up here. */
+		ProcessSearchResults();
+
 		TCHAR szStatus[512];
 
 		if (!m_bStopSearching)
 		{
-			int iFoldersFound = LOWORD(lParam);
-			int iFilesFound = HIWORD(lParam);
+			auto iFoldersFound = static_cast<int>(wParam);
+			auto iFilesFound = static_cast<int>(lParam);
 
 			TCHAR szTemp[128];
 			LoadString(GetResourceInstance(), IDS_SEARCH_FINISHED_MESSAGE, szTemp,
@@ -827,20 +826,6 @@ INT_PTR SearchDialog::OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	}
 	break;
 
-	case NSearchDialog::WM_APP_SEARCHCHANGEDDIRECTORY:
-	{
-		TCHAR szStatus[512];
-		TCHAR *pszDirectory = nullptr;
-
-		pszDirectory = reinterpret_cast<TCHAR *>(wParam);
-
-		TCHAR szTemp[64];
-		LoadString(GetResourceInstance(), IDS_SEARCHING, szTemp, std::size(szTemp));
-		StringCchPrintf(szStatus, std::size(szStatus), szTemp, pszDirectory);
-		SetDlgItemText(m_hDlg, IDC_STATIC_STATUS, szStatus);
-	}
-	break;
-
 	case NSearchDialog::WM_APP_REGULAREXPRESSIONINVALID:
 	{
 		/* The link/status controls are in the same position, and
@@ -870,65 +855,61 @@ INT_PTR SearchDialog::OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lParam)
 	return 0;
 }
 
-INT_PTR SearchDialog::OnTimer(int iTimerID)
+void SearchDialog::ProcessSearchResults()
 {
-	if (iTimerID != SEARCH_PROCESSITEMS_TIMER_ID)
+	assert(m_pSearch != nullptr);
+
+	for (const auto &batch : m_pSearch->TakeBatches())
 	{
-		return 1;
+		OnSearchResults(batch);
 	}
+}
 
+void SearchDialog::OnSearchResults(const FileSearcher::Batch &batch)
+{
 	HWND hListView = GetDlgItem(m_hDlg, IDC_LISTVIEW_SEARCHRESULTS);
 	int nListViewItems = ListView_GetItemCount(hListView);
 
-	int nItems =
-		std::min(static_cast<int>(m_AwaitingSearchItems.size()), SEARCH_MAX_ITEMS_BATCH_PROCESS);
-	int i = 0;
-
-	auto itr = m_AwaitingSearchItems.begin();
-
-	while (i < nItems)
 	{
-		LVITEM lvItem;
-		SHFILEINFO shfi;
-		int iIndex;
-
-		PIDLIST_ABSOLUTE pidl = *itr;
-
-		std::wstring fullFileName;
-		GetDisplayName(pidl, SHGDN_FORPARSING, fullFileName);
-
-		TCHAR directory[MAX_PATH];
-		StringCchCopy(directory, std::size(directory), fullFileName.c_str());
-		PathRemoveFileSpec(directory);
-
-		std::wstring fileName;
-		GetDisplayName(pidl, SHGDN_INFOLDER | SHGDN_FORPARSING, fileName);
+		ScopedRedrawDisabler redrawDisabler(hListView);
 
-		SHGetFileInfo((LPCWSTR) pidl, 0, &shfi, sizeof(shfi), SHGFI_PIDL | SHGFI_SYSICONINDEX);
+		for (const auto &fullFileName : batch.paths)
+		{
+			LVITEM lvItem;
+			SHFILEINFO shfi;
+			int iIndex;
 
-		m_SearchItemsMapInternal.insert(
-			std::unordered_map<int, std::wstring>::value_type(m_iInternalIndex, fullFileName));
+			TCHAR directory[MAX_PATH];
+			StringCchCopy(directory, std::size(directory), fullFileName.c_str());
+			PathRemoveFileSpec(directory);
 
-		lvItem.mask = LVIF_IMAGE | LVIF_TEXT | LVIF_PARAM;
-		lvItem.pszText = fileName.data();
-		lvItem.iItem = nListViewItems + i;
-		lvItem.iSubItem = 0;
-		lvItem.iImage = shfi.iIcon;
-		lvItem.lParam = m_iInternalIndex++;
-		iIndex = ListView_InsertItem(hListView, &lvItem);
+			std::wstring fileName = PathFindFileName(fullFileName.c_str());
 
-		ListView_SetItemText(hListView, iIndex, 1, directory);
+			SHGetFileInfo(fullFileName.c_str(), 0, &shfi, sizeof(shfi), SHGFI_SYSICONINDEX);
 
-		CoTaskMemFree(pidl);
+			m_SearchItemsMapInternal.insert(
+				std::unordered_map<int, std::wstring>::value_type(m_iInternalIndex, fullFileName));
 
-		itr = m_AwaitingSearchItems.erase(itr);
+			lvItem.mask = LVIF_IMAGE | LVIF_TEXT | LVIF_PARAM;
+			lvItem.pszText = fileName.data();
+			lvItem.iItem = nListViewItems++;
+			lvItem.iSubItem = 0;
+			lvItem.iImage = shfi.iIcon;
+			lvItem.lParam = m_iInternalIndex++;
+			iIndex = ListView_InsertItem(hListView, &lvItem);
 
-		i++;
+			ListView_SetItemText(hListView, iIndex, 1, directory);
+		}
 	}
 
-	m_bSetSearchTimer = TRUE;
-
-	return 0;
+	if (!batch.currentFolder.empty() && !m_bStopSearching)
+	{
+		TCHAR szStatus[512];
+		TCHAR szTemp[64];
+		LoadString(GetResourceInstance(), IDS_SEARCHING, szTemp, std::size(szTemp));
+		StringCchPrintf(szStatus, std::size(szStatus), szTemp, batch.currentFolder.c_str());
+		SetDlgItemText(m_hDlg, IDC_STATIC_STATUS, szStatus);
+	}
 }
 
 INT_PTR SearchDialog::OnClose()
@@ -955,206 +936,82 @@ DWORD WINAPI NSearchDialog::SearchThread(LPVOID pParam)
 	return 0;
 }
 
-Search::Search(HWND hDlg, TCHAR *szBaseDirectory, TCHAR *szPattern, DWORD dwAttributes,
-	BOOL bUseRegularExpressions, BOOL bCaseInsensitive, BOOL bSearchSubFolders)
-{
-	m_hDlg = hDlg;
-	m_dwAttributes = dwAttributes;
-	m_bUseRegularExpressions = bUseRegularExpressions;
-	m_bCaseInsensitive = bCaseInsensitive;
-	m_bSearchSubFolders = bSearchSubFolders;
-
-	StringCchCopy(m_szBaseDirectory, std::size(m_szBaseDirectory), szBaseDirectory);
-	StringCchCopy(m_szSearchPattern, std::size(m_szSearchPattern), szPattern);
-
-	InitializeCriticalSection(&m_csStop);
-	m_bStopSearching = FALSE;
-}
-
-Search::~Search()
+Search::Search(HWND hDlg, BackgroundWorkPool *workPool, const std::wstring &baseDirectory,
+	const FileSearcher::Criteria &criteria) :
+	m_hDlg(hDlg),
+	m_workPool(workPool),
+	m_baseDirectory(baseDirectory),
+	m_criteria(criteria)
 {
-	DeleteCriticalSection(&m_csStop);
 }
 
 void Search::StartSearching()
 {
-	m_iFoldersFound = 0;
-	m_iFilesFound = 0;
+	std::optional<FileSearcher> fileSearcher;
 
-	if (lstrlen(m_szSearchPattern) != 0 && m_bUseRegularExpressions)
+	try
 	{
-		try
-		{
-			if (m_bCaseInsensitive)
-			{
-				m_rxPattern.assign(m_szSearchPattern, std::regex_constants::icase);
-			}
-			else
-			{
-				m_rxPattern.assign(m_szSearchPattern);
-			}
-		}
-		catch (std::exception)
-		{
-			SendMessage(m_hDlg, NSearchDialog::WM_APP_REGULAREXPRESSIONINVALID, 0, 0);
+		fileSearcher.emplace(m_criteria, m_workPool);
+	}
+	catch (const boost::regex_error &)
+	{
+		SendMessage(m_hDlg, NSearchDialog::WM_APP_REGULAREXPRESSIONINVALID, 0, 0);
 
-			return;
-		}
+		Release();
+		return;
 	}
 
-	SearchDirectory(m_szBaseDirectory);
+	auto summary = fileSearcher->Search(m_baseDirectory,
+		std::bind_front(&Search::OnBatchReady, this), m_stopSource.get_token());
 
-	SendMessage(m_hDlg, NSearchDialog::WM_APP_SEARCHFINISHED, 0,
-		MAKELPARAM(m_iFoldersFound, m_iFilesFound));
+	// This message is posted, rather than sent, so that it's processed after any batches of
+	// results that are still in the queue. If the search was stopped, the dialog will show a
+	// cancellation message, rather than the number of items found.
+	PostMessage(m_hDlg, NSearchDialog::WM_APP_SEARCHFINISHED,
+		static_cast<WPARAM>(summary ? summary->numFoldersFound : 0),
+		static_cast<LPARAM>(summary ? summary->numFilesFound : 0));
 
 	Release();
 }
 
-void Search::SearchDirectory(const TCHAR *szDirectory)
+void Search::OnBatchReady(FileSearcher::Batch batch)
 {
-	SendMessage(m_hDlg, NSearchDialog::WM_APP_SEARCHCHANGEDDIRECTORY,
-		reinterpret_cast<WPARAM>(szDirectory), 0);
-
-	std::list<std::wstring> subFolderList;
-
-	SearchDirectoryInternal(szDirectory, &subFolderList);
-
-	bool bStop = false;
-
-	EnterCriticalSection(&m_csStop);
-	if (m_bStopSearching)
-	{
-		bStop = true;
-	}
-	LeaveCriticalSection(&m_csStop);
-
-	if (bStop)
 	{
-		return;
-	}
+		std::unique_lock lock(m_batchesMutex);
 
-	if (m_bSearchSubFolders)
-	{
-		for (const auto &strSubFolder : subFolderList)
+		// Wait until the dialog has processed enough of the previous batches. If the search is
+		// stopped in the meantime, the batch is simply dropped.
+		if (!m_batchesCondition.wait(lock, m_stopSource.get_token(),
+				[this] { return m_pendingBatches.size() < MAX_QUEUED_BATCHES; }))
 		{
-			SearchDirectory(strSubFolder.c_str());
+			return;
 		}
+
+		m_pendingBatches.push_back(std::move(batch));
 	}
+
+	// The dialog takes every pending batch each time it processes this message, so if the message
+	// can't be posted, the batch will be picked up along with the next one.
+	PostMessage(m_hDlg, NSearchDialog::WM_APP_SEARCHRESULTSFOUND, 0, 0);
 }
 
-/* Can't recurse, as it would overflow the stack. */
-void Search::SearchDirectoryInternal(const TCHAR *szSearchDirectory,
-	std::list<std::wstring> *pSubFolderList)
+std::vector<FileSearcher::Batch> Search::TakeBatches()
 {
-	assert(szSearchDirectory != nullptr);
-	assert(pSubFolderList != nullptr);
-
-	WIN32_FIND_DATA wfd;
-	TCHAR szSearchTerm[MAX_PATH];
+	std::vector<FileSearcher::Batch> batches;
 
-	PathCombine(szSearchTerm, szSearchDirectory, _T("*"));
-
-	HANDLE hFindFile = FindFirstFile(szSearchTerm, &wfd);
-
-	if (hFindFile != INVALID_HANDLE_VALUE)
 	{
-		bool bStop = false;
-
-		while (FindNextFile(hFindFile, &wfd) != 0 && !bStop)
-		{
-			if (lstrcmpi(wfd.cFileName, _T(".")) != 0 && lstrcmpi(wfd.cFileName, _T("..")) != 0)
-			{
-				BOOL bMatchFileName = FALSE;
-				BOOL bMatchAttributes = FALSE;
-
-				/* Only match against the filename if it's not empty. */
-				if (lstrlen(m_szSearchPattern) != 0)
-				{
-					if (m_bUseRegularExpressions)
-					{
-						if (std::regex_match(wfd.cFileName, m_rxPattern))
-						{
-							bMatchFileName = TRUE;
-						}
-					}
-					else
-					{
-						if (CheckWildcardMatch(m_szSearchPattern, wfd.cFileName,
-								!m_bCaseInsensitive))
-						{
-							bMatchFileName = TRUE;
-						}
-					}
-				}
-				else
-				{
-					/* No filename constraint, so all filenames match. */
-					bMatchFileName = TRUE;
-				}
-
-				if (m_dwAttributes != 0)
-				{
-					if ((wfd.dwFileAttributes & m_dwAttributes) == m_dwAttributes)
-					{
-						bMatchAttributes = TRUE;
-					}
-				}
-				else
-				{
-					bMatchAttributes = TRUE;
-				}
-
-				BOOL bItemMatch = bMatchFileName && bMatchAttributes;
-
-				if (bItemMatch)
-				{
-					if ((wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-						== FILE_ATTRIBUTE_DIRECTORY)
-					{
-						m_iFoldersFound++;
-					}
-					else
-					{
-						m_iFilesFound++;
-					}
-
-					TCHAR szFullFileName[MAX_PATH];
-					PathCombine(szFullFileName, szSearchDirectory, wfd.cFileName);
-
-					unique_pidl_absolute pidl;
-					SHParseDisplayName(szFullFileName, nullptr, wil::out_param(pidl), 0, nullptr);
-
-					PostMessage(m_hDlg, NSearchDialog::WM_APP_SEARCHITEMFOUND,
-						reinterpret_cast<WPARAM>(ILCloneFull(pidl.get())), 0);
-				}
-
-				if ((wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
-				{
-					TCHAR szSubFolder[MAX_PATH];
-
-					PathCombine(szSubFolder, szSearchDirectory, wfd.cFileName);
-
-					pSubFolderList->push_back(szSubFolder);
-				}
-			}
+		std::scoped_lock lock(m_batchesMutex);
+		batches = std::exchange(m_pendingBatches, {});
+	}
 
-			EnterCriticalSection(&m_csStop);
-			if (m_bStopSearching)
-			{
-				bStop = true;
-			}
-			LeaveCriticalSection(&m_csStop);
-		}
+	m_batchesCondition.notify_all();
 
-		FindClose(hFindFile);
-	}
+	return batches;
 }
 
 void Search::StopSearching()
 {
-	EnterCriticalSection(&m_csStop);
-	m_bStopSearching = TRUE;
-	LeaveCriticalSection(&m_csStop);
+	m_stopSource.request_stop();
 }
 
 void SearchDialog::SaveState()
@@ -6,18 +6,22 @@
 
 #include "ThemedDialog.h"
 #include "../Helper/DialogSettings.h"
+#include "../Helper/FileSearcher.h"
 #include "../Helper/ReferenceCount.h"
 #include "../Helper/ShellContextMenu.h"
 #include <boost/circular_buffer.hpp>
 #include <MsXml2.h>
 #include <objbase.h>
+#include <condition_variable>
 #include <list>
-#include <regex>
+#include <mutex>
+#include <stop_token>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 class BrowserWindow;
+class BackgroundWorkPool;
 class CoreInterface;
 class IconResourceLoader;
 class SearchDialog;
@@ -104,42 +108,44 @@ private:
 class Search : public ReferenceCount
 {
 public:
-	Search(HWND hDlg, TCHAR *szBaseDirectory, TCHAR *szPattern, DWORD dwAttributes,
-		BOOL bUseRegularExpressions, BOOL bCaseInsensitive, BOOL bSearchSubFolders);
-	~Search();
+	Search(HWND hDlg, BackgroundWorkPool *workPool, const std::wstring &baseDirectory,
+		const FileSearcher::Criteria &criteria);
 
 	void StartSearching();
 	void StopSearching();
 
+	// Called by the dialog to take every batch of results that's waiting to be processed.
+	std::vector<FileSearcher::Batch> TakeBatches();
+
 private:
-	void SearchDirectory(const TCHAR *szDirectory);
-	void SearchDirectoryInternal(const TCHAR *szSearchDirectory,
-		std::list<std::wstring> *pSubFolderList);
+	// The number of batches that can be waiting to be processed by the dialog at any one time.
+	// Once this limit is reached, the search waits for the dialog to catch up, so that the dialog's
+	// message queue isn't flooded with results.
+	static constexpr size_t MAX_QUEUED_BATCHES = 4;
 
-	HWND m_hDlg;
+	void OnBatchReady(FileSearcher::Batch batch);
 
-	TCHAR m_szBaseDirectory[MAX_PATH];
-	TCHAR m_szSearchPattern[MAX_PATH + 2];
-	DWORD m_dwAttributes;
-	BOOL m_bUseRegularExpressions;
-	BOOL m_bCaseInsensitive;
-	BOOL m_bSearchSubFolders;
+	HWND m_hDlg;
+	BackgroundWorkPool *const m_workPool;
 
-	std::wregex m_rxPattern;
+	const std::wstring m_baseDirectory;
+	const FileSearcher::Criteria m_criteria;
 
-	CRITICAL_SECTION m_csStop;
-	BOOL m_bStopSearching;
+	std::stop_source m_stopSource;
 
-	int m_iFoldersFound;
-	int m_iFilesFound;
+	// Batches are owned here, rather than by the messages used to notify the dialog, so that any
+	// batches that haven't been processed when the dialog is destroyed are still freed.
+	std::mutex m_batchesMutex;
+	std::condition_variable_any m_batchesCondition;
+	std::vector<FileSearcher::Batch> m_pendingBatches;
 };
 
 class SearchDialog : public ThemedDialog, private ShellContextMenuHandler
 {
 public:
 	SearchDialog(HINSTANCE resourceInstance, HWND hParent, ThemeManager *themeManager,
-		std::wstring_view searchDirectory, BrowserWindow *browserWindow,
-		CoreInterface *coreInterface, TabContainer *tabContainer,
+		BackgroundWorkPool *workPool, std::wstring_view searchDirectory,
+		BrowserWindow *browserWindow, CoreInterface *coreInterface, TabContainer *tabContainer,
 		const IconResourceLoader *iconResourceLoader);
 	~SearchDialog();
 
@@ -150,7 +156,6 @@ public:
 
 protected:
 	INT_PTR OnInitDialog() override;
-	INT_PTR OnTimer(int iTimerID) override;
 	INT_PTR OnCommand(WPARAM wParam, LPARAM lParam) override;
 	INT_PTR OnNotify(NMHDR *pnmhdr) override;
 	INT_PTR OnClose() override;
@@ -161,10 +166,6 @@ protected:
 	virtual wil::unique_hicon GetDialogIcon(int iconWidth, int iconHeight) const override;
 
 private:
-	static const int SEARCH_PROCESSITEMS_TIMER_ID = 0;
-	static const int SEARCH_PROCESSITEMS_TIMER_ELAPSED = 50;
-	static const int SEARCH_MAX_ITEMS_BATCH_PROCESS = 100;
-
 	static const int OPEN_FILE_LOCATION_MENU_ITEM_ID = ShellContextMenu::MAX_SHELL_MENU_ID + 1;
 
 	std::vector<ResizableDialogControl> GetResizableControls() override;
@@ -173,6 +174,8 @@ private:
 	void OnSearch();
 	void StartSearching();
 	void StopSearching();
+	void ProcessSearchResults();
+	void OnSearchResults(const FileSearcher::Batch &batch);
 	void SaveEntry(int comboBoxId, boost::circular_buffer<std::wstring> &buffer);
 	void UpdateListViewHeader();
 
@@ -185,6 +188,7 @@ private:
 	void HandleCustomMenuItem(PCIDLIST_ABSOLUTE pidlParent, const std::vector<PidlChild> &pidlItems,
 		UINT menuItemId) override;
 
+	BackgroundWorkPool *const m_workPool;
 	std::wstring m_searchDirectory;
 	BrowserWindow *m_browserWindow = nullptr;
 	CoreInterface *m_coreInterface = nullptr;
@@ -198,12 +202,9 @@ private:
 	Search *m_pSearch = nullptr;
 
 	/* Listview item information. */
-	std::list<PIDLIST_ABSOLUTE> m_AwaitingSearchItems;
 	std::unordered_map<int, std::wstring> m_SearchItemsMapInternal;
 	int m_iInternalIndex;
 	int m_iPreviousSelectedColumn;
 
-	BOOL m_bSetSearchTimer;
-
 	SearchDialogPersistentSettings *m_persistentSettings = nullptr;
 };
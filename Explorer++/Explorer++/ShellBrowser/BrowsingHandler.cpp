@@ -4,12 +4,15 @@
 
 #include "stdafx.h"
 #include "ShellBrowserImpl.h"
+#include "App.h"
 #include "Config.h"
 #include "DocumentServiceProvider.h"
 #include "HistoryEntry.h"
 #include "IconFetcher.h"
 #include "ItemData.h"
 #include "MainResource.h"
+#include "Runtime.h"
+#include "RuntimeHelper.h"
 #include "ShellEnumerator.h"
 #include "ShellNavigationController.h"
 #include "ShellView.h"
@@ -31,8 +34,10 @@ HRESULT ShellBrowserImpl::Navigate(NavigateParams &navigateParams)
 
 	m_navigationStartedSignal(navigateParams);
 
-	std::vector<ItemInfo_t> items;
-	HRESULT hr = PerformEnumeration(navigateParams, items);
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<PidlChild> pidls;
+	HRESULT hr = PerformEnumeration(navigateParams, pidls);
 
 	if (FAILED(hr))
 	{
@@ -40,13 +45,13 @@ HRESULT ShellBrowserImpl::Navigate(NavigateParams &navigateParams)
 		return hr;
 	}
 
-	OnEnumerationCompleted(std::move(items), navigateParams);
+	StartRetrievingItems(std::move(pidls), navigateParams, startTime);
 
 	return hr;
 }
 
 HRESULT ShellBrowserImpl::PerformEnumeration(NavigateParams &navigateParams,
-	std::vector<ShellBrowserImpl::ItemInfo_t> &items)
+	std::vector<PidlChild> &pidls)
 {
 	// Note that although standard shortcuts (.lnk files) are currently handled outside this class,
 	// symlinks and virtual link objects aren't, so they will be handled here.
@@ -68,15 +73,17 @@ HRESULT ShellBrowserImpl::PerformEnumeration(NavigateParams &navigateParams,
 	}
 
 	RETURN_IF_FAILED(
-		EnumerateFolder(navigateParams.pidl.Raw(), m_hOwner, m_folderSettings.showHidden, items));
+		EnumerateFolder(navigateParams.pidl.Raw(), m_hOwner, m_folderSettings.showHidden, pidls));
 
 	CommitNavigation(navigateParams);
 
 	return S_OK;
 }
 
+// Retrieves the child items in the folder. The information on each item is retrieved separately,
+// once the navigation has been committed.
 HRESULT ShellBrowserImpl::EnumerateFolder(PCIDLIST_ABSOLUTE pidlDirectory, HWND owner,
-	bool showHidden, std::vector<ShellBrowserImpl::ItemInfo_t> &items)
+	bool showHidden, std::vector<PidlChild> &pidls)
 {
 	wil::com_ptr_nothrow<IShellFolder> shellFolder;
 	RETURN_IF_FAILED(BindToIdl(pidlDirectory, IID_PPV_ARGS(&shellFolder)));
@@ -89,15 +96,111 @@ HRESULT ShellBrowserImpl::EnumerateFolder(PCIDLIST_ABSOLUTE pidlDirectory, HWND
 	}
 
 	ShellEnumerator enumerator;
-	std::vector<PidlChild> outputPidls;
-	RETURN_IF_FAILED(enumerator.EnumerateDirectory(shellFolder.get(), owner, flags, outputPidls));
+	RETURN_IF_FAILED(enumerator.EnumerateDirectory(shellFolder.get(), owner, flags, pidls));
+
+	return S_OK;
+}
+
+// Building up the information for each item can be relatively slow, since it requires multiple
+// calls to the shell. So, rather than retrieving the information for every item before displaying
+// anything, the items are split into chunks which are processed in parallel in the background. The
+// results are then inserted into the view in batches as they arrive.
+void ShellBrowserImpl::StartRetrievingItems(std::vector<PidlChild> &&pidls,
+	const NavigateParams &navigateParams, std::chrono::steady_clock::time_point startTime)
+{
+	auto &itemRetrieval = m_directoryState.itemRetrieval;
+	itemRetrieval.navigateParams = navigateParams;
+	itemRetrieval.startTime = startTime;
+	itemRetrieval.nextBatchSize = ITEM_RETRIEVAL_CHUNK_SIZE;
+	itemRetrieval.inProgress = true;
+
+	// Monitoring starts here, rather than once all the items have been inserted, since otherwise
+	// any changes made while the items are being retrieved would be missed.
+	StartDirectoryMonitoringIfNecessary();
+
+	if (pidls.empty())
+	{
+		InsertRetrievedItems();
+		OnEnumerationCompleted();
+		return;
+	}
+
+	for (size_t i = 0; i < pidls.size(); i += ITEM_RETRIEVAL_CHUNK_SIZE)
+	{
+		auto chunkEnd = pidls.begin() + std::min(i + ITEM_RETRIEVAL_CHUNK_SIZE, pidls.size());
+		std::vector<PidlChild> chunk(std::make_move_iterator(pidls.begin() + i),
+			std::make_move_iterator(chunkEnd));
+
+		itemRetrieval.numChunksRemaining++;
+
+		RetrieveItemChunk(m_weakPtrFactory.GetWeakPtr(), m_directoryState.pidlDirectory,
+			std::move(chunk), m_uniqueFolderId, m_app->GetRuntime(),
+			m_directoryState.scopedStopSource->GetToken());
+	}
+}
+
+concurrencpp::null_result ShellBrowserImpl::RetrieveItemChunk(WeakPtr<ShellBrowserImpl> weakSelf,
+	PidlAbsolute pidlDirectory, std::vector<PidlChild> pidls, int folderId, Runtime *runtime,
+	std::stop_token stopToken)
+{
+	co_await ResumeOnComStaThread(runtime);
+
+	std::vector<ItemInfo_t> items;
+	HRESULT hr = RetrieveItems(pidlDirectory.Raw(), pidls, stopToken, items);
+
+	co_await ResumeOnUiThread(runtime);
+
+	if (stopToken.stop_requested())
+	{
+		co_return;
+	}
+
+	if (FAILED(hr))
+	{
+		// Dropping the chunk would leave the folder looking complete, with items missing, so the
+		// items are retrieved here instead.
+		LOG(WARNING) << "Couldn't bind to folder on background thread (hr = " << std::hex << hr
+					 << "), retrieving " << std::dec << pidls.size() << " items on UI thread";
+
+		hr = RetrieveItems(pidlDirectory.Raw(), pidls, stopToken, items);
+
+		if (FAILED(hr))
+		{
+			LOG(ERROR) << "Couldn't bind to folder (hr = " << std::hex << hr << "), "
+					   << std::dec << pidls.size() << " items won't be shown";
+		}
+	}
+
+	// The stop_token should be invalidated when this class is destroyed, so weakSelf should always
+	// be valid here (a CHECK will be triggered if not).
+	weakSelf->OnItemChunkRetrieved(folderId, std::move(items));
+}
 
-	for (const auto &pidl : outputPidls)
+HRESULT ShellBrowserImpl::RetrieveItems(PCIDLIST_ABSOLUTE pidlDirectory,
+	const std::vector<PidlChild> &pidls, std::stop_token stopToken,
+	std::vector<ItemInfo_t> &items)
+{
+	// The folder is bound to again here, since an IShellFolder instance retrieved on one thread
+	// can't be used on another.
+	wil::com_ptr_nothrow<IShellFolder> shellFolder;
+	RETURN_IF_FAILED(BindToIdl(pidlDirectory, IID_PPV_ARGS(&shellFolder)));
+
+	for (const auto &pidl : pidls)
 	{
+		if (stopToken.stop_requested())
+		{
+			return S_OK;
+		}
+
 		auto item = GetItemInformation(shellFolder.get(), pidlDirectory, pidl.Raw());
 
 		if (item)
 		{
+			// When this is called on a background thread, building the keys here means that
+			// they're built in parallel, rather than on the UI thread when the items are inserted.
+			item->nameKeys = SortKeyStore::BuildNameKeys(item->displayName, item->wfd,
+				item->bDrive, item->parsingName);
+
 			items.push_back(std::move(*item));
 		}
 	}
@@ -105,6 +208,91 @@ HRESULT ShellBrowserImpl::EnumerateFolder(PCIDLIST_ABSOLUTE pidlDirectory, HWND
 	return S_OK;
 }
 
+void ShellBrowserImpl::OnItemChunkRetrieved(int folderId, std::vector<ItemInfo_t> &&items)
+{
+	// The stop token should be triggered whenever the folder changes, but this serves as a
+	// secondary check that the results are for the current folder.
+	if (folderId != m_uniqueFolderId)
+	{
+		return;
+	}
+
+	auto &itemRetrieval = m_directoryState.itemRetrieval;
+	DCHECK_GT(itemRetrieval.numChunksRemaining, 0);
+	itemRetrieval.numChunksRemaining--;
+
+	std::move(items.begin(), items.end(), std::back_inserter(itemRetrieval.retrievedItems));
+
+	// The batch size is doubled each time. That allows the first set of items to be shown
+	// quickly, without the number of insertions (each of which has to place the batch within the
+	// items already shown) growing linearly with the number of items.
+	if (itemRetrieval.retrievedItems.size() >= itemRetrieval.nextBatchSize
+		|| itemRetrieval.numChunksRemaining == 0)
+	{
+		InsertRetrievedItems();
+		itemRetrieval.nextBatchSize *= 2;
+	}
+
+	if (itemRetrieval.numChunksRemaining == 0)
+	{
+		OnEnumerationCompleted();
+	}
+}
+
+void ShellBrowserImpl::InsertRetrievedItems()
+{
+	auto &itemRetrieval = m_directoryState.itemRetrieval;
+
+	std::vector<int> internalIndexes;
+	internalIndexes.reserve(itemRetrieval.retrievedItems.size());
+
+	for (auto &item : itemRetrieval.retrievedItems)
+	{
+		internalIndexes.push_back(RegisterItem(std::move(item)));
+	}
+
+	itemRetrieval.retrievedItems.clear();
+
+	ExcludeFilteredItems(internalIndexes);
+
+	// The items already shown are in sorted order, so each new item can be placed directly in its
+	// sorted position, without the folder having to be sorted again.
+	QueueItemsForSortedInsertion(std::move(internalIndexes));
+
+	/* Stop the list view from redrawing itself each time is inserted.
+	Redrawing will be allowed once all items have being inserted.
+	(reduces lag when a large number of items are going to be inserted). */
+	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
+
+	InsertAwaitingItems();
+
+	if (!itemRetrieval.firstBatchInserted)
+	{
+		if (m_folderSettings.viewMode == +ViewMode::Details)
+		{
+			ApplyHeaderSortArrow();
+		}
+
+		ListView_EnsureVisible(m_hListView, 0, FALSE);
+	}
+
+	/* Allow the listview to redraw itself once again. */
+	SendMessage(m_hListView, WM_SETREDRAW, TRUE, NULL);
+
+	if (!itemRetrieval.firstBatchInserted)
+	{
+		/* Set the focus back to the first item. */
+		ListView_SetItemState(m_hListView, 0, LVIS_FOCUSED, LVIS_FOCUSED);
+
+		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - itemRetrieval.startTime);
+		LOG(INFO) << "First batch of " << m_directoryState.selectionTracker.GetNumItems()
+				  << " items inserted after " << duration.count() << "ms";
+
+		itemRetrieval.firstBatchInserted = true;
+	}
+}
+
 void ShellBrowserImpl::CommitNavigation(const NavigateParams &navigateParams)
 {
 	PrepareToChangeFolders();
@@ -123,6 +311,7 @@ void ShellBrowserImpl::CommitNavigation(const NavigateParams &navigateParams)
 	m_directoryState.directory =
 		GetDisplayNameWithFallback(navigateParams.pidl.Raw(), SHGDN_FORPARSING);
 	m_directoryState.virtualFolder = isVirtualFolder;
+	m_directoryState.isRecycleBin = CompareVirtualFolders(CSIDL_BITBUCKET);
 	m_uniqueFolderId++;
 
 	SetActiveColumnSet();
@@ -131,6 +320,10 @@ void ShellBrowserImpl::CommitNavigation(const NavigateParams &navigateParams)
 
 	NotifyShellOfNavigation(navigateParams.pidl.Raw());
 
+	// The items in this folder will be inserted asynchronously. If another navigation occurs
+	// before that process is complete, the state for this folder will still need to be reset.
+	m_bFolderVisited = TRUE;
+
 	m_navigationCommittedSignal(navigateParams);
 }
 
@@ -139,6 +332,7 @@ void ShellBrowserImpl::PrepareToChangeFolders()
 	if (m_bFolderVisited)
 	{
 		SaveColumnWidths();
+		LogColumnTextMetrics();
 	}
 
 	ClearPendingResults();
@@ -148,6 +342,7 @@ void ShellBrowserImpl::PrepareToChangeFolders()
 	StoreCurrentlySelectedItems();
 
 	ListView_DeleteAllItems(m_hListView);
+	m_listViewItemModel.Clear();
 
 	if (m_bFolderVisited)
 	{
@@ -157,16 +352,18 @@ void ShellBrowserImpl::PrepareToChangeFolders()
 
 void ShellBrowserImpl::ClearPendingResults()
 {
-	m_columnThreadPool.clear_queue();
-	m_columnResults.clear();
+	m_columnTaskGroup.CancelPendingTasks();
+	m_columnTextScheduler->Clear();
 
 	m_iconFetcher->ClearQueue();
 
-	m_thumbnailThreadPool.clear_queue();
+	m_thumbnailTaskGroup.CancelPendingTasks();
 	m_thumbnailResults.clear();
 
-	m_infoTipsThreadPool.clear_queue();
+	m_infoTipsTaskGroup.CancelPendingTasks();
 	m_infoTipResults.clear();
+
+	CancelGroupingTasks();
 }
 
 void ShellBrowserImpl::StoreCurrentlySelectedItems()
@@ -191,13 +388,14 @@ void ShellBrowserImpl::ResetFolderState()
 
 	m_directoryState = DirectoryState();
 
-	EnterCriticalSection(&m_csDirectoryAltered);
-	m_AlteredList.clear();
-	LeaveCriticalSection(&m_csDirectoryAltered);
+	// Any queued changes relate to the previous folder, so they can be discarded.
+	m_directoryChangeQueue.Drain();
 
 	m_itemInfoMap.clear();
+	m_sortKeyStore.Clear();
+	m_itemNameIndex.Clear();
 
-	m_renamedItemOldPidl.reset();
+	m_renamedItemOldName.reset();
 }
 
 void ShellBrowserImpl::NotifyShellOfNavigation(PCIDLIST_ABSOLUTE pidl)
@@ -346,29 +544,43 @@ std::optional<int> ShellBrowserImpl::AddItemInternal(IShellFolder *shellFolder,
 }
 
 int ShellBrowserImpl::AddItemInternal(int itemIndex, ItemInfo_t itemInfo, BOOL setPosition)
+{
+	int itemId = RegisterItem(std::move(itemInfo));
+	QueueItemForInsertion(itemId, itemIndex, setPosition);
+	return itemId;
+}
+
+// Stores the details for an item, without adding the item to the listview.
+int ShellBrowserImpl::RegisterItem(ItemInfo_t itemInfo)
 {
 	int itemId = GenerateUniqueItemId();
-	m_itemInfoMap.insert({ itemId, std::move(itemInfo) });
+	auto [itr, inserted] = m_itemInfoMap.insert({ itemId, std::move(itemInfo) });
+	DCHECK(inserted);
+	m_itemNameIndex.AddItem(itemId, itr->second.parsingName);
+	UpdateItemSortKeys(itemId);
 
+	return itemId;
+}
+
+void ShellBrowserImpl::QueueItemForInsertion(int internalIndex, int itemIndex, BOOL setPosition)
+{
 	AwaitingAdd_t awaitingAdd;
 
 	if (itemIndex == -1)
 	{
-		awaitingAdd.iItem =
-			m_directoryState.numItems + static_cast<int>(m_directoryState.awaitingAddList.size());
+		awaitingAdd.iItem = m_directoryState.selectionTracker.GetNumItems()
+			+ static_cast<int>(m_directoryState.awaitingAddList.size());
 	}
 	else
 	{
 		awaitingAdd.iItem = itemIndex;
 	}
 
-	awaitingAdd.iItemInternal = itemId;
+	awaitingAdd.iItemInternal = internalIndex;
 	awaitingAdd.bPosition = setPosition;
 	awaitingAdd.iAfter = itemIndex - 1;
 
 	m_directoryState.awaitingAddList.push_back(awaitingAdd);
-
-	return itemId;
 }
 
 std::optional<ShellBrowserImpl::ItemInfo_t> ShellBrowserImpl::GetItemInformation(
@@ -522,29 +734,17 @@ HRESULT ShellBrowserImpl::ExtractFindDataUsingPropertyStore(IShellFolder *shellF
 	return hr;
 }
 
-void ShellBrowserImpl::OnEnumerationCompleted(std::vector<ShellBrowserImpl::ItemInfo_t> &&items,
-	const NavigateParams &navigateParams)
+void ShellBrowserImpl::OnEnumerationCompleted()
 {
-	for (auto &item : items)
-	{
-		AddItemInternal(-1, std::move(item), FALSE);
-	}
-
-	/* Stop the list view from redrawing itself each time is inserted.
-	Redrawing will be allowed once all items have being inserted.
-	(reduces lag when a large number of items are going to be inserted). */
-	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
-
-	InsertAwaitingItems();
-	SortFolder();
+	auto &itemRetrieval = m_directoryState.itemRetrieval;
+	itemRetrieval.inProgress = false;
+	CHECK(itemRetrieval.navigateParams);
+	const NavigateParams &navigateParams = *itemRetrieval.navigateParams;
 
-	ListView_EnsureVisible(m_hListView, 0, FALSE);
-
-	/* Allow the listview to redraw itself once again. */
-	SendMessage(m_hListView, WM_SETREDRAW, TRUE, NULL);
-
-	/* Set the focus back to the first item. */
-	ListView_SetItemState(m_hListView, 0, LVIS_FOCUSED, LVIS_FOCUSED);
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - itemRetrieval.startTime);
+	LOG(INFO) << "Enumeration of " << m_directoryState.selectionTracker.GetNumItems()
+			  << " items completed after " << duration.count() << "ms";
 
 	// A history entry should be created when the navigation is committed, so there should always be
 	// a current entry here, and that entry should be for the current navigation.
@@ -559,16 +759,37 @@ void ShellBrowserImpl::OnEnumerationCompleted(std::vector<ShellBrowserImpl::Item
 		SelectItems({ navigateParams.originalPidl });
 	}
 
+	ApplyDeferredDirectoryChanges();
+
+	m_navigationCompletedSignal(navigateParams);
+}
+
+void ShellBrowserImpl::StartDirectoryMonitoringIfNecessary()
+{
 	if (m_config->shellChangeNotificationType == ShellChangeNotificationType::All
 		|| (m_config->shellChangeNotificationType == ShellChangeNotificationType::NonFilesystem
 			&& m_directoryState.virtualFolder))
 	{
 		StartDirectoryMonitoring(m_directoryState.pidlDirectory.Raw());
 	}
+}
 
-	m_bFolderVisited = TRUE;
+void ShellBrowserImpl::ApplyDeferredDirectoryChanges()
+{
+	auto &itemRetrieval = m_directoryState.itemRetrieval;
 
-	m_navigationCompletedSignal(navigateParams);
+	auto deferredShellChanges = std::exchange(itemRetrieval.deferredShellChanges, {});
+
+	if (!deferredShellChanges.empty())
+	{
+		ProcessShellChangeNotifications(deferredShellChanges);
+	}
+
+	// The changes themselves are still in the queue, so they simply need to be drained.
+	if (std::exchange(itemRetrieval.directoryChangesDeferred, false))
+	{
+		DirectoryAltered();
+	}
 }
 
 void ShellBrowserImpl::InsertAwaitingItems()
@@ -577,23 +798,31 @@ void ShellBrowserImpl::InsertAwaitingItems()
 
 	if (nPrevItems == 0 && m_directoryState.awaitingAddList.empty())
 	{
-		m_directoryState.numItems = 0;
-
 		return;
 	}
 
 	/* Make the listview allocate space (for internal data structures)
 	for all the items at once, rather than individually.
 	Acts as a speed optimization. */
-	ListView_SetItemCount(m_hListView, m_directoryState.awaitingAddList.size() + nPrevItems);
+	// A virtual listview has no per-item storage to allocate. Its item count is updated once the
+	// items have been added to the model.
+	if (!m_virtualListView)
+	{
+		ListView_SetItemCount(m_hListView, m_directoryState.awaitingAddList.size() + nPrevItems);
+	}
 
 	if (m_folderSettings.autoArrange)
 	{
 		ListViewHelper::SetAutoArrange(m_hListView, false);
 	}
 
-	int nAdded = 0;
 	std::optional<int> itemToRename;
+	std::vector<int> itemsToSelect;
+
+	// Items are added to the model for a virtual listview in a single batch once the loop below
+	// has finished, since inserting items one at a time would require the item order to be
+	// shifted for each item.
+	std::vector<std::pair<int, int>> virtualListViewItems;
 
 	for (const auto &awaitingItem : m_directoryState.awaitingAddList)
 	{
@@ -605,123 +834,169 @@ void ShellBrowserImpl::InsertAwaitingItems()
 			continue;
 		}
 
-		BasicItemInfo_t basicItemInfo = getBasicItemInfo(awaitingItem.iItemInternal);
-		std::wstring filename = ProcessItemFileName(basicItemInfo, m_config->globalFolderSettings);
-
-		LVITEM lv;
-		lv.mask = LVIF_TEXT | LVIF_IMAGE | LVIF_PARAM;
-
-		if (m_folderSettings.showInGroups)
+		if (m_virtualListView)
 		{
-			int groupId = DetermineItemGroup(awaitingItem.iItemInternal);
-
-			lv.mask |= LVIF_GROUPID;
-			lv.iGroupId = groupId;
-
-			EnsureGroupExistsInListView(groupId);
+			virtualListViewItems.emplace_back(awaitingItem.iItemInternal, awaitingItem.iItem);
+		}
+		else
+		{
+			InsertListViewItem(awaitingItem);
 		}
 
-		lv.iItem = awaitingItem.iItem;
-		lv.iSubItem = 0;
-
-		auto firstColumn = GetFirstCheckedColumn();
-
-		if ((m_folderSettings.viewMode == +ViewMode::Details)
-			&& firstColumn.type != +ColumnType::Name)
+		if (m_directoryState.queuedRenameItem.HasValue()
+			&& ArePidlsEquivalent(itemInfo.pidlComplete.Raw(),
+				m_directoryState.queuedRenameItem.Raw()))
 		{
-			lv.pszText = LPSTR_TEXTCALLBACK;
+			itemToRename = awaitingItem.iItemInternal;
 		}
-		else
+
+		auto selectItr = std::find_if(m_directoryState.filesToSelect.begin(),
+			m_directoryState.filesToSelect.end(), [&itemInfo](const auto &pidl)
+			{ return ArePidlsEquivalent(pidl.Raw(), itemInfo.pidlComplete.Raw()); });
+
+		if (selectItr != m_directoryState.filesToSelect.end())
 		{
-			lv.pszText = filename.data();
+			itemsToSelect.push_back(awaitingItem.iItemInternal);
+			m_directoryState.filesToSelect.erase(selectItr);
 		}
 
-		lv.iImage = I_IMAGECALLBACK;
-		lv.lParam = awaitingItem.iItemInternal;
+		AddTrackedItem(awaitingItem.iItemInternal);
+	}
+
+	if (m_folderSettings.autoArrange)
+	{
+		ListViewHelper::SetAutoArrange(m_hListView, true);
+	}
 
-		/* Insert the item into the list view control. */
-		int iItemIndex = ListView_InsertItem(m_hListView, &lv);
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.InsertItems(virtualListViewItems);
 
-		if (awaitingItem.bPosition && m_folderSettings.viewMode != +ViewMode::Details)
+		for (const auto &virtualListViewItem : virtualListViewItems)
 		{
-			POINT ptItem;
+			int internalIndex = virtualListViewItem.first;
+			int index = *m_listViewItemModel.GetPosition(internalIndex);
 
-			if (awaitingItem.iAfter != -1)
+			if (m_folderSettings.showInGroups)
 			{
-				ListView_GetItemPosition(m_hListView, awaitingItem.iAfter, &ptItem);
+				InsertItemIntoGroup(index, DetermineItemGroup(internalIndex));
 			}
-			else
+
+			/* If the file is marked as hidden, ghost it out. */
+			if (m_itemInfoMap.at(internalIndex).wfd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)
 			{
-				ptItem.x = 0;
-				ptItem.y = 0;
+				SetItemCutState(index, true);
 			}
-
-			/* The item will end up in the position AFTER iAfter. */
-			ListView_SetItemPosition32(m_hListView, iItemIndex, ptItem.x, ptItem.y);
 		}
 
-		if (m_folderSettings.viewMode == +ViewMode::Tiles)
+		if (m_folderSettings.showInGroups)
 		{
-			SetTileViewItemInfo(iItemIndex, awaitingItem.iItemInternal);
+			// The sorted positions the items were inserted at don't take groups into account.
+			m_listViewItemModel.Sort(
+				std::bind_front(&ShellBrowserImpl::CompareVirtualListViewItems, this));
 		}
 
-		if (m_directoryState.queuedRenameItem.HasValue()
-			&& ArePidlsEquivalent(itemInfo.pidlComplete.Raw(),
-				m_directoryState.queuedRenameItem.Raw()))
+		UpdateVirtualListViewItemCount();
+	}
+
+	m_directoryState.awaitingAddList.clear();
+
+	// Inserting an item can change the index of items that were inserted previously, so the items
+	// are only selected once all the items have been inserted.
+	for (int internalIndex : itemsToSelect)
+	{
+		auto index = LocateItemByInternalIndex(internalIndex);
+		CHECK(index);
+
+		ListViewHelper::SelectItem(m_hListView, *index, true);
+
+		int selectedCount = ListView_GetSelectedCount(m_hListView);
+
+		if (selectedCount == 1)
 		{
-			itemToRename = iItemIndex;
+			ListViewHelper::FocusItem(m_hListView, *index, true);
+			ListView_EnsureVisible(m_hListView, *index, FALSE);
 		}
+	}
 
-		auto selectItr = std::find_if(m_directoryState.filesToSelect.begin(),
-			m_directoryState.filesToSelect.end(), [&itemInfo](const auto &pidl)
-			{ return ArePidlsEquivalent(pidl.Raw(), itemInfo.pidlComplete.Raw()); });
+	if (itemToRename)
+	{
+		m_directoryState.queuedRenameItem.Reset();
 
-		if (selectItr != m_directoryState.filesToSelect.end())
-		{
-			ListViewHelper::SelectItem(m_hListView, iItemIndex, true);
+		auto index = LocateItemByInternalIndex(*itemToRename);
+		CHECK(index);
 
-			int selectedCount = ListView_GetSelectedCount(m_hListView);
+		ListView_EditLabel(m_hListView, *index);
+	}
+}
 
-			if (selectedCount == 1)
-			{
-				ListViewHelper::FocusItem(m_hListView, iItemIndex, true);
-				ListView_EnsureVisible(m_hListView, iItemIndex, FALSE);
-			}
+void ShellBrowserImpl::InsertListViewItem(const AwaitingAdd_t &awaitingItem)
+{
+	const auto &itemInfo = m_itemInfoMap.at(awaitingItem.iItemInternal);
 
-			m_directoryState.filesToSelect.erase(selectItr);
-		}
+	BasicItemInfo_t basicItemInfo = getBasicItemInfo(awaitingItem.iItemInternal);
+	std::wstring filename = ProcessItemFileName(basicItemInfo, m_config->globalFolderSettings);
 
-		/* If the file is marked as hidden, ghost it out. */
-		if (itemInfo.wfd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)
-		{
-			ListView_SetItemState(m_hListView, iItemIndex, LVIS_CUT, LVIS_CUT);
-		}
+	LVITEM lv;
+	lv.mask = LVIF_TEXT | LVIF_IMAGE | LVIF_PARAM;
 
-		/* Add the current file's size to the running size of the current directory. */
-		/* A folder may or may not have 0 in its high file size member.
-		It should either be zeroed, or never counted. */
-		ULARGE_INTEGER ulFileSize;
-		ulFileSize.LowPart = itemInfo.wfd.nFileSizeLow;
-		ulFileSize.HighPart = itemInfo.wfd.nFileSizeHigh;
+	if (m_folderSettings.showInGroups)
+	{
+		int groupId = DetermineItemGroup(awaitingItem.iItemInternal);
 
-		m_directoryState.totalDirSize += ulFileSize.QuadPart;
+		lv.mask |= LVIF_GROUPID;
+		lv.iGroupId = groupId;
 
-		nAdded++;
+		EnsureGroupExistsInListView(groupId);
 	}
 
-	if (m_folderSettings.autoArrange)
+	lv.iItem = awaitingItem.iItem;
+	lv.iSubItem = 0;
+
+	auto firstColumn = GetFirstCheckedColumn();
+
+	if ((m_folderSettings.viewMode == +ViewMode::Details) && firstColumn.type != +ColumnType::Name)
 	{
-		ListViewHelper::SetAutoArrange(m_hListView, true);
+		lv.pszText = LPSTR_TEXTCALLBACK;
+	}
+	else
+	{
+		lv.pszText = filename.data();
 	}
 
-	m_directoryState.numItems = nPrevItems + nAdded;
+	lv.iImage = I_IMAGECALLBACK;
+	lv.lParam = awaitingItem.iItemInternal;
 
-	m_directoryState.awaitingAddList.clear();
+	/* Insert the item into the list view control. */
+	int iItemIndex = ListView_InsertItem(m_hListView, &lv);
 
-	if (itemToRename)
+	if (awaitingItem.bPosition && m_folderSettings.viewMode != +ViewMode::Details)
 	{
-		m_directoryState.queuedRenameItem.Reset();
-		ListView_EditLabel(m_hListView, *itemToRename);
+		POINT ptItem;
+
+		if (awaitingItem.iAfter != -1)
+		{
+			ListView_GetItemPosition(m_hListView, awaitingItem.iAfter, &ptItem);
+		}
+		else
+		{
+			ptItem.x = 0;
+			ptItem.y = 0;
+		}
+
+		/* The item will end up in the position AFTER iAfter. */
+		ListView_SetItemPosition32(m_hListView, iItemIndex, ptItem.x, ptItem.y);
+	}
+
+	if (m_folderSettings.viewMode == +ViewMode::Tiles)
+	{
+		SetTileViewItemInfo(iItemIndex, awaitingItem.iItemInternal);
+	}
+
+	/* If the file is marked as hidden, ghost it out. */
+	if (itemInfo.wfd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)
+	{
+		SetItemCutState(iItemIndex, true);
 	}
 }
 
@@ -747,36 +1022,27 @@ BOOL ShellBrowserImpl::IsFileFiltered(const ItemInfo_t &itemInfo) const
 
 void ShellBrowserImpl::RemoveItem(int iItemInternal)
 {
-	ULARGE_INTEGER ulFileSize;
-	LVFINDINFO lvfi;
-	int iItem;
-	int nItems;
-
 	if (iItemInternal == -1)
 	{
 		return;
 	}
 
-	/* Take the file size of the removed file away from the total
-	directory size. */
-	ulFileSize.LowPart = m_itemInfoMap.at(iItemInternal).wfd.nFileSizeLow;
-	ulFileSize.HighPart = m_itemInfoMap.at(iItemInternal).wfd.nFileSizeHigh;
+	// This also removes the item from the selection, if it's selected.
+	m_directoryState.selectionTracker.RemoveItem(iItemInternal);
 
-	m_directoryState.totalDirSize -= ulFileSize.QuadPart;
+	m_columnTextScheduler->InvalidateItem(iItemInternal);
 
 	/* Locate the item within the listview.
 	Could use filename, providing removed
 	items are always deleted before new
 	items are inserted. */
-	lvfi.flags = LVFI_PARAM;
-	lvfi.lParam = iItemInternal;
-	iItem = ListView_FindItem(m_hListView, -1, &lvfi);
+	auto index = LocateItemByInternalIndex(iItemInternal);
 
-	if (iItem != -1)
+	if (index)
 	{
 		if (m_folderSettings.showInGroups)
 		{
-			auto groupId = GetItemGroupId(iItem);
+			auto groupId = GetItemGroupId(*index);
 
 			if (groupId)
 			{
@@ -785,15 +1051,20 @@ void ShellBrowserImpl::RemoveItem(int iItemInternal)
 		}
 
 		/* Remove the item from the listview. */
-		ListView_DeleteItem(m_hListView, iItem);
+		DeleteListViewItem(*index);
 	}
 
-	m_directoryState.filteredItemsList.erase(iItemInternal);
-	m_itemInfoMap.erase(iItemInternal);
-
-	nItems = ListView_GetItemCount(m_hListView);
+	DiscardItem(iItemInternal);
+}
 
-	m_directoryState.numItems--;
+// Removes the stored details for an item. The item itself should already have been removed from
+// the listview (or never inserted in the first place).
+void ShellBrowserImpl::DiscardItem(int internalIndex)
+{
+	m_directoryState.filteredItemsList.erase(internalIndex);
+	m_itemInfoMap.erase(internalIndex);
+	m_sortKeyStore.RemoveItem(internalIndex);
+	m_itemNameIndex.RemoveItem(internalIndex);
 }
 
 ShellNavigationController *ShellBrowserImpl::GetNavigationController() const
@@ -4,6 +4,7 @@
 
 #include "stdafx.h"
 #include "ColumnDataRetrieval.h"
+#include "ColumnValueCache.h"
 #include "Columns.h"
 #include "FolderSettings.h"
 #include "ItemData.h"
@@ -17,11 +18,70 @@
 #include <IPHlpApi.h>
 #include <propkey.h>
 #include <filesystem>
+#include <optional>
+#include <stop_token>
 
 BOOL GetPrinterStatusDescription(DWORD dwStatus, TCHAR *szStatus, size_t cchMax);
+std::wstring GetColumnTextUncached(ColumnType columnType, const BasicItemInfo_t &basicItemInfo,
+	const GlobalFolderSettings &globalFolderSettings, std::stop_token stopToken);
+std::optional<std::wstring> MaybeGetColumnTextUncached(ColumnType columnType,
+	const BasicItemInfo_t &basicItemInfo, const GlobalFolderSettings &globalFolderSettings,
+	std::stop_token stopToken);
+std::optional<std::wstring> MaybeGetVersionColumnText(const BasicItemInfo_t &itemInfo,
+	VersionInfoType versioninfoType);
+std::optional<std::wstring> MaybeGetImageColumnText(const BasicItemInfo_t &itemInfo,
+	PROPID PropertyID);
+std::optional<std::wstring> MaybeGetMediaMetadataColumnText(const BasicItemInfo_t &itemInfo,
+	MediaMetadataType mediaMetadataType);
 
 std::wstring GetColumnText(ColumnType columnType, const BasicItemInfo_t &basicItemInfo,
-	const GlobalFolderSettings &globalFolderSettings)
+	const GlobalFolderSettings &globalFolderSettings, ColumnValueCache *columnValueCache,
+	std::stop_token stopToken)
+{
+	// The cache is keyed on the file's size and last write time, so it can only be used when that
+	// information is available.
+	if (!columnValueCache || !basicItemInfo.isFindDataValid
+		|| !ColumnValueCache::IsColumnCacheable(columnType))
+	{
+		return GetColumnTextUncached(columnType, basicItemInfo, globalFolderSettings, stopToken);
+	}
+
+	auto key =
+		ColumnValueCache::BuildKey(basicItemInfo.getFullPath(), basicItemInfo.wfd, columnType);
+	auto cachedText = columnValueCache->MaybeGetValue(key);
+
+	if (cachedText)
+	{
+		return *cachedText;
+	}
+
+	auto text =
+		MaybeGetColumnTextUncached(columnType, basicItemInfo, globalFolderSettings, stopToken);
+
+	// If the text couldn't be retrieved (e.g. because the file is currently in use), nothing is
+	// cached, so that retrieval will be attempted again the next time the text is needed.
+	if (!text)
+	{
+		return L"";
+	}
+
+	columnValueCache->SetValue(key, *text);
+
+	return *text;
+}
+
+std::wstring GetColumnTextUncached(ColumnType columnType, const BasicItemInfo_t &basicItemInfo,
+	const GlobalFolderSettings &globalFolderSettings, std::stop_token stopToken)
+{
+	return MaybeGetColumnTextUncached(columnType, basicItemInfo, globalFolderSettings, stopToken)
+		.value_or(L"");
+}
+
+// Returns std::nullopt if the text for a column that's read from the file itself couldn't be
+// retrieved. For other columns, failures simply result in empty text.
+std::optional<std::wstring> MaybeGetColumnTextUncached(ColumnType columnType,
+	const BasicItemInfo_t &basicItemInfo, const GlobalFolderSettings &globalFolderSettings,
+	std::stop_token stopToken)
 {
 	switch (columnType)
 	{
@@ -31,7 +91,7 @@ std::wstring GetColumnText(ColumnType columnType, const BasicItemInfo_t &basicIt
 	case ColumnType::Type:
 		return GetTypeColumnText(basicItemInfo);
 	case ColumnType::Size:
-		return GetSizeColumnText(basicItemInfo, globalFolderSettings);
+		return GetSizeColumnText(basicItemInfo, globalFolderSettings, stopToken);
 
 	case ColumnType::DateModified:
 		return GetTimeColumnText(basicItemInfo, TimeType::Modified, globalFolderSettings);
@@ -50,15 +110,15 @@ std::wstring GetColumnText(ColumnType columnType, const BasicItemInfo_t &basicIt
 		return GetOwnerColumnText(basicItemInfo);
 
 	case ColumnType::ProductName:
-		return GetVersionColumnText(basicItemInfo, VersionInfoType::ProductName);
+		return MaybeGetVersionColumnText(basicItemInfo, VersionInfoType::ProductName);
 	case ColumnType::Company:
-		return GetVersionColumnText(basicItemInfo, VersionInfoType::Company);
+		return MaybeGetVersionColumnText(basicItemInfo, VersionInfoType::Company);
 	case ColumnType::Description:
-		return GetVersionColumnText(basicItemInfo, VersionInfoType::Description);
+		return MaybeGetVersionColumnText(basicItemInfo, VersionInfoType::Description);
 	case ColumnType::FileVersion:
-		return GetVersionColumnText(basicItemInfo, VersionInfoType::FileVersion);
+		return MaybeGetVersionColumnText(basicItemInfo, VersionInfoType::FileVersion);
 	case ColumnType::ProductVersion:
-		return GetVersionColumnText(basicItemInfo, VersionInfoType::ProductVersion);
+		return MaybeGetVersionColumnText(basicItemInfo, VersionInfoType::ProductVersion);
 
 	case ColumnType::ShortcutTo:
 		return GetShortcutToColumnText(basicItemInfo);
@@ -79,13 +139,13 @@ std::wstring GetColumnText(ColumnType columnType, const BasicItemInfo_t &basicIt
 		return GetItemDetailsColumnText(basicItemInfo, &PKEY_Comment, globalFolderSettings);
 
 	case ColumnType::CameraModel:
-		return GetImageColumnText(basicItemInfo, PropertyTagEquipModel);
+		return MaybeGetImageColumnText(basicItemInfo, PropertyTagEquipModel);
 	case ColumnType::DateTaken:
-		return GetImageColumnText(basicItemInfo, PropertyTagDateTime);
+		return MaybeGetImageColumnText(basicItemInfo, PropertyTagDateTime);
 	case ColumnType::Width:
-		return GetImageColumnText(basicItemInfo, PropertyTagImageWidth);
+		return MaybeGetImageColumnText(basicItemInfo, PropertyTagImageWidth);
 	case ColumnType::Height:
-		return GetImageColumnText(basicItemInfo, PropertyTagImageHeight);
+		return MaybeGetImageColumnText(basicItemInfo, PropertyTagImageHeight);
 
 	case ColumnType::VirtualComments:
 		return GetControlPanelCommentsColumnText(basicItemInfo);
@@ -125,53 +185,54 @@ std::wstring GetColumnText(ColumnType columnType, const BasicItemInfo_t &basicIt
 		return GetNetworkAdapterColumnText(basicItemInfo);
 
 	case ColumnType::MediaBitrate:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Bitrate);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Bitrate);
 	case ColumnType::MediaCopyright:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Copyright);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Copyright);
 	case ColumnType::MediaDuration:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Duration);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Duration);
 	case ColumnType::MediaProtected:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Protected);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Protected);
 	case ColumnType::MediaRating:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Rating);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Rating);
 	case ColumnType::MediaAlbumArtist:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::AlbumArtist);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::AlbumArtist);
 	case ColumnType::MediaAlbum:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::AlbumTitle);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::AlbumTitle);
 	case ColumnType::MediaBeatsPerMinute:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::BeatsPerMinute);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::BeatsPerMinute);
 	case ColumnType::MediaComposer:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Composer);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Composer);
 	case ColumnType::MediaConductor:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Conductor);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Conductor);
 	case ColumnType::MediaDirector:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Director);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Director);
 	case ColumnType::MediaGenre:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Genre);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Genre);
 	case ColumnType::MediaLanguage:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Language);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Language);
 	case ColumnType::MediaBroadcastDate:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::BroadcastDate);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::BroadcastDate);
 	case ColumnType::MediaChannel:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Channel);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Channel);
 	case ColumnType::MediaStationName:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::StationName);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::StationName);
 	case ColumnType::MediaMood:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Mood);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Mood);
 	case ColumnType::MediaParentalRating:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::ParentalRating);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::ParentalRating);
 	case ColumnType::MediaParentalRatingReason:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::ParentalRatingReason);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo,
+			MediaMetadataType::ParentalRatingReason);
 	case ColumnType::MediaPeriod:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Period);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Period);
 	case ColumnType::MediaProducer:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Producer);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Producer);
 	case ColumnType::MediaPublisher:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Publisher);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Publisher);
 	case ColumnType::MediaWriter:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Writer);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Writer);
 	case ColumnType::MediaYear:
-		return GetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Year);
+		return MaybeGetMediaMetadataColumnText(basicItemInfo, MediaMetadataType::Year);
 
 	default:
 		assert(false);
@@ -246,7 +307,7 @@ std::wstring GetTypeColumnText(const BasicItemInfo_t &itemInfo)
 }
 
 std::wstring GetSizeColumnText(const BasicItemInfo_t &itemInfo,
-	const GlobalFolderSettings &globalFolderSettings)
+	const GlobalFolderSettings &globalFolderSettings, std::stop_token stopToken)
 {
 	if (!itemInfo.isFindDataValid)
 	{
@@ -269,7 +330,7 @@ std::wstring GetSizeColumnText(const BasicItemInfo_t &itemInfo,
 		if (globalFolderSettings.showFolderSizes
 			&& !(globalFolderSettings.disableFolderSizesNetworkRemovable && bNetworkRemovable))
 		{
-			return GetFolderSizeColumnText(itemInfo, globalFolderSettings);
+			return GetFolderSizeColumnText(itemInfo, globalFolderSettings, stopToken);
 		}
 		else
 		{
@@ -284,19 +345,25 @@ std::wstring GetSizeColumnText(const BasicItemInfo_t &itemInfo,
 }
 
 std::wstring GetFolderSizeColumnText(const BasicItemInfo_t &itemInfo,
-	const GlobalFolderSettings &globalFolderSettings)
+	const GlobalFolderSettings &globalFolderSettings, std::stop_token stopToken)
 {
-	auto folderInfo = GetFolderInfo(itemInfo.getFullPath());
-
-	/* TODO: This should
-	be done some other way.
-	Shouldn't depend on
-	the internal index. */
-	// m_cachedFolderSizes.insert({internalIndex, totalFolderSize.QuadPart});
+	// This is called from a task on the shared background pool, once for each folder that's
+	// visible, so the walk is run entirely on the calling thread, rather than starting additional
+	// threads for each folder.
+	//
+	// The result is also stored in the shared folder size cache, which is what allows folders to
+	// be sorted by size.
+	FolderSizeCalculator calculator(&FolderSizeCache::GetInstance(), 1);
+	auto folderInfo = calculator.Calculate(itemInfo.getFullPath(), stopToken);
+
+	if (!folderInfo)
+	{
+		return L"";
+	}
 
 	auto displayFormat = globalFolderSettings.forceSize ? globalFolderSettings.sizeDisplayFormat
 														: +SizeDisplayFormat::None;
-	return FormatSizeString(folderInfo.size, displayFormat);
+	return FormatSizeString(folderInfo->size, displayFormat);
 }
 
 std::wstring GetTimeColumnText(const BasicItemInfo_t &itemInfo, TimeType timeType,
@@ -478,6 +545,12 @@ HRESULT GetItemDetailsRawData(const BasicItemInfo_t &itemInfo, const SHCOLUMNID
 }
 
 std::wstring GetVersionColumnText(const BasicItemInfo_t &itemInfo, VersionInfoType versioninfoType)
+{
+	return MaybeGetVersionColumnText(itemInfo, versioninfoType).value_or(L"");
+}
+
+std::optional<std::wstring> MaybeGetVersionColumnText(const BasicItemInfo_t &itemInfo,
+	VersionInfoType versioninfoType)
 {
 	std::wstring versionInfoName;
 
@@ -514,7 +587,7 @@ std::wstring GetVersionColumnText(const BasicItemInfo_t &itemInfo, VersionInfoTy
 
 	if (!versionInfoObtained)
 	{
-		return L"";
+		return std::nullopt;
 	}
 
 	return versionInfo;
@@ -572,6 +645,12 @@ std::wstring GetExtensionColumnText(const BasicItemInfo_t &itemInfo)
 }
 
 std::wstring GetImageColumnText(const BasicItemInfo_t &itemInfo, PROPID PropertyID)
+{
+	return MaybeGetImageColumnText(itemInfo, PropertyID).value_or(L"");
+}
+
+std::optional<std::wstring> MaybeGetImageColumnText(const BasicItemInfo_t &itemInfo,
+	PROPID PropertyID)
 {
 	TCHAR imageProperty[512];
 	BOOL res = ReadImageProperty(itemInfo.getFullPath().c_str(), PropertyID, imageProperty,
@@ -579,7 +658,7 @@ std::wstring GetImageColumnText(const BasicItemInfo_t &itemInfo, PROPID Property
 
 	if (!res)
 	{
-		return L"";
+		return std::nullopt;
 	}
 
 	return imageProperty;
@@ -811,6 +890,12 @@ std::wstring GetNetworkAdapterColumnText(const BasicItemInfo_t &itemInfo)
 
 std::wstring GetMediaMetadataColumnText(const BasicItemInfo_t &itemInfo,
 	MediaMetadataType mediaMetadataType)
+{
+	return MaybeGetMediaMetadataColumnText(itemInfo, mediaMetadataType).value_or(L"");
+}
+
+std::optional<std::wstring> MaybeGetMediaMetadataColumnText(const BasicItemInfo_t &itemInfo,
+	MediaMetadataType mediaMetadataType)
 {
 	const TCHAR *attributeName = GetMediaMetadataAttributeName(mediaMetadataType);
 
@@ -819,7 +904,7 @@ std::wstring GetMediaMetadataColumnText(const BasicItemInfo_t &itemInfo,
 
 	if (!SUCCEEDED(hr))
 	{
-		return L"";
+		return std::nullopt;
 	}
 
 	TCHAR szOutput[512];
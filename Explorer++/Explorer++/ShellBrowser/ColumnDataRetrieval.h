@@ -5,8 +5,10 @@
 #pragma once
 
 #include "Columns.h"
+#include <stop_token>
 #include <string>
 
+class ColumnValueCache;
 struct BasicItemInfo_t;
 struct GlobalFolderSettings;
 
@@ -63,8 +65,12 @@ enum class MediaMetadataType
 	Year
 };
 
+// If a cache is provided, it will be checked before the column text is retrieved, and updated
+// afterwards, for columns that can be cached. The stop token is used to abandon slow retrievals
+// (such as the calculation of a folder's size), in which case the text will be empty.
 std::wstring GetColumnText(ColumnType columnType, const BasicItemInfo_t &basicItemInfo,
-	const GlobalFolderSettings &globalFolderSettings);
+	const GlobalFolderSettings &globalFolderSettings, ColumnValueCache *columnValueCache,
+	std::stop_token stopToken = {});
 std::wstring GetNameColumnText(const BasicItemInfo_t &itemInfo,
 	const GlobalFolderSettings &globalFolderSettings);
 std::wstring ProcessItemFileName(const BasicItemInfo_t &itemInfo,
@@ -103,6 +109,6 @@ std::wstring GetDriveSpaceColumnText(const BasicItemInfo_t &itemInfo, bool Total
 BOOL GetDriveSpaceColumnRawData(const BasicItemInfo_t &itemInfo, bool TotalSize,
 	ULARGE_INTEGER &DriveSpace);
 std::wstring GetSizeColumnText(const BasicItemInfo_t &itemInfo,
-	const GlobalFolderSettings &globalFolderSettings);
+	const GlobalFolderSettings &globalFolderSettings, std::stop_token stopToken = {});
 std::wstring GetFolderSizeColumnText(const BasicItemInfo_t &itemInfo,
-	const GlobalFolderSettings &globalFolderSettings);
+	const GlobalFolderSettings &globalFolderSettings, std::stop_token stopToken = {});
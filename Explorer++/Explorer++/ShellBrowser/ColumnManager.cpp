@@ -4,6 +4,7 @@
 
 #include "stdafx.h"
 #include "ShellBrowserImpl.h"
+#include "App.h"
 #include "ColumnDataRetrieval.h"
 #include "Columns.h"
 #include "Config.h"
@@ -12,70 +13,138 @@
 #include "ResourceHelper.h"
 #include "SortModes.h"
 #include "ViewModes.h"
+#include "../Helper/FolderSize.h"
+#include <algorithm>
 #include <cassert>
 #include <list>
 
 void ShellBrowserImpl::QueueColumnTask(int itemInternalIndex, ColumnType columnType)
 {
-	int columnResultID = m_columnResultIDCounter++;
+	bool taskCreated = m_columnTextScheduler->AddRequest(itemInternalIndex, columnType,
+		[this, itemInternalIndex] { return getBasicItemInfo(itemInternalIndex); },
+		m_config->globalFolderSettings);
 
-	BasicItemInfo_t basicItemInfo = getBasicItemInfo(itemInternalIndex);
-	GlobalFolderSettings globalFolderSettings = m_config->globalFolderSettings;
+	if (!taskCreated)
+	{
+		// Either this column has already been requested, or it's been added to an existing task
+		// for the item.
+		return;
+	}
 
-	auto result = m_columnThreadPool.push(
-		[listView = m_hListView, columnResultID, columnType, itemInternalIndex, basicItemInfo,
-			globalFolderSettings](int id)
+	// Each job runs whichever task has the highest priority at the time, which won't necessarily
+	// be the task that was just created. There's one job per task, however, so every task will
+	// eventually be run.
+	m_columnTaskGroup.Push(
+		[columnTextScheduler = m_columnTextScheduler,
+			columnValueCache = m_app->GetColumnValueCache(),
+			listView = m_hListView](std::stop_token stopToken)
 		{
-			UNREFERENCED_PARAMETER(id);
-
-			return GetColumnTextAsync(listView, columnResultID, columnType, itemInternalIndex,
-				basicItemInfo, globalFolderSettings);
+			RetrieveColumnText(columnTextScheduler.get(), columnValueCache, listView, stopToken);
 		});
-
-	// The function call above might finish before this line runs,
-	// but that doesn't matter, as the results won't be processed
-	// until a message posted to the main thread has been handled
-	// (which can only occur after this function has returned).
-	m_columnResults.insert({ columnResultID, std::move(result) });
 }
 
-ShellBrowserImpl::ColumnResult_t ShellBrowserImpl::GetColumnTextAsync(HWND listView,
-	int columnResultId, ColumnType columnType, int internalIndex,
-	const BasicItemInfo_t &basicItemInfo, const GlobalFolderSettings &globalFolderSettings)
+void ShellBrowserImpl::RetrieveColumnText(ColumnTextScheduler *columnTextScheduler,
+	ColumnValueCache *columnValueCache, HWND listView, std::stop_token stopToken)
 {
-	std::wstring columnText = GetColumnText(columnType, basicItemInfo, globalFolderSettings);
+	auto task = columnTextScheduler->PopTask();
 
-	// This message may be delivered before this function has returned.
-	// That doesn't actually matter, since the message handler will
-	// simply wait for the result to be returned.
-	PostMessage(listView, WM_APP_COLUMN_RESULT_READY, columnResultId, 0);
+	if (!task)
+	{
+		// The pending tasks have been cleared.
+		return;
+	}
 
-	ColumnResult_t result;
-	result.itemInternalIndex = internalIndex;
-	result.columnType = columnType;
-	result.columnText = columnText;
+	std::vector<ColumnTextScheduler::Result> results;
 
-	return result;
+	for (auto columnType : task->columnTypes)
+	{
+		results.emplace_back(task->internalIndex, columnType,
+			GetColumnText(columnType, task->basicItemInfo, *task->globalFolderSettings,
+				columnValueCache, stopToken));
+	}
+
+	if (stopToken.stop_requested())
+	{
+		// The text for a slow column may have been abandoned part way through, so the results
+		// can't be used.
+		return;
+	}
+
+	// Only a single message is posted for each batch of results. Any results that arrive before
+	// the message has been processed will be picked up along with it.
+	if (columnTextScheduler->CompleteTask(*task, std::move(results)))
+	{
+		PostMessage(listView, WM_APP_COLUMN_RESULT_READY, 0, 0);
+	}
 }
 
-void ShellBrowserImpl::ProcessColumnResult(int columnResultId)
+void ShellBrowserImpl::ProcessColumnResults()
 {
-	auto itr = m_columnResults.find(columnResultId);
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = now - m_lastColumnResultsTime;
 
-	if (itr == m_columnResults.end())
+	if (elapsed < COLUMN_RESULTS_INTERVAL)
 	{
-		// This result is for a previous folder. It can be ignored.
+		// A batch was applied within the current frame. This batch will be applied once the frame
+		// has ended, along with any further results that arrive in the meantime.
+		auto delay =
+			std::chrono::ceil<std::chrono::milliseconds>(COLUMN_RESULTS_INTERVAL - elapsed);
+		SetTimer(m_hListView, COLUMN_RESULTS_TIMER_ID, static_cast<UINT>(delay.count()), nullptr);
 		return;
 	}
 
-	if (m_folderSettings.viewMode != +ViewMode::Details)
+	m_lastColumnResultsTime = now;
+
+	auto results = m_columnTextScheduler->TakeResults();
+	bool groupsPending = !m_directoryState.pendingGroupItems.empty();
+	bool folderSizesUpdated = false;
+
+	for (const auto &result : results)
 	{
-		return;
+		ApplyColumnResult(result);
+
+		if (result.columnType == +ColumnType::Size && UpdateFolderSizeSortKey(result.internalIndex))
+		{
+			folderSizesUpdated = true;
+		}
 	}
 
-	auto result = itr->second.get();
+	// As in ProcessGroupResults, a virtual listview can only put the items into their final
+	// positions once every group is known.
+	bool groupsCompleted =
+		m_virtualListView && groupsPending && m_directoryState.pendingGroupItems.empty();
 
-	auto index = LocateItemByInternalIndex(result.itemInternalIndex);
+	if (groupsCompleted || (folderSizesUpdated && m_folderSettings.sortMode == +SortMode::Size))
+	{
+		SortFolder();
+	}
+}
+
+// Folder sizes are calculated when the size column text is retrieved. Once a size is known, it can
+// be used to sort the folder.
+bool ShellBrowserImpl::UpdateFolderSizeSortKey(int internalIndex)
+{
+	auto itr = m_itemInfoMap.find(internalIndex);
+
+	if (itr == m_itemInfoMap.end() || !m_sortKeyStore.IsFolder(internalIndex))
+	{
+		return false;
+	}
+
+	auto folderInfo = FolderSizeCache::GetInstance().MaybeGetFolderInfo(itr->second.parsingName);
+
+	if (!folderInfo)
+	{
+		return false;
+	}
+
+	m_sortKeyStore.SetFolderSize(internalIndex, folderInfo->size);
+	return true;
+}
+
+void ShellBrowserImpl::ApplyColumnResult(const ColumnTextScheduler::Result &result)
+{
+	auto index = LocateItemByInternalIndex(result.internalIndex);
 
 	if (!index)
 	{
@@ -83,6 +152,32 @@ void ShellBrowserImpl::ProcessColumnResult(int columnResultId)
 		return;
 	}
 
+	m_itemInfoMap.at(result.internalIndex).columnText[result.columnType._to_integral()] =
+		result.columnText;
+
+	auto groupColumn = GetGroupModeColumn(m_folderSettings.groupMode);
+
+	if (groupColumn && *groupColumn == result.columnType
+		&& m_directoryState.pendingGroupItems.contains(result.internalIndex))
+	{
+		InsertItemIntoGroup(*index, DetermineItemGroup(result.internalIndex));
+	}
+
+	// Outside of the details view, the text is only needed for grouping.
+	if (m_folderSettings.viewMode != +ViewMode::Details)
+	{
+		return;
+	}
+
+	if (m_virtualListView)
+	{
+		// Text is stored by column type, so it remains valid even if the column is moved.
+		m_listViewItemModel.SetColumnText(result.internalIndex, result.columnType._to_integral(),
+			result.columnText);
+		ListView_RedrawItems(m_hListView, *index, *index);
+		return;
+	}
+
 	auto columnIndex = GetColumnIndexByType(result.columnType);
 
 	if (!columnIndex)
@@ -94,8 +189,44 @@ void ShellBrowserImpl::ProcessColumnResult(int columnResultId)
 	auto columnText = std::make_unique<TCHAR[]>(result.columnText.size() + 1);
 	StringCchCopy(columnText.get(), result.columnText.size() + 1, result.columnText.c_str());
 	ListView_SetItemText(m_hListView, *index, *columnIndex, columnText.get());
+}
+
+// The listview only reports the text it needs as it paints, so once scrolling has finished, any
+// tasks for items that are no longer visible are moved behind the tasks for the visible items.
+void ShellBrowserImpl::UpdateColumnTaskPriorities()
+{
+	if (m_folderSettings.viewMode != +ViewMode::Details)
+	{
+		return;
+	}
+
+	int topIndex = ListView_GetTopIndex(m_hListView);
+	int lastIndex = std::min(topIndex + ListView_GetCountPerPage(m_hListView),
+		ListView_GetItemCount(m_hListView) - 1);
+
+	std::unordered_set<int> visibleItems;
+
+	for (int i = topIndex; i <= lastIndex; i++)
+	{
+		visibleItems.insert(GetItemInternalIndex(i));
+	}
+
+	m_columnTextScheduler->SetVisibleItems(visibleItems);
+}
+
+void ShellBrowserImpl::LogColumnTextMetrics() const
+{
+	auto metrics = m_columnTextScheduler->GetMetrics();
+
+	if (metrics.requestsReceived == 0)
+	{
+		return;
+	}
 
-	m_columnResults.erase(itr);
+	LOG(INFO) << "Column text: " << metrics.requestsReceived << " requests, "
+			  << metrics.duplicatesDropped << " duplicates dropped, " << metrics.queueDepth
+			  << " items still queued, latency p50/p90/p99 " << metrics.latencyP50.count() << "/"
+			  << metrics.latencyP90.count() << "/" << metrics.latencyP99.count() << " us";
 }
 
 std::optional<int> ShellBrowserImpl::GetColumnIndexByType(ColumnType columnType) const
@@ -0,0 +1,270 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ColumnTextScheduler.h"
+#include <algorithm>
+#include <limits>
+
+bool ColumnTextScheduler::AddRequest(int internalIndex, ColumnType columnType,
+	const BasicItemInfoGetter &getBasicItemInfo, const GlobalFolderSettings &globalFolderSettings)
+{
+	std::scoped_lock lock(m_mutex);
+
+	m_requestsReceived++;
+
+	auto pendingItr = m_pendingTasks.find(internalIndex);
+
+	if (pendingItr != m_pendingTasks.end())
+	{
+		// The listview only requests text for items it's painting, so an item that's requested
+		// again while it's waiting is still on screen and should be moved to the front.
+		m_taskOrder.erase(pendingItr->second.priorityKey);
+		pendingItr->second.priorityKey = BuildPriorityKey(internalIndex);
+		m_taskOrder.insert(pendingItr->second.priorityKey);
+	}
+
+	// There are only ever a handful of columns outstanding for an item, so a linear search is
+	// sufficient.
+	auto &outstandingRequests = m_outstandingRequests[internalIndex];
+	bool alreadyRequested = std::ranges::any_of(outstandingRequests,
+		[columnType](const OutstandingRequest &request)
+		{ return request.columnType == columnType._to_integral(); });
+
+	if (alreadyRequested)
+	{
+		m_duplicatesDropped++;
+		return false;
+	}
+
+	outstandingRequests.push_back({ columnType._to_integral(), Clock::now() });
+
+	if (pendingItr != m_pendingTasks.end())
+	{
+		pendingItr->second.columnTypes.push_back(columnType);
+		return false;
+	}
+
+	if (!m_globalFolderSettings || *m_globalFolderSettings != globalFolderSettings)
+	{
+		m_globalFolderSettings = std::make_shared<const GlobalFolderSettings>(globalFolderSettings);
+	}
+
+	PendingTask pendingTask = { { columnType }, getBasicItemInfo(), m_globalFolderSettings,
+		BuildPriorityKey(internalIndex) };
+	m_taskOrder.insert(pendingTask.priorityKey);
+	m_pendingTasks.emplace(internalIndex, std::move(pendingTask));
+
+	return true;
+}
+
+std::optional<ColumnTextScheduler::Task> ColumnTextScheduler::PopTask()
+{
+	std::scoped_lock lock(m_mutex);
+
+	if (m_taskOrder.empty())
+	{
+		return std::nullopt;
+	}
+
+	int internalIndex = m_taskOrder.begin()->internalIndex;
+	m_taskOrder.erase(m_taskOrder.begin());
+
+	auto node = m_pendingTasks.extract(internalIndex);
+	CHECK(!node.empty());
+
+	auto &pendingTask = node.mapped();
+
+	return Task{ internalIndex, std::move(pendingTask.columnTypes),
+		std::move(pendingTask.basicItemInfo), std::move(pendingTask.globalFolderSettings),
+		m_generation, m_nextTaskId++ };
+}
+
+bool ColumnTextScheduler::CompleteTask(const Task &task, std::vector<Result> &&results)
+{
+	std::scoped_lock lock(m_mutex);
+
+	if (!IsTaskValid(task))
+	{
+		return false;
+	}
+
+	m_completedTasks.push_back({ task.internalIndex, task.taskId, std::move(results) });
+
+	if (m_notificationPending)
+	{
+		return false;
+	}
+
+	m_notificationPending = true;
+
+	return true;
+}
+
+std::vector<ColumnTextScheduler::Result> ColumnTextScheduler::TakeResults()
+{
+	std::scoped_lock lock(m_mutex);
+
+	m_notificationPending = false;
+
+	auto now = Clock::now();
+	std::vector<Result> results;
+
+	for (auto &completedTask : m_completedTasks)
+	{
+		// The item may have been invalidated since the task was completed.
+		if (!WasTaskCreatedAfterInvalidation(completedTask.internalIndex, completedTask.taskId))
+		{
+			continue;
+		}
+
+		auto requestsItr = m_outstandingRequests.find(completedTask.internalIndex);
+
+		for (auto &result : completedTask.results)
+		{
+			if (requestsItr != m_outstandingRequests.end())
+			{
+				auto &outstandingRequests = requestsItr->second;
+				auto itr = std::ranges::find(outstandingRequests,
+					result.columnType._to_integral(), &OutstandingRequest::columnType);
+
+				if (itr != outstandingRequests.end())
+				{
+					RecordLatency(now - itr->requestTime);
+					outstandingRequests.erase(itr);
+				}
+			}
+
+			results.push_back(std::move(result));
+		}
+
+		if (requestsItr != m_outstandingRequests.end() && requestsItr->second.empty())
+		{
+			m_outstandingRequests.erase(requestsItr);
+		}
+	}
+
+	m_completedTasks.clear();
+
+	return results;
+}
+
+void ColumnTextScheduler::SetVisibleItems(const std::unordered_set<int> &internalIndexes)
+{
+	std::scoped_lock lock(m_mutex);
+
+	m_visibleItems = internalIndexes;
+
+	for (auto &[internalIndex, pendingTask] : m_pendingTasks)
+	{
+		bool notVisible = !m_visibleItems.contains(internalIndex);
+
+		if (pendingTask.priorityKey.notVisible == notVisible)
+		{
+			continue;
+		}
+
+		m_taskOrder.erase(pendingTask.priorityKey);
+		pendingTask.priorityKey.notVisible = notVisible;
+		m_taskOrder.insert(pendingTask.priorityKey);
+	}
+}
+
+void ColumnTextScheduler::InvalidateItem(int internalIndex)
+{
+	std::scoped_lock lock(m_mutex);
+
+	auto pendingItr = m_pendingTasks.find(internalIndex);
+
+	if (pendingItr != m_pendingTasks.end())
+	{
+		m_taskOrder.erase(pendingItr->second.priorityKey);
+		m_pendingTasks.erase(pendingItr);
+	}
+
+	m_outstandingRequests.erase(internalIndex);
+
+	// Any results that have already been stored for the item will be discarded by TakeResults().
+	m_firstValidTaskIds[internalIndex] = m_nextTaskId;
+}
+
+void ColumnTextScheduler::Clear()
+{
+	std::scoped_lock lock(m_mutex);
+
+	m_generation++;
+
+	m_pendingTasks.clear();
+	m_taskOrder.clear();
+	m_visibleItems.clear();
+	m_outstandingRequests.clear();
+	m_firstValidTaskIds.clear();
+	m_completedTasks.clear();
+
+	m_requestsReceived = 0;
+	m_duplicatesDropped = 0;
+	m_latencySamples.clear();
+}
+
+ColumnTextScheduler::Metrics ColumnTextScheduler::GetMetrics() const
+{
+	std::scoped_lock lock(m_mutex);
+
+	Metrics metrics;
+	metrics.queueDepth = m_pendingTasks.size();
+	metrics.requestsReceived = m_requestsReceived;
+	metrics.duplicatesDropped = m_duplicatesDropped;
+
+	if (!m_latencySamples.empty())
+	{
+		std::vector<Clock::duration> samples(m_latencySamples.begin(), m_latencySamples.end());
+		metrics.latencyP50 = GetPercentile(samples, 0.5);
+		metrics.latencyP90 = GetPercentile(samples, 0.9);
+		metrics.latencyP99 = GetPercentile(samples, 0.99);
+	}
+
+	return metrics;
+}
+
+ColumnTextScheduler::PriorityKey ColumnTextScheduler::BuildPriorityKey(int internalIndex)
+{
+	return { !m_visibleItems.contains(internalIndex),
+		std::numeric_limits<uint64_t>::max() - m_sequence++, internalIndex };
+}
+
+bool ColumnTextScheduler::IsTaskValid(const Task &task) const
+{
+	if (task.generation != m_generation)
+	{
+		return false;
+	}
+
+	return WasTaskCreatedAfterInvalidation(task.internalIndex, task.taskId);
+}
+
+bool ColumnTextScheduler::WasTaskCreatedAfterInvalidation(int internalIndex,
+	uint64_t taskId) const
+{
+	auto itr = m_firstValidTaskIds.find(internalIndex);
+
+	return itr == m_firstValidTaskIds.end() || taskId >= itr->second;
+}
+
+void ColumnTextScheduler::RecordLatency(Clock::duration latency)
+{
+	if (m_latencySamples.size() == MAX_LATENCY_SAMPLES)
+	{
+		m_latencySamples.pop_front();
+	}
+
+	m_latencySamples.push_back(latency);
+}
+
+std::chrono::microseconds ColumnTextScheduler::GetPercentile(std::vector<Clock::duration> &samples,
+	double percentile)
+{
+	auto index = static_cast<size_t>(percentile * static_cast<double>(samples.size() - 1));
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return std::chrono::duration_cast<std::chrono::microseconds>(samples[index]);
+}
@@ -0,0 +1,176 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "Columns.h"
+#include "FolderSettings.h"
+#include "ItemData.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Schedules the retrieval of column text for the items in a listview. Requests are made on the UI
+// thread, the text is retrieved on a background thread and the results are handed back to the UI
+// thread in batches.
+//
+// Requests are deduplicated on (item, column, generation), so each column for an item is only
+// retrieved once, no matter how many times the listview asks for it (e.g. as it's scrolled back and
+// forth). All the outstanding columns for an item are retrieved by a single task. Tasks for visible
+// items are run first and, within that, the most recently requested items are run first, since
+// those are the items the listview has most recently painted.
+//
+// This class is thread-safe.
+class ColumnTextScheduler
+{
+public:
+	struct Task
+	{
+		int internalIndex;
+		std::vector<ColumnType> columnTypes;
+		BasicItemInfo_t basicItemInfo;
+		std::shared_ptr<const GlobalFolderSettings> globalFolderSettings;
+		int generation;
+		uint64_t taskId;
+	};
+
+	struct Result
+	{
+		int internalIndex;
+		ColumnType columnType;
+		std::wstring columnText;
+	};
+
+	struct Metrics
+	{
+		// The number of items waiting for a task to run.
+		size_t queueDepth = 0;
+
+		uint64_t requestsReceived = 0;
+		uint64_t duplicatesDropped = 0;
+
+		// The time between a column first being requested and its text being handed back to the UI
+		// thread. Calculated over the most recent results.
+		std::chrono::microseconds latencyP50 = {};
+		std::chrono::microseconds latencyP90 = {};
+		std::chrono::microseconds latencyP99 = {};
+	};
+
+	using BasicItemInfoGetter = std::function<BasicItemInfo_t()>;
+
+	// Returns true if a new task was created, in which case the caller should arrange for PopTask()
+	// to be called once more on a background thread. The item information is only retrieved when a
+	// new task is created.
+	bool AddRequest(int internalIndex, ColumnType columnType,
+		const BasicItemInfoGetter &getBasicItemInfo,
+		const GlobalFolderSettings &globalFolderSettings);
+
+	// Returns the task with the highest priority, or std::nullopt if there are no tasks waiting.
+	std::optional<Task> PopTask();
+
+	// Stores the results of a task. Returns true if the UI thread should be notified that results
+	// are available. Only a single notification is requested until TakeResults() is next called.
+	bool CompleteTask(const Task &task, std::vector<Result> &&results);
+
+	// Called on the UI thread to retrieve all the results that have accumulated.
+	std::vector<Result> TakeResults();
+
+	// Tasks for the specified items will be run before any other tasks.
+	void SetVisibleItems(const std::unordered_set<int> &internalIndexes);
+
+	// Called when an item has changed. Any pending or in-progress requests for the item will be
+	// discarded, so that the item's columns can be requested again.
+	void InvalidateItem(int internalIndex);
+
+	// Discards all pending requests and results and starts a new generation. Results from tasks
+	// that are still running will be ignored.
+	void Clear();
+
+	Metrics GetMetrics() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr size_t MAX_LATENCY_SAMPLES = 1024;
+
+	struct PriorityKey
+	{
+		// Visible items have a lower value and are sorted first.
+		bool notVisible;
+
+		// The most recently requested items are sorted first.
+		uint64_t inverseSequence;
+
+		int internalIndex;
+
+		auto operator<=>(const PriorityKey &) const = default;
+	};
+
+	struct PendingTask
+	{
+		std::vector<ColumnType> columnTypes;
+		BasicItemInfo_t basicItemInfo;
+		std::shared_ptr<const GlobalFolderSettings> globalFolderSettings;
+		PriorityKey priorityKey;
+	};
+
+	struct OutstandingRequest
+	{
+		ColumnType::_integral columnType;
+		Clock::time_point requestTime;
+	};
+
+	struct CompletedTask
+	{
+		int internalIndex;
+		uint64_t taskId;
+		std::vector<Result> results;
+	};
+
+	PriorityKey BuildPriorityKey(int internalIndex);
+	bool IsTaskValid(const Task &task) const;
+	bool WasTaskCreatedAfterInvalidation(int internalIndex, uint64_t taskId) const;
+	void RecordLatency(Clock::duration latency);
+	static std::chrono::microseconds GetPercentile(std::vector<Clock::duration> &samples,
+		double percentile);
+
+	mutable std::mutex m_mutex;
+
+	int m_generation = 0;
+	uint64_t m_sequence = 0;
+	uint64_t m_nextTaskId = 0;
+
+	std::unordered_map<int, PendingTask> m_pendingTasks;
+	std::set<PriorityKey> m_taskOrder;
+	std::unordered_set<int> m_visibleItems;
+
+	// Every column that has been requested, but whose text hasn't yet been handed back to the UI
+	// thread, along with the time it was first requested. This is keyed by internal index, so that
+	// the requests for an item can be discarded without examining the requests for other items.
+	std::unordered_map<int, std::vector<OutstandingRequest>> m_outstandingRequests;
+
+	// When an item is invalidated, the results from any task created before that point are
+	// discarded. Results that have already been stored are filtered out when they're taken, rather
+	// than being searched for at the point the item is invalidated.
+	std::unordered_map<int, uint64_t> m_firstValidTaskIds;
+
+	// The settings are shared between tasks and only copied when they change.
+	std::shared_ptr<const GlobalFolderSettings> m_globalFolderSettings;
+
+	std::vector<CompletedTask> m_completedTasks;
+	bool m_notificationPending = false;
+
+	uint64_t m_requestsReceived = 0;
+	uint64_t m_duplicatesDropped = 0;
+	std::deque<Clock::duration> m_latencySamples;
+};
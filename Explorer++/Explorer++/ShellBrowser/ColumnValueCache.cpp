@@ -0,0 +1,383 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ColumnValueCache.h"
+#include <algorithm>
+#include <vector>
+
+ColumnValueCache::ColumnValueCache(const std::filesystem::path &filePath,
+	uint64_t maxSizeInBytes) :
+	m_filePath(filePath),
+	m_maxSizeInBytes(maxSizeInBytes)
+{
+	MapFile();
+}
+
+bool ColumnValueCache::IsColumnCacheable(ColumnType columnType)
+{
+	// Only columns whose text is copied directly from the file are included. The text for columns
+	// like the image width or media duration is formatted from a numeric value and would become
+	// stale if that formatting changed (e.g. following a change to the display language).
+	switch (columnType)
+	{
+	case ColumnType::ProductName:
+	case ColumnType::Company:
+	case ColumnType::Description:
+	case ColumnType::FileVersion:
+	case ColumnType::ProductVersion:
+	case ColumnType::CameraModel:
+	case ColumnType::DateTaken:
+	case ColumnType::MediaCopyright:
+	case ColumnType::MediaRating:
+	case ColumnType::MediaAlbumArtist:
+	case ColumnType::MediaAlbum:
+	case ColumnType::MediaBeatsPerMinute:
+	case ColumnType::MediaComposer:
+	case ColumnType::MediaConductor:
+	case ColumnType::MediaDirector:
+	case ColumnType::MediaGenre:
+	case ColumnType::MediaLanguage:
+	case ColumnType::MediaBroadcastDate:
+	case ColumnType::MediaChannel:
+	case ColumnType::MediaStationName:
+	case ColumnType::MediaMood:
+	case ColumnType::MediaParentalRating:
+	case ColumnType::MediaParentalRatingReason:
+	case ColumnType::MediaPeriod:
+	case ColumnType::MediaProducer:
+	case ColumnType::MediaPublisher:
+	case ColumnType::MediaWriter:
+	case ColumnType::MediaYear:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+ColumnValueCache::Key ColumnValueCache::BuildKey(const std::wstring &path,
+	const WIN32_FIND_DATA &findData, ColumnType columnType)
+{
+	// 64-bit FNV-1a.
+	uint64_t pathHash = 14695981039346656037ULL;
+
+	for (wchar_t c : path)
+	{
+		pathHash ^= static_cast<uint64_t>(c);
+		pathHash *= 1099511628211ULL;
+	}
+
+	uint64_t size = (static_cast<uint64_t>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+	uint64_t lastWriteTime = (static_cast<uint64_t>(findData.ftLastWriteTime.dwHighDateTime) << 32)
+		| findData.ftLastWriteTime.dwLowDateTime;
+
+	return { pathHash, size, lastWriteTime, columnType._to_integral() };
+}
+
+std::optional<std::wstring> ColumnValueCache::MaybeGetValue(const Key &key)
+{
+	std::scoped_lock lock(m_mutex);
+
+	auto itr = m_newEntries.find(key);
+
+	if (itr != m_newEntries.end())
+	{
+		itr->second.lastAccess = ++m_accessCounter;
+		return itr->second.text;
+	}
+
+	const auto *fileEntry = FindMappedEntry(key);
+
+	if (!fileEntry)
+	{
+		return std::nullopt;
+	}
+
+	auto index = static_cast<size_t>(fileEntry - m_mappedEntries.data());
+	m_mappedAccessTimes[index] = ++m_accessCounter;
+
+	auto text = m_mappedText.subspan(static_cast<size_t>(fileEntry->textOffset),
+		fileEntry->textLength);
+	return std::wstring(text.begin(), text.end());
+}
+
+void ColumnValueCache::SetValue(const Key &key, const std::wstring &value)
+{
+	std::scoped_lock lock(m_mutex);
+
+	m_newEntries.insert_or_assign(key, Entry{ value, ++m_accessCounter });
+}
+
+bool ColumnValueCache::Save()
+{
+	std::scoped_lock lock(m_mutex);
+
+	auto entries = GetAllEntries();
+
+	std::vector<std::map<Key, Entry>::iterator> entriesByAccess;
+	entriesByAccess.reserve(entries.size());
+
+	for (auto itr = entries.begin(); itr != entries.end(); ++itr)
+	{
+		entriesByAccess.push_back(itr);
+	}
+
+	std::sort(entriesByAccess.begin(), entriesByAccess.end(),
+		[](const auto &itr1, const auto &itr2)
+		{ return itr1->second.lastAccess > itr2->second.lastAccess; });
+
+	uint64_t totalSize = sizeof(FileHeader);
+	bool budgetExceeded = false;
+
+	for (auto itr : entriesByAccess)
+	{
+		uint64_t entrySize = GetEntrySize(itr->second.text.size());
+
+		if (!budgetExceeded && totalSize + entrySize <= m_maxSizeInBytes)
+		{
+			totalSize += entrySize;
+			continue;
+		}
+
+		// Once an entry doesn't fit, all less recently used entries are evicted as well, even if
+		// they're small enough to fit in the remaining space.
+		budgetExceeded = true;
+		entries.erase(itr);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_filePath.parent_path(), error);
+
+	if (error)
+	{
+		return false;
+	}
+
+	auto tempFilePath = m_filePath;
+	tempFilePath += L".tmp";
+
+	if (!WriteCacheFile(tempFilePath, entries))
+	{
+		return false;
+	}
+
+	// The existing file can't be replaced while it's mapped.
+	UnmapFile();
+
+	BOOL res = MoveFileEx(tempFilePath.c_str(), m_filePath.c_str(), MOVEFILE_REPLACE_EXISTING);
+
+	if (!res)
+	{
+		// This will happen if another instance of the application currently has the file mapped.
+		// The new entries are retained, so that a later call can save them, once the file is no
+		// longer in use.
+		LOG(WARNING) << "Column value cache file couldn't be replaced (error " << GetLastError()
+					 << ")";
+
+		DeleteFile(tempFilePath.c_str());
+		MapFile();
+		return false;
+	}
+
+	m_newEntries.clear();
+	m_mappedAccessTimes.clear();
+
+	MapFile();
+
+	return true;
+}
+
+ColumnValueCache::Key ColumnValueCache::GetFileEntryKey(const FileEntry &fileEntry)
+{
+	return { fileEntry.pathHash, fileEntry.size, fileEntry.lastWriteTime, fileEntry.columnType };
+}
+
+uint64_t ColumnValueCache::GetEntrySize(size_t textLength)
+{
+	return sizeof(FileEntry) + textLength * sizeof(wchar_t);
+}
+
+void ColumnValueCache::MapFile()
+{
+	m_file.reset(CreateFile(m_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+
+	if (!m_file)
+	{
+		return;
+	}
+
+	LARGE_INTEGER fileSize;
+	BOOL res = GetFileSizeEx(m_file.get(), &fileSize);
+
+	if (!res || static_cast<uint64_t>(fileSize.QuadPart) < sizeof(FileHeader))
+	{
+		UnmapFile();
+		return;
+	}
+
+	m_mapping.reset(CreateFileMapping(m_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+	if (!m_mapping)
+	{
+		UnmapFile();
+		return;
+	}
+
+	m_view.reset(static_cast<std::byte *>(MapViewOfFile(m_mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+
+	if (!m_view)
+	{
+		UnmapFile();
+		return;
+	}
+
+	auto fileSizeInBytes = static_cast<uint64_t>(fileSize.QuadPart);
+	const auto *header = reinterpret_cast<const FileHeader *>(m_view.get());
+
+	if (header->magic != FILE_MAGIC || header->version != FILE_VERSION
+		|| header->numEntries > (fileSizeInBytes - sizeof(FileHeader)) / sizeof(FileEntry))
+	{
+		UnmapFile();
+		return;
+	}
+
+	uint64_t textStart = sizeof(FileHeader) + header->numEntries * sizeof(FileEntry);
+
+	m_mappedEntries = { reinterpret_cast<const FileEntry *>(m_view.get() + sizeof(FileHeader)),
+		static_cast<size_t>(header->numEntries) };
+	m_mappedText = { reinterpret_cast<const wchar_t *>(m_view.get() + textStart),
+		static_cast<size_t>((fileSizeInBytes - textStart) / sizeof(wchar_t)) };
+
+	// The file may have been truncated or otherwise corrupted. Lookups rely on the entries being
+	// sorted and on each entry referring to text within the file, so if either of those isn't the
+	// case, the file is ignored (and will be replaced the next time the cache is saved).
+	if (!AreMappedEntriesValid())
+	{
+		LOG(WARNING) << "Column value cache file is invalid and will be discarded";
+		UnmapFile();
+		return;
+	}
+
+	m_accessCounter = std::max(m_accessCounter, header->accessCounter);
+}
+
+bool ColumnValueCache::AreMappedEntriesValid() const
+{
+	for (size_t i = 0; i < m_mappedEntries.size(); i++)
+	{
+		const auto &fileEntry = m_mappedEntries[i];
+
+		if (fileEntry.textOffset > m_mappedText.size()
+			|| fileEntry.textLength > m_mappedText.size() - fileEntry.textOffset)
+		{
+			return false;
+		}
+
+		// Keys are unique, so each key should be strictly greater than the previous one.
+		if (i > 0 && !(GetFileEntryKey(m_mappedEntries[i - 1]) < GetFileEntryKey(fileEntry)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ColumnValueCache::UnmapFile()
+{
+	m_mappedEntries = {};
+	m_mappedText = {};
+	m_view.reset();
+	m_mapping.reset();
+	m_file.reset();
+}
+
+const ColumnValueCache::FileEntry *ColumnValueCache::FindMappedEntry(const Key &key) const
+{
+	auto itr = std::lower_bound(m_mappedEntries.begin(), m_mappedEntries.end(), key,
+		[](const FileEntry &fileEntry, const Key &key)
+		{ return GetFileEntryKey(fileEntry) < key; });
+
+	if (itr == m_mappedEntries.end() || GetFileEntryKey(*itr) != key)
+	{
+		return nullptr;
+	}
+
+	return &*itr;
+}
+
+std::map<ColumnValueCache::Key, ColumnValueCache::Entry> ColumnValueCache::GetAllEntries() const
+{
+	std::map<Key, Entry> entries;
+
+	for (size_t i = 0; i < m_mappedEntries.size(); i++)
+	{
+		const auto &fileEntry = m_mappedEntries[i];
+		auto text = m_mappedText.subspan(static_cast<size_t>(fileEntry.textOffset),
+			fileEntry.textLength);
+		auto accessItr = m_mappedAccessTimes.find(i);
+		uint64_t lastAccess =
+			(accessItr != m_mappedAccessTimes.end()) ? accessItr->second : fileEntry.lastAccess;
+
+		entries.emplace(GetFileEntryKey(fileEntry),
+			Entry{ std::wstring(text.begin(), text.end()), lastAccess });
+	}
+
+	for (const auto &[key, entry] : m_newEntries)
+	{
+		entries.insert_or_assign(key, entry);
+	}
+
+	return entries;
+}
+
+bool ColumnValueCache::WriteCacheFile(const std::filesystem::path &filePath,
+	const std::map<Key, Entry> &entries) const
+{
+	std::vector<FileEntry> fileEntries;
+	fileEntries.reserve(entries.size());
+
+	std::wstring text;
+
+	for (const auto &[key, entry] : entries)
+	{
+		fileEntries.push_back({ key.pathHash, key.size, key.lastWriteTime, key.columnType,
+			static_cast<uint32_t>(entry.text.size()), text.size(), entry.lastAccess });
+		text += entry.text;
+	}
+
+	FileHeader header = { FILE_MAGIC, FILE_VERSION, fileEntries.size(), m_accessCounter };
+
+	std::vector<std::byte> data(sizeof(header) + fileEntries.size() * sizeof(FileEntry)
+		+ text.size() * sizeof(wchar_t));
+	auto *current = data.data();
+	current = std::copy_n(reinterpret_cast<const std::byte *>(&header), sizeof(header), current);
+	current = std::copy_n(reinterpret_cast<const std::byte *>(fileEntries.data()),
+		fileEntries.size() * sizeof(FileEntry), current);
+	std::copy_n(reinterpret_cast<const std::byte *>(text.data()), text.size() * sizeof(wchar_t),
+		current);
+
+	wil::unique_hfile file(CreateFile(filePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, nullptr));
+
+	if (!file)
+	{
+		return false;
+	}
+
+	DWORD numBytesWritten;
+	BOOL res = WriteFile(file.get(), data.data(), static_cast<DWORD>(data.size()),
+		&numBytesWritten, nullptr);
+
+	if (!res || numBytesWritten != data.size())
+	{
+		file.reset();
+		DeleteFile(filePath.c_str());
+		return false;
+	}
+
+	return true;
+}
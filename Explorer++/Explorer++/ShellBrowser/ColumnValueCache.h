@@ -0,0 +1,127 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "Columns.h"
+#include <boost/core/noncopyable.hpp>
+#include <wil/resource.h>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+// A persistent cache of the text for columns that are expensive to retrieve (e.g. columns that
+// require a file to be opened and parsed). Entries are keyed on the file's path, size and last
+// write time, so any modification to a file will result in a cache miss. Stale entries are never
+// looked up again and are eventually evicted, since the cache is bounded by a size budget and the
+// least recently used entries are removed first when it's saved.
+//
+// The cache file is memory-mapped when the cache is created and lookups are performed directly
+// against the mapped entries, so the text doesn't need to be read up front. The entries are
+// validated when the file is mapped and the whole file is ignored if it's corrupt. Entries added
+// during the session are held in memory until Save() is called.
+//
+// This class is thread-safe.
+class ColumnValueCache : private boost::noncopyable
+{
+public:
+	struct Key
+	{
+		uint64_t pathHash;
+		uint64_t size;
+		uint64_t lastWriteTime;
+		uint32_t columnType;
+
+		auto operator<=>(const Key &) const = default;
+	};
+
+	ColumnValueCache(const std::filesystem::path &filePath, uint64_t maxSizeInBytes);
+
+	// Only columns whose text is read directly from the contents of the file can be cached. That
+	// excludes columns whose text is formatted (e.g. according to the user's settings or the
+	// display language), as well as columns like the owner, which can change without the last
+	// write time being updated.
+	static bool IsColumnCacheable(ColumnType columnType);
+	static Key BuildKey(const std::wstring &path, const WIN32_FIND_DATA &findData,
+		ColumnType columnType);
+
+	std::optional<std::wstring> MaybeGetValue(const Key &key);
+	void SetValue(const Key &key, const std::wstring &value);
+
+	// Writes the cache to disk, evicting the least recently used entries if the cache is larger
+	// than the size budget. Returns false if the cache couldn't be written, which will be the case
+	// if another instance of the application has the file mapped. The new entries are retained in
+	// that case.
+	bool Save();
+
+private:
+	static constexpr uint32_t FILE_MAGIC = 0x43564345;
+	static constexpr uint32_t FILE_VERSION = 1;
+
+	// The file consists of a header, followed by an array of entries (sorted by key) and then the
+	// text for each of the entries.
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t numEntries;
+		uint64_t accessCounter;
+	};
+
+	struct FileEntry
+	{
+		uint64_t pathHash;
+		uint64_t size;
+		uint64_t lastWriteTime;
+		uint32_t columnType;
+		uint32_t textLength;
+		uint64_t textOffset;
+		uint64_t lastAccess;
+	};
+
+	static_assert(sizeof(FileHeader) == 24);
+	static_assert(sizeof(FileEntry) == 48);
+
+	struct Entry
+	{
+		std::wstring text;
+		uint64_t lastAccess;
+	};
+
+	static Key GetFileEntryKey(const FileEntry &fileEntry);
+	static uint64_t GetEntrySize(size_t textLength);
+
+	void MapFile();
+	bool AreMappedEntriesValid() const;
+	void UnmapFile();
+	const FileEntry *FindMappedEntry(const Key &key) const;
+	std::map<Key, Entry> GetAllEntries() const;
+	bool WriteCacheFile(const std::filesystem::path &filePath,
+		const std::map<Key, Entry> &entries) const;
+
+	const std::filesystem::path m_filePath;
+	const uint64_t m_maxSizeInBytes;
+
+	mutable std::mutex m_mutex;
+
+	wil::unique_hfile m_file;
+	wil::unique_handle m_mapping;
+	wil::unique_mapview_ptr<std::byte> m_view;
+	std::span<const FileEntry> m_mappedEntries;
+	std::span<const wchar_t> m_mappedText;
+
+	// The mapped file is read-only, so the access times for mapped entries that are used during the
+	// session are tracked separately (indexed by the position of the entry in the file).
+	std::unordered_map<size_t, uint64_t> m_mappedAccessTimes;
+
+	std::map<Key, Entry> m_newEntries;
+
+	// A logical clock that's incremented on each access and persisted along with the cache.
+	uint64_t m_accessCounter = 0;
+};
@@ -0,0 +1,185 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "DirectoryChangeCollapser.h"
+
+void DirectoryChangeCollapser::ItemAdded(const std::wstring &name)
+{
+	m_numEvents++;
+
+	auto itr = m_pendingChanges.find(name);
+
+	if (itr == m_pendingChanges.end())
+	{
+		AppendChange({ DirectoryChange::Type::Added, name });
+		return;
+	}
+
+	auto &change = *m_changes[itr->second];
+
+	// If the item was removed, it's now been replaced. Otherwise, the item is already known to
+	// exist and the pending change will result in its current details being retrieved anyway.
+	if (change.type == DirectoryChange::Type::Removed)
+	{
+		change.type = DirectoryChange::Type::Modified;
+	}
+}
+
+void DirectoryChangeCollapser::ItemRemoved(const std::wstring &name)
+{
+	m_numEvents++;
+
+	RemoveItem(name);
+}
+
+void DirectoryChangeCollapser::ItemModified(const std::wstring &name)
+{
+	m_numEvents++;
+
+	// Additions, modifications and renames all result in the current details for the item being
+	// retrieved, so if there's already a pending change, the modification can be dropped. A
+	// modification to an item that's been removed isn't meaningful and is also dropped.
+	if (!m_pendingChanges.contains(name))
+	{
+		AppendChange({ DirectoryChange::Type::Modified, name });
+	}
+}
+
+void DirectoryChangeCollapser::ItemRenamed(const std::wstring &oldName,
+	const std::wstring &newName)
+{
+	m_numEvents++;
+
+	if (auto newItr = m_pendingChanges.find(newName); newItr != m_pendingChanges.end())
+	{
+		// The item has been moved over the top of an item that has a pending change (e.g. a file
+		// that was saved by writing a temporary file, deleting the original, then renaming the
+		// temporary file). In that case, the item with the old name is gone and the item with the
+		// new name has been replaced.
+		size_t newIndex = newItr->second;
+
+		RemoveItem(oldName);
+
+		auto &change = *m_changes[newIndex];
+
+		if (change.type == DirectoryChange::Type::Removed)
+		{
+			change.type = DirectoryChange::Type::Modified;
+		}
+
+		return;
+	}
+
+	auto oldItr = m_pendingChanges.find(oldName);
+
+	if (oldItr == m_pendingChanges.end())
+	{
+		AppendChange({ DirectoryChange::Type::Renamed, newName, oldName });
+		return;
+	}
+
+	size_t index = oldItr->second;
+	auto &change = *m_changes[index];
+
+	switch (change.type)
+	{
+	case DirectoryChange::Type::Added:
+		change.name = newName;
+		break;
+
+	case DirectoryChange::Type::Modified:
+		change = { DirectoryChange::Type::Renamed, newName, oldName };
+		break;
+
+	case DirectoryChange::Type::Renamed:
+		if (change.oldName == newName)
+		{
+			// The item has been renamed back to its original name.
+			change = { DirectoryChange::Type::Modified, newName };
+		}
+		else
+		{
+			change.name = newName;
+		}
+		break;
+
+	case DirectoryChange::Type::Removed:
+		// The item being renamed no longer exists, so from the point of view of the directory,
+		// the item with the new name is entirely new.
+		AppendChange({ DirectoryChange::Type::Added, newName });
+		return;
+	}
+
+	m_pendingChanges.erase(oldName);
+	m_pendingChanges.emplace(newName, index);
+}
+
+void DirectoryChangeCollapser::RemoveItem(const std::wstring &name)
+{
+	auto itr = m_pendingChanges.find(name);
+
+	if (itr == m_pendingChanges.end())
+	{
+		AppendChange({ DirectoryChange::Type::Removed, name });
+		return;
+	}
+
+	size_t index = itr->second;
+	auto &change = *m_changes[index];
+
+	switch (change.type)
+	{
+	case DirectoryChange::Type::Added:
+		m_changes[index].reset();
+		m_pendingChanges.erase(itr);
+		break;
+
+	case DirectoryChange::Type::Modified:
+		change.type = DirectoryChange::Type::Removed;
+		break;
+
+	case DirectoryChange::Type::Removed:
+		break;
+
+	case DirectoryChange::Type::Renamed:
+	{
+		// It's the item with the original name that needs to be removed.
+		auto originalName = change.oldName;
+		change = { DirectoryChange::Type::Removed, originalName };
+		m_pendingChanges.erase(itr);
+
+		// If there's already a pending change for an item with the original name, that change
+		// will occur after this one, so the two changes can be applied independently.
+		m_pendingChanges.try_emplace(originalName, index);
+	}
+	break;
+	}
+}
+
+void DirectoryChangeCollapser::AppendChange(DirectoryChange change)
+{
+	m_pendingChanges.insert_or_assign(change.name, m_changes.size());
+	m_changes.push_back(std::move(change));
+}
+
+std::vector<DirectoryChange> DirectoryChangeCollapser::GetChanges() const
+{
+	std::vector<DirectoryChange> changes;
+
+	for (const auto &change : m_changes)
+	{
+		if (change)
+		{
+			changes.push_back(*change);
+		}
+	}
+
+	return changes;
+}
+
+int DirectoryChangeCollapser::GetNumEvents() const
+{
+	return m_numEvents;
+}
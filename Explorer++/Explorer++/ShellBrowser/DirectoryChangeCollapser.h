@@ -0,0 +1,67 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct DirectoryChange
+{
+	enum class Type
+	{
+		Added,
+		Removed,
+		Modified,
+		Renamed
+	};
+
+	Type type;
+	std::wstring name;
+
+	// Only set for renames.
+	std::wstring oldName;
+
+	bool operator==(const DirectoryChange &) const = default;
+};
+
+// Takes the raw sequence of change notifications received for a directory and reduces it to the
+// net set of changes that need to be applied. For example, if an item is added and then removed,
+// no change is generated at all, while repeated modifications to an item result in a single
+// modification.
+//
+// Subsequent changes to an item are always merged into the item's pending change. That means that
+// once an item has been added, no later change will refer to it, so additions can safely be
+// applied after all other changes. The relative order of changes to different items is preserved.
+//
+// Names are compared exactly, which is the conservative choice: if two names only differ by case,
+// the changes to them will be left as-is, rather than being merged.
+class DirectoryChangeCollapser
+{
+public:
+	void ItemAdded(const std::wstring &name);
+	void ItemRemoved(const std::wstring &name);
+	void ItemModified(const std::wstring &name);
+	void ItemRenamed(const std::wstring &oldName, const std::wstring &newName);
+
+	std::vector<DirectoryChange> GetChanges() const;
+
+	// Returns the total number of raw notifications that have been processed.
+	int GetNumEvents() const;
+
+private:
+	void RemoveItem(const std::wstring &name);
+	void AppendChange(DirectoryChange change);
+
+	// Entries are reset, rather than erased, when changes cancel out, so that the indexes stored
+	// in m_pendingChanges remain valid.
+	std::vector<std::optional<DirectoryChange>> m_changes;
+
+	// Maps the current name of each item that has a pending change to the index of that change.
+	std::unordered_map<std::wstring, size_t> m_pendingChanges;
+
+	int m_numEvents = 0;
+};
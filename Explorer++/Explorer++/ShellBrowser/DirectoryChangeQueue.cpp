@@ -0,0 +1,126 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "DirectoryChangeQueue.h"
+
+DirectoryChangeQueue::DirectoryChangeQueue(size_t maxChanges, size_t maxNameCharacters) :
+	m_maxChanges(RoundUpToPowerOfTwo(maxChanges)),
+	m_maxNameCharacters(RoundUpToPowerOfTwo(maxNameCharacters)),
+	m_slots(std::make_unique<Slot[]>(m_maxChanges)),
+	m_names(std::make_unique<wchar_t[]>(m_maxNameCharacters))
+{
+}
+
+bool DirectoryChangeQueue::Push(DWORD action, std::wstring_view name, int folderId)
+{
+	if (name.size() > m_maxNameCharacters)
+	{
+		m_overflowed.store(true, std::memory_order_release);
+		return false;
+	}
+
+	auto nameLength = static_cast<uint32_t>(name.size());
+	uint64_t head = m_head.load(std::memory_order_relaxed);
+	uint32_t record;
+	uint32_t nameOffset;
+
+	do
+	{
+		// Acquiring the tail ensures that the consumer has finished reading any record (and name)
+		// that's about to be overwritten.
+		uint64_t tail = m_tail.load(std::memory_order_acquire);
+
+		record = GetRecords(head);
+		nameOffset = GetCharacters(head);
+
+		if (record - GetRecords(tail) >= m_maxChanges
+			|| nameOffset + nameLength - GetCharacters(tail) > m_maxNameCharacters)
+		{
+			m_overflowed.store(true, std::memory_order_release);
+			return false;
+		}
+	} while (!m_head.compare_exchange_weak(head, PackPosition(record + 1, nameOffset + nameLength),
+		std::memory_order_relaxed));
+
+	for (uint32_t i = 0; i < nameLength; i++)
+	{
+		m_names[(nameOffset + i) & (m_maxNameCharacters - 1)] = name[i];
+	}
+
+	auto &slot = m_slots[record & (m_maxChanges - 1)];
+	slot.action = action;
+	slot.folderId = folderId;
+	slot.nameOffset = nameOffset;
+	slot.nameLength = nameLength;
+	slot.sequence.store(record + 1, std::memory_order_release);
+
+	return true;
+}
+
+DirectoryChangeQueue::DrainResult DirectoryChangeQueue::Drain()
+{
+	DrainResult result;
+
+	// The flag is checked before the records are read, so that if a change is dropped while the
+	// queue is being drained, the flag will still be set the next time the queue is drained.
+	result.overflowed = m_overflowed.exchange(false, std::memory_order_acquire);
+
+	uint64_t tail = m_tail.load(std::memory_order_relaxed);
+	uint32_t record = GetRecords(tail);
+	uint32_t nameEnd = GetCharacters(tail);
+
+	while (true)
+	{
+		const auto &slot = m_slots[record & (m_maxChanges - 1)];
+
+		if (slot.sequence.load(std::memory_order_acquire) != record + 1)
+		{
+			break;
+		}
+
+		std::wstring name(slot.nameLength, '\0');
+
+		for (uint32_t i = 0; i < slot.nameLength; i++)
+		{
+			name[i] = m_names[(slot.nameOffset + i) & (m_maxNameCharacters - 1)];
+		}
+
+		result.changes.push_back({ slot.action, slot.folderId, std::move(name) });
+
+		nameEnd = slot.nameOffset + slot.nameLength;
+		record++;
+	}
+
+	m_tail.store(PackPosition(record, nameEnd), std::memory_order_release);
+
+	return result;
+}
+
+uint64_t DirectoryChangeQueue::PackPosition(uint32_t records, uint32_t characters)
+{
+	return (static_cast<uint64_t>(records) << 32) | characters;
+}
+
+uint32_t DirectoryChangeQueue::GetRecords(uint64_t position)
+{
+	return static_cast<uint32_t>(position >> 32);
+}
+
+uint32_t DirectoryChangeQueue::GetCharacters(uint64_t position)
+{
+	return static_cast<uint32_t>(position);
+}
+
+size_t DirectoryChangeQueue::RoundUpToPowerOfTwo(size_t value)
+{
+	size_t result = 1;
+
+	while (result < value)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
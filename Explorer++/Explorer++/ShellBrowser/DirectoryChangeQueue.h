@@ -0,0 +1,84 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <boost/core/noncopyable.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A bounded, lock-free queue of directory change notifications. Any number of threads can push
+// changes, while a single thread (the UI thread, in practice) drains them.
+//
+// Each change is stored as a small fixed-size record, with the names packed into a shared character
+// buffer, rather than each record reserving space for a full path. Pushing a change never blocks
+// and never allocates. If the queue is full, the change is dropped and the queue is marked as
+// having overflowed, at which point the consumer can no longer trust the set of changes it receives
+// and should rescan the directory instead.
+class DirectoryChangeQueue : private boost::noncopyable
+{
+public:
+	struct Change
+	{
+		DWORD action;
+		int folderId;
+		std::wstring name;
+	};
+
+	struct DrainResult
+	{
+		std::vector<Change> changes;
+
+		// Set if one or more changes were dropped since the last time the queue was drained.
+		bool overflowed = false;
+	};
+
+	// Both capacities are rounded up to a power of two.
+	DirectoryChangeQueue(size_t maxChanges, size_t maxNameCharacters);
+
+	// Can be called from any thread. Returns false if there wasn't enough space to store the
+	// change.
+	bool Push(DWORD action, std::wstring_view name, int folderId);
+
+	// Should only be called from the consumer thread. Changes are returned in the order in which
+	// space for them was reserved. A change that's still in the process of being written (and any
+	// change after it) will be left in the queue and returned by a subsequent call.
+	DrainResult Drain();
+
+private:
+	struct Slot
+	{
+		// Set to the position of the record, plus one, once the record has been written.
+		std::atomic<uint32_t> sequence = 0;
+
+		DWORD action;
+		int folderId;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+	};
+
+	// The number of records and the number of name characters written are combined into a single
+	// value, so that space for both can be reserved in a single atomic operation. That also means
+	// that names are stored in the same order as the records that reference them, so the name
+	// space can be released in order as records are consumed. Both counters are free-running and
+	// wrap around.
+	static uint64_t PackPosition(uint32_t records, uint32_t characters);
+	static uint32_t GetRecords(uint64_t position);
+	static uint32_t GetCharacters(uint64_t position);
+
+	static size_t RoundUpToPowerOfTwo(size_t value);
+
+	const size_t m_maxChanges;
+	const size_t m_maxNameCharacters;
+	const std::unique_ptr<Slot[]> m_slots;
+	const std::unique_ptr<wchar_t[]> m_names;
+
+	std::atomic<uint64_t> m_head = 0;
+	std::atomic<uint64_t> m_tail = 0;
+	std::atomic<bool> m_overflowed = false;
+};
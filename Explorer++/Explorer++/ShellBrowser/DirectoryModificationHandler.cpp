@@ -13,7 +13,6 @@
 #include "ViewModes.h"
 #include "../Helper/ListViewHelper.h"
 #include "../Helper/ShellHelper.h"
-#include <list>
 
 void ShellBrowserImpl::StartDirectoryMonitoring(PCIDLIST_ABSOLUTE pidl)
 {
@@ -52,19 +51,37 @@ void ShellBrowserImpl::StartDirectoryMonitoring(PCIDLIST_ABSOLUTE pidl)
 void ShellBrowserImpl::ProcessShellChangeNotifications(
 	const std::vector<ShellChangeNotification> &shellChangeNotifications)
 {
+	auto &itemRetrieval = m_directoryState.itemRetrieval;
+
+	if (itemRetrieval.inProgress)
+	{
+		for (const auto &change : shellChangeNotifications)
+		{
+			itemRetrieval.deferredShellChanges.emplace_back(change.event, change.pidl1.get(),
+				change.pidl2.get());
+		}
+
+		return;
+	}
+
 	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
 
+	PendingItemChanges pendingChanges;
+
 	for (const auto &change : shellChangeNotifications)
 	{
-		ProcessShellChangeNotification(change);
+		ProcessShellChangeNotification(change, pendingChanges);
 	}
 
+	ApplyPendingItemChanges(pendingChanges);
+
 	SendMessage(m_hListView, WM_SETREDRAW, TRUE, NULL);
 
 	directoryContentsChanged.m_signal();
 }
 
-void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotification &change)
+void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotification &change,
+	PendingItemChanges &pendingChanges)
 {
 	switch (change.event)
 	{
@@ -73,7 +90,7 @@ void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotificat
 	case SHCNE_CREATE:
 		if (ILIsParent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get(), TRUE))
 		{
-			OnItemAdded(change.pidl1.get());
+			OnItemAdded(change.pidl1.get(), pendingChanges);
 		}
 		break;
 
@@ -82,7 +99,7 @@ void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotificat
 		if (ILIsParent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get(), TRUE)
 			&& ILIsParent(m_directoryState.pidlDirectory.Raw(), change.pidl2.get(), TRUE))
 		{
-			OnItemRenamed(change.pidl1.get(), change.pidl2.get());
+			OnItemRenamed(change.pidl1.get(), change.pidl2.get(), pendingChanges);
 		}
 		else if (ArePidlsEquivalent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get()))
 		{
@@ -94,7 +111,7 @@ void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotificat
 	case SHCNE_UPDATEITEM:
 		if (ILIsParent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get(), TRUE))
 		{
-			OnItemModified(change.pidl1.get());
+			OnItemModified(change.pidl1.get(), pendingChanges);
 		}
 		else if (ArePidlsEquivalent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get()))
 		{
@@ -138,7 +155,7 @@ void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotificat
 		// item is actually a child of the current directory.
 		if (ILIsParent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get(), TRUE))
 		{
-			OnItemRemoved(change.pidl1.get());
+			OnItemRemoved(change.pidl1.get(), pendingChanges);
 		}
 		else if (ArePidlsEquivalent(m_directoryState.pidlDirectory.Raw(), change.pidl1.get())
 			|| ILIsParent(change.pidl1.get(), m_directoryState.pidlDirectory.Raw(), false))
@@ -156,75 +173,233 @@ void ShellBrowserImpl::ProcessShellChangeNotification(const ShellChangeNotificat
 
 void ShellBrowserImpl::DirectoryAltered()
 {
-	EnterCriticalSection(&m_csDirectoryAltered);
+	// Any changes queued from this point on will need to be handled by another timer callback.
+	// The flag is reset before the queue is drained, so that a change can't be queued in between
+	// without a timer being set.
+	m_directoryChangesTimerPending = false;
 
-	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
-
-	// Note that directory change notifications are received asynchronously. That means that, in
-	// each of the cases below, it's not reasonable to assume that the file being referenced
-	// actually exists (since it may have been renamed or deleted since the original notification
-	// was sent).
-	for (const auto &af : m_AlteredList)
+	// The changes are left in the queue until the items in the folder have been retrieved. They'll
+	// be applied at that point.
+	if (m_directoryState.itemRetrieval.inProgress)
 	{
-		// Only undertake the modification if the unique folder index on the modified item and
-		// current folder match up (i.e. ensure the directory has not changed since these files were
-		// modified).
-		if (af.iFolderIndex != m_uniqueFolderId)
-		{
-			continue;
-		}
+		m_directoryState.itemRetrieval.directoryChangesDeferred = true;
+		return;
+	}
 
-		wil::com_ptr_nothrow<IShellFolder> parent;
-		HRESULT hr = SHBindToObject(nullptr, m_directoryState.pidlDirectory.Raw(), nullptr,
-			IID_PPV_ARGS(&parent));
+	auto [queuedChanges, overflowed] = m_directoryChangeQueue.Drain();
 
-		if (FAILED(hr))
-		{
-			continue;
-		}
+	if (overflowed)
+	{
+		// Some changes were dropped, so the only way to bring the listview back in sync with the
+		// directory is to refresh it.
+		LOG(INFO) << "Directory change queue overflowed, refreshing";
+
+		m_renamedItemOldName.reset();
+		RefreshDirectoryAfterUpdate(m_weakPtrFactory.GetWeakPtr(), m_app->GetRuntime(),
+			m_directoryState.scopedStopSource->GetToken());
+		return;
+	}
 
-		PidlAbsolute simplePidl;
-		hr = CreateSimplePidl(af.szFileName, simplePidl, parent.get());
+	DirectoryChangeCollapser collapser;
 
-		if (FAILED(hr))
+	for (const auto &queuedChange : queuedChanges)
+	{
+		// Only undertake the modification if the unique folder index on the modified item and
+		// current folder match up (i.e. ensure the directory has not changed since these files were
+		// modified).
+		if (queuedChange.folderId != m_uniqueFolderId)
 		{
 			continue;
 		}
 
-		switch (af.dwAction)
+		switch (queuedChange.action)
 		{
 		case FILE_ACTION_ADDED:
-			OnItemAdded(simplePidl.Raw());
+			collapser.ItemAdded(queuedChange.name);
 			break;
 
 		case FILE_ACTION_RENAMED_OLD_NAME:
-			assert(!m_renamedItemOldPidl);
-			m_renamedItemOldPidl.reset(ILCloneFull(simplePidl.Raw()));
+			assert(!m_renamedItemOldName);
+			m_renamedItemOldName = queuedChange.name;
 			break;
 
 		case FILE_ACTION_RENAMED_NEW_NAME:
-			OnItemRenamed(m_renamedItemOldPidl.get(), simplePidl.Raw());
-
-			m_renamedItemOldPidl.reset();
+			// The old name should always be sent first. The notification for the old name may
+			// have been processed as part of the previous batch, however, which is why the name
+			// is stored in a member variable.
+			if (m_renamedItemOldName)
+			{
+				collapser.ItemRenamed(*m_renamedItemOldName, queuedChange.name);
+				m_renamedItemOldName.reset();
+			}
+			else
+			{
+				assert(false);
+				collapser.ItemAdded(queuedChange.name);
+			}
 			break;
 
 		case FILE_ACTION_MODIFIED:
-			OnItemModified(simplePidl.Raw());
+			collapser.ItemModified(queuedChange.name);
 			break;
 
 		case FILE_ACTION_REMOVED:
-			OnItemRemoved(simplePidl.Raw());
+			collapser.ItemRemoved(queuedChange.name);
 			break;
 		}
 	}
 
+	auto changes = collapser.GetChanges();
+
+	if (changes.empty())
+	{
+		return;
+	}
+
+	LOG(INFO) << "Directory changes: " << collapser.GetNumEvents() << " notifications collapsed to "
+			  << changes.size() << " changes";
+
+	wil::com_ptr_nothrow<IShellFolder> parent;
+	HRESULT hr = SHBindToObject(nullptr, m_directoryState.pidlDirectory.Raw(), nullptr,
+		IID_PPV_ARGS(&parent));
+
+	if (FAILED(hr))
+	{
+		return;
+	}
+
+	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
+
+	PendingItemChanges pendingChanges;
+
+	for (const auto &change : changes)
+	{
+		ApplyDirectoryChange(parent.get(), change, pendingChanges);
+	}
+
+	ApplyPendingItemChanges(pendingChanges);
+
 	SendMessage(m_hListView, WM_SETREDRAW, TRUE, NULL);
 
 	directoryContentsChanged.m_signal();
+}
+
+// Note that directory change notifications are received asynchronously. That means that, in each
+// of the cases below, it's not reasonable to assume that the file being referenced actually exists
+// (since it may have been renamed or deleted since the original notification was sent).
+void ShellBrowserImpl::ApplyDirectoryChange(IShellFolder *parent, const DirectoryChange &change,
+	PendingItemChanges &pendingChanges)
+{
+	PidlAbsolute simplePidl;
+	HRESULT hr = CreateSimplePidl(change.name, simplePidl, parent);
+
+	if (FAILED(hr))
+	{
+		return;
+	}
+
+	switch (change.type)
+	{
+	case DirectoryChange::Type::Added:
+		OnItemAdded(simplePidl.Raw(), pendingChanges);
+		break;
+
+	case DirectoryChange::Type::Removed:
+		OnItemRemoved(simplePidl.Raw(), pendingChanges);
+		break;
+
+	case DirectoryChange::Type::Modified:
+		OnItemModified(simplePidl.Raw(), pendingChanges);
+		break;
 
-	m_AlteredList.clear();
+	case DirectoryChange::Type::Renamed:
+	{
+		PidlAbsolute oldSimplePidl;
+		hr = CreateSimplePidl(change.oldName, oldSimplePidl, parent);
 
-	LeaveCriticalSection(&m_csDirectoryAltered);
+		if (SUCCEEDED(hr))
+		{
+			OnItemRenamed(oldSimplePidl.Raw(), simplePidl.Raw(), pendingChanges);
+		}
+	}
+	break;
+	}
+}
+
+void ShellBrowserImpl::ApplyPendingItemChanges(const PendingItemChanges &pendingChanges)
+{
+	if (!pendingChanges.updatedItems.empty())
+	{
+		if (m_folderSettings.showInGroups)
+		{
+			for (int internalIndex : pendingChanges.updatedItems)
+			{
+				// The item may have been removed or filtered after it was updated.
+				auto itemIndex = LocateItemByInternalIndex(internalIndex);
+
+				if (itemIndex)
+				{
+					InsertItemIntoGroup(*itemIndex, DetermineItemGroup(internalIndex));
+				}
+			}
+		}
+
+		if (m_virtualListView)
+		{
+			SortVirtualListView(
+				std::bind_front(&ShellBrowserImpl::CompareVirtualListViewItems, this));
+		}
+		else
+		{
+			ListView_SortItems(m_hListView, SortStub, this);
+		}
+	}
+
+	std::vector<int> itemsToInsertSorted;
+
+	for (int internalIndex : pendingChanges.unfilteredItems)
+	{
+		// If an item was updated more than once, it may appear multiple times.
+		if (m_directoryState.filteredItemsList.erase(internalIndex) == 1)
+		{
+			itemsToInsertSorted.push_back(internalIndex);
+		}
+	}
+
+	bool unfilteredItems = !itemsToInsertSorted.empty();
+
+	if (m_config->globalFolderSettings.insertSorted)
+	{
+		itemsToInsertSorted.insert(itemsToInsertSorted.end(), pendingChanges.addedItems.begin(),
+			pendingChanges.addedItems.end());
+	}
+
+	ExcludeFilteredItems(itemsToInsertSorted);
+
+	// The sorted positions are determined relative to the items currently in the listview, so
+	// these items need to be queued before any items that are simply appended.
+	if (!itemsToInsertSorted.empty())
+	{
+		QueueItemsForSortedInsertion(std::move(itemsToInsertSorted));
+	}
+
+	if (!m_config->globalFolderSettings.insertSorted)
+	{
+		for (int internalIndex : pendingChanges.addedItems)
+		{
+			QueueItemForInsertion(internalIndex, -1, FALSE);
+		}
+	}
+
+	if (!m_directoryState.awaitingAddList.empty())
+	{
+		InsertAwaitingItems();
+	}
+
+	if (unfilteredItems)
+	{
+		SendMessage(m_hOwner, WM_USER_UPDATEWINDOWS, 0, 0);
+	}
 }
 
 void CALLBACK TimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
@@ -237,36 +412,35 @@ void CALLBACK TimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
 	SendMessage(hwnd, WM_USER_FILESADDED, idEvent, 0);
 }
 
+// Called on the directory monitoring thread.
 void ShellBrowserImpl::FilesModified(DWORD Action, const TCHAR *FileName, int EventId,
 	int iFolderIndex)
 {
-	EnterCriticalSection(&m_csDirectoryAltered);
-
-	SetTimer(m_hOwner, EventId, 200, TimerProc);
-
-	AlteredFile_t af;
+	// If the queue is full, the change will be dropped. The queue will be marked as having
+	// overflowed, however, and the directory will be refreshed once the timer fires.
+	m_directoryChangeQueue.Push(Action, FileName, iFolderIndex);
 
-	StringCchCopy(af.szFileName, std::size(af.szFileName), FileName);
-	af.dwAction = Action;
-	af.iFolderIndex = iFolderIndex;
-
-	m_AlteredList.push_back(af);
-
-	LeaveCriticalSection(&m_csDirectoryAltered);
+	// Only the first change in a batch starts the timer. The timer isn't restarted for subsequent
+	// changes, so that changes are still applied regularly while a directory is being continuously
+	// modified.
+	if (!m_directoryChangesTimerPending.exchange(true))
+	{
+		SetTimer(m_hOwner, EventId, DIRECTORY_CHANGES_INTERVAL, TimerProc);
+	}
 }
 
-void ShellBrowserImpl::OnItemAdded(PCIDLIST_ABSOLUTE simplePidl)
+void ShellBrowserImpl::OnItemAdded(PCIDLIST_ABSOLUTE simplePidl,
+	PendingItemChanges &pendingChanges)
 {
 	auto existingItemInternalIndex = GetItemInternalIndexForPidl(simplePidl);
 
-	// When adding an item, it makes no sense to add it if it already exists. If the item does
-	// exist, it's an indication of a programming error. That is, it's not expected that this would
-	// happen at all during normal use.
-	// Silently returning here is about the only thing that can be reasonably done and at least
-	// prevents duplicate items from being added.
+	// Directory monitoring starts before the items in the folder are retrieved, so if an item is
+	// created while that's happening, it can be both retrieved and reported as added. In that
+	// case, the existing item is simply updated, which also prevents duplicate items from being
+	// added.
 	if (existingItemInternalIndex)
 	{
-		assert(false);
+		OnItemModified(simplePidl, pendingChanges);
 		return;
 	}
 
@@ -291,10 +465,10 @@ void ShellBrowserImpl::OnItemAdded(PCIDLIST_ABSOLUTE simplePidl)
 		pidl = simplePidl;
 	}
 
-	AddItem(pidl);
+	AddItem(pidl, pendingChanges);
 }
 
-void ShellBrowserImpl::AddItem(PCIDLIST_ABSOLUTE pidl)
+void ShellBrowserImpl::AddItem(PCIDLIST_ABSOLUTE pidl, PendingItemChanges &pendingChanges)
 {
 	wil::com_ptr_nothrow<IShellFolder> shellFolder;
 	PCITEMID_CHILD pidlChild = nullptr;
@@ -305,47 +479,42 @@ void ShellBrowserImpl::AddItem(PCIDLIST_ABSOLUTE pidl)
 		return;
 	}
 
-	auto itemId = AddItemInternal(shellFolder.get(), m_directoryState.pidlDirectory.Raw(),
-		pidlChild, -1, FALSE);
+	auto itemInfo =
+		GetItemInformation(shellFolder.get(), m_directoryState.pidlDirectory.Raw(), pidlChild);
 
-	if (!itemId)
+	if (!itemInfo)
 	{
 		return;
 	}
 
-	if (m_config->globalFolderSettings.insertSorted)
-	{
-		// TODO: It would be better to pass the items details to this function directly
-		// instead (before the item is added to the awaiting list).
-		int sortedPosition = DetermineItemSortedPosition(*itemId);
-
-		auto itr = std::find_if(m_directoryState.awaitingAddList.begin(),
-			m_directoryState.awaitingAddList.end(), [itemId](const AwaitingAdd_t &awaitingItem)
-			{ return *itemId == awaitingItem.iItemInternal; });
-
-		// The item was added successfully above, so should be in the list of awaiting
-		// items.
-		CHECK(itr != m_directoryState.awaitingAddList.end());
-
-		itr->iItem = sortedPosition;
-		itr->bPosition = TRUE;
-		itr->iAfter = sortedPosition - 1;
-	}
-
-	InsertAwaitingItems();
+	// The item will be inserted into the listview (in its sorted position, if necessary) once all
+	// the other changes have been processed.
+	pendingChanges.addedItems.push_back(RegisterItem(std::move(*itemInfo)));
 }
 
-void ShellBrowserImpl::OnItemRemoved(PCIDLIST_ABSOLUTE simplePidl)
+void ShellBrowserImpl::OnItemRemoved(PCIDLIST_ABSOLUTE simplePidl,
+	PendingItemChanges &pendingChanges)
 {
 	auto internalIndex = GetItemInternalIndexForPidl(simplePidl);
 
-	if (internalIndex)
+	if (!internalIndex)
+	{
+		return;
+	}
+
+	// If the item was added as part of the same set of changes, it won't have been inserted into
+	// the listview yet.
+	if (std::erase(pendingChanges.addedItems, *internalIndex) > 0)
 	{
-		RemoveItem(*internalIndex);
+		DiscardItem(*internalIndex);
+		return;
 	}
+
+	RemoveItem(*internalIndex);
 }
 
-void ShellBrowserImpl::OnItemModified(PCIDLIST_ABSOLUTE simplePidl)
+void ShellBrowserImpl::OnItemModified(PCIDLIST_ABSOLUTE simplePidl,
+	PendingItemChanges &pendingChanges)
 {
 	PidlAbsolute pidlFull;
 	HRESULT hr = UpdatePidl(simplePidl, pidlFull);
@@ -356,7 +525,7 @@ void ShellBrowserImpl::OnItemModified(PCIDLIST_ABSOLUTE simplePidl)
 	// rename/deletion notification is likely to be processed soon).
 	if (SUCCEEDED(hr))
 	{
-		UpdateItem(pidlFull.Raw());
+		UpdateItem(pidlFull.Raw(), nullptr, pendingChanges);
 	}
 }
 
@@ -370,7 +539,8 @@ void ShellBrowserImpl::OnItemModified(PCIDLIST_ABSOLUTE simplePidl)
 // When an item is modified, the name shouldn't change, so that does mean that there is at least one
 // difference between the two update types. However, handling both updates in a single method is
 // better than having two very similar methods.
-void ShellBrowserImpl::UpdateItem(PCIDLIST_ABSOLUTE pidl, PCIDLIST_ABSOLUTE updatedPidl)
+void ShellBrowserImpl::UpdateItem(PCIDLIST_ABSOLUTE pidl, PCIDLIST_ABSOLUTE updatedPidl,
+	PendingItemChanges &pendingChanges)
 {
 	auto internalIndex = GetItemInternalIndexForPidl(pidl);
 
@@ -407,35 +577,33 @@ void ShellBrowserImpl::UpdateItem(PCIDLIST_ABSOLUTE pidl, PCIDLIST_ABSOLUTE upda
 		return;
 	}
 
-	ULARGE_INTEGER oldFileSize = { m_itemInfoMap[*internalIndex].wfd.nFileSizeLow,
-		m_itemInfoMap[*internalIndex].wfd.nFileSizeHigh };
-	ULARGE_INTEGER newFileSize = { itemInfo->wfd.nFileSizeLow, itemInfo->wfd.nFileSizeHigh };
-
-	m_directoryState.totalDirSize += newFileSize.QuadPart - oldFileSize.QuadPart;
-
 	m_itemInfoMap[*internalIndex] = std::move(*itemInfo);
 	const ItemInfo_t &updatedItemInfo = m_itemInfoMap[*internalIndex];
 
+	// If the item is currently shown, its new size will be reflected in the directory and
+	// selection totals.
+	UpdateTrackedItem(*internalIndex);
+
+	// Any column text that's currently being retrieved is based on the previous version of the
+	// item.
+	m_columnTextScheduler->InvalidateItem(*internalIndex);
+	m_itemNameIndex.AddItem(*internalIndex, updatedItemInfo.parsingName);
+	UpdateItemSortKeys(*internalIndex);
+
 	auto itemIndex = LocateItemByInternalIndex(*internalIndex);
 
-	// Items may be filtered out of the listview, so it's valid for an item not to be found.
+	// Items may be filtered out of the listview (or not yet inserted), so it's valid for an item
+	// not to be found.
 	if (!itemIndex)
 	{
 		if (!IsFileFiltered(updatedItemInfo))
 		{
-			UnfilterItem(*internalIndex);
+			pendingChanges.unfilteredItems.push_back(*internalIndex);
 		}
 
 		return;
 	}
 
-	UINT state = ListView_GetItemState(m_hListView, *itemIndex, LVIS_SELECTED);
-
-	if (WI_IsFlagSet(state, LVIS_SELECTED))
-	{
-		m_directoryState.fileSelectionSize += newFileSize.QuadPart - oldFileSize.QuadPart;
-	}
-
 	if (IsFileFiltered(updatedItemInfo))
 	{
 		RemoveFilteredItem(*itemIndex, *internalIndex);
@@ -452,33 +620,29 @@ void ShellBrowserImpl::UpdateItem(PCIDLIST_ABSOLUTE pidl, PCIDLIST_ABSOLUTE upda
 	{
 		// The display name can change, even if the parsing name is the same. For example, when the
 		// recycle bin is renamed, the parsing name remains the same.
-		BasicItemInfo_t basicItemInfo = getBasicItemInfo(*internalIndex);
-		std::wstring filename = ProcessItemFileName(basicItemInfo, m_config->globalFolderSettings);
-		ListView_SetItemText(m_hListView, *itemIndex, 0, filename.data());
-	}
-
-	if (WI_IsFlagSet(updatedItemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_HIDDEN))
-	{
-		ListView_SetItemState(m_hListView, *itemIndex, LVIS_CUT, LVIS_CUT);
-	}
-	else
-	{
-		ListView_SetItemState(m_hListView, *itemIndex, 0, LVIS_CUT);
+		if (m_virtualListView)
+		{
+			ListView_RedrawItems(m_hListView, *itemIndex, *itemIndex);
+		}
+		else
+		{
+			BasicItemInfo_t basicItemInfo = getBasicItemInfo(*internalIndex);
+			std::wstring filename =
+				ProcessItemFileName(basicItemInfo, m_config->globalFolderSettings);
+			ListView_SetItemText(m_hListView, *itemIndex, 0, filename.data());
+		}
 	}
 
-	if (m_folderSettings.showInGroups)
-	{
-		int groupId = DetermineItemGroup(*internalIndex);
-		InsertItemIntoGroup(*itemIndex, groupId);
-	}
+	SetItemCutState(*itemIndex,
+		WI_IsFlagSet(updatedItemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_HIDDEN));
 
-	// It's not safe to use itemIndex past this point.
-	ListView_SortItems(m_hListView, SortStub, this);
-	itemIndex.reset();
+	// The item's group and position will be updated once all the other changes have been
+	// processed.
+	pendingChanges.updatedItems.push_back(*internalIndex);
 }
 
 void ShellBrowserImpl::OnItemRenamed(PCIDLIST_ABSOLUTE simplePidlOld,
-	PCIDLIST_ABSOLUTE simplePidlNew)
+	PCIDLIST_ABSOLUTE simplePidlNew, PendingItemChanges &pendingChanges)
 {
 	// When an item is updated, the WIN32_FIND_DATA information cached in the pidl will be
 	// retrieved. As the simple pidl won't contain this information, it's important to convert the
@@ -507,7 +671,7 @@ void ShellBrowserImpl::OnItemRenamed(PCIDLIST_ABSOLUTE simplePidlOld,
 		pidlNew = simplePidlNew;
 	}
 
-	UpdateItem(simplePidlOld, pidlNew);
+	UpdateItem(simplePidlOld, pidlNew, pendingChanges);
 }
 
 void ShellBrowserImpl::InvalidateAllColumnsForItem(int itemIndex)
@@ -517,6 +681,16 @@ void ShellBrowserImpl::InvalidateAllColumnsForItem(int itemIndex)
 		return;
 	}
 
+	// Any text that's still being retrieved for the item is now out of date.
+	m_columnTextScheduler->InvalidateItem(GetItemInternalIndex(itemIndex));
+
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.ResetColumnText(GetItemInternalIndex(itemIndex));
+		ListView_RedrawItems(m_hListView, itemIndex, itemIndex);
+		return;
+	}
+
 	auto numColumns = std::count_if(m_pActiveColumns->begin(), m_pActiveColumns->end(),
 		[](const Column_t &column) { return column.checked; });
 
@@ -528,6 +702,13 @@ void ShellBrowserImpl::InvalidateAllColumnsForItem(int itemIndex)
 
 void ShellBrowserImpl::InvalidateIconForItem(int itemIndex)
 {
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.ResetImage(GetItemInternalIndex(itemIndex));
+		ListView_RedrawItems(m_hListView, itemIndex, itemIndex);
+		return;
+	}
+
 	LVITEM lvItem;
 	lvItem.mask = LVIF_IMAGE;
 	lvItem.iItem = itemIndex;
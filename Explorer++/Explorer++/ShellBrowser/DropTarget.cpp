@@ -147,10 +147,8 @@ void ShellBrowserImpl::RepositionLocalFiles(const POINT *ppt)
 
 		if (m_folderSettings.viewMode == +ViewMode::Details)
 		{
-			LVITEM lvItem;
 			POINT ptItem;
 			BOOL bBelowPreviousItem = TRUE;
-			BOOL bRes;
 			int iInsert = 0;
 			int iSort = 0;
 			int nItems;
@@ -181,32 +179,34 @@ void ShellBrowserImpl::RepositionLocalFiles(const POINT *ppt)
 
 			for (i = 0; i < nItems; i++)
 			{
-				lvItem.mask = LVIF_PARAM;
-				lvItem.iItem = i;
-				lvItem.iSubItem = 0;
-				bRes = ListView_GetItem(m_hListView, &lvItem);
+				int internalIndex = GetItemInternalIndex(i);
 
-				if (bRes)
+				if (i == *index)
 				{
-					if (i == *index)
+					m_itemInfoMap.at(internalIndex).iRelativeSort = iInsert;
+				}
+				else
+				{
+					if (iSort == iInsert)
 					{
-						m_itemInfoMap.at((int) lvItem.lParam).iRelativeSort = iInsert;
+						iSort++;
 					}
-					else
-					{
-						if (iSort == iInsert)
-						{
-							iSort++;
-						}
 
-						m_itemInfoMap.at((int) lvItem.lParam).iRelativeSort = iSort;
-					}
+					m_itemInfoMap.at(internalIndex).iRelativeSort = iSort;
 				}
 
 				iSort++;
 			}
 
-			ListView_SortItems(m_hListView, SortTemporaryStub, (LPARAM) this);
+			if (m_virtualListView)
+			{
+				SortVirtualListView([this](int internalIndex1, int internalIndex2)
+					{ return SortTemporary(internalIndex1, internalIndex2); });
+			}
+			else
+			{
+				ListView_SortItems(m_hListView, SortTemporaryStub, (LPARAM) this);
+			}
 		}
 		else
 		{
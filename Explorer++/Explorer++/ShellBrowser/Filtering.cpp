@@ -6,6 +6,7 @@
 #include "ShellBrowserImpl.h"
 #include "MainResource.h"
 #include "../Helper/ListViewHelper.h"
+#include "../Helper/ScopedRedrawDisabler.h"
 
 std::wstring ShellBrowserImpl::GetFilterText() const
 {
@@ -14,12 +15,16 @@ std::wstring ShellBrowserImpl::GetFilterText() const
 
 void ShellBrowserImpl::SetFilterText(std::wstring_view filter)
 {
+	// When the filter is being typed, each character will usually narrow the filter, in which case
+	// none of the hidden items can become visible.
+	bool filterNarrowed = WildcardPattern::IsSubsetOf(filter, m_folderSettings.filter);
+
 	m_folderSettings.filter = filter;
+	UpdateFilterPattern();
 
 	if (m_folderSettings.applyFilter)
 	{
-		UnfilterAllItems();
-		UpdateFiltering();
+		ReapplyFilter(filterNarrowed);
 	}
 }
 
@@ -37,7 +42,20 @@ bool ShellBrowserImpl::IsFilterApplied() const
 
 void ShellBrowserImpl::SetFilterCaseSensitive(bool filterCaseSensitive)
 {
+	if (filterCaseSensitive == m_folderSettings.filterCaseSensitive)
+	{
+		return;
+	}
+
 	m_folderSettings.filterCaseSensitive = filterCaseSensitive;
+	UpdateFilterPattern();
+
+	// A case-sensitive filter can only match a subset of the items that the equivalent
+	// case-insensitive filter matches.
+	if (m_folderSettings.applyFilter)
+	{
+		ReapplyFilter(filterCaseSensitive);
+	}
 }
 
 bool ShellBrowserImpl::GetFilterCaseSensitive() const
@@ -45,11 +63,18 @@ bool ShellBrowserImpl::GetFilterCaseSensitive() const
 	return m_folderSettings.filterCaseSensitive;
 }
 
+void ShellBrowserImpl::UpdateFilterPattern()
+{
+	m_filterPattern =
+		WildcardPattern(m_folderSettings.filter, m_folderSettings.filterCaseSensitive);
+}
+
 void ShellBrowserImpl::UpdateFiltering()
 {
 	if (m_folderSettings.applyFilter)
 	{
 		RemoveFilteredItems();
+		SendMessage(m_hOwner, WM_USER_UPDATEWINDOWS, 0, 0);
 	}
 	else
 	{
@@ -57,57 +82,109 @@ void ShellBrowserImpl::UpdateFiltering()
 	}
 }
 
-void ShellBrowserImpl::RemoveFilteredItems()
+// Updates the set of visible items after the filter has changed. Rather than restoring every
+// filtered item and then filtering the full set of items again, only the items whose visibility
+// has changed are inserted or removed.
+void ShellBrowserImpl::ReapplyFilter(bool filterNarrowed)
 {
-	if (!m_folderSettings.applyFilter)
+	std::vector<int> itemsToRestore;
+
+	if (!filterNarrowed)
 	{
-		return;
+		for (int internalIndex : m_directoryState.filteredItemsList)
+		{
+			if (!IsFileFiltered(m_itemInfoMap.at(internalIndex)))
+			{
+				itemsToRestore.push_back(internalIndex);
+			}
+		}
 	}
 
-	int nItems = ListView_GetItemCount(m_hListView);
+	// The items that no longer match are removed first, so that the restored items don't need to
+	// be tested again.
+	RemoveFilteredItems();
 
-	for (int i = nItems - 1; i >= 0; i--)
+	if (!itemsToRestore.empty())
 	{
-		int internalIndex = GetItemInternalIndex(i);
-
-		if (!((m_itemInfoMap.at(internalIndex).wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-				== FILE_ATTRIBUTE_DIRECTORY))
+		for (int internalIndex : itemsToRestore)
 		{
-			if (IsFilenameFiltered(m_itemInfoMap.at(internalIndex).displayName.c_str()))
-			{
-				RemoveFilteredItem(i, internalIndex);
-			}
+			m_directoryState.filteredItemsList.erase(internalIndex);
 		}
+
+		QueueItemsForSortedInsertion(std::move(itemsToRestore));
+		InsertAwaitingItems();
 	}
 
 	SendMessage(m_hOwner, WM_USER_UPDATEWINDOWS, 0, 0);
 }
 
-void ShellBrowserImpl::RemoveFilteredItem(int iItem, int iItemInternal)
+void ShellBrowserImpl::RemoveFilteredItems()
 {
-	ULARGE_INTEGER ulFileSize;
+	if (!m_folderSettings.applyFilter)
+	{
+		return;
+	}
 
-	const auto &item = m_itemInfoMap.at(iItemInternal);
+	int nItems = ListView_GetItemCount(m_hListView);
+	std::vector<int> itemsToRemove;
 
-	if (ListView_GetItemState(m_hListView, iItem, LVIS_SELECTED) == LVIS_SELECTED)
+	for (int i = 0; i < nItems; i++)
 	{
-		ulFileSize.LowPart = item.wfd.nFileSizeLow;
-		ulFileSize.HighPart = item.wfd.nFileSizeHigh;
+		const auto &itemInfo = m_itemInfoMap.at(GetItemInternalIndex(i));
 
-		m_directoryState.fileSelectionSize -= ulFileSize.QuadPart;
+		if (WI_IsFlagClear(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY)
+			&& IsFilenameFiltered(itemInfo.displayName.c_str()))
+		{
+			itemsToRemove.push_back(i);
+		}
 	}
 
-	/* Take the file size of the removed file away from the total
-	directory size. */
-	ulFileSize.LowPart = item.wfd.nFileSizeLow;
-	ulFileSize.HighPart = item.wfd.nFileSizeHigh;
+	if (itemsToRemove.empty())
+	{
+		return;
+	}
 
-	m_directoryState.totalDirSize -= ulFileSize.QuadPart;
+	if (m_virtualListView)
+	{
+		// The items can all be removed from the model in a single pass.
+		std::unordered_set<int> internalIndexes;
+
+		for (int item : itemsToRemove)
+		{
+			int internalIndex = GetItemInternalIndex(item);
+			OnItemFiltered(internalIndex);
+			internalIndexes.insert(internalIndex);
+		}
+
+		m_listViewItemModel.RemoveItems(internalIndexes);
+		UpdateVirtualListViewItemCount();
+		return;
+	}
+
+	ScopedRedrawDisabler redrawDisabler(m_hListView);
+
+	// Items are removed from the end of the list first, so that removing an item doesn't change
+	// the index of any of the items still to be removed.
+	for (auto itr = itemsToRemove.rbegin(); itr != itemsToRemove.rend(); ++itr)
+	{
+		RemoveFilteredItem(*itr, GetItemInternalIndex(*itr));
+	}
+}
+
+void ShellBrowserImpl::RemoveFilteredItem(int iItem, int iItemInternal)
+{
+	OnItemFiltered(iItemInternal);
 
 	/* Remove the item from the m_hListView. */
-	ListView_DeleteItem(m_hListView, iItem);
+	DeleteListViewItem(iItem);
+}
 
-	m_directoryState.numItems--;
+// Updates the directory state for an item that's about to be removed from the listview because
+// it's been filtered.
+void ShellBrowserImpl::OnItemFiltered(int iItemInternal)
+{
+	// This also removes the item from the selection, if it's selected.
+	m_directoryState.selectionTracker.RemoveItem(iItemInternal);
 
 	assert(m_directoryState.filteredItemsList.count(iItemInternal) == 0);
 	m_directoryState.filteredItemsList.insert(iItemInternal);
@@ -115,8 +192,7 @@ void ShellBrowserImpl::RemoveFilteredItem(int iItem, int iItemInternal)
 
 BOOL ShellBrowserImpl::IsFilenameFiltered(const TCHAR *FileName) const
 {
-	if (CheckWildcardMatch(m_folderSettings.filter.c_str(), FileName,
-			m_folderSettings.filterCaseSensitive))
+	if (m_filterPattern.Matches(FileName))
 	{
 		return FALSE;
 	}
@@ -126,12 +202,13 @@ BOOL ShellBrowserImpl::IsFilenameFiltered(const TCHAR *FileName) const
 
 void ShellBrowserImpl::UnfilterAllItems()
 {
-	for (int internalIndex : m_directoryState.filteredItemsList)
-	{
-		RestoreFilteredItem(internalIndex);
-	}
-
+	// Any items that are still filtered will be added back to the filtered list when the items are
+	// restored, so the list needs to be cleared first.
+	std::vector<int> internalIndexes(m_directoryState.filteredItemsList.begin(),
+		m_directoryState.filteredItemsList.end());
 	m_directoryState.filteredItemsList.clear();
+
+	RestoreFilteredItems(internalIndexes);
 	SendMessage(m_hOwner, WM_USER_UPDATEWINDOWS, 0, 0);
 }
 
@@ -157,3 +234,35 @@ void ShellBrowserImpl::RestoreFilteredItem(int internalIndex)
 
 	InsertAwaitingItems();
 }
+
+void ShellBrowserImpl::RestoreFilteredItems(const std::vector<int> &internalIndexes)
+{
+	std::vector<int> itemsToRestore = internalIndexes;
+	ExcludeFilteredItems(itemsToRestore);
+
+	if (itemsToRestore.empty())
+	{
+		return;
+	}
+
+	QueueItemsForSortedInsertion(std::move(itemsToRestore));
+	InsertAwaitingItems();
+}
+
+// Removes the items that are currently filtered from the specified list, adding them to the set of
+// filtered items instead. This needs to be done before items are queued for sorted insertion,
+// since the sorted positions are determined on the basis that every queued item will be inserted.
+void ShellBrowserImpl::ExcludeFilteredItems(std::vector<int> &internalIndexes)
+{
+	std::erase_if(internalIndexes,
+		[this](int internalIndex)
+		{
+			if (!IsFileFiltered(m_itemInfoMap.at(internalIndex)))
+			{
+				return false;
+			}
+
+			m_directoryState.filteredItemsList.insert(internalIndex);
+			return true;
+		});
+}
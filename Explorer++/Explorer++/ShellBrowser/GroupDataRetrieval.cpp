@@ -0,0 +1,606 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "GroupDataRetrieval.h"
+#include "ColumnDataRetrieval.h"
+#include "ItemData.h"
+#include "MainResource.h"
+#include "ResourceHelper.h"
+#include "../Helper/Helper.h"
+#include "../Helper/ShellHelper.h"
+#include "../Helper/TimeHelper.h"
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/integer_traits.hpp>
+#include <glog/logging.h>
+#include <wil/common.h>
+#include <iphlpapi.h>
+#include <cassert>
+
+namespace
+{
+
+const uint64_t KBYTE = 1024;
+const uint64_t MBYTE = 1024 * 1024;
+const uint64_t GBYTE = 1024 * 1024 * 1024;
+
+enum class GroupByDateType
+{
+	Created,
+	Modified,
+	Accessed
+};
+
+/* TODO: These groups have changed as of Windows Vista.*/
+std::optional<GroupInfo> DetermineItemNameGroup(const BasicItemInfo_t &itemInfo,
+	HINSTANCE resourceInstance)
+{
+	/* Take the first character of the item's name,
+	and use it to determine which group it belongs to. */
+	TCHAR ch = itemInfo.szDisplayName[0];
+
+	if (iswalpha(ch))
+	{
+		return GroupInfo(std::wstring(1, towupper(ch)));
+	}
+	else
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_NAME_OTHER),
+			INT_MAX);
+	}
+}
+
+std::optional<GroupInfo> DetermineItemSizeGroup(const BasicItemInfo_t &itemInfo,
+	HINSTANCE resourceInstance)
+{
+	if ((itemInfo.wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_SIZE_FOLDERS), 0);
+	}
+	else if (!itemInfo.isFindDataValid)
+	{
+		return std::nullopt;
+	}
+
+	struct SizeGroup
+	{
+		int nameResourceId;
+		uint64_t upperLimit;
+	};
+
+	// If the limits here are adjusted, the entries in the string table should be updated as well
+	// (since they reference the limits as well).
+	SizeGroup sizeGroups[] = { { IDS_GROUPBY_SIZE_EMPTY, 0 }, { IDS_GROUPBY_SIZE_TINY, 16 * KBYTE },
+		{ IDS_GROUPBY_SIZE_SMALL, MBYTE }, { IDS_GROUPBY_SIZE_MEDIUM, 128 * MBYTE },
+		{ IDS_GROUPBY_SIZE_LARGE, GBYTE }, { IDS_GROUPBY_SIZE_HUGE, 4 * GBYTE },
+		{ IDS_GROUPBY_SIZE_GIGANTIC, boost::integer_traits<uint64_t>::const_max } };
+
+	ULARGE_INTEGER fileSize = { itemInfo.wfd.nFileSizeLow, itemInfo.wfd.nFileSizeHigh };
+	int currentIndex = 0;
+
+	while (fileSize.QuadPart > sizeGroups[currentIndex].upperLimit
+		&& currentIndex < (std::size(sizeGroups) - 1))
+	{
+		currentIndex++;
+	}
+
+	return GroupInfo(
+		ResourceHelper::LoadString(resourceInstance, sizeGroups[currentIndex].nameResourceId),
+		currentIndex + 1);
+}
+
+/* TODO: These groups have changed as of Windows Vista. */
+std::optional<GroupInfo> DetermineItemTotalSizeGroup(const BasicItemInfo_t &itemInfo)
+{
+	IShellFolder *pShellFolder = nullptr;
+	PCITEMID_CHILD pidlRelative = nullptr;
+	const TCHAR *sizeGroups[] = { _T("Small"), _T("Medium"), _T("Huge"), _T("Gigantic") };
+	TCHAR szItem[MAX_PATH];
+	STRRET str;
+	ULARGE_INTEGER nTotalBytes;
+	ULARGE_INTEGER nFreeBytes;
+	BOOL bRoot;
+	BOOL bRes = FALSE;
+	ULARGE_INTEGER totalSizeGroupLimits[6];
+	int iSize = 0;
+	int i;
+
+	totalSizeGroupLimits[0].QuadPart = 0;
+	totalSizeGroupLimits[1].QuadPart = 0;
+	totalSizeGroupLimits[2].QuadPart = GBYTE;
+	totalSizeGroupLimits[3].QuadPart = 20 * totalSizeGroupLimits[2].QuadPart;
+	totalSizeGroupLimits[4].QuadPart = 100 * totalSizeGroupLimits[2].QuadPart;
+
+	SHBindToParent(itemInfo.pidlComplete.get(), IID_PPV_ARGS(&pShellFolder), &pidlRelative);
+
+	pShellFolder->GetDisplayNameOf(pidlRelative, SHGDN_FORPARSING, &str);
+	StrRetToBuf(&str, pidlRelative, szItem, std::size(szItem));
+
+	bRoot = PathIsRoot(szItem);
+
+	if (bRoot)
+	{
+		bRes = GetDiskFreeSpaceEx(szItem, nullptr, &nTotalBytes, &nFreeBytes);
+
+		pShellFolder->Release();
+
+		i = std::size(sizeGroups) - 1;
+
+		while (nTotalBytes.QuadPart < totalSizeGroupLimits[i].QuadPart && i > 0)
+		{
+			i--;
+		}
+
+		iSize = i;
+	}
+
+	if (!bRoot || !bRes)
+	{
+		return std::nullopt;
+	}
+
+	return GroupInfo(sizeGroups[iSize], iSize);
+}
+
+std::optional<GroupInfo> DetermineItemTypeGroupVirtual(const BasicItemInfo_t &itemInfo)
+{
+	SHFILEINFO shfi;
+	DWORD_PTR res = SHGetFileInfo((LPTSTR) itemInfo.pidlComplete.get(), 0, &shfi, sizeof(shfi),
+		SHGFI_PIDL | SHGFI_TYPENAME);
+
+	if (!res)
+	{
+		return std::nullopt;
+	}
+
+	return GroupInfo(shfi.szTypeName);
+}
+
+std::optional<GroupInfo> DetermineItemDateGroup(const BasicItemInfo_t &itemInfo,
+	GroupByDateType dateType, HINSTANCE resourceInstance)
+{
+	if (!itemInfo.isFindDataValid)
+	{
+		return std::nullopt;
+	}
+
+	using namespace boost::gregorian;
+	using namespace boost::posix_time;
+
+	SYSTEMTIME stFileTime;
+	BOOL ret = FALSE;
+
+	switch (dateType)
+	{
+	case GroupByDateType::Modified:
+		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftLastWriteTime, &stFileTime);
+		break;
+
+	case GroupByDateType::Created:
+		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftCreationTime, &stFileTime);
+		break;
+
+	case GroupByDateType::Accessed:
+		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftLastAccessTime, &stFileTime);
+		break;
+
+	default:
+		LOG(FATAL) << "Incorrect date type";
+	}
+
+	if (!ret)
+	{
+		return std::nullopt;
+	}
+
+	FILETIME localFileTime;
+	ret = SystemTimeToFileTime(&stFileTime, &localFileTime);
+
+	if (!ret)
+	{
+		return std::nullopt;
+	}
+
+	auto filePosixTime = from_ftime<ptime>(localFileTime);
+	date fileDate = filePosixTime.date();
+
+	date today = day_clock::local_day();
+	int relativeSortPosition = 0;
+
+	if (fileDate > today)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_FUTURE),
+			relativeSortPosition);
+	}
+
+	relativeSortPosition--;
+
+	if (fileDate == today)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_TODAY),
+			relativeSortPosition);
+	}
+
+	date yesterday = today - days(1);
+
+	relativeSortPosition--;
+
+	if (fileDate == yesterday)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_YESTERDAY),
+			relativeSortPosition);
+	}
+
+	// Note that this assumes that Sunday is the first day of the week.
+	unsigned short currentWeekday = today.day_of_week().as_number();
+	date startOfWeek = today - days(currentWeekday);
+
+	relativeSortPosition--;
+
+	if (fileDate >= startOfWeek)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_THIS_WEEK),
+			relativeSortPosition);
+	}
+
+	date startOfLastWeek = startOfWeek - weeks(1);
+
+	relativeSortPosition--;
+
+	if (fileDate >= startOfLastWeek)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_LAST_WEEK),
+			relativeSortPosition);
+	}
+
+	date startOfMonth = date(today.year(), today.month(), 1);
+
+	relativeSortPosition--;
+
+	if (fileDate >= startOfMonth)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_THIS_MONTH),
+			relativeSortPosition);
+	}
+
+	date startOfLastMonth = startOfMonth - months(1);
+
+	relativeSortPosition--;
+
+	if (fileDate >= startOfLastMonth)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_LAST_MONTH),
+			relativeSortPosition);
+	}
+
+	date startOfYear = date(today.year(), 1, 1);
+
+	relativeSortPosition--;
+
+	if (fileDate >= startOfYear)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_THIS_YEAR),
+			relativeSortPosition);
+	}
+
+	date startOfLastYear = startOfYear - years(1);
+
+	relativeSortPosition--;
+
+	if (fileDate >= startOfLastYear)
+	{
+		return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_LAST_YEAR),
+			relativeSortPosition);
+	}
+
+	relativeSortPosition--;
+
+	return GroupInfo(ResourceHelper::LoadString(resourceInstance, IDS_GROUPBY_DATE_LONG_AGO),
+		relativeSortPosition);
+}
+
+/* TODO: Need to sort based on percentage free. */
+std::optional<GroupInfo> DetermineItemFreeSpaceGroup(const BasicItemInfo_t &itemInfo)
+{
+	TCHAR szFreeSpace[MAX_PATH];
+	IShellFolder *pShellFolder = nullptr;
+	PCITEMID_CHILD pidlRelative = nullptr;
+	STRRET str;
+	TCHAR szItem[MAX_PATH];
+	ULARGE_INTEGER nTotalBytes;
+	ULARGE_INTEGER nFreeBytes;
+	BOOL bRoot;
+	BOOL bRes = FALSE;
+
+	SHBindToParent(itemInfo.pidlComplete.get(), IID_PPV_ARGS(&pShellFolder), &pidlRelative);
+
+	pShellFolder->GetDisplayNameOf(pidlRelative, SHGDN_FORPARSING, &str);
+	StrRetToBuf(&str, pidlRelative, szItem, std::size(szItem));
+
+	pShellFolder->Release();
+
+	bRoot = PathIsRoot(szItem);
+
+	if (bRoot)
+	{
+		bRes = GetDiskFreeSpaceEx(szItem, nullptr, &nTotalBytes, &nFreeBytes);
+
+		LARGE_INTEGER lDiv1;
+		LARGE_INTEGER lDiv2;
+
+		lDiv1.QuadPart = 100;
+		lDiv2.QuadPart = 10;
+
+		/* Divide by 10 to remove the one's digit, then multiply
+		by 10 so that only the ten's digit rmains. */
+		StringCchPrintf(szFreeSpace, std::size(szFreeSpace), _T("%I64d%% free"),
+			(((nFreeBytes.QuadPart * lDiv1.QuadPart) / nTotalBytes.QuadPart) / lDiv2.QuadPart)
+				* lDiv2.QuadPart);
+	}
+
+	if (!bRoot || !bRes)
+	{
+		return std::nullopt;
+	}
+
+	return GroupInfo(szFreeSpace);
+}
+
+std::optional<GroupInfo> DetermineItemAttributeGroup(const BasicItemInfo_t &itemInfo)
+{
+	if (!itemInfo.isFindDataValid)
+	{
+		return std::nullopt;
+	}
+
+	auto attributesString = BuildFileAttributesString(itemInfo.wfd.dwFileAttributes);
+	return GroupInfo(attributesString);
+}
+
+std::optional<GroupInfo> DetermineItemExtensionGroup(const BasicItemInfo_t &itemInfo)
+{
+	if (WI_IsFlagSet(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY))
+	{
+		return std::nullopt;
+	}
+
+	std::wstring fullFileName = itemInfo.getFullPath();
+	TCHAR *pExt = PathFindExtension(fullFileName.c_str());
+
+	if (*pExt == '\0')
+	{
+		return std::nullopt;
+	}
+
+	return GroupInfo(pExt);
+}
+
+/* TODO: Fix. Need to check for each adapter. */
+std::optional<GroupInfo> DetermineItemNetworkStatus(const BasicItemInfo_t &itemInfo,
+	HINSTANCE resourceInstance)
+{
+	/* When this function is
+	properly implemented, this
+	can be removed. */
+	UNREFERENCED_PARAMETER(itemInfo);
+
+	TCHAR szStatus[32] = L"";
+	IP_ADAPTER_ADDRESSES *pAdapterAddresses = nullptr;
+	UINT uStatusID = 0;
+	ULONG ulOutBufLen = 0;
+
+	GetAdaptersAddresses(AF_UNSPEC, 0, nullptr, nullptr, &ulOutBufLen);
+
+	pAdapterAddresses = (IP_ADAPTER_ADDRESSES *) malloc(ulOutBufLen);
+
+	GetAdaptersAddresses(AF_UNSPEC, 0, nullptr, pAdapterAddresses, &ulOutBufLen);
+
+	/* TODO: These strings need to be setup correctly. */
+	/*switch(pAdapterAddresses->OperStatus)
+	{
+		case IfOperStatusUp:
+			uStatusID = IDS_NETWORKADAPTER_CONNECTED;
+			break;
+
+		case IfOperStatusDown:
+			uStatusID = IDS_NETWORKADAPTER_DISCONNECTED;
+			break;
+
+		case IfOperStatusTesting:
+			uStatusID = IDS_NETWORKADAPTER_TESTING;
+			break;
+
+		case IfOperStatusUnknown:
+			uStatusID = IDS_NETWORKADAPTER_UNKNOWN;
+			break;
+
+		case IfOperStatusDormant:
+			uStatusID = IDS_NETWORKADAPTER_DORMANT;
+			break;
+
+		case IfOperStatusNotPresent:
+			uStatusID = IDS_NETWORKADAPTER_NOTPRESENT;
+			break;
+
+		case IfOperStatusLowerLayerDown:
+			uStatusID = IDS_NETWORKADAPTER_LOWLAYER;
+			break;
+	}*/
+
+	LoadString(resourceInstance, uStatusID, szStatus, std::size(szStatus));
+
+	return GroupInfo(szStatus);
+}
+
+}
+
+std::optional<GroupInfo> DetermineItemGroupInfo(const BasicItemInfo_t &basicItemInfo,
+	SortMode groupMode, HINSTANCE resourceInstance,
+	const GlobalFolderSettings &globalFolderSettings, ColumnValueCache *columnValueCache)
+{
+	if (auto columnType = GetGroupModeColumn(groupMode))
+	{
+		auto columnText =
+			GetColumnText(*columnType, basicItemInfo, globalFolderSettings, columnValueCache);
+
+		if (columnText.empty())
+		{
+			return std::nullopt;
+		}
+
+		return GroupInfo(columnText);
+	}
+
+	std::optional<GroupInfo> groupInfo;
+
+	switch (groupMode)
+	{
+	case SortMode::Name:
+		groupInfo = DetermineItemNameGroup(basicItemInfo, resourceInstance);
+		break;
+
+	case SortMode::Type:
+		groupInfo = DetermineItemTypeGroupVirtual(basicItemInfo);
+		break;
+
+	case SortMode::Size:
+		groupInfo = DetermineItemSizeGroup(basicItemInfo, resourceInstance);
+		break;
+
+	case SortMode::DateModified:
+		groupInfo =
+			DetermineItemDateGroup(basicItemInfo, GroupByDateType::Modified, resourceInstance);
+		break;
+
+	case SortMode::TotalSize:
+		groupInfo = DetermineItemTotalSizeGroup(basicItemInfo);
+		break;
+
+	case SortMode::FreeSpace:
+		groupInfo = DetermineItemFreeSpaceGroup(basicItemInfo);
+		break;
+
+	case SortMode::DateDeleted:
+		break;
+
+	case SortMode::Attributes:
+		groupInfo = DetermineItemAttributeGroup(basicItemInfo);
+		break;
+
+	case SortMode::ShortName:
+		groupInfo = DetermineItemNameGroup(basicItemInfo, resourceInstance);
+		break;
+
+	case SortMode::ShortcutTo:
+		break;
+
+	case SortMode::HardLinks:
+		break;
+
+	case SortMode::Extension:
+		groupInfo = DetermineItemExtensionGroup(basicItemInfo);
+		break;
+
+	case SortMode::Created:
+		groupInfo =
+			DetermineItemDateGroup(basicItemInfo, GroupByDateType::Created, resourceInstance);
+		break;
+
+	case SortMode::Accessed:
+		groupInfo =
+			DetermineItemDateGroup(basicItemInfo, GroupByDateType::Accessed, resourceInstance);
+		break;
+
+	case SortMode::VirtualComments:
+		break;
+
+	case SortMode::NumPrinterDocuments:
+		break;
+
+	case SortMode::PrinterStatus:
+		break;
+
+	case SortMode::PrinterComments:
+		break;
+
+	case SortMode::PrinterLocation:
+		break;
+
+	case SortMode::NetworkAdapterStatus:
+		groupInfo = DetermineItemNetworkStatus(basicItemInfo, resourceInstance);
+		break;
+
+	default:
+		assert(false);
+		break;
+	}
+
+	return groupInfo;
+}
+
+bool IsSlowGroupMode(SortMode groupMode)
+{
+	return groupMode == +SortMode::FreeSpace;
+}
+
+std::optional<ColumnType> GetGroupModeColumn(SortMode groupMode)
+{
+	switch (groupMode)
+	{
+	case SortMode::OriginalLocation:
+		return ColumnType::OriginalLocation;
+
+	case SortMode::Owner:
+		return ColumnType::Owner;
+
+	case SortMode::ProductName:
+		return ColumnType::ProductName;
+
+	case SortMode::Company:
+		return ColumnType::Company;
+
+	case SortMode::Description:
+		return ColumnType::Description;
+
+	case SortMode::FileVersion:
+		return ColumnType::FileVersion;
+
+	case SortMode::ProductVersion:
+		return ColumnType::ProductVersion;
+
+	case SortMode::Title:
+		return ColumnType::Title;
+
+	case SortMode::Subject:
+		return ColumnType::Subject;
+
+	case SortMode::Authors:
+		return ColumnType::Authors;
+
+	case SortMode::Keywords:
+		return ColumnType::Keywords;
+
+	case SortMode::Comments:
+		return ColumnType::Comment;
+
+	case SortMode::CameraModel:
+		return ColumnType::CameraModel;
+
+	case SortMode::DateTaken:
+		return ColumnType::DateTaken;
+
+	case SortMode::Width:
+		return ColumnType::Width;
+
+	case SortMode::Height:
+		return ColumnType::Height;
+
+	case SortMode::FileSystem:
+		return ColumnType::FileSystem;
+
+	default:
+		return std::nullopt;
+	}
+}
@@ -0,0 +1,48 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "Columns.h"
+#include "SortModes.h"
+#include <optional>
+#include <string>
+
+class ColumnValueCache;
+struct BasicItemInfo_t;
+struct GlobalFolderSettings;
+
+struct GroupInfo
+{
+	std::wstring name;
+	int relativeSortPosition;
+
+	explicit GroupInfo(const std::wstring &name) : name(name), relativeSortPosition(0)
+	{
+	}
+
+	GroupInfo(const std::wstring &name, int relativeSortPosition) :
+		name(name),
+		relativeSortPosition(relativeSortPosition)
+	{
+	}
+};
+
+// Determines the group an item belongs to in the specified mode. This only depends on the item
+// itself (and not on the state of any listview), so it can be called from background threads.
+// Returns std::nullopt if the item doesn't belong to any specific group. The group names are loaded
+// from the string table in the resource instance.
+std::optional<GroupInfo> DetermineItemGroupInfo(const BasicItemInfo_t &basicItemInfo,
+	SortMode groupMode, HINSTANCE resourceInstance,
+	const GlobalFolderSettings &globalFolderSettings, ColumnValueCache *columnValueCache);
+
+// Returns true for the modes where determining an item's group requires a slow query that isn't
+// shared with any column. In those modes, items are placed into their groups progressively, rather
+// than all at once.
+bool IsSlowGroupMode(SortMode groupMode);
+
+// Returns the column whose text is used to group items in the specified mode, for those modes
+// where the text is expensive to retrieve. Grouping in these modes reuses the text retrieved for
+// the details view (and vice versa), rather than retrieving the same values twice.
+std::optional<ColumnType> GetGroupModeColumn(SortMode groupMode);
@@ -4,31 +4,19 @@
 
 #include "stdafx.h"
 #include "ShellBrowserImpl.h"
+#include "App.h"
 #include "Config.h"
+#include "GroupDataRetrieval.h"
 #include "ItemData.h"
 #include "MainResource.h"
 #include "ResourceHelper.h"
 #include "SortModes.h"
 #include "../Helper/Helper.h"
+#include "../Helper/ScopedRedrawDisabler.h"
 #include "../Helper/ShellHelper.h"
-#include "../Helper/TimeHelper.h"
-#include <boost/date_time/gregorian/gregorian.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/integer_traits.hpp>
 #include <glog/logging.h>
-#include <wil/common.h>
-#include <iphlpapi.h>
-#include <propkey.h>
-#include <cassert>
 #include <format>
 
-namespace
-{
-const uint64_t KBYTE = 1024;
-const uint64_t MBYTE = 1024 * 1024;
-const uint64_t GBYTE = 1024 * 1024 * 1024;
-}
-
 bool ShellBrowserImpl::GetShowInGroups() const
 {
 	return m_folderSettings.showInGroups;
@@ -45,6 +33,7 @@ void ShellBrowserImpl::SetShowInGroups(bool showInGroups)
 
 	if (!showInGroups)
 	{
+		CancelGroupingTasks();
 		ListView_EnableGroupView(m_hListView, false);
 		ListView_RemoveAllGroups(m_hListView);
 		m_directoryState.groups.clear();
@@ -53,6 +42,13 @@ void ShellBrowserImpl::SetShowInGroups(bool showInGroups)
 	{
 		MoveItemsIntoGroups();
 	}
+
+	// A virtual listview can't display groups. Instead, the items are ordered by group, so the
+	// order needs to be updated whenever grouping is turned on or off.
+	if (m_virtualListView)
+	{
+		SortFolder();
+	}
 }
 
 int CALLBACK ShellBrowserImpl::GroupComparisonStub(int id1, int id2, void *data)
@@ -142,160 +138,35 @@ const ShellBrowserImpl::ListViewGroup ShellBrowserImpl::GetListViewGroupById(int
 
 int ShellBrowserImpl::DetermineItemGroup(int iItemInternal)
 {
-	BasicItemInfo_t basicItemInfo = getBasicItemInfo(iItemInternal);
+	// If the item was waiting on a background result, that result is now out of date.
+	m_directoryState.pendingGroupItems.erase(iItemInternal);
+
 	std::optional<GroupInfo> groupInfo;
 
-	switch (m_folderSettings.groupMode)
+	if (auto columnType = GetGroupModeColumn(m_folderSettings.groupMode))
 	{
-	case SortMode::Name:
-		groupInfo = DetermineItemNameGroup(basicItemInfo);
-		break;
-
-	case SortMode::Type:
-		groupInfo = DetermineItemTypeGroupVirtual(basicItemInfo);
-		break;
-
-	case SortMode::Size:
-		groupInfo = DetermineItemSizeGroup(basicItemInfo);
-		break;
-
-	case SortMode::DateModified:
-		groupInfo = DetermineItemDateGroup(basicItemInfo, GroupByDateType::Modified);
-		break;
-
-	case SortMode::TotalSize:
-		groupInfo = DetermineItemTotalSizeGroup(basicItemInfo);
-		break;
-
-	case SortMode::FreeSpace:
-		groupInfo = DetermineItemFreeSpaceGroup(basicItemInfo);
-		break;
-
-	case SortMode::DateDeleted:
-		break;
-
-	case SortMode::OriginalLocation:
-		groupInfo = DetermineItemSummaryGroup(basicItemInfo, &SCID_ORIGINAL_LOCATION,
-			m_config->globalFolderSettings);
-		break;
-
-	case SortMode::Attributes:
-		groupInfo = DetermineItemAttributeGroup(basicItemInfo);
-		break;
-
-	case SortMode::ShortName:
-		groupInfo = DetermineItemNameGroup(basicItemInfo);
-		break;
-
-	case SortMode::Owner:
-		groupInfo = DetermineItemOwnerGroup(basicItemInfo);
-		break;
-
-	case SortMode::ProductName:
-		groupInfo = DetermineItemVersionGroup(basicItemInfo, _T("ProductName"));
-		break;
+		// Grouping in this mode is based on the same text that's shown in the details view, so
+		// the text is retrieved using the column tasks. Until it's available, the item is placed
+		// in the loading group.
+		const auto &itemInfo = m_itemInfoMap.at(iItemInternal);
+		auto itr = itemInfo.columnText.find(columnType->_to_integral());
 
-	case SortMode::Company:
-		groupInfo = DetermineItemVersionGroup(basicItemInfo, _T("CompanyName"));
-		break;
-
-	case SortMode::Description:
-		groupInfo = DetermineItemVersionGroup(basicItemInfo, _T("FileDescription"));
-		break;
-
-	case SortMode::FileVersion:
-		groupInfo = DetermineItemVersionGroup(basicItemInfo, _T("FileVersion"));
-		break;
-
-	case SortMode::ProductVersion:
-		groupInfo = DetermineItemVersionGroup(basicItemInfo, _T("ProductVersion"));
-		break;
-
-	case SortMode::ShortcutTo:
-		break;
-
-	case SortMode::HardLinks:
-		break;
-
-	case SortMode::Extension:
-		groupInfo = DetermineItemExtensionGroup(basicItemInfo);
-		break;
-
-	case SortMode::Created:
-		groupInfo = DetermineItemDateGroup(basicItemInfo, GroupByDateType::Created);
-		break;
-
-	case SortMode::Accessed:
-		groupInfo = DetermineItemDateGroup(basicItemInfo, GroupByDateType::Accessed);
-		break;
-
-	case SortMode::Title:
-		groupInfo =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Title, m_config->globalFolderSettings);
-		break;
-
-	case SortMode::Subject:
-		groupInfo =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Subject, m_config->globalFolderSettings);
-		break;
-
-	case SortMode::Authors:
-		groupInfo =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Author, m_config->globalFolderSettings);
-		break;
-
-	case SortMode::Keywords:
-		groupInfo = DetermineItemSummaryGroup(basicItemInfo, &PKEY_Keywords,
-			m_config->globalFolderSettings);
-		break;
+		if (itr == itemInfo.columnText.end())
+		{
+			m_directoryState.pendingGroupItems.insert(iItemInternal);
+			QueueColumnTask(iItemInternal, *columnType);
+			return GetLoadingGroupId();
+		}
 
-	case SortMode::Comments:
+		if (!itr->second.empty())
+		{
+			groupInfo = GroupInfo(itr->second);
+		}
+	}
+	else
+	{
 		groupInfo =
-			DetermineItemSummaryGroup(basicItemInfo, &PKEY_Comment, m_config->globalFolderSettings);
-		break;
-
-	case SortMode::CameraModel:
-		groupInfo = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagEquipModel);
-		break;
-
-	case SortMode::DateTaken:
-		groupInfo = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagDateTime);
-		break;
-
-	case SortMode::Width:
-		groupInfo = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagImageWidth);
-		break;
-
-	case SortMode::Height:
-		groupInfo = DetermineItemCameraPropertyGroup(basicItemInfo, PropertyTagImageHeight);
-		break;
-
-	case SortMode::VirtualComments:
-		break;
-
-	case SortMode::FileSystem:
-		groupInfo = DetermineItemFileSystemGroup(basicItemInfo);
-		break;
-
-	case SortMode::NumPrinterDocuments:
-		break;
-
-	case SortMode::PrinterStatus:
-		break;
-
-	case SortMode::PrinterComments:
-		break;
-
-	case SortMode::PrinterLocation:
-		break;
-
-	case SortMode::NetworkAdapterStatus:
-		groupInfo = DetermineItemNetworkStatus(basicItemInfo);
-		break;
-
-	default:
-		assert(false);
-		break;
+			DetermineItemGroupInfo(getBasicItemInfo(iItemInternal), m_folderSettings.groupMode);
 	}
 
 	if (!groupInfo)
@@ -307,6 +178,22 @@ int ShellBrowserImpl::DetermineItemGroup(int iItemInternal)
 	return GetOrCreateListViewGroup(*groupInfo);
 }
 
+// Note that this is called from background threads, so it shouldn't depend on any state that
+// can be modified on the UI thread.
+std::optional<GroupInfo> ShellBrowserImpl::DetermineItemGroupInfo(
+	const BasicItemInfo_t &basicItemInfo, SortMode groupMode) const
+{
+	return ::DetermineItemGroupInfo(basicItemInfo, groupMode, m_resourceInstance,
+		m_config->globalFolderSettings, m_app->GetColumnValueCache());
+}
+
+// Items are placed in this group while their actual group is being determined.
+int ShellBrowserImpl::GetLoadingGroupId()
+{
+	return GetOrCreateListViewGroup(
+		GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_LOADING), INT_MAX));
+}
+
 int ShellBrowserImpl::GetOrCreateListViewGroup(const GroupInfo &groupInfo)
 {
 	// Note that this will return an existing group, if a group already exists with the specified
@@ -316,535 +203,230 @@ int ShellBrowserImpl::GetOrCreateListViewGroup(const GroupInfo &groupInfo)
 	return group->id;
 }
 
-/* TODO: These groups have changed as of Windows Vista.*/
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemNameGroup(
-	const BasicItemInfo_t &itemInfo) const
+// Regrouping is done in two stages. The group for each item is first determined, after which the
+// groups are created and the items assigned to them in a single pass. In the slow modes, the first
+// stage runs on background threads and the results are applied as they're posted back. In the
+// remaining modes, the groups are cheap to determine, so the first stage runs on the UI thread.
+// Waiting on background tasks for those modes could leave the UI thread stuck behind unrelated work
+// (such as folder size calculations) that's already in the pool.
+void ShellBrowserImpl::MoveItemsIntoGroups()
 {
-	/* Take the first character of the item's name,
-	and use it to determine which group it belongs to. */
-	TCHAR ch = itemInfo.szDisplayName[0];
+	CancelGroupingTasks();
 
-	if (iswalpha(ch))
-	{
-		return GroupInfo(std::wstring(1, towupper(ch)));
-	}
-	else
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_NAME_OTHER),
-			INT_MAX);
-	}
-}
+	ListView_RemoveAllGroups(m_hListView);
+	m_directoryState.groups.clear();
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemSizeGroup(
-	const BasicItemInfo_t &itemInfo) const
-{
-	if ((itemInfo.wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_SIZE_FOLDERS),
-			0);
-	}
-	else if (!itemInfo.isFindDataValid)
+	ListView_EnableGroupView(m_hListView, true);
+
+	if (m_virtualListView)
 	{
-		return std::nullopt;
+		// Any group previously assigned to an item no longer exists.
+		for (int i = 0; i < m_listViewItemModel.GetCount(); i++)
+		{
+			m_listViewItemModel.SetGroupId(m_listViewItemModel.GetInternalIndexAt(i),
+				std::nullopt);
+		}
 	}
 
-	struct SizeGroup
+	if (GetGroupModeColumn(m_folderSettings.groupMode))
 	{
-		int nameResourceId;
-		uint64_t upperLimit;
-	};
-
-	// If the limits here are adjusted, the entries in the string table should be updated as well
-	// (since they reference the limits as well).
-	SizeGroup sizeGroups[] = { { IDS_GROUPBY_SIZE_EMPTY, 0 }, { IDS_GROUPBY_SIZE_TINY, 16 * KBYTE },
-		{ IDS_GROUPBY_SIZE_SMALL, MBYTE }, { IDS_GROUPBY_SIZE_MEDIUM, 128 * MBYTE },
-		{ IDS_GROUPBY_SIZE_LARGE, GBYTE }, { IDS_GROUPBY_SIZE_HUGE, 4 * GBYTE },
-		{ IDS_GROUPBY_SIZE_GIGANTIC, boost::integer_traits<uint64_t>::const_max } };
+		// Any item whose column text has already been retrieved can be placed into its group
+		// immediately. The remaining items will be moved out of the loading group as their text
+		// arrives.
+		ScopedRedrawDisabler redrawDisabler(m_hListView);
+		int numItems = ListView_GetItemCount(m_hListView);
 
-	ULARGE_INTEGER fileSize = { itemInfo.wfd.nFileSizeLow, itemInfo.wfd.nFileSizeHigh };
-	int currentIndex = 0;
+		for (int i = 0; i < numItems; i++)
+		{
+			InsertItemIntoGroup(i, DetermineItemGroup(GetItemInternalIndex(i)));
+		}
 
-	while (fileSize.QuadPart > sizeGroups[currentIndex].upperLimit
-		&& currentIndex < (std::size(sizeGroups) - 1))
-	{
-		currentIndex++;
+		return;
 	}
 
-	return GroupInfo(
-		ResourceHelper::LoadString(m_resourceInstance, sizeGroups[currentIndex].nameResourceId),
-		currentIndex + 1);
-}
-
-/* TODO: These groups have changed as of Windows Vista. */
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemTotalSizeGroup(
-	const BasicItemInfo_t &itemInfo) const
-{
-	IShellFolder *pShellFolder = nullptr;
-	PCITEMID_CHILD pidlRelative = nullptr;
-	const TCHAR *sizeGroups[] = { _T("Small"), _T("Medium"), _T("Huge"), _T("Gigantic") };
-	TCHAR szItem[MAX_PATH];
-	STRRET str;
-	ULARGE_INTEGER nTotalBytes;
-	ULARGE_INTEGER nFreeBytes;
-	BOOL bRoot;
-	BOOL bRes = FALSE;
-	ULARGE_INTEGER totalSizeGroupLimits[6];
-	int iSize = 0;
-	int i;
-
-	totalSizeGroupLimits[0].QuadPart = 0;
-	totalSizeGroupLimits[1].QuadPart = 0;
-	totalSizeGroupLimits[2].QuadPart = GBYTE;
-	totalSizeGroupLimits[3].QuadPart = 20 * totalSizeGroupLimits[2].QuadPart;
-	totalSizeGroupLimits[4].QuadPart = 100 * totalSizeGroupLimits[2].QuadPart;
-
-	SHBindToParent(itemInfo.pidlComplete.get(), IID_PPV_ARGS(&pShellFolder), &pidlRelative);
-
-	pShellFolder->GetDisplayNameOf(pidlRelative, SHGDN_FORPARSING, &str);
-	StrRetToBuf(&str, pidlRelative, szItem, std::size(szItem));
-
-	bRoot = PathIsRoot(szItem);
-
-	if (bRoot)
+	if (IsSlowGroupMode(m_folderSettings.groupMode))
 	{
-		bRes = GetDiskFreeSpaceEx(szItem, nullptr, &nTotalBytes, &nFreeBytes);
+		auto chunks = BuildGroupingChunks();
 
-		pShellFolder->Release();
+		// Determining the groups could take a significant amount of time, so the items are placed
+		// in a temporary group and moved to their actual groups as the results arrive.
+		int loadingGroupId = GetLoadingGroupId();
 
-		i = std::size(sizeGroups) - 1;
+		ScopedRedrawDisabler redrawDisabler(m_hListView);
 
-		while (nTotalBytes.QuadPart < totalSizeGroupLimits[i].QuadPart && i > 0)
+		for (const auto &chunk : chunks)
 		{
-			i--;
+			for (const auto &[internalIndex, index] : chunk)
+			{
+				InsertItemIntoGroup(index, loadingGroupId);
+				m_directoryState.pendingGroupItems.insert(internalIndex);
+			}
 		}
 
-		iSize = i;
-	}
+		for (auto &chunk : chunks)
+		{
+			int groupResultId = m_groupResultIDCounter++;
+			m_groupResults.insert(
+				{ groupResultId, QueueGroupingTask(std::move(chunk), groupResultId) });
+		}
 
-	if (!bRoot || !bRes)
-	{
-		return std::nullopt;
+		return;
 	}
 
-	return GroupInfo(sizeGroups[iSize], iSize);
-}
-
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemTypeGroupVirtual(
-	const BasicItemInfo_t &itemInfo) const
-{
-	SHFILEINFO shfi;
-	DWORD_PTR res = SHGetFileInfo((LPTSTR) itemInfo.pidlComplete.get(), 0, &shfi, sizeof(shfi),
-		SHGFI_PIDL | SHGFI_TYPENAME);
+	int numItems = ListView_GetItemCount(m_hListView);
+	std::vector<GroupResult> results;
+	results.reserve(numItems);
 
-	if (!res)
+	for (int i = 0; i < numItems; i++)
 	{
-		return std::nullopt;
+		int internalIndex = GetItemInternalIndex(i);
+		results.emplace_back(internalIndex, i,
+			DetermineItemGroupInfo(getBasicItemInfo(internalIndex), m_folderSettings.groupMode));
 	}
 
-	return GroupInfo(shfi.szTypeName);
+	ScopedRedrawDisabler redrawDisabler(m_hListView);
+	ApplyGroupResults(results);
 }
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemDateGroup(
-	const BasicItemInfo_t &itemInfo, GroupByDateType dateType) const
+// Splits the items in the listview into chunks of (internal index, index) pairs.
+std::vector<std::vector<std::pair<int, int>>> ShellBrowserImpl::BuildGroupingChunks() const
 {
-	if (!itemInfo.isFindDataValid)
-	{
-		return std::nullopt;
-	}
-
-	using namespace boost::gregorian;
-	using namespace boost::posix_time;
-
-	SYSTEMTIME stFileTime;
-	BOOL ret = FALSE;
-
-	switch (dateType)
-	{
-	case GroupByDateType::Modified:
-		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftLastWriteTime, &stFileTime);
-		break;
-
-	case GroupByDateType::Created:
-		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftCreationTime, &stFileTime);
-		break;
-
-	case GroupByDateType::Accessed:
-		ret = FileTimeToLocalSystemTime(&itemInfo.wfd.ftLastAccessTime, &stFileTime);
-		break;
-
-	default:
-		LOG(FATAL) << "Incorrect date type";
-	}
-
-	if (!ret)
-	{
-		return std::nullopt;
-	}
-
-	FILETIME localFileTime;
-	ret = SystemTimeToFileTime(&stFileTime, &localFileTime);
-
-	if (!ret)
-	{
-		return std::nullopt;
-	}
-
-	auto filePosixTime = from_ftime<ptime>(localFileTime);
-	date fileDate = filePosixTime.date();
-
-	date today = day_clock::local_day();
-	int relativeSortPosition = 0;
-
-	if (fileDate > today)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_FUTURE),
-			relativeSortPosition);
-	}
-
-	relativeSortPosition--;
-
-	if (fileDate == today)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_TODAY),
-			relativeSortPosition);
-	}
-
-	date yesterday = today - days(1);
-
-	relativeSortPosition--;
-
-	if (fileDate == yesterday)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_YESTERDAY),
-			relativeSortPosition);
-	}
-
-	// Note that this assumes that Sunday is the first day of the week.
-	unsigned short currentWeekday = today.day_of_week().as_number();
-	date startOfWeek = today - days(currentWeekday);
-
-	relativeSortPosition--;
-
-	if (fileDate >= startOfWeek)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_THIS_WEEK),
-			relativeSortPosition);
-	}
-
-	date startOfLastWeek = startOfWeek - weeks(1);
-
-	relativeSortPosition--;
-
-	if (fileDate >= startOfLastWeek)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_LAST_WEEK),
-			relativeSortPosition);
-	}
+	std::vector<std::vector<std::pair<int, int>>> chunks;
+	int numItems = ListView_GetItemCount(m_hListView);
 
-	date startOfMonth = date(today.year(), today.month(), 1);
-
-	relativeSortPosition--;
-
-	if (fileDate >= startOfMonth)
-	{
-		return GroupInfo(
-			ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_THIS_MONTH),
-			relativeSortPosition);
-	}
-
-	date startOfLastMonth = startOfMonth - months(1);
-
-	relativeSortPosition--;
-
-	if (fileDate >= startOfLastMonth)
-	{
-		return GroupInfo(
-			ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_LAST_MONTH),
-			relativeSortPosition);
-	}
-
-	date startOfYear = date(today.year(), 1, 1);
-
-	relativeSortPosition--;
-
-	if (fileDate >= startOfYear)
+	for (int i = 0; i < numItems; i++)
 	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_THIS_YEAR),
-			relativeSortPosition);
-	}
-
-	date startOfLastYear = startOfYear - years(1);
-
-	relativeSortPosition--;
+		if (chunks.empty() || chunks.back().size() == GROUPING_CHUNK_SIZE)
+		{
+			chunks.emplace_back().reserve(GROUPING_CHUNK_SIZE);
+		}
 
-	if (fileDate >= startOfLastYear)
-	{
-		return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_LAST_YEAR),
-			relativeSortPosition);
+		chunks.back().emplace_back(GetItemInternalIndex(i), i);
 	}
 
-	relativeSortPosition--;
-
-	return GroupInfo(ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_DATE_LONG_AGO),
-		relativeSortPosition);
+	return chunks;
 }
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemSummaryGroup(
-	const BasicItemInfo_t &itemInfo, const SHCOLUMNID *pscid,
-	const GlobalFolderSettings &globalFolderSettings) const
+// Queues a task that determines the group for each of the specified items. A message will be posted
+// to the listview once the results are available.
+std::future<std::vector<ShellBrowserImpl::GroupResult>> ShellBrowserImpl::QueueGroupingTask(
+	std::vector<std::pair<int, int>> items, int groupResultId)
 {
-	TCHAR szDetail[512];
-	HRESULT hr =
-		GetItemDetails(itemInfo, pscid, szDetail, std::size(szDetail), globalFolderSettings);
+	// The item information is copied here, since the items can be modified on the UI thread while
+	// the task is running.
+	std::vector<BasicItemInfo_t> basicItemInfos;
+	basicItemInfos.reserve(items.size());
 
-	if (SUCCEEDED(hr) && lstrlen(szDetail) > 0)
+	for (const auto &[internalIndex, index] : items)
 	{
-		return GroupInfo(szDetail);
-	}
-	else
-	{
-		return std::nullopt;
+		basicItemInfos.push_back(getBasicItemInfo(internalIndex));
 	}
-}
-
-/* TODO: Need to sort based on percentage free. */
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemFreeSpaceGroup(
-	const BasicItemInfo_t &itemInfo) const
-{
-	TCHAR szFreeSpace[MAX_PATH];
-	IShellFolder *pShellFolder = nullptr;
-	PCITEMID_CHILD pidlRelative = nullptr;
-	STRRET str;
-	TCHAR szItem[MAX_PATH];
-	ULARGE_INTEGER nTotalBytes;
-	ULARGE_INTEGER nFreeBytes;
-	BOOL bRoot;
-	BOOL bRes = FALSE;
-
-	SHBindToParent(itemInfo.pidlComplete.get(), IID_PPV_ARGS(&pShellFolder), &pidlRelative);
 
-	pShellFolder->GetDisplayNameOf(pidlRelative, SHGDN_FORPARSING, &str);
-	StrRetToBuf(&str, pidlRelative, szItem, std::size(szItem));
-
-	pShellFolder->Release();
+	return m_groupTaskGroup.Push(
+		[this, listView = m_hListView, groupResultId, groupMode = m_folderSettings.groupMode,
+			items = std::move(items), basicItemInfos = std::move(basicItemInfos)](
+			std::stop_token stopToken)
+		{
+			std::vector<GroupResult> results;
+			results.reserve(items.size());
 
-	bRoot = PathIsRoot(szItem);
+			for (size_t i = 0; i < items.size(); i++)
+			{
+				if (stopToken.stop_requested())
+				{
+					break;
+				}
 
-	if (bRoot)
-	{
-		bRes = GetDiskFreeSpaceEx(szItem, nullptr, &nTotalBytes, &nFreeBytes);
+				results.emplace_back(items[i].first, items[i].second,
+					DetermineItemGroupInfo(basicItemInfos[i], groupMode));
+			}
 
-		LARGE_INTEGER lDiv1;
-		LARGE_INTEGER lDiv2;
+			PostMessage(listView, WM_APP_GROUP_RESULTS_READY, groupResultId, 0);
 
-		lDiv1.QuadPart = 100;
-		lDiv2.QuadPart = 10;
-
-		/* Divide by 10 to remove the one's digit, then multiply
-		by 10 so that only the ten's digit rmains. */
-		StringCchPrintf(szFreeSpace, std::size(szFreeSpace), _T("%I64d%% free"),
-			(((nFreeBytes.QuadPart * lDiv1.QuadPart) / nTotalBytes.QuadPart) / lDiv2.QuadPart)
-				* lDiv2.QuadPart);
-	}
-
-	if (!bRoot || !bRes)
-	{
-		return std::nullopt;
-	}
-
-	return GroupInfo(szFreeSpace);
+			return results;
+		});
 }
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemAttributeGroup(
-	const BasicItemInfo_t &itemInfo) const
+void ShellBrowserImpl::ProcessGroupResults(int groupResultId)
 {
-	if (!itemInfo.isFindDataValid)
-	{
-		return std::nullopt;
-	}
-
-	auto attributesString = BuildFileAttributesString(itemInfo.wfd.dwFileAttributes);
-	return GroupInfo(attributesString);
-}
-
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemOwnerGroup(
-	const BasicItemInfo_t &itemInfo) const
-{
-	std::wstring fullFileName = itemInfo.getFullPath();
-
-	TCHAR szOwner[512];
-	BOOL ret = GetFileOwner(fullFileName.c_str(), szOwner, std::size(szOwner));
+	auto itr = m_groupResults.find(groupResultId);
 
-	if (!ret)
+	if (itr == m_groupResults.end())
 	{
-		return std::nullopt;
+		return;
 	}
 
-	return GroupInfo(szOwner);
-}
+	auto results = itr->second.get();
+	m_groupResults.erase(itr);
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemVersionGroup(
-	const BasicItemInfo_t &itemInfo, const TCHAR *szVersionType) const
-{
-	std::wstring fullFileName = itemInfo.getFullPath();
+	// Items that have been regrouped since the task was queued, or that have been removed, will no
+	// longer be pending.
+	std::erase_if(results,
+		[this](const GroupResult &result)
+		{ return m_directoryState.pendingGroupItems.erase(result.internalIndex) == 0; });
 
-	TCHAR szVersion[512];
-	BOOL bVersionInfoObtained = GetVersionInfoString(fullFileName.c_str(), szVersionType, szVersion,
-		static_cast<UINT>(std::size(szVersion)));
+	ApplyGroupResults(results);
 
-	if (!bVersionInfoObtained)
+	// A virtual listview orders items by group, so the items can only be put into their final
+	// positions once every group is known.
+	if (m_virtualListView && m_directoryState.pendingGroupItems.empty())
 	{
-		return std::nullopt;
+		SortFolder();
 	}
-
-	return GroupInfo(szVersion);
 }
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemCameraPropertyGroup(
-	const BasicItemInfo_t &itemInfo, PROPID PropertyId) const
+void ShellBrowserImpl::ApplyGroupResults(const std::vector<GroupResult> &results)
 {
-	std::wstring fullFileName = itemInfo.getFullPath();
-
-	TCHAR szProperty[512];
-	BOOL bRes = ReadImageProperty(fullFileName.c_str(), PropertyId, szProperty,
-		static_cast<int>(std::size(szProperty)));
+	auto unspecifiedGroupInfo = GroupInfo(
+		ResourceHelper::LoadString(m_resourceInstance, IDS_GROUPBY_UNSPECIFIED), INT_MIN);
 
-	if (!bRes)
+	for (const auto &result : results)
 	{
-		return std::nullopt;
-	}
+		std::optional<int> index;
 
-	return GroupInfo(szProperty);
-}
-
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemExtensionGroup(
-	const BasicItemInfo_t &itemInfo) const
-{
-	if (WI_IsFlagSet(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY))
-	{
-		return std::nullopt;
-	}
+		if (result.indexHint < ListView_GetItemCount(m_hListView)
+			&& GetItemInternalIndex(result.indexHint) == result.internalIndex)
+		{
+			index = result.indexHint;
+		}
+		else
+		{
+			index = LocateItemByInternalIndex(result.internalIndex);
+		}
 
-	std::wstring fullFileName = itemInfo.getFullPath();
-	TCHAR *pExt = PathFindExtension(fullFileName.c_str());
+		if (!index)
+		{
+			continue;
+		}
 
-	if (*pExt == '\0')
-	{
-		return std::nullopt;
+		int groupId = GetOrCreateListViewGroup(
+			result.groupInfo ? *result.groupInfo : unspecifiedGroupInfo);
+		InsertItemIntoGroup(*index, groupId);
 	}
-
-	return GroupInfo(pExt);
 }
 
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemFileSystemGroup(
-	const BasicItemInfo_t &itemInfo) const
+void ShellBrowserImpl::CancelGroupingTasks()
 {
-	std::wstring fullPath = itemInfo.getFullPath();
-	BOOL isRoot = PathIsRoot(fullPath.c_str());
-
-	if (!isRoot)
-	{
-		return std::nullopt;
-	}
-
-	TCHAR fileSystemName[MAX_PATH];
-	BOOL res = GetVolumeInformation(fullPath.c_str(), nullptr, 0, nullptr, nullptr, nullptr,
-		fileSystemName, std::size(fileSystemName));
-
-	if (!res)
-	{
-		return std::nullopt;
-	}
-
-	return GroupInfo(fileSystemName);
+	m_groupTaskGroup.CancelPendingTasks();
+	m_groupResults.clear();
+	m_directoryState.pendingGroupItems.clear();
 }
 
-/* TODO: Fix. Need to check for each adapter. */
-std::optional<ShellBrowserImpl::GroupInfo> ShellBrowserImpl::DetermineItemNetworkStatus(
-	const BasicItemInfo_t &itemInfo) const
+// Column tasks can be cancelled independently of grouping (e.g. when switching out of the details
+// view), in which case the tasks for any items still waiting on their group need to be requeued.
+void ShellBrowserImpl::QueuePendingGroupColumnTasks()
 {
-	/* When this function is
-	properly implemented, this
-	can be removed. */
-	UNREFERENCED_PARAMETER(itemInfo);
-
-	TCHAR szStatus[32] = L"";
-	IP_ADAPTER_ADDRESSES *pAdapterAddresses = nullptr;
-	UINT uStatusID = 0;
-	ULONG ulOutBufLen = 0;
+	auto columnType = GetGroupModeColumn(m_folderSettings.groupMode);
 
-	GetAdaptersAddresses(AF_UNSPEC, 0, nullptr, nullptr, &ulOutBufLen);
-
-	pAdapterAddresses = (IP_ADAPTER_ADDRESSES *) malloc(ulOutBufLen);
-
-	GetAdaptersAddresses(AF_UNSPEC, 0, nullptr, pAdapterAddresses, &ulOutBufLen);
-
-	/* TODO: These strings need to be setup correctly. */
-	/*switch(pAdapterAddresses->OperStatus)
+	if (!columnType)
 	{
-		case IfOperStatusUp:
-			uStatusID = IDS_NETWORKADAPTER_CONNECTED;
-			break;
-
-		case IfOperStatusDown:
-			uStatusID = IDS_NETWORKADAPTER_DISCONNECTED;
-			break;
-
-		case IfOperStatusTesting:
-			uStatusID = IDS_NETWORKADAPTER_TESTING;
-			break;
-
-		case IfOperStatusUnknown:
-			uStatusID = IDS_NETWORKADAPTER_UNKNOWN;
-			break;
-
-		case IfOperStatusDormant:
-			uStatusID = IDS_NETWORKADAPTER_DORMANT;
-			break;
-
-		case IfOperStatusNotPresent:
-			uStatusID = IDS_NETWORKADAPTER_NOTPRESENT;
-			break;
-
-		case IfOperStatusLowerLayerDown:
-			uStatusID = IDS_NETWORKADAPTER_LOWLAYER;
-			break;
-	}*/
-
-	LoadString(m_resourceInstance, uStatusID, szStatus, std::size(szStatus));
-
-	return GroupInfo(szStatus);
-}
-
-void ShellBrowserImpl::MoveItemsIntoGroups()
-{
-	LVITEM item;
-	int nItems;
-	int iGroupId;
-	int i = 0;
-
-	ListView_RemoveAllGroups(m_hListView);
-	m_directoryState.groups.clear();
-
-	ListView_EnableGroupView(m_hListView, true);
-
-	nItems = ListView_GetItemCount(m_hListView);
-
-	SendMessage(m_hListView, WM_SETREDRAW, FALSE, NULL);
+		return;
+	}
 
-	for (i = 0; i < nItems; i++)
+	for (int internalIndex : m_directoryState.pendingGroupItems)
 	{
-		item.mask = LVIF_PARAM;
-		item.iItem = i;
-		item.iSubItem = 0;
-		ListView_GetItem(m_hListView, &item);
-
-		iGroupId = DetermineItemGroup((int) item.lParam);
-
-		InsertItemIntoGroup(i, iGroupId);
+		QueueColumnTask(internalIndex, *columnType);
 	}
-
-	SendMessage(m_hListView, WM_SETREDRAW, TRUE, NULL);
 }
 
 void ShellBrowserImpl::InsertItemIntoGroup(int index, int groupId)
@@ -858,12 +440,22 @@ void ShellBrowserImpl::InsertItemIntoGroup(int index, int groupId)
 
 	EnsureGroupExistsInListView(groupId);
 
-	LVITEM item;
-	item.mask = LVIF_GROUPID;
-	item.iItem = index;
-	item.iSubItem = 0;
-	item.iGroupId = groupId;
-	BOOL res = ListView_SetItem(m_hListView, &item);
+	BOOL res;
+
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.SetGroupId(GetItemInternalIndex(index), groupId);
+		res = TRUE;
+	}
+	else
+	{
+		LVITEM item;
+		item.mask = LVIF_GROUPID;
+		item.iItem = index;
+		item.iSubItem = 0;
+		item.iGroupId = groupId;
+		res = ListView_SetItem(m_hListView, &item);
+	}
 
 	if (res)
 	{
@@ -888,6 +480,13 @@ void ShellBrowserImpl::EnsureGroupExistsInListView(int groupId)
 
 void ShellBrowserImpl::InsertGroupIntoListView(const ListViewGroup &listViewGroup)
 {
+	// Groups are only tracked internally when using a virtual listview, since the control itself
+	// doesn't support them.
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	std::wstring header = GenerateGroupHeader(listViewGroup);
 
 	LVINSERTGROUPSORTED lvigs;
@@ -904,11 +503,21 @@ void ShellBrowserImpl::InsertGroupIntoListView(const ListViewGroup &listViewGrou
 
 void ShellBrowserImpl::RemoveGroupFromListView(const ListViewGroup &listViewGroup)
 {
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	ListView_RemoveGroup(m_hListView, listViewGroup.id);
 }
 
 void ShellBrowserImpl::UpdateGroupHeader(const ListViewGroup &listViewGroup)
 {
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	std::wstring header = GenerateGroupHeader(listViewGroup);
 
 	LVGROUP lvGroup;
@@ -958,6 +567,11 @@ void ShellBrowserImpl::OnItemAddedToGroup(int groupId)
 
 std::optional<int> ShellBrowserImpl::GetItemGroupId(int index)
 {
+	if (m_virtualListView)
+	{
+		return m_listViewItemModel.GetGroupId(GetItemInternalIndex(index));
+	}
+
 	LVITEM item;
 	item.mask = LVIF_GROUPID;
 	item.iItem = index;
@@ -31,7 +31,7 @@ void ShellBrowserImpl::SetupThumbnailsView(int shellImageListType)
 
 void ShellBrowserImpl::RemoveThumbnailsView()
 {
-	m_thumbnailThreadPool.clear_queue();
+	m_thumbnailTaskGroup.CancelPendingTasks();
 	m_thumbnailResults.clear();
 
 	InvalidateAllItemImages();
@@ -44,6 +44,13 @@ void ShellBrowserImpl::RemoveThumbnailsView()
 
 void ShellBrowserImpl::InvalidateAllItemImages()
 {
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.ResetAllImages();
+		InvalidateRect(m_hListView, nullptr, FALSE);
+		return;
+	}
+
 	int numItems = ListView_GetItemCount(m_hListView);
 
 	for (int i = 0; i < numItems; i++)
@@ -63,12 +70,10 @@ void ShellBrowserImpl::QueueThumbnailTask(int internalIndex)
 
 	BasicItemInfo_t basicItemInfo = getBasicItemInfo(internalIndex);
 
-	auto result = m_thumbnailThreadPool.push(
+	auto result = m_thumbnailTaskGroup.Push(
 		[listView = m_hListView, thumbnailResultID, internalIndex, basicItemInfo,
-			thumbnailSize = m_thumbnailItemWidth](int id) -> std::optional<ThumbnailResult_t>
+			thumbnailSize = m_thumbnailItemWidth]() -> std::optional<ThumbnailResult_t>
 		{
-			UNREFERENCED_PARAMETER(id);
-
 			auto bitmap = GetThumbnail(basicItemInfo.pidlComplete.get(), thumbnailSize,
 				WTS_EXTRACT | WTS_SCALETOREQUESTEDSIZE);
 
@@ -176,6 +181,14 @@ void ShellBrowserImpl::ProcessThumbnailResult(int thumbnailResultId)
 		return;
 	}
 
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.SetImage(result->itemInternalIndex, imageIndex,
+			m_listViewItemModel.GetOverlay(result->itemInternalIndex));
+		ListView_RedrawItems(m_hListView, *index, *index);
+		return;
+	}
+
 	LVITEM lvItem;
 	lvItem.mask = LVIF_IMAGE;
 	lvItem.iItem = *index;
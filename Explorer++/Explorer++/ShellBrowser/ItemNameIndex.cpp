@@ -0,0 +1,98 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ItemNameIndex.h"
+
+void ItemNameIndex::AddItem(int internalIndex, const std::wstring &parsingName)
+{
+	// If the item is already present (e.g. because it's been renamed), its previous name will be
+	// replaced.
+	RemoveItem(internalIndex);
+
+	m_entries.insert({ internalIndex, NormalizeName(GetItemName(parsingName)) });
+}
+
+void ItemNameIndex::RemoveItem(int internalIndex)
+{
+	m_entries.get<0>().erase(internalIndex);
+}
+
+void ItemNameIndex::Clear()
+{
+	m_entries.clear();
+}
+
+std::vector<int> ItemNameIndex::FindItems(const std::wstring &parsingName) const
+{
+	std::vector<int> internalIndexes;
+	auto range = m_entries.get<1>().equal_range(NormalizeName(GetItemName(parsingName)));
+
+	for (auto itr = range.first; itr != range.second; ++itr)
+	{
+		internalIndexes.push_back(itr->internalIndex);
+	}
+
+	return internalIndexes;
+}
+
+size_t ItemNameIndex::GetSize() const
+{
+	return m_entries.size();
+}
+
+// Returns the final component of the parsing name, ignoring any trailing separators (e.g. the
+// name for "C:\\" is "C:"). If the name doesn't contain any separators, the whole name is used.
+std::wstring_view ItemNameIndex::GetItemName(std::wstring_view parsingName)
+{
+	auto trimmedName = parsingName;
+
+	while (!trimmedName.empty() && trimmedName.back() == '\\')
+	{
+		trimmedName.remove_suffix(1);
+	}
+
+	if (trimmedName.empty())
+	{
+		return parsingName;
+	}
+
+	auto separatorPosition = trimmedName.rfind('\\');
+
+	if (separatorPosition == std::wstring_view::npos)
+	{
+		return trimmedName;
+	}
+
+	return trimmedName.substr(separatorPosition + 1);
+}
+
+// Short names are generated by truncating the long name and appending a '~' followed by a number,
+// so a name without a '~' can't be a short name.
+bool ItemNameIndex::MayBeShortName(std::wstring_view itemName)
+{
+	return itemName.find('~') != std::wstring_view::npos;
+}
+
+std::wstring ItemNameIndex::NormalizeName(std::wstring_view itemName)
+{
+	if (itemName.empty())
+	{
+		return std::wstring(itemName);
+	}
+
+	std::wstring normalizedName(itemName.size(), '\0');
+	int res = LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_UPPERCASE, itemName.data(),
+		static_cast<int>(itemName.size()), normalizedName.data(),
+		static_cast<int>(normalizedName.size()), nullptr, nullptr, 0);
+
+	if (res == 0)
+	{
+		return std::wstring(itemName);
+	}
+
+	normalizedName.resize(res);
+
+	return normalizedName;
+}
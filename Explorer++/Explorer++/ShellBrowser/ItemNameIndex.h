@@ -0,0 +1,103 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index_container.hpp>
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Maps the name of each item in a folder to the item's internal index, so that an item can be found
+// without having to compare it against every other item in the folder.
+//
+// Items are keyed on the final component of their parsing name (i.e. their name within the
+// parent folder), rather than the full parsing name, since the same item can be reached through
+// different parents (e.g. through an alias or a library), which only changes the earlier
+// components. Names are matched case-insensitively. Since multiple items could, in theory, have
+// names that only differ by case, a lookup can return more than one item and it's up to the caller
+// to determine which (if any) of the returned items is the correct one.
+class ItemNameIndex
+{
+public:
+	void AddItem(int internalIndex, const std::wstring &parsingName);
+	void RemoveItem(int internalIndex);
+	void Clear();
+
+	std::vector<int> FindItems(const std::wstring &parsingName) const;
+
+	// Returns the first item for which isEquivalent returns true. Only the items indexed under the
+	// parsing name are checked, so a miss doesn't require any other items to be examined. The one
+	// exception is a name that may be a short (8.3) name, since an equivalent item will have been
+	// indexed under its long name. In that case, or if no parsing name is available, every other
+	// item is checked as well.
+	template <typename Predicate>
+	std::optional<int> FindEquivalentItem(const std::optional<std::wstring> &parsingName,
+		Predicate isEquivalent) const
+	{
+		std::vector<int> checkedItems;
+
+		if (parsingName)
+		{
+			checkedItems = FindItems(*parsingName);
+
+			for (int internalIndex : checkedItems)
+			{
+				if (isEquivalent(internalIndex))
+				{
+					return internalIndex;
+				}
+			}
+
+			if (!MayBeShortName(GetItemName(*parsingName)))
+			{
+				return std::nullopt;
+			}
+		}
+
+		for (const auto &entry : m_entries.get<0>())
+		{
+			if (std::find(checkedItems.begin(), checkedItems.end(), entry.internalIndex)
+					== checkedItems.end()
+				&& isEquivalent(entry.internalIndex))
+			{
+				return entry.internalIndex;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	size_t GetSize() const;
+
+private:
+	struct Entry
+	{
+		int internalIndex;
+		std::wstring normalizedName;
+	};
+
+	// clang-format off
+	using EntrySet = boost::multi_index_container<Entry,
+		boost::multi_index::indexed_by<
+			boost::multi_index::hashed_unique<
+				boost::multi_index::member<Entry, int, &Entry::internalIndex>
+			>,
+			boost::multi_index::hashed_non_unique<
+				boost::multi_index::member<Entry, std::wstring, &Entry::normalizedName>
+			>
+		>
+	>;
+	// clang-format on
+
+	static std::wstring_view GetItemName(std::wstring_view parsingName);
+	static bool MayBeShortName(std::wstring_view itemName);
+	static std::wstring NormalizeName(std::wstring_view itemName);
+
+	EntrySet m_entries;
+};
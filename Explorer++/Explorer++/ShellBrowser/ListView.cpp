@@ -118,8 +118,17 @@ LRESULT ShellBrowserImpl::ListViewProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPAR
 		OnClipboardUpdate();
 		return 0;
 
+	case WM_TIMER:
+		if (wParam == COLUMN_RESULTS_TIMER_ID)
+		{
+			KillTimer(hwnd, COLUMN_RESULTS_TIMER_ID);
+			ProcessColumnResults();
+			return 0;
+		}
+		break;
+
 	case WM_APP_COLUMN_RESULT_READY:
-		ProcessColumnResult(static_cast<int>(wParam));
+		ProcessColumnResults();
 		break;
 
 	case WM_APP_THUMBNAIL_RESULT_READY:
@@ -129,6 +138,14 @@ LRESULT ShellBrowserImpl::ListViewProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPAR
 	case WM_APP_INFO_TIP_READY:
 		ProcessInfoTipResult(static_cast<int>(wParam));
 		break;
+
+	case WM_APP_GROUP_RESULTS_READY:
+		ProcessGroupResults(static_cast<int>(wParam));
+		break;
+
+	case WM_APP_SELECTION_CHANGED:
+		OnSelectionChangedNotification();
+		break;
 	}
 
 	return DefSubclassProc(hwnd, uMsg, wParam, lParam);
@@ -169,6 +186,17 @@ LRESULT ShellBrowserImpl::ListViewParentProc(HWND hwnd, UINT uMsg, WPARAM wParam
 				OnListViewItemChanged(reinterpret_cast<NMLISTVIEW *>(lParam));
 				break;
 
+			case LVN_ODSTATECHANGED:
+				OnVirtualListViewItemRangeChanged(reinterpret_cast<NMLVODSTATECHANGE *>(lParam));
+				break;
+
+			case LVN_ODFINDITEM:
+				return OnVirtualListViewFindItem(reinterpret_cast<NMLVFINDITEM *>(lParam));
+
+			case LVN_ENDSCROLL:
+				UpdateColumnTaskPriorities();
+				break;
+
 			case LVN_KEYDOWN:
 				OnListViewKeyDown(reinterpret_cast<NMLVKEYDOWN *>(lParam));
 				break;
@@ -348,8 +376,36 @@ void ShellBrowserImpl::OnListViewGetDisplayInfo(LPARAM lParam)
 	pnmv = (NMLVDISPINFO *) lParam;
 	plvItem = &pnmv->item;
 
+	if (m_virtualListView)
+	{
+		OnVirtualListViewGetDisplayInfo(plvItem);
+		return;
+	}
+
 	int internalIndex = static_cast<int>(plvItem->lParam);
 
+	if (m_folderSettings.viewMode == +ViewMode::Details && (plvItem->mask & LVIF_TEXT) == LVIF_TEXT)
+	{
+		auto columnType = GetColumnTypeByIndex(plvItem->iSubItem);
+		CHECK(columnType);
+
+		QueueColumnTask(internalIndex, *columnType);
+	}
+
+	if ((plvItem->mask & LVIF_IMAGE) == LVIF_IMAGE)
+	{
+		plvItem->iImage = GetInitialItemImage(internalIndex);
+	}
+
+	plvItem->mask |= LVIF_DI_SETITEM;
+}
+
+// Returns the image that will be shown for the item until its actual icon (or thumbnail) has been
+// retrieved. The retrieval of the actual image is queued here as well.
+int ShellBrowserImpl::GetInitialItemImage(int internalIndex)
+{
+	const ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
+
 	/* Construct an image here using the items
 	actual icon. This image will be shown initially.
 	If the item also has a thumbnail image, this
@@ -359,70 +415,66 @@ void ShellBrowserImpl::OnListViewGetDisplayInfo(LPARAM lParam)
 	first, or else it may be possible for the
 	thumbnail to be drawn before the initial
 	image. */
-	if (IsThumbnailsViewMode(m_folderSettings.viewMode)
-		&& (plvItem->mask & LVIF_IMAGE) == LVIF_IMAGE)
+	if (IsThumbnailsViewMode(m_folderSettings.viewMode))
 	{
-		const ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
+		int imageIndex;
 		auto cachedThumbnailIndex = GetCachedThumbnailIndex(itemInfo);
 
 		if (cachedThumbnailIndex)
 		{
-			plvItem->iImage = *cachedThumbnailIndex;
+			imageIndex = *cachedThumbnailIndex;
 		}
 		else
 		{
-			plvItem->iImage = GetIconThumbnail(internalIndex);
+			imageIndex = GetIconThumbnail(internalIndex);
 		}
 
-		plvItem->mask |= LVIF_DI_SETITEM;
-
 		QueueThumbnailTask(internalIndex);
 
-		return;
+		return imageIndex;
 	}
 
-	if (m_folderSettings.viewMode == +ViewMode::Details && (plvItem->mask & LVIF_TEXT) == LVIF_TEXT)
-	{
-		auto columnType = GetColumnTypeByIndex(plvItem->iSubItem);
-		CHECK(columnType);
+	int imageIndex;
+	auto cachedIconIndex = m_cachedIcons->MaybeGetIconIndex(itemInfo.parsingName);
 
-		QueueColumnTask(internalIndex, *columnType);
+	if (cachedIconIndex)
+	{
+		// Note that only the icon is set here. Any overlay will be added by the icon retrieval
+		// task (scheduled below).
+		imageIndex = *cachedIconIndex;
 	}
-
-	if ((plvItem->mask & LVIF_IMAGE) == LVIF_IMAGE)
+	else
 	{
-		const ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
-		auto cachedIconIndex = m_cachedIcons->MaybeGetIconIndex(itemInfo.parsingName);
-
-		if (cachedIconIndex)
+		if ((itemInfo.wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
 		{
-			// Note that only the icon is set here. Any overlay will be added by the icon retrieval
-			// task (scheduled below).
-			plvItem->iImage = *cachedIconIndex;
+			imageIndex = m_iFolderIcon;
 		}
 		else
 		{
-			if ((itemInfo.wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-				== FILE_ATTRIBUTE_DIRECTORY)
-			{
-				plvItem->iImage = m_iFolderIcon;
-			}
-			else
-			{
-				plvItem->iImage = m_iFileIcon;
-			}
+			imageIndex = m_iFileIcon;
 		}
-
-		m_iconFetcher->QueueIconTask(itemInfo.pidlComplete.Raw(),
-			[this, internalIndex](int iconIndex, int overlayIndex)
-			{ ProcessIconResult(internalIndex, iconIndex, overlayIndex); });
 	}
 
-	plvItem->mask |= LVIF_DI_SETITEM;
+	m_iconFetcher->QueueIconTask(itemInfo.pidlComplete.Raw(),
+		[this, internalIndex](int iconIndex, int overlayIndex)
+		{ ProcessIconResult(internalIndex, iconIndex, overlayIndex); });
+
+	return imageIndex;
 }
 
 void ShellBrowserImpl::ProcessIconResult(int internalIndex, int iconIndex, int overlayIndex)
 {
+	if (m_virtualListView)
+	{
+		if (m_listViewItemModel.HasItem(internalIndex))
+		{
+			m_listViewItemModel.SetImage(internalIndex, iconIndex, overlayIndex);
+			RedrawVirtualListViewItem(internalIndex);
+		}
+
+		return;
+	}
+
 	auto index = LocateItemByInternalIndex(internalIndex);
 
 	if (!index)
@@ -472,12 +524,12 @@ void ShellBrowserImpl::QueueInfoTipTask(int internalIndex, const std::wstring &e
 	Config configCopy = *m_config;
 	bool virtualFolder = InVirtualFolder();
 
-	auto result = m_infoTipsThreadPool.push(
+	// Info tips are only requested when the user hovers over an item, so they're run ahead of
+	// other background work.
+	auto result = m_infoTipsTaskGroup.Push(
 		[this, infoTipResultId, internalIndex, basicItemInfo, configCopy, virtualFolder,
-			existingInfoTip](int id)
+			existingInfoTip]
 		{
-			UNREFERENCED_PARAMETER(id);
-
 			auto result = GetInfoTipAsync(m_hListView, infoTipResultId, internalIndex,
 				basicItemInfo, configCopy, m_resourceInstance, virtualFolder);
 
@@ -491,7 +543,8 @@ void ShellBrowserImpl::QueueInfoTipTask(int internalIndex, const std::wstring &e
 			}
 
 			return result;
-		});
+		},
+		TaskPriority::High);
 
 	m_infoTipResults.insert({ infoTipResultId, std::move(result) });
 }
@@ -593,6 +646,12 @@ void ShellBrowserImpl::OnListViewItemInserted(const NMLISTVIEW *itemData)
 
 void ShellBrowserImpl::OnListViewItemChanged(const NMLISTVIEW *changeData)
 {
+	if (m_virtualListView)
+	{
+		OnVirtualListViewItemChanged(changeData);
+		return;
+	}
+
 	if (changeData->uChanged != LVIF_STATE)
 	{
 		return;
@@ -624,48 +683,47 @@ void ShellBrowserImpl::OnListViewItemChanged(const NMLISTVIEW *changeData)
 		}
 	}
 
-	UpdateFileSelectionInfo(static_cast<int>(changeData->lParam), currentlySelected);
+	m_directoryState.selectionTracker.SetSelected(static_cast<int>(changeData->lParam),
+		currentlySelected);
 
-	listViewSelectionChanged.m_signal();
+	QueueSelectionChangedNotification();
 }
 
-void ShellBrowserImpl::UpdateFileSelectionInfo(int internalIndex, BOOL selected)
+void ShellBrowserImpl::AddTrackedItem(int internalIndex)
 {
-	ULARGE_INTEGER ulFileSize;
-	BOOL isFolder;
-
-	isFolder = (m_itemInfoMap.at(internalIndex).wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-		== FILE_ATTRIBUTE_DIRECTORY;
+	const auto &itemInfo = m_itemInfoMap.at(internalIndex);
+	ULARGE_INTEGER fileSize = { itemInfo.wfd.nFileSizeLow, itemInfo.wfd.nFileSizeHigh };
+	m_directoryState.selectionTracker.AddItem(internalIndex,
+		WI_IsFlagSet(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY), fileSize.QuadPart);
+}
 
-	ulFileSize.LowPart = m_itemInfoMap.at(internalIndex).wfd.nFileSizeLow;
-	ulFileSize.HighPart = m_itemInfoMap.at(internalIndex).wfd.nFileSizeHigh;
+void ShellBrowserImpl::UpdateTrackedItem(int internalIndex)
+{
+	const auto &itemInfo = m_itemInfoMap.at(internalIndex);
+	ULARGE_INTEGER fileSize = { itemInfo.wfd.nFileSizeLow, itemInfo.wfd.nFileSizeHigh };
+	m_directoryState.selectionTracker.UpdateItem(internalIndex,
+		WI_IsFlagSet(itemInfo.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY), fileSize.QuadPart);
+}
 
-	if (selected)
+// Selecting all the items in a large folder results in one LVN_ITEMCHANGED notification per item.
+// Updating the selection totals for each item is cheap, but there's no need for observers to be
+// notified of each individual change. So, rather than signaling once per item, a message is posted
+// and the signal is only sent once the current batch of notifications has been processed.
+void ShellBrowserImpl::QueueSelectionChangedNotification()
+{
+	if (m_selectionChangedNotificationQueued)
 	{
-		if (isFolder)
-		{
-			m_directoryState.numFoldersSelected++;
-		}
-		else
-		{
-			m_directoryState.numFilesSelected++;
-		}
-
-		m_directoryState.fileSelectionSize += ulFileSize.QuadPart;
+		return;
 	}
-	else
-	{
-		if (isFolder)
-		{
-			m_directoryState.numFoldersSelected--;
-		}
-		else
-		{
-			m_directoryState.numFilesSelected--;
-		}
 
-		m_directoryState.fileSelectionSize -= ulFileSize.QuadPart;
-	}
+	m_selectionChangedNotificationQueued = true;
+	PostMessage(m_hListView, WM_APP_SELECTION_CHANGED, 0, 0);
+}
+
+void ShellBrowserImpl::OnSelectionChangedNotification()
+{
+	m_selectionChangedNotificationQueued = false;
+	listViewSelectionChanged.m_signal();
 }
 
 void ShellBrowserImpl::OnListViewKeyDown(const NMLVKEYDOWN *lvKeyDown)
@@ -691,7 +749,7 @@ void ShellBrowserImpl::OnListViewKeyDown(const NMLVKEYDOWN *lvKeyDown)
 	case 'I':
 		if (IsKeyDown(VK_CONTROL) && !IsKeyDown(VK_SHIFT) && !IsKeyDown(VK_MENU))
 		{
-			ListViewHelper::InvertSelection(m_hListView);
+			InvertSelection();
 			SetFocus(m_hListView);
 		}
 		break;
@@ -752,6 +810,11 @@ ShellBrowserImpl::ItemInfo_t &ShellBrowserImpl::GetItemByIndex(int index)
 
 int ShellBrowserImpl::GetItemInternalIndex(int item) const
 {
+	if (m_virtualListView)
+	{
+		return m_listViewItemModel.GetInternalIndexAt(item);
+	}
+
 	LVITEM lvItem;
 	lvItem.mask = LVIF_PARAM;
 	lvItem.iItem = item;
@@ -772,6 +835,18 @@ void ShellBrowserImpl::MarkItemAsCut(int item, bool cut)
 		return;
 	}
 
+	SetItemCutState(item, cut);
+}
+
+void ShellBrowserImpl::SetItemCutState(int item, bool cut)
+{
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.SetCut(GetItemInternalIndex(item), cut);
+		ListView_RedrawItems(m_hListView, item, item);
+		return;
+	}
+
 	if (cut)
 	{
 		ListView_SetItemState(m_hListView, item, LVIS_CUT, LVIS_CUT);
@@ -782,6 +857,18 @@ void ShellBrowserImpl::MarkItemAsCut(int item, bool cut)
 	}
 }
 
+void ShellBrowserImpl::DeleteListViewItem(int item)
+{
+	if (m_virtualListView)
+	{
+		m_listViewItemModel.RemoveItem(GetItemInternalIndex(item));
+		UpdateVirtualListViewItemCount();
+		return;
+	}
+
+	ListView_DeleteItem(m_hListView, item);
+}
+
 void ShellBrowserImpl::ShowPropertiesForSelectedFiles() const
 {
 	std::vector<unique_pidl_child> pidls;
@@ -1264,7 +1351,9 @@ BOOL ShellBrowserImpl::OnListViewEndLabelEdit(const NMLVDISPINFO *dispInfo)
 	// change, even if the parsing name remains the same. Comparing the parsing names will show that
 	// they're equivalent. It's easier just to update the item, regardless.
 	unique_pidl_absolute pidlNew(ILCombine(m_directoryState.pidlDirectory.Raw(), newChild.get()));
-	UpdateItem(item.pidlComplete.Raw(), pidlNew.get());
+	PendingItemChanges pendingChanges;
+	UpdateItem(item.pidlComplete.Raw(), pidlNew.get(), pendingChanges);
+	ApplyPendingItemChanges(pendingChanges);
 
 	// The text will be set by UpdateItem. It's not safe to return true here, since items can sorted
 	// by UpdateItem, which can result in the index of this item being changed.
@@ -1280,47 +1369,13 @@ LRESULT ShellBrowserImpl::OnListViewCustomDraw(NMLVCUSTOMDRAW *listViewCustomDra
 
 	case CDDS_ITEMPREPAINT:
 	{
-		const auto &itemInfo =
-			GetItemByIndex(static_cast<int>(listViewCustomDraw->nmcd.dwItemSpec));
+		auto &itemInfo = GetItemByIndex(static_cast<int>(listViewCustomDraw->nmcd.dwItemSpec));
+		auto colorRuleIndex = GetItemColorRuleIndex(itemInfo);
 
-		for (const auto &colorRule : m_app->GetColorRuleModel()->GetItems())
+		if (colorRuleIndex)
 		{
-			bool matchedFileName = false;
-			bool matchedAttributes = false;
-
-			if (!colorRule->GetFilterPattern().empty())
-			{
-				if (CheckWildcardMatch(colorRule->GetFilterPattern().c_str(),
-						itemInfo.displayName.c_str(), !colorRule->GetFilterPatternCaseInsensitive())
-					== 1)
-				{
-					matchedFileName = true;
-				}
-			}
-			else
-			{
-				matchedFileName = true;
-			}
-
-			if (colorRule->GetFilterAttributes() != 0)
-			{
-				if (itemInfo.isFindDataValid
-					&& WI_IsAnyFlagSet(itemInfo.wfd.dwFileAttributes,
-						colorRule->GetFilterAttributes()))
-				{
-					matchedAttributes = true;
-				}
-			}
-			else
-			{
-				matchedAttributes = true;
-			}
-
-			if (matchedFileName && matchedAttributes)
-			{
-				listViewCustomDraw->clrText = colorRule->GetColor();
-				return CDRF_NEWFONT;
-			}
+			listViewCustomDraw->clrText = m_colorRuleProgram->GetColor(*colorRuleIndex);
+			return CDRF_NEWFONT;
 		}
 	}
 	break;
@@ -1329,8 +1384,38 @@ LRESULT ShellBrowserImpl::OnListViewCustomDraw(NMLVCUSTOMDRAW *listViewCustomDra
 	return CDRF_DODEFAULT;
 }
 
+// Items are drawn far more often than either the items or the color rules change, so the rule that
+// applies to each item is cached, rather than being re-evaluated every time the item is drawn.
+std::optional<size_t> ShellBrowserImpl::GetItemColorRuleIndex(ItemInfo_t &itemInfo)
+{
+	if (itemInfo.colorRuleGeneration == m_colorRuleGeneration)
+	{
+		return itemInfo.colorRuleIndex;
+	}
+
+	if (!m_colorRuleProgram)
+	{
+		m_colorRuleProgram.emplace(m_app->GetColorRuleModel());
+	}
+
+	std::optional<DWORD> attributes;
+
+	if (itemInfo.isFindDataValid)
+	{
+		attributes = itemInfo.wfd.dwFileAttributes;
+	}
+
+	itemInfo.colorRuleIndex = m_colorRuleProgram->Evaluate(itemInfo.displayName, attributes);
+	itemInfo.colorRuleGeneration = m_colorRuleGeneration;
+
+	return itemInfo.colorRuleIndex;
+}
+
 void ShellBrowserImpl::OnColorRulesUpdated()
 {
+	m_colorRuleProgram.reset();
+	m_colorRuleGeneration++;
+
 	// Any changes to the color rules will require the listview to be redrawn.
 	InvalidateRect(m_hListView, nullptr, false);
 }
@@ -1342,6 +1427,11 @@ void ShellBrowserImpl::OnFullRowSelectUpdated(BOOL newValue)
 
 void ShellBrowserImpl::OnCheckBoxSelectionUpdated(BOOL newValue)
 {
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	ListViewHelper::AddRemoveExtendedStyles(m_hListView, LVS_EX_CHECKBOXES, newValue);
 }
 
@@ -0,0 +1,469 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ListViewItemModel.h"
+#include "SelectionTracker.h"
+#include "../Helper/ParallelSort.h"
+#include <algorithm>
+#include <bit>
+
+ListViewItemModel::ListViewItemModel(const SelectionTracker *selectionTracker) :
+	m_selectionTracker(selectionTracker)
+{
+}
+
+int ListViewItemModel::GetCount() const
+{
+	return static_cast<int>(m_order.size()) - m_numRemovedSlots;
+}
+
+bool ListViewItemModel::HasItem(int internalIndex) const
+{
+	return internalIndex >= 0 && static_cast<size_t>(internalIndex) < m_items.size()
+		&& m_items[internalIndex].present;
+}
+
+int ListViewItemModel::GetInternalIndexAt(int position) const
+{
+	CHECK(position >= 0 && position < GetCount());
+
+	if (m_numRemovedSlots == 0)
+	{
+		return m_order[position];
+	}
+
+	return m_order[FindSlotForPosition(position)];
+}
+
+std::optional<int> ListViewItemModel::GetPosition(int internalIndex) const
+{
+	if (!HasItem(internalIndex))
+	{
+		return std::nullopt;
+	}
+
+	UpdatePositions();
+
+	int slot = m_slots[internalIndex];
+	return slot - CountRemovedSlotsBefore(slot);
+}
+
+int ListViewItemModel::InsertItem(int internalIndex, int position)
+{
+	CHECK(!HasItem(internalIndex));
+
+	ErasePendingRemovals();
+
+	position = std::clamp(position, 0, GetCount());
+	m_order.insert(m_order.begin() + position, internalIndex);
+	EnsureCapacity(internalIndex);
+	m_items[internalIndex].present = true;
+	InvalidatePositionsFrom(position);
+
+	return position;
+}
+
+void ListViewItemModel::InsertItems(const std::vector<std::pair<int, int>> &items)
+{
+	ErasePendingRemovals();
+
+	std::vector<std::pair<int, int>> positionsAndItems;
+
+	for (const auto &[internalIndex, position] : items)
+	{
+		int finalPosition =
+			std::clamp(position, 0, GetCount() + static_cast<int>(positionsAndItems.size()));
+
+		// Since each item in the run is inserted after the previous one, none of the items will be
+		// shifted by a subsequent insertion, so the position of each item is final.
+		if (!positionsAndItems.empty() && finalPosition <= positionsAndItems.back().first)
+		{
+			InsertOrderedItems(positionsAndItems);
+			positionsAndItems.clear();
+
+			finalPosition = std::clamp(position, 0, GetCount());
+		}
+
+		positionsAndItems.emplace_back(finalPosition, internalIndex);
+	}
+
+	InsertOrderedItems(positionsAndItems);
+}
+
+void ListViewItemModel::RemoveItem(int internalIndex)
+{
+	if (!HasItem(internalIndex))
+	{
+		return;
+	}
+
+	UpdatePositions();
+
+	int slot = m_slots[internalIndex];
+	m_order[slot] = REMOVED_SLOT;
+	MarkSlotRemoved(slot);
+
+	ClearColumnText(internalIndex);
+	m_items[internalIndex] = {};
+
+	if (m_focusedItem == internalIndex)
+	{
+		m_focusedItem.reset();
+	}
+}
+
+void ListViewItemModel::RemoveItems(const std::unordered_set<int> &internalIndexes)
+{
+	for (int internalIndex : internalIndexes)
+	{
+		RemoveItem(internalIndex);
+	}
+}
+
+void ListViewItemModel::Sort(const Comparator &comparator, BackgroundWorkPool *workPool)
+{
+	ErasePendingRemovals();
+
+	auto lessThan = [&comparator](int internalIndex1, int internalIndex2)
+	{ return comparator(internalIndex1, internalIndex2) < 0; };
+
+	// A stable sort is used, so that items the comparator considers equivalent retain their
+	// existing relative order. Both sorts produce the same result.
+	if (workPool)
+	{
+		ParallelStableSort(m_order.begin(), m_order.end(), lessThan, workPool);
+	}
+	else
+	{
+		std::stable_sort(m_order.begin(), m_order.end(), lessThan);
+	}
+
+	InvalidatePositionsFrom(0);
+}
+
+void ListViewItemModel::Clear()
+{
+	m_order.clear();
+	m_items.clear();
+	m_focusedItem.reset();
+	m_columnText.clear();
+	m_removedSlotTree.clear();
+	m_numRemovedSlots = 0;
+	m_firstRemovedSlot = 0;
+	m_slots.clear();
+	m_firstInvalidSlot = 0;
+}
+
+bool ListViewItemModel::IsSelected(int internalIndex) const
+{
+	return HasItem(internalIndex) && m_selectionTracker->IsSelected(internalIndex);
+}
+
+int ListViewItemModel::GetSelectedCount() const
+{
+	return m_selectionTracker->GetNumSelectedItems();
+}
+
+std::vector<int> ListViewItemModel::GetSelectedPositions() const
+{
+	std::vector<int> positions;
+	positions.reserve(GetSelectedCount());
+
+	for (int internalIndex : m_selectionTracker->GetSelectedItems())
+	{
+		auto position = GetPosition(internalIndex);
+
+		if (position)
+		{
+			positions.push_back(*position);
+		}
+	}
+
+	std::sort(positions.begin(), positions.end());
+
+	return positions;
+}
+
+void ListViewItemModel::SetFocusedItem(std::optional<int> internalIndex)
+{
+	CHECK(!internalIndex || HasItem(*internalIndex));
+	m_focusedItem = internalIndex;
+}
+
+std::optional<int> ListViewItemModel::GetFocusedItem() const
+{
+	return m_focusedItem;
+}
+
+void ListViewItemModel::SetCut(int internalIndex, bool cut)
+{
+	GetItemData(internalIndex).cut = cut;
+}
+
+bool ListViewItemModel::IsCut(int internalIndex) const
+{
+	return GetItemData(internalIndex).cut;
+}
+
+void ListViewItemModel::SetGroupId(int internalIndex, std::optional<int> groupId)
+{
+	GetItemData(internalIndex).groupId = groupId;
+}
+
+std::optional<int> ListViewItemModel::GetGroupId(int internalIndex) const
+{
+	return GetItemData(internalIndex).groupId;
+}
+
+void ListViewItemModel::SetImage(int internalIndex, int imageIndex, int overlayIndex)
+{
+	auto &itemData = GetItemData(internalIndex);
+	itemData.imageIndex = imageIndex;
+	itemData.overlayIndex = overlayIndex;
+}
+
+void ListViewItemModel::ResetImage(int internalIndex)
+{
+	auto &itemData = GetItemData(internalIndex);
+	itemData.imageIndex.reset();
+	itemData.overlayIndex = 0;
+}
+
+void ListViewItemModel::ResetAllImages()
+{
+	for (auto &itemData : m_items)
+	{
+		itemData.imageIndex.reset();
+		itemData.overlayIndex = 0;
+	}
+}
+
+std::optional<int> ListViewItemModel::GetImage(int internalIndex) const
+{
+	return GetItemData(internalIndex).imageIndex;
+}
+
+int ListViewItemModel::GetOverlay(int internalIndex) const
+{
+	return GetItemData(internalIndex).overlayIndex;
+}
+
+void ListViewItemModel::SetColumnText(int internalIndex, int columnId, const std::wstring &text)
+{
+	CHECK(HasItem(internalIndex));
+	CHECK_GE(columnId, 0);
+
+	if (static_cast<size_t>(columnId) >= m_columnText.size())
+	{
+		m_columnText.resize(columnId + 1);
+	}
+
+	auto &column = m_columnText[columnId];
+
+	if (static_cast<size_t>(internalIndex) >= column.size())
+	{
+		column.resize(m_items.size());
+	}
+
+	column[internalIndex] = text;
+}
+
+const std::wstring *ListViewItemModel::MaybeGetColumnText(int internalIndex, int columnId) const
+{
+	CHECK(HasItem(internalIndex));
+
+	if (columnId < 0 || static_cast<size_t>(columnId) >= m_columnText.size())
+	{
+		return nullptr;
+	}
+
+	const auto &column = m_columnText[columnId];
+
+	if (static_cast<size_t>(internalIndex) >= column.size() || !column[internalIndex])
+	{
+		return nullptr;
+	}
+
+	return &*column[internalIndex];
+}
+
+void ListViewItemModel::ResetColumnText(int internalIndex)
+{
+	CHECK(HasItem(internalIndex));
+	ClearColumnText(internalIndex);
+}
+
+// Inserts a set of items, each of which is given with the position it should end up at. The
+// positions need to be in increasing order.
+void ListViewItemModel::InsertOrderedItems(
+	const std::vector<std::pair<int, int>> &positionsAndItems)
+{
+	if (positionsAndItems.empty())
+	{
+		return;
+	}
+
+	std::vector<int> order;
+	order.reserve(m_order.size() + positionsAndItems.size());
+
+	auto nextExistingItem = m_order.begin();
+
+	for (const auto &[position, internalIndex] : positionsAndItems)
+	{
+		CHECK(!HasItem(internalIndex));
+
+		auto numExistingItems = position - static_cast<int>(order.size());
+		order.insert(order.end(), nextExistingItem, nextExistingItem + numExistingItems);
+		nextExistingItem += numExistingItems;
+
+		order.push_back(internalIndex);
+		EnsureCapacity(internalIndex);
+		m_items[internalIndex].present = true;
+	}
+
+	order.insert(order.end(), nextExistingItem, m_order.end());
+	m_order = std::move(order);
+
+	InvalidatePositionsFrom(positionsAndItems.front().first);
+}
+
+void ListViewItemModel::EnsureCapacity(int internalIndex)
+{
+	CHECK_GE(internalIndex, 0);
+
+	if (static_cast<size_t>(internalIndex) >= m_items.size())
+	{
+		m_items.resize(internalIndex + 1);
+		m_slots.resize(internalIndex + 1);
+	}
+}
+
+ListViewItemModel::ItemData &ListViewItemModel::GetItemData(int internalIndex)
+{
+	CHECK(HasItem(internalIndex));
+	return m_items[internalIndex];
+}
+
+const ListViewItemModel::ItemData &ListViewItemModel::GetItemData(int internalIndex) const
+{
+	CHECK(HasItem(internalIndex));
+	return m_items[internalIndex];
+}
+
+void ListViewItemModel::ClearColumnText(int internalIndex)
+{
+	for (auto &column : m_columnText)
+	{
+		if (static_cast<size_t>(internalIndex) < column.size())
+		{
+			column[internalIndex].reset();
+		}
+	}
+}
+
+void ListViewItemModel::InvalidatePositionsFrom(int slot)
+{
+	m_firstInvalidSlot = std::min(m_firstInvalidSlot, slot);
+}
+
+void ListViewItemModel::UpdatePositions() const
+{
+	for (int slot = m_firstInvalidSlot; slot < static_cast<int>(m_order.size()); slot++)
+	{
+		if (m_order[slot] != REMOVED_SLOT)
+		{
+			m_slots[m_order[slot]] = slot;
+		}
+	}
+
+	m_firstInvalidSlot = static_cast<int>(m_order.size());
+}
+
+void ListViewItemModel::MarkSlotRemoved(int slot)
+{
+	if (m_numRemovedSlots == 0)
+	{
+		m_removedSlotTree.assign(m_order.size() + 1, 0);
+		m_firstRemovedSlot = slot;
+	}
+	else
+	{
+		m_firstRemovedSlot = std::min(m_firstRemovedSlot, slot);
+	}
+
+	for (int node = slot + 1; node < static_cast<int>(m_removedSlotTree.size());
+		node += node & -node)
+	{
+		m_removedSlotTree[node]++;
+	}
+
+	m_numRemovedSlots++;
+}
+
+// Returns the number of removed slots in the range [0, slot).
+int ListViewItemModel::CountRemovedSlotsBefore(int slot) const
+{
+	if (m_numRemovedSlots == 0)
+	{
+		return 0;
+	}
+
+	int count = 0;
+
+	for (int node = slot; node > 0; node -= node & -node)
+	{
+		count += m_removedSlotTree[node];
+	}
+
+	return count;
+}
+
+// Returns the slot that holds the item at the specified position, by descending the tree and
+// skipping over any block of slots that contains fewer remaining items than are still required.
+int ListViewItemModel::FindSlotForPosition(int position) const
+{
+	int numSlots = static_cast<int>(m_order.size());
+	int slot = 0;
+	int itemsRequired = position + 1;
+
+	for (int step = static_cast<int>(std::bit_floor(static_cast<unsigned int>(numSlots)));
+		step > 0; step >>= 1)
+	{
+		int node = slot + step;
+
+		if (node > numSlots)
+		{
+			continue;
+		}
+
+		int itemsInBlock = step - m_removedSlotTree[node];
+
+		if (itemsInBlock < itemsRequired)
+		{
+			slot = node;
+			itemsRequired -= itemsInBlock;
+		}
+	}
+
+	return slot;
+}
+
+// Erases the slots of any removed items from the display order, in a single pass.
+void ListViewItemModel::ErasePendingRemovals()
+{
+	if (m_numRemovedSlots == 0)
+	{
+		return;
+	}
+
+	m_order.erase(std::remove(m_order.begin() + m_firstRemovedSlot, m_order.end(), REMOVED_SLOT),
+		m_order.end());
+
+	InvalidatePositionsFrom(m_firstRemovedSlot);
+
+	m_removedSlotTree.clear();
+	m_numRemovedSlots = 0;
+	m_firstRemovedSlot = 0;
+}
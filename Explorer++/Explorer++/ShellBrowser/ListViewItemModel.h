@@ -0,0 +1,139 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class BackgroundWorkPool;
+class SelectionTracker;
+
+// Holds the items shown in a virtual (owner-data) listview. In that mode, the listview itself only
+// knows how many items there are. Everything else - the order of the items, which items are
+// selected and the data that's displayed for each item - is stored here and provided to the
+// listview on request.
+//
+// Items are identified by their internal index. Nothing here depends on a window, so the display
+// order and item state can be maintained (and tested) independently of the listview.
+//
+// Internal indexes are small integers, allocated sequentially, so the data for each item is stored
+// in vectors indexed by internal index, in the same way as SortKeyStore and SelectionTracker. The
+// selection itself is owned by the SelectionTracker and is only queried here.
+class ListViewItemModel
+{
+public:
+	// Returns a negative value if the first item should appear before the second, a positive
+	// value if it should appear after and 0 if the items are equivalent.
+	using Comparator = std::function<int(int internalIndex1, int internalIndex2)>;
+
+	explicit ListViewItemModel(const SelectionTracker *selectionTracker);
+
+	int GetCount() const;
+	bool HasItem(int internalIndex) const;
+	int GetInternalIndexAt(int position) const;
+	std::optional<int> GetPosition(int internalIndex) const;
+
+	// Inserts the item at the specified position. If the position is past the end of the list, the
+	// item will be appended. Returns the position the item was inserted at.
+	int InsertItem(int internalIndex, int position);
+
+	// Equivalent to calling InsertItem() for each (internal index, position) pair in turn. Runs of
+	// items with increasing positions (e.g. a set of items being inserted in sorted order) are
+	// inserted in a single pass.
+	void InsertItems(const std::vector<std::pair<int, int>> &items);
+
+	// Removed items are only erased from the display order when the order is next modified (i.e.
+	// when items are inserted or sorted), so removing a single item is O(log n), rather than
+	// requiring the items after it to be shifted down each time.
+	void RemoveItem(int internalIndex);
+
+	// Items that don't exist are ignored.
+	void RemoveItems(const std::unordered_set<int> &internalIndexes);
+
+	// If a work pool is provided, the comparator may be called concurrently from several threads,
+	// which significantly speeds up sorting a large number of items. That should only be done when
+	// the comparator doesn't modify anything and only reads data that won't be modified while the
+	// sort is in progress.
+	void Sort(const Comparator &comparator, BackgroundWorkPool *workPool = nullptr);
+	void Clear();
+
+	bool IsSelected(int internalIndex) const;
+	int GetSelectedCount() const;
+	std::vector<int> GetSelectedPositions() const;
+
+	void SetFocusedItem(std::optional<int> internalIndex);
+	std::optional<int> GetFocusedItem() const;
+
+	void SetCut(int internalIndex, bool cut);
+	bool IsCut(int internalIndex) const;
+
+	void SetGroupId(int internalIndex, std::optional<int> groupId);
+	std::optional<int> GetGroupId(int internalIndex) const;
+
+	void SetImage(int internalIndex, int imageIndex, int overlayIndex);
+	void ResetImage(int internalIndex);
+	void ResetAllImages();
+	std::optional<int> GetImage(int internalIndex) const;
+	int GetOverlay(int internalIndex) const;
+
+	// Column text is keyed by a small, non-negative, caller-defined column ID (e.g. the integral
+	// value of a ColumnType). An item with no text for a particular column will return nullptr.
+	void SetColumnText(int internalIndex, int columnId, const std::wstring &text);
+	const std::wstring *MaybeGetColumnText(int internalIndex, int columnId) const;
+	void ResetColumnText(int internalIndex);
+
+private:
+	struct ItemData
+	{
+		bool present = false;
+		bool cut = false;
+		std::optional<int> groupId;
+		std::optional<int> imageIndex;
+		int overlayIndex = 0;
+	};
+
+	// Marks a slot in m_order whose item has been removed, but not yet erased.
+	static constexpr int REMOVED_SLOT = -1;
+
+	void InsertOrderedItems(const std::vector<std::pair<int, int>> &positionsAndItems);
+	void EnsureCapacity(int internalIndex);
+	ItemData &GetItemData(int internalIndex);
+	const ItemData &GetItemData(int internalIndex) const;
+	void ClearColumnText(int internalIndex);
+	void InvalidatePositionsFrom(int slot);
+	void UpdatePositions() const;
+	void MarkSlotRemoved(int slot);
+	int CountRemovedSlotsBefore(int slot) const;
+	int FindSlotForPosition(int position) const;
+	void ErasePendingRemovals();
+
+	const SelectionTracker *const m_selectionTracker;
+
+	// The display order. While there are pending removals, this also contains REMOVED_SLOT
+	// entries, which are skipped over when converting between slots and positions.
+	std::vector<int> m_order;
+	std::vector<ItemData> m_items;
+	std::optional<int> m_focusedItem;
+
+	// Indexed by column ID, then by internal index.
+	std::vector<std::vector<std::optional<std::wstring>>> m_columnText;
+
+	// A Fenwick tree, counting the removed slots in m_order. This is only allocated while there are
+	// pending removals and allows the position of an item (and the item at a position) to be
+	// determined in O(log n).
+	std::vector<int> m_removedSlotTree;
+	int m_numRemovedSlots = 0;
+	int m_firstRemovedSlot = 0;
+
+	// The slot each item occupies in m_order, indexed by internal index. These are updated lazily,
+	// so that inserting a batch of items only requires a single pass over the items that were
+	// shifted, rather than one pass per item.
+	mutable std::vector<int> m_slots;
+	mutable int m_firstInvalidSlot = 0;
+};
@@ -0,0 +1,122 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "NamePatternMatcher.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+NamePatternMatcher::MatchSet::MatchSet(size_t size) :
+	m_words((size + BITS_PER_WORD - 1) / BITS_PER_WORD),
+	m_size(size)
+{
+}
+
+bool NamePatternMatcher::MatchSet::IsMatch(size_t index) const
+{
+	if (index >= m_size)
+	{
+		return false;
+	}
+
+	return ((m_words[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1) != 0;
+}
+
+size_t NamePatternMatcher::MatchSet::GetSize() const
+{
+	return m_size;
+}
+
+size_t NamePatternMatcher::MatchSet::GetNumMatches() const
+{
+	size_t numMatches = 0;
+
+	for (auto word : m_words)
+	{
+		numMatches += std::popcount(word);
+	}
+
+	return numMatches;
+}
+
+NamePatternMatcher::NamePatternMatcher(std::wstring_view pattern, Syntax syntax,
+	bool caseSensitive)
+{
+	// As with FileSearcher, Boost.Regex is used, rather than std::regex, since it matches
+	// considerably faster.
+	if (syntax == Syntax::RegularExpression)
+	{
+		boost::regex_constants::syntax_option_type flags = boost::regex::perl;
+
+		if (!caseSensitive)
+		{
+			flags |= boost::regex::icase;
+		}
+
+		m_regex.emplace(pattern.begin(), pattern.end(), flags);
+	}
+	else
+	{
+		m_wildcardPattern.emplace(pattern, caseSensitive);
+	}
+}
+
+bool NamePatternMatcher::Matches(std::wstring_view name) const
+{
+	if (m_regex)
+	{
+		return boost::regex_match(name.begin(), name.end(), *m_regex);
+	}
+
+	return m_wildcardPattern->Matches(name);
+}
+
+NamePatternMatcher::MatchSet NamePatternMatcher::MatchNames(
+	const std::vector<std::wstring_view> &names, BackgroundWorkPool *workPool) const
+{
+	MatchSet matchSet(names.size());
+
+	size_t numChunks = std::min(static_cast<size_t>(std::max(workPool->GetMaxConcurrency(), 1)),
+		names.size() / MIN_NAMES_PER_CHUNK);
+
+	if (numChunks <= 1)
+	{
+		MatchRange(names, 0, names.size(), matchSet);
+		return matchSet;
+	}
+
+	// Each chunk starts on a word boundary, so every word in the set is only ever written to by a
+	// single thread.
+	size_t numWords = matchSet.m_words.size();
+	std::vector<std::function<void()>> chunkMatches;
+
+	for (size_t i = 0; i < numChunks; i++)
+	{
+		size_t start = std::min(numWords * i / numChunks * MatchSet::BITS_PER_WORD, names.size());
+		size_t end =
+			std::min(numWords * (i + 1) / numChunks * MatchSet::BITS_PER_WORD, names.size());
+
+		chunkMatches.emplace_back([this, &names, start, end, &matchSet]
+			{ MatchRange(names, start, end, matchSet); });
+	}
+
+	RunConcurrently(workPool, chunkMatches);
+
+	return matchSet;
+}
+
+void NamePatternMatcher::MatchRange(const std::vector<std::wstring_view> &names, size_t start,
+	size_t end, MatchSet &matchSet) const
+{
+	for (size_t i = start; i < end; i++)
+	{
+		if (Matches(names[i]))
+		{
+			matchSet.m_words[i / MatchSet::BITS_PER_WORD] |= MatchSet::Word{ 1 }
+				<< (i % MatchSet::BITS_PER_WORD);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "../Helper/WildcardPattern.h"
+#include <boost/regex.hpp>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+class BackgroundWorkPool;
+
+// Matches item names against a wildcard pattern or a regular expression. The pattern is compiled
+// once, when the matcher is constructed, and can then be matched against an entire set of names at
+// a time. Large sets of names are split into chunks, which are matched concurrently, using tasks
+// on the shared work pool.
+class NamePatternMatcher
+{
+public:
+	enum class Syntax
+	{
+		Wildcard,
+		RegularExpression
+	};
+
+	// Holds one bit for each name that was matched, with the bit set if the name matched the
+	// pattern.
+	class MatchSet
+	{
+	public:
+		bool IsMatch(size_t index) const;
+		size_t GetSize() const;
+		size_t GetNumMatches() const;
+
+	private:
+		friend NamePatternMatcher;
+
+		using Word = uint64_t;
+		static constexpr size_t BITS_PER_WORD = 64;
+
+		explicit MatchSet(size_t size);
+
+		std::vector<Word> m_words;
+		size_t m_size;
+	};
+
+	// Throws boost::regex_error if the syntax is RegularExpression and the pattern isn't a valid
+	// regular expression.
+	NamePatternMatcher(std::wstring_view pattern, Syntax syntax, bool caseSensitive);
+
+	bool Matches(std::wstring_view name) const;
+
+	// Matches every name, with the names split into up to one chunk per pool thread. The calling
+	// thread also matches names, so this won't stall if the pool is busy.
+	MatchSet MatchNames(const std::vector<std::wstring_view> &names,
+		BackgroundWorkPool *workPool) const;
+
+private:
+	// Below this number of names per chunk, it's quicker to match the names directly than to queue
+	// another task.
+	static constexpr size_t MIN_NAMES_PER_CHUNK = 8192;
+
+	void MatchRange(const std::vector<std::wstring_view> &names, size_t start, size_t end,
+		MatchSet &matchSet) const;
+
+	std::optional<WildcardPattern> m_wildcardPattern;
+	std::optional<boost::wregex> m_regex;
+};
@@ -0,0 +1,257 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "SelectionTracker.h"
+#include <algorithm>
+#include <bit>
+
+void SelectionTracker::AddItem(int internalIndex, bool isFolder, uint64_t size)
+{
+	if (HasItem(internalIndex))
+	{
+		UpdateItem(internalIndex, isFolder, size);
+		return;
+	}
+
+	EnsureCapacity(internalIndex);
+
+	SetBit(m_items, internalIndex, true);
+	SetBit(m_folders, internalIndex, isFolder);
+	m_sizes[internalIndex] = size;
+
+	AddToTotals(m_itemTotals, isFolder, size);
+}
+
+void SelectionTracker::UpdateItem(int internalIndex, bool isFolder, uint64_t size)
+{
+	if (!HasItem(internalIndex))
+	{
+		return;
+	}
+
+	bool wasFolder = TestBit(m_folders, internalIndex);
+	uint64_t previousSize = m_sizes[internalIndex];
+
+	RemoveFromTotals(m_itemTotals, wasFolder, previousSize);
+	AddToTotals(m_itemTotals, isFolder, size);
+
+	if (IsSelected(internalIndex))
+	{
+		RemoveFromTotals(m_selectionTotals, wasFolder, previousSize);
+		AddToTotals(m_selectionTotals, isFolder, size);
+	}
+
+	SetBit(m_folders, internalIndex, isFolder);
+	m_sizes[internalIndex] = size;
+}
+
+void SelectionTracker::RemoveItem(int internalIndex)
+{
+	if (!HasItem(internalIndex))
+	{
+		return;
+	}
+
+	SetSelected(internalIndex, false);
+
+	RemoveFromTotals(m_itemTotals, TestBit(m_folders, internalIndex), m_sizes[internalIndex]);
+
+	SetBit(m_items, internalIndex, false);
+	SetBit(m_folders, internalIndex, false);
+	m_sizes[internalIndex] = 0;
+}
+
+bool SelectionTracker::HasItem(int internalIndex) const
+{
+	return TestBit(m_items, internalIndex);
+}
+
+void SelectionTracker::Clear()
+{
+	m_items.clear();
+	m_folders.clear();
+	m_selected.clear();
+	m_sizes.clear();
+
+	m_itemTotals = {};
+	m_selectionTotals = {};
+}
+
+bool SelectionTracker::SetSelected(int internalIndex, bool selected)
+{
+	if (!HasItem(internalIndex) || IsSelected(internalIndex) == selected)
+	{
+		return false;
+	}
+
+	SetBit(m_selected, internalIndex, selected);
+
+	bool isFolder = TestBit(m_folders, internalIndex);
+
+	if (selected)
+	{
+		AddToTotals(m_selectionTotals, isFolder, m_sizes[internalIndex]);
+	}
+	else
+	{
+		RemoveFromTotals(m_selectionTotals, isFolder, m_sizes[internalIndex]);
+	}
+
+	return true;
+}
+
+void SelectionTracker::SetAllSelected(bool selected)
+{
+	if (selected)
+	{
+		std::copy(m_items.begin(), m_items.end(), m_selected.begin());
+		m_selectionTotals = m_itemTotals;
+	}
+	else
+	{
+		std::fill(m_selected.begin(), m_selected.end(), 0);
+		m_selectionTotals = {};
+	}
+}
+
+void SelectionTracker::InvertSelection()
+{
+	// Each word is independent of the others, so this loop can be vectorized.
+	for (size_t i = 0; i < m_selected.size(); i++)
+	{
+		m_selected[i] = m_items[i] & ~m_selected[i];
+	}
+
+	// Every item is either in the current selection or the inverted selection, so the totals for
+	// the inverted selection are simply whatever's left over.
+	m_selectionTotals = { m_itemTotals.numFiles - m_selectionTotals.numFiles,
+		m_itemTotals.numFolders - m_selectionTotals.numFolders,
+		m_itemTotals.size - m_selectionTotals.size };
+}
+
+bool SelectionTracker::IsSelected(int internalIndex) const
+{
+	return TestBit(m_selected, internalIndex);
+}
+
+std::vector<int> SelectionTracker::GetSelectedItems() const
+{
+	std::vector<int> selectedItems;
+	selectedItems.reserve(GetNumSelectedItems());
+
+	for (size_t i = 0; i < m_selected.size(); i++)
+	{
+		// Only the set bits are visited, so words with no selected items are skipped entirely.
+		for (Word word = m_selected[i]; word != 0; word &= word - 1)
+		{
+			selectedItems.push_back(
+				static_cast<int>(i * BITS_PER_WORD) + std::countr_zero(word));
+		}
+	}
+
+	return selectedItems;
+}
+
+int SelectionTracker::GetNumItems() const
+{
+	return m_itemTotals.numFiles + m_itemTotals.numFolders;
+}
+
+int SelectionTracker::GetNumSelectedItems() const
+{
+	return m_selectionTotals.numFiles + m_selectionTotals.numFolders;
+}
+
+const SelectionTracker::Totals &SelectionTracker::GetItemTotals() const
+{
+	return m_itemTotals;
+}
+
+const SelectionTracker::Totals &SelectionTracker::GetSelectionTotals() const
+{
+	return m_selectionTotals;
+}
+
+bool SelectionTracker::TestBit(const std::vector<Word> &words, int index)
+{
+	if (index < 0)
+	{
+		return false;
+	}
+
+	size_t wordIndex = static_cast<size_t>(index) / BITS_PER_WORD;
+
+	if (wordIndex >= words.size())
+	{
+		return false;
+	}
+
+	return ((words[wordIndex] >> (index % BITS_PER_WORD)) & 1) != 0;
+}
+
+void SelectionTracker::SetBit(std::vector<Word> &words, int index, bool value)
+{
+	Word mask = Word{ 1 } << (index % BITS_PER_WORD);
+	Word &word = words[static_cast<size_t>(index) / BITS_PER_WORD];
+
+	if (value)
+	{
+		word |= mask;
+	}
+	else
+	{
+		word &= ~mask;
+	}
+}
+
+void SelectionTracker::AddToTotals(Totals &totals, bool isFolder, uint64_t size)
+{
+	if (isFolder)
+	{
+		totals.numFolders++;
+	}
+	else
+	{
+		totals.numFiles++;
+	}
+
+	totals.size += size;
+}
+
+void SelectionTracker::RemoveFromTotals(Totals &totals, bool isFolder, uint64_t size)
+{
+	if (isFolder)
+	{
+		totals.numFolders--;
+	}
+	else
+	{
+		totals.numFiles--;
+	}
+
+	totals.size -= size;
+}
+
+void SelectionTracker::EnsureCapacity(int internalIndex)
+{
+	CHECK_GE(internalIndex, 0);
+
+	auto requiredSize = static_cast<size_t>(internalIndex) + 1;
+
+	if (m_sizes.size() >= requiredSize)
+	{
+		return;
+	}
+
+	// Internal indexes are allocated sequentially, so the storage grows geometrically, in the same
+	// way as a vector would.
+	size_t newSize = std::max(requiredSize, m_sizes.size() * 2);
+	size_t numWords = (newSize + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+	m_items.resize(numWords);
+	m_folders.resize(numWords);
+	m_selected.resize(numWords);
+	m_sizes.resize(numWords * BITS_PER_WORD);
+}
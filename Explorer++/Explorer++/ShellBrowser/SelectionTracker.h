@@ -0,0 +1,78 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Tracks the items shown in the listview and which of those items are selected, along with the
+// number of files and folders and their total size, for both the items as a whole and the
+// selection.
+//
+// Internal indexes are small integers, allocated sequentially, so each set of items is stored as a
+// bitset indexed by internal index. Operations that affect every item (selecting all items,
+// clearing the selection or inverting it) are then a single pass over the words of the bitset, with
+// the selection totals derived directly from the overall totals, rather than being accumulated one
+// item at a time.
+class SelectionTracker
+{
+public:
+	struct Totals
+	{
+		int numFiles = 0;
+		int numFolders = 0;
+		uint64_t size = 0;
+
+		bool operator==(const Totals &) const = default;
+	};
+
+	// Adding an item that's already being tracked will update its details, without changing its
+	// selection state.
+	void AddItem(int internalIndex, bool isFolder, uint64_t size);
+
+	// Does nothing if the item isn't being tracked.
+	void UpdateItem(int internalIndex, bool isFolder, uint64_t size);
+
+	// Removes the item, deselecting it first, if necessary. Does nothing if the item isn't being
+	// tracked.
+	void RemoveItem(int internalIndex);
+
+	bool HasItem(int internalIndex) const;
+	void Clear();
+
+	// Returns true if the selection state of the item changed. Items that aren't being tracked
+	// can't be selected.
+	bool SetSelected(int internalIndex, bool selected);
+	void SetAllSelected(bool selected);
+	void InvertSelection();
+	bool IsSelected(int internalIndex) const;
+
+	// Returns the internal indexes of the selected items, in increasing order.
+	std::vector<int> GetSelectedItems() const;
+
+	int GetNumItems() const;
+	int GetNumSelectedItems() const;
+	const Totals &GetItemTotals() const;
+	const Totals &GetSelectionTotals() const;
+
+private:
+	using Word = uint64_t;
+	static constexpr int BITS_PER_WORD = 64;
+
+	static bool TestBit(const std::vector<Word> &words, int index);
+	static void SetBit(std::vector<Word> &words, int index, bool value);
+	static void AddToTotals(Totals &totals, bool isFolder, uint64_t size);
+	static void RemoveFromTotals(Totals &totals, bool isFolder, uint64_t size);
+
+	void EnsureCapacity(int internalIndex);
+
+	std::vector<Word> m_items;
+	std::vector<Word> m_folders;
+	std::vector<Word> m_selected;
+	std::vector<uint64_t> m_sizes;
+
+	Totals m_itemTotals;
+	Totals m_selectionTotals;
+};
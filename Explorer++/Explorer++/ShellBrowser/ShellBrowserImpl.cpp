@@ -9,11 +9,13 @@
 #include "ColorRuleModel.h"
 #include "Config.h"
 #include "CoreInterface.h"
+#include "FeatureList.h"
 #include "FolderView.h"
 #include "IconFetcherImpl.h"
 #include "ItemData.h"
 #include "MainResource.h"
 #include "MassRenameDialog.h"
+#include "NamePatternMatcher.h"
 #include "PreservedFolderState.h"
 #include "ServiceProvider.h"
 #include "ShellBrowserEmbedder.h"
@@ -28,6 +30,8 @@
 #include "../Helper/FileActionHandler.h"
 #include "../Helper/FileOperations.h"
 #include "../Helper/ListViewHelper.h"
+#include "../Helper/ParallelSort.h"
+#include "../Helper/ScopedRedrawDisabler.h"
 #include "../Helper/ShellHelper.h"
 #include <wil/com.h>
 #include <list>
@@ -48,31 +52,35 @@ ShellBrowserImpl::ShellBrowserImpl(HWND hOwner, ShellBrowserEmbedder *embedder,
 	CoreInterface *coreInterface, TabNavigationInterface *tabNavigation,
 	FileActionHandler *fileActionHandler, const FolderSettings &folderSettings,
 	const FolderColumns *initialColumns) :
-	ShellDropTargetWindow(CreateListView(hOwner)),
+	ShellDropTargetWindow(
+		CreateListView(hOwner, app->GetFeatureList()->IsEnabled(Feature::VirtualListView))),
 	m_hListView(GetHWND()),
 	m_hOwner(hOwner),
 	m_app(app),
+	m_virtualListView(WI_IsFlagSet(GetWindowLongPtr(GetHWND(), GWL_STYLE), LVS_OWNERDATA)),
 	m_tabNavigation(tabNavigation),
 	m_fileActionHandler(fileActionHandler),
 	m_fontSetter(GetHWND(), app->GetConfig()),
 	m_tooltipFontSetter(reinterpret_cast<HWND>(SendMessage(GetHWND(), LVM_GETTOOLTIPS, 0, 0)),
 		app->GetConfig()),
-	m_columnThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
-		CoUninitialize),
-	m_columnResultIDCounter(0),
+	m_listViewItemModel(&m_directoryState.selectionTracker),
+	m_columnTextScheduler(std::make_shared<ColumnTextScheduler>()),
+	m_columnTaskGroup(app->GetRuntime()->GetBackgroundWorkPool()),
 	m_cachedIcons(coreInterface->GetCachedIcons()),
-	m_thumbnailThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
-		CoUninitialize),
+	m_thumbnailTaskGroup(app->GetRuntime()->GetBackgroundWorkPool()),
 	m_thumbnailResultIDCounter(0),
-	m_infoTipsThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
-		CoUninitialize),
+	m_infoTipsTaskGroup(app->GetRuntime()->GetBackgroundWorkPool()),
 	m_infoTipResultIDCounter(0),
 	m_resourceInstance(coreInterface->GetResourceInstance()),
 	m_acceleratorManager(coreInterface->GetAcceleratorManager()),
 	m_config(app->GetConfig()),
 	m_folderSettings(folderSettings),
+	m_filterPattern(folderSettings.filter, folderSettings.filterCaseSensitive),
+	m_groupTaskGroup(app->GetRuntime()->GetBackgroundWorkPool()),
 	m_shellChangeWatcher(GetHWND(),
 		std::bind_front(&ShellBrowserImpl::ProcessShellChangeNotifications, this)),
+	m_directoryChangeQueue(MAX_QUEUED_DIRECTORY_CHANGES,
+		MAX_QUEUED_DIRECTORY_CHANGE_NAME_CHARACTERS),
 	m_shellWindowRegistered(false),
 	m_folderColumns(
 		initialColumns ? *initialColumns : app->GetConfig()->globalFolderSettings.folderColumns),
@@ -80,7 +88,8 @@ ShellBrowserImpl::ShellBrowserImpl(HWND hOwner, ShellBrowserEmbedder *embedder,
 	m_weakPtrFactory(this)
 {
 	InitializeListView();
-	m_iconFetcher = std::make_unique<IconFetcherImpl>(m_hListView, m_cachedIcons);
+	m_iconFetcher = std::make_unique<IconFetcherImpl>(m_hListView, m_cachedIcons,
+		app->GetRuntime()->GetBackgroundWorkPool());
 	m_navigationController = std::make_unique<ShellNavigationController>(this, tabNavigation);
 
 	m_getDragImageMessage = RegisterWindowMessage(DI_GETDRAGIMAGE);
@@ -88,6 +97,7 @@ ShellBrowserImpl::ShellBrowserImpl(HWND hOwner, ShellBrowserEmbedder *embedder,
 	m_bFolderVisited = FALSE;
 
 	m_performingDrag = false;
+	m_syncingVirtualListViewSelection = false;
 	m_nCurrentColumns = 0;
 	m_pActiveColumns = nullptr;
 	m_nActiveColumns = 0;
@@ -97,8 +107,6 @@ ShellBrowserImpl::ShellBrowserImpl(HWND hOwner, ShellBrowserEmbedder *embedder,
 
 	m_PreviousSortColumnExists = false;
 
-	InitializeCriticalSection(&m_csDirectoryAltered);
-
 	FAIL_FAST_IF_FAILED(GetDefaultFolderIconIndex(m_iFolderIcon));
 	FAIL_FAST_IF_FAILED(GetDefaultFileIconIndex(m_iFileIcon));
 
@@ -128,23 +136,26 @@ ShellBrowserImpl::~ShellBrowserImpl()
 
 	DestroyWindow(m_hListView);
 
-	m_columnThreadPool.clear_queue();
-	m_thumbnailThreadPool.clear_queue();
-	m_infoTipsThreadPool.clear_queue();
-
-	DeleteCriticalSection(&m_csDirectoryAltered);
+	m_columnTaskGroup.CancelPendingTasks();
+	m_columnTextScheduler->Clear();
+	m_thumbnailTaskGroup.CancelPendingTasks();
+	m_infoTipsTaskGroup.CancelPendingTasks();
+	m_groupTaskGroup.CancelPendingTasks();
 }
 
-HWND ShellBrowserImpl::CreateListView(HWND parent)
+HWND ShellBrowserImpl::CreateListView(HWND parent, bool virtualListView)
 {
 	// Note that the only reason LVS_REPORT is specified here is so that the listview header theme
 	// can be set immediately when in dark mode. Without this style, ListView_GetHeader() will
 	// return NULL. The actual view mode set here doesn't matter, since it will be updated when
 	// navigating to a folder.
-	return ::CreateListView(parent,
-		WS_CHILD | WS_CLIPSIBLINGS | WS_CLIPCHILDREN | LVS_REPORT | LVS_EDITLABELS
-			| LVS_SHOWSELALWAYS | LVS_SHAREIMAGELISTS | LVS_AUTOARRANGE | WS_TABSTOP
-			| LVS_ALIGNTOP);
+	DWORD style = WS_CHILD | WS_CLIPSIBLINGS | WS_CLIPCHILDREN | LVS_REPORT | LVS_EDITLABELS
+		| LVS_SHOWSELALWAYS | LVS_SHAREIMAGELISTS | LVS_AUTOARRANGE | WS_TABSTOP | LVS_ALIGNTOP;
+
+	// The LVS_OWNERDATA style can't be added or removed once the control has been created.
+	WI_SetFlagIf(style, LVS_OWNERDATA, virtualListView);
+
+	return ::CreateListView(parent, style);
 }
 
 void ShellBrowserImpl::InitializeListView()
@@ -159,7 +170,9 @@ void ShellBrowserImpl::InitializeListView()
 	m_connections.push_back(m_config->useFullRowSelect.addObserver(
 		std::bind_front(&ShellBrowserImpl::OnFullRowSelectUpdated, this)));
 
-	if (m_config->checkBoxSelection.get())
+	// The check state of an item in a virtual listview isn't stored by the control, so check box
+	// selection isn't supported in that mode.
+	if (m_config->checkBoxSelection.get() && !m_virtualListView)
 	{
 		dwExtendedStyle |= LVS_EX_CHECKBOXES;
 	}
@@ -169,6 +182,13 @@ void ShellBrowserImpl::InitializeListView()
 
 	ListView_SetExtendedListViewStyle(m_hListView, dwExtendedStyle);
 
+	if (m_virtualListView)
+	{
+		// A virtual listview only stores the selected and focused state of each item. The other
+		// states are provided by the model.
+		ListView_SetCallbackMask(m_hListView, LVIS_CUT | LVIS_OVERLAYMASK);
+	}
+
 	ListViewHelper::SetAutoArrange(m_hListView, m_folderSettings.autoArrange);
 	ListViewHelper::AddRemoveExtendedStyles(m_hListView, LVS_EX_GRIDLINES,
 		m_config->globalFolderSettings.showGridlines.get());
@@ -375,8 +395,9 @@ void ShellBrowserImpl::SetViewModeInternal(ViewMode viewMode)
 
 	if (viewMode != +ViewMode::Details)
 	{
-		m_columnThreadPool.clear_queue();
-		m_columnResults.clear();
+		m_columnTaskGroup.CancelPendingTasks();
+		m_columnTextScheduler->Clear();
+		QueuePendingGroupColumnTasks();
 	}
 
 	if (viewMode != +ViewMode::Details && viewMode != +ViewMode::Tiles)
@@ -412,6 +433,12 @@ void ShellBrowserImpl::SetViewModeInternal(ViewMode viewMode)
 
 void ShellBrowserImpl::SetFirstColumnTextToCallback()
 {
+	// The text for items in a virtual listview is always retrieved on demand.
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	int numItems = ListView_GetItemCount(m_hListView);
 
 	for (int i = 0; i < numItems; i++)
@@ -422,6 +449,11 @@ void ShellBrowserImpl::SetFirstColumnTextToCallback()
 
 void ShellBrowserImpl::SetFirstColumnTextToFilename()
 {
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	int numItems = ListView_GetItemCount(m_hListView);
 
 	for (int i = 0; i < numItems; i++)
@@ -598,21 +630,91 @@ void ShellBrowserImpl::SelectItems(const std::vector<PidlAbsolute> &pidls)
 	}
 }
 
-int ShellBrowserImpl::LocateFileItemIndex(const TCHAR *szFileName) const
+void ShellBrowserImpl::InvertSelection()
 {
-	LV_FINDINFO lvFind;
-	int iItem;
-	int iInternalIndex;
+	if (!m_virtualListView)
+	{
+		// The listview will send a notification for each item, which is what the selection totals
+		// will be updated from.
+		ListViewHelper::InvertSelection(m_hListView);
+		return;
+	}
 
-	iInternalIndex = LocateFileItemInternalIndex(szFileName);
+	m_directoryState.selectionTracker.InvertSelection();
+	SyncVirtualListViewSelection();
+	QueueSelectionChangedNotification();
+}
 
-	if (iInternalIndex != -1)
+// Selects (or deselects) every item whose name matches. The names are all matched up front, off the
+// UI thread where there are enough of them, and the resulting set of matches is then applied to the
+// listview as a single batch.
+void ShellBrowserImpl::SelectItemsMatching(const NamePatternMatcher &matcher, bool select)
+{
+	int numItems =
+		m_virtualListView ? m_listViewItemModel.GetCount() : ListView_GetItemCount(m_hListView);
+
+	std::vector<int> internalIndexes;
+	std::vector<std::wstring_view> names;
+	internalIndexes.reserve(numItems);
+	names.reserve(numItems);
+
+	for (int i = 0; i < numItems; i++)
+	{
+		int internalIndex = GetItemInternalIndex(i);
+		internalIndexes.push_back(internalIndex);
+		names.emplace_back(m_itemInfoMap.at(internalIndex).wfd.cFileName);
+	}
+
+	auto matchSet = matcher.MatchNames(names, m_app->GetRuntime()->GetBackgroundWorkPool());
+
+	if (matchSet.GetNumMatches() == 0)
+	{
+		return;
+	}
+
+	if (!m_virtualListView)
+	{
+		// The listview will send a notification for each item, which is what the selection totals
+		// will be updated from. Those notifications are cheap and the resulting selection change
+		// notification is only sent once.
+		ScopedRedrawDisabler redrawDisabler(m_hListView);
+
+		for (int i = 0; i < numItems; i++)
+		{
+			if (matchSet.IsMatch(i))
+			{
+				ListViewHelper::SelectItem(m_hListView, i, select);
+			}
+		}
+
+		return;
+	}
+
+	bool selectionChanged = false;
+
+	for (int i = 0; i < numItems; i++)
 	{
-		lvFind.flags = LVFI_PARAM;
-		lvFind.lParam = iInternalIndex;
-		iItem = ListView_FindItem(m_hListView, -1, &lvFind);
+		if (matchSet.IsMatch(i)
+			&& m_directoryState.selectionTracker.SetSelected(internalIndexes[i], select))
+		{
+			selectionChanged = true;
+		}
+	}
 
-		return iItem;
+	if (selectionChanged)
+	{
+		SyncVirtualListViewSelection();
+		QueueSelectionChangedNotification();
+	}
+}
+
+int ShellBrowserImpl::LocateFileItemIndex(const TCHAR *szFileName) const
+{
+	int iInternalIndex = LocateFileItemInternalIndex(szFileName);
+
+	if (iInternalIndex != -1)
+	{
+		return LocateItemByInternalIndex(iInternalIndex).value_or(-1);
 	}
 
 	return -1;
@@ -620,7 +722,7 @@ int ShellBrowserImpl::LocateFileItemIndex(const TCHAR *szFileName) const
 
 int ShellBrowserImpl::LocateFileItemInternalIndex(const TCHAR *szFileName) const
 {
-	for (int i = 0; i < m_directoryState.numItems; i++)
+	for (int i = 0; i < m_directoryState.selectionTracker.GetNumItems(); i++)
 	{
 		const auto &item = GetItemByIndex(i);
 
@@ -647,19 +749,29 @@ std::optional<int> ShellBrowserImpl::GetItemIndexForPidl(PCIDLIST_ABSOLUTE pidl)
 
 std::optional<int> ShellBrowserImpl::GetItemInternalIndexForPidl(PCIDLIST_ABSOLUTE pidl) const
 {
-	auto itr = std::find_if(m_itemInfoMap.begin(), m_itemInfoMap.end(), [pidl](const auto &pair)
-		{ return ArePidlsEquivalent(pidl, pair.second.pidlComplete.Raw()); });
+	std::optional<std::wstring> parsingName;
+	std::wstring currentParsingName;
+	HRESULT hr = GetDisplayName(pidl, SHGDN_FORPARSING, currentParsingName);
 
-	if (itr == m_itemInfoMap.end())
+	if (SUCCEEDED(hr))
 	{
-		return std::nullopt;
+		parsingName = currentParsingName;
 	}
 
-	return itr->first;
+	// The name index only narrows down the set of items that need to be checked. The final
+	// comparison is still performed by the shell.
+	return m_itemNameIndex.FindEquivalentItem(parsingName,
+		[this, pidl](int internalIndex)
+		{ return ArePidlsEquivalent(pidl, m_itemInfoMap.at(internalIndex).pidlComplete.Raw()); });
 }
 
 std::optional<int> ShellBrowserImpl::LocateItemByInternalIndex(int internalIndex) const
 {
+	if (m_virtualListView)
+	{
+		return m_listViewItemModel.GetPosition(internalIndex);
+	}
+
 	LVFINDINFO lvfi;
 	lvfi.flags = LVFI_PARAM;
 	lvfi.lParam = internalIndex;
@@ -744,80 +856,104 @@ int ShellBrowserImpl::GenerateUniqueItemId()
 	return m_directoryState.itemIDCounter++;
 }
 
-int ShellBrowserImpl::DetermineItemSortedPosition(LPARAM lParam) const
+// Items in the listview are expected to already be in sorted order, so the position can be found
+// using a binary search. The item will be inserted before the first item (at or after first) it
+// doesn't compare greater than.
+int ShellBrowserImpl::DetermineItemSortedPosition(LPARAM lParam, int first) const
 {
-	LVITEM lvItem;
-	BOOL bItem;
-	int res = 1;
-	int nItems = 0;
-	int i = 0;
-
-	nItems = ListView_GetItemCount(m_hListView);
+	int count = ListView_GetItemCount(m_hListView) - first;
 
-	while (res > 0 && i < nItems)
+	while (count > 0)
 	{
-		lvItem.mask = LVIF_PARAM;
-		lvItem.iItem = i;
-		lvItem.iSubItem = 0;
-		bItem = ListView_GetItem(m_hListView, &lvItem);
+		int step = count / 2;
+		int middle = first + step;
 
-		if (bItem)
+		if (Sort(static_cast<int>(lParam), GetItemInternalIndex(middle)) > 0)
 		{
-			res = Sort(static_cast<int>(lParam), static_cast<int>(lvItem.lParam));
+			first = middle + 1;
+			count -= step + 1;
 		}
 		else
 		{
-			res = 0;
+			count = step;
 		}
-
-		i++;
 	}
 
-	/* The item will always be inserted BEFORE
-	the item at position i that we specify here.
-	For example, specifying 0, will place the item
-	at 0 (and push 0 to 1), specifying 1 will place
-	the item at 1 (and push 1 to 2).
-	Therefore, to place in the last position, need
-	to place AFTER last item. */
-	if ((i - 1) == nItems - 1 && res > 0)
+	return first;
+}
+
+// Adds the specified items (none of which should currently be in the listview) to the list of
+// items awaiting insertion, with each item placed in its sorted position. The items are sorted
+// first, so that each item's position only has to be searched for after the position of the
+// previous item.
+void ShellBrowserImpl::QueueItemsForSortedInsertion(std::vector<int> internalIndexes)
+{
+	auto compare = [this](int internalIndex1, int internalIndex2)
+	{ return Sort(internalIndex1, internalIndex2) < 0; };
+
+	if (SortKeyStore::IsSortModeSupported(m_folderSettings.sortMode))
 	{
-		i++;
+		ParallelStableSort(internalIndexes.begin(), internalIndexes.end(), compare,
+			m_app->GetRuntime()->GetBackgroundWorkPool());
 	}
+	else
+	{
+		std::stable_sort(internalIndexes.begin(), internalIndexes.end(), compare);
+	}
+
+	int currentItem = 0;
+	int numQueued = 0;
+
+	for (int internalIndex : internalIndexes)
+	{
+		currentItem = DetermineItemSortedPosition(internalIndex, currentItem);
+
+		// Each of the previously queued items will be inserted before this one, which shifts the
+		// final position of this item along.
+		int sortedPosition = currentItem + numQueued;
 
-	return i - 1;
+		AwaitingAdd_t awaitingAdd;
+		awaitingAdd.iItem = sortedPosition;
+		awaitingAdd.bPosition = TRUE;
+		awaitingAdd.iAfter = sortedPosition - 1;
+		awaitingAdd.iItemInternal = internalIndex;
+		m_directoryState.awaitingAddList.push_back(awaitingAdd);
+
+		numQueued++;
+	}
 }
 
 int ShellBrowserImpl::GetNumItems() const
 {
-	return m_directoryState.numItems;
+	return m_directoryState.selectionTracker.GetNumItems();
 }
 
 int ShellBrowserImpl::GetNumSelectedFiles() const
 {
-	return m_directoryState.numFilesSelected;
+	return m_directoryState.selectionTracker.GetSelectionTotals().numFiles;
 }
 
 int ShellBrowserImpl::GetNumSelectedFolders() const
 {
-	return m_directoryState.numFoldersSelected;
+	return m_directoryState.selectionTracker.GetSelectionTotals().numFolders;
 }
 
 int ShellBrowserImpl::GetNumSelected() const
 {
-	return m_directoryState.numFilesSelected + m_directoryState.numFoldersSelected;
+	const auto &totals = m_directoryState.selectionTracker.GetSelectionTotals();
+	return totals.numFiles + totals.numFolders;
 }
 
 // Returns the total size of the items in the current directory (not including any sub-directories).
 uint64_t ShellBrowserImpl::GetTotalDirectorySize()
 {
-	return m_directoryState.totalDirSize;
+	return m_directoryState.selectionTracker.GetItemTotals().size;
 }
 
 // Returns the size of the currently selected items.
 uint64_t ShellBrowserImpl::GetSelectionSize()
 {
-	return m_directoryState.fileSelectionSize;
+	return m_directoryState.selectionTracker.GetSelectionTotals().size;
 }
 
 void ShellBrowserImpl::VerifySortMode()
@@ -973,7 +1109,9 @@ void ShellBrowserImpl::OnDeviceChange(UINT eventType, LONG_PTR eventData)
 
 					if (SUCCEEDED(hr))
 					{
-						OnItemAdded(simplePidl.Raw());
+						PendingItemChanges pendingChanges;
+						OnItemAdded(simplePidl.Raw(), pendingChanges);
+						ApplyPendingItemChanges(pendingChanges);
 					}
 				}
 			}
@@ -1042,18 +1180,15 @@ void ShellBrowserImpl::UpdateDriveIcon(const TCHAR *szDrive)
 
 	if (SUCCEEDED(hr))
 	{
-		for (i = 0; i < m_directoryState.numItems; i++)
+		for (i = 0; i < m_directoryState.selectionTracker.GetNumItems(); i++)
 		{
-			lvItem.mask = LVIF_PARAM;
-			lvItem.iItem = i;
-			lvItem.iSubItem = 0;
-			ListView_GetItem(m_hListView, &lvItem);
+			int internalIndex = GetItemInternalIndex(i);
 
 			if (ArePidlsEquivalent(pidlDrive.get(),
-					m_itemInfoMap.at((int) lvItem.lParam).pidlComplete.Raw()))
+					m_itemInfoMap.at(internalIndex).pidlComplete.Raw()))
 			{
 				iItem = i;
-				iItemInternal = (int) lvItem.lParam;
+				iItemInternal = internalIndex;
 
 				break;
 			}
@@ -1064,7 +1199,22 @@ void ShellBrowserImpl::UpdateDriveIcon(const TCHAR *szDrive)
 	{
 		SHGetFileInfo(szDrive, 0, &shfi, sizeof(shfi), SHGFI_SYSICONINDEX);
 
-		m_itemInfoMap.at(iItemInternal).displayName = displayName;
+		auto &itemInfo = m_itemInfoMap.at(iItemInternal);
+		itemInfo.displayName = displayName;
+
+		// The color rule that applies to the item may have changed along with its name.
+		itemInfo.colorRuleGeneration = 0;
+
+		UpdateItemSortKeys(iItemInternal);
+
+		if (m_virtualListView)
+		{
+			// The display name will be retrieved from the item when the item is redrawn.
+			m_listViewItemModel.SetImage(iItemInternal, shfi.iIcon,
+				m_listViewItemModel.GetOverlay(iItemInternal));
+			ListView_RedrawItems(m_hListView, iItem, iItem);
+			return;
+		}
 
 		/* Update the drives icon and display name. */
 		lvItem.mask = LVIF_TEXT | LVIF_IMAGE;
@@ -1078,22 +1228,18 @@ void ShellBrowserImpl::UpdateDriveIcon(const TCHAR *szDrive)
 
 void ShellBrowserImpl::RemoveDrive(const TCHAR *szDrive)
 {
-	LVITEM lvItem;
 	int iItemInternal = -1;
 	int i = 0;
 
-	for (i = 0; i < m_directoryState.numItems; i++)
+	for (i = 0; i < m_directoryState.selectionTracker.GetNumItems(); i++)
 	{
-		lvItem.mask = LVIF_PARAM;
-		lvItem.iItem = i;
-		lvItem.iSubItem = 0;
-		ListView_GetItem(m_hListView, &lvItem);
+		int internalIndex = GetItemInternalIndex(i);
 
-		if (m_itemInfoMap.at((int) lvItem.lParam).bDrive)
+		if (m_itemInfoMap.at(internalIndex).bDrive)
 		{
-			if (lstrcmp(szDrive, m_itemInfoMap.at((int) lvItem.lParam).szDrive) == 0)
+			if (lstrcmp(szDrive, m_itemInfoMap.at(internalIndex).szDrive) == 0)
 			{
-				iItemInternal = (int) lvItem.lParam;
+				iItemInternal = internalIndex;
 				break;
 			}
 		}
@@ -5,23 +5,33 @@
 #pragma once
 
 #include "ClipboardOperations.h"
+#include "ColorRuleProgram.h"
 #include "ColumnDataRetrieval.h"
+#include "ColumnTextScheduler.h"
 #include "Columns.h"
+#include "DirectoryChangeCollapser.h"
+#include "DirectoryChangeQueue.h"
 #include "FolderSettings.h"
+#include "GroupDataRetrieval.h"
+#include "ItemNameIndex.h"
+#include "ListViewItemModel.h"
 #include "MainFontSetter.h"
+#include "SelectionTracker.h"
 #include "ServiceProvider.h"
 #include "ShellBrowser.h"
 #include "ShellChangeWatcher.h"
 #include "SignalWrapper.h"
+#include "SortKeyStore.h"
 #include "SortModes.h"
 #include "ViewModes.h"
+#include "../Helper/BackgroundWorkPool.h"
 #include "../Helper/ScopedStopSource.h"
 #include "../Helper/ShellDropTargetWindow.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/WeakPtr.h"
 #include "../Helper/WeakPtrFactory.h"
+#include "../Helper/WildcardPattern.h"
 #include "../Helper/WinRTBaseWrapper.h"
-#include "../ThirdParty/CTPL/cpl_stl.h"
 #include <boost/core/noncopyable.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
@@ -31,6 +41,8 @@
 #include <wil/com.h>
 #include <wil/resource.h>
 #include <thumbcache.h>
+#include <atomic>
+#include <chrono>
 #include <future>
 #include <list>
 #include <memory>
@@ -46,10 +58,12 @@ class AcceleratorManager;
 class App;
 struct BasicItemInfo_t;
 class CachedIcons;
+class ColumnValueCache;
 struct Config;
 class CoreInterface;
 class FileActionHandler;
 class IconFetcher;
+class NamePatternMatcher;
 struct PreservedFolderState;
 class PreservedHistoryEntry;
 class Runtime;
@@ -171,6 +185,8 @@ public:
 	void SetFileAttributesForSelection();
 
 	void SelectItems(const std::vector<PidlAbsolute> &pidls);
+	void InvertSelection();
+	void SelectItemsMatching(const NamePatternMatcher &matcher, bool select);
 	uint64_t GetTotalDirectorySize();
 	uint64_t GetSelectionSize();
 	int LocateFileItemIndex(const TCHAR *szFileName) const;
@@ -230,18 +246,26 @@ private:
 		when items need to be rearranged). */
 		int iRelativeSort;
 
-		ItemInfo_t() : wfd({}), isFindDataValid(false), bDrive(FALSE)
+		// The index of the color rule that applies to this item. This is determined the first
+		// time the item is drawn and is only valid while colorRuleGeneration matches
+		// m_colorRuleGeneration.
+		std::optional<size_t> colorRuleIndex;
+		int colorRuleGeneration;
+
+		// The text that's been retrieved for each column, keyed by column type. This is filled in
+		// as column results arrive and is used when grouping by a column's value, so that the
+		// value doesn't need to be retrieved a second time.
+		std::unordered_map<ColumnType::_integral, std::wstring> columnText;
+
+		// The collation keys for the item's name, if they were built when the item was retrieved.
+		// These are handed over to m_sortKeyStore once the item is registered.
+		std::optional<SortKeyStore::NameKeys> nameKeys;
+
+		ItemInfo_t() : wfd({}), isFindDataValid(false), bDrive(FALSE), colorRuleGeneration(0)
 		{
 		}
 	};
 
-	struct AlteredFile_t
-	{
-		TCHAR szFileName[MAX_PATH];
-		DWORD dwAction;
-		int iFolderIndex;
-	};
-
 	struct AwaitingAdd_t
 	{
 		int iItem;
@@ -251,6 +275,22 @@ private:
 		int iAfter;
 	};
 
+	// When a set of changes is applied to the directory, the work that would otherwise be
+	// repeated for each item (e.g. inserting items in their sorted positions, resorting the
+	// listview) is deferred, so that it can be done once, after all the changes have been
+	// processed.
+	struct PendingItemChanges
+	{
+		// Items that have been added, but not yet inserted into the listview.
+		std::vector<int> addedItems;
+
+		// Items that were filtered, but need to be shown again after being updated.
+		std::vector<int> unfilteredItems;
+
+		// Items that have been updated and need to be resorted and regrouped.
+		std::vector<int> updatedItems;
+	};
+
 	struct Added_t
 	{
 		TCHAR szFileName[MAX_PATH];
@@ -262,13 +302,6 @@ private:
 		POINT DropPoint;
 	};
 
-	struct ColumnResult_t
-	{
-		int itemInternalIndex;
-		ColumnType columnType;
-		std::wstring columnText;
-	};
-
 	struct ThumbnailResult_t
 	{
 		int itemInternalIndex;
@@ -281,22 +314,6 @@ private:
 		std::wstring infoTip;
 	};
 
-	struct GroupInfo
-	{
-		std::wstring name;
-		int relativeSortPosition;
-
-		explicit GroupInfo(const std::wstring &name) : name(name), relativeSortPosition(0)
-		{
-		}
-
-		GroupInfo(const std::wstring &name, int relativeSortPosition) :
-			name(name),
-			relativeSortPosition(relativeSortPosition)
-		{
-		}
-	};
-
 	struct ListViewGroup
 	{
 	public:
@@ -317,11 +334,16 @@ private:
 		static inline int idCounter = 0;
 	};
 
-	enum class GroupByDateType
+	struct GroupResult
 	{
-		Created,
-		Modified,
-		Accessed
+		int internalIndex;
+
+		// The index of the item at the point the group was requested. Unless items have since
+		// been inserted or removed, the item will still be at this index when the result is
+		// applied, which avoids having to search for it.
+		int indexHint;
+
+		std::optional<GroupInfo> groupInfo;
 	};
 
 	// clang-format off
@@ -337,11 +359,35 @@ private:
 	>;
 	// clang-format on
 
+	// Tracks the retrieval of item information for the current folder, which happens in the
+	// background once a navigation has been committed.
+	struct ItemRetrievalState
+	{
+		std::optional<NavigateParams> navigateParams;
+		std::chrono::steady_clock::time_point startTime;
+		int numChunksRemaining = 0;
+
+		// Items that have been retrieved, but not yet inserted into the view.
+		std::vector<ItemInfo_t> retrievedItems;
+		size_t nextBatchSize = 0;
+		bool firstBatchInserted = false;
+
+		bool inProgress = false;
+
+		// Directory monitoring starts before any items have been retrieved, so that no changes are
+		// missed. Until retrieval has finished, however, the items that a change refers to may not
+		// have been added yet, so changes that arrive in the meantime are held back and applied
+		// once retrieval is complete.
+		std::vector<ShellChangeNotification> deferredShellChanges;
+		bool directoryChangesDeferred = false;
+	};
+
 	struct DirectoryState
 	{
 		PidlAbsolute pidlDirectory;
 		std::wstring directory;
 		bool virtualFolder;
+		bool isRecycleBin;
 		int itemIDCounter;
 
 		/* Stores information on files that have
@@ -362,11 +408,8 @@ private:
 		// it has been added.
 		PidlAbsolute queuedRenameItem;
 
-		int numItems;
-		int numFilesSelected;
-		int numFoldersSelected;
-		uint64_t totalDirSize;
-		uint64_t fileSelectionSize;
+		// Tracks the items currently shown in the listview and which of those items are selected.
+		SelectionTracker selectionTracker;
 
 		/* Cached folder size data. */
 		mutable std::unordered_map<int, ULONGLONG> cachedFolderSizes;
@@ -378,16 +421,18 @@ private:
 
 		ListViewGroupSet groups;
 
+		// Items that have been placed in the temporary "Loading" group, while their actual group
+		// is determined in the background.
+		std::unordered_set<int> pendingGroupItems;
+
+		ItemRetrievalState itemRetrieval;
+
 		std::unique_ptr<ScopedStopSource> scopedStopSource;
 
 		DirectoryState() :
 			virtualFolder(false),
+			isRecycleBin(false),
 			itemIDCounter(0),
-			numItems(0),
-			numFilesSelected(0),
-			numFoldersSelected(0),
-			totalDirSize(0),
-			fileSelectionSize(0),
 			scopedStopSource(std::make_unique<ScopedStopSource>())
 		{
 		}
@@ -396,17 +441,54 @@ private:
 	static const UINT WM_APP_COLUMN_RESULT_READY = WM_APP + 150;
 	static const UINT WM_APP_THUMBNAIL_RESULT_READY = WM_APP + 151;
 	static const UINT WM_APP_INFO_TIP_READY = WM_APP + 152;
+	static const UINT WM_APP_GROUP_RESULTS_READY = WM_APP + 153;
+	static const UINT WM_APP_SELECTION_CHANGED = WM_APP + 154;
+
+	static constexpr size_t ITEM_RETRIEVAL_CHUNK_SIZE = 256;
+
+	// The number of items whose groups are determined by each background task when regrouping in
+	// one of the slow group modes.
+	static constexpr size_t GROUPING_CHUNK_SIZE = 256;
+
+	// Column results are applied to the listview at most once per frame.
+	static constexpr auto COLUMN_RESULTS_INTERVAL = std::chrono::milliseconds(16);
+
+	// The listview uses several timers internally, so this needs to be distinct from the IDs it
+	// uses.
+	static const UINT_PTR COLUMN_RESULTS_TIMER_ID = 1000;
 
-	static HWND CreateListView(HWND parent);
+	// The maximum number of directory changes (and the total length of their names) that can be
+	// queued between updates. If either limit is exceeded, the directory will be refreshed.
+	static constexpr size_t MAX_QUEUED_DIRECTORY_CHANGES = 4096;
+	static constexpr size_t MAX_QUEUED_DIRECTORY_CHANGE_NAME_CHARACTERS = 128 * 1024;
+
+	// Directory changes are applied in batches, at most once per interval.
+	static constexpr UINT DIRECTORY_CHANGES_INTERVAL = 200;
+
+	static HWND CreateListView(HWND parent, bool virtualListView);
 	void InitializeListView();
 	int GenerateUniqueItemId();
 	void MarkItemAsCut(int item, bool cut);
+	void SetItemCutState(int item, bool cut);
+	void DeleteListViewItem(int item);
 	void VerifySortMode();
 
 	/* Browsing support. */
-	HRESULT PerformEnumeration(NavigateParams &navigateParams, std::vector<ItemInfo_t> &items);
+	HRESULT PerformEnumeration(NavigateParams &navigateParams, std::vector<PidlChild> &pidls);
 	static HRESULT EnumerateFolder(PCIDLIST_ABSOLUTE pidlDirectory, HWND owner, bool showHidden,
+		std::vector<PidlChild> &pidls);
+	void StartRetrievingItems(std::vector<PidlChild> &&pidls, const NavigateParams &navigateParams,
+		std::chrono::steady_clock::time_point startTime);
+	static concurrencpp::null_result RetrieveItemChunk(WeakPtr<ShellBrowserImpl> weakSelf,
+		PidlAbsolute pidlDirectory, std::vector<PidlChild> pidls, int folderId, Runtime *runtime,
+		std::stop_token stopToken);
+	static HRESULT RetrieveItems(PCIDLIST_ABSOLUTE pidlDirectory,
+		const std::vector<PidlChild> &pidls, std::stop_token stopToken,
 		std::vector<ItemInfo_t> &items);
+	void OnItemChunkRetrieved(int folderId, std::vector<ItemInfo_t> &&items);
+	void InsertRetrievedItems();
+	void StartDirectoryMonitoringIfNecessary();
+	void ApplyDeferredDirectoryChanges();
 	static std::optional<ItemInfo_t> GetItemInformation(IShellFolder *shellFolder,
 		PCIDLIST_ABSOLUTE pidlDirectory, PCITEMID_CHILD pidlChild);
 	void CommitNavigation(const NavigateParams &navigateParams);
@@ -414,13 +496,15 @@ private:
 	void ClearPendingResults();
 	void StoreCurrentlySelectedItems();
 	void ResetFolderState();
-	void OnEnumerationCompleted(std::vector<ItemInfo_t> &&items,
-		const NavigateParams &navigateParams);
+	void OnEnumerationCompleted();
 	void InsertAwaitingItems();
+	void InsertListViewItem(const AwaitingAdd_t &awaitingItem);
 	BOOL IsFileFiltered(const ItemInfo_t &itemInfo) const;
 	std::optional<int> AddItemInternal(IShellFolder *shellFolder, PCIDLIST_ABSOLUTE pidlDirectory,
 		PCITEMID_CHILD pidlChild, int itemIndex, BOOL setPosition);
 	int AddItemInternal(int itemIndex, ItemInfo_t itemInfo, BOOL setPosition);
+	int RegisterItem(ItemInfo_t itemInfo);
+	void QueueItemForInsertion(int internalIndex, int itemIndex, BOOL setPosition);
 	static HRESULT ExtractFindDataUsingPropertyStore(IShellFolder *shellFolder,
 		PCITEMID_CHILD pidlChild, WIN32_FIND_DATA &output);
 	void SetViewModeInternal(ViewMode viewMode);
@@ -436,6 +520,7 @@ private:
 	LRESULT ListViewParentProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 	static int CALLBACK SortStub(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort);
+	static int CALLBACK SortByPositionStub(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort);
 
 	/* Message handlers. */
 	void ColumnClicked(int iClickedColumn);
@@ -447,6 +532,7 @@ private:
 	void OnRButtonDown(HWND hwnd, BOOL doubleClick, int x, int y, UINT keyFlags);
 	bool OnMouseWheel(int xPos, int yPos, int delta, UINT keys);
 	void OnListViewGetDisplayInfo(LPARAM lParam);
+	int GetInitialItemImage(int internalIndex);
 	LRESULT OnListViewGetInfoTip(NMLVGETINFOTIP *getInfoTip);
 	BOOL OnListViewGetEmptyMarkup(NMLVEMPTYMARKUP *emptyMarkup);
 	void QueueInfoTipTask(int internalIndex, const std::wstring &existingInfoTip);
@@ -456,7 +542,10 @@ private:
 	void ProcessInfoTipResult(int infoTipResultId);
 	void OnListViewItemInserted(const NMLISTVIEW *itemData);
 	void OnListViewItemChanged(const NMLISTVIEW *changeData);
-	void UpdateFileSelectionInfo(int internalIndex, BOOL selected);
+	void AddTrackedItem(int internalIndex);
+	void UpdateTrackedItem(int internalIndex);
+	void QueueSelectionChangedNotification();
+	void OnSelectionChangedNotification();
 	void OnListViewKeyDown(const NMLVKEYDOWN *lvKeyDown);
 	std::vector<PidlAbsolute> GetSelectedItemPidls() const;
 	void OnListViewBeginDrag(const NMLISTVIEW *info);
@@ -466,6 +555,7 @@ private:
 	BOOL OnListViewEndLabelEdit(const NMLVDISPINFO *dispInfo);
 	LRESULT OnListViewCustomDraw(NMLVCUSTOMDRAW *listViewCustomDraw);
 	void OnColorRulesUpdated();
+	std::optional<size_t> GetItemColorRuleIndex(ItemInfo_t &itemInfo);
 	void OnFullRowSelectUpdated(BOOL newValue);
 	void OnCheckBoxSelectionUpdated(BOOL newValue);
 	void OnShowGridlinesUpdated(BOOL newValue);
@@ -493,22 +583,28 @@ private:
 
 	/* Sorting. */
 	void SortFolder();
+	void SortListViewInParallel();
 	int CALLBACK Sort(int InternalIndex1, int InternalIndex2) const;
+	int SortUsingItemInfo(int internalIndex1, int internalIndex2) const;
+	void UpdateItemSortKeys(int internalIndex);
 
 	/* Listview column support. */
 	void AddFirstColumn();
 	void SetUpListViewColumns();
 	void DeleteAllColumns();
 	void QueueColumnTask(int itemInternalIndex, ColumnType columnType);
-	static ColumnResult_t GetColumnTextAsync(HWND listView, int columnResultId,
-		ColumnType columnType, int internalIndex, const BasicItemInfo_t &basicItemInfo,
-		const GlobalFolderSettings &globalFolderSettings);
+	static void RetrieveColumnText(ColumnTextScheduler *columnTextScheduler,
+		ColumnValueCache *columnValueCache, HWND listView, std::stop_token stopToken);
 	void InsertColumn(ColumnType columnType, int columnIndex, int width);
 	void SetActiveColumnSet();
 	void GetColumnInternal(ColumnType columnType, Column_t *pci) const;
 	Column_t GetFirstCheckedColumn();
 	void SaveColumnWidths();
-	void ProcessColumnResult(int columnResultId);
+	void ProcessColumnResults();
+	void ApplyColumnResult(const ColumnTextScheduler::Result &result);
+	bool UpdateFolderSizeSortKey(int internalIndex);
+	void UpdateColumnTaskPriorities();
+	void LogColumnTextMetrics() const;
 	std::optional<int> GetColumnIndexByType(ColumnType columnType) const;
 	std::optional<ColumnType> GetColumnTypeByIndex(int index) const;
 
@@ -520,17 +616,25 @@ private:
 	void StartDirectoryMonitoring(PCIDLIST_ABSOLUTE pidl);
 	void ProcessShellChangeNotifications(
 		const std::vector<ShellChangeNotification> &shellChangeNotifications);
-	void ProcessShellChangeNotification(const ShellChangeNotification &change);
-	void OnItemAdded(PCIDLIST_ABSOLUTE simplePidl);
-	void AddItem(PCIDLIST_ABSOLUTE pidl);
+	void ProcessShellChangeNotification(const ShellChangeNotification &change,
+		PendingItemChanges &pendingChanges);
+	void ApplyDirectoryChange(IShellFolder *parent, const DirectoryChange &change,
+		PendingItemChanges &pendingChanges);
+	void ApplyPendingItemChanges(const PendingItemChanges &pendingChanges);
+	void OnItemAdded(PCIDLIST_ABSOLUTE simplePidl, PendingItemChanges &pendingChanges);
+	void AddItem(PCIDLIST_ABSOLUTE pidl, PendingItemChanges &pendingChanges);
 	void RemoveItem(int iItemInternal);
-	void OnItemRemoved(PCIDLIST_ABSOLUTE simplePidl);
-	void OnItemModified(PCIDLIST_ABSOLUTE simplePidl);
-	void UpdateItem(PCIDLIST_ABSOLUTE pidl, PCIDLIST_ABSOLUTE updatedPidl = nullptr);
-	void OnItemRenamed(PCIDLIST_ABSOLUTE simplePidlOld, PCIDLIST_ABSOLUTE simplePidlNew);
+	void DiscardItem(int internalIndex);
+	void OnItemRemoved(PCIDLIST_ABSOLUTE simplePidl, PendingItemChanges &pendingChanges);
+	void OnItemModified(PCIDLIST_ABSOLUTE simplePidl, PendingItemChanges &pendingChanges);
+	void UpdateItem(PCIDLIST_ABSOLUTE pidl, PCIDLIST_ABSOLUTE updatedPidl,
+		PendingItemChanges &pendingChanges);
+	void OnItemRenamed(PCIDLIST_ABSOLUTE simplePidlOld, PCIDLIST_ABSOLUTE simplePidlNew,
+		PendingItemChanges &pendingChanges);
 	void InvalidateAllColumnsForItem(int itemIndex);
 	void InvalidateIconForItem(int itemIndex);
-	int DetermineItemSortedPosition(LPARAM lParam) const;
+	int DetermineItemSortedPosition(LPARAM lParam, int first = 0) const;
+	void QueueItemsForSortedInsertion(std::vector<int> internalIndexes);
 	static concurrencpp::null_result OnCurrentDirectoryRenamed(WeakPtr<ShellBrowserImpl> weakSelf,
 		PidlAbsolute simplePidlUpdated, Runtime *runtime, std::stop_token stopToken);
 	static concurrencpp::null_result OnDirectoryPropertiesChanged(
@@ -543,13 +647,18 @@ private:
 		std::stop_token stopToken);
 
 	/* Filtering support. */
+	void UpdateFilterPattern();
 	void UpdateFiltering();
+	void ReapplyFilter(bool filterNarrowed);
 	void RemoveFilteredItems();
 	void RemoveFilteredItem(int iItem, int iItemInternal);
+	void OnItemFiltered(int iItemInternal);
 	BOOL IsFilenameFiltered(const TCHAR *FileName) const;
 	void UnfilterAllItems();
 	void UnfilterItem(int internalIndex);
 	void RestoreFilteredItem(int internalIndex);
+	void RestoreFilteredItems(const std::vector<int> &internalIndexes);
+	void ExcludeFilteredItems(std::vector<int> &internalIndexes);
 
 	/* Listview group support. */
 	static int CALLBACK GroupComparisonStub(int id1, int id2, void *data);
@@ -558,28 +667,20 @@ private:
 	int GroupRelativePositionComparison(const ListViewGroup &group1, const ListViewGroup &group2);
 	const ListViewGroup GetListViewGroupById(int groupId);
 	int DetermineItemGroup(int iItemInternal);
-	std::optional<GroupInfo> DetermineItemNameGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemSizeGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemTotalSizeGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemTypeGroupVirtual(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemDateGroup(const BasicItemInfo_t &itemInfo,
-		GroupByDateType dateType) const;
-	std::optional<GroupInfo> DetermineItemSummaryGroup(const BasicItemInfo_t &itemInfo,
-		const SHCOLUMNID *pscid, const GlobalFolderSettings &globalFolderSettings) const;
-	std::optional<GroupInfo> DetermineItemFreeSpaceGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemAttributeGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemOwnerGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemVersionGroup(const BasicItemInfo_t &itemInfo,
-		const TCHAR *szVersionType) const;
-	std::optional<GroupInfo> DetermineItemCameraPropertyGroup(const BasicItemInfo_t &itemInfo,
-		PROPID PropertyId) const;
-	std::optional<GroupInfo> DetermineItemExtensionGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemFileSystemGroup(const BasicItemInfo_t &itemInfo) const;
-	std::optional<GroupInfo> DetermineItemNetworkStatus(const BasicItemInfo_t &itemInfo) const;
+	std::optional<GroupInfo> DetermineItemGroupInfo(const BasicItemInfo_t &basicItemInfo,
+		SortMode groupMode) const;
+	int GetLoadingGroupId();
 
 	/* Other grouping support. */
 	int GetOrCreateListViewGroup(const GroupInfo &groupInfo);
 	void MoveItemsIntoGroups();
+	std::vector<std::vector<std::pair<int, int>>> BuildGroupingChunks() const;
+	std::future<std::vector<GroupResult>> QueueGroupingTask(
+		std::vector<std::pair<int, int>> items, int groupResultId);
+	void ProcessGroupResults(int groupResultId);
+	void ApplyGroupResults(const std::vector<GroupResult> &results);
+	void CancelGroupingTasks();
+	void QueuePendingGroupColumnTasks();
 	void InsertItemIntoGroup(int index, int groupId);
 	void EnsureGroupExistsInListView(int groupId);
 	void InsertGroupIntoListView(const ListViewGroup &listViewGroup);
@@ -593,6 +694,20 @@ private:
 	/* Listview icons. */
 	void ProcessIconResult(int internalIndex, int iconIndex, int overlayIndex);
 
+	/* Virtual listview support. */
+	void OnVirtualListViewGetDisplayInfo(LVITEM *item);
+	std::wstring GetVirtualListViewItemText(int internalIndex, int subItem);
+	void OnVirtualListViewItemChanged(const NMLISTVIEW *changeData);
+	void OnVirtualListViewItemRangeChanged(const NMLVODSTATECHANGE *stateChange);
+	void UpdateVirtualListViewItemSelection(int firstItem, int lastItem, bool selected);
+	LRESULT OnVirtualListViewFindItem(const NMLVFINDITEM *findItem);
+	void UpdateVirtualListViewItemCount();
+	void SortVirtualListView(const ListViewItemModel::Comparator &comparator,
+		bool allowParallel = false);
+	int CompareVirtualListViewItems(int internalIndex1, int internalIndex2);
+	void SyncVirtualListViewSelection();
+	void RedrawVirtualListViewItem(int internalIndex);
+
 	/* Thumbnails view. */
 	void QueueThumbnailTask(int internalIndex);
 	std::optional<int> GetCachedThumbnailIndex(const ItemInfo_t &itemInfo);
@@ -642,6 +757,10 @@ private:
 
 	App *const m_app;
 
+	// Set when the listview was created with LVS_OWNERDATA. This can't be changed once the listview
+	// has been created.
+	const bool m_virtualListView;
+
 	std::vector<std::unique_ptr<ShellBrowserHelperBase>> m_helpers;
 
 	NavigationStartedSignal m_navigationStartedSignal;
@@ -669,18 +788,35 @@ private:
 	as display name. */
 	std::unordered_map<int, ItemInfo_t> m_itemInfoMap;
 
-	ctpl::thread_pool m_columnThreadPool;
-	std::unordered_map<int, std::future<ColumnResult_t>> m_columnResults;
-	int m_columnResultIDCounter;
+	// Holds the values used to sort the items in m_itemInfoMap. Needs to be updated whenever an
+	// item is added, updated or removed.
+	SortKeyStore m_sortKeyStore;
+
+	// Allows items in m_itemInfoMap to be looked up by their parsing name. Needs to be updated
+	// whenever an item is added, renamed or removed.
+	ItemNameIndex m_itemNameIndex;
+
+	// In virtual listview mode, holds the display order and state of each item. Unused otherwise.
+	// The selection state is read from m_directoryState.selectionTracker.
+	ListViewItemModel m_listViewItemModel;
+	bool m_syncingVirtualListViewSelection;
+
+	// Set when a WM_APP_SELECTION_CHANGED message has been posted, but not yet processed.
+	bool m_selectionChangedNotificationQueued = false;
+
+	// Shared with the column tasks, which can outlive this instance.
+	std::shared_ptr<ColumnTextScheduler> m_columnTextScheduler;
+	std::chrono::steady_clock::time_point m_lastColumnResultsTime;
+	TaskGroup m_columnTaskGroup;
 
 	std::unique_ptr<IconFetcher> m_iconFetcher;
 	CachedIcons *m_cachedIcons;
 
-	ctpl::thread_pool m_thumbnailThreadPool;
+	TaskGroup m_thumbnailTaskGroup;
 	std::unordered_map<int, std::future<std::optional<ThumbnailResult_t>>> m_thumbnailResults;
 	int m_thumbnailResultIDCounter;
 
-	ctpl::thread_pool m_infoTipsThreadPool;
+	TaskGroup m_infoTipsTaskGroup;
 	std::unordered_map<int, std::future<std::optional<InfoTipResult>>> m_infoTipResults;
 	int m_infoTipResultIDCounter;
 
@@ -701,18 +837,34 @@ private:
 	const Config *m_config;
 	FolderSettings m_folderSettings;
 
+	// The compiled form of the filter in m_folderSettings. Needs to be updated whenever the filter
+	// text or case sensitivity changes.
+	WildcardPattern m_filterPattern;
+
+	// The color rules, compiled the first time an item is drawn after the rules change. Each
+	// change to the rules increments the generation, which invalidates the rule index cached in
+	// each item.
+	std::optional<ColorRuleProgram> m_colorRuleProgram;
+	int m_colorRuleGeneration = 1;
+
+	// When all the items are regrouped, their groups are determined on background threads. The
+	// tasks reference this instance, so this needs to be destroyed before any of the members
+	// those tasks use.
+	TaskGroup m_groupTaskGroup;
+	std::unordered_map<int, std::future<std::vector<GroupResult>>> m_groupResults;
+	int m_groupResultIDCounter = 0;
+
 	/* ID. */
 	std::optional<int> m_ID;
 
 	// Directory monitoring
 	ShellChangeWatcher m_shellChangeWatcher;
-	unique_pidl_absolute m_renamedItemOldPidl;
+	std::optional<std::wstring> m_renamedItemOldName;
 
-	/* Stores information on files that
-	have been modified (i.e. created, deleted,
-	renamed, etc). */
-	CRITICAL_SECTION m_csDirectoryAltered;
-	std::list<AlteredFile_t> m_AlteredList;
+	// Stores information on files that have been modified (i.e. created, deleted, renamed, etc).
+	// Changes are pushed by the directory monitoring thread and drained on the UI thread.
+	DirectoryChangeQueue m_directoryChangeQueue;
+	std::atomic<bool> m_directoryChangesTimerPending = false;
 
 	int m_middleButtonItem;
 
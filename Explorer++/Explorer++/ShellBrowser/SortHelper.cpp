@@ -64,43 +64,21 @@ int SortBySize(const BasicItemInfo_t &itemInfo1, const BasicItemInfo_t &itemInfo
 	bool isFolder1 = WI_IsFlagSet(itemInfo1.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY);
 	bool isFolder2 = WI_IsFlagSet(itemInfo2.wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY);
 
-	ULONGLONG size1;
-	ULONGLONG size2;
-
 	if (isFolder1 && isFolder2)
 	{
-		// Temporarily disabled.
-		/*auto itr1 = m_cachedFolderSizes.find(InternalIndex1);
-		auto itr2 = m_cachedFolderSizes.find(InternalIndex2);
-
-		if (itr1 == m_cachedFolderSizes.end() && itr2 == m_cachedFolderSizes.end())
-		{
-			return 0;
-		}
-		else if (itr1 != m_cachedFolderSizes.end() && itr2 == m_cachedFolderSizes.end())
-		{
-			return 1;
-		}
-		else if (itr1 == m_cachedFolderSizes.end() && itr2 != m_cachedFolderSizes.end())
-		{
-			return -1;
-		}
-
-		size1 = itr1->second;
-		size2 = itr2->second;*/
-
-		size1 = 0;
-		size2 = 0;
+		// Folder sizes are only held by SortKeyStore (see SortKeyStore::SetFolderSize()), which is
+		// what's used when sorting by size. They're not looked up here, since doing that for each
+		// comparison would be expensive. So two folders are considered equal, as they are in the
+		// store until their sizes are known.
+		return 0;
 	}
-	else
-	{
-		// Both items are files (as opposed to folders).
-		ULARGE_INTEGER fileSize1 = { itemInfo1.wfd.nFileSizeLow, itemInfo1.wfd.nFileSizeHigh };
-		ULARGE_INTEGER fileSize2 = { itemInfo2.wfd.nFileSizeLow, itemInfo2.wfd.nFileSizeHigh };
 
-		size1 = fileSize1.QuadPart;
-		size2 = fileSize2.QuadPart;
-	}
+	// Both items are files (as opposed to folders).
+	ULARGE_INTEGER fileSize1 = { itemInfo1.wfd.nFileSizeLow, itemInfo1.wfd.nFileSizeHigh };
+	ULARGE_INTEGER fileSize2 = { itemInfo2.wfd.nFileSizeLow, itemInfo2.wfd.nFileSizeHigh };
+
+	ULONGLONG size1 = fileSize1.QuadPart;
+	ULONGLONG size2 = fileSize2.QuadPart;
 
 	if (size1 > size2)
 	{
@@ -0,0 +1,341 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "SortKeyStore.h"
+#include "FolderSettings.h"
+#include "../Helper/Helper.h"
+#include <wil/common.h>
+
+namespace
+{
+
+uint64_t FileTimeToInteger(const FILETIME &fileTime)
+{
+	ULARGE_INTEGER value = { fileTime.dwLowDateTime, fileTime.dwHighDateTime };
+	return value.QuadPart;
+}
+
+}
+
+SortKeyStore::NameKey::NameKey(const std::wstring &name) :
+	natural(name, CollationKey::Type::Natural),
+	caseInsensitive(name, CollationKey::Type::CaseInsensitive)
+{
+}
+
+const CollationKey &SortKeyStore::NameKey::Get(bool useNaturalSortOrder) const
+{
+	return useNaturalSortOrder ? natural : caseInsensitive;
+}
+
+// Note that this can be called from any thread.
+SortKeyStore::NameKeys SortKeyStore::BuildNameKeys(const std::wstring &displayName,
+	const WIN32_FIND_DATA &wfd, bool isRoot, const std::wstring &parsingName)
+{
+	NameKeys nameKeys;
+	nameKeys.displayName = NameKey(displayName);
+
+	bool isFolder = WI_IsFlagSet(wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY);
+	auto extensionPosition = FindHideableExtension(displayName, isFolder);
+
+	if (extensionPosition)
+	{
+		nameKeys.displayNameWithoutExtension = NameKey(displayName.substr(0, *extensionPosition));
+	}
+
+	if (isRoot)
+	{
+		nameKeys.rootPath = NameKey(parsingName);
+	}
+
+	return nameKeys;
+}
+
+void SortKeyStore::SetItem(int internalIndex, const std::wstring &displayName,
+	const WIN32_FIND_DATA &wfd, bool isFindDataValid, bool isRoot, const std::wstring &parsingName,
+	std::optional<NameKeys> nameKeys)
+{
+	CHECK_GE(internalIndex, 0);
+
+	auto index = static_cast<size_t>(internalIndex);
+
+	if (index >= m_flags.size())
+	{
+		size_t newSize = index + 1;
+		m_flags.resize(newSize);
+		m_displayNames.resize(newSize);
+		m_rootPaths.resize(newSize);
+		m_nameKeys.resize(newSize);
+		m_extensions.resize(newSize);
+		m_attributeStrings.resize(newSize);
+		m_sizes.resize(newSize);
+		m_creationTimes.resize(newSize);
+		m_lastWriteTimes.resize(newSize);
+		m_lastAccessTimes.resize(newSize);
+	}
+
+	bool isFolder = WI_IsFlagSet(wfd.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY);
+	uint8_t flags = ItemFlags::Present;
+	WI_SetFlagIf(flags, ItemFlags::Folder, isFolder);
+	WI_SetFlagIf(flags, ItemFlags::FindDataValid, isFindDataValid);
+	WI_SetFlagIf(flags, ItemFlags::Root, isRoot);
+
+	auto extensionPosition = FindHideableExtension(displayName, isFolder);
+
+	if (extensionPosition)
+	{
+		WI_SetFlag(flags, ItemFlags::ExtensionHideable);
+		WI_SetFlagIf(flags, ItemFlags::Link,
+			lstrcmpi(displayName.c_str() + *extensionPosition, _T(".lnk")) == 0);
+	}
+
+	std::wstring rootPath = isRoot ? parsingName : std::wstring();
+
+	if (nameKeys)
+	{
+		m_nameKeys[index] = std::move(*nameKeys);
+	}
+	else if (!HasItem(internalIndex) || m_displayNames[index] != displayName
+		|| m_rootPaths[index] != rootPath || IsFolder(internalIndex) != isFolder)
+	{
+		m_nameKeys[index] = BuildNameKeys(displayName, wfd, isRoot, parsingName);
+	}
+
+	m_displayNames[index] = displayName;
+	m_rootPaths[index] = std::move(rootPath);
+
+	const TCHAR *fileExtension = PathFindExtension(wfd.cFileName);
+	m_extensions[index] =
+		(!isFolder && *fileExtension == '.') ? std::wstring(fileExtension + 1) : std::wstring();
+
+	m_attributeStrings[index] =
+		isFindDataValid ? BuildFileAttributesString(wfd.dwFileAttributes) : std::wstring();
+
+	ULARGE_INTEGER fileSize = { wfd.nFileSizeLow, wfd.nFileSizeHigh };
+	m_sizes[index] = fileSize.QuadPart;
+
+	m_creationTimes[index] = FileTimeToInteger(wfd.ftCreationTime);
+	m_lastWriteTimes[index] = FileTimeToInteger(wfd.ftLastWriteTime);
+	m_lastAccessTimes[index] = FileTimeToInteger(wfd.ftLastAccessTime);
+
+	m_flags[index] = flags;
+}
+
+void SortKeyStore::RemoveItem(int internalIndex)
+{
+	if (!HasItem(internalIndex))
+	{
+		return;
+	}
+
+	auto index = static_cast<size_t>(internalIndex);
+	m_flags[index] = 0;
+	m_displayNames[index] = {};
+	m_rootPaths[index] = {};
+	m_nameKeys[index] = {};
+	m_extensions[index] = {};
+	m_attributeStrings[index] = {};
+}
+
+void SortKeyStore::SetFolderSize(int internalIndex, uint64_t size)
+{
+	if (!IsFolder(internalIndex))
+	{
+		return;
+	}
+
+	auto index = static_cast<size_t>(internalIndex);
+	m_sizes[index] = size;
+	WI_SetFlag(m_flags[index], ItemFlags::FolderSizeKnown);
+}
+
+void SortKeyStore::Clear()
+{
+	m_flags.clear();
+	m_displayNames.clear();
+	m_rootPaths.clear();
+	m_nameKeys.clear();
+	m_extensions.clear();
+	m_attributeStrings.clear();
+	m_sizes.clear();
+	m_creationTimes.clear();
+	m_lastWriteTimes.clear();
+	m_lastAccessTimes.clear();
+}
+
+bool SortKeyStore::HasItem(int internalIndex) const
+{
+	return internalIndex >= 0 && static_cast<size_t>(internalIndex) < m_flags.size()
+		&& WI_IsFlagSet(m_flags[internalIndex], ItemFlags::Present);
+}
+
+bool SortKeyStore::IsFolder(int internalIndex) const
+{
+	return HasFlag(internalIndex, ItemFlags::Folder);
+}
+
+bool SortKeyStore::IsSortModeSupported(SortMode sortMode)
+{
+	switch (sortMode)
+	{
+	case SortMode::Name:
+	case SortMode::Size:
+	case SortMode::DateModified:
+	case SortMode::Created:
+	case SortMode::Accessed:
+	case SortMode::Attributes:
+	case SortMode::Extension:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+// The results here are expected to match those of the equivalent functions in SortHelper.cpp.
+int SortKeyStore::Compare(int internalIndex1, int internalIndex2, SortMode sortMode,
+	const GlobalFolderSettings &globalFolderSettings) const
+{
+	DCHECK(HasItem(internalIndex1));
+	DCHECK(HasItem(internalIndex2));
+
+	switch (sortMode)
+	{
+	case SortMode::Name:
+		return CompareNames(internalIndex1, internalIndex2, globalFolderSettings);
+
+	case SortMode::Size:
+		return CompareSizes(internalIndex1, internalIndex2);
+
+	case SortMode::DateModified:
+		return CompareTimes(internalIndex1, internalIndex2, m_lastWriteTimes);
+
+	case SortMode::Created:
+		return CompareTimes(internalIndex1, internalIndex2, m_creationTimes);
+
+	case SortMode::Accessed:
+		return CompareTimes(internalIndex1, internalIndex2, m_lastAccessTimes);
+
+	case SortMode::Attributes:
+		return StrCmpLogicalW(m_attributeStrings[internalIndex1].c_str(),
+			m_attributeStrings[internalIndex2].c_str());
+
+	case SortMode::Extension:
+		return StrCmpLogicalW(m_extensions[internalIndex1].c_str(),
+			m_extensions[internalIndex2].c_str());
+
+	default:
+		DCHECK(false) << "Unsupported sort mode";
+		return 0;
+	}
+}
+
+int SortKeyStore::CompareDisplayNames(int internalIndex1, int internalIndex2,
+	bool useNaturalSortOrder) const
+{
+	return m_nameKeys[internalIndex1].displayName.Get(useNaturalSortOrder).Compare(
+		m_nameKeys[internalIndex2].displayName.Get(useNaturalSortOrder));
+}
+
+// This mirrors the processing done by ProcessItemFileName(). Keys are built for both versions of
+// the name, so that they don't need to be rebuilt if the extension settings change.
+std::optional<size_t> SortKeyStore::FindHideableExtension(const std::wstring &displayName,
+	bool isFolder)
+{
+	if (isFolder || displayName.empty() || displayName[0] == '.')
+	{
+		return std::nullopt;
+	}
+
+	const TCHAR *extension = PathFindExtension(displayName.c_str());
+
+	if (*extension == '\0')
+	{
+		return std::nullopt;
+	}
+
+	return extension - displayName.c_str();
+}
+
+const SortKeyStore::NameKey &SortKeyStore::GetNameKey(int internalIndex,
+	const GlobalFolderSettings &globalFolderSettings) const
+{
+	bool hideExtension = HasFlag(internalIndex, ItemFlags::ExtensionHideable)
+		&& (!globalFolderSettings.showExtensions
+			|| (globalFolderSettings.hideLinkExtension
+				&& HasFlag(internalIndex, ItemFlags::Link)));
+
+	const auto &nameKeys = m_nameKeys[internalIndex];
+	return hideExtension ? nameKeys.displayNameWithoutExtension : nameKeys.displayName;
+}
+
+bool SortKeyStore::HasFlag(int internalIndex, ItemFlags flag) const
+{
+	return WI_IsFlagSet(m_flags[internalIndex], flag);
+}
+
+int SortKeyStore::CompareNames(int internalIndex1, int internalIndex2,
+	const GlobalFolderSettings &globalFolderSettings) const
+{
+	bool useNaturalSortOrder = globalFolderSettings.useNaturalSortOrder;
+	bool isRoot1 = HasFlag(internalIndex1, ItemFlags::Root);
+	bool isRoot2 = HasFlag(internalIndex2, ItemFlags::Root);
+
+	if (isRoot1 != isRoot2)
+	{
+		return isRoot1 ? -1 : 1;
+	}
+	else if (isRoot1 && isRoot2)
+	{
+		// If the items been compared are both drives, sort by drive letter, rather than display
+		// name.
+		return m_nameKeys[internalIndex1].rootPath.Get(useNaturalSortOrder).Compare(
+			m_nameKeys[internalIndex2].rootPath.Get(useNaturalSortOrder));
+	}
+
+	const auto &key1 = GetNameKey(internalIndex1, globalFolderSettings).Get(useNaturalSortOrder);
+	const auto &key2 = GetNameKey(internalIndex2, globalFolderSettings).Get(useNaturalSortOrder);
+	return key1.Compare(key2);
+}
+
+int SortKeyStore::CompareSizes(int internalIndex1, int internalIndex2) const
+{
+	bool isFindDataValid1 = HasFlag(internalIndex1, ItemFlags::FindDataValid);
+	bool isFindDataValid2 = HasFlag(internalIndex2, ItemFlags::FindDataValid);
+
+	if (!isFindDataValid1 || !isFindDataValid2)
+	{
+		return CompareValues(isFindDataValid1, isFindDataValid2);
+	}
+
+	// A folder whose size is known is considered larger than one whose size isn't. Two folders
+	// with unknown sizes are considered equal.
+	if (HasFlag(internalIndex1, ItemFlags::Folder) && HasFlag(internalIndex2, ItemFlags::Folder))
+	{
+		bool isSizeKnown1 = HasFlag(internalIndex1, ItemFlags::FolderSizeKnown);
+		bool isSizeKnown2 = HasFlag(internalIndex2, ItemFlags::FolderSizeKnown);
+
+		if (!isSizeKnown1 || !isSizeKnown2)
+		{
+			return CompareValues(isSizeKnown1, isSizeKnown2);
+		}
+	}
+
+	return CompareValues(m_sizes[internalIndex1], m_sizes[internalIndex2]);
+}
+
+int SortKeyStore::CompareTimes(int internalIndex1, int internalIndex2,
+	const std::vector<uint64_t> &times) const
+{
+	bool isFindDataValid1 = HasFlag(internalIndex1, ItemFlags::FindDataValid);
+	bool isFindDataValid2 = HasFlag(internalIndex2, ItemFlags::FindDataValid);
+
+	if (!isFindDataValid1 || !isFindDataValid2)
+	{
+		return CompareValues(isFindDataValid1, isFindDataValid2);
+	}
+
+	return CompareValues(times[internalIndex1], times[internalIndex2]);
+}
@@ -0,0 +1,118 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "SortModes.h"
+#include "../Helper/CollationKey.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct GlobalFolderSettings;
+
+// Stores the values used when sorting the items in a folder. The values are extracted once, when an
+// item is added or updated, and are held in a set of parallel arrays, indexed by the item's internal
+// index. Comparing two items therefore doesn't require any item data to be copied.
+//
+// Only the sort modes whose values are available without querying the item are supported here.
+// The remaining modes (e.g. sorting by owner or by version information) need to retrieve data from
+// the item itself and are handled separately.
+//
+// Names are compared using collation keys. Building the keys is the most expensive part of adding
+// an item, so the keys can be built ahead of time, on the thread that retrieves the item, and
+// passed in. If they're not passed in, the existing keys are kept, provided the item's name hasn't
+// changed.
+class SortKeyStore
+{
+public:
+	// The keys for a single name, for both natural and case-insensitive ordering.
+	struct NameKey
+	{
+		NameKey() = default;
+		explicit NameKey(const std::wstring &name);
+
+		const CollationKey &Get(bool useNaturalSortOrder) const;
+
+		CollationKey natural;
+		CollationKey caseInsensitive;
+	};
+
+	struct NameKeys
+	{
+		NameKey displayName;
+
+		// Only set if the item has an extension that can be hidden.
+		NameKey displayNameWithoutExtension;
+
+		// Only set for drives.
+		NameKey rootPath;
+	};
+
+	static NameKeys BuildNameKeys(const std::wstring &displayName, const WIN32_FIND_DATA &wfd,
+		bool isRoot, const std::wstring &parsingName);
+
+	void SetItem(int internalIndex, const std::wstring &displayName, const WIN32_FIND_DATA &wfd,
+		bool isFindDataValid, bool isRoot, const std::wstring &parsingName,
+		std::optional<NameKeys> nameKeys = std::nullopt);
+	void RemoveItem(int internalIndex);
+	void Clear();
+
+	// Folder sizes aren't part of the item data, since they need to be calculated separately. Once
+	// the size of a folder is known, it can be set here and will then be used when sorting by
+	// size. The size is reset if the item is subsequently updated.
+	void SetFolderSize(int internalIndex, uint64_t size);
+
+	bool HasItem(int internalIndex) const;
+	bool IsFolder(int internalIndex) const;
+
+	static bool IsSortModeSupported(SortMode sortMode);
+	int Compare(int internalIndex1, int internalIndex2, SortMode sortMode,
+		const GlobalFolderSettings &globalFolderSettings) const;
+	int CompareDisplayNames(int internalIndex1, int internalIndex2,
+		bool useNaturalSortOrder) const;
+
+private:
+	enum ItemFlags : uint8_t
+	{
+		Present = 1 << 0,
+		Folder = 1 << 1,
+		FindDataValid = 1 << 2,
+		Root = 1 << 3,
+		Link = 1 << 4,
+		ExtensionHideable = 1 << 5,
+		FolderSizeKnown = 1 << 6
+	};
+
+	static std::optional<size_t> FindHideableExtension(const std::wstring &displayName,
+		bool isFolder);
+
+	const NameKey &GetNameKey(int internalIndex,
+		const GlobalFolderSettings &globalFolderSettings) const;
+	bool HasFlag(int internalIndex, ItemFlags flag) const;
+
+	int CompareNames(int internalIndex1, int internalIndex2,
+		const GlobalFolderSettings &globalFolderSettings) const;
+	int CompareSizes(int internalIndex1, int internalIndex2) const;
+	int CompareTimes(int internalIndex1, int internalIndex2,
+		const std::vector<uint64_t> &times) const;
+
+	template <typename T>
+	static int CompareValues(T value1, T value2)
+	{
+		return (value1 > value2) - (value1 < value2);
+	}
+
+	std::vector<uint8_t> m_flags;
+	std::vector<std::wstring> m_displayNames;
+	std::vector<std::wstring> m_rootPaths;
+	std::vector<NameKeys> m_nameKeys;
+	std::vector<std::wstring> m_extensions;
+	std::vector<std::wstring> m_attributeStrings;
+	std::vector<uint64_t> m_sizes;
+	std::vector<uint64_t> m_creationTimes;
+	std::vector<uint64_t> m_lastWriteTimes;
+	std::vector<uint64_t> m_lastAccessTimes;
+};
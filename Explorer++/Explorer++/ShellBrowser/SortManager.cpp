@@ -4,18 +4,40 @@
 
 #include "stdafx.h"
 #include "ShellBrowserImpl.h"
+#include "App.h"
 #include "Config.h"
 #include "ItemData.h"
+#include "Runtime.h"
 #include "SortHelper.h"
 #include "SortModes.h"
 #include "ViewModes.h"
+#include "../Helper/ParallelSort.h"
 #include <propkey.h>
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 void ShellBrowserImpl::SortFolder()
 {
-	SendMessage(m_hListView, LVM_SORTITEMS, reinterpret_cast<WPARAM>(this),
-		reinterpret_cast<LPARAM>(SortStub));
+	// In the sort modes handled by m_sortKeyStore, comparing two items only involves reading
+	// precomputed keys, so the comparison can safely be run on several threads at once.
+	bool allowParallel = SortKeyStore::IsSortModeSupported(m_folderSettings.sortMode);
+
+	if (m_virtualListView)
+	{
+		SortVirtualListView(std::bind_front(&ShellBrowserImpl::CompareVirtualListViewItems, this),
+			allowParallel);
+	}
+	else if (allowParallel)
+	{
+		SortListViewInParallel();
+	}
+	else
+	{
+		SendMessage(m_hListView, LVM_SORTITEMS, reinterpret_cast<WPARAM>(this),
+			reinterpret_cast<LPARAM>(SortStub));
+	}
 
 	if (m_folderSettings.viewMode == +ViewMode::Details)
 	{
@@ -29,346 +51,92 @@ int CALLBACK ShellBrowserImpl::SortStub(LPARAM lParam1, LPARAM lParam2, LPARAM l
 	return pShellBrowser->Sort(static_cast<int>(lParam1), static_cast<int>(lParam2));
 }
 
+// When sorting, the listview calls the comparison function on the UI thread, many times for each
+// item. So, rather than having the listview compare the items directly, the final order is
+// determined here, in parallel, and the listview then only has to compare each item's position.
+void ShellBrowserImpl::SortListViewInParallel()
+{
+	int numItems = ListView_GetItemCount(m_hListView);
+
+	std::vector<int> order;
+	order.reserve(numItems);
+
+	int maxInternalIndex = -1;
+
+	for (int i = 0; i < numItems; i++)
+	{
+		int internalIndex = GetItemInternalIndex(i);
+		order.push_back(internalIndex);
+		maxInternalIndex = std::max(maxInternalIndex, internalIndex);
+	}
+
+	ParallelStableSort(order.begin(), order.end(),
+		[this](int internalIndex1, int internalIndex2)
+		{ return Sort(internalIndex1, internalIndex2) < 0; },
+		m_app->GetRuntime()->GetBackgroundWorkPool());
+
+	std::vector<int> positions(maxInternalIndex + 1);
+
+	for (int position = 0; position < numItems; position++)
+	{
+		positions[order[position]] = position;
+	}
+
+	SendMessage(m_hListView, LVM_SORTITEMS, reinterpret_cast<WPARAM>(&positions),
+		reinterpret_cast<LPARAM>(SortByPositionStub));
+}
+
+int CALLBACK ShellBrowserImpl::SortByPositionStub(LPARAM lParam1, LPARAM lParam2,
+	LPARAM lParamSort)
+{
+	const auto *positions = reinterpret_cast<const std::vector<int> *>(lParamSort);
+	return (*positions)[lParam1] - (*positions)[lParam2];
+}
+
+void ShellBrowserImpl::UpdateItemSortKeys(int internalIndex)
+{
+	ItemInfo_t &itemInfo = m_itemInfoMap.at(internalIndex);
+	m_sortKeyStore.SetItem(internalIndex, itemInfo.displayName, itemInfo.wfd,
+		itemInfo.isFindDataValid, itemInfo.bDrive, itemInfo.parsingName,
+		std::exchange(itemInfo.nameKeys, std::nullopt));
+}
+
 /* Also see NBookmarkHelper::Sort. */
 int CALLBACK ShellBrowserImpl::Sort(int InternalIndex1, int InternalIndex2) const
 {
 	int comparisonResult = 0;
 
-	BasicItemInfo_t basicItemInfo1 = getBasicItemInfo(InternalIndex1);
-	BasicItemInfo_t basicItemInfo2 = getBasicItemInfo(InternalIndex2);
-
-	bool isFolder1 = ((basicItemInfo1.wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-						 == FILE_ATTRIBUTE_DIRECTORY)
-		? true
-		: false;
-	bool isFolder2 = ((basicItemInfo2.wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-						 == FILE_ATTRIBUTE_DIRECTORY)
-		? true
-		: false;
+	bool isFolder1 = m_sortKeyStore.IsFolder(InternalIndex1);
+	bool isFolder2 = m_sortKeyStore.IsFolder(InternalIndex2);
 
 	/* Folders will by default be sorted separately from files,
 	except in the recycle bin. */
 	if (!m_config->globalFolderSettings.displayMixedFilesAndFolders && isFolder1 && !isFolder2
-		&& !CompareVirtualFolders(CSIDL_BITBUCKET))
+		&& !m_directoryState.isRecycleBin)
 	{
 		comparisonResult = -1;
 	}
 	else if (!m_config->globalFolderSettings.displayMixedFilesAndFolders && !isFolder1 && isFolder2
-		&& !CompareVirtualFolders(CSIDL_BITBUCKET))
+		&& !m_directoryState.isRecycleBin)
 	{
 		comparisonResult = 1;
 	}
+	else if (SortKeyStore::IsSortModeSupported(m_folderSettings.sortMode))
+	{
+		comparisonResult = m_sortKeyStore.Compare(InternalIndex1, InternalIndex2,
+			m_folderSettings.sortMode, m_config->globalFolderSettings);
+	}
 	else
 	{
-		switch (m_folderSettings.sortMode)
-		{
-		case SortMode::Name:
-			comparisonResult =
-				SortByName(basicItemInfo1, basicItemInfo2, m_config->globalFolderSettings);
-			break;
-
-		case SortMode::Type:
-			comparisonResult = SortByType(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::Size:
-			comparisonResult = SortBySize(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::DateModified:
-			comparisonResult = SortByDate(basicItemInfo1, basicItemInfo2, DateType::Modified);
-			break;
-
-		case SortMode::TotalSize:
-			comparisonResult = SortByTotalSize(basicItemInfo1, basicItemInfo2, TRUE);
-			break;
-
-		case SortMode::FreeSpace:
-			comparisonResult = SortByTotalSize(basicItemInfo1, basicItemInfo2, FALSE);
-			break;
-
-		case SortMode::DateDeleted:
-			comparisonResult =
-				SortByItemDetails(basicItemInfo1, basicItemInfo2, &SCID_DATE_DELETED);
-			break;
-
-		case SortMode::OriginalLocation:
-			comparisonResult =
-				SortByItemDetails(basicItemInfo1, basicItemInfo2, &SCID_ORIGINAL_LOCATION);
-			break;
-
-		case SortMode::Attributes:
-			comparisonResult = SortByAttributes(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::RealSize:
-			comparisonResult = SortByRealSize(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::ShortName:
-			comparisonResult = SortByShortName(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::Owner:
-			comparisonResult = SortByOwner(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::ProductName:
-			comparisonResult =
-				SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::ProductName);
-			break;
-
-		case SortMode::Company:
-			comparisonResult =
-				SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::Company);
-			break;
-
-		case SortMode::Description:
-			comparisonResult =
-				SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::Description);
-			break;
-
-		case SortMode::FileVersion:
-			comparisonResult =
-				SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::FileVersion);
-			break;
-
-		case SortMode::ProductVersion:
-			comparisonResult =
-				SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::ProductVersion);
-			break;
-
-		case SortMode::ShortcutTo:
-			comparisonResult = SortByShortcutTo(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::HardLinks:
-			comparisonResult = SortByHardlinks(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::Extension:
-			comparisonResult = SortByExtension(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::Created:
-			comparisonResult = SortByDate(basicItemInfo1, basicItemInfo2, DateType::Created);
-			break;
-
-		case SortMode::Accessed:
-			comparisonResult = SortByDate(basicItemInfo1, basicItemInfo2, DateType::Accessed);
-			break;
-
-		case SortMode::Title:
-			comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Title);
-			break;
-
-		case SortMode::Subject:
-			comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Subject);
-			break;
-
-		case SortMode::Authors:
-			comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Author);
-			break;
-
-		case SortMode::Keywords:
-			comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Keywords);
-			break;
-
-		case SortMode::Comments:
-			comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Comment);
-			break;
-
-		case SortMode::CameraModel:
-			comparisonResult =
-				SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagEquipModel);
-			break;
-
-		case SortMode::DateTaken:
-			comparisonResult =
-				SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagDateTime);
-			break;
-
-		case SortMode::Width:
-			comparisonResult =
-				SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagImageWidth);
-			break;
-
-		case SortMode::Height:
-			comparisonResult =
-				SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagImageHeight);
-			break;
-
-		case SortMode::VirtualComments:
-			comparisonResult = SortByVirtualComments(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::FileSystem:
-			comparisonResult = SortByFileSystem(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::NumPrinterDocuments:
-			comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
-				PrinterInformationType::NumJobs);
-			break;
-
-		case SortMode::PrinterStatus:
-			comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
-				PrinterInformationType::Status);
-			break;
-
-		case SortMode::PrinterComments:
-			comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
-				PrinterInformationType::Comments);
-			break;
-
-		case SortMode::PrinterLocation:
-			comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
-				PrinterInformationType::Location);
-			break;
-
-		case SortMode::NetworkAdapterStatus:
-			comparisonResult = SortByNetworkAdapterStatus(basicItemInfo1, basicItemInfo2);
-			break;
-
-		case SortMode::MediaBitrate:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Bitrate);
-			break;
-
-		case SortMode::MediaCopyright:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Copyright);
-			break;
-
-		case SortMode::MediaDuration:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Duration);
-			break;
-
-		case SortMode::MediaProtected:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Protected);
-			break;
-
-		case SortMode::MediaRating:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Rating);
-			break;
-
-		case SortMode::MediaAlbumArtist:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::AlbumArtist);
-			break;
-
-		case SortMode::MediaAlbum:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::AlbumTitle);
-			break;
-
-		case SortMode::MediaBeatsPerMinute:
-			comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
-				MediaMetadataType::BeatsPerMinute);
-			break;
-
-		case SortMode::MediaComposer:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Composer);
-			break;
-
-		case SortMode::MediaConductor:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Conductor);
-			break;
-
-		case SortMode::MediaDirector:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Director);
-			break;
-
-		case SortMode::MediaGenre:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Genre);
-			break;
-
-		case SortMode::MediaLanguage:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Language);
-			break;
-
-		case SortMode::MediaBroadcastDate:
-			comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
-				MediaMetadataType::BroadcastDate);
-			break;
-
-		case SortMode::MediaChannel:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Channel);
-			break;
-
-		case SortMode::MediaStationName:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::StationName);
-			break;
-
-		case SortMode::MediaMood:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Mood);
-			break;
-
-		case SortMode::MediaParentalRating:
-			comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
-				MediaMetadataType::ParentalRating);
-			break;
-
-		case SortMode::MediaParentalRatingReason:
-			comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
-				MediaMetadataType::ParentalRatingReason);
-			break;
-
-		case SortMode::MediaPeriod:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Period);
-			break;
-
-		case SortMode::MediaProducer:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Producer);
-			break;
-
-		case SortMode::MediaPublisher:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Publisher);
-			break;
-
-		case SortMode::MediaWriter:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Writer);
-			break;
-
-		case SortMode::MediaYear:
-			comparisonResult =
-				SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Year);
-			break;
-
-		default:
-			assert(false);
-			break;
-		}
+		comparisonResult = SortUsingItemInfo(InternalIndex1, InternalIndex2);
 	}
 
 	if (comparisonResult == 0)
 	{
 		/* By default, items that are equal will be sub-sorted
 		by their display names. */
-		if (m_config->globalFolderSettings.useNaturalSortOrder)
-		{
-			comparisonResult =
-				StrCmpLogicalW(basicItemInfo1.szDisplayName, basicItemInfo2.szDisplayName);
-		}
-		else
-		{
-			comparisonResult = StrCmpIW(basicItemInfo1.szDisplayName, basicItemInfo2.szDisplayName);
-		}
+		comparisonResult = m_sortKeyStore.CompareDisplayNames(InternalIndex1, InternalIndex2,
+			m_config->globalFolderSettings.useNaturalSortOrder);
 	}
 
 	if (m_folderSettings.sortDirection == +SortDirection::Descending)
@@ -378,3 +146,279 @@ int CALLBACK ShellBrowserImpl::Sort(int InternalIndex1, int InternalIndex2) cons
 
 	return comparisonResult;
 }
+
+// Handles the sort modes that require data to be retrieved from the items themselves. The
+// remaining sort modes are handled by m_sortKeyStore.
+int ShellBrowserImpl::SortUsingItemInfo(int internalIndex1, int internalIndex2) const
+{
+	BasicItemInfo_t basicItemInfo1 = getBasicItemInfo(internalIndex1);
+	BasicItemInfo_t basicItemInfo2 = getBasicItemInfo(internalIndex2);
+
+	int comparisonResult = 0;
+
+	switch (m_folderSettings.sortMode)
+	{
+	case SortMode::Type:
+		comparisonResult = SortByType(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::TotalSize:
+		comparisonResult = SortByTotalSize(basicItemInfo1, basicItemInfo2, TRUE);
+		break;
+
+	case SortMode::FreeSpace:
+		comparisonResult = SortByTotalSize(basicItemInfo1, basicItemInfo2, FALSE);
+		break;
+
+	case SortMode::DateDeleted:
+		comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &SCID_DATE_DELETED);
+		break;
+
+	case SortMode::OriginalLocation:
+		comparisonResult =
+			SortByItemDetails(basicItemInfo1, basicItemInfo2, &SCID_ORIGINAL_LOCATION);
+		break;
+
+	case SortMode::RealSize:
+		comparisonResult = SortByRealSize(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::ShortName:
+		comparisonResult = SortByShortName(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::Owner:
+		comparisonResult = SortByOwner(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::ProductName:
+		comparisonResult =
+			SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::ProductName);
+		break;
+
+	case SortMode::Company:
+		comparisonResult =
+			SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::Company);
+		break;
+
+	case SortMode::Description:
+		comparisonResult =
+			SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::Description);
+		break;
+
+	case SortMode::FileVersion:
+		comparisonResult =
+			SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::FileVersion);
+		break;
+
+	case SortMode::ProductVersion:
+		comparisonResult =
+			SortByVersionInfo(basicItemInfo1, basicItemInfo2, VersionInfoType::ProductVersion);
+		break;
+
+	case SortMode::ShortcutTo:
+		comparisonResult = SortByShortcutTo(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::HardLinks:
+		comparisonResult = SortByHardlinks(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::Title:
+		comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Title);
+		break;
+
+	case SortMode::Subject:
+		comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Subject);
+		break;
+
+	case SortMode::Authors:
+		comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Author);
+		break;
+
+	case SortMode::Keywords:
+		comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Keywords);
+		break;
+
+	case SortMode::Comments:
+		comparisonResult = SortByItemDetails(basicItemInfo1, basicItemInfo2, &PKEY_Comment);
+		break;
+
+	case SortMode::CameraModel:
+		comparisonResult =
+			SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagEquipModel);
+		break;
+
+	case SortMode::DateTaken:
+		comparisonResult = SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagDateTime);
+		break;
+
+	case SortMode::Width:
+		comparisonResult =
+			SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagImageWidth);
+		break;
+
+	case SortMode::Height:
+		comparisonResult =
+			SortByImageProperty(basicItemInfo1, basicItemInfo2, PropertyTagImageHeight);
+		break;
+
+	case SortMode::VirtualComments:
+		comparisonResult = SortByVirtualComments(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::FileSystem:
+		comparisonResult = SortByFileSystem(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::NumPrinterDocuments:
+		comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
+			PrinterInformationType::NumJobs);
+		break;
+
+	case SortMode::PrinterStatus:
+		comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
+			PrinterInformationType::Status);
+		break;
+
+	case SortMode::PrinterComments:
+		comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
+			PrinterInformationType::Comments);
+		break;
+
+	case SortMode::PrinterLocation:
+		comparisonResult = SortByPrinterProperty(basicItemInfo1, basicItemInfo2,
+			PrinterInformationType::Location);
+		break;
+
+	case SortMode::NetworkAdapterStatus:
+		comparisonResult = SortByNetworkAdapterStatus(basicItemInfo1, basicItemInfo2);
+		break;
+
+	case SortMode::MediaBitrate:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Bitrate);
+		break;
+
+	case SortMode::MediaCopyright:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Copyright);
+		break;
+
+	case SortMode::MediaDuration:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Duration);
+		break;
+
+	case SortMode::MediaProtected:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Protected);
+		break;
+
+	case SortMode::MediaRating:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Rating);
+		break;
+
+	case SortMode::MediaAlbumArtist:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::AlbumArtist);
+		break;
+
+	case SortMode::MediaAlbum:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::AlbumTitle);
+		break;
+
+	case SortMode::MediaBeatsPerMinute:
+		comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
+			MediaMetadataType::BeatsPerMinute);
+		break;
+
+	case SortMode::MediaComposer:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Composer);
+		break;
+
+	case SortMode::MediaConductor:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Conductor);
+		break;
+
+	case SortMode::MediaDirector:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Director);
+		break;
+
+	case SortMode::MediaGenre:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Genre);
+		break;
+
+	case SortMode::MediaLanguage:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Language);
+		break;
+
+	case SortMode::MediaBroadcastDate:
+		comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
+			MediaMetadataType::BroadcastDate);
+		break;
+
+	case SortMode::MediaChannel:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Channel);
+		break;
+
+	case SortMode::MediaStationName:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::StationName);
+		break;
+
+	case SortMode::MediaMood:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Mood);
+		break;
+
+	case SortMode::MediaParentalRating:
+		comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
+			MediaMetadataType::ParentalRating);
+		break;
+
+	case SortMode::MediaParentalRatingReason:
+		comparisonResult = SortByMediaMetadata(basicItemInfo1, basicItemInfo2,
+			MediaMetadataType::ParentalRatingReason);
+		break;
+
+	case SortMode::MediaPeriod:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Period);
+		break;
+
+	case SortMode::MediaProducer:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Producer);
+		break;
+
+	case SortMode::MediaPublisher:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Publisher);
+		break;
+
+	case SortMode::MediaWriter:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Writer);
+		break;
+
+	case SortMode::MediaYear:
+		comparisonResult =
+			SortByMediaMetadata(basicItemInfo1, basicItemInfo2, MediaMetadataType::Year);
+		break;
+
+	default:
+		assert(false);
+		break;
+	}
+
+	return comparisonResult;
+}
@@ -30,8 +30,6 @@ void ShellBrowserImpl::InsertTileViewColumns()
 
 void ShellBrowserImpl::SetTileViewInfo()
 {
-	LVITEM lvItem;
-	BOOL bRes;
 	int nItems;
 	int i = 0;
 
@@ -39,21 +37,20 @@ void ShellBrowserImpl::SetTileViewInfo()
 
 	for (i = 0; i < nItems; i++)
 	{
-		lvItem.mask = LVIF_PARAM;
-		lvItem.iItem = i;
-		lvItem.iSubItem = 0;
-		bRes = ListView_GetItem(m_hListView, &lvItem);
-
-		if (bRes)
-		{
-			SetTileViewItemInfo(i, (int) lvItem.lParam);
-		}
+		SetTileViewItemInfo(i, GetItemInternalIndex(i));
 	}
 }
 
 /* TODO: Make this function configurable. */
 void ShellBrowserImpl::SetTileViewItemInfo(int iItem, int iItemInternal)
 {
+	// The additional tile text would need to be provided on demand in a virtual listview, which
+	// isn't currently supported. Only the item name is shown in that case.
+	if (m_virtualListView)
+	{
+		return;
+	}
+
 	SHFILEINFO shfi;
 	LVTILEINFO lvti;
 	UINT uColumns[2] = { 1, 2 };
@@ -0,0 +1,310 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ShellBrowserImpl.h"
+#include "App.h"
+#include "ColumnDataRetrieval.h"
+#include "Config.h"
+#include "ItemData.h"
+#include "Runtime.h"
+#include "ViewModes.h"
+#include <wil/common.h>
+
+void ShellBrowserImpl::OnVirtualListViewGetDisplayInfo(LVITEM *item)
+{
+	int internalIndex = GetItemInternalIndex(item->iItem);
+
+	if (WI_IsFlagSet(item->mask, LVIF_TEXT))
+	{
+		std::wstring text = GetVirtualListViewItemText(internalIndex, item->iSubItem);
+		StringCchCopy(item->pszText, item->cchTextMax, text.c_str());
+	}
+
+	if (WI_IsFlagSet(item->mask, LVIF_IMAGE))
+	{
+		auto imageIndex = m_listViewItemModel.GetImage(internalIndex);
+
+		if (!imageIndex)
+		{
+			// The initial image is saved, so that it's only generated (and the actual image only
+			// requested) once.
+			imageIndex = GetInitialItemImage(internalIndex);
+			m_listViewItemModel.SetImage(internalIndex, *imageIndex, 0);
+		}
+
+		item->iImage = *imageIndex;
+	}
+
+	if (WI_IsFlagSet(item->mask, LVIF_STATE))
+	{
+		item->state = INDEXTOOVERLAYMASK(m_listViewItemModel.GetOverlay(internalIndex));
+		WI_SetFlagIf(item->state, LVIS_CUT, m_listViewItemModel.IsCut(internalIndex));
+	}
+}
+
+std::wstring ShellBrowserImpl::GetVirtualListViewItemText(int internalIndex, int subItem)
+{
+	std::optional<ColumnType> columnType;
+
+	if (m_folderSettings.viewMode == +ViewMode::Details)
+	{
+		columnType = GetColumnTypeByIndex(subItem);
+		CHECK(columnType);
+	}
+
+	// The item text in non-details view is always the filename. The name column is also generated
+	// directly, since the text is cheap to generate and always visible.
+	if (!columnType || *columnType == +ColumnType::Name)
+	{
+		return ProcessItemFileName(getBasicItemInfo(internalIndex), m_config->globalFolderSettings);
+	}
+
+	const auto *text = m_listViewItemModel.MaybeGetColumnText(internalIndex,
+		columnType->_to_integral());
+
+	if (text)
+	{
+		return *text;
+	}
+
+	// An empty string is stored until the actual text has been retrieved, so that the text is only
+	// requested once.
+	m_listViewItemModel.SetColumnText(internalIndex, columnType->_to_integral(), L"");
+	QueueColumnTask(internalIndex, *columnType);
+
+	return L"";
+}
+
+void ShellBrowserImpl::OnVirtualListViewItemChanged(const NMLISTVIEW *changeData)
+{
+	if (m_syncingVirtualListViewSelection || changeData->uChanged != LVIF_STATE)
+	{
+		return;
+	}
+
+	// An item index of -1 indicates that the change applies to all items.
+	bool previouslyFocused = WI_IsFlagSet(changeData->uOldState, LVIS_FOCUSED);
+	bool currentlyFocused = WI_IsFlagSet(changeData->uNewState, LVIS_FOCUSED);
+
+	if (currentlyFocused && !previouslyFocused && changeData->iItem != -1)
+	{
+		m_listViewItemModel.SetFocusedItem(GetItemInternalIndex(changeData->iItem));
+	}
+	else if (!currentlyFocused && previouslyFocused
+		&& (changeData->iItem == -1
+			|| m_listViewItemModel.GetFocusedItem() == GetItemInternalIndex(changeData->iItem)))
+	{
+		m_listViewItemModel.SetFocusedItem(std::nullopt);
+	}
+
+	bool previouslySelected = WI_IsFlagSet(changeData->uOldState, LVIS_SELECTED);
+	bool currentlySelected = WI_IsFlagSet(changeData->uNewState, LVIS_SELECTED);
+
+	if (previouslySelected == currentlySelected)
+	{
+		return;
+	}
+
+	if (changeData->iItem == -1)
+	{
+		// The change applies to every item, so the selection can be updated in a single operation,
+		// rather than item by item.
+		m_directoryState.selectionTracker.SetAllSelected(currentlySelected);
+		QueueSelectionChangedNotification();
+	}
+	else
+	{
+		UpdateVirtualListViewItemSelection(changeData->iItem, changeData->iItem,
+			currentlySelected);
+	}
+}
+
+// Sent when the state of a range of items changes (e.g. when items are selected using shift+click).
+void ShellBrowserImpl::OnVirtualListViewItemRangeChanged(const NMLVODSTATECHANGE *stateChange)
+{
+	if (m_syncingVirtualListViewSelection)
+	{
+		return;
+	}
+
+	bool previouslySelected = WI_IsFlagSet(stateChange->uOldState, LVIS_SELECTED);
+	bool currentlySelected = WI_IsFlagSet(stateChange->uNewState, LVIS_SELECTED);
+
+	if (previouslySelected == currentlySelected)
+	{
+		return;
+	}
+
+	UpdateVirtualListViewItemSelection(stateChange->iFrom, stateChange->iTo, currentlySelected);
+}
+
+void ShellBrowserImpl::UpdateVirtualListViewItemSelection(int firstItem, int lastItem,
+	bool selected)
+{
+	bool selectionChanged = false;
+
+	for (int item = firstItem; item <= lastItem; item++)
+	{
+		if (m_directoryState.selectionTracker.SetSelected(GetItemInternalIndex(item), selected))
+		{
+			selectionChanged = true;
+		}
+	}
+
+	if (selectionChanged)
+	{
+		QueueSelectionChangedNotification();
+	}
+}
+
+// Used when searching for an item by typing its name.
+LRESULT ShellBrowserImpl::OnVirtualListViewFindItem(const NMLVFINDITEM *findItem)
+{
+	const LVFINDINFO &findInfo = findItem->lvfi;
+
+	if (WI_AreAllFlagsClear(findInfo.flags, LVFI_STRING | LVFI_PARTIAL))
+	{
+		return -1;
+	}
+
+	int numItems = m_listViewItemModel.GetCount();
+	int startItem = std::max(findItem->iStart, 0);
+	int searchLength = static_cast<int>(wcslen(findInfo.psz));
+
+	for (int i = 0; i < numItems; i++)
+	{
+		int item = startItem + i;
+
+		if (item >= numItems)
+		{
+			if (WI_IsFlagClear(findInfo.flags, LVFI_WRAP))
+			{
+				break;
+			}
+
+			item -= numItems;
+		}
+
+		const auto &itemInfo = m_itemInfoMap.at(GetItemInternalIndex(item));
+		bool matches;
+
+		if (WI_IsFlagSet(findInfo.flags, LVFI_PARTIAL))
+		{
+			matches = StrCmpNIW(itemInfo.displayName.c_str(), findInfo.psz, searchLength) == 0;
+		}
+		else
+		{
+			matches = StrCmpIW(itemInfo.displayName.c_str(), findInfo.psz) == 0;
+		}
+
+		if (matches)
+		{
+			return item;
+		}
+	}
+
+	return -1;
+}
+
+void ShellBrowserImpl::UpdateVirtualListViewItemCount()
+{
+	// LVSICF_NOSCROLL prevents the listview from scrolling back to the top each time the number of
+	// items changes.
+	ListView_SetItemCountEx(m_hListView, m_listViewItemModel.GetCount(), LVSICF_NOSCROLL);
+
+	SyncVirtualListViewSelection();
+}
+
+void ShellBrowserImpl::SortVirtualListView(const ListViewItemModel::Comparator &comparator,
+	bool allowParallel)
+{
+	m_listViewItemModel.Sort(comparator,
+		allowParallel ? m_app->GetRuntime()->GetBackgroundWorkPool() : nullptr);
+
+	SyncVirtualListViewSelection();
+	InvalidateRect(m_hListView, nullptr, FALSE);
+}
+
+int ShellBrowserImpl::CompareVirtualListViewItems(int internalIndex1, int internalIndex2)
+{
+	// A virtual listview can't display groups, so items are ordered by group first, which ensures
+	// that the items in each group are at least shown together.
+	if (m_folderSettings.showInGroups)
+	{
+		auto groupId1 = m_listViewItemModel.GetGroupId(internalIndex1);
+		auto groupId2 = m_listViewItemModel.GetGroupId(internalIndex2);
+
+		// Items that haven't been assigned a group are treated as belonging to a single group of
+		// their own, ordered after every other group. Comparing them only by the sort column
+		// wouldn't be consistent with the group ordering and so wouldn't be a strict weak ordering.
+		if (groupId1 != groupId2)
+		{
+			if (!groupId1)
+			{
+				return 1;
+			}
+
+			if (!groupId2)
+			{
+				return -1;
+			}
+
+			return GroupComparison(*groupId1, *groupId2);
+		}
+	}
+
+	return Sort(internalIndex1, internalIndex2);
+}
+
+// The listview tracks the selected and focused items by position. Whenever items are added, removed
+// or reordered, those positions are no longer accurate and the state needs to be reapplied from the
+// model, which tracks selection by item.
+void ShellBrowserImpl::SyncVirtualListViewSelection()
+{
+	m_syncingVirtualListViewSelection = true;
+
+	int numItems = m_listViewItemModel.GetCount();
+
+	if (numItems > 0 && m_listViewItemModel.GetSelectedCount() == numItems)
+	{
+		ListView_SetItemState(m_hListView, -1, LVIS_SELECTED, LVIS_SELECTED);
+	}
+	else
+	{
+		ListView_SetItemState(m_hListView, -1, 0, LVIS_SELECTED);
+
+		for (int item : m_listViewItemModel.GetSelectedPositions())
+		{
+			ListView_SetItemState(m_hListView, item, LVIS_SELECTED, LVIS_SELECTED);
+		}
+	}
+
+	auto focusedItem = m_listViewItemModel.GetFocusedItem();
+
+	if (focusedItem)
+	{
+		int item = *m_listViewItemModel.GetPosition(*focusedItem);
+		ListView_SetItemState(m_hListView, item, LVIS_FOCUSED, LVIS_FOCUSED);
+		ListView_SetSelectionMark(m_hListView, item);
+	}
+	else
+	{
+		ListView_SetItemState(m_hListView, -1, 0, LVIS_FOCUSED);
+	}
+
+	m_syncingVirtualListViewSelection = false;
+}
+
+void ShellBrowserImpl::RedrawVirtualListViewItem(int internalIndex)
+{
+	auto item = m_listViewItemModel.GetPosition(internalIndex);
+
+	if (!item)
+	{
+		return;
+	}
+
+	ListView_RedrawItems(m_hListView, *item, *item);
+}
@@ -60,11 +60,9 @@ ShellTreeView::ShellTreeView(HWND hParent, App *app, BrowserWindow *browserWindo
 	m_config(app->GetConfig()),
 	m_fileActionHandler(fileActionHandler),
 	m_fontSetter(GetHWND(), app->GetConfig()),
-	m_iconThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
-		CoUninitialize),
+	m_iconTaskGroup(app->GetRuntime()->GetBackgroundWorkPool()),
 	m_iconResultIDCounter(0),
-	m_subfoldersThreadPool(1, std::bind(CoInitializeEx, nullptr, COINIT_APARTMENTTHREADED),
-		CoUninitialize),
+	m_subfoldersTaskGroup(app->GetRuntime()->GetBackgroundWorkPool()),
 	m_subfoldersResultIDCounter(0),
 	m_cachedIcons(cachedIcons),
 	m_dropExpandItem(nullptr),
@@ -160,7 +158,7 @@ ShellTreeView::~ShellTreeView()
 		OleFlushClipboard();
 	}
 
-	m_iconThreadPool.clear_queue();
+	m_iconTaskGroup.CancelPendingTasks();
 }
 
 LRESULT ShellTreeView::TreeViewProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -492,11 +490,9 @@ void ShellTreeView::QueueIconTask(HTREEITEM treeItem)
 
 	int iconResultID = m_iconResultIDCounter++;
 
-	auto result = m_iconThreadPool.push(
-		[this, iconResultID, nodeId = node->GetId(), treeItem, basicItemInfo](int id)
+	auto result = m_iconTaskGroup.Push(
+		[this, iconResultID, nodeId = node->GetId(), treeItem, basicItemInfo]
 		{
-			UNREFERENCED_PARAMETER(id);
-
 			return FindIconAsync(m_hTreeView, iconResultID, nodeId, treeItem,
 				basicItemInfo.pidl.get());
 		});
@@ -583,14 +579,15 @@ void ShellTreeView::QueueSubfoldersTask(HTREEITEM item)
 
 	int subfoldersResultID = m_subfoldersResultIDCounter++;
 
-	auto result = m_subfoldersThreadPool.push(
-		[this, subfoldersResultID, item, basicItemInfo](int id)
+	// The subfolder check only determines whether an expand button is shown, so it's run after
+	// other background work (e.g. icon retrieval).
+	auto result = m_subfoldersTaskGroup.Push(
+		[this, subfoldersResultID, item, basicItemInfo]
 		{
-			UNREFERENCED_PARAMETER(id);
-
 			return CheckSubfoldersAsync(m_hTreeView, subfoldersResultID, item,
 				basicItemInfo.pidl.get());
-		});
+		},
+		TaskPriority::Low);
 
 	m_subfoldersResults.insert({ subfoldersResultID, std::move(result) });
 }
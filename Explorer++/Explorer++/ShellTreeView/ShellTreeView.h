@@ -7,13 +7,13 @@
 #include "MainFontSetter.h"
 #include "ShellChangeWatcher.h"
 #include "SignalWrapper.h"
+#include "../Helper/BackgroundWorkPool.h"
 #include "../Helper/DropHandler.h"
 #include "../Helper/ShellContextMenu.h"
 #include "../Helper/ShellDropTargetWindow.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/WindowSubclass.h"
 #include "../Helper/iDirectoryMonitor.h"
-#include "../ThirdParty/CTPL/cpl_stl.h"
 #include <boost/signals2.hpp>
 #include <concurrencpp/concurrencpp.h>
 #include <wil/com.h>
@@ -239,11 +239,11 @@ private:
 	// be set. Once the treeview font is set, the same font will be applied to the tooltip control.
 	MainFontSetter m_fontSetter;
 
-	ctpl::thread_pool m_iconThreadPool;
+	TaskGroup m_iconTaskGroup;
 	std::unordered_map<int, std::future<std::optional<IconResult>>> m_iconResults;
 	int m_iconResultIDCounter;
 
-	ctpl::thread_pool m_subfoldersThreadPool;
+	TaskGroup m_subfoldersTaskGroup;
 	std::unordered_map<int, std::future<std::optional<SubfoldersResult>>> m_subfoldersResults;
 	int m_subfoldersResultIDCounter;
 
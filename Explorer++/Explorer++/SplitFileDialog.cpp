@@ -8,6 +8,8 @@
 #include "MainResource.h"
 #include "ResourceHelper.h"
 #include "../Helper/FileOperations.h"
+#include "../Helper/FileSplitter.h"
+#include "../Helper/FileStreams.h"
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/ShellHelper.h"
 #include "../Helper/StringHelper.h"
@@ -15,6 +17,8 @@
 #include "../Helper/XMLSettings.h"
 #include <wil/resource.h>
 #include <comdef.h>
+#include <atomic>
+#include <format>
 #include <unordered_map>
 
 namespace NSplitFileDialog
@@ -23,8 +27,10 @@ const int WM_APP_SETTOTALSPLITCOUNT = WM_APP + 1;
 const int WM_APP_SETCURRENTSPLITCOUNT = WM_APP + 2;
 const int WM_APP_SPLITFINISHED = WM_APP + 3;
 const int WM_APP_INPUTFILEINVALID = WM_APP + 4;
+const int WM_APP_SPLITFAILED = WM_APP + 5;
 
 const TCHAR COUNTER_PATTERN[] = _T("/N");
+const TCHAR CHECKSUM_FILE_EXTENSION[] = _T(".sfv");
 
 DWORD WINAPI SplitFileThreadProcStub(LPVOID pParam);
 }
@@ -33,12 +39,15 @@ const TCHAR SplitFileDialogPersistentSettings::SETTINGS_KEY[] = _T("SplitFile");
 
 const TCHAR SplitFileDialogPersistentSettings::SETTING_SIZE[] = _T("Size");
 const TCHAR SplitFileDialogPersistentSettings::SETTING_SIZE_GROUP[] = _T("SizeGroup");
+const TCHAR SplitFileDialogPersistentSettings::SETTING_CREATE_CHECKSUM_FILE[] =
+	_T("CreateChecksumFile");
 
 SplitFileDialog::SplitFileDialog(HINSTANCE resourceInstance, HWND hParent,
 	ThemeManager *themeManager, const IconResourceLoader *iconResourceLoader,
-	const std::wstring &strFullFilename) :
+	BackgroundWorkPool *workPool, const std::wstring &strFullFilename) :
 	ThemedDialog(resourceInstance, IDD_SPLITFILE, hParent, DialogSizingType::None, themeManager),
 	m_iconResourceLoader(iconResourceLoader),
+	m_workPool(workPool),
 	m_strFullFilename(strFullFilename),
 	m_bSplittingFile(false),
 	m_bStopSplitting(false),
@@ -132,6 +141,11 @@ INT_PTR SplitFileDialog::OnInitDialog()
 		szOutputFilename, NSplitFileDialog::COUNTER_PATTERN);
 	SetDlgItemText(m_hDlg, IDC_SPLIT_EDIT_OUTPUTFILENAME, szOutputFilename);
 
+	if (m_persistentSettings->m_createChecksumFile)
+	{
+		CheckDlgButton(m_hDlg, IDC_SPLIT_CHECK_CHECKSUMFILE, BST_CHECKED);
+	}
+
 	auto hCurentFont = reinterpret_cast<HFONT>(
 		SendDlgItemMessage(m_hDlg, IDC_SPLIT_STATIC_FILENAMEHELPER, WM_GETFONT, 0, 0));
 
@@ -257,6 +271,8 @@ void SplitFileDialog::SaveState()
 	m_persistentSettings->m_strSplitSize = GetWindowString(GetDlgItem(m_hDlg, IDC_SPLIT_EDIT_SIZE));
 	m_persistentSettings->m_strSplitGroup =
 		GetWindowString(GetDlgItem(m_hDlg, IDC_SPLIT_COMBOBOX_SIZES));
+	m_persistentSettings->m_createChecksumFile =
+		(IsDlgButtonChecked(m_hDlg, IDC_SPLIT_CHECK_CHECKSUMFILE) == BST_CHECKED);
 
 	m_persistentSettings->m_bStateSaved = TRUE;
 }
@@ -276,29 +292,16 @@ INT_PTR SplitFileDialog::OnPrivateMessage(UINT uMsg, WPARAM wParam, LPARAM lPara
 		break;
 
 	case NSplitFileDialog::WM_APP_SPLITFINISHED:
-		OnSplitFinished();
+		OnSplitFinished(wParam != FALSE);
 		break;
 
 	case NSplitFileDialog::WM_APP_INPUTFILEINVALID:
-	{
-		TCHAR szTemp[128];
-		LoadString(GetResourceInstance(), IDS_SPLITFILEDIALOG_INPUTFILEINVALID, szTemp,
-			std::size(szTemp));
-		SetDlgItemText(m_hDlg, IDC_SPLIT_STATIC_MESSAGE, szTemp);
-
-		assert(m_pSplitFile != nullptr);
-
-		m_pSplitFile->Release();
-		m_pSplitFile = nullptr;
-
-		m_bSplittingFile = false;
-		m_bStopSplitting = false;
-
-		KillTimer(m_hDlg, ELPASED_TIMER_ID);
+		OnSplitFailed(IDS_SPLITFILEDIALOG_INPUTFILEINVALID);
+		break;
 
-		SetDlgItemText(m_hDlg, IDOK, m_szOk);
-	}
-	break;
+	case NSplitFileDialog::WM_APP_SPLITFAILED:
+		OnSplitFailed(IDS_SPLITFILEDIALOG_SPLITFAILED);
+		break;
 	}
 
 	return 0;
@@ -365,9 +368,9 @@ void SplitFileDialog::OnOk()
 		std::wstring strOutputDirectory = GetWindowString(hEditOutputDirectory);
 
 		BOOL bTranslated;
-		UINT uSplitSize = GetDlgItemInt(m_hDlg, IDC_SPLIT_EDIT_SIZE, &bTranslated, FALSE);
+		uint64_t splitSize = GetDlgItemInt(m_hDlg, IDC_SPLIT_EDIT_SIZE, &bTranslated, FALSE);
 
-		if (!bTranslated)
+		if (!bTranslated || splitSize == 0)
 		{
 			TCHAR szTemp[128];
 
@@ -397,21 +400,24 @@ void SplitFileDialog::OnOk()
 				break;
 
 			case SizeType::KB:
-				uSplitSize *= KB;
+				splitSize *= KB;
 				break;
 
 			case SizeType::MB:
-				uSplitSize *= MB;
+				splitSize *= MB;
 				break;
 
 			case SizeType::GB:
-				uSplitSize *= GB;
+				splitSize *= GB;
 				break;
 			}
 		}
 
-		m_pSplitFile = new SplitFile(m_hDlg, m_strFullFilename, strOutputFilename,
-			strOutputDirectory, uSplitSize);
+		bool createChecksumFile =
+			(IsDlgButtonChecked(m_hDlg, IDC_SPLIT_CHECK_CHECKSUMFILE) == BST_CHECKED);
+
+		m_pSplitFile = new SplitFile(m_hDlg, m_workPool, m_strFullFilename, strOutputFilename,
+			strOutputDirectory, splitSize, createChecksumFile);
 
 		GetDlgItemText(m_hDlg, IDOK, m_szOk, static_cast<int>(std::size(m_szOk)));
 
@@ -480,13 +486,16 @@ void SplitFileDialog::OnChangeOutputDirectory()
 	SetDlgItemText(m_hDlg, IDC_SPLIT_EDIT_OUTPUT, parsingName.c_str());
 }
 
-void SplitFileDialog::OnSplitFinished()
+void SplitFileDialog::OnSplitFinished(bool checksumFileFailed)
 {
-	TCHAR szTemp[64];
+	TCHAR szTemp[128];
 
 	if (!m_bStopSplitting)
 	{
-		LoadString(GetResourceInstance(), IDS_SPLITFILEDIALOG_FINISHED, szTemp, std::size(szTemp));
+		UINT stringId = checksumFileFailed
+			? IDS_SPLITFILEDIALOG_CHECKSUMFILEFAILED
+			: IDS_SPLITFILEDIALOG_FINISHED;
+		LoadString(GetResourceInstance(), stringId, szTemp, std::size(szTemp));
 	}
 	else
 	{
@@ -512,130 +521,164 @@ void SplitFileDialog::OnSplitFinished()
 	SetDlgItemText(m_hDlg, IDOK, m_szOk);
 }
 
-DWORD WINAPI NSplitFileDialog::SplitFileThreadProcStub(LPVOID pParam)
+void SplitFileDialog::OnSplitFailed(UINT errorStringId)
 {
-	assert(pParam != nullptr);
+	TCHAR szTemp[128];
+	LoadString(GetResourceInstance(), errorStringId, szTemp, std::size(szTemp));
+	SetDlgItemText(m_hDlg, IDC_SPLIT_STATIC_MESSAGE, szTemp);
 
-	auto *pSplitFile = reinterpret_cast<SplitFile *>(pParam);
-	pSplitFile->Split();
+	assert(m_pSplitFile != nullptr);
 
-	return 0;
+	m_pSplitFile->Release();
+	m_pSplitFile = nullptr;
+
+	m_bSplittingFile = false;
+	m_bStopSplitting = false;
+
+	KillTimer(m_hDlg, ELPASED_TIMER_ID);
+
+	SetDlgItemText(m_hDlg, IDOK, m_szOk);
 }
 
-SplitFile::SplitFile(HWND hDlg, const std::wstring &strFullFilename,
-	const std::wstring &strOutputFilename, const std::wstring &strOutputDirectory, UINT uSplitSize)
+DWORD WINAPI NSplitFileDialog::SplitFileThreadProcStub(LPVOID pParam)
 {
-	m_hDlg = hDlg;
-	m_strFullFilename = strFullFilename;
-	m_strOutputFilename = strOutputFilename;
-	m_strOutputDirectory = strOutputDirectory;
-	m_uSplitSize = uSplitSize;
+	assert(pParam != nullptr);
 
-	m_bStopSplitting = false;
+	auto *pSplitFile = reinterpret_cast<SplitFile *>(pParam);
+	pSplitFile->Split();
 
-	InitializeCriticalSection(&m_csStop);
+	return 0;
 }
 
-SplitFile::~SplitFile()
+SplitFile::SplitFile(HWND hDlg, BackgroundWorkPool *workPool,
+	const std::wstring &strFullFilename, const std::wstring &strOutputFilename,
+	const std::wstring &strOutputDirectory, uint64_t splitSize, bool createChecksumFile) :
+	m_hDlg(hDlg),
+	m_workPool(workPool),
+	m_strFullFilename(strFullFilename),
+	m_strOutputFilename(strOutputFilename),
+	m_strOutputDirectory(strOutputDirectory),
+	m_splitSize(splitSize),
+	m_createChecksumFile(createChecksumFile)
 {
-	DeleteCriticalSection(&m_csStop);
 }
 
 void SplitFile::Split()
 {
-	HANDLE hInputFile = CreateFile(m_strFullFilename.c_str(), GENERIC_READ, FILE_SHARE_READ,
-		nullptr, OPEN_EXISTING, 0, nullptr);
+	// The input file is held open (without write sharing) until the split is complete, so that it
+	// can't be modified while it's being read.
+	wil::unique_hfile inputFile(CreateFile(m_strFullFilename.c_str(), GENERIC_READ,
+		FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr));
 
-	if (hInputFile == INVALID_HANDLE_VALUE)
+	if (!inputFile)
 	{
 		PostMessage(m_hDlg, NSplitFileDialog::WM_APP_INPUTFILEINVALID, 0, 0);
 		return;
 	}
 
-	LARGE_INTEGER lFileSize;
-	GetFileSizeEx(hInputFile, &lFileSize);
+	LARGE_INTEGER fileSize;
 
-	LONGLONG nSplits = lFileSize.QuadPart / m_uSplitSize;
-
-	if ((lFileSize.QuadPart % m_uSplitSize) != 0)
+	if (!GetFileSizeEx(inputFile.get(), &fileSize))
 	{
-		nSplits++;
+		PostMessage(m_hDlg, NSplitFileDialog::WM_APP_INPUTFILEINVALID, 0, 0);
+		return;
 	}
 
-	PostMessage(m_hDlg, NSplitFileDialog::WM_APP_SETTOTALSPLITCOUNT, static_cast<WPARAM>(nSplits),
-		0);
+	auto inputSize = static_cast<uint64_t>(fileSize.QuadPart);
 
-	SplitInternal(hInputFile, lFileSize);
+	PostMessage(m_hDlg, NSplitFileDialog::WM_APP_SETTOTALSPLITCOUNT,
+		static_cast<WPARAM>(FileSplitter::GetNumParts(inputSize, m_splitSize)), 0);
 
-	CloseHandle(hInputFile);
+	auto openInputFile = [this](uint64_t offset) -> std::unique_ptr<ReadAheadPipeline::Source>
+	{ return FileReader::Open(m_strFullFilename, offset); };
 
-	SendMessage(m_hDlg, NSplitFileDialog::WM_APP_SPLITFINISHED, 0, 0);
-}
+	auto createPart = [this](size_t partIndex,
+						  uint64_t partSize) -> std::unique_ptr<FileSplitter::Sink>
+	{
+		auto partFile = FileWriter::Create(m_strOutputDirectory + _T("\\")
+			+ GetPartFilename(partIndex));
 
-void SplitFile::SplitInternal(HANDLE hInputFile, const LARGE_INTEGER &lFileSize)
-{
-	LARGE_INTEGER lRunningSplitSize = { 0 };
+		if (partFile)
+		{
+			partFile->Reserve(partSize);
+		}
+
+		return partFile;
+	};
 
-	char *pBuffer = new char[m_uSplitSize];
-	bool bStop = false;
-	int nSplitsMade = 1;
+	// Parts are written concurrently, so they won't necessarily finish in order. The progress
+	// shown is the number of parts that have been written.
+	std::atomic<size_t> numPartsWritten = 0;
 
-	while (lRunningSplitSize.QuadPart < lFileSize.QuadPart && !bStop)
+	auto onPartWritten = [this, &numPartsWritten](size_t partIndex)
 	{
-		DWORD dwNumberOfBytesRead;
-		ReadFile(hInputFile, reinterpret_cast<LPVOID>(pBuffer), m_uSplitSize, &dwNumberOfBytesRead,
-			nullptr);
+		UNREFERENCED_PARAMETER(partIndex);
 
-		std::wstring strOutputFullFilename;
-		ProcessFilename(nSplitsMade, strOutputFullFilename);
+		PostMessage(m_hDlg, NSplitFileDialog::WM_APP_SETCURRENTSPLITCOUNT, ++numPartsWritten, 0);
+	};
 
-		HANDLE hOutputFile = CreateFile(strOutputFullFilename.c_str(), GENERIC_WRITE, 0, nullptr,
-			CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+	FileSplitter splitter(m_workPool);
+	auto result = splitter.Run(inputSize, m_splitSize, m_createChecksumFile, openInputFile,
+		createPart, onPartWritten, m_stopSource.get_token());
 
-		if (hOutputFile != INVALID_HANDLE_VALUE)
-		{
-			DWORD dwNumberOfBytesWritten;
-			WriteFile(hOutputFile, reinterpret_cast<LPCVOID>(pBuffer), dwNumberOfBytesRead,
-				&dwNumberOfBytesWritten, nullptr);
+	inputFile.reset();
 
-			CloseHandle(hOutputFile);
-		}
-
-		/* TODO: Wait for a set period of time before sending message
-		(so as not to block the GUI). */
-		PostMessage(m_hDlg, NSplitFileDialog::WM_APP_SETCURRENTSPLITCOUNT, nSplitsMade, 0);
+	if (result.status == FileSplitter::Status::ReadFailed
+		|| result.status == FileSplitter::Status::WriteFailed)
+	{
+		SendMessage(m_hDlg, NSplitFileDialog::WM_APP_SPLITFAILED, 0, 0);
+		return;
+	}
 
-		lRunningSplitSize.QuadPart += dwNumberOfBytesRead;
-		nSplitsMade++;
+	bool checksumFileFailed = false;
 
-		EnterCriticalSection(&m_csStop);
-		if (m_bStopSplitting)
-		{
-			bStop = true;
-		}
-		LeaveCriticalSection(&m_csStop);
+	if (result.status == FileSplitter::Status::Succeeded && m_createChecksumFile)
+	{
+		checksumFileFailed = !WriteChecksumFile(result.checksums);
 	}
 
-	delete[] pBuffer;
+	SendMessage(m_hDlg, NSplitFileDialog::WM_APP_SPLITFINISHED, checksumFileFailed, 0);
 }
 
-void SplitFile::ProcessFilename(int nSplitsMade, std::wstring &strOutputFullFilename)
+std::wstring SplitFile::GetPartFilename(size_t partIndex) const
 {
-	std::wstring strOutputFilename = m_strOutputFilename;
+	std::wstring partFilename = m_strOutputFilename;
+	partFilename.replace(partFilename.find(NSplitFileDialog::COUNTER_PATTERN),
+		std::size(NSplitFileDialog::COUNTER_PATTERN) - 1, std::to_wstring(partIndex + 1));
+	return partFilename;
+}
+
+// Writes an SFV file, which lists each part, along with its CRC-32. The file is named after the
+// input file and is placed alongside the parts.
+bool SplitFile::WriteChecksumFile(const std::vector<uint32_t> &checksums) const
+{
+	std::string contents;
+
+	for (size_t i = 0; i < checksums.size(); i++)
+	{
+		contents += std::format("{} {:08X}\r\n", wstrToUtf8Str(GetPartFilename(i)), checksums[i]);
+	}
 
-	std::wstringstream ss;
-	ss << nSplitsMade;
-	strOutputFilename.replace(strOutputFilename.find(NSplitFileDialog::COUNTER_PATTERN), 2,
-		ss.str());
+	auto checksumFile = FileWriter::Create(m_strOutputDirectory + _T("\\")
+		+ PathFindFileName(m_strFullFilename.c_str()) + NSplitFileDialog::CHECKSUM_FILE_EXTENSION);
 
-	strOutputFullFilename = m_strOutputDirectory + _T("\\") + strOutputFilename;
+	if (!checksumFile)
+	{
+		return false;
+	}
+
+	if (!checksumFile->Write(std::as_bytes(std::span(contents))))
+	{
+		checksumFile->Discard();
+		return false;
+	}
+
+	return true;
 }
 
 void SplitFile::StopSplitting()
 {
-	EnterCriticalSection(&m_csStop);
-	m_bStopSplitting = true;
-	LeaveCriticalSection(&m_csStop);
+	m_stopSource.request_stop();
 }
 
 SplitFileDialogPersistentSettings::SplitFileDialogPersistentSettings() :
@@ -643,6 +686,7 @@ SplitFileDialogPersistentSettings::SplitFileDialogPersistentSettings() :
 {
 	m_strSplitSize = _T("10");
 	m_strSplitGroup = _T("KB");
+	m_createChecksumFile = false;
 }
 
 SplitFileDialogPersistentSettings &SplitFileDialogPersistentSettings::GetInstance()
@@ -655,12 +699,15 @@ void SplitFileDialogPersistentSettings::SaveExtraRegistrySettings(HKEY hKey)
 {
 	RegistrySettings::SaveString(hKey, SETTING_SIZE, m_strSplitSize);
 	RegistrySettings::SaveString(hKey, SETTING_SIZE_GROUP, m_strSplitGroup);
+	RegistrySettings::SaveDword(hKey, SETTING_CREATE_CHECKSUM_FILE, m_createChecksumFile);
 }
 
 void SplitFileDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 {
 	RegistrySettings::ReadString(hKey, SETTING_SIZE, m_strSplitSize);
 	RegistrySettings::ReadString(hKey, SETTING_SIZE_GROUP, m_strSplitGroup);
+	RegistrySettings::Read32BitValueFromRegistry(hKey, SETTING_CREATE_CHECKSUM_FILE,
+		m_createChecksumFile);
 }
 
 void SplitFileDialogPersistentSettings::SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom,
@@ -669,6 +716,8 @@ void SplitFileDialogPersistentSettings::SaveExtraXMLSettings(IXMLDOMDocument *pX
 	XMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SIZE, m_strSplitSize.c_str());
 	XMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_SIZE_GROUP,
 		m_strSplitGroup.c_str());
+	XMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_CREATE_CHECKSUM_FILE,
+		XMLSettings::EncodeBoolValue(m_createChecksumFile));
 }
 
 void SplitFileDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
@@ -681,4 +730,8 @@ void SplitFileDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR
 	{
 		m_strSplitGroup = _bstr_t(bstrValue);
 	}
+	else if (lstrcmpi(bstrName, SETTING_CREATE_CHECKSUM_FILE) == 0)
+	{
+		m_createChecksumFile = XMLSettings::DecodeBoolValue(bstrValue);
+	}
 }
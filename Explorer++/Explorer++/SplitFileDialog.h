@@ -7,9 +7,13 @@
 #include "ThemedDialog.h"
 #include "../Helper/DialogSettings.h"
 #include "../Helper/ReferenceCount.h"
+#include <cstdint>
+#include <stop_token>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+class BackgroundWorkPool;
 class IconResourceLoader;
 class SplitFileDialog;
 
@@ -25,6 +29,7 @@ private:
 
 	static const TCHAR SETTING_SIZE[];
 	static const TCHAR SETTING_SIZE_GROUP[];
+	static const TCHAR SETTING_CREATE_CHECKSUM_FILE[];
 
 	SplitFileDialogPersistentSettings();
 
@@ -39,38 +44,45 @@ private:
 
 	std::wstring m_strSplitSize;
 	std::wstring m_strSplitGroup;
+	bool m_createChecksumFile;
 };
 
+// Splits a file into parts using FileSplitter, which writes several parts at once, with a fixed
+// amount of buffer memory. If requested, an SFV file listing the CRC-32 of each part is also
+// written to the output directory. The checksums are calculated as the parts are written, so the
+// parts don't have to be read back in.
 class SplitFile : public ReferenceCount
 {
 public:
-	SplitFile(HWND hDlg, const std::wstring &strFullFilename, const std::wstring &strOutputFilename,
-		const std::wstring &strOutputDirectory, UINT uSplitSize);
-	~SplitFile();
+	SplitFile(HWND hDlg, BackgroundWorkPool *workPool, const std::wstring &strFullFilename,
+		const std::wstring &strOutputFilename, const std::wstring &strOutputDirectory,
+		uint64_t splitSize, bool createChecksumFile);
 
 	void Split();
 	void StopSplitting();
 
 private:
-	void SplitInternal(HANDLE hInputFile, const LARGE_INTEGER &lFileSize);
-	void ProcessFilename(int nSplitsMade, std::wstring &strOutputFullFilename);
+	std::wstring GetPartFilename(size_t partIndex) const;
+	bool WriteChecksumFile(const std::vector<uint32_t> &checksums) const;
 
 	HWND m_hDlg;
+	BackgroundWorkPool *const m_workPool;
 
 	std::wstring m_strFullFilename;
 	std::wstring m_strOutputFilename;
 	std::wstring m_strOutputDirectory;
-	UINT m_uSplitSize;
+	uint64_t m_splitSize;
+	bool m_createChecksumFile;
 
-	CRITICAL_SECTION m_csStop;
-	bool m_bStopSplitting;
+	std::stop_source m_stopSource;
 };
 
 class SplitFileDialog : public ThemedDialog
 {
 public:
 	SplitFileDialog(HINSTANCE resourceInstance, HWND hParent, ThemeManager *themeManager,
-		const IconResourceLoader *iconResourceLoader, const std::wstring &strFullFilename);
+		const IconResourceLoader *iconResourceLoader, BackgroundWorkPool *workPool,
+		const std::wstring &strFullFilename);
 	~SplitFileDialog();
 
 protected:
@@ -114,9 +126,11 @@ private:
 	void OnOk();
 	void OnCancel();
 	void OnChangeOutputDirectory();
-	void OnSplitFinished();
+	void OnSplitFinished(bool checksumFileFailed);
+	void OnSplitFailed(UINT errorStringId);
 
 	const IconResourceLoader *const m_iconResourceLoader;
+	BackgroundWorkPool *const m_workPool;
 
 	std::wstring m_strFullFilename;
 	bool m_bSplittingFile;
@@ -5,6 +5,7 @@
 #include "stdafx.h"
 #include "Storage.h"
 #include "../Helper/ProcessHelper.h"
+#include <wil/resource.h>
 #include <filesystem>
 
 namespace Storage
@@ -21,4 +22,25 @@ std::wstring GetConfigFilePath()
 	return configFilePath.c_str();
 }
 
+std::wstring GetColumnValueCacheFilePath()
+{
+	wil::unique_cotaskmem_string localAppDataPath;
+	HRESULT hr = SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_DEFAULT, nullptr,
+		&localAppDataPath);
+
+	if (FAILED(hr))
+	{
+		// Fall back to storing the cache alongside the executable.
+		std::filesystem::path cacheFilePath(GetConfigFilePath());
+		cacheFilePath.replace_filename(COLUMN_VALUE_CACHE_FILENAME);
+		return cacheFilePath.c_str();
+	}
+
+	std::filesystem::path cacheFilePath(localAppDataPath.get());
+	cacheFilePath /= COLUMN_VALUE_CACHE_DIRECTORY_NAME;
+	cacheFilePath /= COLUMN_VALUE_CACHE_FILENAME;
+
+	return cacheFilePath.c_str();
+}
+
 }
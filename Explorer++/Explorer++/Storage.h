@@ -24,6 +24,12 @@ inline const wchar_t CONFIG_FILE_FILENAME[] = L"config.xml";
 inline const wchar_t CONFIG_FILE_ROOT_NODE_NAME[] = L"ExplorerPlusPlus";
 inline const wchar_t CONFIG_FILE_SETTINGS_NODE_NAME[] = L"Settings";
 
+// The column value cache is stored in the local (i.e. non-roaming) application data folder, since
+// it can be large and is only a cache.
+inline const wchar_t COLUMN_VALUE_CACHE_DIRECTORY_NAME[] = L"Explorer++";
+inline const wchar_t COLUMN_VALUE_CACHE_FILENAME[] = L"ColumnValueCache.dat";
+
 std::wstring GetConfigFilePath();
+std::wstring GetColumnValueCacheFilePath();
 
 }
@@ -334,6 +334,12 @@ void Explorerplusplus::OnTabListViewSelectionChanged(const Tab &tab)
 
 	if (GetActivePane()->GetTabContainer()->IsTabSelected(tab))
 	{
+		// Folder sizes are only calculated for the selected tab, so none of the outstanding
+		// calculations are needed any more. Cancelled calculations don't report back, so their
+		// entries are removed here.
+		m_folderSizeTaskGroup.CancelPendingTasks();
+		m_DWFolderSizes.clear();
+
 		SetTimer(m_hContainer, LISTVIEW_ITEM_CHANGED_TIMER_ID, LISTVIEW_ITEM_CHANGED_TIMEOUT,
 			nullptr);
 	}
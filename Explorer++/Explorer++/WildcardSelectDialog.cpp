@@ -4,22 +4,27 @@
 
 #include "stdafx.h"
 #include "WildcardSelectDialog.h"
+#include "App.h"
 #include "BrowserPane.h"
 #include "BrowserWindow.h"
 #include "MainResource.h"
 #include "ResourceHelper.h"
+#include "ShellBrowser/NamePatternMatcher.h"
 #include "ShellBrowser/ShellBrowserImpl.h"
 #include "TabContainer.h"
 #include "../Helper/BaseDialog.h"
-#include "../Helper/ListViewHelper.h"
 #include "../Helper/RegistrySettings.h"
 #include "../Helper/WindowHelper.h"
 #include "../Helper/XMLSettings.h"
+#include <boost/regex.hpp>
+#include <optional>
 
 const TCHAR WildcardSelectDialogPersistentSettings::SETTINGS_KEY[] = _T("WildcardSelect");
 
 const TCHAR WildcardSelectDialogPersistentSettings::SETTING_PATTERN_LIST[] = _T("Pattern");
 const TCHAR WildcardSelectDialogPersistentSettings::SETTING_CURRENT_TEXT[] = _T("CurrentText");
+const TCHAR WildcardSelectDialogPersistentSettings::SETTING_USE_REGULAR_EXPRESSIONS[] =
+	_T("UseRegularExpressions");
 
 WildcardSelectDialog::WildcardSelectDialog(HINSTANCE resourceInstance, HWND hParent,
 	ThemeManager *themeManager, BOOL bSelect, BrowserWindow *browserWindow) :
@@ -45,6 +50,11 @@ INT_PTR WildcardSelectDialog::OnInitDialog()
 
 	ComboBox_SetText(hComboBox, m_pwsdps->m_pattern.c_str());
 
+	if (m_pwsdps->m_useRegularExpressions)
+	{
+		CheckDlgButton(m_hDlg, IDC_WILDCARDSELECT_USE_REGULAR_EXPRESSIONS, BST_CHECKED);
+	}
+
 	if (!m_bSelect)
 	{
 		std::wstring deselectTitle =
@@ -64,6 +74,8 @@ std::vector<ResizableDialogControl> WildcardSelectDialog::GetResizableControls()
 	std::vector<ResizableDialogControl> controls;
 	controls.emplace_back(GetDlgItem(m_hDlg, IDC_SELECTGROUP_COMBOBOX), MovingType::None,
 		SizingType::Horizontal);
+	controls.emplace_back(GetDlgItem(m_hDlg, IDC_WILDCARDSELECT_USE_REGULAR_EXPRESSIONS),
+		MovingType::None, SizingType::Horizontal);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDOK), MovingType::Horizontal, SizingType::None);
 	controls.emplace_back(GetDlgItem(m_hDlg, IDCANCEL), MovingType::Horizontal, SizingType::None);
 	return controls;
@@ -94,7 +106,13 @@ void WildcardSelectDialog::OnOk()
 
 	if (lstrlen(szPattern) != 0)
 	{
-		SelectItems(szPattern);
+		if (!SelectItems(szPattern))
+		{
+			auto errorMessage = ResourceHelper::LoadString(GetResourceInstance(),
+				IDS_WILDCARDSELECT_REGULAR_EXPRESSION_INVALID);
+			MessageBox(m_hDlg, errorMessage.c_str(), App::APP_NAME, MB_ICONWARNING | MB_OK);
+			return;
+		}
 
 		bool bStorePattern = true;
 
@@ -120,22 +138,29 @@ void WildcardSelectDialog::OnOk()
 	EndDialog(m_hDlg, 1);
 }
 
-void WildcardSelectDialog::SelectItems(TCHAR *szPattern)
+// Returns false if the pattern is a regular expression that isn't valid.
+bool WildcardSelectDialog::SelectItems(const std::wstring &pattern)
 {
-	const auto &tab = m_browserWindow->GetActivePane()->GetTabContainer()->GetSelectedTab();
-	HWND hListView = tab.GetShellBrowserImpl()->GetListView();
-
-	int nItems = ListView_GetItemCount(hListView);
-
-	for (int i = 0; i < nItems; i++)
+	bool useRegularExpressions =
+		IsDlgButtonChecked(m_hDlg, IDC_WILDCARDSELECT_USE_REGULAR_EXPRESSIONS) == BST_CHECKED;
+	auto syntax = useRegularExpressions
+		? NamePatternMatcher::Syntax::RegularExpression
+		: NamePatternMatcher::Syntax::Wildcard;
+	std::optional<NamePatternMatcher> matcher;
+
+	try
 	{
-		std::wstring filename = tab.GetShellBrowserImpl()->GetItemName(i);
-
-		if (CheckWildcardMatch(szPattern, filename.c_str(), FALSE) == 1)
-		{
-			ListViewHelper::SelectItem(hListView, i, m_bSelect);
-		}
+		matcher.emplace(pattern, syntax, false);
 	}
+	catch (const boost::regex_error &)
+	{
+		return false;
+	}
+
+	const auto &tab = m_browserWindow->GetActivePane()->GetTabContainer()->GetSelectedTab();
+	tab.GetShellBrowserImpl()->SelectItemsMatching(*matcher, m_bSelect);
+
+	return true;
 }
 
 void WildcardSelectDialog::OnCancel()
@@ -154,12 +179,15 @@ void WildcardSelectDialog::SaveState()
 	m_pwsdps->SaveDialogPosition(m_hDlg);
 
 	m_pwsdps->m_pattern = GetDlgItemString(m_hDlg, IDC_SELECTGROUP_COMBOBOX);
+	m_pwsdps->m_useRegularExpressions =
+		IsDlgButtonChecked(m_hDlg, IDC_WILDCARDSELECT_USE_REGULAR_EXPRESSIONS) == BST_CHECKED;
 
 	m_pwsdps->m_bStateSaved = TRUE;
 }
 
 WildcardSelectDialogPersistentSettings::WildcardSelectDialogPersistentSettings() :
-	DialogSettings(SETTINGS_KEY)
+	DialogSettings(SETTINGS_KEY),
+	m_useRegularExpressions(false)
 {
 }
 
@@ -173,12 +201,15 @@ void WildcardSelectDialogPersistentSettings::SaveExtraRegistrySettings(HKEY hKey
 {
 	RegistrySettings::SaveStringList(hKey, SETTING_PATTERN_LIST, m_PatternList);
 	RegistrySettings::SaveString(hKey, SETTING_CURRENT_TEXT, m_pattern);
+	RegistrySettings::SaveDword(hKey, SETTING_USE_REGULAR_EXPRESSIONS, m_useRegularExpressions);
 }
 
 void WildcardSelectDialogPersistentSettings::LoadExtraRegistrySettings(HKEY hKey)
 {
 	RegistrySettings::ReadStringList(hKey, SETTING_PATTERN_LIST, m_PatternList);
 	RegistrySettings::ReadString(hKey, SETTING_CURRENT_TEXT, m_pattern);
+	RegistrySettings::Read32BitValueFromRegistry(hKey, SETTING_USE_REGULAR_EXPRESSIONS,
+		m_useRegularExpressions);
 }
 
 void WildcardSelectDialogPersistentSettings::SaveExtraXMLSettings(IXMLDOMDocument *pXMLDom,
@@ -186,6 +217,8 @@ void WildcardSelectDialogPersistentSettings::SaveExtraXMLSettings(IXMLDOMDocumen
 {
 	XMLSettings::AddStringListToNode(pXMLDom, pParentNode, SETTING_PATTERN_LIST, m_PatternList);
 	XMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_CURRENT_TEXT, m_pattern.c_str());
+	XMLSettings::AddAttributeToNode(pXMLDom, pParentNode, SETTING_USE_REGULAR_EXPRESSIONS,
+		XMLSettings::EncodeBoolValue(m_useRegularExpressions));
 }
 
 void WildcardSelectDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName, BSTR bstrValue)
@@ -200,4 +233,8 @@ void WildcardSelectDialogPersistentSettings::LoadExtraXMLSettings(BSTR bstrName,
 	{
 		m_pattern = bstrValue;
 	}
+	else if (lstrcmpi(bstrName, SETTING_USE_REGULAR_EXPRESSIONS) == 0)
+	{
+		m_useRegularExpressions = XMLSettings::DecodeBoolValue(bstrValue);
+	}
 }
@@ -28,6 +28,7 @@ private:
 
 	static const TCHAR SETTING_PATTERN_LIST[];
 	static const TCHAR SETTING_CURRENT_TEXT[];
+	static const TCHAR SETTING_USE_REGULAR_EXPRESSIONS[];
 
 	WildcardSelectDialogPersistentSettings();
 
@@ -43,6 +44,7 @@ private:
 
 	std::wstring m_pattern;
 	std::list<std::wstring> m_PatternList;
+	bool m_useRegularExpressions;
 };
 
 class WildcardSelectDialog : public ThemedDialog
@@ -62,7 +64,7 @@ private:
 
 	void OnOk();
 	void OnCancel();
-	void SelectItems(TCHAR *szPattern);
+	bool SelectItems(const std::wstring &pattern);
 
 	BOOL m_bSelect;
 	BrowserWindow *m_browserWindow = nullptr;
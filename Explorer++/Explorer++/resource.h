@@ -205,6 +205,12 @@
 #define IDS_SEARCH_OPEN_ITEM_LOCATION_HELP_TEXT 401
 #define IDD_OPTIONS_STARTUP             402
 #define IDS_OPTIONS_CUSTOM_FOLDERS_TOOLTIP 403
+#define IDS_GROUPBY_LOADING             404
+#define IDS_WILDCARDSELECT_REGULAR_EXPRESSION_INVALID 405
+#define IDS_MERGE_FILES_MERGEFAILED     406
+#define IDS_SPLITFILEDIALOG_SPLITFAILED 407
+#define IDS_SPLITFILEDIALOG_CHECKSUMFILEFAILED 408
+#define IDS_DESTROY_FILES_FAILED        409
 #define IDC_DEFAULTCOLUMNS_DESCRIPTION  1001
 #define IDC_COLUMNS_DESCRIPTION         1001
 #define IDC_SETTINGS_CHECK_EXTENSIONS   1002
@@ -430,6 +436,10 @@
 #define IDC_OPTIONS_MAIN_FONT           1373
 #define IDC_STARTUP_CUSTOM_FOLDERS      1374
 #define IDC_STARTUP_CUSTOM_FOLDERS_LIST 1375
+#define IDC_FILTERS_FILTER_AS_YOU_TYPE  1376
+#define IDC_WILDCARDSELECT_USE_REGULAR_EXPRESSIONS 1377
+#define IDC_SPLIT_CHECK_CHECKSUMFILE    1378
+#define IDC_DESTROYFILES_PROGRESS       1379
 #define IDS_COLUMN_DESCRIPTION_NAME     2000
 #define IDS_COLUMN_DESCRIPTION_TYPE     2001
 #define IDS_COLUMN_DESCRIPTION_SIZE     2002
@@ -982,9 +992,9 @@
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        404
+#define _APS_NEXT_RESOURCE_VALUE        410
 #define _APS_NEXT_COMMAND_VALUE         40554
-#define _APS_NEXT_CONTROL_VALUE         1376
+#define _APS_NEXT_CONTROL_VALUE         1380
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
@@ -0,0 +1,159 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "BackgroundWorkPool.h"
+#include <algorithm>
+#include <atomic>
+
+BackgroundWorkPool::BackgroundWorkPool(std::shared_ptr<concurrencpp::executor> executor) :
+	m_executor(executor)
+{
+}
+
+int BackgroundWorkPool::GetMaxConcurrency() const
+{
+	return m_executor->max_concurrency_level();
+}
+
+std::shared_ptr<BackgroundWorkPool::GroupState> BackgroundWorkPool::CreateGroup()
+{
+	return std::make_shared<GroupState>();
+}
+
+void BackgroundWorkPool::Enqueue(const std::shared_ptr<GroupState> &group, TaskPriority priority,
+	Task task)
+{
+	std::unique_lock lock(m_mutex);
+
+	m_queue.emplace(QueueKey{ priority, m_nextSequence++ },
+		QueuedTask{ group, group->stopSource.get_token(), std::move(task) });
+
+	lock.unlock();
+
+	// Each job runs whichever task has the highest priority at the time it starts, rather than the
+	// task queued here. There's one job per task, however, so every task that isn't cancelled will
+	// eventually be run.
+	m_executor->post([this] { RunNextTask(); });
+}
+
+void BackgroundWorkPool::CancelTasks(const std::shared_ptr<GroupState> &group)
+{
+	std::vector<QueuedTask> cancelledTasks;
+
+	std::unique_lock lock(m_mutex);
+
+	for (auto itr = m_queue.begin(); itr != m_queue.end();)
+	{
+		if (itr->second.group == group)
+		{
+			cancelledTasks.push_back(std::move(itr->second));
+			itr = m_queue.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+
+	// Running tasks hold a token from the existing stop source. Subsequent tasks will be given a
+	// token from the new source.
+	group->stopSource.request_stop();
+	group->stopSource = {};
+
+	lock.unlock();
+
+	// The cancelled tasks are destroyed here, outside the lock, since destroying a task will
+	// destroy anything it's captured.
+	cancelledTasks.clear();
+}
+
+void BackgroundWorkPool::WaitForRunningTasks(const std::shared_ptr<GroupState> &group)
+{
+	std::unique_lock lock(m_mutex);
+	m_taskFinishedCondition.wait(lock, [&group] { return group->numRunningTasks == 0; });
+}
+
+void BackgroundWorkPool::RunNextTask()
+{
+	std::unique_lock lock(m_mutex);
+
+	if (m_queue.empty())
+	{
+		// The task this job was queued for has been cancelled, or already run by another job.
+		return;
+	}
+
+	auto node = m_queue.extract(m_queue.begin());
+	auto &queuedTask = node.mapped();
+	queuedTask.group->numRunningTasks++;
+
+	lock.unlock();
+
+	queuedTask.task(queuedTask.stopToken);
+
+	// The task is destroyed before the group is marked as idle, so that nothing the task has
+	// captured will outlive the group's owner.
+	queuedTask.task = nullptr;
+
+	lock.lock();
+	queuedTask.group->numRunningTasks--;
+	lock.unlock();
+
+	m_taskFinishedCondition.notify_all();
+}
+
+TaskGroup::TaskGroup(BackgroundWorkPool *workPool) :
+	m_workPool(workPool),
+	m_group(workPool->CreateGroup())
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+	CancelPendingTasks();
+	m_workPool->WaitForRunningTasks(m_group);
+}
+
+void TaskGroup::CancelPendingTasks()
+{
+	m_workPool->CancelTasks(m_group);
+}
+
+void RunConcurrently(BackgroundWorkPool *workPool, const std::vector<std::function<void()>> &funcs,
+	TaskPriority priority)
+{
+	if (funcs.empty())
+	{
+		return;
+	}
+
+	std::atomic<size_t> nextIndex = 0;
+
+	auto runRemainingFuncs = [&funcs, &nextIndex]
+	{
+		for (size_t i = nextIndex++; i < funcs.size(); i = nextIndex++)
+		{
+			funcs[i]();
+		}
+	};
+
+	TaskGroup taskGroup(workPool);
+
+	// The calling thread runs functions as well, so one less task is needed.
+	size_t numTasks =
+		std::min(funcs.size(), static_cast<size_t>(std::max(workPool->GetMaxConcurrency(), 1)))
+		- 1;
+
+	for (size_t i = 0; i < numTasks; i++)
+	{
+		taskGroup.Push(runRemainingFuncs, priority);
+	}
+
+	runRemainingFuncs();
+
+	// At this point, every function has been started. Tasks that haven't started yet have nothing
+	// left to do and are removed by the TaskGroup destructor, which then waits for any tasks still
+	// running one of the functions.
+}
@@ -0,0 +1,142 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <boost/core/noncopyable.hpp>
+#include <concurrencpp/concurrencpp.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <type_traits>
+#include <vector>
+
+// Tasks with a higher priority are run first. Tasks with the same priority are run in the order
+// they were queued.
+enum class TaskPriority
+{
+	High,
+	Normal,
+	Low
+};
+
+// A single, process-wide queue of background work. Tasks are run on a shared executor (in
+// practice, the COM STA thread pool), so the total number of threads stays fixed, no matter how
+// many components are queueing work.
+//
+// Tasks are submitted through a TaskGroup, which allows the tasks belonging to a particular
+// component (e.g. a tab) to be cancelled together.
+//
+// This class is thread-safe.
+class BackgroundWorkPool : private boost::noncopyable
+{
+public:
+	BackgroundWorkPool(std::shared_ptr<concurrencpp::executor> executor);
+
+	int GetMaxConcurrency() const;
+
+private:
+	friend class TaskGroup;
+
+	using Task = std::function<void(std::stop_token stopToken)>;
+
+	struct GroupState
+	{
+		std::stop_source stopSource;
+		int numRunningTasks = 0;
+	};
+
+	struct QueueKey
+	{
+		TaskPriority priority;
+		uint64_t sequence;
+
+		auto operator<=>(const QueueKey &) const = default;
+	};
+
+	struct QueuedTask
+	{
+		std::shared_ptr<GroupState> group;
+		std::stop_token stopToken;
+		Task task;
+	};
+
+	std::shared_ptr<GroupState> CreateGroup();
+	void Enqueue(const std::shared_ptr<GroupState> &group, TaskPriority priority, Task task);
+	void CancelTasks(const std::shared_ptr<GroupState> &group);
+	void WaitForRunningTasks(const std::shared_ptr<GroupState> &group);
+	void RunNextTask();
+
+	const std::shared_ptr<concurrencpp::executor> m_executor;
+
+	std::mutex m_mutex;
+	std::condition_variable m_taskFinishedCondition;
+	std::map<QueueKey, QueuedTask> m_queue;
+	uint64_t m_nextSequence = 0;
+};
+
+// Represents a set of tasks queued by a single component. Tasks can be cancelled as a group and
+// the destructor will wait for any running tasks to finish, so tasks can safely reference the
+// owning component.
+class TaskGroup : private boost::noncopyable
+{
+public:
+	TaskGroup(BackgroundWorkPool *workPool);
+	~TaskGroup();
+
+	// Queues a task and returns a future that will hold its result. The task can optionally accept
+	// a std::stop_token, which will be signaled if the task is cancelled while it's running.
+	template <typename Func>
+	auto Push(Func func, TaskPriority priority = TaskPriority::Normal)
+	{
+		auto wrappedFunc =
+			[func = std::move(func)]([[maybe_unused]] std::stop_token stopToken) mutable
+		{
+			if constexpr (std::is_invocable_v<Func &, std::stop_token>)
+			{
+				return func(stopToken);
+			}
+			else
+			{
+				return func();
+			}
+		};
+
+		using ResultType = std::invoke_result_t<decltype(wrappedFunc) &, std::stop_token>;
+
+		auto task = std::make_shared<std::packaged_task<ResultType(std::stop_token)>>(
+			std::move(wrappedFunc));
+		auto future = task->get_future();
+
+		m_workPool->Enqueue(m_group, priority,
+			[task](std::stop_token stopToken) { (*task)(stopToken); });
+
+		return future;
+	}
+
+	// Removes any tasks in this group that haven't started yet and signals any tasks that are
+	// currently running to stop. The futures for removed tasks will be left without a value.
+	void CancelPendingTasks();
+
+private:
+	BackgroundWorkPool *const m_workPool;
+	const std::shared_ptr<BackgroundWorkPool::GroupState> m_group;
+};
+
+// Runs each of the functions and returns once they've all finished. The functions are spread
+// across the pool and the calling thread, with up to one task being queued for each pool thread.
+// Each task (as well as the calling thread) repeatedly takes the next function that hasn't been
+// started yet, so functions that no pool thread has picked up by the time the calling thread is
+// free are run by the calling thread itself.
+//
+// That means the caller never waits on tasks that are queued behind unrelated work; the worst case
+// is that every function is run on the calling thread. It also means that this can safely be
+// called from a task that's running on the pool.
+void RunConcurrently(BackgroundWorkPool *workPool, const std::vector<std::function<void()>> &funcs,
+	TaskPriority priority = TaskPriority::High);
@@ -0,0 +1,112 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ChaCha20.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+
+// "expand 32-byte k"
+constexpr std::array<uint32_t, 4> CONSTANTS = { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+
+constexpr int NUM_DOUBLE_ROUNDS = 10;
+
+uint32_t LoadLittleEndian32(const std::byte *data)
+{
+	return std::to_integer<uint32_t>(data[0]) | (std::to_integer<uint32_t>(data[1]) << 8)
+		| (std::to_integer<uint32_t>(data[2]) << 16) | (std::to_integer<uint32_t>(data[3]) << 24);
+}
+
+void StoreLittleEndian32(uint32_t value, std::byte *data)
+{
+	data[0] = static_cast<std::byte>(value);
+	data[1] = static_cast<std::byte>(value >> 8);
+	data[2] = static_cast<std::byte>(value >> 16);
+	data[3] = static_cast<std::byte>(value >> 24);
+}
+
+void QuarterRound(std::array<uint32_t, 16> &x, int a, int b, int c, int d)
+{
+	x[a] += x[b];
+	x[d] = std::rotl(x[d] ^ x[a], 16);
+	x[c] += x[d];
+	x[b] = std::rotl(x[b] ^ x[c], 12);
+	x[a] += x[b];
+	x[d] = std::rotl(x[d] ^ x[a], 8);
+	x[c] += x[d];
+	x[b] = std::rotl(x[b] ^ x[c], 7);
+}
+
+}
+
+ChaCha20::ChaCha20(const Key &key, const Nonce &nonce, uint64_t counter)
+{
+	std::copy(CONSTANTS.begin(), CONSTANTS.end(), m_state.begin());
+
+	for (size_t i = 0; i < 8; i++)
+	{
+		m_state[4 + i] = LoadLittleEndian32(key.data() + i * 4);
+	}
+
+	m_state[12] = static_cast<uint32_t>(counter);
+	m_state[13] = static_cast<uint32_t>(counter >> 32);
+	m_state[14] = LoadLittleEndian32(nonce.data());
+	m_state[15] = LoadLittleEndian32(nonce.data() + 4);
+}
+
+void ChaCha20::Generate(std::span<std::byte> output)
+{
+	if (m_leftoverOffset < BLOCK_SIZE)
+	{
+		size_t size = std::min(output.size(), BLOCK_SIZE - m_leftoverOffset);
+		std::copy_n(m_leftover.begin() + m_leftoverOffset, size, output.begin());
+		m_leftoverOffset += size;
+		output = output.subspan(size);
+	}
+
+	while (output.size() >= BLOCK_SIZE)
+	{
+		GenerateBlock(output.first<BLOCK_SIZE>());
+		output = output.subspan(BLOCK_SIZE);
+	}
+
+	if (!output.empty())
+	{
+		GenerateBlock(m_leftover);
+		std::copy_n(m_leftover.begin(), output.size(), output.begin());
+		m_leftoverOffset = output.size();
+	}
+}
+
+void ChaCha20::GenerateBlock(std::span<std::byte, BLOCK_SIZE> output)
+{
+	auto working = m_state;
+
+	for (int i = 0; i < NUM_DOUBLE_ROUNDS; i++)
+	{
+		QuarterRound(working, 0, 4, 8, 12);
+		QuarterRound(working, 1, 5, 9, 13);
+		QuarterRound(working, 2, 6, 10, 14);
+		QuarterRound(working, 3, 7, 11, 15);
+		QuarterRound(working, 0, 5, 10, 15);
+		QuarterRound(working, 1, 6, 11, 12);
+		QuarterRound(working, 2, 7, 8, 13);
+		QuarterRound(working, 3, 4, 9, 14);
+	}
+
+	for (size_t i = 0; i < working.size(); i++)
+	{
+		StoreLittleEndian32(working[i] + m_state[i], output.data() + i * 4);
+	}
+
+	m_state[12]++;
+
+	if (m_state[12] == 0)
+	{
+		m_state[13]++;
+	}
+}
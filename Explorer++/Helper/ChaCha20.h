@@ -0,0 +1,45 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Generates the ChaCha20 keystream, which can be used as a fast source of cryptographically secure
+// random data, once seeded with a random key.
+//
+// The block function is the one specified in RFC 8439, but the block counter and nonce are both
+// 64 bits (as in the original ChaCha design), so that a single key and nonce can produce far more
+// than the 256GB allowed by a 32-bit counter. With a counter below 2^32 and a nonce whose first 4
+// bytes are zero, the output is identical to RFC 8439.
+class ChaCha20
+{
+public:
+	static constexpr size_t KEY_SIZE = 32;
+	static constexpr size_t NONCE_SIZE = 8;
+	static constexpr size_t BLOCK_SIZE = 64;
+
+	using Key = std::array<std::byte, KEY_SIZE>;
+	using Nonce = std::array<std::byte, NONCE_SIZE>;
+
+	ChaCha20(const Key &key, const Nonce &nonce = {}, uint64_t counter = 0);
+
+	// Fills the output with the next output.size() bytes of the keystream.
+	void Generate(std::span<std::byte> output);
+
+private:
+	using Block = std::array<std::byte, BLOCK_SIZE>;
+
+	void GenerateBlock(std::span<std::byte, BLOCK_SIZE> output);
+
+	std::array<uint32_t, 16> m_state;
+
+	// Keystream that has been generated but not yet returned, when a previous request ended part
+	// way through a block.
+	Block m_leftover;
+	size_t m_leftoverOffset = BLOCK_SIZE;
+};
@@ -0,0 +1,71 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "CollationKey.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+DWORD GetMapFlags(CollationKey::Type type)
+{
+	switch (type)
+	{
+	case CollationKey::Type::Natural:
+		// SORT_DIGITSASNUMBERS is what StrCmpLogicalW uses to compare digits by value. The
+		// resulting sort key encodes each run of digits as a number, so the runs compare by value
+		// when the keys are compared byte by byte.
+		return LCMAP_SORTKEY | NORM_IGNORECASE | SORT_DIGITSASNUMBERS;
+
+	case CollationKey::Type::CaseInsensitive:
+	default:
+		return LCMAP_SORTKEY | NORM_IGNORECASE;
+	}
+}
+
+}
+
+CollationKey::CollationKey(std::wstring_view str, Type type)
+{
+	if (str.empty())
+	{
+		return;
+	}
+
+	DWORD flags = GetMapFlags(type);
+	int length = static_cast<int>(str.size());
+
+	// When LCMAP_SORTKEY is specified, the sizes are in bytes, rather than characters.
+	int keySize = LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, str.data(), length, nullptr, 0,
+		nullptr, nullptr, 0);
+
+	if (keySize == 0)
+	{
+		return;
+	}
+
+	m_key.resize(keySize);
+	keySize = LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, str.data(), length,
+		reinterpret_cast<LPWSTR>(m_key.data()), keySize, nullptr, nullptr, 0);
+	m_key.resize(keySize);
+}
+
+int CollationKey::Compare(const CollationKey &other) const
+{
+	size_t commonSize = std::min(m_key.size(), other.m_key.size());
+
+	if (commonSize > 0)
+	{
+		int result = std::memcmp(m_key.data(), other.m_key.data(), commonSize);
+
+		if (result != 0)
+		{
+			return result < 0 ? -1 : 1;
+		}
+	}
+
+	return (m_key.size() > other.m_key.size()) - (m_key.size() < other.m_key.size());
+}
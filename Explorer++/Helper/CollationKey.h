@@ -0,0 +1,39 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// A binary key, built from a string, that orders strings according to the user's locale. Two keys
+// are compared with a simple byte comparison, which is significantly cheaper than comparing the
+// original strings, so building keys is worthwhile whenever the same strings are going to be
+// compared repeatedly (for example, when sorting a large number of items).
+class CollationKey
+{
+public:
+	enum class Type
+	{
+		// Orders strings in the same way as StrCmpLogicalW. That is, the comparison is
+		// case-insensitive and runs of digits are compared by their numeric value (so "file2"
+		// is ordered before "file10").
+		Natural,
+
+		// Orders strings in the same way as StrCmpIW.
+		CaseInsensitive
+	};
+
+	// An empty key, which is ordered before the key for any non-empty string.
+	CollationKey() = default;
+	CollationKey(std::wstring_view str, Type type);
+
+	int Compare(const CollationKey &other) const;
+
+	bool operator==(const CollationKey &) const = default;
+
+private:
+	std::vector<uint8_t> m_key;
+};
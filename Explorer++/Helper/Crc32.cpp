@@ -0,0 +1,84 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "Crc32.h"
+#include <array>
+
+namespace
+{
+
+constexpr uint32_t POLYNOMIAL = 0xEDB88320;
+
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+// The tables used to process 8 bytes at a time (the "slicing-by-8" method). tables[0] is the
+// standard byte-at-a-time table, while tables[n] gives the effect of a byte followed by n zero
+// bytes.
+constexpr CrcTables GenerateTables()
+{
+	CrcTables tables = {};
+
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+
+		for (int j = 0; j < 8; j++)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ POLYNOMIAL) : (crc >> 1);
+		}
+
+		tables[0][i] = crc;
+	}
+
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		for (size_t j = 1; j < tables.size(); j++)
+		{
+			uint32_t previous = tables[j - 1][i];
+			tables[j][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+		}
+	}
+
+	return tables;
+}
+
+constexpr CrcTables TABLES = GenerateTables();
+
+uint32_t LoadLittleEndian32(const std::byte *data)
+{
+	return std::to_integer<uint32_t>(data[0]) | (std::to_integer<uint32_t>(data[1]) << 8)
+		| (std::to_integer<uint32_t>(data[2]) << 16) | (std::to_integer<uint32_t>(data[3]) << 24);
+}
+
+}
+
+void Crc32::Update(std::span<const std::byte> data)
+{
+	uint32_t crc = m_crc;
+
+	while (data.size() >= 8)
+	{
+		uint32_t low = crc ^ LoadLittleEndian32(data.data());
+		uint32_t high = LoadLittleEndian32(data.data() + 4);
+
+		crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^ TABLES[5][(low >> 16) & 0xFF]
+			^ TABLES[4][low >> 24] ^ TABLES[3][high & 0xFF] ^ TABLES[2][(high >> 8) & 0xFF]
+			^ TABLES[1][(high >> 16) & 0xFF] ^ TABLES[0][high >> 24];
+
+		data = data.subspan(8);
+	}
+
+	for (auto byte : data)
+	{
+		crc = (crc >> 8) ^ TABLES[0][(crc ^ std::to_integer<uint32_t>(byte)) & 0xFF];
+	}
+
+	m_crc = crc;
+}
+
+uint32_t Crc32::GetValue() const
+{
+	return m_crc ^ 0xFFFFFFFF;
+}
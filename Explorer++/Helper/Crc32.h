@@ -0,0 +1,21 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Calculates the CRC-32 (as used by zip, PNG and SFV files) of a stream of data, which can be
+// supplied in pieces of any size.
+class Crc32
+{
+public:
+	void Update(std::span<const std::byte> data);
+	uint32_t GetValue() const;
+
+private:
+	uint32_t m_crc = 0xFFFFFFFF;
+};
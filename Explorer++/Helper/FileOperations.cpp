@@ -4,18 +4,21 @@
 
 #include "stdafx.h"
 #include "FileOperations.h"
+#include "BackgroundWorkPool.h"
 #include "DragDropHelper.h"
 #include "DriveInfo.h"
+#include "FileStreams.h"
 #include "Helper.h"
 #include "ShellHelper.h"
 #include "StringHelper.h"
 #include <wil/com.h>
+#include <wil/resource.h>
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <list>
 #include <sstream>
 
-BOOL GetFileClusterSize(const std::wstring &strFilename, PLARGE_INTEGER lpRealFileSize);
-
 HRESULT FileOperations::RenameFile(IShellItem *item, const std::wstring &newName)
 {
 	wil::com_ptr_nothrow<IFileOperation> fo;
@@ -510,141 +513,219 @@ BOOL FileOperations::CreateBrowseDialog(HWND hOwner, const std::wstring &strTitl
 	return bSuccessful;
 }
 
-BOOL GetFileClusterSize(const std::wstring &strFilename, PLARGE_INTEGER lpRealFileSize)
+namespace
 {
-	DWORD dwClusterSize;
 
-	LARGE_INTEGER lFileSize;
-	BOOL bRet = GetFileSizeEx(strFilename.c_str(), &lFileSize);
+constexpr size_t MAX_SECURE_DELETE_WORKERS = 4;
 
-	if (!bRet)
-	{
-		return FALSE;
-	}
+struct SecureDeleteItem
+{
+	std::wstring path;
+	uint64_t size;
+};
 
-	TCHAR szRoot[MAX_PATH];
-	HRESULT hr = StringCchCopy(szRoot, std::size(szRoot), strFilename.c_str());
+// Returns the size of the file rounded up to the end of its last cluster, since the whole of the
+// last cluster may contain data from the file.
+std::optional<uint64_t> GetClusterAlignedSize(const std::wstring &path, uint64_t size)
+{
+	TCHAR root[MAX_PATH];
+	HRESULT hr = StringCchCopy(root, std::size(root), path.c_str());
 
 	if (FAILED(hr))
 	{
-		return FALSE;
+		return std::nullopt;
 	}
 
-	bRet = PathStripToRoot(szRoot);
-
-	if (!bRet)
+	if (!PathStripToRoot(root))
 	{
-		return FALSE;
+		return std::nullopt;
 	}
 
-	bRet = GetClusterSize(szRoot, &dwClusterSize);
+	DWORD clusterSize;
 
-	if (!bRet)
+	if (!GetClusterSize(root, &clusterSize) || clusterSize == 0)
 	{
-		return FALSE;
+		return std::nullopt;
 	}
 
-	if ((lFileSize.QuadPart % dwClusterSize) != 0)
+	if ((size % clusterSize) != 0)
 	{
-		/* The real size is the logical file size rounded up to the end of the
-		nearest cluster. */
-		lFileSize.QuadPart += dwClusterSize - (lFileSize.QuadPart % dwClusterSize);
+		size += clusterSize - (size % clusterSize);
 	}
 
-	*lpRealFileSize = lFileSize;
-
-	return TRUE;
+	return size;
 }
 
-void FileOperations::DeleteFileSecurely(const std::wstring &strFilename,
-	OverwriteMethod overwriteMethod)
+std::optional<ChaCha20::Key> GenerateRandomKey()
 {
-	HANDLE hFile;
-	WIN32_FIND_DATA wfd;
-	HANDLE hFindFile;
-	HCRYPTPROV hProv;
-	LARGE_INTEGER lRealFileSize;
-	BYTE pass1Data;
-	BYTE pass2Data;
-	BYTE pass3Data;
-	DWORD nBytesWritten;
-	BOOL bFolder;
-	int i = 0;
-
-	hFindFile = FindFirstFile(strFilename.c_str(), &wfd);
+	wil::unique_hcryptprov provider;
+	BOOL res = CryptAcquireContext(&provider, nullptr, nullptr, PROV_RSA_AES, CRYPT_VERIFYCONTEXT);
 
-	if (hFindFile == INVALID_HANDLE_VALUE)
+	if (!res)
 	{
-		return;
+		return std::nullopt;
 	}
 
-	bFolder = (wfd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY;
+	ChaCha20::Key key;
+	res = CryptGenRandom(provider.get(), static_cast<DWORD>(key.size()),
+		reinterpret_cast<BYTE *>(key.data()));
 
-	FindClose(hFindFile);
+	if (!res)
+	{
+		return std::nullopt;
+	}
 
-	if (bFolder)
+	return key;
+}
+
+std::vector<OverwritePass> GetOverwritePasses(FileOperations::OverwriteMethod overwriteMethod)
+{
+	switch (overwriteMethod)
 	{
-		return;
+	case FileOperations::OverwriteMethod::OnePass:
+		return { { OverwritePass::Type::Pattern, std::byte{ 0x00 } } };
+
+	case FileOperations::OverwriteMethod::ThreePass:
+		return { { OverwritePass::Type::Pattern, std::byte{ 0x00 } },
+			{ OverwritePass::Type::Pattern, std::byte{ 0xFF } }, { OverwritePass::Type::Random } };
+
+	default:
+		LOG(FATAL) << "Invalid OverwriteMethod value";
 	}
+}
 
-	/* Determine the actual size of the file on disk
-	(i.e. how many clusters it is allocated). */
-	GetFileClusterSize(strFilename, &lRealFileSize);
+bool DeleteItemSecurely(const SecureDeleteItem &item, SecureOverwriter &overwriter,
+	std::span<const OverwritePass> passes, SecureOverwriter::ProgressCallback progressCallback,
+	std::stop_token stopToken)
+{
+	// Checked here, as well as by the overwriter, so that empty files aren't deleted once a stop
+	// has been requested.
+	if (stopToken.stop_requested())
+	{
+		return false;
+	}
 
-	/* Open the file, block any sharing mode, to stop the file
-	been opened while it is overwritten. */
-	hFile =
-		CreateFile(strFilename.c_str(), FILE_WRITE_DATA, 0, nullptr, OPEN_EXISTING, NULL, nullptr);
+	auto file = FileOverwriter::Open(item.path);
 
-	if (hFile == INVALID_HANDLE_VALUE)
+	if (!file)
 	{
-		return;
+		return false;
 	}
 
-	/* Extend the file out to the end of its last sector. */
-	SetFilePointerEx(hFile, lRealFileSize, nullptr, FILE_BEGIN);
-	SetEndOfFile(hFile);
+	// Extend the file out to the end of its last cluster.
+	if (!file->SetSize(item.size))
+	{
+		return false;
+	}
 
-	/* Start at the beginning of the file, and
-	write in the first-pass data, 0x00 over
-	the length of the whole file. */
-	SetFilePointer(hFile, 0, nullptr, FILE_BEGIN);
-	pass1Data = 0x00;
+	auto status = overwriter.Overwrite(*file, item.size, passes, progressCallback, stopToken);
 
-	for (i = 0; i < lRealFileSize.QuadPart; i++)
+	if (status != SecureOverwriter::Status::Succeeded)
 	{
-		WriteFile(hFile, (LPVOID) &pass1Data, 1, &nBytesWritten, nullptr);
+		return false;
 	}
 
-	if (overwriteMethod == OverwriteMethod::ThreePass)
+	file.reset();
+
+	return DeleteFile(item.path.c_str());
+}
+
+}
+
+size_t FileOperations::DeleteFilesSecurely(const std::vector<std::wstring> &paths,
+	OverwriteMethod overwriteMethod, BackgroundWorkPool *workPool,
+	SecureDeleteProgressCallback progressCallback, std::stop_token stopToken)
+{
+	auto passes = GetOverwritePasses(overwriteMethod);
+
+	std::vector<SecureDeleteItem> items;
+	uint64_t totalSize = 0;
+	size_t numFailed = 0;
+
+	for (const auto &path : paths)
 	{
-		/* Start at the beginning of the file, and
-		write in the second-pass data, 0xFF over
-		the length of the whole file. */
-		SetFilePointer(hFile, 0, nullptr, FILE_BEGIN);
-		pass2Data = 0xFF;
+		WIN32_FILE_ATTRIBUTE_DATA attributeData;
+
+		if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &attributeData))
+		{
+			numFailed++;
+			continue;
+		}
+
+		// Folders are skipped.
+		if (WI_IsFlagSet(attributeData.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY))
+		{
+			continue;
+		}
+
+		ULARGE_INTEGER fileSize = { { attributeData.nFileSizeLow, attributeData.nFileSizeHigh } };
+		auto alignedSize = GetClusterAlignedSize(path, fileSize.QuadPart);
 
-		for (i = 0; i < lRealFileSize.QuadPart; i++)
+		if (!alignedSize)
 		{
-			WriteFile(hFile, (LPVOID) &pass2Data, 1, &nBytesWritten, nullptr);
+			numFailed++;
+			continue;
 		}
 
-		SetFilePointer(hFile, 0, nullptr, FILE_BEGIN);
+		items.push_back({ path, *alignedSize });
+		totalSize += *alignedSize * passes.size();
+	}
 
-		CryptAcquireContext(&hProv, _T("SecureDelete"), nullptr, PROV_RSA_AES, CRYPT_NEWKEYSET);
+	// Each file is handled entirely by one worker, with several files being processed at once.
+	// Each worker has its own overwriter, seeded with a separate random key.
+	size_t numWorkers = std::min(items.size(), MAX_SECURE_DELETE_WORKERS);
+	std::vector<ChaCha20::Key> keys;
 
-		for (i = 0; i < lRealFileSize.QuadPart; i++)
+	for (size_t i = 0; i < numWorkers; i++)
+	{
+		auto key = GenerateRandomKey();
+
+		if (!key)
 		{
-			CryptGenRandom(hProv, 1, (LPBYTE) &pass3Data);
-			WriteFile(hFile, (LPVOID) &pass3Data, 1, &nBytesWritten, nullptr);
+			return numFailed + items.size();
 		}
 
-		CryptAcquireContext(&hProv, _T("SecureDelete"), nullptr, PROV_RSA_AES, CRYPT_DELETEKEYSET);
+		keys.push_back(*key);
 	}
 
-	FlushFileBuffers(hFile);
+	std::atomic<size_t> nextItemIndex = 0;
+	std::atomic<size_t> numItemsFailed = 0;
+	std::atomic<uint64_t> totalBytesWritten = 0;
+
+	auto itemProgressCallback = [&totalBytesWritten, totalSize,
+									&progressCallback](uint64_t numBytesWritten)
+	{
+		uint64_t updatedBytesWritten = totalBytesWritten += numBytesWritten;
+
+		if (progressCallback)
+		{
+			progressCallback(updatedBytesWritten, totalSize);
+		}
+	};
+
+	auto worker = [&items, &passes, &nextItemIndex, &numItemsFailed, &itemProgressCallback,
+					  stopToken](const ChaCha20::Key &key)
+	{
+		SecureOverwriter overwriter(key);
+
+		for (size_t index = nextItemIndex++; index < items.size(); index = nextItemIndex++)
+		{
+			if (!DeleteItemSecurely(items[index], overwriter, passes, itemProgressCallback,
+					stopToken))
+			{
+				numItemsFailed++;
+			}
+		}
+	};
+
+	std::vector<std::function<void()>> workers;
+
+	for (const auto &key : keys)
+	{
+		workers.emplace_back([&worker, &key] { worker(key); });
+	}
 
-	CloseHandle(hFile);
+	RunConcurrently(workPool, workers);
 
-	DeleteFile(strFilename.c_str());
+	return numFailed + numItemsFailed;
 }
@@ -5,9 +5,14 @@
 #pragma once
 
 #include "PidlHelper.h"
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <stop_token>
 #include <vector>
 
+class BackgroundWorkPool;
+
 namespace FileOperations
 {
 
@@ -17,10 +22,24 @@ enum class OverwriteMethod
 	ThreePass = 2
 };
 
+// Called as files are overwritten, with the number of bytes written so far and the total number of
+// bytes that will be written, across all files and passes. May be called concurrently from
+// multiple threads.
+using SecureDeleteProgressCallback =
+	std::function<void(uint64_t numBytesWritten, uint64_t totalBytes)>;
+
 HRESULT RenameFile(IShellItem *item, const std::wstring &newName);
 HRESULT DeleteFiles(HWND hwnd, const std::vector<PCIDLIST_ABSOLUTE> &pidls, bool permanent,
 	bool silent);
-void DeleteFileSecurely(const std::wstring &strFilename, OverwriteMethod overwriteMethod);
+
+// Overwrites each of the specified files using the given method, then deletes it. Several files
+// are processed at once, using tasks on the shared work pool, along with the calling thread.
+// Folders are skipped. If a stop is requested, any files that haven't been completely overwritten
+// are left in place. Returns the number of files that couldn't be deleted.
+size_t DeleteFilesSecurely(const std::vector<std::wstring> &paths, OverwriteMethod overwriteMethod,
+	BackgroundWorkPool *workPool, SecureDeleteProgressCallback progressCallback = nullptr,
+	std::stop_token stopToken = {});
+
 HRESULT CopyFilesToFolder(HWND hOwner, const std::wstring &strTitle,
 	std::vector<PCIDLIST_ABSOLUTE> &pidls, bool move);
 HRESULT CopyFiles(HWND hwnd, IShellItem *destinationFolder, std::vector<PCIDLIST_ABSOLUTE> &pidls,
@@ -0,0 +1,359 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FileSearcher.h"
+#include "BackgroundWorkPool.h"
+#include <glog/logging.h>
+#include <wil/common.h>
+#include <wil/resource.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+class FileSearcher::Run
+{
+public:
+	Run(const FileSearcher *searcher, BatchCallback batchCallback, std::stop_token stopToken);
+
+	std::optional<Summary> Start(const std::wstring &directory);
+
+private:
+	void RunWorker();
+	void PushFolders(std::vector<std::wstring> folders);
+	void SearchFolder(const std::wstring &folder);
+	void SetCurrentFolder(const std::wstring &folder);
+	void AddMatches(std::vector<std::wstring> paths);
+	void MaybeDeliverBatches(bool force);
+
+	const FileSearcher *const m_searcher;
+	const BatchCallback m_batchCallback;
+	const std::stop_token m_stopToken;
+
+	// Folders are taken from the back of the queue, which keeps the search roughly depth-first and
+	// so limits the size of the queue.
+	std::mutex m_queueMutex;
+	std::condition_variable_any m_queueCondition;
+	std::vector<std::wstring> m_queue;
+
+	// The number of folders that have been queued, but not yet searched. Once this reaches 0, the
+	// search is complete. Guarded by m_queueMutex.
+	size_t m_numPendingFolders = 0;
+
+	std::mutex m_batchMutex;
+	Batch m_pendingBatch;
+	std::chrono::steady_clock::time_point m_lastDeliveryTime;
+
+	// Held while a batch is being taken and delivered, so that batches are delivered one at a time
+	// and in order.
+	std::mutex m_deliveryMutex;
+
+	std::atomic<int> m_numFoldersFound = 0;
+	std::atomic<int> m_numFilesFound = 0;
+};
+
+FileSearcher::Run::Run(const FileSearcher *searcher, BatchCallback batchCallback,
+	std::stop_token stopToken) :
+	m_searcher(searcher),
+	m_batchCallback(std::move(batchCallback)),
+	m_stopToken(stopToken),
+	m_lastDeliveryTime(std::chrono::steady_clock::now())
+{
+}
+
+std::optional<FileSearcher::Summary> FileSearcher::Run::Start(const std::wstring &directory)
+{
+	PushFolders({ directory });
+
+	// A worker that starts after the search has finished returns straight away, so it doesn't
+	// matter how long a task spends waiting in the pool's queue.
+	std::vector<std::function<void()>> workers(m_searcher->m_numWorkers,
+		std::bind_front(&Run::RunWorker, this));
+	RunConcurrently(m_searcher->m_workPool, workers);
+
+	// Any matches that were found are delivered, even if the search was stopped.
+	MaybeDeliverBatches(true);
+
+	if (m_stopToken.stop_requested())
+	{
+		return std::nullopt;
+	}
+
+	return Summary{ m_numFoldersFound, m_numFilesFound };
+}
+
+void FileSearcher::Run::RunWorker()
+{
+	while (true)
+	{
+		std::wstring folder;
+
+		{
+			std::unique_lock lock(m_queueMutex);
+			m_queueCondition.wait(lock, m_stopToken,
+				[this] { return !m_queue.empty() || m_numPendingFolders == 0; });
+
+			if (m_stopToken.stop_requested() || m_queue.empty())
+			{
+				return;
+			}
+
+			folder = std::move(m_queue.back());
+			m_queue.pop_back();
+		}
+
+		SearchFolder(folder);
+		MaybeDeliverBatches(false);
+
+		std::scoped_lock lock(m_queueMutex);
+
+		if (--m_numPendingFolders == 0)
+		{
+			m_queueCondition.notify_all();
+		}
+	}
+}
+
+void FileSearcher::Run::PushFolders(std::vector<std::wstring> folders)
+{
+	if (folders.empty())
+	{
+		return;
+	}
+
+	{
+		std::scoped_lock lock(m_queueMutex);
+		m_numPendingFolders += folders.size();
+		m_queue.insert(m_queue.end(), std::make_move_iterator(folders.begin()),
+			std::make_move_iterator(folders.end()));
+	}
+
+	m_queueCondition.notify_all();
+}
+
+void FileSearcher::Run::SearchFolder(const std::wstring &folder)
+{
+	SetCurrentFolder(folder);
+
+	std::wstring folderPrefix = folder;
+
+	if (!folderPrefix.empty() && folderPrefix.back() != '\\')
+	{
+		folderPrefix += '\\';
+	}
+
+	WIN32_FIND_DATA findData;
+
+	// The short name isn't needed, so FindExInfoBasic is used to avoid having it retrieved.
+	wil::unique_hfind findHandle(FindFirstFileEx((folderPrefix + L"*").c_str(), FindExInfoBasic,
+		&findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH));
+
+	if (!findHandle)
+	{
+		return;
+	}
+
+	std::vector<std::wstring> matches;
+	std::vector<std::wstring> subfolders;
+
+	do
+	{
+		if (m_stopToken.stop_requested())
+		{
+			return;
+		}
+
+		std::wstring_view name = findData.cFileName;
+
+		if (name == L"." || name == L"..")
+		{
+			continue;
+		}
+
+		bool isFolder = WI_IsFlagSet(findData.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY);
+
+		if (m_searcher->Matches(findData))
+		{
+			matches.push_back(folderPrefix + findData.cFileName);
+
+			if (isFolder)
+			{
+				m_numFoldersFound++;
+			}
+			else
+			{
+				m_numFilesFound++;
+			}
+		}
+
+		// Folders that are reparse points (e.g. junctions and symbolic links) aren't entered, since
+		// they could otherwise result in the same folder being searched multiple times, or in a
+		// cycle.
+		if (isFolder && m_searcher->m_searchSubfolders
+			&& WI_IsFlagClear(findData.dwFileAttributes, FILE_ATTRIBUTE_REPARSE_POINT))
+		{
+			subfolders.push_back(folderPrefix + findData.cFileName);
+		}
+	} while (FindNextFile(findHandle.get(), &findData));
+
+	AddMatches(std::move(matches));
+	PushFolders(std::move(subfolders));
+}
+
+void FileSearcher::Run::SetCurrentFolder(const std::wstring &folder)
+{
+	std::scoped_lock lock(m_batchMutex);
+	m_pendingBatch.currentFolder = folder;
+}
+
+void FileSearcher::Run::AddMatches(std::vector<std::wstring> paths)
+{
+	if (paths.empty())
+	{
+		return;
+	}
+
+	std::scoped_lock lock(m_batchMutex);
+	m_pendingBatch.paths.insert(m_pendingBatch.paths.end(),
+		std::make_move_iterator(paths.begin()), std::make_move_iterator(paths.end()));
+}
+
+// A batch is delivered once the batch interval has passed since the previous delivery, or once
+// enough matches have been found to fill a batch. If another worker is already delivering a batch,
+// there's no need to wait for it, as it will be picked up the next time a folder is completed.
+void FileSearcher::Run::MaybeDeliverBatches(bool force)
+{
+	std::unique_lock deliveryLock(m_deliveryMutex, std::defer_lock);
+
+	if (force)
+	{
+		deliveryLock.lock();
+	}
+	else if (!deliveryLock.try_lock())
+	{
+		return;
+	}
+
+	while (true)
+	{
+		Batch batch;
+
+		{
+			std::scoped_lock lock(m_batchMutex);
+
+			auto now = std::chrono::steady_clock::now();
+			bool batchFull = m_pendingBatch.paths.size() >= m_searcher->m_maxBatchSize;
+			bool intervalElapsed = now - m_lastDeliveryTime >= m_searcher->m_batchInterval;
+
+			if (!batchFull && !intervalElapsed && !force)
+			{
+				return;
+			}
+
+			if (m_pendingBatch.paths.size() <= m_searcher->m_maxBatchSize)
+			{
+				batch.paths = std::exchange(m_pendingBatch.paths, {});
+			}
+			else
+			{
+				auto end = m_pendingBatch.paths.begin()
+					+ static_cast<std::ptrdiff_t>(m_searcher->m_maxBatchSize);
+				batch.paths.assign(std::make_move_iterator(m_pendingBatch.paths.begin()),
+					std::make_move_iterator(end));
+				m_pendingBatch.paths.erase(m_pendingBatch.paths.begin(), end);
+			}
+
+			batch.currentFolder = m_pendingBatch.currentFolder;
+			m_lastDeliveryTime = now;
+		}
+
+		m_batchCallback(std::move(batch));
+
+		std::scoped_lock lock(m_batchMutex);
+
+		// A forced delivery drains every match, while other deliveries only continue for as long
+		// as there are enough matches left to fill a batch.
+		if (m_pendingBatch.paths.empty()
+			|| (!force && m_pendingBatch.paths.size() < m_searcher->m_maxBatchSize))
+		{
+			return;
+		}
+	}
+}
+
+FileSearcher::FileSearcher(const Criteria &criteria, BackgroundWorkPool *workPool,
+	unsigned int numWorkers, std::chrono::milliseconds batchInterval, size_t maxBatchSize) :
+	m_matchAllNames(criteria.pattern.empty()),
+	m_requiredAttributes(criteria.requiredAttributes),
+	m_searchSubfolders(criteria.searchSubfolders),
+	m_workPool(workPool),
+	m_numWorkers(numWorkers),
+	m_batchInterval(batchInterval),
+	m_maxBatchSize(maxBatchSize)
+{
+	CHECK_GT(numWorkers, 0u);
+	CHECK_GT(maxBatchSize, 0u);
+
+	if (m_matchAllNames)
+	{
+		return;
+	}
+
+	switch (criteria.syntax)
+	{
+	case PatternSyntax::Wildcard:
+		m_wildcardPattern.emplace(criteria.pattern, criteria.caseSensitive);
+		break;
+
+	// Boost.Regex uses the same (Perl-derived) syntax as std::regex's default ECMAScript grammar,
+	// but matches considerably faster.
+	case PatternSyntax::RegularExpression:
+	{
+		boost::regex_constants::syntax_option_type flags = boost::regex::perl;
+
+		if (!criteria.caseSensitive)
+		{
+			flags |= boost::regex::icase;
+		}
+
+		m_regex.emplace(criteria.pattern, flags);
+	}
+	break;
+
+	default:
+		LOG(FATAL) << "Invalid PatternSyntax value";
+	}
+}
+
+bool FileSearcher::Matches(const WIN32_FIND_DATA &findData) const
+{
+	if ((findData.dwFileAttributes & m_requiredAttributes) != m_requiredAttributes)
+	{
+		return false;
+	}
+
+	return MatchesName(findData.cFileName);
+}
+
+bool FileSearcher::MatchesName(std::wstring_view name) const
+{
+	if (m_matchAllNames)
+	{
+		return true;
+	}
+
+	if (m_regex)
+	{
+		return boost::regex_match(name.begin(), name.end(), *m_regex);
+	}
+
+	return m_wildcardPattern->Matches(name);
+}
+
+std::optional<FileSearcher::Summary> FileSearcher::Search(const std::wstring &directory,
+	BatchCallback batchCallback, std::stop_token stopToken) const
+{
+	Run run(this, std::move(batchCallback), stopToken);
+	return run.Start(directory);
+}
@@ -0,0 +1,108 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "WildcardPattern.h"
+#include <boost/regex.hpp>
+#include <windows.h>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class BackgroundWorkPool;
+
+// Searches a folder tree for items whose name and attributes match a set of criteria.
+//
+// The folders to be searched are placed in a shared queue, which is consumed by several workers at
+// once. The workers run as tasks on the shared background work pool, with the calling thread acting
+// as one of them. The pattern is compiled once, when the searcher is constructed, and the
+// attributes of each item are checked before its name, since that check is cheaper. Matches aren't
+// reported individually; instead, they're collected and delivered in batches, once the batch
+// interval has passed or the batch has reached its maximum size, whichever comes first.
+//
+// This class doesn't depend on any UI, so the batch callback is responsible for passing results to
+// whichever thread needs them.
+class FileSearcher
+{
+public:
+	enum class PatternSyntax
+	{
+		Wildcard,
+		RegularExpression
+	};
+
+	struct Criteria
+	{
+		// An empty pattern matches every item.
+		std::wstring pattern;
+		PatternSyntax syntax = PatternSyntax::Wildcard;
+		bool caseSensitive = false;
+
+		// An item only matches if every one of these attributes is set.
+		DWORD requiredAttributes = 0;
+
+		bool searchSubfolders = true;
+	};
+
+	struct Batch
+	{
+		// The full paths of the items that were matched.
+		std::vector<std::wstring> paths;
+
+		// The folder that was most recently entered, which can be used to show progress. A batch
+		// can be delivered without any matches, so that this is updated regularly.
+		std::wstring currentFolder;
+	};
+
+	struct Summary
+	{
+		int numFoldersFound;
+		int numFilesFound;
+	};
+
+	// Batches are delivered on the threads performing the search, though the callback will never
+	// be invoked concurrently.
+	using BatchCallback = std::function<void(Batch batch)>;
+
+	static constexpr unsigned int DEFAULT_NUM_WORKERS = 4;
+	static constexpr std::chrono::milliseconds DEFAULT_BATCH_INTERVAL{ 50 };
+	static constexpr size_t DEFAULT_MAX_BATCH_SIZE = 1000;
+
+	// Throws boost::regex_error if the syntax is RegularExpression and the pattern isn't a valid
+	// regular expression.
+	FileSearcher(const Criteria &criteria, BackgroundWorkPool *workPool,
+		unsigned int numWorkers = DEFAULT_NUM_WORKERS,
+		std::chrono::milliseconds batchInterval = DEFAULT_BATCH_INTERVAL,
+		size_t maxBatchSize = DEFAULT_MAX_BATCH_SIZE);
+
+	bool Matches(const WIN32_FIND_DATA &findData) const;
+
+	// The calling thread takes part in the search, so at most numWorkers - 1 tasks are queued on
+	// the pool. If the pool is busy, the calling thread may end up performing the whole search.
+	// Folders that can't be accessed are skipped. Every batch is delivered before this returns.
+	// Returns std::nullopt if a stop is requested before the search finishes.
+	std::optional<Summary> Search(const std::wstring &directory, BatchCallback batchCallback,
+		std::stop_token stopToken = {}) const;
+
+private:
+	class Run;
+
+	bool MatchesName(std::wstring_view name) const;
+
+	const bool m_matchAllNames;
+	std::optional<WildcardPattern> m_wildcardPattern;
+	std::optional<boost::wregex> m_regex;
+	const DWORD m_requiredAttributes;
+	const bool m_searchSubfolders;
+
+	BackgroundWorkPool *const m_workPool;
+	const unsigned int m_numWorkers;
+	const std::chrono::milliseconds m_batchInterval;
+	const size_t m_maxBatchSize;
+};
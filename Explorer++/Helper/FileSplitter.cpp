@@ -0,0 +1,233 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FileSplitter.h"
+#include "BackgroundWorkPool.h"
+#include "Crc32.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <limits>
+
+// Presents a single part of the input as a source. The parts within a run are read one after
+// another from the same input, so each part simply carries on from where the previous one ended.
+class FileSplitter::PartSource : public ReadAheadPipeline::Source
+{
+public:
+	PartSource(ReadAheadPipeline::Source &input, uint64_t size) : m_input(input), m_remaining(size)
+	{
+	}
+
+	std::optional<size_t> Read(std::span<std::byte> buffer) override
+	{
+		if (m_remaining == 0)
+		{
+			return 0;
+		}
+
+		auto readSize = static_cast<size_t>(std::min<uint64_t>(buffer.size(), m_remaining));
+		auto numBytesRead = m_input.Read(buffer.first(readSize));
+
+		// If the input ends before the part is complete, the input is smaller than it was expected
+		// to be, which is treated as a failure.
+		if (!numBytesRead || *numBytesRead == 0)
+		{
+			return std::nullopt;
+		}
+
+		m_remaining -= *numBytesRead;
+
+		return numBytesRead;
+	}
+
+private:
+	ReadAheadPipeline::Source &m_input;
+	uint64_t m_remaining;
+};
+
+FileSplitter::FileSplitter(BackgroundWorkPool *workPool, unsigned int numWriters,
+	size_t bufferSize, size_t numBuffers) :
+	m_workPool(workPool)
+{
+	CHECK_GT(numWriters, 0u);
+
+	for (unsigned int i = 0; i < numWriters; i++)
+	{
+		m_pipelines.push_back(std::make_unique<ReadAheadPipeline>(bufferSize, numBuffers));
+	}
+}
+
+uint64_t FileSplitter::GetNumParts(uint64_t inputSize, uint64_t partSize)
+{
+	CHECK_GT(partSize, 0u);
+
+	return (inputSize / partSize) + ((inputSize % partSize != 0) ? 1 : 0);
+}
+
+FileSplitter::Result FileSplitter::Run(uint64_t inputSize, uint64_t partSize,
+	bool computeChecksums, InputFactory inputFactory, SinkFactory sinkFactory,
+	PartFinishedCallback partFinishedCallback, std::stop_token stopToken)
+{
+	uint64_t numParts = GetNumParts(inputSize, partSize);
+	CHECK_LE(numParts, std::numeric_limits<size_t>::max());
+
+	Result result = { Status::Succeeded, 0, {} };
+
+	if (computeChecksums)
+	{
+		result.checksums.resize(static_cast<size_t>(numParts));
+	}
+
+	size_t numRuns = static_cast<size_t>(std::min<uint64_t>(m_pipelines.size(), numParts));
+	std::vector<RunResult> runResults(numRuns);
+
+	// A failure in any one run stops the others, as does a stop request from the caller.
+	std::stop_source stopSource;
+	std::stop_callback stopCallback(stopToken, [&stopSource] { stopSource.request_stop(); });
+
+	std::vector<std::function<void()>> runs;
+
+	for (size_t i = 0; i < numRuns; i++)
+	{
+		auto firstPart = static_cast<size_t>(numParts * i / numRuns);
+		auto lastPart = static_cast<size_t>(numParts * (i + 1) / numRuns);
+
+		runs.emplace_back(
+			[&, i, firstPart, lastPart]
+			{
+				runResults[i] = SplitRun(*m_pipelines[i], firstPart, lastPart, inputSize, partSize,
+					computeChecksums ? &result.checksums : nullptr, inputFactory, sinkFactory,
+					partFinishedCallback, stopSource.get_token());
+
+				if (runResults[i].status != Status::Succeeded)
+				{
+					stopSource.request_stop();
+				}
+			});
+	}
+
+	RunConcurrently(m_workPool, runs);
+
+	// A run that was stopped because another run failed will report that it was cancelled, so
+	// failures take precedence.
+	bool cancelled = false;
+
+	for (const auto &runResult : runResults)
+	{
+		if (runResult.status == Status::ReadFailed || runResult.status == Status::WriteFailed)
+		{
+			return { runResult.status, runResult.partIndex, {} };
+		}
+
+		if (runResult.status == Status::Cancelled)
+		{
+			cancelled = true;
+		}
+	}
+
+	if (cancelled)
+	{
+		return { Status::Cancelled, 0, {} };
+	}
+
+	return result;
+}
+
+// Copies the parts in the range [firstPart, lastPart).
+FileSplitter::RunResult FileSplitter::SplitRun(ReadAheadPipeline &pipeline, size_t firstPart,
+	size_t lastPart, uint64_t inputSize, uint64_t partSize, std::vector<uint32_t> *checksums,
+	const InputFactory &inputFactory, const SinkFactory &sinkFactory,
+	const PartFinishedCallback &partFinishedCallback, std::stop_token stopToken)
+{
+	auto input = inputFactory(static_cast<uint64_t>(firstPart) * partSize);
+
+	if (!input)
+	{
+		return { Status::ReadFailed, firstPart };
+	}
+
+	auto getPartSize = [inputSize, partSize](size_t partIndex)
+	{ return std::min(partSize, inputSize - static_cast<uint64_t>(partIndex) * partSize); };
+
+	std::unique_ptr<Sink> sink;
+	Crc32 crc;
+
+	auto openPart = [firstPart, &input, &getPartSize](
+						size_t index) -> std::unique_ptr<ReadAheadPipeline::Source>
+	{ return std::make_unique<PartSource>(*input, getPartSize(firstPart + index)); };
+
+	auto writeBlock = [firstPart, checksums, &sinkFactory, &getPartSize, &sink, &crc](size_t index,
+						  std::span<const std::byte> block)
+	{
+		if (!sink)
+		{
+			size_t partIndex = firstPart + index;
+			sink = sinkFactory(partIndex, getPartSize(partIndex));
+
+			if (!sink)
+			{
+				return false;
+			}
+		}
+
+		if (checksums)
+		{
+			crc.Update(block);
+		}
+
+		return sink->Write(block);
+	};
+
+	auto onPartFinished = [firstPart, checksums, &partFinishedCallback, &sink, &crc](size_t index)
+	{
+		// Parts are never empty and a part that ends early is treated as a read failure, so at
+		// least one block will have been written by this point.
+		CHECK(sink);
+
+		size_t partIndex = firstPart + index;
+
+		if (checksums)
+		{
+			(*checksums)[partIndex] = crc.GetValue();
+			crc = {};
+		}
+
+		sink.reset();
+
+		if (partFinishedCallback)
+		{
+			partFinishedCallback(partIndex);
+		}
+
+		return true;
+	};
+
+	auto pipelineResult =
+		pipeline.Run(lastPart - firstPart, openPart, writeBlock, onPartFinished, stopToken);
+
+	if (sink)
+	{
+		// The part that was being written when the run stopped is incomplete.
+		sink->Discard();
+	}
+
+	size_t partIndex = firstPart + pipelineResult.sourceIndex;
+
+	switch (pipelineResult.status)
+	{
+	case ReadAheadPipeline::Status::Succeeded:
+		return { Status::Succeeded, 0 };
+
+	case ReadAheadPipeline::Status::ProcessFailed:
+		return { Status::WriteFailed, partIndex };
+
+	case ReadAheadPipeline::Status::Cancelled:
+		return { Status::Cancelled, partIndex };
+
+	case ReadAheadPipeline::Status::OpenFailed:
+	case ReadAheadPipeline::Status::ReadFailed:
+	default:
+		return { Status::ReadFailed, partIndex };
+	}
+}
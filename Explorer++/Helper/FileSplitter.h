@@ -0,0 +1,108 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "ReadAheadPipeline.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+class BackgroundWorkPool;
+
+// Splits an input into consecutive parts of a fixed size (with the last part holding whatever
+// remains).
+//
+// The parts are divided into contiguous runs, one per writer. Each run is copied by a separate task
+// on the shared work pool (with the calling thread also taking part), through its own
+// ReadAheadPipeline, so several parts are written at once, while reading and writing within a run
+// overlap. Memory use is fixed by the number of writers and the size of each
+// pipeline's buffer pool; it doesn't depend on the size of the parts.
+//
+// A CRC-32 of each part can also be calculated as the part is copied, so that a checksum file can
+// be produced without having to read the parts back in.
+class FileSplitter
+{
+public:
+	// Receives the contents of a single part.
+	class Sink
+	{
+	public:
+		virtual ~Sink() = default;
+
+		virtual bool Write(std::span<const std::byte> data) = 0;
+
+		// Called if the part can't be written in its entirety.
+		virtual void Discard() = 0;
+	};
+
+	enum class Status
+	{
+		Succeeded,
+		ReadFailed,
+		WriteFailed,
+		Cancelled
+	};
+
+	struct Result
+	{
+		Status status;
+
+		// The index of the part that couldn't be read or written. Only meaningful if the status is
+		// Status::ReadFailed or Status::WriteFailed.
+		size_t partIndex;
+
+		// The CRC-32 of each part, indexed by part. Only filled in if checksums were requested and
+		// the split succeeded.
+		std::vector<uint32_t> checksums;
+	};
+
+	// Opens the input, positioned at the specified offset. Returns nullptr on failure. May be
+	// called from several threads at once.
+	using InputFactory =
+		std::function<std::unique_ptr<ReadAheadPipeline::Source>(uint64_t offset)>;
+
+	// Creates the sink for a part. Returns nullptr on failure. May be called from several threads
+	// at once.
+	using SinkFactory = std::function<std::unique_ptr<Sink>(size_t partIndex, uint64_t partSize)>;
+
+	// Called once a part has been written in its entirety. May be called from several threads at
+	// once.
+	using PartFinishedCallback = std::function<void(size_t partIndex)>;
+
+	static constexpr unsigned int DEFAULT_NUM_WRITERS = 4;
+
+	FileSplitter(BackgroundWorkPool *workPool, unsigned int numWriters = DEFAULT_NUM_WRITERS,
+		size_t bufferSize = ReadAheadPipeline::DEFAULT_BUFFER_SIZE,
+		size_t numBuffers = ReadAheadPipeline::DEFAULT_NUM_BUFFERS);
+
+	static uint64_t GetNumParts(uint64_t inputSize, uint64_t partSize);
+
+	// The input is expected to contain exactly inputSize bytes. If it ends early, the split fails
+	// with Status::ReadFailed.
+	Result Run(uint64_t inputSize, uint64_t partSize, bool computeChecksums,
+		InputFactory inputFactory, SinkFactory sinkFactory,
+		PartFinishedCallback partFinishedCallback = nullptr, std::stop_token stopToken = {});
+
+private:
+	class PartSource;
+
+	struct RunResult
+	{
+		Status status;
+		size_t partIndex;
+	};
+
+	RunResult SplitRun(ReadAheadPipeline &pipeline, size_t firstPart, size_t lastPart,
+		uint64_t inputSize, uint64_t partSize, std::vector<uint32_t> *checksums,
+		const InputFactory &inputFactory, const SinkFactory &sinkFactory,
+		const PartFinishedCallback &partFinishedCallback, std::stop_token stopToken);
+
+	BackgroundWorkPool *const m_workPool;
+	std::vector<std::unique_ptr<ReadAheadPipeline>> m_pipelines;
+};
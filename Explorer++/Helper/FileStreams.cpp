@@ -0,0 +1,200 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "FileStreams.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+
+// ReadFile and WriteFile take a 32-bit size, so large requests are split up.
+constexpr size_t MAX_IO_SIZE = 64 * 1024 * 1024;
+
+bool WriteAll(HANDLE file, std::span<const std::byte> data)
+{
+	while (!data.empty())
+	{
+		auto requestSize = static_cast<DWORD>(std::min(data.size(), MAX_IO_SIZE));
+
+		DWORD numBytesWritten;
+		BOOL res = WriteFile(file, data.data(), requestSize, &numBytesWritten, nullptr);
+
+		if (!res || numBytesWritten == 0)
+		{
+			return false;
+		}
+
+		data = data.subspan(numBytesWritten);
+	}
+
+	return true;
+}
+
+}
+
+std::unique_ptr<FileReader> FileReader::Open(const std::wstring &path, uint64_t offset)
+{
+	wil::unique_hfile file(CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	if (offset != 0)
+	{
+		if (offset > static_cast<uint64_t>(std::numeric_limits<LONGLONG>::max()))
+		{
+			return nullptr;
+		}
+
+		LARGE_INTEGER distance;
+		distance.QuadPart = static_cast<LONGLONG>(offset);
+
+		if (!SetFilePointerEx(file.get(), distance, nullptr, FILE_BEGIN))
+		{
+			return nullptr;
+		}
+	}
+
+	return std::unique_ptr<FileReader>(new FileReader(std::move(file)));
+}
+
+FileReader::FileReader(wil::unique_hfile file) : m_file(std::move(file))
+{
+}
+
+std::optional<size_t> FileReader::Read(std::span<std::byte> buffer)
+{
+	size_t totalBytesRead = 0;
+
+	// A single read can return fewer bytes than requested, so reads continue until the buffer is
+	// full or the end of the file is reached.
+	while (totalBytesRead < buffer.size())
+	{
+		auto remaining = buffer.subspan(totalBytesRead);
+		auto requestSize = static_cast<DWORD>(std::min(remaining.size(), MAX_IO_SIZE));
+
+		DWORD numBytesRead;
+		BOOL res = ReadFile(m_file.get(), remaining.data(), requestSize, &numBytesRead, nullptr);
+
+		if (!res)
+		{
+			return std::nullopt;
+		}
+
+		if (numBytesRead == 0)
+		{
+			break;
+		}
+
+		totalBytesRead += numBytesRead;
+	}
+
+	return totalBytesRead;
+}
+
+std::unique_ptr<FileWriter> FileWriter::Create(const std::wstring &path)
+{
+	wil::unique_hfile file(CreateFile(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<FileWriter>(new FileWriter(std::move(file), path));
+}
+
+FileWriter::FileWriter(wil::unique_hfile file, const std::wstring &path) :
+	m_file(std::move(file)),
+	m_path(path)
+{
+}
+
+bool FileWriter::Reserve(uint64_t size)
+{
+	if (size > static_cast<uint64_t>(std::numeric_limits<LONGLONG>::max()))
+	{
+		return false;
+	}
+
+	FILE_ALLOCATION_INFO allocationInfo;
+	allocationInfo.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+	return SetFileInformationByHandle(m_file.get(), FileAllocationInfo, &allocationInfo,
+		sizeof(allocationInfo));
+}
+
+bool FileWriter::Write(std::span<const std::byte> data)
+{
+	return WriteAll(m_file.get(), data);
+}
+
+void FileWriter::Discard()
+{
+	m_file.reset();
+	DeleteFile(m_path.c_str());
+}
+
+std::unique_ptr<FileOverwriter> FileOverwriter::Open(const std::wstring &path)
+{
+	wil::unique_hfile file(CreateFile(path.c_str(), FILE_READ_ATTRIBUTES | FILE_WRITE_DATA, 0,
+		nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<FileOverwriter>(new FileOverwriter(std::move(file)));
+}
+
+FileOverwriter::FileOverwriter(wil::unique_hfile file) : m_file(std::move(file))
+{
+}
+
+std::optional<uint64_t> FileOverwriter::GetSize() const
+{
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(m_file.get(), &size))
+	{
+		return std::nullopt;
+	}
+
+	return static_cast<uint64_t>(size.QuadPart);
+}
+
+bool FileOverwriter::SetSize(uint64_t size)
+{
+	if (size > static_cast<uint64_t>(std::numeric_limits<LONGLONG>::max()))
+	{
+		return false;
+	}
+
+	FILE_END_OF_FILE_INFO endOfFileInfo;
+	endOfFileInfo.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+	return SetFileInformationByHandle(m_file.get(), FileEndOfFileInfo, &endOfFileInfo,
+		sizeof(endOfFileInfo));
+}
+
+bool FileOverwriter::Rewind()
+{
+	LARGE_INTEGER distance = {};
+	return SetFilePointerEx(m_file.get(), distance, nullptr, FILE_BEGIN);
+}
+
+bool FileOverwriter::Write(std::span<const std::byte> data)
+{
+	return WriteAll(m_file.get(), data);
+}
+
+bool FileOverwriter::Flush()
+{
+	return FlushFileBuffers(m_file.get());
+}
@@ -0,0 +1,81 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "FileSplitter.h"
+#include "ReadAheadPipeline.h"
+#include "SecureOverwriter.h"
+#include <wil/resource.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+// Reads a file sequentially, from the specified offset to the end, for use as a ReadAheadPipeline
+// source.
+class FileReader : public ReadAheadPipeline::Source
+{
+public:
+	// Returns nullptr if the file can't be opened.
+	static std::unique_ptr<FileReader> Open(const std::wstring &path, uint64_t offset = 0);
+
+	std::optional<size_t> Read(std::span<std::byte> buffer) override;
+
+private:
+	explicit FileReader(wil::unique_hfile file);
+
+	const wil::unique_hfile m_file;
+};
+
+// Writes a file sequentially. The file is created when the writer is created and must not already
+// exist.
+class FileWriter : public FileSplitter::Sink
+{
+public:
+	// Returns nullptr if the file can't be created.
+	static std::unique_ptr<FileWriter> Create(const std::wstring &path);
+
+	// Reserves space for a file of the specified size, so that the file system can allocate the
+	// space in one go, rather than extending the file each time it's written to. The size of the
+	// file itself isn't changed, so a file that's only partially written won't contain a section
+	// of zeroes at the end.
+	bool Reserve(uint64_t size);
+
+	bool Write(std::span<const std::byte> data) override;
+
+	// Closes the file and then deletes it. Used when a file can't be written in its entirety.
+	void Discard() override;
+
+private:
+	FileWriter(wil::unique_hfile file, const std::wstring &path);
+
+	wil::unique_hfile m_file;
+	const std::wstring m_path;
+};
+
+// Overwrites an existing file in place, for use as a SecureOverwriter target. The file is opened
+// without sharing, so nothing else can read or write it while it's being overwritten.
+class FileOverwriter : public SecureOverwriter::Target
+{
+public:
+	// Returns nullptr if the file can't be opened.
+	static std::unique_ptr<FileOverwriter> Open(const std::wstring &path);
+
+	std::optional<uint64_t> GetSize() const;
+
+	// Sets the size of the file. This is used to extend the file, so that the slack space at the
+	// end of the last cluster is overwritten as well.
+	bool SetSize(uint64_t size);
+
+	bool Rewind() override;
+	bool Write(std::span<const std::byte> data) override;
+	bool Flush() override;
+
+private:
+	explicit FileOverwriter(wil::unique_hfile file);
+
+	const wil::unique_hfile m_file;
+};
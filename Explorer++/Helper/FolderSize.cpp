@@ -4,63 +4,400 @@
 
 #include "stdafx.h"
 #include "FolderSize.h"
-#include <filesystem>
+#include <glog/logging.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 
-FolderInfo GetFolderInfo(const std::wstring &path)
+class FolderSizeCalculator::Walk
 {
-	FolderInfo folderInfo = {};
+public:
+	Walk(FolderSizeCache *cache, unsigned int numThreads, std::stop_token stopToken);
+
+	std::optional<FolderInfo> Run(const std::filesystem::path &path);
+
+private:
+	struct Task
+	{
+		std::filesystem::path path;
+
+		// The last write time is known if the folder was found by enumerating its parent.
+		std::optional<std::filesystem::file_time_type> lastWriteTime;
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void RunWorker(size_t workerIndex);
+	std::optional<Task> PopTask(size_t workerIndex);
+	void PushTask(size_t workerIndex, Task task);
+	void ProcessFolder(size_t workerIndex, const Task &task);
+	void AddTotals(std::uintmax_t size, int numFiles, int numFolders);
+
+	FolderSizeCache *const m_cache;
+	const std::stop_token m_stopToken;
+
+	std::vector<WorkerQueue> m_queues;
+
+	// The number of tasks sitting in a queue.
+	std::atomic<size_t> m_numQueuedTasks = 0;
+
+	// The number of tasks that have been queued, but not yet completed. Once this reaches 0, the
+	// walk is complete.
+	std::atomic<size_t> m_numPendingTasks = 0;
+
+	std::mutex m_idleMutex;
+	std::condition_variable_any m_idleCondition;
+
+	std::atomic<std::uintmax_t> m_size = 0;
+	std::atomic<int> m_numFiles = 0;
+	std::atomic<int> m_numFolders = 0;
+};
+
+FolderSizeCalculator::Walk::Walk(FolderSizeCache *cache, unsigned int numThreads,
+	std::stop_token stopToken) :
+	m_cache(cache),
+	m_stopToken(stopToken),
+	m_queues(numThreads)
+{
+}
+
+std::optional<FolderInfo> FolderSizeCalculator::Walk::Run(const std::filesystem::path &path)
+{
+	PushTask(0, { path, std::nullopt });
+
+	{
+		std::vector<std::jthread> helperThreads;
+
+		for (size_t i = 1; i < m_queues.size(); i++)
+		{
+			helperThreads.emplace_back(&Walk::RunWorker, this, i);
+		}
+
+		RunWorker(0);
+	}
+
+	// A folder that was being enumerated when the stop was requested is abandoned part way through,
+	// but still counts as completed, so the number of pending tasks can't be used to determine
+	// whether the walk finished.
+	if (m_stopToken.stop_requested() || m_numPendingTasks > 0)
+	{
+		return std::nullopt;
+	}
+
+	return FolderInfo{ m_size, m_numFolders, m_numFiles };
+}
+
+void FolderSizeCalculator::Walk::RunWorker(size_t workerIndex)
+{
+	while (!m_stopToken.stop_requested())
+	{
+		auto task = PopTask(workerIndex);
+
+		if (!task)
+		{
+			std::unique_lock lock(m_idleMutex);
+			bool wakeUp = m_idleCondition.wait(lock, m_stopToken,
+				[this] { return m_numQueuedTasks > 0 || m_numPendingTasks == 0; });
+
+			if (!wakeUp || m_numPendingTasks == 0)
+			{
+				return;
+			}
+
+			continue;
+		}
+
+		ProcessFolder(workerIndex, *task);
+
+		if (--m_numPendingTasks == 0)
+		{
+			std::scoped_lock lock(m_idleMutex);
+			m_idleCondition.notify_all();
+		}
+	}
+}
+
+// Each thread takes the most recently added folder from its own queue, which keeps the walk
+// roughly depth-first and so limits the size of the queue. Folders are taken from the other end of
+// the other queues, since those are the folders least likely to be processed soon by the thread
+// that owns the queue.
+std::optional<FolderSizeCalculator::Walk::Task> FolderSizeCalculator::Walk::PopTask(
+	size_t workerIndex)
+{
+	{
+		auto &queue = m_queues[workerIndex];
+		std::scoped_lock lock(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			auto task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			m_numQueuedTasks--;
+			return task;
+		}
+	}
+
+	for (size_t i = 1; i < m_queues.size(); i++)
+	{
+		auto &queue = m_queues[(workerIndex + i) % m_queues.size()];
+		std::scoped_lock lock(queue.mutex);
+
+		if (!queue.tasks.empty())
+		{
+			auto task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			m_numQueuedTasks--;
+			return task;
+		}
+	}
+
+	return std::nullopt;
+}
+
+void FolderSizeCalculator::Walk::PushTask(size_t workerIndex, Task task)
+{
+	m_numPendingTasks++;
+
+	{
+		auto &queue = m_queues[workerIndex];
+		std::scoped_lock lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+		m_numQueuedTasks++;
+	}
+
+	// Acquiring the mutex here ensures that a thread that's about to wait will see the updated
+	// count, or will be woken by the notification.
+	{
+		std::scoped_lock lock(m_idleMutex);
+	}
+
+	m_idleCondition.notify_one();
+}
+
+void FolderSizeCalculator::Walk::ProcessFolder(size_t workerIndex, const Task &task)
+{
+	auto lastWriteTime = task.lastWriteTime;
+
+	if (!lastWriteTime)
+	{
+		std::error_code timeError;
+		auto currentLastWriteTime = std::filesystem::last_write_time(task.path, timeError);
+
+		if (!timeError)
+		{
+			lastWriteTime = currentLastWriteTime;
+		}
+	}
+
+	if (m_cache && lastWriteTime)
+	{
+		auto cachedEntry = m_cache->MaybeGetFolderEntry(task.path, *lastWriteTime);
+
+		if (cachedEntry)
+		{
+			AddTotals(cachedEntry->size, cachedEntry->numFiles,
+				static_cast<int>(cachedEntry->subfolderNames.size()));
+
+			// The subfolders still need to be visited, since they may have changed, even though
+			// this folder hasn't.
+			for (const auto &subfolderName : cachedEntry->subfolderNames)
+			{
+				PushTask(workerIndex, { task.path / subfolderName, std::nullopt });
+			}
+
+			return;
+		}
+	}
+
+	FolderSizeCache::FolderEntry entry = {};
+
+	// The entry is only cached if every item in the folder could be examined.
+	bool complete = true;
+
 	std::error_code error;
+	std::filesystem::directory_iterator itr(task.path, error);
 
-	for (const auto &entry : std::filesystem::directory_iterator(path, error))
+	for (; !error && itr != std::filesystem::end(itr); itr.increment(error))
 	{
-		std::error_code typeErrorCode;
-		auto isDirectory = entry.is_directory(typeErrorCode);
+		if (m_stopToken.stop_requested())
+		{
+			return;
+		}
+
+		const auto &directoryEntry = *itr;
 
-		if (typeErrorCode)
+		std::error_code typeError;
+		bool isDirectory = directoryEntry.is_directory(typeError);
+
+		if (typeError)
 		{
+			complete = false;
 			continue;
 		}
 
 		if (isDirectory)
 		{
-			folderInfo.numFolders++;
+			// Symbolic links to folders aren't followed, as they could otherwise result in the same
+			// folder being counted multiple times, or in a cycle.
+			std::error_code linkError;
 
-			FolderInfo subFolderInfo = GetFolderInfo(entry.path());
+			if (directoryEntry.is_symlink(linkError) || linkError)
+			{
+				continue;
+			}
+
+			entry.subfolderNames.push_back(directoryEntry.path().filename());
+
+			std::error_code subfolderTimeError;
+			auto subfolderLastWriteTime = directoryEntry.last_write_time(subfolderTimeError);
 
-			folderInfo.size += subFolderInfo.size;
-			folderInfo.numFolders += subFolderInfo.numFolders;
-			folderInfo.numFiles += subFolderInfo.numFiles;
+			PushTask(workerIndex,
+				{ directoryEntry.path(),
+					subfolderTimeError ? std::nullopt : std::optional(subfolderLastWriteTime) });
 		}
 		else
 		{
-			std::error_code sizeErrorCode;
-			const auto size = std::filesystem::file_size(entry.path(), sizeErrorCode);
+			// On Windows, the size is returned from the data retrieved during enumeration.
+			std::error_code sizeError;
+			auto size = directoryEntry.file_size(sizeError);
 
 			// If the size can't be retrieved, the error will be ignored and the current file will
 			// effectively be skipped over.
-			if (!sizeErrorCode)
+			if (sizeError)
 			{
-				folderInfo.size += size;
-				folderInfo.numFiles++;
+				complete = false;
+				continue;
 			}
+
+			entry.size += size;
+			entry.numFiles++;
 		}
 	}
 
+	if (error)
+	{
+		// Either the folder couldn't be opened, or enumeration failed part way through. In both
+		// cases, the items that were found are still counted.
+		complete = false;
+	}
+
+	AddTotals(entry.size, entry.numFiles, static_cast<int>(entry.subfolderNames.size()));
+
+	if (m_cache && lastWriteTime && complete)
+	{
+		entry.lastWriteTime = *lastWriteTime;
+		m_cache->SetFolderEntry(task.path, std::move(entry));
+	}
+}
+
+void FolderSizeCalculator::Walk::AddTotals(std::uintmax_t size, int numFiles, int numFolders)
+{
+	m_size += size;
+	m_numFiles += numFiles;
+	m_numFolders += numFolders;
+}
+
+FolderSizeCalculator::FolderSizeCalculator(FolderSizeCache *cache, unsigned int numThreads) :
+	m_cache(cache),
+	m_numThreads(numThreads)
+{
+	CHECK_GT(numThreads, 0u);
+}
+
+std::optional<FolderInfo> FolderSizeCalculator::Calculate(const std::filesystem::path &path,
+	std::stop_token stopToken)
+{
+	Walk walk(m_cache, m_numThreads, stopToken);
+	auto folderInfo = walk.Run(path);
+
+	if (folderInfo && m_cache)
+	{
+		m_cache->SetFolderInfo(path, *folderInfo);
+	}
+
 	return folderInfo;
 }
 
-DWORD WINAPI Thread_CalculateFolderSize(LPVOID lpParameter)
+FolderSizeCache::FolderSizeCache(size_t maxEntries) : m_maxEntries(maxEntries)
+{
+}
+
+FolderSizeCache &FolderSizeCache::GetInstance()
+{
+	static FolderSizeCache cache;
+	return cache;
+}
+
+std::optional<FolderInfo> FolderSizeCache::MaybeGetFolderInfo(
+	const std::filesystem::path &path) const
 {
-	FolderSize_t *pFolderSize = reinterpret_cast<FolderSize_t *>(lpParameter);
+	std::scoped_lock lock(m_mutex);
 
-	auto folderInfo = GetFolderInfo(pFolderSize->szPath);
+	auto itr = m_folderInfo.find(path.native());
 
-	ULARGE_INTEGER size;
-	size.QuadPart = folderInfo.size;
+	if (itr == m_folderInfo.end())
+	{
+		return std::nullopt;
+	}
+
+	return itr->second;
+}
+
+void FolderSizeCache::Clear()
+{
+	std::scoped_lock lock(m_mutex);
 
-	pFolderSize->pfnCallback(folderInfo.numFolders, folderInfo.numFiles, &size, pFolderSize->pData);
+	m_folderEntries.clear();
+	m_folderInfo.clear();
+}
 
-	free(pFolderSize);
+std::optional<FolderSizeCache::FolderEntry> FolderSizeCache::MaybeGetFolderEntry(
+	const std::filesystem::path &path, std::filesystem::file_time_type lastWriteTime) const
+{
+	std::scoped_lock lock(m_mutex);
 
-	return 1;
+	auto itr = m_folderEntries.find(path.native());
+
+	if (itr == m_folderEntries.end() || itr->second.lastWriteTime != lastWriteTime)
+	{
+		return std::nullopt;
+	}
+
+	return itr->second;
+}
+
+void FolderSizeCache::SetFolderEntry(const std::filesystem::path &path, FolderEntry entry)
+{
+	std::scoped_lock lock(m_mutex);
+
+	if (m_folderEntries.size() >= m_maxEntries && !m_folderEntries.contains(path.native()))
+	{
+		m_folderEntries.clear();
+	}
+
+	m_folderEntries.insert_or_assign(path.native(), std::move(entry));
+}
+
+void FolderSizeCache::SetFolderInfo(const std::filesystem::path &path,
+	const FolderInfo &folderInfo)
+{
+	std::scoped_lock lock(m_mutex);
+
+	if (m_folderInfo.size() >= m_maxEntries && !m_folderInfo.contains(path.native()))
+	{
+		m_folderInfo.clear();
+	}
+
+	m_folderInfo.insert_or_assign(path.native(), folderInfo);
+}
+
+std::optional<FolderInfo> GetFolderInfo(const std::wstring &path, std::stop_token stopToken)
+{
+	FolderSizeCalculator calculator(&FolderSizeCache::GetInstance());
+	return calculator.Calculate(path, stopToken);
 }
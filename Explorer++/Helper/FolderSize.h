@@ -4,6 +4,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 struct FolderInfo
 {
 	std::uintmax_t size;
@@ -11,13 +20,86 @@ struct FolderInfo
 	int numFiles;
 };
 
-FolderInfo GetFolderInfo(const std::wstring &path);
+// Caches the contents of the folders visited by FolderSizeCalculator, so that the size of a folder
+// can be recalculated without enumerating every folder within it again.
+//
+// The entry for each folder holds the size of the files directly within it, along with the names
+// of its subfolders, and is keyed by the folder's path and last write time. The last write time of
+// a folder changes whenever an item within it is added, removed or renamed, so any such change, at
+// any depth, will be picked up. Changes to the size of an existing file (which don't affect the
+// folder's last write time) won't be, until the folder itself is modified.
+//
+// This class is thread-safe.
+class FolderSizeCache
+{
+public:
+	static constexpr size_t DEFAULT_MAX_ENTRIES = 100'000;
+
+	// Once the number of folders reaches the maximum, the cache is cleared.
+	explicit FolderSizeCache(size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+	// A cache shared by everything in the process that calculates folder sizes.
+	static FolderSizeCache &GetInstance();
+
+	// Returns the result of the most recent calculation for the folder, if there is one. The
+	// result isn't validated, so this is only suitable in situations where the folder can't be
+	// examined (e.g. when sorting).
+	std::optional<FolderInfo> MaybeGetFolderInfo(const std::filesystem::path &path) const;
+
+	void Clear();
+
+private:
+	friend class FolderSizeCalculator;
+
+	struct FolderEntry
+	{
+		std::filesystem::file_time_type lastWriteTime;
+		std::uintmax_t size;
+		int numFiles;
+		std::vector<std::filesystem::path> subfolderNames;
+	};
+
+	using Key = std::filesystem::path::string_type;
 
-typedef struct
+	std::optional<FolderEntry> MaybeGetFolderEntry(const std::filesystem::path &path,
+		std::filesystem::file_time_type lastWriteTime) const;
+	void SetFolderEntry(const std::filesystem::path &path, FolderEntry entry);
+	void SetFolderInfo(const std::filesystem::path &path, const FolderInfo &folderInfo);
+
+	const size_t m_maxEntries;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<Key, FolderEntry> m_folderEntries;
+	std::unordered_map<Key, FolderInfo> m_folderInfo;
+};
+
+// Calculates the total size of a folder, along with the number of files and folders within it.
+//
+// The folder tree is walked by several threads at once. Each thread has its own queue of folders;
+// subfolders are added to the queue of the thread that finds them and a thread that runs out of
+// work takes folders from the other queues. File sizes are read from the directory entries, so no
+// additional request is needed for each file on Windows.
+class FolderSizeCalculator
 {
-	TCHAR szPath[MAX_PATH];
-	LPVOID pData;
-	void (*pfnCallback)(int nFolders, int nFiles, PULARGE_INTEGER lTotalFolderSize, LPVOID pData);
-} FolderSize_t;
+public:
+	static constexpr unsigned int DEFAULT_NUM_THREADS = 4;
+
+	// The calling thread takes part in the walk, so numThreads - 1 additional threads are created
+	// for each calculation. The cache is optional.
+	explicit FolderSizeCalculator(FolderSizeCache *cache = nullptr,
+		unsigned int numThreads = DEFAULT_NUM_THREADS);
+
+	// Folders and files that can't be accessed are skipped. Returns std::nullopt if a stop is
+	// requested before the calculation finishes.
+	std::optional<FolderInfo> Calculate(const std::filesystem::path &path,
+		std::stop_token stopToken = {});
+
+private:
+	class Walk;
+
+	FolderSizeCache *const m_cache;
+	const unsigned int m_numThreads;
+};
 
-DWORD WINAPI Thread_CalculateFolderSize(LPVOID lpParameter);
+// Calculates the size of a folder using the shared cache.
+std::optional<FolderInfo> GetFolderInfo(const std::wstring &path, std::stop_token stopToken = {});
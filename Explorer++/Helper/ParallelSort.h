@@ -0,0 +1,134 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "BackgroundWorkPool.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace ParallelSortDetail
+{
+
+// Below this number of elements per chunk, the cost of queueing the tasks and merging the results
+// outweighs any benefit from sorting in parallel.
+inline constexpr size_t MIN_ELEMENTS_PER_CHUNK = 16384;
+
+// Merges each pair of adjacent sorted runs in the source range into the destination range. The
+// runs are delimited by the offsets in bounds, which is updated to describe the merged runs. The
+// pairs are merged concurrently.
+template <typename SourceIt, typename DestIt, typename Compare>
+void MergeAdjacentRuns(BackgroundWorkPool *workPool, SourceIt source, DestIt dest,
+	std::vector<size_t> &bounds, Compare comp)
+{
+	size_t numRuns = bounds.size() - 1;
+	std::vector<size_t> mergedBounds;
+	mergedBounds.reserve(numRuns / 2 + 2);
+
+	std::vector<std::function<void()>> merges;
+
+	for (size_t i = 0; i < numRuns; i += 2)
+	{
+		mergedBounds.push_back(bounds[i]);
+
+		size_t first = bounds[i];
+		size_t middle = bounds[i + 1];
+
+		if (i + 1 == numRuns)
+		{
+			// There's an odd number of runs, so the final run has nothing to be merged with.
+			std::move(source + first, source + middle, dest + first);
+			continue;
+		}
+
+		size_t last = bounds[i + 2];
+
+		merges.emplace_back(
+			[source, dest, first, middle, last, &comp]
+			{
+				std::merge(std::make_move_iterator(source + first),
+					std::make_move_iterator(source + middle),
+					std::make_move_iterator(source + middle),
+					std::make_move_iterator(source + last), dest + first, comp);
+			});
+	}
+
+	RunConcurrently(workPool, merges);
+
+	mergedBounds.push_back(bounds.back());
+	bounds = std::move(mergedBounds);
+}
+
+}
+
+// Sorts the range using tasks on the shared work pool. The sort is stable, so the result is always
+// the same as the result of std::stable_sort.
+//
+// The range is split into one chunk per pool thread, each chunk is sorted independently, then
+// adjacent chunks are merged, in parallel, until a single sorted run remains. The calling thread
+// takes part in the sort (see RunConcurrently()), so the sort won't stall if the pool is busy.
+// Small ranges are sorted entirely on the calling thread.
+//
+// Since the comparison function will be called concurrently from several threads, it (and
+// anything it reads) must be safe to use in that way. The element type must be default
+// constructible, as a temporary buffer the same size as the range is used when merging.
+template <typename RandomIt, typename Compare>
+void ParallelStableSort(RandomIt first, RandomIt last, Compare comp, BackgroundWorkPool *workPool)
+{
+	using ValueType = typename std::iterator_traits<RandomIt>::value_type;
+
+	auto size = static_cast<size_t>(last - first);
+	size_t numChunks = std::min(static_cast<size_t>(std::max(workPool->GetMaxConcurrency(), 1)),
+		size / ParallelSortDetail::MIN_ELEMENTS_PER_CHUNK);
+
+	if (numChunks <= 1)
+	{
+		std::stable_sort(first, last, comp);
+		return;
+	}
+
+	std::vector<size_t> bounds;
+
+	for (size_t i = 0; i <= numChunks; i++)
+	{
+		bounds.push_back(size * i / numChunks);
+	}
+
+	std::vector<std::function<void()>> chunkSorts;
+
+	for (size_t i = 0; i < numChunks; i++)
+	{
+		chunkSorts.emplace_back([first, start = bounds[i], end = bounds[i + 1], &comp]
+			{ std::stable_sort(first + start, first + end, comp); });
+	}
+
+	RunConcurrently(workPool, chunkSorts);
+
+	// The runs are merged back and forth between the original range and the buffer.
+	std::vector<ValueType> buffer(size);
+	bool inBuffer = false;
+
+	while (bounds.size() > 2)
+	{
+		if (inBuffer)
+		{
+			ParallelSortDetail::MergeAdjacentRuns(workPool, buffer.begin(), first, bounds, comp);
+		}
+		else
+		{
+			ParallelSortDetail::MergeAdjacentRuns(workPool, first, buffer.begin(), bounds, comp);
+		}
+
+		inBuffer = !inBuffer;
+	}
+
+	if (inBuffer)
+	{
+		std::move(buffer.begin(), buffer.end(), first);
+	}
+}
@@ -0,0 +1,212 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "ReadAheadPipeline.h"
+#include <glog/logging.h>
+#include <thread>
+
+ReadAheadPipeline::ReadAheadPipeline(size_t bufferSize, size_t numBuffers) :
+	m_bufferSize(bufferSize),
+	m_numBuffers(numBuffers)
+{
+	CHECK_GT(bufferSize, 0u);
+
+	// At least two buffers are needed for reading and processing to overlap.
+	CHECK_GE(numBuffers, 2u);
+
+	m_storage.reset(static_cast<std::byte *>(
+		::operator new[](bufferSize * numBuffers, std::align_val_t{ BUFFER_ALIGNMENT })));
+}
+
+ReadAheadPipeline::Result ReadAheadPipeline::Run(size_t numSources, SourceFactory sourceFactory,
+	BlockProcessor blockProcessor, SourceFinishedCallback sourceFinishedCallback,
+	std::stop_token stopToken)
+{
+	m_freeBuffers.clear();
+
+	for (size_t i = 0; i < m_numBuffers; i++)
+	{
+		m_freeBuffers.push_back(i);
+	}
+
+	m_readBlocks.clear();
+	m_stopReading = false;
+
+	Result result = { Status::Succeeded, 0 };
+	size_t numSourcesFinished = 0;
+
+	{
+		std::jthread readerThread([this, numSources, &sourceFactory]
+			{ ReadSources(numSources, sourceFactory); });
+
+		while (numSourcesFinished < numSources)
+		{
+			auto block = PopBlock(stopToken);
+
+			if (!block)
+			{
+				result = { Status::Cancelled, numSourcesFinished };
+				break;
+			}
+
+			if (block->type == BlockType::OpenFailed)
+			{
+				result = { Status::OpenFailed, block->sourceIndex };
+				break;
+			}
+			else if (block->type == BlockType::ReadFailed)
+			{
+				result = { Status::ReadFailed, block->sourceIndex };
+				break;
+			}
+			else if (block->type == BlockType::EndOfSource)
+			{
+				numSourcesFinished++;
+
+				if (sourceFinishedCallback && !sourceFinishedCallback(block->sourceIndex))
+				{
+					result = { Status::ProcessFailed, block->sourceIndex };
+					break;
+				}
+
+				continue;
+			}
+
+			bool processed = blockProcessor(block->sourceIndex,
+				GetBuffer(block->bufferIndex).first(block->size));
+			ReleaseBuffer(block->bufferIndex);
+
+			if (!processed)
+			{
+				result = { Status::ProcessFailed, block->sourceIndex };
+				break;
+			}
+		}
+
+		{
+			std::scoped_lock lock(m_mutex);
+			m_stopReading = true;
+		}
+
+		m_condition.notify_all();
+	}
+
+	return result;
+}
+
+void ReadAheadPipeline::ReadSources(size_t numSources, const SourceFactory &sourceFactory)
+{
+	for (size_t i = 0; i < numSources; i++)
+	{
+		auto source = sourceFactory(i);
+
+		if (!source)
+		{
+			PushBlock({ BlockType::OpenFailed, i });
+			return;
+		}
+
+		if (!ReadSource(i, *source))
+		{
+			return;
+		}
+	}
+}
+
+// Returns false if reading should stop, either because the source couldn't be read, or because the
+// pipeline is being stopped.
+bool ReadAheadPipeline::ReadSource(size_t sourceIndex, Source &source)
+{
+	while (true)
+	{
+		auto bufferIndex = AcquireBuffer();
+
+		if (!bufferIndex)
+		{
+			return false;
+		}
+
+		auto numBytesRead = source.Read(GetBuffer(*bufferIndex));
+
+		if (!numBytesRead)
+		{
+			ReleaseBuffer(*bufferIndex);
+			PushBlock({ BlockType::ReadFailed, sourceIndex });
+			return false;
+		}
+
+		if (*numBytesRead == 0)
+		{
+			ReleaseBuffer(*bufferIndex);
+			PushBlock({ BlockType::EndOfSource, sourceIndex });
+			return true;
+		}
+
+		CHECK_LE(*numBytesRead, m_bufferSize);
+
+		PushBlock({ BlockType::Data, sourceIndex, *bufferIndex, *numBytesRead });
+	}
+}
+
+// Waits until a buffer is free. Returns std::nullopt if the pipeline is stopped while waiting.
+std::optional<size_t> ReadAheadPipeline::AcquireBuffer()
+{
+	std::unique_lock lock(m_mutex);
+	m_condition.wait(lock, [this] { return m_stopReading || !m_freeBuffers.empty(); });
+
+	if (m_stopReading)
+	{
+		return std::nullopt;
+	}
+
+	size_t bufferIndex = m_freeBuffers.back();
+	m_freeBuffers.pop_back();
+	return bufferIndex;
+}
+
+void ReadAheadPipeline::ReleaseBuffer(size_t bufferIndex)
+{
+	{
+		std::scoped_lock lock(m_mutex);
+		m_freeBuffers.push_back(bufferIndex);
+	}
+
+	m_condition.notify_all();
+}
+
+void ReadAheadPipeline::PushBlock(const Block &block)
+{
+	{
+		std::scoped_lock lock(m_mutex);
+		m_readBlocks.push_back(block);
+	}
+
+	m_condition.notify_all();
+}
+
+// Waits until a block has been read. Returns std::nullopt if a stop is requested while waiting.
+std::optional<ReadAheadPipeline::Block> ReadAheadPipeline::PopBlock(std::stop_token stopToken)
+{
+	std::unique_lock lock(m_mutex);
+
+	if (!m_condition.wait(lock, stopToken, [this] { return !m_readBlocks.empty(); }))
+	{
+		return std::nullopt;
+	}
+
+	if (stopToken.stop_requested())
+	{
+		return std::nullopt;
+	}
+
+	Block block = m_readBlocks.front();
+	m_readBlocks.pop_front();
+	return block;
+}
+
+std::span<std::byte> ReadAheadPipeline::GetBuffer(size_t bufferIndex)
+{
+	return { m_storage.get() + bufferIndex * m_bufferSize, m_bufferSize };
+}
@@ -0,0 +1,123 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+// Reads a series of sources, in order, and passes the data to a processing function in fixed-size
+// blocks.
+//
+// The sources are read on a background thread, into a fixed pool of page-aligned buffers, while
+// the blocks that have already been read are processed on the calling thread. Reading the next
+// block (including the first block of the next source) therefore overlaps with processing the
+// current one, and memory use is bounded by the size of the pool, regardless of how large the
+// sources are.
+//
+// The pipeline only deals with abstract sources and has no dependency on any particular I/O API.
+class ReadAheadPipeline
+{
+public:
+	class Source
+	{
+	public:
+		virtual ~Source() = default;
+
+		// Reads up to buffer.size() bytes into the buffer. Returns the number of bytes read, with 0
+		// indicating that the end of the source has been reached, or std::nullopt on failure.
+		virtual std::optional<size_t> Read(std::span<std::byte> buffer) = 0;
+	};
+
+	enum class Status
+	{
+		Succeeded,
+		OpenFailed,
+		ReadFailed,
+		ProcessFailed,
+		Cancelled
+	};
+
+	struct Result
+	{
+		Status status;
+
+		// The index of the source that was being read or processed when the operation stopped.
+		// Only meaningful if the operation didn't succeed.
+		size_t sourceIndex;
+	};
+
+	// Returns nullptr if the source can't be opened.
+	using SourceFactory = std::function<std::unique_ptr<Source>(size_t sourceIndex)>;
+
+	// Called for each block read, in order. Returning false stops the operation.
+	using BlockProcessor =
+		std::function<bool(size_t sourceIndex, std::span<const std::byte> block)>;
+
+	// Called once the final block from a source has been processed (or, for an empty source, once
+	// the end of the source has been reached). Returning false stops the operation.
+	using SourceFinishedCallback = std::function<bool(size_t sourceIndex)>;
+
+	static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+	static constexpr size_t DEFAULT_NUM_BUFFERS = 4;
+	static constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+	ReadAheadPipeline(size_t bufferSize = DEFAULT_BUFFER_SIZE,
+		size_t numBuffers = DEFAULT_NUM_BUFFERS);
+
+	Result Run(size_t numSources, SourceFactory sourceFactory, BlockProcessor blockProcessor,
+		SourceFinishedCallback sourceFinishedCallback = nullptr, std::stop_token stopToken = {});
+
+private:
+	struct AlignedDeleter
+	{
+		void operator()(std::byte *data) const
+		{
+			::operator delete[](data, std::align_val_t{ BUFFER_ALIGNMENT });
+		}
+	};
+
+	enum class BlockType
+	{
+		Data,
+		EndOfSource,
+		OpenFailed,
+		ReadFailed
+	};
+
+	struct Block
+	{
+		BlockType type;
+		size_t sourceIndex;
+		size_t bufferIndex = 0;
+		size_t size = 0;
+	};
+
+	void ReadSources(size_t numSources, const SourceFactory &sourceFactory);
+	bool ReadSource(size_t sourceIndex, Source &source);
+	std::optional<size_t> AcquireBuffer();
+	void ReleaseBuffer(size_t bufferIndex);
+	void PushBlock(const Block &block);
+	std::optional<Block> PopBlock(std::stop_token stopToken);
+	std::span<std::byte> GetBuffer(size_t bufferIndex);
+
+	const size_t m_bufferSize;
+	const size_t m_numBuffers;
+	std::unique_ptr<std::byte[], AlignedDeleter> m_storage;
+
+	std::mutex m_mutex;
+	std::condition_variable_any m_condition;
+	std::vector<size_t> m_freeBuffers;
+	std::deque<Block> m_readBlocks;
+	bool m_stopReading = false;
+};
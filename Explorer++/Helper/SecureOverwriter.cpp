@@ -0,0 +1,70 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "SecureOverwriter.h"
+#include <glog/logging.h>
+#include <algorithm>
+
+SecureOverwriter::SecureOverwriter(const ChaCha20::Key &key, size_t blockSize) :
+	m_block(blockSize),
+	m_randomStream(key)
+{
+	CHECK_GT(blockSize, 0u);
+}
+
+SecureOverwriter::Status SecureOverwriter::Overwrite(Target &target, uint64_t size,
+	std::span<const OverwritePass> passes, ProgressCallback progressCallback,
+	std::stop_token stopToken)
+{
+	for (const auto &pass : passes)
+	{
+		if (!target.Rewind())
+		{
+			return Status::WriteFailed;
+		}
+
+		if (pass.type == OverwritePass::Type::Pattern)
+		{
+			std::fill(m_block.begin(), m_block.end(), pass.pattern);
+		}
+
+		uint64_t remaining = size;
+
+		while (remaining > 0)
+		{
+			if (stopToken.stop_requested())
+			{
+				return Status::Cancelled;
+			}
+
+			auto block = std::span(m_block).first(
+				static_cast<size_t>(std::min<uint64_t>(m_block.size(), remaining)));
+
+			if (pass.type == OverwritePass::Type::Random)
+			{
+				m_randomStream.Generate(block);
+			}
+
+			if (!target.Write(block))
+			{
+				return Status::WriteFailed;
+			}
+
+			remaining -= block.size();
+
+			if (progressCallback)
+			{
+				progressCallback(block.size());
+			}
+		}
+
+		if (!target.Flush())
+		{
+			return Status::WriteFailed;
+		}
+	}
+
+	return Status::Succeeded;
+}
@@ -0,0 +1,81 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include "ChaCha20.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+struct OverwritePass
+{
+	enum class Type
+	{
+		// Every byte is set to the pattern value.
+		Pattern,
+
+		// The data is taken from a cryptographically secure random stream.
+		Random
+	};
+
+	Type type;
+	std::byte pattern = {};
+};
+
+// Overwrites the contents of a target (typically a file that's about to be deleted) using a
+// sequence of passes.
+//
+// Each pass is written in large blocks, starting from the beginning of the target. Random data is
+// generated by expanding a single random key into a ChaCha20 keystream, so the random pass can run
+// at close to the speed of the storage device, rather than being limited by the cost of requesting
+// random data from the system.
+//
+// The overwriter only deals with an abstract target and has no dependency on any particular I/O
+// API.
+class SecureOverwriter
+{
+public:
+	class Target
+	{
+	public:
+		virtual ~Target() = default;
+
+		// Moves back to the start of the target, ready for the next pass.
+		virtual bool Rewind() = 0;
+
+		virtual bool Write(std::span<const std::byte> data) = 0;
+
+		// Called once each pass is complete. This should ensure that the pass has reached the
+		// underlying storage. Otherwise, the passes could be combined in a cache, with only the
+		// final pass actually being written out.
+		virtual bool Flush() = 0;
+	};
+
+	enum class Status
+	{
+		Succeeded,
+		WriteFailed,
+		Cancelled
+	};
+
+	// Called each time a block has been written, with the size of the block.
+	using ProgressCallback = std::function<void(uint64_t numBytesWritten)>;
+
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+	// The key is used to generate the data for random passes, so it should itself come from a
+	// cryptographically secure source.
+	SecureOverwriter(const ChaCha20::Key &key, size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+	Status Overwrite(Target &target, uint64_t size, std::span<const OverwritePass> passes,
+		ProgressCallback progressCallback = nullptr, std::stop_token stopToken = {});
+
+private:
+	std::vector<std::byte> m_block;
+	ChaCha20 m_randomStream;
+};
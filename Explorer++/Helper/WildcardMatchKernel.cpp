@@ -0,0 +1,188 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "WildcardMatchKernel.h"
+#include <bit>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define WILDCARD_MATCH_KERNEL_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace WildcardMatchKernel
+{
+
+namespace
+{
+
+wchar_t FoldAsciiCase(wchar_t c)
+{
+	return (static_cast<unsigned int>(c - 'A') < 26) ? static_cast<wchar_t>(c + ('a' - 'A')) : c;
+}
+
+wchar_t MaybeFoldAsciiCase(wchar_t c, bool foldAsciiCase)
+{
+	return foldAsciiCase ? FoldAsciiCase(c) : c;
+}
+
+#ifdef WILDCARD_MATCH_KERNEL_SSE2
+
+static_assert(sizeof(wchar_t) == sizeof(uint16_t));
+
+constexpr size_t VECTOR_SIZE = sizeof(__m128i) / sizeof(wchar_t);
+
+__m128i LoadCharacters(const wchar_t *characters)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(characters));
+}
+
+__m128i FoldAsciiCase(__m128i characters)
+{
+	// Characters in the range ['A', 'Z'] are shifted down to [0, 25]. Everything else wraps
+	// around to a larger (unsigned) value, so a saturating subtraction of 25 will only result in
+	// 0 for uppercase characters.
+	__m128i offset = _mm_sub_epi16(characters, _mm_set1_epi16('A'));
+	__m128i isUppercase =
+		_mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(25)), _mm_setzero_si128());
+	return _mm_add_epi16(characters, _mm_and_si128(isUppercase, _mm_set1_epi16('a' - 'A')));
+}
+
+__m128i MaybeFoldAsciiCase(__m128i characters, bool foldAsciiCase)
+{
+	return foldAsciiCase ? FoldAsciiCase(characters) : characters;
+}
+
+bool AllZero(__m128i value)
+{
+	return _mm_movemask_epi8(_mm_cmpeq_epi16(value, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif
+
+}
+
+bool IsAscii(std::wstring_view text)
+{
+	size_t i = 0;
+
+#ifdef WILDCARD_MATCH_KERNEL_SSE2
+	for (; i + VECTOR_SIZE <= text.size(); i += VECTOR_SIZE)
+	{
+		__m128i characters = LoadCharacters(text.data() + i);
+
+		if (!AllZero(_mm_subs_epu16(characters, _mm_set1_epi16(0x7F))))
+		{
+			return false;
+		}
+	}
+#endif
+
+	for (; i < text.size(); i++)
+	{
+		if (text[i] > 0x7F)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Equals(const wchar_t *text, const wchar_t *pattern, const wchar_t *mask, size_t length,
+	bool foldAsciiCase)
+{
+	size_t i = 0;
+
+#ifdef WILDCARD_MATCH_KERNEL_SSE2
+	for (; i + VECTOR_SIZE <= length; i += VECTOR_SIZE)
+	{
+		__m128i textCharacters = MaybeFoldAsciiCase(LoadCharacters(text + i), foldAsciiCase);
+		__m128i difference = _mm_xor_si128(textCharacters, LoadCharacters(pattern + i));
+
+		if (!AllZero(_mm_and_si128(difference, LoadCharacters(mask + i))))
+		{
+			return false;
+		}
+	}
+#endif
+
+	for (; i < length; i++)
+	{
+		if (((MaybeFoldAsciiCase(text[i], foldAsciiCase) ^ pattern[i]) & mask[i]) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t Find(std::wstring_view text, size_t start, const wchar_t *pattern, const wchar_t *mask,
+	size_t length, bool foldAsciiCase)
+{
+	if (start > text.size() || text.size() - start < length)
+	{
+		return std::wstring_view::npos;
+	}
+
+	size_t last = text.size() - length;
+
+	// Candidate positions are found by searching for the first character in the pattern that
+	// isn't a wildcard. If every character is a wildcard, the pattern will match at any position.
+	size_t anchor = 0;
+
+	while (anchor < length && mask[anchor] == 0)
+	{
+		anchor++;
+	}
+
+	if (anchor == length)
+	{
+		return start;
+	}
+
+	wchar_t anchorCharacter = pattern[anchor];
+	size_t position = start;
+
+#ifdef WILDCARD_MATCH_KERNEL_SSE2
+	__m128i anchorCharacters = _mm_set1_epi16(static_cast<short>(anchorCharacter));
+
+	// Since anchor < length, each load here will stay within the bounds of the text.
+	for (; position + VECTOR_SIZE - 1 <= last; position += VECTOR_SIZE)
+	{
+		__m128i textCharacters =
+			MaybeFoldAsciiCase(LoadCharacters(text.data() + position + anchor), foldAsciiCase);
+
+		// Each matching character sets 2 bits in the mask. Only the lower bit is examined.
+		auto candidates = static_cast<unsigned int>(
+			_mm_movemask_epi8(_mm_cmpeq_epi16(textCharacters, anchorCharacters)));
+		candidates &= 0x5555;
+
+		while (candidates != 0)
+		{
+			size_t candidate = position + std::countr_zero(candidates) / 2;
+			candidates &= candidates - 1;
+
+			if (Equals(text.data() + candidate, pattern, mask, length, foldAsciiCase))
+			{
+				return candidate;
+			}
+		}
+	}
+#endif
+
+	for (; position <= last; position++)
+	{
+		if (MaybeFoldAsciiCase(text[position + anchor], foldAsciiCase) == anchorCharacter
+			&& Equals(text.data() + position, pattern, mask, length, foldAsciiCase))
+		{
+			return position;
+		}
+	}
+
+	return std::wstring_view::npos;
+}
+
+}
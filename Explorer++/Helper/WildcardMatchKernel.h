@@ -0,0 +1,34 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <string_view>
+
+// The low-level comparison routines used by WildcardPattern. Where SSE2 is available, characters
+// are compared 8 at a time, otherwise a scalar implementation is used.
+//
+// Patterns are passed in alongside a mask. Positions where the mask is 0 (i.e. those that
+// correspond to a '?' wildcard) match any character, while positions where the mask is 0xFFFF
+// need to match exactly.
+//
+// When foldAsciiCase is set, the characters from the text are converted to lowercase before being
+// compared, though only in the ASCII range. The pattern is expected to have been folded already.
+// Full case folding is left to the caller, which can use IsAscii() to determine whether ASCII
+// folding will be sufficient for a particular string.
+namespace WildcardMatchKernel
+{
+
+bool IsAscii(std::wstring_view text);
+
+// Compares the first `length` characters of text against the pattern.
+bool Equals(const wchar_t *text, const wchar_t *pattern, const wchar_t *mask, size_t length,
+	bool foldAsciiCase);
+
+// Returns the earliest position, at or after start, at which the pattern matches the text in its
+// entirety. Returns std::wstring_view::npos if there's no such position.
+size_t Find(std::wstring_view text, size_t start, const wchar_t *pattern, const wchar_t *mask,
+	size_t length, bool foldAsciiCase);
+
+}
@@ -0,0 +1,397 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "stdafx.h"
+#include "WildcardPattern.h"
+#include "WildcardMatchKernel.h"
+#include <array>
+#include <memory>
+
+namespace
+{
+
+struct FoldTable
+{
+	std::array<wchar_t, 0x10000> characters;
+
+	// Whether the table folds characters in the ASCII range in the same way that
+	// WildcardMatchKernel does. If not, the kernel can't be used to fold the case of strings.
+	bool asciiFoldingMatchesKernel;
+};
+
+bool DoesAsciiFoldingMatchKernel(const FoldTable &table)
+{
+	for (wchar_t c = 0; c <= 0x7F; c++)
+	{
+		wchar_t expected = (c >= 'A' && c <= 'Z') ? static_cast<wchar_t>(c + ('a' - 'A')) : c;
+
+		if (table.characters[c] != expected)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::unique_ptr<FoldTable> BuildFoldTable()
+{
+	auto table = std::make_unique<FoldTable>();
+
+	for (size_t i = 0; i < table->characters.size(); i++)
+	{
+		table->characters[i] = static_cast<wchar_t>(i);
+	}
+
+	// The mapping for every character is retrieved in a single call. Lowercase mappings are one to
+	// one, so the output should be the same length as the input. Surrogates are left as-is, since
+	// they can't be mapped individually.
+	std::wstring characters;
+
+	for (size_t i = 1; i < table->characters.size(); i++)
+	{
+		if (i < 0xD800 || i > 0xDFFF)
+		{
+			characters.push_back(static_cast<wchar_t>(i));
+		}
+	}
+
+	std::wstring mappedCharacters(characters.size(), '\0');
+	int res = LCMapString(LOCALE_USER_DEFAULT, LCMAP_LOWERCASE, characters.data(),
+		static_cast<int>(characters.size()), mappedCharacters.data(),
+		static_cast<int>(mappedCharacters.size()));
+
+	if (res == static_cast<int>(characters.size()))
+	{
+		for (size_t i = 0; i < characters.size(); i++)
+		{
+			// The wildcard characters have a special meaning, so no other character should be
+			// mapped to one of them.
+			if (mappedCharacters[i] == '*' || mappedCharacters[i] == '?')
+			{
+				continue;
+			}
+
+			table->characters[characters[i]] = mappedCharacters[i];
+		}
+	}
+
+	table->asciiFoldingMatchesKernel = DoesAsciiFoldingMatchKernel(*table);
+
+	return table;
+}
+
+const FoldTable &GetFoldTable()
+{
+	static const std::unique_ptr<FoldTable> foldTable = BuildFoldTable();
+	return *foldTable;
+}
+
+}
+
+WildcardPattern::WildcardPattern() : WildcardPattern(L"", true)
+{
+}
+
+WildcardPattern::WildcardPattern(std::wstring_view pattern, bool caseSensitive) :
+	m_caseSensitive(caseSensitive)
+{
+	if (pattern.find(':') == std::wstring_view::npos)
+	{
+		AddSubPattern(pattern);
+		return;
+	}
+
+	size_t start = 0;
+
+	while (start <= pattern.size())
+	{
+		size_t end = pattern.find(':', start);
+
+		if (end == std::wstring_view::npos)
+		{
+			end = pattern.size();
+		}
+
+		// Empty patterns (e.g. those between two consecutive separators) are skipped, though a
+		// pattern that only consists of spaces is retained and will match an empty string.
+		if (end > start)
+		{
+			auto subPattern = pattern.substr(start, end - start);
+
+			auto first = subPattern.find_first_not_of(' ');
+			auto last = subPattern.find_last_not_of(' ');
+			subPattern = (first == std::wstring_view::npos)
+				? std::wstring_view()
+				: subPattern.substr(first, last - first + 1);
+
+			AddSubPattern(subPattern);
+		}
+
+		start = end + 1;
+	}
+}
+
+void WildcardPattern::AddSubPattern(std::wstring_view pattern)
+{
+	SubPattern subPattern;
+	subPattern.anchoredStart = pattern.empty() || pattern.front() != '*';
+	subPattern.anchoredEnd = pattern.empty() || pattern.back() != '*';
+	subPattern.minLength = 0;
+
+	size_t start = 0;
+
+	while (start <= pattern.size())
+	{
+		size_t end = pattern.find('*', start);
+
+		if (end == std::wstring_view::npos)
+		{
+			end = pattern.size();
+		}
+
+		// Consecutive '*' characters are equivalent to a single '*', so there's no need to record
+		// the empty segment between them. The exception is a pattern with no '*' characters at
+		// all, which always has exactly one segment (even if it's empty).
+		if (end > start || (start == 0 && end == pattern.size()))
+		{
+			Segment segment;
+			segment.offset = m_segmentText.size();
+			segment.length = end - start;
+
+			for (size_t i = start; i < end; i++)
+			{
+				m_segmentText.push_back(MaybeFoldCase(pattern[i]));
+				m_segmentMask.push_back((pattern[i] == '?') ? 0 : 0xFFFF);
+			}
+
+			subPattern.segments.push_back(segment);
+			subPattern.minLength += segment.length;
+		}
+
+		start = end + 1;
+	}
+
+	m_subPatterns.push_back(std::move(subPattern));
+}
+
+bool WildcardPattern::Matches(std::wstring_view text) const
+{
+	FoldMode foldMode = GetFoldMode(text);
+
+	for (const auto &subPattern : m_subPatterns)
+	{
+		if (MatchesSubPattern(subPattern, text, foldMode))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool WildcardPattern::IsSubsetOf(std::wstring_view pattern, std::wstring_view otherPattern)
+{
+	if (pattern == otherPattern)
+	{
+		return true;
+	}
+
+	if (pattern.find(':') != std::wstring_view::npos
+		|| otherPattern.find(':') != std::wstring_view::npos)
+	{
+		return false;
+	}
+
+	if (!otherPattern.empty() && otherPattern.find_first_not_of('*') == std::wstring_view::npos)
+	{
+		return true;
+	}
+
+	if (pattern.size() <= otherPattern.size())
+	{
+		return false;
+	}
+
+	// The only case detected here is where pattern is the result of inserting characters into
+	// otherPattern next to a '*'. For example, if "a*b" becomes "ac*b", any string that matches the
+	// new pattern will start with "a" and end with "b", so will match the original pattern. The
+	// inserted characters can't include a '*', since that might allow more strings to match.
+	size_t prefixLength = 0;
+
+	while (prefixLength < otherPattern.size()
+		&& pattern[prefixLength] == otherPattern[prefixLength])
+	{
+		prefixLength++;
+	}
+
+	size_t suffixLength = 0;
+
+	while (suffixLength < otherPattern.size()
+		&& pattern[pattern.size() - suffixLength - 1]
+			== otherPattern[otherPattern.size() - suffixLength - 1])
+	{
+		suffixLength++;
+	}
+
+	size_t insertedLength = pattern.size() - otherPattern.size();
+
+	// The characters may have been inserted at any point in the range where the patterns share
+	// both a common prefix and a common suffix.
+	for (size_t position = otherPattern.size() - suffixLength; position <= prefixLength;
+		 position++)
+	{
+		auto insertedText = pattern.substr(position, insertedLength);
+
+		if (insertedText.find('*') != std::wstring_view::npos)
+		{
+			continue;
+		}
+
+		if ((position > 0 && otherPattern[position - 1] == '*')
+			|| (position < otherPattern.size() && otherPattern[position] == '*'))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+WildcardPattern::FoldMode WildcardPattern::GetFoldMode(std::wstring_view text) const
+{
+	if (m_caseSensitive)
+	{
+		return FoldMode::None;
+	}
+
+	// Characters outside the ASCII range can fold to characters within it (e.g. KELVIN SIGN folds
+	// to 'k'), so the full table is needed if there are any such characters in the text.
+	if (GetFoldTable().asciiFoldingMatchesKernel && WildcardMatchKernel::IsAscii(text))
+	{
+		return FoldMode::Ascii;
+	}
+
+	return FoldMode::Full;
+}
+
+bool WildcardPattern::MatchesSubPattern(const SubPattern &subPattern, std::wstring_view text,
+	FoldMode foldMode) const
+{
+	if (text.size() < subPattern.minLength)
+	{
+		return false;
+	}
+
+	const auto &segments = subPattern.segments;
+
+	if (subPattern.anchoredStart && subPattern.anchoredEnd && segments.size() == 1)
+	{
+		// There are no '*' characters in the pattern.
+		return text.size() == segments[0].length
+			&& MatchesSegmentAt(segments[0], text, 0, foldMode);
+	}
+
+	size_t firstSegment = 0;
+	size_t lastSegment = segments.size();
+	size_t start = 0;
+	size_t end = text.size();
+
+	if (subPattern.anchoredStart)
+	{
+		if (!MatchesSegmentAt(segments[firstSegment], text, 0, foldMode))
+		{
+			return false;
+		}
+
+		start = segments[firstSegment].length;
+		firstSegment++;
+	}
+
+	if (subPattern.anchoredEnd)
+	{
+		const auto &segment = segments[lastSegment - 1];
+
+		// The minimum length check above ensures that this segment won't overlap with the first.
+		if (!MatchesSegmentAt(segment, text, text.size() - segment.length, foldMode))
+		{
+			return false;
+		}
+
+		end = text.size() - segment.length;
+		lastSegment--;
+	}
+
+	// Each of the remaining segments is surrounded by '*' characters. Matching each segment at the
+	// earliest possible position leaves the most room for the segments that follow it, so if that
+	// doesn't result in a match, nothing will.
+	auto remainingText = text.substr(0, end);
+
+	for (size_t i = firstSegment; i < lastSegment; i++)
+	{
+		size_t position = FindSegment(segments[i], remainingText, start, foldMode);
+
+		if (position == std::wstring_view::npos)
+		{
+			return false;
+		}
+
+		start = position + segments[i].length;
+	}
+
+	return true;
+}
+
+bool WildcardPattern::MatchesSegmentAt(const Segment &segment, std::wstring_view text,
+	size_t position, FoldMode foldMode) const
+{
+	const wchar_t *segmentText = m_segmentText.data() + segment.offset;
+	const wchar_t *segmentMask = m_segmentMask.data() + segment.offset;
+
+	if (foldMode != FoldMode::Full)
+	{
+		return WildcardMatchKernel::Equals(text.data() + position, segmentText, segmentMask,
+			segment.length, foldMode == FoldMode::Ascii);
+	}
+
+	for (size_t i = 0; i < segment.length; i++)
+	{
+		if (segmentMask[i] != 0 && FoldCase(text[position + i]) != segmentText[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t WildcardPattern::FindSegment(const Segment &segment, std::wstring_view text, size_t start,
+	FoldMode foldMode) const
+{
+	if (foldMode != FoldMode::Full)
+	{
+		return WildcardMatchKernel::Find(text, start, m_segmentText.data() + segment.offset,
+			m_segmentMask.data() + segment.offset, segment.length, foldMode == FoldMode::Ascii);
+	}
+
+	for (size_t position = start; position + segment.length <= text.size(); position++)
+	{
+		if (MatchesSegmentAt(segment, text, position, foldMode))
+		{
+			return position;
+		}
+	}
+
+	return std::wstring_view::npos;
+}
+
+wchar_t WildcardPattern::MaybeFoldCase(wchar_t c) const
+{
+	return m_caseSensitive ? c : FoldCase(c);
+}
+
+wchar_t WildcardPattern::FoldCase(wchar_t c)
+{
+	return GetFoldTable().characters[c];
+}
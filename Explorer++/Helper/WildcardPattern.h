@@ -0,0 +1,88 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A wildcard pattern that's parsed once and can then be matched against any number of strings. The
+// following syntax is supported:
+//
+// '*' matches any sequence of characters (including an empty sequence).
+// '?' matches exactly one character.
+// ':' separates multiple patterns (e.g. "*.h: *.cpp"). A string matches if it matches any of the
+// individual patterns. Leading and trailing spaces are removed from each individual pattern.
+//
+// Matching runs in time proportional to the length of the string multiplied by the length of the
+// pattern in the worst case, doesn't allocate and, in the common case of a pattern like "*.cpp",
+// only compares the literal prefix and suffix of the string. Comparisons are performed by
+// WildcardMatchKernel. For case-insensitive patterns, strings that only contain ASCII characters
+// are folded as part of the comparison, while other strings use the full folding table.
+class WildcardPattern
+{
+public:
+	// An empty pattern, which only matches an empty string.
+	WildcardPattern();
+	WildcardPattern(std::wstring_view pattern, bool caseSensitive);
+
+	bool Matches(std::wstring_view text) const;
+
+	// Returns true if every string matched by pattern is also matched by otherPattern (when both
+	// are matched with the same case sensitivity). Only simple cases are detected (for example,
+	// "*abc*" being a subset of "*ab*"), so a return value of false doesn't necessarily mean that
+	// the pattern isn't a subset.
+	static bool IsSubsetOf(std::wstring_view pattern, std::wstring_view otherPattern);
+
+	// Folds the case of a single character, in the same way that case-insensitive patterns do.
+	static wchar_t FoldCase(wchar_t c);
+
+private:
+	enum class FoldMode
+	{
+		None,
+		Ascii,
+		Full
+	};
+
+	// A run of characters between '*' wildcards.
+	struct Segment
+	{
+		size_t offset;
+		size_t length;
+	};
+
+	struct SubPattern
+	{
+		std::vector<Segment> segments;
+
+		// Whether the pattern starts and ends with a segment (rather than a '*').
+		bool anchoredStart;
+		bool anchoredEnd;
+
+		// The sum of the segment lengths, which is the shortest string that can match.
+		size_t minLength;
+	};
+
+	void AddSubPattern(std::wstring_view pattern);
+	FoldMode GetFoldMode(std::wstring_view text) const;
+	bool MatchesSubPattern(const SubPattern &subPattern, std::wstring_view text,
+		FoldMode foldMode) const;
+	bool MatchesSegmentAt(const Segment &segment, std::wstring_view text, size_t position,
+		FoldMode foldMode) const;
+	size_t FindSegment(const Segment &segment, std::wstring_view text, size_t start,
+		FoldMode foldMode) const;
+	wchar_t MaybeFoldCase(wchar_t c) const;
+
+	bool m_caseSensitive;
+
+	// The text for every segment, with the case folded if the pattern is case-insensitive.
+	std::wstring m_segmentText;
+
+	// For each character in m_segmentText, 0 if the character is a '?' wildcard, 0xFFFF otherwise.
+	std::wstring m_segmentMask;
+
+	std::vector<SubPattern> m_subPatterns;
+};
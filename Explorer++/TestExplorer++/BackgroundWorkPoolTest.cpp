@@ -0,0 +1,244 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ComStaThreadPoolExecutor.h"
+#include "ExecutorTestHelper.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+class BackgroundWorkPoolTest : public Test
+{
+protected:
+	~BackgroundWorkPoolTest()
+	{
+		if (m_executor)
+		{
+			m_executor->shutdown();
+		}
+	}
+
+	void CreateWorkPool(int numThreads)
+	{
+		m_executor = std::make_shared<ComStaThreadPoolExecutor>(numThreads);
+		m_workPool = std::make_unique<BackgroundWorkPool>(m_executor);
+	}
+
+	// Queues a task that won't finish until the returned promise is fulfilled. This function
+	// doesn't return until the task has started running.
+	std::promise<void> BlockWorkPool(TaskGroup &taskGroup)
+	{
+		std::promise<void> releasePromise;
+		std::promise<void> startedPromise;
+
+		taskGroup.Push(
+			[releaseFuture = releasePromise.get_future().share(), &startedPromise]
+			{
+				startedPromise.set_value();
+				releaseFuture.wait();
+			});
+
+		startedPromise.get_future().wait();
+
+		return releasePromise;
+	}
+
+	std::shared_ptr<concurrencpp::executor> m_executor;
+	std::unique_ptr<BackgroundWorkPool> m_workPool;
+};
+
+TEST_F(BackgroundWorkPoolTest, Result)
+{
+	CreateWorkPool(1);
+	TaskGroup taskGroup(m_workPool.get());
+
+	auto future = taskGroup.Push([] { return 42; });
+	EXPECT_EQ(future.get(), 42);
+}
+
+TEST_F(BackgroundWorkPoolTest, Priority)
+{
+	CreateWorkPool(1);
+	TaskGroup taskGroup1(m_workPool.get());
+	TaskGroup taskGroup2(m_workPool.get());
+
+	auto releasePromise = BlockWorkPool(taskGroup1);
+
+	std::mutex mutex;
+	std::vector<int> order;
+	std::vector<std::future<void>> futures;
+
+	auto recordTask = [&mutex, &order](int value)
+	{
+		return [&mutex, &order, value]
+		{
+			std::scoped_lock lock(mutex);
+			order.push_back(value);
+		};
+	};
+
+	// Priorities apply across groups. Within a priority, tasks are run in the order they were
+	// queued.
+	futures.push_back(taskGroup1.Push(recordTask(1), TaskPriority::Low));
+	futures.push_back(taskGroup2.Push(recordTask(2), TaskPriority::Normal));
+	futures.push_back(taskGroup1.Push(recordTask(3), TaskPriority::High));
+	futures.push_back(taskGroup2.Push(recordTask(4), TaskPriority::Normal));
+	futures.push_back(taskGroup2.Push(recordTask(5), TaskPriority::High));
+
+	releasePromise.set_value();
+
+	for (auto &future : futures)
+	{
+		future.get();
+	}
+
+	EXPECT_THAT(order, ElementsAre(3, 5, 2, 4, 1));
+}
+
+TEST_F(BackgroundWorkPoolTest, CancelPendingTasks)
+{
+	CreateWorkPool(1);
+	TaskGroup taskGroup1(m_workPool.get());
+	TaskGroup taskGroup2(m_workPool.get());
+
+	std::promise<void> startedPromise;
+	auto runningFuture = taskGroup1.Push(
+		[&startedPromise](std::stop_token stopToken)
+		{
+			startedPromise.set_value();
+
+			while (!stopToken.stop_requested())
+			{
+				std::this_thread::yield();
+			}
+
+			return true;
+		});
+	startedPromise.get_future().wait();
+
+	auto cancelledFuture = taskGroup1.Push([] { return 1; });
+	auto otherGroupFuture = taskGroup2.Push([] { return 2; });
+
+	taskGroup1.CancelPendingTasks();
+
+	// The running task should have been signaled to stop and the queued task should have been
+	// removed. The task from the other group should be unaffected.
+	EXPECT_TRUE(runningFuture.get());
+	EXPECT_THROW(cancelledFuture.get(), std::future_error);
+	EXPECT_EQ(otherGroupFuture.get(), 2);
+
+	// Tasks queued after the cancellation should run normally.
+	auto future = taskGroup1.Push([](std::stop_token stopToken)
+		{ return stopToken.stop_requested(); });
+	EXPECT_FALSE(future.get());
+}
+
+TEST_F(BackgroundWorkPoolTest, DestructionWaitsForRunningTasks)
+{
+	CreateWorkPool(1);
+	auto taskGroup = std::make_unique<TaskGroup>(m_workPool.get());
+
+	std::promise<void> startedPromise;
+	std::atomic_bool finished = false;
+	taskGroup->Push(
+		[&startedPromise, &finished]
+		{
+			startedPromise.set_value();
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			finished = true;
+		});
+	startedPromise.get_future().wait();
+
+	taskGroup.reset();
+	EXPECT_TRUE(finished);
+}
+
+TEST_F(BackgroundWorkPoolTest, TasksRunConcurrently)
+{
+	constexpr int NUM_TASKS = 4;
+
+	CreateWorkPool(NUM_TASKS);
+	TaskGroup taskGroup(m_workPool.get());
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	int numStarted = 0;
+	std::vector<std::future<bool>> futures;
+
+	// Each task waits for all the other tasks to start, which will only happen if the tasks from
+	// a single group are spread across multiple threads.
+	for (int i = 0; i < NUM_TASKS; i++)
+	{
+		futures.push_back(taskGroup.Push(
+			[&mutex, &condition, &numStarted]
+			{
+				std::unique_lock lock(mutex);
+				numStarted++;
+				condition.notify_all();
+				return condition.wait_for(lock, TASK_TIMEOUT_DURATION,
+					[&numStarted] { return numStarted == NUM_TASKS; });
+			}));
+	}
+
+	for (auto &future : futures)
+	{
+		EXPECT_TRUE(future.get());
+	}
+}
+
+TEST_F(BackgroundWorkPoolTest, RunConcurrently)
+{
+	constexpr int NUM_FUNCS = 100;
+
+	CreateWorkPool(4);
+
+	std::vector<std::atomic_int> numCalls(NUM_FUNCS);
+	std::vector<std::function<void()>> funcs;
+
+	for (int i = 0; i < NUM_FUNCS; i++)
+	{
+		funcs.emplace_back([&numCalls, i] { numCalls[i]++; });
+	}
+
+	RunConcurrently(m_workPool.get(), funcs);
+
+	for (const auto &count : numCalls)
+	{
+		EXPECT_EQ(count, 1);
+	}
+}
+
+TEST_F(BackgroundWorkPoolTest, RunConcurrentlyWhenPoolBusy)
+{
+	CreateWorkPool(2);
+	TaskGroup taskGroup(m_workPool.get());
+
+	auto releasePromise1 = BlockWorkPool(taskGroup);
+	auto releasePromise2 = BlockWorkPool(taskGroup);
+
+	// Every pool thread is busy, so every function should be run on the calling thread, rather
+	// than the call waiting for the pool to become free.
+	auto callingThreadId = std::this_thread::get_id();
+	std::vector<std::thread::id> threadIds(4);
+	std::vector<std::function<void()>> funcs;
+
+	for (auto &threadId : threadIds)
+	{
+		funcs.emplace_back([&threadId] { threadId = std::this_thread::get_id(); });
+	}
+
+	RunConcurrently(m_workPool.get(), funcs);
+
+	EXPECT_THAT(threadIds, Each(callingThreadId));
+
+	releasePromise1.set_value();
+	releasePromise2.set_value();
+}
+
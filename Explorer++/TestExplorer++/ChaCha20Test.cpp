@@ -0,0 +1,97 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/ChaCha20.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::vector<std::byte> HexToBytes(const std::string &hex)
+{
+	std::vector<std::byte> bytes;
+
+	for (size_t i = 0; i + 1 < hex.size(); i += 2)
+	{
+		bytes.push_back(static_cast<std::byte>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+	}
+
+	return bytes;
+}
+
+std::vector<std::byte> Generate(ChaCha20 &chaCha20, size_t size)
+{
+	std::vector<std::byte> output(size);
+	chaCha20.Generate(output);
+	return output;
+}
+
+ChaCha20::Key MakeSequentialKey()
+{
+	ChaCha20::Key key;
+
+	for (size_t i = 0; i < key.size(); i++)
+	{
+		key[i] = static_cast<std::byte>(i);
+	}
+
+	return key;
+}
+
+}
+
+TEST(ChaCha20Test, ZeroKey)
+{
+	ChaCha20 chaCha20({});
+	EXPECT_EQ(Generate(chaCha20, 128),
+		HexToBytes("76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+				   "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586"
+				   "9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+				   "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f"));
+}
+
+TEST(ChaCha20Test, InitialCounter)
+{
+	ChaCha20 chaCha20({}, {}, 1);
+	EXPECT_EQ(Generate(chaCha20, 64),
+		HexToBytes("9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+				   "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f"));
+}
+
+TEST(ChaCha20Test, KeyAndNonce)
+{
+	// This corresponds to the keystream used in the encryption example in RFC 8439, section 2.4.2.
+	ChaCha20::Nonce nonce = {};
+	nonce[3] = std::byte{ 0x4a };
+
+	ChaCha20 chaCha20(MakeSequentialKey(), nonce, 1);
+	EXPECT_EQ(Generate(chaCha20, 128),
+		HexToBytes("224f51f3401bd9e12fde276fb8631ded8c131f823d2c06e27e4fcaec9ef3cf78"
+				   "8a3b0aa372600a92b57974cded2b9334794cba40c63e34cdea212c4cf07d41b7"
+				   "69a6749f3f630f4122cafe28ec4dc47e26d4346d70b98c73f3e9c53ac40c5945"
+				   "398b6eda1a832c89c167eacd901d7e2bf363740373201aa188fbbce83991c4ed"));
+}
+
+TEST(ChaCha20Test, GenerateInPieces)
+{
+	ChaCha20 referenceChaCha20(MakeSequentialKey());
+	auto expected = Generate(referenceChaCha20, 1000);
+
+	for (size_t pieceSize : { 1, 7, 63, 64, 65, 200 })
+	{
+		ChaCha20 chaCha20(MakeSequentialKey());
+		std::vector<std::byte> output;
+
+		while (output.size() < expected.size())
+		{
+			auto piece = Generate(chaCha20, std::min(pieceSize, expected.size() - output.size()));
+			output.insert(output.end(), piece.begin(), piece.end());
+		}
+
+		EXPECT_EQ(output, expected) << "Piece size: " << pieceSize;
+	}
+}
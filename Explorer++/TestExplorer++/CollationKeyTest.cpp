@@ -0,0 +1,155 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/CollationKey.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+
+namespace
+{
+
+int Sign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+// Generates names that resemble typical file names, with a mix of upper and lowercase letters,
+// runs of digits (with and without leading zeros), punctuation and non-ASCII characters.
+std::vector<std::wstring> GenerateCorpus(size_t size)
+{
+	const std::wstring letters = L"abcdeFGHIJxyzXYZ\u00e9\u00c9\u00fc\u00dc\u00df\u00f8\u00c5";
+	const std::wstring punctuation = L" ._-()[]'&+~";
+
+	std::mt19937 generator(1234);
+	std::vector<std::wstring> corpus;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		std::wstring name;
+		int numParts = std::uniform_int_distribution<int>(1, 5)(generator);
+
+		for (int j = 0; j < numParts; j++)
+		{
+			switch (std::uniform_int_distribution<int>(0, 3)(generator))
+			{
+			case 0:
+			case 1:
+			{
+				int length = std::uniform_int_distribution<int>(1, 4)(generator);
+
+				for (int k = 0; k < length; k++)
+				{
+					name += letters[std::uniform_int_distribution<size_t>(0, letters.size() - 1)(
+						generator)];
+				}
+			}
+			break;
+
+			case 2:
+			{
+				int length = std::uniform_int_distribution<int>(1, 12)(generator);
+
+				for (int k = 0; k < length; k++)
+				{
+					name += static_cast<wchar_t>(
+						L'0' + std::uniform_int_distribution<int>(0, 9)(generator));
+				}
+			}
+			break;
+
+			case 3:
+				name += punctuation[std::uniform_int_distribution<size_t>(0,
+					punctuation.size() - 1)(generator)];
+				break;
+			}
+		}
+
+		corpus.push_back(name);
+	}
+
+	// Names that only differ in case or in the digits they contain are the most likely to be
+	// ordered incorrectly, so some specific cases are included as well.
+	std::vector<std::wstring> specificNames = { L"file1", L"file01", L"file001", L"File1",
+		L"file2", L"file10", L"file9", L"file10a", L"file10A", L"file 10", L"file1.txt",
+		L"file1 (2).txt", L"file1 (10).txt", L"4294967296", L"4294967295", L"a", L"A", L"", L"1",
+		L"01", L"_", L"-a", L"a-b", L"ab" };
+	corpus.insert(corpus.end(), specificNames.begin(), specificNames.end());
+
+	return corpus;
+}
+
+void CheckMatchesReference(CollationKey::Type type,
+	std::function<int(const wchar_t *, const wchar_t *)> referenceComparison)
+{
+	auto corpus = GenerateCorpus(2000);
+
+	std::vector<CollationKey> keys;
+	keys.reserve(corpus.size());
+
+	for (const auto &name : corpus)
+	{
+		keys.emplace_back(name, type);
+	}
+
+	// Every pair is compared, so that any inconsistency with the reference ordering is detected.
+	for (size_t i = 0; i < corpus.size(); i++)
+	{
+		for (size_t j = 0; j < corpus.size(); j++)
+		{
+			int expected = Sign(referenceComparison(corpus[i].c_str(), corpus[j].c_str()));
+			int actual = keys[i].Compare(keys[j]);
+
+			ASSERT_EQ(actual, expected)
+				<< "Strings: \"" << corpus[i] << "\", \"" << corpus[j] << "\"";
+		}
+	}
+}
+
+}
+
+TEST(CollationKeyTest, NaturalMatchesStrCmpLogical)
+{
+	CheckMatchesReference(CollationKey::Type::Natural, StrCmpLogicalW);
+}
+
+TEST(CollationKeyTest, CaseInsensitiveMatchesStrCmpI)
+{
+	CheckMatchesReference(CollationKey::Type::CaseInsensitive, StrCmpIW);
+}
+
+TEST(CollationKeyTest, Natural)
+{
+	CollationKey key1(L"file2.txt", CollationKey::Type::Natural);
+	CollationKey key2(L"file10.txt", CollationKey::Type::Natural);
+	CollationKey key3(L"FILE10.TXT", CollationKey::Type::Natural);
+
+	EXPECT_LT(key1.Compare(key2), 0);
+	EXPECT_GT(key2.Compare(key1), 0);
+	EXPECT_EQ(key2.Compare(key3), 0);
+	EXPECT_EQ(key2, key3);
+}
+
+TEST(CollationKeyTest, CaseInsensitive)
+{
+	CollationKey key1(L"file2.txt", CollationKey::Type::CaseInsensitive);
+	CollationKey key2(L"file10.txt", CollationKey::Type::CaseInsensitive);
+	CollationKey key3(L"FILE10.TXT", CollationKey::Type::CaseInsensitive);
+
+	EXPECT_GT(key1.Compare(key2), 0);
+	EXPECT_EQ(key2.Compare(key3), 0);
+}
+
+TEST(CollationKeyTest, Empty)
+{
+	CollationKey emptyKey;
+	CollationKey emptyStringKey(L"", CollationKey::Type::Natural);
+	CollationKey key(L"a", CollationKey::Type::Natural);
+
+	EXPECT_EQ(emptyKey.Compare(emptyStringKey), 0);
+	EXPECT_LT(emptyKey.Compare(key), 0);
+	EXPECT_GT(key.Compare(emptyKey), 0);
+}
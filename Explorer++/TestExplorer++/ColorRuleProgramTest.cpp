@@ -0,0 +1,83 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ColorRuleProgram.h"
+#include "ColorRuleModel.h"
+#include <gtest/gtest.h>
+
+using namespace testing;
+
+class ColorRuleProgramTest : public Test
+{
+protected:
+	ColorRuleProgramTest()
+	{
+		m_model.AddItem(std::make_unique<ColorRule>(L"Compressed files", L"", false,
+			FILE_ATTRIBUTE_COMPRESSED, RGB(0, 116, 232)));
+		m_model.AddItem(std::make_unique<ColorRule>(L"C++ files", L"*.cpp: *.h", true, 0,
+			RGB(0, 0, 128)));
+		m_model.AddItem(std::make_unique<ColorRule>(L"Hidden text files", L"*.txt", false,
+			FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM, RGB(128, 128, 128)));
+	}
+
+	ColorRuleModel m_model;
+};
+
+TEST_F(ColorRuleProgramTest, Evaluate)
+{
+	ColorRuleProgram program(&m_model);
+	EXPECT_EQ(program.GetRuleCount(), 3u);
+
+	EXPECT_EQ(program.Evaluate(L"file.cpp", FILE_ATTRIBUTE_NORMAL), 1u);
+	EXPECT_EQ(program.Evaluate(L"FILE.H", FILE_ATTRIBUTE_NORMAL), 1u);
+	EXPECT_EQ(program.Evaluate(L"file.txt", FILE_ATTRIBUTE_NORMAL), std::nullopt);
+	EXPECT_EQ(program.Evaluate(L"file.txt", FILE_ATTRIBUTE_SYSTEM), 2u);
+	EXPECT_EQ(program.Evaluate(L"file.TXT", FILE_ATTRIBUTE_HIDDEN), std::nullopt);
+
+	// The first matching rule should be returned.
+	EXPECT_EQ(program.Evaluate(L"file.cpp", FILE_ATTRIBUTE_COMPRESSED), 0u);
+
+	EXPECT_EQ(program.GetColor(0), RGB(0, 116, 232));
+	EXPECT_EQ(program.GetColor(1), RGB(0, 0, 128));
+	EXPECT_EQ(program.GetColor(2), RGB(128, 128, 128));
+}
+
+TEST_F(ColorRuleProgramTest, UnknownAttributes)
+{
+	ColorRuleProgram program(&m_model);
+
+	// Rules that depend on attributes can't match an item whose attributes aren't known.
+	EXPECT_EQ(program.Evaluate(L"file.cpp", std::nullopt), 1u);
+	EXPECT_EQ(program.Evaluate(L"file.txt", std::nullopt), std::nullopt);
+}
+
+TEST_F(ColorRuleProgramTest, Empty)
+{
+	ColorRuleModel model;
+	ColorRuleProgram program(&model);
+	EXPECT_EQ(program.GetRuleCount(), 0u);
+	EXPECT_EQ(program.Evaluate(L"file.cpp", FILE_ATTRIBUTE_NORMAL), std::nullopt);
+
+	ColorRuleProgram defaultProgram;
+	EXPECT_EQ(defaultProgram.Evaluate(L"file.cpp", FILE_ATTRIBUTE_NORMAL), std::nullopt);
+}
+
+TEST_F(ColorRuleProgramTest, Snapshot)
+{
+	ColorRuleProgram program(&m_model);
+
+	// The program is a snapshot of the rules at the point it was built, so later changes to the
+	// model shouldn't affect it.
+	m_model.GetItemAtIndex(1)->SetFilterPattern(L"*.txt");
+	m_model.RemoveItem(m_model.GetItemAtIndex(0));
+
+	EXPECT_EQ(program.GetRuleCount(), 3u);
+	EXPECT_EQ(program.Evaluate(L"file.cpp", FILE_ATTRIBUTE_NORMAL), 1u);
+
+	ColorRuleProgram updatedProgram(&m_model);
+	EXPECT_EQ(updatedProgram.GetRuleCount(), 2u);
+	EXPECT_EQ(updatedProgram.Evaluate(L"file.cpp", FILE_ATTRIBUTE_NORMAL), std::nullopt);
+	EXPECT_EQ(updatedProgram.Evaluate(L"file.txt", FILE_ATTRIBUTE_NORMAL), 0u);
+}
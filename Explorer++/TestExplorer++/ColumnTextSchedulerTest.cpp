@@ -0,0 +1,231 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/ColumnTextScheduler.h"
+#include <gtest/gtest.h>
+
+using namespace testing;
+
+class ColumnTextSchedulerTest : public Test
+{
+protected:
+	bool AddRequest(int internalIndex, ColumnType columnType)
+	{
+		return m_scheduler.AddRequest(internalIndex, columnType,
+			[this]
+			{
+				m_numItemInfoRequests++;
+				return BasicItemInfo_t();
+			},
+			m_globalFolderSettings);
+	}
+
+	std::vector<int> PopAllTasks()
+	{
+		std::vector<int> order;
+
+		while (auto task = m_scheduler.PopTask())
+		{
+			order.push_back(task->internalIndex);
+		}
+
+		return order;
+	}
+
+	void CompleteTask(const ColumnTextScheduler::Task &task)
+	{
+		std::vector<ColumnTextScheduler::Result> results;
+
+		for (auto columnType : task.columnTypes)
+		{
+			results.emplace_back(task.internalIndex, columnType, L"Text");
+		}
+
+		m_scheduler.CompleteTask(task, std::move(results));
+	}
+
+	ColumnTextScheduler m_scheduler;
+	GlobalFolderSettings m_globalFolderSettings;
+	int m_numItemInfoRequests = 0;
+};
+
+TEST_F(ColumnTextSchedulerTest, Deduplication)
+{
+	EXPECT_TRUE(AddRequest(1, ColumnType::Size));
+	EXPECT_FALSE(AddRequest(1, ColumnType::Size));
+	EXPECT_FALSE(AddRequest(1, ColumnType::Size));
+
+	auto metrics = m_scheduler.GetMetrics();
+	EXPECT_EQ(metrics.queueDepth, 1U);
+	EXPECT_EQ(metrics.requestsReceived, 3U);
+	EXPECT_EQ(metrics.duplicatesDropped, 2U);
+
+	// The column is still outstanding while the task is running.
+	auto task = m_scheduler.PopTask();
+	ASSERT_TRUE(task);
+	EXPECT_FALSE(AddRequest(1, ColumnType::Size));
+
+	CompleteTask(*task);
+	EXPECT_FALSE(AddRequest(1, ColumnType::Size));
+
+	// Once the result has been handed back, the column can be requested again.
+	m_scheduler.TakeResults();
+	EXPECT_TRUE(AddRequest(1, ColumnType::Size));
+}
+
+TEST_F(ColumnTextSchedulerTest, ColumnsForItemCombined)
+{
+	EXPECT_TRUE(AddRequest(1, ColumnType::Size));
+	EXPECT_FALSE(AddRequest(1, ColumnType::Type));
+	EXPECT_FALSE(AddRequest(1, ColumnType::DateModified));
+	EXPECT_TRUE(AddRequest(2, ColumnType::Type));
+
+	// The item information should only be retrieved once per task.
+	EXPECT_EQ(m_numItemInfoRequests, 2);
+
+	auto task1 = m_scheduler.PopTask();
+	ASSERT_TRUE(task1);
+	EXPECT_EQ(task1->internalIndex, 2);
+	EXPECT_THAT(task1->columnTypes, ElementsAre(ColumnType::Type));
+
+	auto task2 = m_scheduler.PopTask();
+	ASSERT_TRUE(task2);
+	EXPECT_EQ(task2->internalIndex, 1);
+	EXPECT_THAT(task2->columnTypes,
+		ElementsAre(ColumnType::Size, ColumnType::Type, ColumnType::DateModified));
+
+	EXPECT_FALSE(m_scheduler.PopTask());
+}
+
+TEST_F(ColumnTextSchedulerTest, Priority)
+{
+	for (int i = 0; i < 5; i++)
+	{
+		AddRequest(i, ColumnType::Size);
+	}
+
+	// Requesting an item that's already queued should move it to the front.
+	AddRequest(1, ColumnType::Size);
+	AddRequest(3, ColumnType::Type);
+
+	EXPECT_THAT(PopAllTasks(), ElementsAre(3, 1, 4, 2, 0));
+
+	for (int i = 0; i < 5; i++)
+	{
+		AddRequest(i + 10, ColumnType::Size);
+	}
+
+	// Visible items should be run first, regardless of when they were requested.
+	m_scheduler.SetVisibleItems({ 10, 12 });
+	AddRequest(15, ColumnType::Size);
+
+	EXPECT_THAT(PopAllTasks(), ElementsAre(12, 10, 15, 14, 13, 11));
+}
+
+TEST_F(ColumnTextSchedulerTest, ResultsBatched)
+{
+	AddRequest(1, ColumnType::Size);
+	AddRequest(2, ColumnType::Size);
+	AddRequest(3, ColumnType::Size);
+
+	auto task1 = m_scheduler.PopTask();
+	auto task2 = m_scheduler.PopTask();
+	auto task3 = m_scheduler.PopTask();
+	ASSERT_TRUE(task1 && task2 && task3);
+
+	// Only the first result in a batch should require a notification.
+	EXPECT_TRUE(m_scheduler.CompleteTask(*task1, { { 3, ColumnType::Size, L"3" } }));
+	EXPECT_FALSE(m_scheduler.CompleteTask(*task2, { { 2, ColumnType::Size, L"2" } }));
+
+	auto results = m_scheduler.TakeResults();
+	ASSERT_EQ(results.size(), 2U);
+	EXPECT_EQ(results[0].internalIndex, 3);
+	EXPECT_EQ(results[0].columnText, L"3");
+	EXPECT_EQ(results[1].internalIndex, 2);
+	EXPECT_EQ(results[1].columnText, L"2");
+
+	EXPECT_TRUE(m_scheduler.CompleteTask(*task3, { { 1, ColumnType::Size, L"1" } }));
+	EXPECT_EQ(m_scheduler.TakeResults().size(), 1U);
+	EXPECT_TRUE(m_scheduler.TakeResults().empty());
+
+	auto metrics = m_scheduler.GetMetrics();
+	EXPECT_EQ(metrics.queueDepth, 0U);
+	EXPECT_LE(metrics.latencyP50, metrics.latencyP90);
+	EXPECT_LE(metrics.latencyP90, metrics.latencyP99);
+}
+
+TEST_F(ColumnTextSchedulerTest, Clear)
+{
+	AddRequest(1, ColumnType::Size);
+	AddRequest(2, ColumnType::Size);
+
+	auto task = m_scheduler.PopTask();
+	ASSERT_TRUE(task);
+
+	m_scheduler.Clear();
+	EXPECT_FALSE(m_scheduler.PopTask());
+
+	// The task was started in a previous generation, so its results should be discarded.
+	CompleteTask(*task);
+	EXPECT_TRUE(m_scheduler.TakeResults().empty());
+
+	EXPECT_TRUE(AddRequest(task->internalIndex, ColumnType::Size));
+
+	auto metrics = m_scheduler.GetMetrics();
+	EXPECT_EQ(metrics.queueDepth, 1U);
+	EXPECT_EQ(metrics.requestsReceived, 1U);
+	EXPECT_EQ(metrics.duplicatesDropped, 0U);
+}
+
+TEST_F(ColumnTextSchedulerTest, InvalidateItem)
+{
+	AddRequest(1, ColumnType::Size);
+	AddRequest(2, ColumnType::Size);
+
+	auto staleTask = m_scheduler.PopTask();
+	ASSERT_TRUE(staleTask);
+	ASSERT_EQ(staleTask->internalIndex, 2);
+
+	m_scheduler.InvalidateItem(1);
+	m_scheduler.InvalidateItem(2);
+
+	// Item 1 was still queued, so its task should have been removed. The results from the task
+	// for item 2 were based on the old item information, so they should be discarded.
+	EXPECT_FALSE(m_scheduler.PopTask());
+	CompleteTask(*staleTask);
+	EXPECT_TRUE(m_scheduler.TakeResults().empty());
+
+	EXPECT_TRUE(AddRequest(1, ColumnType::Size));
+	EXPECT_TRUE(AddRequest(2, ColumnType::Size));
+
+	auto task = m_scheduler.PopTask();
+	ASSERT_TRUE(task);
+	CompleteTask(*task);
+	EXPECT_EQ(m_scheduler.TakeResults().size(), 1U);
+}
+
+TEST_F(ColumnTextSchedulerTest, InvalidateItemWithStoredResults)
+{
+	AddRequest(1, ColumnType::Size);
+	AddRequest(2, ColumnType::Size);
+
+	auto task1 = m_scheduler.PopTask();
+	auto task2 = m_scheduler.PopTask();
+	ASSERT_TRUE(task1 && task2);
+
+	CompleteTask(*task1);
+	CompleteTask(*task2);
+
+	// The results for item 1 have already been stored, but are now out of date, so they should be
+	// discarded. The results for item 2 should be unaffected.
+	m_scheduler.InvalidateItem(1);
+
+	auto results = m_scheduler.TakeResults();
+	ASSERT_EQ(results.size(), 1U);
+	EXPECT_EQ(results[0].internalIndex, 2);
+
+	// The column for item 1 is no longer outstanding, so it can be requested again.
+	EXPECT_TRUE(AddRequest(1, ColumnType::Size));
+}
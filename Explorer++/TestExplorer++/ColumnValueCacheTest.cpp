@@ -0,0 +1,280 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/ColumnValueCache.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <functional>
+
+using namespace testing;
+
+class ColumnValueCacheTest : public Test
+{
+protected:
+	// Large enough that none of the tests below will result in an eviction.
+	static constexpr uint64_t DEFAULT_CACHE_SIZE = 1024 * 1024;
+
+	ColumnValueCacheTest() :
+		m_filePath(std::filesystem::temp_directory_path() / L"ExplorerPlusPlusTest"
+			/ L"ColumnValueCacheTest.dat")
+	{
+	}
+
+	void SetUp() override
+	{
+		std::filesystem::remove_all(m_filePath.parent_path());
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(m_filePath.parent_path());
+	}
+
+	static ColumnValueCache::Key BuildKey(const std::wstring &path, uint64_t size,
+		uint64_t lastWriteTime, ColumnType columnType)
+	{
+		WIN32_FIND_DATA findData = {};
+		findData.nFileSizeHigh = static_cast<DWORD>(size >> 32);
+		findData.nFileSizeLow = static_cast<DWORD>(size);
+		findData.ftLastWriteTime.dwHighDateTime = static_cast<DWORD>(lastWriteTime >> 32);
+		findData.ftLastWriteTime.dwLowDateTime = static_cast<DWORD>(lastWriteTime);
+		return ColumnValueCache::BuildKey(path, findData, columnType);
+	}
+
+	const std::filesystem::path m_filePath;
+};
+
+TEST_F(ColumnValueCacheTest, IsColumnCacheable)
+{
+	EXPECT_TRUE(ColumnValueCache::IsColumnCacheable(ColumnType::FileVersion));
+	EXPECT_TRUE(ColumnValueCache::IsColumnCacheable(ColumnType::CameraModel));
+	EXPECT_TRUE(ColumnValueCache::IsColumnCacheable(ColumnType::MediaAlbumArtist));
+	EXPECT_TRUE(ColumnValueCache::IsColumnCacheable(ColumnType::MediaYear));
+
+	// The text for these columns is formatted from a numeric value, so it isn't cached.
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::Width));
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::MediaBitrate));
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::MediaDuration));
+
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::Name));
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::Size));
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::Owner));
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::HardLinks));
+	EXPECT_FALSE(ColumnValueCache::IsColumnCacheable(ColumnType::PrinterModel));
+}
+
+TEST_F(ColumnValueCacheTest, GetValue)
+{
+	ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+
+	auto key = BuildKey(L"C:\\file.exe", 100, 200, ColumnType::FileVersion);
+	EXPECT_EQ(cache.MaybeGetValue(key), std::nullopt);
+
+	cache.SetValue(key, L"1.0.0.0");
+	EXPECT_EQ(cache.MaybeGetValue(key), L"1.0.0.0");
+
+	cache.SetValue(key, L"2.0.0.0");
+	EXPECT_EQ(cache.MaybeGetValue(key), L"2.0.0.0");
+
+	// Empty values should be cached as well, since they're just as expensive to retrieve.
+	auto emptyKey = BuildKey(L"C:\\file.txt", 100, 200, ColumnType::FileVersion);
+	cache.SetValue(emptyKey, L"");
+	EXPECT_EQ(cache.MaybeGetValue(emptyKey), L"");
+}
+
+TEST_F(ColumnValueCacheTest, Invalidation)
+{
+	ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+
+	cache.SetValue(BuildKey(L"C:\\file.exe", 100, 200, ColumnType::FileVersion), L"1.0.0.0");
+	ASSERT_TRUE(cache.Save());
+
+	for (int i = 0; i < 2; i++)
+	{
+		// Any change to the file should result in a cache miss.
+		EXPECT_EQ(cache.MaybeGetValue(BuildKey(L"C:\\file.exe", 101, 200, ColumnType::FileVersion)),
+			std::nullopt);
+		EXPECT_EQ(cache.MaybeGetValue(BuildKey(L"C:\\file.exe", 100, 201, ColumnType::FileVersion)),
+			std::nullopt);
+		EXPECT_EQ(cache.MaybeGetValue(BuildKey(L"C:\\file.exe", 100, 200, ColumnType::Company)),
+			std::nullopt);
+		EXPECT_EQ(
+			cache.MaybeGetValue(BuildKey(L"C:\\file2.exe", 100, 200, ColumnType::FileVersion)),
+			std::nullopt);
+
+		// The lookup should work the same way, regardless of whether the entry is held in memory
+		// or in the mapped file.
+		cache.SetValue(BuildKey(L"C:\\other.exe", 100, 200, ColumnType::FileVersion), L"3.0.0.0");
+	}
+}
+
+TEST_F(ColumnValueCacheTest, Persistence)
+{
+	auto key1 = BuildKey(L"C:\\file1.exe", 100, 200, ColumnType::FileVersion);
+	auto key2 = BuildKey(L"C:\\file2.mp3", 300, 400, ColumnType::MediaAlbumArtist);
+
+	{
+		ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+		cache.SetValue(key1, L"1.0.0.0");
+		ASSERT_TRUE(cache.Save());
+
+		// Entries should still be available after the cache has been saved.
+		EXPECT_EQ(cache.MaybeGetValue(key1), L"1.0.0.0");
+
+		cache.SetValue(key2, L"Artist");
+		ASSERT_TRUE(cache.Save());
+	}
+
+	ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+	EXPECT_EQ(cache.MaybeGetValue(key1), L"1.0.0.0");
+	EXPECT_EQ(cache.MaybeGetValue(key2), L"Artist");
+
+	// Updating a value that's in the mapped file should take precedence over the existing value.
+	cache.SetValue(key1, L"1.0.0.1");
+	EXPECT_EQ(cache.MaybeGetValue(key1), L"1.0.0.1");
+	ASSERT_TRUE(cache.Save());
+
+	ColumnValueCache reloadedCache(m_filePath, DEFAULT_CACHE_SIZE);
+	EXPECT_EQ(reloadedCache.MaybeGetValue(key1), L"1.0.0.1");
+}
+
+TEST_F(ColumnValueCacheTest, Eviction)
+{
+	const std::wstring value(100, 'a');
+
+	// Each entry is made up of a 48 byte record and the text. The file also has a 24 byte header.
+	// This is enough space for two entries.
+	uint64_t cacheSize = 24 + 2 * (48 + value.size() * sizeof(wchar_t));
+
+	auto key1 = BuildKey(L"C:\\file1.exe", 100, 200, ColumnType::FileVersion);
+	auto key2 = BuildKey(L"C:\\file2.exe", 100, 200, ColumnType::FileVersion);
+	auto key3 = BuildKey(L"C:\\file3.exe", 100, 200, ColumnType::FileVersion);
+
+	{
+		ColumnValueCache cache(m_filePath, cacheSize);
+		cache.SetValue(key1, value);
+		cache.SetValue(key2, value);
+		ASSERT_TRUE(cache.Save());
+	}
+
+	{
+		// The access times are persisted, so the entry that's accessed here should be retained,
+		// even though it was added first.
+		ColumnValueCache cache(m_filePath, cacheSize);
+		EXPECT_EQ(cache.MaybeGetValue(key1), value);
+		cache.SetValue(key3, value);
+		ASSERT_TRUE(cache.Save());
+
+		EXPECT_EQ(cache.MaybeGetValue(key1), value);
+		EXPECT_EQ(cache.MaybeGetValue(key2), std::nullopt);
+		EXPECT_EQ(cache.MaybeGetValue(key3), value);
+	}
+
+	EXPECT_LE(std::filesystem::file_size(m_filePath), cacheSize);
+}
+
+TEST_F(ColumnValueCacheTest, CorruptFile)
+{
+	std::filesystem::create_directories(m_filePath.parent_path());
+
+	{
+		std::ofstream file(m_filePath, std::ios::binary);
+		file << "This isn't a valid cache file";
+	}
+
+	// An invalid file should be ignored, and then replaced once the cache is saved.
+	ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+
+	auto key = BuildKey(L"C:\\file.exe", 100, 200, ColumnType::FileVersion);
+	EXPECT_EQ(cache.MaybeGetValue(key), std::nullopt);
+
+	cache.SetValue(key, L"1.0.0.0");
+	ASSERT_TRUE(cache.Save());
+
+	ColumnValueCache reloadedCache(m_filePath, DEFAULT_CACHE_SIZE);
+	EXPECT_EQ(reloadedCache.MaybeGetValue(key), L"1.0.0.0");
+}
+
+// The file below has a valid header, but the entries themselves are invalid. In each case, the
+// whole file should be ignored.
+TEST_F(ColumnValueCacheTest, InvalidEntries)
+{
+	// Offsets within the file. The header is 24 bytes and each entry is 48 bytes.
+	constexpr size_t NUM_ENTRIES_OFFSET = 8;
+	constexpr size_t FIRST_ENTRY_OFFSET = 24;
+	constexpr size_t ENTRY_SIZE = 48;
+	constexpr size_t TEXT_OFFSET_OFFSET = 32;
+
+	auto key1 = BuildKey(L"C:\\file1.exe", 100, 200, ColumnType::FileVersion);
+	auto key2 = BuildKey(L"C:\\file2.exe", 100, 200, ColumnType::FileVersion);
+	auto key3 = BuildKey(L"C:\\file3.exe", 100, 200, ColumnType::FileVersion);
+
+	auto writeCache = [&]()
+	{
+		ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+		cache.SetValue(key1, L"1.0.0.0");
+		cache.SetValue(key2, L"2.0.0.0");
+		cache.SetValue(key3, L"3.0.0.0");
+		ASSERT_TRUE(cache.Save());
+	};
+
+	auto modifyFile = [this](const std::function<void(std::string &)> &modification)
+	{
+		std::string data;
+
+		{
+			std::ifstream file(m_filePath, std::ios::binary);
+			data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+
+		modification(data);
+
+		std::ofstream file(m_filePath, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size());
+	};
+
+	auto expectIgnored = [&]()
+	{
+		ColumnValueCache cache(m_filePath, DEFAULT_CACHE_SIZE);
+		EXPECT_EQ(cache.MaybeGetValue(key1), std::nullopt);
+		EXPECT_EQ(cache.MaybeGetValue(key2), std::nullopt);
+		EXPECT_EQ(cache.MaybeGetValue(key3), std::nullopt);
+	};
+
+	// More entries than the file can hold.
+	writeCache();
+	modifyFile(
+		[](std::string &data)
+		{
+			uint64_t numEntries = 1000;
+			data.replace(NUM_ENTRIES_OFFSET, sizeof(numEntries),
+				reinterpret_cast<const char *>(&numEntries), sizeof(numEntries));
+		});
+	expectIgnored();
+
+	// Entries that aren't sorted. Only the first two entries are swapped, so the last entry could
+	// still be found by a binary search.
+	writeCache();
+	modifyFile(
+		[](std::string &data)
+		{
+			auto firstEntry = data.substr(FIRST_ENTRY_OFFSET, ENTRY_SIZE);
+			auto secondEntry = data.substr(FIRST_ENTRY_OFFSET + ENTRY_SIZE, ENTRY_SIZE);
+			data.replace(FIRST_ENTRY_OFFSET, ENTRY_SIZE, secondEntry);
+			data.replace(FIRST_ENTRY_OFFSET + ENTRY_SIZE, ENTRY_SIZE, firstEntry);
+		});
+	expectIgnored();
+
+	// An entry whose text is outside the file.
+	writeCache();
+	modifyFile(
+		[](std::string &data)
+		{
+			uint64_t textOffset = 1'000'000;
+			data.replace(FIRST_ENTRY_OFFSET + TEXT_OFFSET_OFFSET, sizeof(textOffset),
+				reinterpret_cast<const char *>(&textOffset), sizeof(textOffset));
+		});
+	expectIgnored();
+}
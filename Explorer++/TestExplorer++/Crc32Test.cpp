@@ -0,0 +1,56 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/Crc32.h"
+#include <gtest/gtest.h>
+#include <string_view>
+
+namespace
+{
+
+uint32_t CalculateCrc(std::string_view text)
+{
+	Crc32 crc;
+	crc.Update(std::as_bytes(std::span(text.data(), text.size())));
+	return crc.GetValue();
+}
+
+}
+
+TEST(Crc32Test, Empty)
+{
+	EXPECT_EQ(Crc32().GetValue(), 0u);
+	EXPECT_EQ(CalculateCrc(""), 0u);
+}
+
+TEST(Crc32Test, KnownValues)
+{
+	EXPECT_EQ(CalculateCrc("123456789"), 0xCBF43926u);
+	EXPECT_EQ(CalculateCrc("a"), 0xE8B7BE43u);
+	EXPECT_EQ(CalculateCrc("The quick brown fox jumps over the lazy dog"), 0x414FA339u);
+}
+
+TEST(Crc32Test, Incremental)
+{
+	std::vector<std::byte> data(1000);
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<std::byte>((i * 31) % 251);
+	}
+
+	Crc32 expectedCrc;
+	expectedCrc.Update(data);
+
+	// Splitting the data at every possible point covers both the 8-byte and single-byte paths, on
+	// either side of the split.
+	for (size_t split = 0; split <= data.size(); split++)
+	{
+		Crc32 crc;
+		crc.Update(std::span(data).first(split));
+		crc.Update(std::span(data).subspan(split));
+		EXPECT_EQ(crc.GetValue(), expectedCrc.GetValue());
+	}
+}
@@ -0,0 +1,179 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/DirectoryChangeCollapser.h"
+#include <gtest/gtest.h>
+
+using namespace testing;
+
+using Type = DirectoryChange::Type;
+
+TEST(DirectoryChangeCollapserTest, IndependentChanges)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemAdded(L"a");
+	collapser.ItemRemoved(L"b");
+	collapser.ItemModified(L"c");
+	collapser.ItemRenamed(L"d", L"e");
+
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Added, L"a" }, DirectoryChange{ Type::Removed, L"b" },
+			DirectoryChange{ Type::Modified, L"c" }, DirectoryChange{ Type::Renamed, L"e", L"d" }));
+	EXPECT_EQ(collapser.GetNumEvents(), 4);
+}
+
+TEST(DirectoryChangeCollapserTest, AddThenRemove)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemAdded(L"a");
+	collapser.ItemModified(L"a");
+	collapser.ItemModified(L"b");
+	collapser.ItemRemoved(L"a");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Modified, L"b" }));
+	EXPECT_EQ(collapser.GetNumEvents(), 4);
+}
+
+TEST(DirectoryChangeCollapserTest, RemoveThenAdd)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemRemoved(L"a");
+	collapser.ItemAdded(L"a");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Modified, L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, RepeatedModifications)
+{
+	DirectoryChangeCollapser collapser;
+
+	for (int i = 0; i < 10; i++)
+	{
+		collapser.ItemModified(L"a");
+	}
+
+	collapser.ItemRemoved(L"b");
+	collapser.ItemRemoved(L"b");
+
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Modified, L"a" },
+			DirectoryChange{ Type::Removed, L"b" }));
+	EXPECT_EQ(collapser.GetNumEvents(), 12);
+}
+
+TEST(DirectoryChangeCollapserTest, ModifyThenRemove)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemModified(L"a");
+	collapser.ItemRemoved(L"a");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Removed, L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, RenameAddedItem)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemAdded(L"a");
+	collapser.ItemRenamed(L"a", L"b");
+	collapser.ItemModified(L"b");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Added, L"b" }));
+}
+
+TEST(DirectoryChangeCollapserTest, RenameModifiedItem)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemModified(L"a");
+	collapser.ItemRenamed(L"a", L"b");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Renamed, L"b", L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, ChainedRenames)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemRenamed(L"a", L"b");
+	collapser.ItemRenamed(L"b", L"c");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Renamed, L"c", L"a" }));
+
+	// Renaming the item back to its original name should leave the item in place.
+	collapser.ItemRenamed(L"c", L"a");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Modified, L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, RenameThenRemove)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemRenamed(L"a", L"b");
+	collapser.ItemRemoved(L"b");
+
+	// The item is still listed under its original name, so that's the item that needs to be
+	// removed.
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Removed, L"a" }));
+
+	collapser.ItemAdded(L"a");
+
+	EXPECT_THAT(collapser.GetChanges(), ElementsAre(DirectoryChange{ Type::Modified, L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, NameReusedAfterRename)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemRenamed(L"a", L"b");
+	collapser.ItemAdded(L"a");
+	collapser.ItemRemoved(L"b");
+
+	// The changes refer to two different items with the same name, so they need to be kept
+	// separate (and in order).
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Removed, L"a" }, DirectoryChange{ Type::Added, L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, RenameOverRemovedItem)
+{
+	// This is the sequence of changes that results from a file being saved via a temporary file.
+	DirectoryChangeCollapser collapser;
+	collapser.ItemAdded(L"file.tmp");
+	collapser.ItemModified(L"file.tmp");
+	collapser.ItemRemoved(L"file.txt");
+	collapser.ItemRenamed(L"file.tmp", L"file.txt");
+
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Modified, L"file.txt" }));
+	EXPECT_EQ(collapser.GetNumEvents(), 4);
+}
+
+TEST(DirectoryChangeCollapserTest, RenameOverRemovedItemWithExistingSource)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemRemoved(L"b");
+	collapser.ItemRenamed(L"a", L"b");
+
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Modified, L"b" },
+			DirectoryChange{ Type::Removed, L"a" }));
+}
+
+TEST(DirectoryChangeCollapserTest, RenameRemovedItem)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemRemoved(L"a");
+	collapser.ItemRenamed(L"a", L"b");
+
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Removed, L"a" }, DirectoryChange{ Type::Added, L"b" }));
+}
+
+TEST(DirectoryChangeCollapserTest, NamesAreCaseSensitive)
+{
+	DirectoryChangeCollapser collapser;
+	collapser.ItemAdded(L"a");
+	collapser.ItemRemoved(L"A");
+
+	EXPECT_THAT(collapser.GetChanges(),
+		ElementsAre(DirectoryChange{ Type::Added, L"a" }, DirectoryChange{ Type::Removed, L"A" }));
+}
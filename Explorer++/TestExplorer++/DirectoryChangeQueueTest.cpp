@@ -0,0 +1,171 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/DirectoryChangeQueue.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace testing;
+
+namespace
+{
+
+MATCHER_P3(ChangeIs, action, folderId, name, "")
+{
+	return arg.action == static_cast<DWORD>(action) && arg.folderId == folderId
+		&& arg.name == name;
+}
+
+}
+
+TEST(DirectoryChangeQueueTest, Drain)
+{
+	DirectoryChangeQueue queue(8, 64);
+	EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, L"file1", 1));
+	EXPECT_TRUE(queue.Push(FILE_ACTION_REMOVED, L"file2", 2));
+	EXPECT_TRUE(queue.Push(FILE_ACTION_MODIFIED, L"", 3));
+
+	auto result = queue.Drain();
+	EXPECT_FALSE(result.overflowed);
+	EXPECT_THAT(result.changes,
+		ElementsAre(ChangeIs(FILE_ACTION_ADDED, 1, L"file1"),
+			ChangeIs(FILE_ACTION_REMOVED, 2, L"file2"), ChangeIs(FILE_ACTION_MODIFIED, 3, L"")));
+
+	result = queue.Drain();
+	EXPECT_FALSE(result.overflowed);
+	EXPECT_THAT(result.changes, IsEmpty());
+}
+
+TEST(DirectoryChangeQueueTest, WrapAround)
+{
+	DirectoryChangeQueue queue(4, 16);
+
+	// The record and name positions will both wrap around several times.
+	for (int i = 0; i < 20; i++)
+	{
+		auto name1 = L"a" + std::to_wstring(i);
+		auto name2 = L"file" + std::to_wstring(i);
+		EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, name1, i));
+		EXPECT_TRUE(queue.Push(FILE_ACTION_REMOVED, name2, i));
+
+		auto result = queue.Drain();
+		EXPECT_FALSE(result.overflowed);
+		EXPECT_THAT(result.changes,
+			ElementsAre(ChangeIs(FILE_ACTION_ADDED, i, name1),
+				ChangeIs(FILE_ACTION_REMOVED, i, name2)));
+	}
+}
+
+TEST(DirectoryChangeQueueTest, RecordOverflow)
+{
+	DirectoryChangeQueue queue(2, 64);
+	EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, L"file1", 1));
+	EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, L"file2", 1));
+	EXPECT_FALSE(queue.Push(FILE_ACTION_ADDED, L"file3", 1));
+
+	// The changes that were stored should still be returned.
+	auto result = queue.Drain();
+	EXPECT_TRUE(result.overflowed);
+	EXPECT_THAT(result.changes,
+		ElementsAre(ChangeIs(FILE_ACTION_ADDED, 1, L"file1"),
+			ChangeIs(FILE_ACTION_ADDED, 1, L"file2")));
+
+	// Once the queue has been drained, the overflow flag should be reset and there should be
+	// space for new changes.
+	EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, L"file4", 1));
+
+	result = queue.Drain();
+	EXPECT_FALSE(result.overflowed);
+	EXPECT_THAT(result.changes, ElementsAre(ChangeIs(FILE_ACTION_ADDED, 1, L"file4")));
+}
+
+TEST(DirectoryChangeQueueTest, NameOverflow)
+{
+	DirectoryChangeQueue queue(8, 8);
+	EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, L"abcde", 1));
+	EXPECT_FALSE(queue.Push(FILE_ACTION_ADDED, L"fghij", 1));
+	EXPECT_FALSE(queue.Push(FILE_ACTION_ADDED, L"name longer than the buffer", 1));
+
+	auto result = queue.Drain();
+	EXPECT_TRUE(result.overflowed);
+	EXPECT_THAT(result.changes, ElementsAre(ChangeIs(FILE_ACTION_ADDED, 1, L"abcde")));
+
+	EXPECT_TRUE(queue.Push(FILE_ACTION_ADDED, L"fghij", 1));
+
+	result = queue.Drain();
+	EXPECT_FALSE(result.overflowed);
+	EXPECT_THAT(result.changes, ElementsAre(ChangeIs(FILE_ACTION_ADDED, 1, L"fghij")));
+}
+
+TEST(DirectoryChangeQueueTest, MultipleProducers)
+{
+	constexpr int NUM_PRODUCERS = 4;
+	constexpr int NUM_CHANGES_PER_PRODUCER = 20000;
+
+	// The queue is large enough that it won't overflow, so long as the consumer is draining it.
+	// The queue is still much smaller than the total number of changes, though, so producers and
+	// the consumer will be contending with each other throughout.
+	DirectoryChangeQueue queue(1024, 16 * 1024);
+
+	std::atomic_bool start = false;
+	std::atomic_int numFinishedProducers = 0;
+	std::vector<std::jthread> producers;
+
+	for (int i = 0; i < NUM_PRODUCERS; i++)
+	{
+		producers.emplace_back(
+			[&queue, &start, &numFinishedProducers, i]
+			{
+				while (!start)
+				{
+					std::this_thread::yield();
+				}
+
+				for (int j = 0; j < NUM_CHANGES_PER_PRODUCER; j++)
+				{
+					auto name = std::to_wstring(j);
+
+					while (!queue.Push(FILE_ACTION_MODIFIED, name, i))
+					{
+						std::this_thread::yield();
+					}
+				}
+
+				numFinishedProducers++;
+			});
+	}
+
+	start = true;
+
+	std::vector<int> nextChange(NUM_PRODUCERS, 0);
+	int numReceived = 0;
+
+	while (true)
+	{
+		// The producers may have finished after the queue was last drained, so it needs to be
+		// drained one final time.
+		bool producersFinished = (numFinishedProducers == NUM_PRODUCERS);
+
+		auto result = queue.Drain();
+
+		for (const auto &change : result.changes)
+		{
+			ASSERT_GE(change.folderId, 0);
+			ASSERT_LT(change.folderId, NUM_PRODUCERS);
+
+			// Changes from a single producer should be received in the order they were pushed.
+			ASSERT_EQ(change.name, std::to_wstring(nextChange[change.folderId]));
+			nextChange[change.folderId]++;
+			numReceived++;
+		}
+
+		if (producersFinished)
+		{
+			break;
+		}
+	}
+
+	EXPECT_EQ(numReceived, NUM_PRODUCERS * NUM_CHANGES_PER_PRODUCER);
+}
@@ -0,0 +1,227 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/FileSearcher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+using namespace std::chrono_literals;
+using PatternSyntax = FileSearcher::PatternSyntax;
+
+class FileSearcherTest : public testing::Test
+{
+protected:
+	FileSearcherTest() :
+		m_rootPath(std::filesystem::temp_directory_path() / L"ExplorerPlusPlusTest"
+			/ L"FileSearcherTest"),
+		m_executor(std::make_shared<ComStaThreadPoolExecutor>(
+			FileSearcher::DEFAULT_NUM_WORKERS - 1)),
+		m_workPool(m_executor)
+	{
+	}
+
+	~FileSearcherTest()
+	{
+		m_executor->shutdown();
+	}
+
+	void SetUp() override
+	{
+		std::filesystem::remove_all(m_rootPath);
+		std::filesystem::create_directories(m_rootPath);
+
+		CreateTestFile(L"file1.txt");
+		CreateTestFile(L"File2.TXT");
+		CreateTestFile(L"notes.doc");
+		CreateTestFile(L"a/file3.txt");
+		CreateTestFile(L"a/b/file4.txt");
+		CreateTestFile(L"a/b/image.png");
+		CreateTestFile(L"c/report.txt");
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(m_rootPath);
+	}
+
+	void CreateTestFile(const std::filesystem::path &relativePath)
+	{
+		auto path = m_rootPath / relativePath;
+		std::filesystem::create_directories(path.parent_path());
+
+		std::ofstream file(path, std::ios::binary);
+		file << "test";
+	}
+
+	// Runs the search and returns the paths that were found, sorted so that they can be compared.
+	std::vector<std::wstring> Search(const FileSearcher &searcher)
+	{
+		std::vector<std::wstring> paths;
+		auto summary = searcher.Search(m_rootPath.wstring(),
+			[&paths](FileSearcher::Batch batch)
+			{ paths.insert(paths.end(), batch.paths.begin(), batch.paths.end()); });
+
+		EXPECT_TRUE(summary.has_value());
+
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	std::vector<std::wstring> BuildExpectedPaths(
+		const std::vector<std::filesystem::path> &relativePaths)
+	{
+		std::vector<std::wstring> paths;
+
+		for (const auto &relativePath : relativePaths)
+		{
+			auto path = m_rootPath / relativePath;
+			paths.push_back(path.make_preferred().wstring());
+		}
+
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	static FileSearcher::Criteria BuildCriteria(const std::wstring &pattern,
+		PatternSyntax syntax = PatternSyntax::Wildcard, bool caseSensitive = false)
+	{
+		FileSearcher::Criteria criteria;
+		criteria.pattern = pattern;
+		criteria.syntax = syntax;
+		criteria.caseSensitive = caseSensitive;
+		return criteria;
+	}
+
+	const std::filesystem::path m_rootPath;
+	std::shared_ptr<ComStaThreadPoolExecutor> m_executor;
+	BackgroundWorkPool m_workPool;
+};
+
+TEST_F(FileSearcherTest, Wildcard)
+{
+	FileSearcher searcher(BuildCriteria(L"*.txt"), &m_workPool);
+	EXPECT_EQ(Search(searcher),
+		BuildExpectedPaths({ L"file1.txt", L"File2.TXT", L"a/file3.txt", L"a/b/file4.txt",
+			L"c/report.txt" }));
+
+	FileSearcher caseSensitiveSearcher(BuildCriteria(L"*.txt", PatternSyntax::Wildcard, true),
+		&m_workPool);
+	EXPECT_EQ(Search(caseSensitiveSearcher),
+		BuildExpectedPaths(
+			{ L"file1.txt", L"a/file3.txt", L"a/b/file4.txt", L"c/report.txt" }));
+}
+
+TEST_F(FileSearcherTest, RegularExpression)
+{
+	FileSearcher searcher(BuildCriteria(L"file[0-9]\\.txt", PatternSyntax::RegularExpression),
+		&m_workPool);
+	EXPECT_EQ(Search(searcher),
+		BuildExpectedPaths({ L"file1.txt", L"File2.TXT", L"a/file3.txt", L"a/b/file4.txt" }));
+
+	// The entire name has to match.
+	FileSearcher partialSearcher(BuildCriteria(L"file", PatternSyntax::RegularExpression),
+		&m_workPool);
+	EXPECT_TRUE(Search(partialSearcher).empty());
+}
+
+TEST_F(FileSearcherTest, InvalidRegularExpression)
+{
+	EXPECT_THROW(
+		FileSearcher(BuildCriteria(L"file[", PatternSyntax::RegularExpression), &m_workPool),
+		boost::regex_error);
+}
+
+TEST_F(FileSearcherTest, EmptyPattern)
+{
+	FileSearcher searcher(BuildCriteria(L""), &m_workPool);
+	EXPECT_EQ(Search(searcher),
+		BuildExpectedPaths({ L"file1.txt", L"File2.TXT", L"notes.doc", L"a", L"a/file3.txt",
+			L"a/b", L"a/b/file4.txt", L"a/b/image.png", L"c", L"c/report.txt" }));
+}
+
+TEST_F(FileSearcherTest, Attributes)
+{
+	auto criteria = BuildCriteria(L"");
+	criteria.requiredAttributes = FILE_ATTRIBUTE_DIRECTORY;
+
+	FileSearcher searcher(criteria, &m_workPool);
+	EXPECT_EQ(Search(searcher), BuildExpectedPaths({ L"a", L"a/b", L"c" }));
+}
+
+TEST_F(FileSearcherTest, NoSubfolders)
+{
+	auto criteria = BuildCriteria(L"*.txt");
+	criteria.searchSubfolders = false;
+
+	FileSearcher searcher(criteria, &m_workPool);
+	EXPECT_EQ(Search(searcher), BuildExpectedPaths({ L"file1.txt", L"File2.TXT" }));
+}
+
+TEST_F(FileSearcherTest, Summary)
+{
+	for (unsigned int numWorkers : { 1, 2, 4, 8 })
+	{
+		FileSearcher searcher(BuildCriteria(L"*"), &m_workPool, numWorkers);
+		auto summary = searcher.Search(m_rootPath.wstring(), [](FileSearcher::Batch) {});
+
+		ASSERT_TRUE(summary.has_value());
+		EXPECT_EQ(summary->numFoldersFound, 3);
+		EXPECT_EQ(summary->numFilesFound, 7);
+	}
+}
+
+TEST_F(FileSearcherTest, Batches)
+{
+	// The interval is long enough that batches will only be delivered once they're full (or once
+	// the search finishes).
+	constexpr size_t maxBatchSize = 2;
+	FileSearcher searcher(BuildCriteria(L"*"), &m_workPool, 4, 1h, maxBatchSize);
+
+	std::vector<std::wstring> paths;
+	int numBatches = 0;
+	auto summary = searcher.Search(m_rootPath.wstring(),
+		[&paths, &numBatches, maxBatchSize](FileSearcher::Batch batch)
+		{
+			EXPECT_LE(batch.paths.size(), maxBatchSize);
+			EXPECT_FALSE(batch.currentFolder.empty());
+
+			paths.insert(paths.end(), batch.paths.begin(), batch.paths.end());
+			numBatches++;
+		});
+
+	ASSERT_TRUE(summary.has_value());
+	EXPECT_EQ(paths.size(), 10u);
+	EXPECT_GE(numBatches, 5);
+
+	std::sort(paths.begin(), paths.end());
+	EXPECT_EQ(paths, Search(FileSearcher(BuildCriteria(L"*"), &m_workPool)));
+}
+
+TEST_F(FileSearcherTest, Cancel)
+{
+	std::stop_source stopSource;
+	stopSource.request_stop();
+
+	FileSearcher searcher(BuildCriteria(L"*"), &m_workPool);
+	EXPECT_FALSE(
+		searcher.Search(m_rootPath.wstring(), [](FileSearcher::Batch) {}, stopSource.get_token())
+			.has_value());
+}
+
+TEST_F(FileSearcherTest, MissingFolder)
+{
+	FileSearcher searcher(BuildCriteria(L"*"), &m_workPool);
+	auto summary =
+		searcher.Search((m_rootPath / L"missing").wstring(), [](FileSearcher::Batch) {});
+
+	ASSERT_TRUE(summary.has_value());
+	EXPECT_EQ(summary->numFoldersFound, 0);
+	EXPECT_EQ(summary->numFilesFound, 0);
+}
@@ -0,0 +1,312 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/Crc32.h"
+#include "../Helper/FileSplitter.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+using Status = FileSplitter::Status;
+
+namespace
+{
+
+class MemoryInput : public ReadAheadPipeline::Source
+{
+public:
+	MemoryInput(const std::vector<std::byte> &data, size_t offset) : m_data(data), m_offset(offset)
+	{
+	}
+
+	std::optional<size_t> Read(std::span<std::byte> buffer) override
+	{
+		size_t size = std::min(buffer.size(), m_data.size() - m_offset);
+		std::memcpy(buffer.data(), m_data.data() + m_offset, size);
+		m_offset += size;
+		return size;
+	}
+
+private:
+	const std::vector<std::byte> &m_data;
+	size_t m_offset;
+};
+
+struct Part
+{
+	std::vector<std::byte> data;
+	uint64_t expectedSize = 0;
+	bool discarded = false;
+};
+
+class MemorySink : public FileSplitter::Sink
+{
+public:
+	MemorySink(Part &part, std::optional<size_t> failAtOffset) :
+		m_part(part),
+		m_failAtOffset(failAtOffset)
+	{
+	}
+
+	bool Write(std::span<const std::byte> data) override
+	{
+		if (m_failAtOffset && m_part.data.size() + data.size() > *m_failAtOffset)
+		{
+			return false;
+		}
+
+		m_part.data.insert(m_part.data.end(), data.begin(), data.end());
+		return true;
+	}
+
+	void Discard() override
+	{
+		m_part.discarded = true;
+	}
+
+private:
+	Part &m_part;
+	const std::optional<size_t> m_failAtOffset;
+};
+
+std::vector<std::byte> GenerateData(size_t size)
+{
+	std::vector<std::byte> data(size);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		data[i] = static_cast<std::byte>((i * 31 + i / 251) % 256);
+	}
+
+	return data;
+}
+
+}
+
+class FileSplitterTest : public testing::Test
+{
+protected:
+	static constexpr size_t BUFFER_SIZE = 4096;
+	static constexpr size_t NUM_BUFFERS = 2;
+	static constexpr unsigned int NUM_WRITERS = 3;
+
+	FileSplitterTest() :
+		m_executor(std::make_shared<ComStaThreadPoolExecutor>(NUM_WRITERS)),
+		m_workPool(m_executor),
+		m_splitter(&m_workPool, NUM_WRITERS, BUFFER_SIZE, NUM_BUFFERS)
+	{
+	}
+
+	~FileSplitterTest()
+	{
+		m_executor->shutdown();
+	}
+
+	FileSplitter::Result Split(uint64_t partSize, bool computeChecksums = false,
+		std::optional<size_t> failWriteIndex = std::nullopt,
+		FileSplitter::PartFinishedCallback partFinishedCallback = nullptr,
+		std::stop_token stopToken = {})
+	{
+		auto inputFactory = [this](uint64_t offset) -> std::unique_ptr<ReadAheadPipeline::Source>
+		{ return std::make_unique<MemoryInput>(m_input, static_cast<size_t>(offset)); };
+
+		auto sinkFactory = [this, failWriteIndex](size_t partIndex,
+							   uint64_t partSize) -> std::unique_ptr<FileSplitter::Sink>
+		{
+			std::scoped_lock lock(m_mutex);
+
+			auto &part = m_parts[partIndex];
+			part.expectedSize = partSize;
+
+			std::optional<size_t> failAtOffset;
+
+			if (partIndex == failWriteIndex)
+			{
+				failAtOffset = static_cast<size_t>(partSize / 2);
+			}
+
+			return std::make_unique<MemorySink>(part, failAtOffset);
+		};
+
+		// The input size is taken from m_inputSize, rather than m_input, so that tests can
+		// simulate an input that's shorter than expected.
+		return m_splitter.Run(m_inputSize, partSize, computeChecksums, inputFactory, sinkFactory,
+			partFinishedCallback, stopToken);
+	}
+
+	void SetInput(size_t size)
+	{
+		m_input = GenerateData(size);
+		m_inputSize = size;
+	}
+
+	void VerifyParts(uint64_t partSize)
+	{
+		ASSERT_EQ(m_parts.size(), FileSplitter::GetNumParts(m_input.size(), partSize));
+
+		for (const auto &[partIndex, part] : m_parts)
+		{
+			size_t offset = static_cast<size_t>(partIndex * partSize);
+			size_t size =
+				static_cast<size_t>(std::min<uint64_t>(partSize, m_input.size() - offset));
+
+			EXPECT_EQ(part.expectedSize, size);
+			EXPECT_FALSE(part.discarded);
+			EXPECT_TRUE(std::equal(part.data.begin(), part.data.end(), m_input.begin() + offset,
+				m_input.begin() + offset + size));
+			EXPECT_EQ(part.data.size(), size);
+		}
+	}
+
+	std::shared_ptr<ComStaThreadPoolExecutor> m_executor;
+	BackgroundWorkPool m_workPool;
+	FileSplitter m_splitter;
+	std::vector<std::byte> m_input;
+	uint64_t m_inputSize = 0;
+	std::mutex m_mutex;
+	std::map<size_t, Part> m_parts;
+};
+
+TEST_F(FileSplitterTest, GetNumParts)
+{
+	EXPECT_EQ(FileSplitter::GetNumParts(0, 10), 0u);
+	EXPECT_EQ(FileSplitter::GetNumParts(1, 10), 1u);
+	EXPECT_EQ(FileSplitter::GetNumParts(10, 10), 1u);
+	EXPECT_EQ(FileSplitter::GetNumParts(11, 10), 2u);
+	EXPECT_EQ(FileSplitter::GetNumParts(100, 10), 10u);
+	EXPECT_EQ(FileSplitter::GetNumParts(5ull * 1024 * 1024 * 1024, 1024 * 1024 * 1024), 5u);
+}
+
+TEST_F(FileSplitterTest, Split)
+{
+	for (uint64_t partSize : { uint64_t{ 1000 }, uint64_t{ BUFFER_SIZE },
+			 uint64_t{ BUFFER_SIZE * 3 + 5 }, uint64_t{ 100000 }, uint64_t{ 1000000 } })
+	{
+		SCOPED_TRACE(partSize);
+
+		SetInput(BUFFER_SIZE * 25 + 123);
+		m_parts.clear();
+
+		std::atomic<size_t> numPartsFinished = 0;
+		auto result = Split(partSize, false, std::nullopt,
+			[&numPartsFinished](size_t partIndex)
+			{
+				UNREFERENCED_PARAMETER(partIndex);
+
+				numPartsFinished++;
+			});
+
+		EXPECT_EQ(result.status, Status::Succeeded);
+		EXPECT_TRUE(result.checksums.empty());
+		EXPECT_EQ(numPartsFinished, m_parts.size());
+		VerifyParts(partSize);
+	}
+}
+
+TEST_F(FileSplitterTest, ExactMultiple)
+{
+	SetInput(BUFFER_SIZE * 8);
+
+	auto result = Split(BUFFER_SIZE * 2);
+
+	EXPECT_EQ(result.status, Status::Succeeded);
+	VerifyParts(BUFFER_SIZE * 2);
+}
+
+TEST_F(FileSplitterTest, EmptyInput)
+{
+	SetInput(0);
+
+	auto result = Split(1000, true);
+
+	EXPECT_EQ(result.status, Status::Succeeded);
+	EXPECT_TRUE(result.checksums.empty());
+	EXPECT_TRUE(m_parts.empty());
+}
+
+TEST_F(FileSplitterTest, Checksums)
+{
+	SetInput(100000);
+
+	uint64_t partSize = 7000;
+	auto result = Split(partSize, true);
+
+	ASSERT_EQ(result.status, Status::Succeeded);
+	VerifyParts(partSize);
+	ASSERT_EQ(result.checksums.size(), m_parts.size());
+
+	for (const auto &[partIndex, part] : m_parts)
+	{
+		Crc32 crc;
+		crc.Update(part.data);
+		EXPECT_EQ(result.checksums[partIndex], crc.GetValue());
+	}
+}
+
+TEST_F(FileSplitterTest, InputShorterThanExpected)
+{
+	SetInput(55000);
+	m_inputSize = 60000;
+
+	auto result = Split(10000, true);
+
+	EXPECT_EQ(result.status, Status::ReadFailed);
+	EXPECT_EQ(result.partIndex, 5u);
+	EXPECT_TRUE(result.checksums.empty());
+	EXPECT_TRUE(m_parts[5].discarded);
+}
+
+TEST_F(FileSplitterTest, WriteFailure)
+{
+	SetInput(100000);
+
+	auto result = Split(10000, true, 4);
+
+	EXPECT_EQ(result.status, Status::WriteFailed);
+	EXPECT_EQ(result.partIndex, 4u);
+	EXPECT_TRUE(result.checksums.empty());
+	EXPECT_TRUE(m_parts[4].discarded);
+}
+
+TEST_F(FileSplitterTest, Cancel)
+{
+	SetInput(1000000);
+
+	std::stop_source stopSource;
+	auto result = Split(1000, false, std::nullopt,
+		[&stopSource](size_t partIndex)
+		{
+			UNREFERENCED_PARAMETER(partIndex);
+
+			stopSource.request_stop();
+		},
+		stopSource.get_token());
+
+	EXPECT_EQ(result.status, Status::Cancelled);
+	EXPECT_LT(m_parts.size(), 1000u);
+
+	for (const auto &[partIndex, part] : m_parts)
+	{
+		// Each part is either complete, or was discarded.
+		EXPECT_TRUE(part.discarded || part.data.size() == 1000u);
+	}
+}
+
+TEST_F(FileSplitterTest, FewerPartsThanWriters)
+{
+	SetInput(BUFFER_SIZE * 3);
+
+	auto result = Split(BUFFER_SIZE * 2, true);
+
+	EXPECT_EQ(result.status, Status::Succeeded);
+	EXPECT_EQ(result.checksums.size(), 2u);
+	VerifyParts(BUFFER_SIZE * 2);
+}
@@ -0,0 +1,177 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/FolderSize.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <thread>
+
+class FolderSizeTest : public testing::Test
+{
+protected:
+	FolderSizeTest() :
+		m_rootPath(std::filesystem::temp_directory_path() / L"ExplorerPlusPlusTest"
+			/ L"FolderSizeTest")
+	{
+	}
+
+	void SetUp() override
+	{
+		std::filesystem::remove_all(m_rootPath);
+		std::filesystem::create_directories(m_rootPath);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(m_rootPath);
+	}
+
+	void CreateTestFile(const std::filesystem::path &relativePath, size_t size)
+	{
+		auto path = m_rootPath / relativePath;
+		std::filesystem::create_directories(path.parent_path());
+
+		std::ofstream file(path, std::ios::binary);
+		file << std::string(size, 'a');
+	}
+
+	// Creates a tree containing 4 folders (one of which is empty) and 6 files.
+	void CreateTree()
+	{
+		CreateTestFile(L"file1", 100);
+		CreateTestFile(L"file2", 0);
+		CreateTestFile(L"a/file3", 1000);
+		CreateTestFile(L"a/b/file4", 20);
+		CreateTestFile(L"a/b/file5", 3);
+		CreateTestFile(L"c/file6", 4096);
+		std::filesystem::create_directories(m_rootPath / L"c/empty");
+	}
+
+	static void ExpectFolderInfo(const std::optional<FolderInfo> &folderInfo,
+		std::uintmax_t expectedSize, int expectedNumFolders, int expectedNumFiles)
+	{
+		ASSERT_TRUE(folderInfo.has_value());
+		EXPECT_EQ(folderInfo->size, expectedSize);
+		EXPECT_EQ(folderInfo->numFolders, expectedNumFolders);
+		EXPECT_EQ(folderInfo->numFiles, expectedNumFiles);
+	}
+
+	const std::filesystem::path m_rootPath;
+};
+
+TEST_F(FolderSizeTest, Empty)
+{
+	FolderSizeCalculator calculator;
+	ExpectFolderInfo(calculator.Calculate(m_rootPath), 0, 0, 0);
+}
+
+TEST_F(FolderSizeTest, FilesAndFolders)
+{
+	CreateTree();
+
+	for (unsigned int numThreads : { 1, 2, 4, 8 })
+	{
+		FolderSizeCalculator calculator(nullptr, numThreads);
+		ExpectFolderInfo(calculator.Calculate(m_rootPath), 5219, 4, 6);
+	}
+}
+
+TEST_F(FolderSizeTest, MissingFolder)
+{
+	FolderSizeCalculator calculator;
+	ExpectFolderInfo(calculator.Calculate(m_rootPath / L"missing"), 0, 0, 0);
+}
+
+TEST_F(FolderSizeTest, Cancel)
+{
+	CreateTree();
+
+	std::stop_source stopSource;
+	stopSource.request_stop();
+
+	FolderSizeCache cache;
+	FolderSizeCalculator calculator(&cache);
+	EXPECT_FALSE(calculator.Calculate(m_rootPath, stopSource.get_token()).has_value());
+	EXPECT_FALSE(cache.MaybeGetFolderInfo(m_rootPath).has_value());
+}
+
+TEST_F(FolderSizeTest, CancelDuringWalk)
+{
+	constexpr int NUM_FILES = 1000;
+
+	for (int i = 0; i < NUM_FILES; i++)
+	{
+		CreateTestFile(L"file" + std::to_wstring(i), 1);
+	}
+
+	// The stop is requested at various points during the walk. Whenever it's requested, either the
+	// full result should be returned, or no result should be returned and nothing should be cached.
+	// A partial result should never be returned.
+	for (int delayInMicroseconds : { 0, 50, 100, 200, 500, 1000, 2000, 5000 })
+	{
+		FolderSizeCache cache;
+		FolderSizeCalculator calculator(&cache, 1);
+
+		std::stop_source stopSource;
+		std::jthread stopThread(
+			[&stopSource, delayInMicroseconds]
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(delayInMicroseconds));
+				stopSource.request_stop();
+			});
+
+		auto folderInfo = calculator.Calculate(m_rootPath, stopSource.get_token());
+		stopThread.join();
+
+		if (folderInfo)
+		{
+			ExpectFolderInfo(folderInfo, NUM_FILES, 0, NUM_FILES);
+			ExpectFolderInfo(cache.MaybeGetFolderInfo(m_rootPath), NUM_FILES, 0, NUM_FILES);
+		}
+		else
+		{
+			EXPECT_FALSE(cache.MaybeGetFolderInfo(m_rootPath).has_value());
+		}
+	}
+}
+
+TEST_F(FolderSizeTest, CachedResults)
+{
+	CreateTree();
+
+	FolderSizeCache cache;
+	FolderSizeCalculator calculator(&cache);
+	ExpectFolderInfo(calculator.Calculate(m_rootPath), 5219, 4, 6);
+	ExpectFolderInfo(cache.MaybeGetFolderInfo(m_rootPath), 5219, 4, 6);
+
+	// Changing the size of an existing file doesn't change the last write time of the folder that
+	// contains it, so the cached entry for the folder will continue to be used.
+	CreateTestFile(L"a/b/file4", 40);
+	ExpectFolderInfo(calculator.Calculate(m_rootPath), 5219, 4, 6);
+
+	// Adding a file, however, does change the last write time, so the change will be picked up,
+	// even though it's several levels down.
+	CreateTestFile(L"a/b/file7", 7);
+	ExpectFolderInfo(calculator.Calculate(m_rootPath), 5246, 4, 7);
+
+	cache.Clear();
+	EXPECT_FALSE(cache.MaybeGetFolderInfo(m_rootPath).has_value());
+	ExpectFolderInfo(calculator.Calculate(m_rootPath), 5246, 4, 7);
+}
+
+TEST_F(FolderSizeTest, CacheEviction)
+{
+	CreateTree();
+
+	// The cache can only hold a couple of folders, so it will be cleared during the walk. That
+	// shouldn't affect the results.
+	FolderSizeCache cache(2);
+	FolderSizeCalculator calculator(&cache);
+
+	for (int i = 0; i < 3; i++)
+	{
+		ExpectFolderInfo(calculator.Calculate(m_rootPath), 5219, 4, 6);
+	}
+}
@@ -0,0 +1,209 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/ItemNameIndex.h"
+#include <gtest/gtest.h>
+#include <format>
+#include <random>
+#include <unordered_map>
+
+using namespace testing;
+
+TEST(ItemNameIndexTest, AddAndFind)
+{
+	ItemNameIndex index;
+	index.AddItem(0, L"C:\\Folder\\file.txt");
+	index.AddItem(1, L"C:\\Folder\\other.txt");
+
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\file.txt"), ElementsAre(0));
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\other.txt"), ElementsAre(1));
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\missing.txt"), IsEmpty());
+	EXPECT_EQ(index.GetSize(), 2U);
+}
+
+TEST(ItemNameIndexTest, KeyedOnItemName)
+{
+	ItemNameIndex index;
+	index.AddItem(0, L"C:\\Folder\\file.txt");
+	index.AddItem(1, L"C:\\");
+	index.AddItem(2, L"::{20D04FE0-3AEA-1069-A2D8-08002B30309D}");
+
+	// Only the name of the item within its parent is significant.
+	EXPECT_THAT(index.FindItems(L"D:\\Alias\\file.txt"), ElementsAre(0));
+	EXPECT_THAT(index.FindItems(L"file.txt"), ElementsAre(0));
+
+	EXPECT_THAT(index.FindItems(L"C:\\"), ElementsAre(1));
+	EXPECT_THAT(index.FindItems(L"::{20D04FE0-3AEA-1069-A2D8-08002B30309D}"), ElementsAre(2));
+}
+
+TEST(ItemNameIndexTest, CaseInsensitive)
+{
+	ItemNameIndex index;
+	index.AddItem(0, L"C:\\Folder\\File.TXT");
+
+	EXPECT_THAT(index.FindItems(L"c:\\folder\\file.txt"), ElementsAre(0));
+
+	// Names that only differ by case should both be returned, since it's up to the caller to
+	// determine which item is being referred to.
+	index.AddItem(1, L"c:\\folder\\file.txt");
+	EXPECT_THAT(index.FindItems(L"C:\\FOLDER\\FILE.TXT"), UnorderedElementsAre(0, 1));
+}
+
+TEST(ItemNameIndexTest, Rename)
+{
+	ItemNameIndex index;
+	index.AddItem(0, L"C:\\Folder\\before.txt");
+	index.AddItem(0, L"C:\\Folder\\after.txt");
+
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\before.txt"), IsEmpty());
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\after.txt"), ElementsAre(0));
+	EXPECT_EQ(index.GetSize(), 1U);
+}
+
+TEST(ItemNameIndexTest, RemoveAndClear)
+{
+	ItemNameIndex index;
+	index.AddItem(0, L"C:\\Folder\\file1.txt");
+	index.AddItem(1, L"C:\\Folder\\file2.txt");
+
+	index.RemoveItem(0);
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\file1.txt"), IsEmpty());
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\file2.txt"), ElementsAre(1));
+
+	// Removing an item that doesn't exist should have no effect.
+	index.RemoveItem(5);
+	EXPECT_EQ(index.GetSize(), 1U);
+
+	index.Clear();
+	EXPECT_THAT(index.FindItems(L"C:\\Folder\\file2.txt"), IsEmpty());
+	EXPECT_EQ(index.GetSize(), 0U);
+}
+
+TEST(ItemNameIndexTest, FindEquivalentItem)
+{
+	ItemNameIndex index;
+	index.AddItem(0, L"C:\\Folder\\Long file name.txt");
+	index.AddItem(1, L"C:\\Folder\\other.txt");
+
+	int numChecks = 0;
+	auto isItem0 = [&numChecks](int internalIndex)
+	{
+		numChecks++;
+		return internalIndex == 0;
+	};
+
+	// When the parsing name matches, only the items indexed under that name should be checked.
+	EXPECT_EQ(index.FindEquivalentItem(L"C:\\Folder\\Long file name.txt", isItem0), 0);
+	EXPECT_EQ(numChecks, 1);
+
+	// The same item reached through a different parent (e.g. a library) has the same name within
+	// that parent, so it should still be found directly.
+	numChecks = 0;
+	EXPECT_EQ(index.FindEquivalentItem(L"D:\\Library\\Long file name.txt", isItem0), 0);
+	EXPECT_EQ(numChecks, 1);
+
+	// A name that isn't in the index can't refer to any item, so no items should be checked.
+	numChecks = 0;
+	EXPECT_EQ(index.FindEquivalentItem(L"C:\\Folder\\missing.txt", isItem0), std::nullopt);
+	EXPECT_EQ(numChecks, 0);
+
+	// A short name differs from the name the item was stored under. In that case, or when there's
+	// no name, the remaining items should be checked.
+	EXPECT_EQ(index.FindEquivalentItem(L"C:\\Folder\\LONGFI~1.TXT", isItem0), 0);
+	EXPECT_EQ(index.FindEquivalentItem(std::nullopt, isItem0), 0);
+
+	EXPECT_EQ(index.FindEquivalentItem(L"C:\\Folder\\other.txt",
+				  [](int internalIndex) { return internalIndex == 5; }),
+		std::nullopt);
+}
+
+// Replays a long, randomly generated series of add, remove and rename operations against a large
+// set of items and verifies that every lookup matches the expected result.
+TEST(ItemNameIndexTest, ChangeLogReplay)
+{
+	const int NUM_INITIAL_ITEMS = 100000;
+	const int NUM_CHANGES = 10000;
+
+	ItemNameIndex index;
+	std::unordered_map<int, std::wstring> expectedNames;
+	int nextInternalIndex = 0;
+	int nextNameId = 0;
+
+	auto generateName = [&nextNameId]()
+	{ return std::format(L"C:\\Large Folder\\Item {}.dat", nextNameId++); };
+
+	for (int i = 0; i < NUM_INITIAL_ITEMS; i++)
+	{
+		int internalIndex = nextInternalIndex++;
+		auto name = generateName();
+		index.AddItem(internalIndex, name);
+		expectedNames[internalIndex] = name;
+	}
+
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<int> actionDistribution(0, 2);
+
+	auto pickExistingItem = [&]()
+	{
+		std::uniform_int_distribution<int> itemDistribution(0, nextInternalIndex - 1);
+
+		while (true)
+		{
+			int internalIndex = itemDistribution(generator);
+
+			if (expectedNames.contains(internalIndex))
+			{
+				return internalIndex;
+			}
+		}
+	};
+
+	for (int i = 0; i < NUM_CHANGES; i++)
+	{
+		switch (actionDistribution(generator))
+		{
+		case 0:
+		{
+			int internalIndex = nextInternalIndex++;
+			auto name = generateName();
+			ASSERT_THAT(index.FindItems(name), IsEmpty());
+
+			index.AddItem(internalIndex, name);
+			expectedNames[internalIndex] = name;
+		}
+		break;
+
+		case 1:
+		{
+			int internalIndex = pickExistingItem();
+			ASSERT_THAT(index.FindItems(expectedNames[internalIndex]), ElementsAre(internalIndex));
+
+			index.RemoveItem(internalIndex);
+			ASSERT_THAT(index.FindItems(expectedNames[internalIndex]), IsEmpty());
+			expectedNames.erase(internalIndex);
+		}
+		break;
+
+		case 2:
+		{
+			int internalIndex = pickExistingItem();
+			ASSERT_THAT(index.FindItems(expectedNames[internalIndex]), ElementsAre(internalIndex));
+
+			auto updatedName = generateName();
+			index.AddItem(internalIndex, updatedName);
+			ASSERT_THAT(index.FindItems(expectedNames[internalIndex]), IsEmpty());
+			expectedNames[internalIndex] = updatedName;
+		}
+		break;
+		}
+	}
+
+	EXPECT_EQ(index.GetSize(), expectedNames.size());
+
+	for (const auto &[internalIndex, name] : expectedNames)
+	{
+		EXPECT_THAT(index.FindItems(name), ElementsAre(internalIndex));
+	}
+}
@@ -0,0 +1,349 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/ListViewItemModel.h"
+#include "../Explorer++/ShellBrowser/SelectionTracker.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+using namespace testing;
+
+namespace
+{
+
+std::vector<int> GetOrder(const ListViewItemModel &model)
+{
+	std::vector<int> order;
+
+	for (int i = 0; i < model.GetCount(); i++)
+	{
+		order.push_back(model.GetInternalIndexAt(i));
+	}
+
+	return order;
+}
+
+// Items need to be tracked by the SelectionTracker before they can be selected.
+void InsertTrackedItem(ListViewItemModel &model, SelectionTracker &selectionTracker,
+	int internalIndex, int position)
+{
+	model.InsertItem(internalIndex, position);
+	selectionTracker.AddItem(internalIndex, false, 0);
+}
+
+}
+
+TEST(ListViewItemModelTest, InsertItems)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+	EXPECT_EQ(model.InsertItem(10, 0), 0);
+	EXPECT_EQ(model.InsertItem(11, 1), 1);
+	EXPECT_EQ(model.InsertItem(12, 0), 0);
+	EXPECT_EQ(model.InsertItem(13, 1), 1);
+
+	// Positions past the end of the list should result in the item being appended.
+	EXPECT_EQ(model.InsertItem(14, 100), 4);
+
+	EXPECT_EQ(model.GetCount(), 5);
+	EXPECT_THAT(GetOrder(model), ElementsAre(12, 13, 10, 11, 14));
+
+	EXPECT_EQ(model.GetPosition(12), 0);
+	EXPECT_EQ(model.GetPosition(13), 1);
+	EXPECT_EQ(model.GetPosition(10), 2);
+	EXPECT_EQ(model.GetPosition(11), 3);
+	EXPECT_EQ(model.GetPosition(14), 4);
+	EXPECT_EQ(model.GetPosition(15), std::nullopt);
+}
+
+TEST(ListViewItemModelTest, RemoveItems)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+
+	for (int i = 0; i < 5; i++)
+	{
+		InsertTrackedItem(model, selectionTracker, i, i);
+	}
+
+	selectionTracker.SetSelected(1, true);
+	selectionTracker.SetSelected(3, true);
+	model.SetFocusedItem(3);
+
+	selectionTracker.RemoveItem(3);
+	model.RemoveItem(3);
+	EXPECT_FALSE(model.HasItem(3));
+	EXPECT_THAT(GetOrder(model), ElementsAre(0, 1, 2, 4));
+	EXPECT_EQ(model.GetPosition(4), 3);
+	EXPECT_EQ(model.GetSelectedCount(), 1);
+	EXPECT_EQ(model.GetFocusedItem(), std::nullopt);
+
+	// Removing an item that doesn't exist should have no effect.
+	model.RemoveItem(3);
+	EXPECT_EQ(model.GetCount(), 4);
+
+	model.Clear();
+	selectionTracker.Clear();
+	EXPECT_EQ(model.GetCount(), 0);
+	EXPECT_EQ(model.GetSelectedCount(), 0);
+	EXPECT_FALSE(model.HasItem(0));
+}
+
+TEST(ListViewItemModelTest, BatchInsertItems)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+
+	for (int i = 0; i < 4; i++)
+	{
+		InsertTrackedItem(model, selectionTracker, i, i);
+	}
+
+	selectionTracker.SetSelected(2, true);
+
+	// Each position refers to the list as it is once the previous items have been inserted, in the
+	// same way as it would if the items were inserted one at a time. Positions that decrease
+	// should be handled as well.
+	model.InsertItems({ { 10, 0 }, { 12, 3 }, { 13, 4 }, { 14, 100 }, { 15, 1 } });
+
+	EXPECT_THAT(GetOrder(model), ElementsAre(10, 15, 0, 1, 12, 13, 2, 3, 14));
+
+	for (int position = 0; position < model.GetCount(); position++)
+	{
+		EXPECT_EQ(model.GetPosition(model.GetInternalIndexAt(position)), position);
+	}
+
+	EXPECT_THAT(model.GetSelectedPositions(), ElementsAre(6));
+}
+
+TEST(ListViewItemModelTest, BatchRemoveItems)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+
+	for (int i = 0; i < 6; i++)
+	{
+		InsertTrackedItem(model, selectionTracker, i, i);
+	}
+
+	selectionTracker.SetSelected(1, true);
+	selectionTracker.SetSelected(4, true);
+	model.SetFocusedItem(1);
+
+	selectionTracker.RemoveItem(1);
+	selectionTracker.RemoveItem(3);
+
+	// Items that don't exist should be ignored.
+	model.RemoveItems({ 1, 3, 100 });
+
+	EXPECT_THAT(GetOrder(model), ElementsAre(0, 2, 4, 5));
+	EXPECT_FALSE(model.HasItem(1));
+	EXPECT_FALSE(model.HasItem(3));
+	EXPECT_EQ(model.GetPosition(5), 3);
+	EXPECT_THAT(model.GetSelectedPositions(), ElementsAre(2));
+	EXPECT_EQ(model.GetFocusedItem(), std::nullopt);
+
+	model.RemoveItems({ 100 });
+	EXPECT_EQ(model.GetCount(), 4);
+}
+
+TEST(ListViewItemModelTest, Sort)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+	std::vector<int> values = { 5, 3, 9, 3, 1 };
+
+	for (int i = 0; i < static_cast<int>(values.size()); i++)
+	{
+		InsertTrackedItem(model, selectionTracker, i, i);
+	}
+
+	selectionTracker.SetSelected(2, true);
+	selectionTracker.SetSelected(4, true);
+
+	model.Sort([&values](int internalIndex1, int internalIndex2)
+		{ return values[internalIndex1] - values[internalIndex2]; });
+
+	// Items 1 and 3 are equivalent, so should retain their original order.
+	EXPECT_THAT(GetOrder(model), ElementsAre(4, 1, 3, 0, 2));
+
+	for (int position = 0; position < model.GetCount(); position++)
+	{
+		EXPECT_EQ(model.GetPosition(model.GetInternalIndexAt(position)), position);
+	}
+
+	// Selection is tracked by item, so it should follow the items as they move.
+	EXPECT_THAT(model.GetSelectedPositions(), ElementsAre(0, 4));
+}
+
+TEST(ListViewItemModelTest, Selection)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+
+	for (int i = 0; i < 10; i++)
+	{
+		InsertTrackedItem(model, selectionTracker, i, i);
+	}
+
+	// The selection is owned by the SelectionTracker, so changes made there should be reflected
+	// directly.
+	for (int i = 2; i <= 5; i++)
+	{
+		selectionTracker.SetSelected(i, true);
+	}
+
+	EXPECT_EQ(model.GetSelectedCount(), 4);
+	EXPECT_THAT(model.GetSelectedPositions(), ElementsAre(2, 3, 4, 5));
+	EXPECT_TRUE(model.IsSelected(3));
+	EXPECT_FALSE(model.IsSelected(6));
+
+	InsertTrackedItem(model, selectionTracker, 100, 0);
+	EXPECT_THAT(model.GetSelectedPositions(), ElementsAre(3, 4, 5, 6));
+
+	selectionTracker.InvertSelection();
+	EXPECT_EQ(model.GetSelectedCount(), 7);
+	EXPECT_THAT(model.GetSelectedPositions(), ElementsAre(0, 1, 2, 7, 8, 9, 10));
+
+	selectionTracker.SetAllSelected(true);
+	EXPECT_EQ(model.GetSelectedCount(), 11);
+
+	selectionTracker.SetAllSelected(false);
+	EXPECT_EQ(model.GetSelectedCount(), 0);
+	EXPECT_THAT(model.GetSelectedPositions(), IsEmpty());
+}
+
+TEST(ListViewItemModelTest, ItemData)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+	model.InsertItem(0, 0);
+
+	EXPECT_FALSE(model.IsCut(0));
+	model.SetCut(0, true);
+	EXPECT_TRUE(model.IsCut(0));
+
+	EXPECT_EQ(model.GetGroupId(0), std::nullopt);
+	model.SetGroupId(0, 7);
+	EXPECT_EQ(model.GetGroupId(0), 7);
+
+	EXPECT_EQ(model.GetImage(0), std::nullopt);
+	model.SetImage(0, 3, 1);
+	EXPECT_EQ(model.GetImage(0), 3);
+	EXPECT_EQ(model.GetOverlay(0), 1);
+	model.ResetAllImages();
+	EXPECT_EQ(model.GetImage(0), std::nullopt);
+	EXPECT_EQ(model.GetOverlay(0), 0);
+
+	EXPECT_EQ(model.MaybeGetColumnText(0, 1), nullptr);
+	model.SetColumnText(0, 1, L"Text");
+	ASSERT_NE(model.MaybeGetColumnText(0, 1), nullptr);
+	EXPECT_EQ(*model.MaybeGetColumnText(0, 1), L"Text");
+	EXPECT_EQ(model.MaybeGetColumnText(0, 2), nullptr);
+	model.ResetColumnText(0);
+	EXPECT_EQ(model.MaybeGetColumnText(0, 1), nullptr);
+}
+
+// Applies a long series of random insertions and removals and verifies that the model always
+// matches a simple reference implementation.
+TEST(ListViewItemModelTest, RandomOperations)
+{
+	SelectionTracker selectionTracker;
+	ListViewItemModel model(&selectionTracker);
+	std::vector<int> expectedOrder;
+	int nextInternalIndex = 0;
+
+	std::mt19937 generator(1234);
+
+	for (int i = 0; i < 5000; i++)
+	{
+		bool insert = expectedOrder.empty() || std::uniform_int_distribution<int>(0, 2)(generator);
+
+		if (insert)
+		{
+			int position = std::uniform_int_distribution<int>(0,
+				static_cast<int>(expectedOrder.size()))(generator);
+			int internalIndex = nextInternalIndex++;
+
+			ASSERT_EQ(model.InsertItem(internalIndex, position), position);
+			expectedOrder.insert(expectedOrder.begin() + position, internalIndex);
+		}
+		else
+		{
+			int position = std::uniform_int_distribution<int>(0,
+				static_cast<int>(expectedOrder.size()) - 1)(generator);
+			int internalIndex = expectedOrder[position];
+
+			ASSERT_EQ(model.GetPosition(internalIndex), position);
+			model.RemoveItem(internalIndex);
+			expectedOrder.erase(expectedOrder.begin() + position);
+		}
+
+		// Removed items are only erased from the order once another item is inserted, so this
+		// checks the order both with and without pending removals.
+		if (i % 100 == 0)
+		{
+			ASSERT_EQ(GetOrder(model), expectedOrder);
+		}
+	}
+
+	ASSERT_EQ(GetOrder(model), expectedOrder);
+
+	for (int position = 0; position < static_cast<int>(expectedOrder.size()); position++)
+	{
+		EXPECT_EQ(model.GetPosition(expectedOrder[position]), position);
+	}
+}
+
+// Verifies that inserting a batch of items produces the same result as inserting each item
+// individually.
+TEST(ListViewItemModelTest, RandomBatchInsertions)
+{
+	std::mt19937 generator(1234);
+	int nextInternalIndex = 0;
+
+	for (int i = 0; i < 200; i++)
+	{
+		SelectionTracker selectionTracker;
+		ListViewItemModel model(&selectionTracker);
+		ListViewItemModel expectedModel(&selectionTracker);
+
+		int numExistingItems = std::uniform_int_distribution<int>(0, 20)(generator);
+
+		for (int j = 0; j < numExistingItems; j++)
+		{
+			model.InsertItem(nextInternalIndex, j);
+			expectedModel.InsertItem(nextInternalIndex, j);
+			nextInternalIndex++;
+		}
+
+		// Most batches are in increasing order, as they would be when inserting sorted items, but
+		// positions can also decrease or be out of range.
+		std::vector<std::pair<int, int>> items;
+		int position = 0;
+		int numNewItems = std::uniform_int_distribution<int>(0, 20)(generator);
+
+		for (int j = 0; j < numNewItems; j++)
+		{
+			position += std::uniform_int_distribution<int>(-3, 5)(generator);
+			items.emplace_back(nextInternalIndex++, position);
+		}
+
+		model.InsertItems(items);
+
+		for (const auto &[internalIndex, itemPosition] : items)
+		{
+			expectedModel.InsertItem(internalIndex, itemPosition);
+		}
+
+		ASSERT_EQ(GetOrder(model), GetOrder(expectedModel));
+
+		for (int j = 0; j < model.GetCount(); j++)
+		{
+			ASSERT_EQ(model.GetPosition(model.GetInternalIndexAt(j)), j);
+		}
+	}
+}
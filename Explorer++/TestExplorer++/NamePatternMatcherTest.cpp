@@ -0,0 +1,143 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ComStaThreadPoolExecutor.h"
+#include "../Explorer++/ShellBrowser/NamePatternMatcher.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include <boost/regex.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+using Syntax = NamePatternMatcher::Syntax;
+
+namespace
+{
+
+std::vector<std::wstring> GenerateNames(size_t numNames)
+{
+	const wchar_t *extensions[] = { L".log", L".txt", L".LOG", L".cpp", L".log.bak" };
+
+	std::vector<std::wstring> names;
+	names.reserve(numNames);
+
+	for (size_t i = 0; i < numNames; i++)
+	{
+		names.push_back(L"file" + std::to_wstring(i) + extensions[i % std::size(extensions)]);
+	}
+
+	return names;
+}
+
+std::vector<std::wstring_view> GetNameViews(const std::vector<std::wstring> &names)
+{
+	return { names.begin(), names.end() };
+}
+
+}
+
+TEST(NamePatternMatcherTest, Wildcard)
+{
+	NamePatternMatcher matcher(L"*.log", Syntax::Wildcard, false);
+	EXPECT_TRUE(matcher.Matches(L"file.log"));
+	EXPECT_TRUE(matcher.Matches(L"FILE.LOG"));
+	EXPECT_FALSE(matcher.Matches(L"file.log.bak"));
+	EXPECT_FALSE(matcher.Matches(L"file.txt"));
+
+	NamePatternMatcher caseSensitiveMatcher(L"*.log", Syntax::Wildcard, true);
+	EXPECT_TRUE(caseSensitiveMatcher.Matches(L"file.log"));
+	EXPECT_FALSE(caseSensitiveMatcher.Matches(L"FILE.LOG"));
+}
+
+TEST(NamePatternMatcherTest, RegularExpression)
+{
+	NamePatternMatcher matcher(L"file[0-9]+\\.log", Syntax::RegularExpression, false);
+	EXPECT_TRUE(matcher.Matches(L"file123.log"));
+	EXPECT_TRUE(matcher.Matches(L"FILE1.LOG"));
+	EXPECT_FALSE(matcher.Matches(L"file.log"));
+
+	// The entire name has to match, not just part of it.
+	EXPECT_FALSE(matcher.Matches(L"file1.log.bak"));
+
+	NamePatternMatcher caseSensitiveMatcher(L"file[0-9]+\\.log", Syntax::RegularExpression,
+		true);
+	EXPECT_TRUE(caseSensitiveMatcher.Matches(L"file1.log"));
+	EXPECT_FALSE(caseSensitiveMatcher.Matches(L"FILE1.LOG"));
+}
+
+TEST(NamePatternMatcherTest, InvalidRegularExpression)
+{
+	EXPECT_THROW(NamePatternMatcher(L"file[", Syntax::RegularExpression, false),
+		boost::regex_error);
+
+	// The same text is a valid wildcard pattern.
+	EXPECT_NO_THROW(NamePatternMatcher(L"file[", Syntax::Wildcard, false));
+}
+
+// The parameter is the number of threads in the work pool.
+class NamePatternMatcherThreadsTest : public testing::TestWithParam<int>
+{
+protected:
+	NamePatternMatcherThreadsTest() :
+		m_executor(std::make_shared<ComStaThreadPoolExecutor>(GetParam())),
+		m_workPool(m_executor)
+	{
+	}
+
+	~NamePatternMatcherThreadsTest()
+	{
+		m_executor->shutdown();
+	}
+
+	std::shared_ptr<ComStaThreadPoolExecutor> m_executor;
+	BackgroundWorkPool m_workPool;
+};
+
+TEST_P(NamePatternMatcherThreadsTest, MatchNamesEmpty)
+{
+	NamePatternMatcher matcher(L"*", Syntax::Wildcard, false);
+	auto matchSet = matcher.MatchNames({}, &m_workPool);
+	EXPECT_EQ(matchSet.GetSize(), 0u);
+	EXPECT_EQ(matchSet.GetNumMatches(), 0u);
+	EXPECT_FALSE(matchSet.IsMatch(0));
+}
+
+// The set of matches should be the same as the result of matching each name individually,
+// regardless of how the names are split up between threads.
+TEST_P(NamePatternMatcherThreadsTest, MatchNames)
+{
+	NamePatternMatcher wildcardMatcher(L"*.log", Syntax::Wildcard, false);
+	NamePatternMatcher regexMatcher(L"file[0-9]*7\\.(txt|cpp)", Syntax::RegularExpression, true);
+
+	for (size_t numNames : { 1, 63, 64, 65, 10000, 100003 })
+	{
+		auto names = GenerateNames(numNames);
+		auto nameViews = GetNameViews(names);
+
+		for (const auto *matcher : { &wildcardMatcher, &regexMatcher })
+		{
+			auto matchSet = matcher->MatchNames(nameViews, &m_workPool);
+			ASSERT_EQ(matchSet.GetSize(), numNames);
+
+			size_t expectedNumMatches = 0;
+
+			for (size_t i = 0; i < numNames; i++)
+			{
+				bool expectedMatch = matcher->Matches(names[i]);
+				ASSERT_EQ(matchSet.IsMatch(i), expectedMatch) << "Name: " << i;
+
+				if (expectedMatch)
+				{
+					expectedNumMatches++;
+				}
+			}
+
+			EXPECT_EQ(matchSet.GetNumMatches(), expectedNumMatches);
+		}
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, NamePatternMatcherThreadsTest,
+	testing::Values(1, 2, 3, 8, 64));
@@ -0,0 +1,98 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "ComStaThreadPoolExecutor.h"
+#include "../Helper/BackgroundWorkPool.h"
+#include "../Helper/ParallelSort.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace
+{
+
+struct Item
+{
+	int key;
+	int originalPosition;
+
+	bool operator==(const Item &) const = default;
+};
+
+std::vector<Item> GenerateItems(size_t size, int maxKey)
+{
+	std::mt19937 generator(1234);
+	std::vector<Item> items;
+	items.reserve(size);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		items.push_back({ std::uniform_int_distribution<int>(0, maxKey)(generator),
+			static_cast<int>(i) });
+	}
+
+	return items;
+}
+
+bool CompareKeys(const Item &item1, const Item &item2)
+{
+	return item1.key < item2.key;
+}
+
+}
+
+// The parameter is the number of threads in the work pool.
+class ParallelSortTest : public testing::TestWithParam<int>
+{
+protected:
+	ParallelSortTest() :
+		m_executor(std::make_shared<ComStaThreadPoolExecutor>(GetParam())),
+		m_workPool(m_executor)
+	{
+	}
+
+	~ParallelSortTest()
+	{
+		m_executor->shutdown();
+	}
+
+	std::shared_ptr<ComStaThreadPoolExecutor> m_executor;
+	BackgroundWorkPool m_workPool;
+};
+
+// The keys are drawn from a small range, so there are a large number of equivalent items. Those
+// items should retain their original relative order, exactly as they would with std::stable_sort.
+TEST_P(ParallelSortTest, MatchesStableSort)
+{
+	for (size_t size : { 0, 1, 100, 50000, 100003, 250000 })
+	{
+		auto items = GenerateItems(size, 100);
+
+		auto expectedItems = items;
+		std::stable_sort(expectedItems.begin(), expectedItems.end(), CompareKeys);
+
+		ParallelStableSort(items.begin(), items.end(), CompareKeys, &m_workPool);
+		ASSERT_EQ(items, expectedItems) << "Size: " << size;
+	}
+}
+
+TEST_P(ParallelSortTest, SortedInput)
+{
+	auto items = GenerateItems(200000, 1000000);
+	std::stable_sort(items.begin(), items.end(), CompareKeys);
+
+	auto expectedItems = items;
+	ParallelStableSort(items.begin(), items.end(), CompareKeys, &m_workPool);
+	EXPECT_EQ(items, expectedItems);
+
+	std::reverse(items.begin(), items.end());
+	ParallelStableSort(items.begin(), items.end(), CompareKeys, &m_workPool);
+	EXPECT_TRUE(std::is_sorted(items.begin(), items.end(), CompareKeys));
+}
+
+// Covers a single thread, odd and even numbers of threads (which affect how the sorted chunks are
+// paired up when being merged) and more threads than there are chunks worth sorting separately.
+INSTANTIATE_TEST_SUITE_P(Threads, ParallelSortTest, testing::Values(1, 2, 3, 4, 7, 64));
@@ -0,0 +1,263 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/ReadAheadPipeline.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+using Status = ReadAheadPipeline::Status;
+
+namespace
+{
+
+class MemorySource : public ReadAheadPipeline::Source
+{
+public:
+	MemorySource(const std::vector<std::byte> &data, std::atomic<int> &numBlocksRead,
+		std::optional<size_t> failAtOffset = std::nullopt) :
+		m_data(data),
+		m_numBlocksRead(numBlocksRead),
+		m_failAtOffset(failAtOffset)
+	{
+	}
+
+	std::optional<size_t> Read(std::span<std::byte> buffer) override
+	{
+		if (m_failAtOffset && m_offset >= *m_failAtOffset)
+		{
+			return std::nullopt;
+		}
+
+		size_t size = std::min(buffer.size(), m_data.size() - m_offset);
+		std::memcpy(buffer.data(), m_data.data() + m_offset, size);
+		m_offset += size;
+
+		if (size > 0)
+		{
+			m_numBlocksRead++;
+		}
+
+		return size;
+	}
+
+private:
+	const std::vector<std::byte> &m_data;
+	std::atomic<int> &m_numBlocksRead;
+	const std::optional<size_t> m_failAtOffset;
+	size_t m_offset = 0;
+};
+
+std::vector<std::byte> GenerateData(size_t size, int seed)
+{
+	std::vector<std::byte> data(size);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		data[i] = static_cast<std::byte>((i * 31 + seed) % 251);
+	}
+
+	return data;
+}
+
+}
+
+class ReadAheadPipelineTest : public testing::Test
+{
+protected:
+	static constexpr size_t BUFFER_SIZE = 4096;
+	static constexpr size_t NUM_BUFFERS = 3;
+
+	ReadAheadPipelineTest() : m_pipeline(BUFFER_SIZE, NUM_BUFFERS)
+	{
+	}
+
+	ReadAheadPipeline::SourceFactory MakeSourceFactory(
+		std::optional<size_t> failOpenIndex = std::nullopt,
+		std::optional<size_t> failReadIndex = std::nullopt)
+	{
+		return [this, failOpenIndex, failReadIndex](
+				   size_t index) -> std::unique_ptr<ReadAheadPipeline::Source>
+		{
+			if (index == failOpenIndex)
+			{
+				return nullptr;
+			}
+
+			std::optional<size_t> failAtOffset;
+
+			if (index == failReadIndex)
+			{
+				failAtOffset = m_sources[index].size() / 2;
+			}
+
+			return std::make_unique<MemorySource>(m_sources[index], m_numBlocksRead,
+				failAtOffset);
+		};
+	}
+
+	ReadAheadPipeline m_pipeline;
+	std::vector<std::vector<std::byte>> m_sources;
+	std::atomic<int> m_numBlocksRead = 0;
+};
+
+TEST_F(ReadAheadPipelineTest, ProcessesSourcesInOrder)
+{
+	int seed = 0;
+
+	for (size_t size : { BUFFER_SIZE * 10 + 7, size_t{ 0 }, size_t{ 1 }, BUFFER_SIZE,
+			 BUFFER_SIZE + 1, size_t{ 100000 } })
+	{
+		m_sources.push_back(GenerateData(size, seed++));
+	}
+
+	std::vector<std::vector<std::byte>> processedData(m_sources.size());
+	std::vector<size_t> finishedSources;
+	int numBlocksProcessed = 0;
+
+	auto result = m_pipeline.Run(
+		m_sources.size(), MakeSourceFactory(),
+		[&](size_t index, std::span<const std::byte> block)
+		{
+			EXPECT_LE(block.size(), BUFFER_SIZE);
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(block.data())
+					% ReadAheadPipeline::BUFFER_ALIGNMENT,
+				0u);
+
+			// Each block that's been read, but not yet processed, occupies a buffer, so the number
+			// of blocks read can't get ahead of the number processed by more than the number of
+			// buffers.
+			EXPECT_LE(m_numBlocksRead - numBlocksProcessed, static_cast<int>(NUM_BUFFERS));
+
+			processedData[index].insert(processedData[index].end(), block.begin(), block.end());
+			numBlocksProcessed++;
+			return true;
+		},
+		[&](size_t index)
+		{
+			finishedSources.push_back(index);
+			return true;
+		});
+
+	EXPECT_EQ(result.status, Status::Succeeded);
+	EXPECT_EQ(processedData, m_sources);
+	EXPECT_EQ(finishedSources, (std::vector<size_t>{ 0, 1, 2, 3, 4, 5 }));
+}
+
+TEST_F(ReadAheadPipelineTest, NoSources)
+{
+	bool called = false;
+	auto result = m_pipeline.Run(
+		0, MakeSourceFactory(),
+		[&](size_t, std::span<const std::byte>)
+		{
+			called = true;
+			return true;
+		});
+
+	EXPECT_EQ(result.status, Status::Succeeded);
+	EXPECT_FALSE(called);
+}
+
+TEST_F(ReadAheadPipelineTest, OpenFailure)
+{
+	m_sources = { GenerateData(10000, 0), GenerateData(10000, 1), GenerateData(10000, 2) };
+
+	std::vector<size_t> finishedSources;
+	auto result = m_pipeline.Run(
+		m_sources.size(), MakeSourceFactory(1),
+		[](size_t index, std::span<const std::byte>)
+		{
+			EXPECT_EQ(index, 0u);
+			return true;
+		},
+		[&](size_t index)
+		{
+			finishedSources.push_back(index);
+			return true;
+		});
+
+	EXPECT_EQ(result.status, Status::OpenFailed);
+	EXPECT_EQ(result.sourceIndex, 1u);
+	EXPECT_EQ(finishedSources, (std::vector<size_t>{ 0 }));
+}
+
+TEST_F(ReadAheadPipelineTest, ReadFailure)
+{
+	m_sources = { GenerateData(10000, 0), GenerateData(50000, 1), GenerateData(10000, 2) };
+
+	auto result = m_pipeline.Run(
+		m_sources.size(), MakeSourceFactory(std::nullopt, 1),
+		[](size_t index, std::span<const std::byte>)
+		{
+			EXPECT_LE(index, 1u);
+			return true;
+		});
+
+	EXPECT_EQ(result.status, Status::ReadFailed);
+	EXPECT_EQ(result.sourceIndex, 1u);
+}
+
+TEST_F(ReadAheadPipelineTest, ProcessFailure)
+{
+	m_sources = { GenerateData(100000, 0), GenerateData(100000, 1) };
+
+	int numBlocksProcessed = 0;
+	auto result = m_pipeline.Run(
+		m_sources.size(), MakeSourceFactory(),
+		[&](size_t index, std::span<const std::byte>)
+		{
+			EXPECT_EQ(index, 0u);
+			return ++numBlocksProcessed < 5;
+		});
+
+	EXPECT_EQ(result.status, Status::ProcessFailed);
+	EXPECT_EQ(result.sourceIndex, 0u);
+	EXPECT_EQ(numBlocksProcessed, 5);
+}
+
+TEST_F(ReadAheadPipelineTest, Cancel)
+{
+	m_sources = { GenerateData(1000000, 0) };
+
+	std::stop_source stopSource;
+	int numBlocksProcessed = 0;
+	auto result = m_pipeline.Run(
+		m_sources.size(), MakeSourceFactory(),
+		[&](size_t, std::span<const std::byte>)
+		{
+			if (++numBlocksProcessed == 3)
+			{
+				stopSource.request_stop();
+			}
+
+			return true;
+		},
+		nullptr, stopSource.get_token());
+
+	EXPECT_EQ(result.status, Status::Cancelled);
+	EXPECT_EQ(numBlocksProcessed, 3);
+}
+
+TEST_F(ReadAheadPipelineTest, Reuse)
+{
+	m_sources = { GenerateData(30000, 0) };
+
+	for (int i = 0; i < 3; i++)
+	{
+		std::vector<std::byte> processedData;
+		auto result = m_pipeline.Run(
+			m_sources.size(), MakeSourceFactory(),
+			[&](size_t, std::span<const std::byte> block)
+			{
+				processedData.insert(processedData.end(), block.begin(), block.end());
+				return true;
+			});
+
+		EXPECT_EQ(result.status, Status::Succeeded);
+		EXPECT_EQ(processedData, m_sources[0]);
+	}
+}
@@ -0,0 +1,194 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/SecureOverwriter.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <optional>
+
+using Status = SecureOverwriter::Status;
+
+namespace
+{
+
+class MemoryTarget : public SecureOverwriter::Target
+{
+public:
+	explicit MemoryTarget(size_t size) : m_data(size, std::byte{ 0xAA })
+	{
+	}
+
+	bool Rewind() override
+	{
+		m_offset = 0;
+		return true;
+	}
+
+	bool Write(std::span<const std::byte> data) override
+	{
+		if (m_failAtOffset && m_offset + data.size() > *m_failAtOffset)
+		{
+			return false;
+		}
+
+		// The overwriter should never write beyond the requested size.
+		EXPECT_LE(m_offset + data.size(), m_data.size());
+
+		std::copy(data.begin(), data.end(), m_data.begin() + m_offset);
+		m_offset += data.size();
+		return true;
+	}
+
+	bool Flush() override
+	{
+		// Each pass should cover the entire target before it's flushed.
+		EXPECT_EQ(m_offset, m_data.size());
+
+		m_passes.push_back(m_data);
+		return true;
+	}
+
+	void SetFailAtOffset(size_t offset)
+	{
+		m_failAtOffset = offset;
+	}
+
+	// The contents of the target at the end of each pass.
+	const std::vector<std::vector<std::byte>> &GetPasses() const
+	{
+		return m_passes;
+	}
+
+private:
+	std::vector<std::byte> m_data;
+	size_t m_offset = 0;
+	std::optional<size_t> m_failAtOffset;
+	std::vector<std::vector<std::byte>> m_passes;
+};
+
+bool AllBytesEqual(const std::vector<std::byte> &data, std::byte value)
+{
+	return std::all_of(data.begin(), data.end(), [value](std::byte b) { return b == value; });
+}
+
+}
+
+class SecureOverwriterTest : public testing::Test
+{
+protected:
+	static constexpr size_t BLOCK_SIZE = 4096;
+
+	// The size deliberately isn't a multiple of the block size, so that the final, partial block
+	// in each pass is covered.
+	static constexpr size_t TARGET_SIZE = BLOCK_SIZE * 5 + 123;
+
+	SecureOverwriterTest() : m_overwriter({}, BLOCK_SIZE), m_target(TARGET_SIZE)
+	{
+	}
+
+	SecureOverwriter m_overwriter;
+	MemoryTarget m_target;
+};
+
+TEST_F(SecureOverwriterTest, PatternPasses)
+{
+	const OverwritePass passes[] = { { OverwritePass::Type::Pattern, std::byte{ 0x00 } },
+		{ OverwritePass::Type::Pattern, std::byte{ 0xFF } } };
+
+	auto status = m_overwriter.Overwrite(m_target, TARGET_SIZE, passes);
+	EXPECT_EQ(status, Status::Succeeded);
+
+	const auto &writtenPasses = m_target.GetPasses();
+	ASSERT_EQ(writtenPasses.size(), 2u);
+	EXPECT_TRUE(AllBytesEqual(writtenPasses[0], std::byte{ 0x00 }));
+	EXPECT_TRUE(AllBytesEqual(writtenPasses[1], std::byte{ 0xFF }));
+}
+
+TEST_F(SecureOverwriterTest, RandomPass)
+{
+	const OverwritePass passes[] = { { OverwritePass::Type::Pattern, std::byte{ 0x00 } },
+		{ OverwritePass::Type::Random }, { OverwritePass::Type::Random } };
+
+	auto status = m_overwriter.Overwrite(m_target, TARGET_SIZE, passes);
+	EXPECT_EQ(status, Status::Succeeded);
+
+	const auto &writtenPasses = m_target.GetPasses();
+	ASSERT_EQ(writtenPasses.size(), 3u);
+
+	// The data in each random pass should be distinct, both from the data that was there before
+	// and from the data written in any earlier random pass.
+	EXPECT_NE(writtenPasses[1], writtenPasses[0]);
+	EXPECT_NE(writtenPasses[2], writtenPasses[1]);
+
+	// The random data should also vary across each block, rather than repeating.
+	auto firstBlock = std::span(writtenPasses[1]).first(BLOCK_SIZE);
+	auto secondBlock = std::span(writtenPasses[1]).subspan(BLOCK_SIZE, BLOCK_SIZE);
+	EXPECT_FALSE(std::equal(firstBlock.begin(), firstBlock.end(), secondBlock.begin()));
+}
+
+TEST_F(SecureOverwriterTest, Progress)
+{
+	const OverwritePass passes[] = { { OverwritePass::Type::Pattern, std::byte{ 0x00 } },
+		{ OverwritePass::Type::Random } };
+
+	uint64_t totalBytesWritten = 0;
+	int numCalls = 0;
+	auto progressCallback = [&totalBytesWritten, &numCalls](uint64_t numBytesWritten)
+	{
+		EXPECT_LE(numBytesWritten, BLOCK_SIZE);
+
+		totalBytesWritten += numBytesWritten;
+		numCalls++;
+	};
+
+	auto status = m_overwriter.Overwrite(m_target, TARGET_SIZE, passes, progressCallback);
+	EXPECT_EQ(status, Status::Succeeded);
+	EXPECT_EQ(totalBytesWritten, TARGET_SIZE * 2);
+	EXPECT_EQ(numCalls, 6 * 2);
+}
+
+TEST_F(SecureOverwriterTest, EmptyTarget)
+{
+	MemoryTarget target(0);
+	const OverwritePass passes[] = { { OverwritePass::Type::Random } };
+
+	auto status = m_overwriter.Overwrite(target, 0, passes);
+	EXPECT_EQ(status, Status::Succeeded);
+	EXPECT_EQ(target.GetPasses().size(), 1u);
+}
+
+TEST_F(SecureOverwriterTest, WriteFailed)
+{
+	m_target.SetFailAtOffset(BLOCK_SIZE * 2);
+
+	const OverwritePass passes[] = { { OverwritePass::Type::Pattern, std::byte{ 0x00 } } };
+
+	auto status = m_overwriter.Overwrite(m_target, TARGET_SIZE, passes);
+	EXPECT_EQ(status, Status::WriteFailed);
+	EXPECT_TRUE(m_target.GetPasses().empty());
+}
+
+TEST_F(SecureOverwriterTest, Cancel)
+{
+	std::stop_source stopSource;
+	int numBlocksWritten = 0;
+	auto progressCallback = [&stopSource, &numBlocksWritten](uint64_t numBytesWritten)
+	{
+		UNREFERENCED_PARAMETER(numBytesWritten);
+
+		if (++numBlocksWritten == 2)
+		{
+			stopSource.request_stop();
+		}
+	};
+
+	const OverwritePass passes[] = { { OverwritePass::Type::Pattern, std::byte{ 0x00 } } };
+
+	auto status = m_overwriter.Overwrite(m_target, TARGET_SIZE, passes, progressCallback,
+		stopSource.get_token());
+	EXPECT_EQ(status, Status::Cancelled);
+	EXPECT_EQ(numBlocksWritten, 2);
+	EXPECT_TRUE(m_target.GetPasses().empty());
+}
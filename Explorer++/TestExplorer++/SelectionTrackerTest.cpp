@@ -0,0 +1,285 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/SelectionTracker.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace testing;
+using Totals = SelectionTracker::Totals;
+
+TEST(SelectionTrackerTest, AddRemoveItems)
+{
+	SelectionTracker tracker;
+	tracker.AddItem(0, false, 100);
+	tracker.AddItem(1, true, 0);
+	tracker.AddItem(200, false, 50);
+
+	EXPECT_EQ(tracker.GetNumItems(), 3);
+	EXPECT_EQ(tracker.GetItemTotals(), (Totals{ 2, 1, 150 }));
+	EXPECT_TRUE(tracker.HasItem(200));
+	EXPECT_FALSE(tracker.HasItem(2));
+	EXPECT_FALSE(tracker.HasItem(1000));
+
+	tracker.RemoveItem(0);
+	EXPECT_FALSE(tracker.HasItem(0));
+	EXPECT_EQ(tracker.GetItemTotals(), (Totals{ 1, 1, 50 }));
+
+	// Removing an item that isn't being tracked should have no effect.
+	tracker.RemoveItem(0);
+	tracker.RemoveItem(5000);
+	EXPECT_EQ(tracker.GetItemTotals(), (Totals{ 1, 1, 50 }));
+
+	tracker.Clear();
+	EXPECT_EQ(tracker.GetNumItems(), 0);
+	EXPECT_EQ(tracker.GetItemTotals(), Totals{});
+	EXPECT_FALSE(tracker.HasItem(1));
+}
+
+TEST(SelectionTrackerTest, Selection)
+{
+	SelectionTracker tracker;
+	tracker.AddItem(0, false, 100);
+	tracker.AddItem(1, true, 0);
+	tracker.AddItem(2, false, 25);
+
+	EXPECT_TRUE(tracker.SetSelected(0, true));
+	EXPECT_TRUE(tracker.SetSelected(1, true));
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 1, 1, 100 }));
+
+	// Selecting an item that's already selected shouldn't change anything.
+	EXPECT_FALSE(tracker.SetSelected(0, true));
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 1, 1, 100 }));
+
+	// Items that aren't being tracked can't be selected.
+	EXPECT_FALSE(tracker.SetSelected(3, true));
+	EXPECT_FALSE(tracker.IsSelected(3));
+
+	EXPECT_TRUE(tracker.SetSelected(0, false));
+	EXPECT_FALSE(tracker.IsSelected(0));
+	EXPECT_TRUE(tracker.IsSelected(1));
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 0, 1, 0 }));
+
+	// Removing a selected item should also remove it from the selection.
+	tracker.RemoveItem(1);
+	EXPECT_EQ(tracker.GetSelectionTotals(), Totals{});
+
+	// If the item is added again, it shouldn't be selected.
+	tracker.AddItem(1, true, 0);
+	EXPECT_FALSE(tracker.IsSelected(1));
+}
+
+TEST(SelectionTrackerTest, GetSelectedItems)
+{
+	SelectionTracker tracker;
+
+	for (int i : { 0, 3, 63, 64, 130, 500 })
+	{
+		tracker.AddItem(i, false, 0);
+	}
+
+	EXPECT_THAT(tracker.GetSelectedItems(), IsEmpty());
+
+	// Items should be returned in increasing order, including across word boundaries.
+	tracker.SetSelected(500, true);
+	tracker.SetSelected(63, true);
+	tracker.SetSelected(0, true);
+	tracker.SetSelected(64, true);
+	EXPECT_THAT(tracker.GetSelectedItems(), ElementsAre(0, 63, 64, 500));
+	EXPECT_EQ(tracker.GetNumSelectedItems(), 4);
+
+	tracker.InvertSelection();
+	EXPECT_THAT(tracker.GetSelectedItems(), ElementsAre(3, 130));
+	EXPECT_EQ(tracker.GetNumSelectedItems(), 2);
+}
+
+TEST(SelectionTrackerTest, UpdateItem)
+{
+	SelectionTracker tracker;
+	tracker.AddItem(0, false, 100);
+	tracker.AddItem(1, false, 10);
+	tracker.SetSelected(0, true);
+
+	tracker.UpdateItem(0, false, 300);
+	EXPECT_EQ(tracker.GetItemTotals(), (Totals{ 2, 0, 310 }));
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 1, 0, 300 }));
+	EXPECT_TRUE(tracker.IsSelected(0));
+
+	tracker.UpdateItem(1, false, 20);
+	EXPECT_EQ(tracker.GetItemTotals(), (Totals{ 2, 0, 320 }));
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 1, 0, 300 }));
+
+	// Updating an item that isn't being tracked shouldn't add it.
+	tracker.UpdateItem(2, false, 1000);
+	EXPECT_FALSE(tracker.HasItem(2));
+	EXPECT_EQ(tracker.GetItemTotals(), (Totals{ 2, 0, 320 }));
+}
+
+TEST(SelectionTrackerTest, SetAllSelected)
+{
+	SelectionTracker tracker;
+
+	for (int i = 0; i < 130; i++)
+	{
+		tracker.AddItem(i, i % 10 == 0, i);
+	}
+
+	// Removed items shouldn't be selected.
+	tracker.RemoveItem(64);
+
+	tracker.SetAllSelected(true);
+	EXPECT_EQ(tracker.GetSelectionTotals(), tracker.GetItemTotals());
+	EXPECT_TRUE(tracker.IsSelected(0));
+	EXPECT_TRUE(tracker.IsSelected(129));
+	EXPECT_FALSE(tracker.IsSelected(64));
+
+	tracker.SetAllSelected(false);
+	EXPECT_EQ(tracker.GetSelectionTotals(), Totals{});
+	EXPECT_FALSE(tracker.IsSelected(0));
+}
+
+TEST(SelectionTrackerTest, InvertSelection)
+{
+	SelectionTracker tracker;
+	tracker.AddItem(0, false, 100);
+	tracker.AddItem(1, true, 0);
+	tracker.AddItem(2, false, 25);
+	tracker.AddItem(70, false, 5);
+	tracker.SetSelected(0, true);
+
+	tracker.InvertSelection();
+	EXPECT_FALSE(tracker.IsSelected(0));
+	EXPECT_TRUE(tracker.IsSelected(1));
+	EXPECT_TRUE(tracker.IsSelected(2));
+	EXPECT_TRUE(tracker.IsSelected(70));
+	EXPECT_FALSE(tracker.IsSelected(3));
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 2, 1, 30 }));
+
+	tracker.InvertSelection();
+	EXPECT_EQ(tracker.GetSelectionTotals(), (Totals{ 1, 0, 100 }));
+	EXPECT_TRUE(tracker.IsSelected(0));
+}
+
+// Applies a long series of random operations and verifies that the totals always match totals
+// calculated directly from a simple reference implementation.
+TEST(SelectionTrackerTest, RandomOperations)
+{
+	struct ReferenceItem
+	{
+		bool present = false;
+		bool isFolder = false;
+		uint64_t size = 0;
+		bool selected = false;
+	};
+
+	constexpr int NUM_INTERNAL_INDEXES = 300;
+
+	SelectionTracker tracker;
+	std::vector<ReferenceItem> referenceItems(NUM_INTERNAL_INDEXES);
+	std::mt19937 generator(1234);
+
+	for (int i = 0; i < 5000; i++)
+	{
+		int internalIndex =
+			std::uniform_int_distribution<int>(0, NUM_INTERNAL_INDEXES - 1)(generator);
+		auto &referenceItem = referenceItems[internalIndex];
+
+		switch (std::uniform_int_distribution<int>(0, 6)(generator))
+		{
+		case 0:
+		case 1:
+		{
+			bool isFolder = std::uniform_int_distribution<int>(0, 1)(generator) == 1;
+			auto size = std::uniform_int_distribution<uint64_t>(0, 1'000'000)(generator);
+			tracker.AddItem(internalIndex, isFolder, size);
+			referenceItem.present = true;
+			referenceItem.isFolder = isFolder;
+			referenceItem.size = size;
+		}
+		break;
+
+		case 2:
+			tracker.RemoveItem(internalIndex);
+			referenceItem = {};
+			break;
+
+		case 3:
+		{
+			bool selected = std::uniform_int_distribution<int>(0, 1)(generator) == 1;
+			tracker.SetSelected(internalIndex, selected);
+
+			if (referenceItem.present)
+			{
+				referenceItem.selected = selected;
+			}
+		}
+		break;
+
+		case 4:
+		{
+			auto size = std::uniform_int_distribution<uint64_t>(0, 1'000'000)(generator);
+			tracker.UpdateItem(internalIndex, referenceItem.isFolder, size);
+
+			if (referenceItem.present)
+			{
+				referenceItem.size = size;
+			}
+		}
+		break;
+
+		case 5:
+			tracker.InvertSelection();
+
+			for (auto &item : referenceItems)
+			{
+				item.selected = item.present && !item.selected;
+			}
+			break;
+
+		case 6:
+		{
+			bool selected = std::uniform_int_distribution<int>(0, 3)(generator) == 0;
+			tracker.SetAllSelected(selected);
+
+			for (auto &item : referenceItems)
+			{
+				item.selected = item.present && selected;
+			}
+		}
+		break;
+		}
+
+		Totals expectedItemTotals;
+		Totals expectedSelectionTotals;
+
+		for (const auto &item : referenceItems)
+		{
+			if (!item.present)
+			{
+				continue;
+			}
+
+			for (auto *totals : { &expectedItemTotals, &expectedSelectionTotals })
+			{
+				if (totals == &expectedSelectionTotals && !item.selected)
+				{
+					continue;
+				}
+
+				(item.isFolder ? totals->numFolders : totals->numFiles)++;
+				totals->size += item.size;
+			}
+		}
+
+		ASSERT_EQ(tracker.GetItemTotals(), expectedItemTotals);
+		ASSERT_EQ(tracker.GetSelectionTotals(), expectedSelectionTotals);
+	}
+
+	for (int i = 0; i < NUM_INTERNAL_INDEXES; i++)
+	{
+		EXPECT_EQ(tracker.HasItem(i), referenceItems[i].present);
+		EXPECT_EQ(tracker.IsSelected(i), referenceItems[i].selected);
+	}
+}
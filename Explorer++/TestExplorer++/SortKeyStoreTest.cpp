@@ -0,0 +1,237 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Explorer++/ShellBrowser/SortKeyStore.h"
+#include "../Explorer++/ShellBrowser/FolderSettings.h"
+#include "../Explorer++/ShellBrowser/ItemData.h"
+#include "../Explorer++/ShellBrowser/SortHelper.h"
+#include <gtest/gtest.h>
+#include <strsafe.h>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+struct TestItem
+{
+	std::wstring name;
+	DWORD attributes;
+	ULONGLONG size;
+	ULONGLONG time;
+	bool isFindDataValid;
+};
+
+FILETIME IntegerToFileTime(ULONGLONG value)
+{
+	ULARGE_INTEGER largeInteger;
+	largeInteger.QuadPart = value;
+	return { largeInteger.LowPart, largeInteger.HighPart };
+}
+
+BasicItemInfo_t BuildBasicItemInfo(const TestItem &item)
+{
+	BasicItemInfo_t basicItemInfo;
+	basicItemInfo.wfd = {};
+	basicItemInfo.wfd.dwFileAttributes = item.attributes;
+	StringCchCopy(basicItemInfo.wfd.cFileName, std::size(basicItemInfo.wfd.cFileName),
+		item.name.c_str());
+
+	ULARGE_INTEGER size;
+	size.QuadPart = item.size;
+	basicItemInfo.wfd.nFileSizeLow = size.LowPart;
+	basicItemInfo.wfd.nFileSizeHigh = size.HighPart;
+
+	basicItemInfo.wfd.ftCreationTime = IntegerToFileTime(item.time);
+	basicItemInfo.wfd.ftLastWriteTime = IntegerToFileTime(item.time * 2);
+	basicItemInfo.wfd.ftLastAccessTime = IntegerToFileTime(~item.time);
+
+	basicItemInfo.isFindDataValid = item.isFindDataValid;
+	StringCchCopy(basicItemInfo.szDisplayName, std::size(basicItemInfo.szDisplayName),
+		item.name.c_str());
+	basicItemInfo.isRoot = false;
+
+	return basicItemInfo;
+}
+
+int Sign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+}
+
+class SortKeyStoreTest : public testing::Test
+{
+protected:
+	SortKeyStoreTest()
+	{
+		// clang-format off
+		std::vector<TestItem> items = {
+			{ L"file.txt", FILE_ATTRIBUTE_ARCHIVE, 100, 5000, true },
+			{ L"File2.txt", FILE_ATTRIBUTE_NORMAL, 100, 5000, true },
+			{ L"file10.txt", FILE_ATTRIBUTE_HIDDEN, 0x100000000, 1, true },
+			{ L"file9.TXT", FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_SYSTEM, 99, 0xFFFFFFFF00, true },
+			{ L".hidden", FILE_ATTRIBUTE_HIDDEN, 5, 7, true },
+			{ L"shortcut.lnk", FILE_ATTRIBUTE_ARCHIVE, 1024, 42, true },
+			{ L"archive.tar.gz", FILE_ATTRIBUTE_COMPRESSED, 1ULL << 40, 3, true },
+			{ L"no extension", FILE_ATTRIBUTE_NORMAL, 0, 0, true },
+			{ L"Folder", FILE_ATTRIBUTE_DIRECTORY, 0, 100, true },
+			{ L"folder.with.dots", FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_HIDDEN, 0, 99, true },
+			{ L"virtual item", FILE_ATTRIBUTE_NORMAL, 0, 0, false },
+			{ L"virtual folder", FILE_ATTRIBUTE_DIRECTORY, 0, 0, false }
+		};
+		// clang-format on
+
+		for (const auto &item : items)
+		{
+			auto basicItemInfo = BuildBasicItemInfo(item);
+			m_sortKeyStore.SetItem(static_cast<int>(m_items.size()), basicItemInfo.szDisplayName,
+				basicItemInfo.wfd, basicItemInfo.isFindDataValid, basicItemInfo.isRoot, L"");
+			m_items.push_back(std::move(basicItemInfo));
+		}
+	}
+
+	void CheckMatchesReference(SortMode sortMode,
+		std::function<int(const BasicItemInfo_t &, const BasicItemInfo_t &)> referenceSort)
+	{
+		for (size_t i = 0; i < m_items.size(); i++)
+		{
+			for (size_t j = 0; j < m_items.size(); j++)
+			{
+				int expected = Sign(referenceSort(m_items[i], m_items[j]));
+				int actual = Sign(m_sortKeyStore.Compare(static_cast<int>(i), static_cast<int>(j),
+					sortMode, m_globalFolderSettings));
+
+				EXPECT_EQ(actual, expected) << "Sort mode: " << sortMode._to_string()
+											<< ", items: " << i << ", " << j;
+			}
+		}
+	}
+
+	GlobalFolderSettings m_globalFolderSettings;
+	SortKeyStore m_sortKeyStore;
+	std::vector<BasicItemInfo_t> m_items;
+};
+
+TEST_F(SortKeyStoreTest, Name)
+{
+	for (bool showExtensions : { true, false })
+	{
+		for (bool hideLinkExtension : { true, false })
+		{
+			for (bool useNaturalSortOrder : { true, false })
+			{
+				m_globalFolderSettings.showExtensions = showExtensions;
+				m_globalFolderSettings.hideLinkExtension = hideLinkExtension;
+				m_globalFolderSettings.useNaturalSortOrder = useNaturalSortOrder;
+
+				CheckMatchesReference(SortMode::Name,
+					[this](const BasicItemInfo_t &itemInfo1, const BasicItemInfo_t &itemInfo2)
+					{ return SortByName(itemInfo1, itemInfo2, m_globalFolderSettings); });
+			}
+		}
+	}
+}
+
+// Keys that are built ahead of time (as they are when a folder is enumerated) should produce the
+// same results as keys built by the store itself.
+TEST_F(SortKeyStoreTest, PrebuiltNameKeys)
+{
+	for (size_t i = 0; i < m_items.size(); i++)
+	{
+		const auto &item = m_items[i];
+		auto nameKeys =
+			SortKeyStore::BuildNameKeys(item.szDisplayName, item.wfd, item.isRoot, L"");
+		m_sortKeyStore.SetItem(static_cast<int>(i), item.szDisplayName, item.wfd,
+			item.isFindDataValid, item.isRoot, L"", std::move(nameKeys));
+	}
+
+	CheckMatchesReference(SortMode::Name,
+		[this](const BasicItemInfo_t &itemInfo1, const BasicItemInfo_t &itemInfo2)
+		{ return SortByName(itemInfo1, itemInfo2, m_globalFolderSettings); });
+}
+
+TEST_F(SortKeyStoreTest, Size)
+{
+	CheckMatchesReference(SortMode::Size, SortBySize);
+}
+
+TEST_F(SortKeyStoreTest, FolderSizes)
+{
+	auto compareSizes = [this](int internalIndex1, int internalIndex2)
+	{
+		return Sign(m_sortKeyStore.Compare(internalIndex1, internalIndex2, SortMode::Size,
+			m_globalFolderSettings));
+	};
+
+	// Until their sizes are known, folders are considered equal.
+	EXPECT_EQ(compareSizes(8, 9), 0);
+
+	// A folder whose size is known is considered larger than one whose size isn't.
+	m_sortKeyStore.SetFolderSize(9, 500);
+	EXPECT_EQ(compareSizes(8, 9), -1);
+
+	m_sortKeyStore.SetFolderSize(8, 1000);
+	EXPECT_EQ(compareSizes(8, 9), 1);
+
+	// Folder sizes can't be set for files.
+	m_sortKeyStore.SetFolderSize(0, 1000);
+	EXPECT_EQ(compareSizes(0, 1), 0);
+
+	// Updating a folder resets its size.
+	m_sortKeyStore.SetItem(8, m_items[8].szDisplayName, m_items[8].wfd, true, false, L"");
+	EXPECT_EQ(compareSizes(8, 9), -1);
+}
+
+TEST_F(SortKeyStoreTest, Dates)
+{
+	CheckMatchesReference(SortMode::DateModified,
+		[](const BasicItemInfo_t &itemInfo1, const BasicItemInfo_t &itemInfo2)
+		{ return SortByDate(itemInfo1, itemInfo2, DateType::Modified); });
+	CheckMatchesReference(SortMode::Created,
+		[](const BasicItemInfo_t &itemInfo1, const BasicItemInfo_t &itemInfo2)
+		{ return SortByDate(itemInfo1, itemInfo2, DateType::Created); });
+	CheckMatchesReference(SortMode::Accessed,
+		[](const BasicItemInfo_t &itemInfo1, const BasicItemInfo_t &itemInfo2)
+		{ return SortByDate(itemInfo1, itemInfo2, DateType::Accessed); });
+}
+
+TEST_F(SortKeyStoreTest, Attributes)
+{
+	CheckMatchesReference(SortMode::Attributes, SortByAttributes);
+}
+
+TEST_F(SortKeyStoreTest, Extension)
+{
+	CheckMatchesReference(SortMode::Extension, SortByExtension);
+}
+
+TEST_F(SortKeyStoreTest, DisplayNames)
+{
+	EXPECT_LT(m_sortKeyStore.CompareDisplayNames(0, 1, false), 0);
+	EXPECT_GT(m_sortKeyStore.CompareDisplayNames(2, 3, true), 0);
+	EXPECT_LT(m_sortKeyStore.CompareDisplayNames(2, 3, false), 0);
+}
+
+TEST_F(SortKeyStoreTest, UpdateAndRemove)
+{
+	EXPECT_TRUE(m_sortKeyStore.HasItem(0));
+	EXPECT_FALSE(m_sortKeyStore.IsFolder(0));
+	EXPECT_TRUE(m_sortKeyStore.IsFolder(8));
+
+	m_sortKeyStore.RemoveItem(0);
+	EXPECT_FALSE(m_sortKeyStore.HasItem(0));
+	EXPECT_TRUE(m_sortKeyStore.HasItem(1));
+
+	m_sortKeyStore.SetItem(0, L"zzz", m_items[8].wfd, true, false, L"");
+	EXPECT_TRUE(m_sortKeyStore.HasItem(0));
+	EXPECT_TRUE(m_sortKeyStore.IsFolder(0));
+	EXPECT_GT(m_sortKeyStore.CompareDisplayNames(0, 1, true), 0);
+
+	m_sortKeyStore.Clear();
+	EXPECT_FALSE(m_sortKeyStore.HasItem(0));
+	EXPECT_FALSE(m_sortKeyStore.HasItem(static_cast<int>(m_items.size()) - 1));
+}
@@ -0,0 +1,178 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/WildcardMatchKernel.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace WildcardMatchKernel;
+
+namespace
+{
+
+wchar_t FoldAsciiCaseReference(wchar_t c)
+{
+	return (c >= 'A' && c <= 'Z') ? static_cast<wchar_t>(c - 'A' + 'a') : c;
+}
+
+bool EqualsReference(std::wstring_view text, std::wstring_view pattern, std::wstring_view mask,
+	bool foldAsciiCase)
+{
+	for (size_t i = 0; i < pattern.size(); i++)
+	{
+		wchar_t c = foldAsciiCase ? FoldAsciiCaseReference(text[i]) : text[i];
+
+		if (mask[i] != 0 && c != pattern[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t FindReference(std::wstring_view text, size_t start, std::wstring_view pattern,
+	std::wstring_view mask, bool foldAsciiCase)
+{
+	for (size_t i = start; i + pattern.size() <= text.size(); i++)
+	{
+		if (EqualsReference(text.substr(i), pattern, mask, foldAsciiCase))
+		{
+			return i;
+		}
+	}
+
+	return std::wstring_view::npos;
+}
+
+std::wstring GenerateString(std::mt19937 &generator, std::wstring_view characters,
+	size_t maxLength)
+{
+	std::uniform_int_distribution<size_t> lengthDistribution(0, maxLength);
+	std::uniform_int_distribution<size_t> characterDistribution(0, characters.size() - 1);
+
+	std::wstring str(lengthDistribution(generator), '\0');
+
+	for (auto &c : str)
+	{
+		c = characters[characterDistribution(generator)];
+	}
+
+	return str;
+}
+
+}
+
+TEST(WildcardMatchKernelTest, IsAscii)
+{
+	EXPECT_TRUE(IsAscii(L""));
+	EXPECT_TRUE(IsAscii(L"file.txt"));
+	EXPECT_TRUE(IsAscii(L"a longer file name with spaces.txt"));
+	EXPECT_TRUE(IsAscii(std::wstring(1, 0x7F)));
+	EXPECT_FALSE(IsAscii(std::wstring(1, 0x80)));
+	EXPECT_FALSE(IsAscii(L"a longer file name ending in é"));
+	EXPECT_FALSE(IsAscii(L"é a longer file name starting with"));
+	EXPECT_FALSE(IsAscii(L"￿"));
+}
+
+TEST(WildcardMatchKernelTest, Equals)
+{
+	std::wstring pattern = L"a longer pattern.txt";
+	std::wstring mask(pattern.size(), 0xFFFF);
+
+	auto equals = [&pattern, &mask](const wchar_t *text, bool foldAsciiCase)
+	{ return Equals(text, pattern.data(), mask.data(), pattern.size(), foldAsciiCase); };
+
+	EXPECT_TRUE(equals(L"a longer pattern.txt", false));
+	EXPECT_FALSE(equals(L"A LONGER PATTERN.TXT", false));
+	EXPECT_TRUE(equals(L"A LONGER PATTERN.TXT", true));
+	EXPECT_FALSE(equals(L"a longer pattern.doc", true));
+
+	// Masked characters should be ignored.
+	mask[0] = 0;
+	mask[pattern.size() - 1] = 0;
+	EXPECT_TRUE(equals(L"b longer pattern.txx", false));
+
+	// Characters just outside the uppercase range shouldn't be folded.
+	std::wstring symbolPattern = L"`abcdefghijklmnopqrstuvwxyz{";
+	std::wstring symbolMask(symbolPattern.size(), 0xFFFF);
+	EXPECT_FALSE(Equals(L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[", symbolPattern.data(), symbolMask.data(),
+		symbolPattern.size(), true));
+	EXPECT_TRUE(Equals(L"`ABCDEFGHIJKLMNOPQRSTUVWXYZ{", symbolPattern.data(), symbolMask.data(),
+		symbolPattern.size(), true));
+}
+
+TEST(WildcardMatchKernelTest, Find)
+{
+	std::wstring text = L"the quick brown fox jumps over the lazy dog";
+	std::wstring pattern = L"the";
+	std::wstring mask(pattern.size(), 0xFFFF);
+
+	EXPECT_EQ(Find(text, 0, pattern.data(), mask.data(), pattern.size(), false), 0u);
+	EXPECT_EQ(Find(text, 1, pattern.data(), mask.data(), pattern.size(), false), 31u);
+	EXPECT_EQ(Find(text, 32, pattern.data(), mask.data(), pattern.size(), false),
+		std::wstring_view::npos);
+	EXPECT_EQ(Find(text, text.size() + 1, pattern.data(), mask.data(), pattern.size(), false),
+		std::wstring_view::npos);
+
+	std::wstring upperText = L"THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG";
+	EXPECT_EQ(Find(upperText, 1, pattern.data(), mask.data(), pattern.size(), false),
+		std::wstring_view::npos);
+	EXPECT_EQ(Find(upperText, 1, pattern.data(), mask.data(), pattern.size(), true), 31u);
+
+	// A pattern made up entirely of wildcards will match at the starting position, provided
+	// there's enough text remaining.
+	std::wstring wildcardPattern = L"???";
+	std::wstring wildcardMask(wildcardPattern.size(), 0);
+	EXPECT_EQ(Find(text, 5, wildcardPattern.data(), wildcardMask.data(), wildcardPattern.size(),
+				  false),
+		5u);
+	EXPECT_EQ(Find(text, text.size() - 2, wildcardPattern.data(), wildcardMask.data(),
+				  wildcardPattern.size(), false),
+		std::wstring_view::npos);
+}
+
+// Compares the results of the kernel with straightforward scalar implementations for a large
+// number of random strings, long enough that the vectorized paths are exercised.
+TEST(WildcardMatchKernelTest, MatchesReference)
+{
+	constexpr int NUM_ITERATIONS = 200000;
+
+	std::mt19937 generator(42);
+
+	const std::wstring textCharacters = L"aAbBzZ@[`{.";
+	const std::wstring patternCharacters = L"abz@[`{.?";
+
+	for (bool foldAsciiCase : { false, true })
+	{
+		for (int i = 0; i < NUM_ITERATIONS; i++)
+		{
+			auto text = GenerateString(generator, textCharacters, 40);
+			auto pattern = GenerateString(generator, patternCharacters, 12);
+
+			std::wstring mask;
+
+			for (auto c : pattern)
+			{
+				mask.push_back((c == '?') ? 0 : 0xFFFF);
+			}
+
+			std::uniform_int_distribution<size_t> startDistribution(0, text.size());
+			size_t start = startDistribution(generator);
+
+			ASSERT_EQ(Find(text, start, pattern.data(), mask.data(), pattern.size(), foldAsciiCase),
+				FindReference(text, start, pattern, mask, foldAsciiCase))
+				<< L"Text: \"" << text << L"\", pattern: \"" << pattern << L"\", start: " << start;
+
+			if (pattern.size() <= text.size())
+			{
+				ASSERT_EQ(
+					Equals(text.data(), pattern.data(), mask.data(), pattern.size(), foldAsciiCase),
+					EqualsReference(text, pattern, mask, foldAsciiCase))
+					<< L"Text: \"" << text << L"\", pattern: \"" << pattern << L"\"";
+			}
+		}
+	}
+}
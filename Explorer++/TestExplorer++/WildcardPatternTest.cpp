@@ -0,0 +1,372 @@
+// Copyright (C) Explorer++ Project
+// SPDX-License-Identifier: GPL-3.0-only
+// See LICENSE in the top level directory
+
+#include "pch.h"
+#include "../Helper/WildcardPattern.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace
+{
+
+// The implementation of CheckWildcardMatch that was used before WildcardPattern was introduced.
+// Retained so that the behavior of the two implementations can be compared.
+BOOL LegacyCheckWildcardMatch(const TCHAR *szWildcard, const TCHAR *szString, BOOL bCaseSensitive);
+
+BOOL LegacyCheckWildcardMatchInternal(const TCHAR *szWildcard, const TCHAR *szString,
+	BOOL bCaseSensitive)
+{
+	BOOL bMatched;
+	BOOL bCurrentMatch = TRUE;
+
+	while (*szWildcard != '\0' && *szString != '\0' && bCurrentMatch)
+	{
+		switch (*szWildcard)
+		{
+		case '*':
+			bMatched = FALSE;
+
+			if (*(szWildcard + 1) != '\0')
+			{
+				bMatched = LegacyCheckWildcardMatch(++szWildcard, szString, bCaseSensitive);
+			}
+
+			while (*szWildcard != '\0' && *szString != '\0' && !bMatched)
+			{
+				bMatched = LegacyCheckWildcardMatch(szWildcard, ++szString, bCaseSensitive);
+			}
+
+			if (bMatched)
+			{
+				while (*szWildcard != '\0')
+				{
+					szWildcard++;
+				}
+
+				szWildcard--;
+
+				while (*szString != '\0')
+				{
+					szString++;
+				}
+			}
+
+			bCurrentMatch = bMatched;
+			break;
+
+		case '?':
+			szString++;
+			break;
+
+		default:
+			if (bCaseSensitive)
+			{
+				bCurrentMatch = (*szWildcard == *szString);
+			}
+			else
+			{
+				TCHAR szCharacter1[1];
+				LCMapString(LOCALE_USER_DEFAULT, LCMAP_LOWERCASE, szWildcard, 1, szCharacter1,
+					static_cast<int>(std::size(szCharacter1)));
+
+				TCHAR szCharacter2[1];
+				LCMapString(LOCALE_USER_DEFAULT, LCMAP_LOWERCASE, szString, 1, szCharacter2,
+					static_cast<int>(std::size(szCharacter2)));
+
+				bCurrentMatch = (szCharacter1[0] == szCharacter2[0]);
+			}
+
+			szString++;
+			break;
+		}
+
+		szWildcard++;
+	}
+
+	while (*szWildcard == '*')
+	{
+		szWildcard++;
+	}
+
+	return *szWildcard == '\0' && *szString == '\0' && bCurrentMatch;
+}
+
+BOOL LegacyCheckWildcardMatch(const TCHAR *szWildcard, const TCHAR *szString, BOOL bCaseSensitive)
+{
+	if (!wcschr(szWildcard, ':'))
+	{
+		return LegacyCheckWildcardMatchInternal(szWildcard, szString, bCaseSensitive);
+	}
+
+	TCHAR szWildcardPattern[512];
+	TCHAR *szRemainingPattern = nullptr;
+
+	StringCchCopy(szWildcardPattern, std::size(szWildcardPattern), szWildcard);
+
+	TCHAR *szSinglePattern = wcstok_s(szWildcardPattern, _T(":"), &szRemainingPattern);
+
+	while (szSinglePattern != nullptr)
+	{
+		PathRemoveBlanks(szSinglePattern);
+
+		if (LegacyCheckWildcardMatchInternal(szSinglePattern, szString, bCaseSensitive))
+		{
+			return TRUE;
+		}
+
+		szSinglePattern = wcstok_s(nullptr, _T(":"), &szRemainingPattern);
+	}
+
+	return FALSE;
+}
+
+std::wstring GenerateString(std::mt19937 &generator, std::wstring_view characters,
+	size_t maxLength)
+{
+	std::uniform_int_distribution<size_t> lengthDistribution(0, maxLength);
+	std::uniform_int_distribution<size_t> characterDistribution(0, characters.size() - 1);
+
+	std::wstring str(lengthDistribution(generator), '\0');
+
+	for (auto &c : str)
+	{
+		c = characters[characterDistribution(generator)];
+	}
+
+	return str;
+}
+
+}
+
+TEST(WildcardPatternTest, Literal)
+{
+	WildcardPattern pattern(L"file.txt", true);
+	EXPECT_TRUE(pattern.Matches(L"file.txt"));
+	EXPECT_FALSE(pattern.Matches(L"File.txt"));
+	EXPECT_FALSE(pattern.Matches(L"file.txt2"));
+	EXPECT_FALSE(pattern.Matches(L"file.tx"));
+	EXPECT_FALSE(pattern.Matches(L""));
+}
+
+TEST(WildcardPatternTest, Empty)
+{
+	WildcardPattern pattern(L"", true);
+	EXPECT_TRUE(pattern.Matches(L""));
+	EXPECT_FALSE(pattern.Matches(L"a"));
+
+	WildcardPattern defaultPattern;
+	EXPECT_TRUE(defaultPattern.Matches(L""));
+	EXPECT_FALSE(defaultPattern.Matches(L"a"));
+}
+
+TEST(WildcardPatternTest, Star)
+{
+	WildcardPattern pattern(L"*", true);
+	EXPECT_TRUE(pattern.Matches(L""));
+	EXPECT_TRUE(pattern.Matches(L"file.txt"));
+
+	WildcardPattern suffixPattern(L"*.cpp", true);
+	EXPECT_TRUE(suffixPattern.Matches(L"main.cpp"));
+	EXPECT_TRUE(suffixPattern.Matches(L".cpp"));
+	EXPECT_FALSE(suffixPattern.Matches(L"main.cpp.bak"));
+	EXPECT_FALSE(suffixPattern.Matches(L"cpp"));
+
+	WildcardPattern prefixPattern(L"test*", true);
+	EXPECT_TRUE(prefixPattern.Matches(L"test"));
+	EXPECT_TRUE(prefixPattern.Matches(L"testing"));
+	EXPECT_FALSE(prefixPattern.Matches(L"a test"));
+
+	WildcardPattern middlePattern(L"a*b*c", true);
+	EXPECT_TRUE(middlePattern.Matches(L"abc"));
+	EXPECT_TRUE(middlePattern.Matches(L"aXbYc"));
+	EXPECT_TRUE(middlePattern.Matches(L"abbbcbc"));
+	EXPECT_FALSE(middlePattern.Matches(L"acb"));
+
+	// The prefix and suffix can't overlap.
+	WildcardPattern overlapPattern(L"ab*ba", true);
+	EXPECT_FALSE(overlapPattern.Matches(L"aba"));
+	EXPECT_TRUE(overlapPattern.Matches(L"abba"));
+
+	WildcardPattern multipleStarPattern(L"**a**", true);
+	EXPECT_TRUE(multipleStarPattern.Matches(L"a"));
+	EXPECT_TRUE(multipleStarPattern.Matches(L"bab"));
+	EXPECT_FALSE(multipleStarPattern.Matches(L"bbb"));
+}
+
+TEST(WildcardPatternTest, QuestionMark)
+{
+	WildcardPattern pattern(L"?.txt", true);
+	EXPECT_TRUE(pattern.Matches(L"1.txt"));
+	EXPECT_FALSE(pattern.Matches(L".txt"));
+	EXPECT_FALSE(pattern.Matches(L"12.txt"));
+
+	WildcardPattern mixedPattern(L"*a?c*", true);
+	EXPECT_TRUE(mixedPattern.Matches(L"abc"));
+	EXPECT_TRUE(mixedPattern.Matches(L"xxaxcxx"));
+	EXPECT_FALSE(mixedPattern.Matches(L"ac"));
+}
+
+TEST(WildcardPatternTest, CaseInsensitive)
+{
+	WildcardPattern pattern(L"*.TXT", false);
+	EXPECT_TRUE(pattern.Matches(L"file.txt"));
+	EXPECT_TRUE(pattern.Matches(L"FILE.Txt"));
+	EXPECT_FALSE(pattern.Matches(L"file.doc"));
+
+	WildcardPattern unicodePattern(L"привет*", false);
+	EXPECT_TRUE(unicodePattern.Matches(L"ПРИВЕТ мир"));
+
+	WildcardPattern caseSensitivePattern(L"привет*", true);
+	EXPECT_FALSE(caseSensitivePattern.Matches(L"ПРИВЕТ мир"));
+}
+
+TEST(WildcardPatternTest, MultiplePatterns)
+{
+	WildcardPattern pattern(L"*.h: *.cpp", true);
+	EXPECT_TRUE(pattern.Matches(L"file.h"));
+	EXPECT_TRUE(pattern.Matches(L"file.cpp"));
+	EXPECT_FALSE(pattern.Matches(L"file.txt"));
+
+	// Empty patterns are ignored, while patterns that only contain spaces will match an empty
+	// string.
+	WildcardPattern emptyPattern(L"::", true);
+	EXPECT_FALSE(emptyPattern.Matches(L""));
+
+	WildcardPattern blankPattern(L"a: ", true);
+	EXPECT_TRUE(blankPattern.Matches(L""));
+	EXPECT_TRUE(blankPattern.Matches(L"a"));
+	EXPECT_FALSE(blankPattern.Matches(L" "));
+}
+
+TEST(WildcardPatternTest, IsSubsetOf)
+{
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"*.txt", L"*.txt"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"*abc*", L"*ab*"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"*cab*", L"*ab*"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"ac*b", L"a*b"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"a*cb", L"a*b"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"a?*b", L"a*b"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"file.txt", L"*"));
+	EXPECT_TRUE(WildcardPattern::IsSubsetOf(L"*.txt", L"**"));
+
+	// Widening a pattern, or inserting characters away from a '*', can result in new strings
+	// matching.
+	EXPECT_FALSE(WildcardPattern::IsSubsetOf(L"*ab*", L"*abc*"));
+	EXPECT_FALSE(WildcardPattern::IsSubsetOf(L"acb", L"ab"));
+	EXPECT_FALSE(WildcardPattern::IsSubsetOf(L"*.txt", L"*.tx"));
+	EXPECT_FALSE(WildcardPattern::IsSubsetOf(L"a**b", L"a*b"));
+	EXPECT_FALSE(WildcardPattern::IsSubsetOf(L"a", L""));
+
+	// Multiple patterns aren't handled.
+	EXPECT_FALSE(WildcardPattern::IsSubsetOf(L"*.txt:*.doc", L"*.tx*:*.doc"));
+}
+
+// Verifies that, whenever IsSubsetOf() returns true, every name that matches the first pattern also
+// matches the second.
+TEST(WildcardPatternTest, IsSubsetOfRandom)
+{
+	constexpr int NUM_PATTERNS = 20000;
+	constexpr int NUM_NAMES = 50;
+
+	std::mt19937 generator(42);
+
+	const std::wstring nameCharacters = L"abc";
+	const std::wstring patternCharacters = nameCharacters + L"**?";
+
+	int numSubsets = 0;
+
+	for (int i = 0; i < NUM_PATTERNS; i++)
+	{
+		auto otherPatternText = GenerateString(generator, patternCharacters, 6);
+
+		// Inserts random characters at a random position, which will sometimes result in a
+		// subset.
+		std::uniform_int_distribution<size_t> positionDistribution(0, otherPatternText.size());
+		auto patternText = otherPatternText;
+		patternText.insert(positionDistribution(generator),
+			GenerateString(generator, patternCharacters, 2));
+
+		if (!WildcardPattern::IsSubsetOf(patternText, otherPatternText))
+		{
+			continue;
+		}
+
+		numSubsets++;
+
+		WildcardPattern pattern(patternText, true);
+		WildcardPattern otherPattern(otherPatternText, true);
+
+		for (int j = 0; j < NUM_NAMES; j++)
+		{
+			auto name = GenerateString(generator, nameCharacters, 8);
+
+			if (pattern.Matches(name))
+			{
+				ASSERT_TRUE(otherPattern.Matches(name))
+					<< L"Pattern: \"" << patternText << L"\", other pattern: \""
+					<< otherPatternText << L"\", name: \"" << name << L"\"";
+			}
+		}
+	}
+
+	EXPECT_GT(numSubsets, 0);
+}
+
+// Compares the results of WildcardPattern with the legacy implementation for a large number of
+// randomly generated names and patterns.
+TEST(WildcardPatternTest, MatchesLegacyImplementation)
+{
+	constexpr int NUM_ITERATIONS = 500000;
+
+	// A fixed seed is used, so that any failures are reproducible.
+	std::mt19937 generator(42);
+
+	// A small alphabet makes matches much more likely than they would otherwise be.
+	const std::wstring nameCharacters = L"aAbB. дД";
+	const std::wstring patternCharacters = nameCharacters + L"**??:";
+
+	for (BOOL caseSensitive : { TRUE, FALSE })
+	{
+		for (int i = 0; i < NUM_ITERATIONS; i++)
+		{
+			auto name = GenerateString(generator, nameCharacters, 12);
+			auto patternText = GenerateString(generator, patternCharacters, 8);
+
+			WildcardPattern pattern(patternText, caseSensitive);
+
+			ASSERT_EQ(pattern.Matches(name),
+				LegacyCheckWildcardMatch(patternText.c_str(), name.c_str(), caseSensitive))
+				<< L"Pattern: \"" << patternText << L"\", name: \"" << name
+				<< L"\", case sensitive: " << caseSensitive;
+		}
+	}
+}
+
+// As above, but with longer names that only contain ASCII characters, so that the vectorized
+// comparisons are used for case-insensitive patterns.
+TEST(WildcardPatternTest, MatchesLegacyImplementationLongNames)
+{
+	constexpr int NUM_ITERATIONS = 100000;
+
+	std::mt19937 generator(42);
+
+	const std::wstring nameCharacters = L"aAbB.";
+	const std::wstring patternCharacters = nameCharacters + L"*??";
+
+	for (BOOL caseSensitive : { TRUE, FALSE })
+	{
+		for (int i = 0; i < NUM_ITERATIONS; i++)
+		{
+			auto name = GenerateString(generator, nameCharacters, 40);
+			auto patternText = GenerateString(generator, patternCharacters, 24);
+
+			WildcardPattern pattern(patternText, caseSensitive);
+
+			ASSERT_EQ(pattern.Matches(name),
+				LegacyCheckWildcardMatch(patternText.c_str(), name.c_str(), caseSensitive))
+				<< L"Pattern: \"" << patternText << L"\", name: \"" << name
+				<< L"\", case sensitive: " << caseSensitive;
+		}
+	}
+}